@@ -1,4 +1,6 @@
+import sys
 import time
+import random
 import tomotopy as tp
 filename = 'enwiki-stemmed-1000.txt'
 
@@ -26,22 +28,194 @@ def bench_tomotopy(k, ps, w=0):
     print('K=%d\tW=%d\tTime: %.5g' % (k, w, time.time() - start_time), end='\t')
     print('LL: %g' % model.ll_per_word, flush=True)
 
+def bench_concurrent_infer(threads, frozen=False):
+    import threading
+    model = tp.LDAModel(k=50)
+    texts = [list(filter(lambda x:x!='.', text.strip().split())) for text in open(filename, encoding='utf-8')]
+    for words in texts: model.add_doc(words)
+    model.train(200)
+    model.frozen_inference = frozen
+    expected, _ = model.infer([model.make_doc(words) for words in texts], workers=1)
+    results = [None] * threads
 
-print('== tomotopy (K x ParallelScheme) ==')
-for ps in [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]:
-    print('= {} ='.format(ps.name))
+    # every thread infers all documents on the same model, and should get the same result as a sequential run
+    def run(i):
+        results[i], _ = model.infer([model.make_doc(words) for words in texts], workers=1)
+
+    start_time = time.time()
+    pool = [threading.Thread(target=run, args=(i,)) for i in range(threads)]
+    for t in pool: t.start()
+    for t in pool: t.join()
+    elapsed = time.time() - start_time
+    ok = all(all(abs(x - y) < 1e-5 for a, b in zip(r, expected) for x, y in zip(a, b)) for r in results)
+    print('Threads=%d\tFrozen=%d\tTime: %.5g\tDocs/s: %.5g\tConsistent: %s' % (threads, frozen, elapsed, threads * len(texts) / elapsed, ok), flush=True)
+
+def bench_compressed_save(workers):
+    import os
+    model = tp.LDAModel(k=50)
+    for text in open(filename, encoding='utf-8'): model.add_doc(list(filter(lambda x:x!='.', text.strip().split())))
+    model.train(200)
+    start_time = time.time()
+    model.save('bench.bin')
+    plain_time = time.time() - start_time
+    start_time = time.time()
+    model.save('bench.z.bin', compress=True, workers=workers)
+    save_time = time.time() - start_time
+    start_time = time.time()
+    tp.LDAModel.load('bench.z.bin')
+    load_time = time.time() - start_time
+    ratio = os.path.getsize('bench.bin') / os.path.getsize('bench.z.bin')
+    print('W=%d\tPlain: %.5g\tSave: %.5g\tLoad: %.5g\tRatio: %.3g' % (workers, plain_time, save_time, load_time, ratio), flush=True)
+
+
+def make_synthetic_corpus(D, V, mean_len, len_dist='poisson', zipf_s=1.07, seed=0):
+    '''generates `D` documents over `V` vocabs whose frequencies follow Zipf's law with the exponent `zipf_s`.
+    The lengths of documents follow `len_dist`, one of 'fixed', 'uniform', 'poisson' and 'lognormal', with the mean `mean_len`.
+    The same arguments always give the same corpus.'''
+    rng = random.Random(seed)
+    vocabs = ['w{}'.format(i) for i in range(V)]
+    cum_weights, acc = [], 0
+    for i in range(V):
+        acc += 1 / (i + 1) ** zipf_s
+        cum_weights.append(acc)
+
+    def draw_len():
+        if len_dist == 'fixed': return mean_len
+        if len_dist == 'uniform': return rng.randint(1, 2 * mean_len - 1)
+        if len_dist == 'lognormal': return max(1, round(rng.lognormvariate(0, 1) * mean_len / 1.6487))
+        # Poisson by counting the arrivals of a unit-rate process until `mean_len`
+        n, t = 0, rng.expovariate(1)
+        while t < mean_len:
+            n += 1
+            t += rng.expovariate(1)
+        return max(n, 1)
+
+    return [rng.choices(vocabs, cum_weights=cum_weights, k=draw_len()) for _ in range(D)]
+
+def timeit(fn, repeat=3):
+    '''returns the best elapsed time of `repeat` calls of `fn`'''
+    best = float('inf')
+    for _ in range(repeat):
+        start_time = time.perf_counter()
+        fn()
+        best = min(best, time.perf_counter() - start_time)
+    return best
+
+def bench_synthetic(D, V, K, mean_len, len_dist='poisson', sampling=tp.SamplingMethod.DENSE, ps=tp.ParallelScheme.DEFAULT, w=0, iteration=20):
+    '''times each stage of a model on a synthetic corpus.
+    `train` is dominated by `getZLikelihoods`, `prefixSum` and `sampleFromDiscreteAcc` of the token sampler, and `mergeState` with several workers.
+    `ll` times `getLL`, `infer` the inference of the held-out documents, and `save` and `load` the serialization of the full model.'''
+    docs = make_synthetic_corpus(D, V, mean_len, len_dist)
+    held_out = make_synthetic_corpus(max(D // 10, 1), V, mean_len, len_dist, seed=1)
+    model = tp.LDAModel(k=K, seed=42)
+    model.sampling_method = sampling
+    for words in docs: model.add_doc(words)
+    model.train(0)
+    tokens = model.num_words * iteration
+    train_time = timeit(lambda: model.train(iteration, workers=w, parallel=ps), repeat=1)
+    ll_time = timeit(lambda: model.ll_per_word)
+    infer_time = timeit(lambda: model.infer([model.make_doc(words) for words in held_out], workers=w))
+    data = model.saves(full=True)
+    save_time = timeit(lambda: model.saves(full=True))
+    load_time = timeit(lambda: tp.LDAModel.loads(data))
+    print('D=%d\tV=%d\tK=%d\tLen=%d(%s)\tW=%d\tTrain: %.5g (%.4g Mtok/s)\tLL: %.5g\tInfer: %.5g\tSave: %.5g\tLoad: %.5g' % (
+        D, V, K, mean_len, len_dist, w, train_time, tokens / train_time / 1e6, ll_time, infer_time, save_time, load_time), flush=True)
+
+def bench_synthetic_coherence(D, V, mean_len, window_size=10, w=1):
+    '''times the counting of `ProbEstimator::insertDoc` building `tomotopy.coherence.Coherence` over the documents of a model'''
+    model = tp.LDAModel(k=20, seed=42)
+    for words in make_synthetic_corpus(D, V, mean_len): model.add_doc(words)
+    model.train(20)
+    from tomotopy.coherence import Coherence
+    doc_time = timeit(lambda: Coherence(model, coherence='u_mass', top_n=20, workers=w))
+    window_time = timeit(lambda: Coherence(model, coherence='c_npmi', window_size=window_size, top_n=20, workers=w))
+    print('D=%d\tV=%d\tLen=%d\tW=%d\tDocument: %.5g\tWindows: %.5g' % (D, V, mean_len, w, doc_time, window_time), flush=True)
+
+def bench_synthetic_labeling(D, V, mean_len, K=20):
+    '''times `FoRelevance::estimateContexts`, which runs when `tomotopy.label.FoRelevance` is constructed'''
+    model = tp.LDAModel(k=K, seed=42)
+    for words in make_synthetic_corpus(D, V, mean_len): model.add_doc(words)
+    model.train(20)
+    cands = tp.label.PMIExtractor(min_cf=5, min_df=3, max_len=3, max_cand=5000).extract(model)
+    label_time = timeit(lambda: tp.label.FoRelevance(model, cands, min_df=3))
+    print('D=%d\tV=%d\tLen=%d\tCands=%d\tFoRelevance: %.5g' % (D, V, mean_len, len(cands), label_time), flush=True)
+
+def bench_alloc_policy(D, V, K, policy, w=1, iteration=20):
+    '''times training of a model with a large topic-word matrix under `tomotopy.set_alloc_policy`.
+    Columns of the matrix are accessed randomly by `getZLikelihoods`, so that huge pages save most of the TLB misses once the matrix exceeds the TLB reach.'''
+    tp.set_alloc_policy(policy, min_size=1 << 21)
+    try:
+        model = tp.LDAModel(k=K, seed=42)
+        for words in make_synthetic_corpus(D, V, 100): model.add_doc(words)
+        model.train(0)
+        tokens = model.num_words * iteration
+        train_time = timeit(lambda: model.train(iteration, workers=w), repeat=1)
+        infer_time = timeit(lambda: model.infer(list(model.docs)[:1000], workers=w), repeat=1)
+    finally:
+        tp.set_alloc_policy('default')
+    print('V=%d\tK=%d\tMatrix=%.4g MB\tPolicy=%s\tW=%d\tTrain: %.5g (%.4g Mtok/s)\tInfer: %.5g' % (
+        V, K, V * K * 4 / 2**20, policy, w, train_time, tokens / train_time / 1e6, infer_time), flush=True)
+
+def run(section):
+    '''whether to run `section`. Without arguments all sections are run, otherwise only the named ones.'''
+    return len(sys.argv) <= 1 or section in sys.argv[1:]
+
+if run('scheme'):
+    print('== tomotopy (K x ParallelScheme) ==')
+    for ps in [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]:
+        print('= {} ='.format(ps.name))
+        for k in range(10, 101, 10):
+            bench_tomotopy(k, ps)
+            time.sleep(2)
+
+if run('workers'):
+    print('== tomotopy (Workers x ParallelScheme) ==')
+    for ps in [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]:
+        print('= {} ='.format(ps.name))
+        for w in [1, 2, 3, 4, 5, 6, 7, 8]:
+            bench_tomotopy(50, ps, w)
+            time.sleep(2)
+
+if run('gensim'):
+    print('== gensim (K) ==')
     for k in range(10, 101, 10):
-        bench_tomotopy(k, ps)
+        bench_gensim(k)
         time.sleep(2)
 
-print('== tomotopy (Workers x ParallelScheme) ==')
-for ps in [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]:
-    print('= {} ='.format(ps.name))
-    for w in [1, 2, 3, 4, 5, 6, 7, 8]:
-        bench_tomotopy(50, ps, w)
+if run('infer'):
+    print('== tomotopy concurrent infer (Threads) ==')
+    for frozen in [False, True]:
+        for threads in [1, 2, 4, 8]:
+            bench_concurrent_infer(threads, frozen)
+            time.sleep(2)
+
+if run('save'):
+    print('== tomotopy compressed save (Workers) ==')
+    for w in [1, 2, 4, 8]:
+        bench_compressed_save(w)
         time.sleep(2)
 
-print('== gensim (K) ==')
-for k in range(10, 101, 10):
-    bench_gensim(k)
-    time.sleep(2)
+if run('synthetic'):
+    print('== tomotopy synthetic (K x SamplingMethod) ==')
+    for sampling in [tp.SamplingMethod.DENSE, tp.SamplingMethod.SPARSE, tp.SamplingMethod.MH]:
+        print('= {} ='.format(sampling.name))
+        for k in [10, 100, 500]:
+            bench_synthetic(10000, 20000, k, 100, sampling=sampling)
+
+    print('== tomotopy synthetic (Length x Workers) ==')
+    for len_dist, mean_len in [('fixed', 8), ('poisson', 30), ('lognormal', 300)]:
+        for w in [1, 4, 8]:
+            bench_synthetic(20000, 20000, 50, mean_len, len_dist, w=w)
+
+    print('== tomotopy synthetic coherence (Workers) ==')
+    for w in [1, 4]:
+        bench_synthetic_coherence(10000, 20000, 100, w=w)
+
+    print('== tomotopy synthetic labeling ==')
+    bench_synthetic_labeling(5000, 10000, 100)
+
+if run('alloc'):
+    print('== tomotopy alloc policy (Vocabs x Policy) ==')
+    for V in [20000, 200000, 1000000]:
+        for policy in ['default', 'huge_pages']:
+            bench_alloc_policy(20000, V, 500, policy)
@@ -12,16 +12,25 @@ long_description = ''
 for line in open(os.path.join(here, 'tomotopy/documentation.rst'), encoding='utf-8'):
     long_description += re.sub(r'^<.+>\s*$', '', line)
 
+# model families except LDA are built as separate modules (engines) imported on first use, see `src/python/engine.h`.
+# Setting TOMOTOPY_SPLIT_ENGINES=0 builds all of them into one module as before.
+split_engines = os.environ.get('TOMOTOPY_SPLIT_ENGINES', '1') != '0'
+engines = {
+    'dmr':'DMR', 'gdmr':'GDMR', 'hdp':'HDP', 'mglda':'MGLDA', 'pa':'PA', 'hpa':'HPA', 'ct':'CT', 
+    'slda':'SLDA', 'hlda':'HLDA', 'llda':'LLDA', 'plda':'PLDA', 'dt':'DT', 'pt':'PT',
+}
+engine_sources = {'src/TopicModel/{}Model.cpp'.format(family) for family in engines.values()}
+
 sources = []
 for f in os.listdir(os.path.join(here, 'src/python')):
-    if f.endswith('.cpp') and not f.endswith('py_rt.cpp'): sources.append('src/python/' + f)
+    if f.endswith('.cpp') and f not in ('py_rt.cpp', 'py_engine.cpp'): sources.append('src/python/' + f)
 for f in os.listdir(os.path.join(here, 'src/TopicModel')):
-    if f.endswith('.cpp'): sources.append('src/TopicModel/' + f)
+    if f.endswith('.cpp') and not (split_engines and 'src/TopicModel/' + f in engine_sources): sources.append('src/TopicModel/' + f)
 for f in os.listdir(os.path.join(here, 'src/Labeling')):
     if f.endswith('.cpp'): sources.append('src/Labeling/' + f)
 
 largs = []
-arch_levels = {'':'', 'sse2':'-msse2', 'avx':'-mavx', 'avx2':'-mavx2 -mfma'}
+arch_levels = {'':'', 'sse2':'-msse2', 'avx':'-mavx', 'avx2':'-mavx2 -mfma', 'avx512':'-mavx512f -mavx512dq -mavx512bw -mavx512vl -mavx2 -mfma'}
 if platform.system() == 'Windows': 
     cargs = ['/O2', '/MT', '/Gy']
     arch_levels = {'':'', 'sse2':'/arch:SSE2', 'avx':'/arch:AVX', 'avx2':'/arch:AVX2'}
@@ -35,6 +44,9 @@ else:
     cargs = ['-std=c++1y', '-O3', '-fpermissive', '-Wno-unused-variable', '-Wno-switch']
     arch_levels = {'':'-march=native'}
 
+# NEON is a baseline feature of aarch64, so a single module covers it
+if platform.machine().lower() in ('aarch64', 'arm64'): arch_levels = {'':''}
+
 if struct.calcsize('P') < 8: arch_levels = {k:v for k, v in arch_levels.items() if k in ('', 'sse2')}
 else: arch_levels = {k:v for k, v in arch_levels.items() if k not in ('sse2',)}
 
@@ -54,8 +66,16 @@ for arch, aopt in arch_levels.items():
                     libraries=[],
                     include_dirs=['include', numpy.get_include()],
                     sources=sources,
-                    define_macros=[('MODULE_NAME', 'PyInit_' + module_name)] + lang_macro,
+                    define_macros=[('MODULE_NAME', 'PyInit_' + module_name)] + lang_macro + ([('TOMOTOPY_SPLIT_ENGINES', '1')] if split_engines else []),
                     extra_compile_args=cargs + (aopt.split(' ') if aopt else []), extra_link_args=largs))
+    if not split_engines: continue
+    for name, family in engines.items():
+        modules.append(Extension(module_name + '_' + name,
+                        libraries=[],
+                        include_dirs=['include'],
+                        sources=['src/python/py_engine.cpp', 'src/TopicModel/{}Model.cpp'.format(family), 'src/TopicModel/InferenceModel.cpp'],
+                        define_macros=[('MODULE_NAME', 'PyInit_' + module_name + '_' + name), ('TOMOTOPY_ENGINE', 'I{}Model'.format(family))],
+                        extra_compile_args=cargs + (aopt.split(' ') if aopt else []), extra_link_args=largs))
 
 setup(
     name='tomotopy',
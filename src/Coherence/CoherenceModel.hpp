@@ -16,16 +16,62 @@ namespace tomoto
 {
 	namespace coherence
 	{
+		// iterates the words of a document of a topic model in their original order
+		class DocWordIterator
+		{
+			const Vid* base = nullptr;
+			const uint32_t* order = nullptr;
+			size_t idx = 0;
+		public:
+			DocWordIterator(const DocumentBase* doc = nullptr, size_t _idx = 0)
+				: base{ doc ? doc->words.data() : nullptr }, 
+				order{ doc && !doc->wOrder.empty() ? doc->wOrder.data() : nullptr }, 
+				idx{ _idx }
+			{
+			}
+
+			DocWordIterator& operator++()
+			{
+				++idx;
+				return *this;
+			}
+
+			const Vid& operator*() const
+			{
+				return order ? base[order[idx]] : base[idx];
+			}
+
+			const Vid& operator[](size_t i) const
+			{
+				return order ? base[order[idx + i]] : base[idx + i];
+			}
+
+			bool operator==(const DocWordIterator& o) const
+			{
+				return idx == o.idx && base == o.base;
+			}
+
+			bool operator!=(const DocWordIterator& o) const
+			{
+				return !operator==(o);
+			}
+
+			ptrdiff_t operator-(const DocWordIterator& o) const
+			{
+				return (ptrdiff_t)idx - (ptrdiff_t)o.idx;
+			}
+		};
+
 		class CoherenceModel
 		{
-			std::unique_ptr<IProbEstimator> pe;
+			std::shared_ptr<IProbEstimator> pe;
 			ProbEstimation pe_type = ProbEstimation::none;
 
 			template<ProbEstimation _pe>
-			void init(size_t windowSize)
+			void init(size_t windowSize, bool keepPostings)
 			{
 				pe_type = _pe;
-				pe = std::make_unique<ProbEstimator<_pe>>(windowSize);
+				pe = std::make_shared<ProbEstimator<_pe>>(windowSize, keepPostings);
 			}
 
 			template<ProbEstimation _pe, typename _TargetIter>
@@ -40,24 +86,73 @@ namespace tomoto
 				((ProbEstimator<_pe>*)pe.get())->insertDoc(wordFirst, wordLast);
 			}
 
+			template<ProbEstimation _pe, typename _DocFn>
+			void _insertDocs(size_t numDocs, _DocFn&& docFn, size_t numWorkers)
+			{
+				auto* mainPe = (ProbEstimator<_pe>*)pe.get();
+				if (numWorkers <= 1 || numDocs < numWorkers * 2)
+				{
+					for (size_t i = 0; i < numDocs; ++i)
+					{
+						auto r = docFn(i);
+						mainPe->insertDoc(r.first, r.second);
+					}
+					return;
+				}
+
+				// each worker counts a contiguous range of documents into its own shard,
+				// and the shards are merged in order so that segment ids of the postings stay in the order of documents.
+				using Shard = decltype(mainPe->makeShard());
+				std::vector<Shard> shards;
+				for (size_t w = 0; w < numWorkers; ++w) shards.emplace_back(mainPe->makeShard());
+
+				auto pool = PoolManager::getInstance().borrow(numWorkers);
+				std::vector<std::future<void>> res;
+				for (size_t w = 0; w < numWorkers; ++w)
+				{
+					res.emplace_back(pool->enqueue([&, w](size_t)
+					{
+						const size_t b = numDocs * w / numWorkers, e = numDocs * (w + 1) / numWorkers;
+						for (size_t i = b; i < e; ++i)
+						{
+							auto r = docFn(i);
+							shards[w].insertDoc(r.first, r.second);
+						}
+					}));
+				}
+				for (auto& r : res) r.get();
+
+				for (auto& shard : shards) mainPe->merge(std::move(shard));
+			}
+
 		public:
 			CoherenceModel() = default;
 
-			CoherenceModel(ProbEstimation _pe, size_t windowSize)
+			/*
+			`keepPostings` can be false if only pairwise probabilities are needed,
+			i.e. the segmentation is not `one_set` or an indirect measure is used.
+			*/
+			CoherenceModel(ProbEstimation _pe, size_t windowSize, bool keepPostings = true)
 			{
 				switch (_pe)
 				{
 				case ProbEstimation::document:
-					init<ProbEstimation::document>(windowSize);
+					init<ProbEstimation::document>(windowSize, keepPostings);
 					break;
 				case ProbEstimation::sliding_windows:
-					init<ProbEstimation::sliding_windows>(windowSize);
+					init<ProbEstimation::sliding_windows>(windowSize, keepPostings);
 					break;
 				default:
 					throw std::invalid_argument{ "invalid ProbEstimation `_pe`" };
 				}
 			}
 
+			// uses an estimator already filled, which may be shared with other models
+			CoherenceModel(ProbEstimation _pe, std::shared_ptr<IProbEstimator> _estimator)
+				: pe{ std::move(_estimator) }, pe_type{ _pe }
+			{
+			}
+
 			template<typename _TargetIter>
 			void insertTargets(_TargetIter targetFirst, _TargetIter targetLast)
 			{
@@ -86,12 +181,148 @@ namespace tomoto
 				}
 			}
 
+			/*
+			inserts `numDocs` documents, where `docFn(i)` returns the pair of word iterators of the i-th document.
+			If `numWorkers` > 1, `docFn` is called from multiple threads at once.
+			*/
+			template<typename _DocFn>
+			void insertDocs(size_t numDocs, _DocFn&& docFn, size_t numWorkers = 1)
+			{
+				switch (pe_type)
+				{
+				case ProbEstimation::document:
+					return _insertDocs<ProbEstimation::document>(numDocs, std::forward<_DocFn>(docFn), numWorkers);
+				case ProbEstimation::sliding_windows:
+					return _insertDocs<ProbEstimation::sliding_windows>(numDocs, std::forward<_DocFn>(docFn), numWorkers);
+				default:
+					throw std::invalid_argument{ "invalid ProbEstimation `_pe`" };
+				}
+			}
+
+			// inserts all the documents of `tm` without copying them, using `numWorkers` threads
+			void insertDocs(const ITopicModel& tm, size_t numWorkers = 1)
+			{
+				insertDocs(tm.getNumDocs(), [&](size_t i)
+				{
+					auto* doc = tm.getDoc(i);
+					return std::make_pair(DocWordIterator{ doc }, DocWordIterator{ doc, doc->words.size() });
+				}, numWorkers);
+			}
+
+			// the `topN` most probable words of all topics of `tm`, which may contain duplicates
+			static std::vector<Vid> getTopicTargets(const ITopicModel& tm, size_t topN, size_t numWorkers = 1)
+			{
+				std::vector<Vid> vids;
+				std::vector<Float> weights;
+				tm.getWidsByTopicsSorted(topN, numWorkers, vids, weights);
+				return vids;
+			}
+
 			template<Segmentation _seg, typename _CMFunc, typename _TargetIter>
 			double getScore(_CMFunc&& cm, _TargetIter targetFirst, _TargetIter targetLast) const
 			{
 				return makeSegmentor<_seg>(std::forward<_CMFunc>(cm), pe.get())(targetFirst, targetLast);
 			}
 
+			const IProbEstimator* getEstimator() const
+			{
+				return pe.get();
+			}
+
+			/*
+			scores each of `wordLists` segmented by `seg` using `numWorkers` threads.
+			`cm` should have been made with the estimator of this model so that it can be shared by the workers.
+			*/
+			std::vector<double> getScores(const AnyConfirmMeasurer& cm, Segmentation seg, 
+				const std::vector<std::vector<Vid>>& wordLists, size_t numWorkers = 1) const
+			{
+				std::vector<double> ret(wordLists.size());
+				if (numWorkers <= 1 || wordLists.size() <= 1)
+				{
+					for (size_t i = 0; i < wordLists.size(); ++i) ret[i] = cm.getScore(pe.get(), seg, wordLists[i]);
+					return ret;
+				}
+
+				numWorkers = std::min(numWorkers, wordLists.size());
+				auto pool = PoolManager::getInstance().borrow(numWorkers);
+				std::vector<std::future<void>> res;
+				for (size_t w = 0; w < numWorkers; ++w)
+				{
+					res.emplace_back(pool->enqueue([&, w](size_t)
+					{
+						for (size_t i = w; i < wordLists.size(); i += numWorkers)
+						{
+							ret[i] = cm.getScore(pe.get(), seg, wordLists[i]);
+						}
+					}));
+				}
+				for (auto& r : res) r.get();
+				return ret;
+			}
+
+		};
+
+		/*
+		holds a `CorpusIndex` of a reference corpus and the estimators filled from it.
+		Estimators are kept per configuration and grow with the targets requested,
+		so scoring new targets only scans the occurrences of them rather than the whole corpus.
+		*/
+		class IndexedEstimators
+		{
+			CorpusIndex index;
+			std::map<std::tuple<ProbEstimation, size_t, bool>, std::shared_ptr<IProbEstimator>> estimators;
+
+			template<ProbEstimation _pe, typename _TargetIter>
+			std::shared_ptr<IProbEstimator> _getEstimator(size_t windowSize, bool keepPostings, _TargetIter targetFirst, _TargetIter targetLast)
+			{
+				auto& cur = estimators[std::make_tuple(_pe, windowSize, keepPostings)];
+				auto* curPe = (const ProbEstimator<_pe>*)cur.get();
+				if (curPe && curPe->hasTargets(targetFirst, targetLast)) return cur;
+
+				// the estimator is extended on a copy, since the current one may be in use by other models
+				auto next = curPe ? std::make_shared<ProbEstimator<_pe>>(*curPe) : std::make_shared<ProbEstimator<_pe>>(windowSize, keepPostings);
+				next->insertTargets(targetFirst, targetLast, index);
+				cur = next;
+				return cur;
+			}
+
+		public:
+			template<typename _DocFn>
+			void build(size_t numDocs, _DocFn&& docFn)
+			{
+				estimators.clear();
+				index.build(numDocs, std::forward<_DocFn>(docFn));
+			}
+
+			const CorpusIndex& getIndex() const
+			{
+				return index;
+			}
+
+			template<typename _TargetIter>
+			std::shared_ptr<IProbEstimator> getEstimator(ProbEstimation pe, size_t windowSize, bool keepPostings, _TargetIter targetFirst, _TargetIter targetLast)
+			{
+				switch (pe)
+				{
+				case ProbEstimation::document:
+					return _getEstimator<ProbEstimation::document>(0, keepPostings, targetFirst, targetLast);
+				case ProbEstimation::sliding_windows:
+					return _getEstimator<ProbEstimation::sliding_windows>(windowSize, keepPostings, targetFirst, targetLast);
+				default:
+					throw std::invalid_argument{ "invalid ProbEstimation `_pe`" };
+				}
+			}
+
+			void serializerRead(std::istream& istr)
+			{
+				estimators.clear();
+				index.serializerRead(istr);
+			}
+
+			void serializerWrite(std::ostream& ostr) const
+			{
+				index.serializerWrite(ostr);
+			}
 		};
 	}
 }
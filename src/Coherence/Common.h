@@ -32,6 +32,29 @@ namespace tomoto
 			virtual double getJointNotProb(Vid word1, const std::vector<Vid>& word2) const = 0;
 			virtual ~IProbEstimator() {}
 
+			/*
+			fills the probabilities of each of `words` and of each pair (i, j) of them at `i * words.size() + j`,
+			where `jointNot` is the probability of `words[i]` without `words[j]`.
+			Estimators override it to read their counts without looking up each pair.
+			*/
+			virtual void getPairwiseProbs(const std::vector<Vid>& words,
+				std::vector<double>& single, std::vector<double>& joint, std::vector<double>& jointNot) const
+			{
+				const size_t n = words.size();
+				single.resize(n);
+				joint.resize(n * n);
+				jointNot.resize(n * n);
+				for (size_t i = 0; i < n; ++i)
+				{
+					single[i] = getProb(words[i]);
+					for (size_t j = 0; j < n; ++j)
+					{
+						joint[i * n + j] = getProb(words[i], words[j]);
+						jointNot[i * n + j] = getJointNotProb(words[i], words[j]);
+					}
+				}
+			}
+
 			double getProb(Vid word1, const std::vector<Vid>& word2) const
 			{
 				auto words = word2;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cmath>
+#include <set>
 #include "Common.h"
+#include "Segmentor.hpp"
 
 namespace tomoto
 {
@@ -161,26 +163,120 @@ namespace tomoto
 			}
 		};
 
+		/*
+		an estimator over the probabilities filled by `IProbEstimator::getPairwiseProbs`, where a word is an index into the words given to it.
+		Confirm measures can be evaluated on it for all pairs of the words without looking up the counts of each pair.
+		*/
+		class PairwiseProbEstimator : public IProbEstimator
+		{
+			size_t n = 0;
+			std::vector<double> single, joint, jointNot;
+		public:
+			PairwiseProbEstimator(const IProbEstimator* pe, const std::vector<Vid>& words)
+				: n{ words.size() }
+			{
+				pe->getPairwiseProbs(words, single, joint, jointNot);
+			}
+
+			double getProb(Vid word) const override
+			{
+				return single[word];
+			}
+
+			double getProb(Vid word1, Vid word2) const override
+			{
+				return joint[(size_t)word1 * n + word2];
+			}
+
+			double getProb(const std::vector<Vid>& words) const override
+			{
+				if (words.size() == 0) return 0;
+				if (words.size() == 1) return getProb(words[0]);
+				if (words.size() == 2) return getProb(words[0], words[1]);
+				throw exc::Unimplemented{ "PairwiseProbEstimator has no probabilities of more than two words" };
+			}
+
+			double getJointNotProb(Vid word1, Vid word2) const override
+			{
+				return jointNot[(size_t)word1 * n + word2];
+			}
+
+			double getJointNotProb(Vid word1, const std::vector<Vid>& word2) const override
+			{
+				if (word2.size() == 0) return 0;
+				if (word2.size() == 1) return getJointNotProb(word1, word2[0]);
+				throw exc::Unimplemented{ "PairwiseProbEstimator has no probabilities of more than two words" };
+			}
+		};
+
+		/*
+		If the estimator is given on construction, the context vectors of all the targets are computed at once as the columns of `contexts`,
+		and the measurer is read-only afterwards, so that it can score from multiple threads.
+		Otherwise the vectors are computed lazily into `vectorCache`.
+		*/
 		template<typename _CMFunc, IndirectMeasure _im>
 		class IndirectMeasurer
 		{
 			_CMFunc cm;
 			float gamma;
-			std::vector<Vid> targets;
+			std::vector<Vid> targets; // sorted
+			Eigen::ArrayXXf contexts;
 			mutable std::unordered_map<Vid, Eigen::ArrayXf> vectorCache;
 
-			const Eigen::ArrayXf& getVector(const IProbEstimator* pe, Vid word) const
+			Eigen::ArrayXf makeVector(const IProbEstimator* pe, Vid word) const
 			{
-				auto it = vectorCache.find(word);
-				if (it != vectorCache.end()) return it->second;
-
 				Eigen::ArrayXf v(targets.size());
 				for (size_t i = 0; i < targets.size(); ++i)
 				{
 					v[i] = cm(pe, word, targets[i]);
 				}
-				v = v.pow(gamma);
-				return vectorCache.emplace(word, std::move(v)).first->second;
+				return v.pow(gamma);
+			}
+
+			void computeContexts(const IProbEstimator* pe, size_t numWorkers)
+			{
+				const size_t t = targets.size();
+				const PairwiseProbEstimator pairs{ pe, targets };
+				contexts.resize(t, t);
+				auto fill = [&](size_t b, size_t e)
+				{
+					for (size_t j = b; j < e; ++j)
+					{
+						for (size_t i = 0; i < t; ++i) contexts(i, j) = cm(&pairs, (Vid)j, (Vid)i);
+						contexts.col(j) = contexts.col(j).pow(gamma);
+					}
+				};
+
+				if (numWorkers <= 1 || t < numWorkers * 16)
+				{
+					fill(0, t);
+					return;
+				}
+				auto pool = PoolManager::getInstance().borrow(numWorkers);
+				std::vector<std::future<void>> res;
+				for (size_t w = 0; w < numWorkers; ++w)
+				{
+					res.emplace_back(pool->enqueue([&, w](size_t)
+					{
+						fill(t * w / numWorkers, t * (w + 1) / numWorkers);
+					}));
+				}
+				for (auto& r : res) r.get();
+			}
+
+			Eigen::ArrayXf getVector(const IProbEstimator* pe, Vid word) const
+			{
+				if (contexts.size())
+				{
+					auto it = std::lower_bound(targets.begin(), targets.end(), word);
+					if (it != targets.end() && *it == word) return contexts.col(it - targets.begin());
+					// the vectors of words out of the targets are not cached, so that the measurer stays read-only
+					return makeVector(pe, word);
+				}
+
+				auto it = vectorCache.find(word);
+				if (it != vectorCache.end()) return it->second;
+				return vectorCache.emplace(word, makeVector(pe, word)).first->second;
 			}
 
 			double calcMeasure(const Eigen::ArrayXf& v1, const Eigen::ArrayXf& v2) const
@@ -197,33 +293,115 @@ namespace tomoto
 				return 0;
 			}
 
+			// the measures between each column of `v1` and the same column of `v2`
+			Eigen::ArrayXf calcMeasures(const Eigen::ArrayXXf& v1, const Eigen::ArrayXXf& v2) const
+			{
+				switch (_im)
+				{
+				case IndirectMeasure::cosine:
+					return (v1 * v2).colwise().sum().transpose() 
+						/ (v1.square().colwise().sum() * v2.square().colwise().sum()).sqrt().transpose();
+				case IndirectMeasure::dice:
+					return v1.min(v2).colwise().sum().transpose() / (v1.colwise().sum() + v2.colwise().sum()).transpose();
+				case IndirectMeasure::jaccard:
+					return v1.min(v2).colwise().sum().transpose() / v1.max(v2).colwise().sum().transpose();
+				}
+				return Eigen::ArrayXf::Zero(v1.cols());
+			}
+
+			// the measures between all pairs of the columns of `v`
+			Eigen::ArrayXXf calcPairMeasures(const Eigen::ArrayXXf& v) const
+			{
+				const Eigen::Index n = v.cols();
+				if (_im == IndirectMeasure::cosine)
+				{
+					Eigen::ArrayXXf gram = v.matrix().transpose() * v.matrix();
+					const Eigen::ArrayXf norms = gram.matrix().diagonal().array();
+					return gram / (norms.matrix() * norms.matrix().transpose()).array().sqrt();
+				}
+				Eigen::ArrayXXf ret(n, n);
+				for (Eigen::Index i = 0; i < n; ++i)
+				{
+					for (Eigen::Index j = i; j < n; ++j)
+					{
+						ret(i, j) = ret(j, i) = calcMeasure(v.col(i), v.col(j));
+					}
+				}
+				return ret;
+			}
+
 		public:
 			template<typename _TargetIter>
-			IndirectMeasurer(const _CMFunc& _cm, double _gamma, _TargetIter targetFirst, _TargetIter targetLast)
+			IndirectMeasurer(const _CMFunc& _cm, double _gamma, _TargetIter targetFirst, _TargetIter targetLast,
+				const IProbEstimator* pe = nullptr, size_t numWorkers = 1)
 				: cm{ _cm }, gamma{ (float)_gamma }
 			{
 				std::set<Vid> uniqTargets{ targetFirst, targetLast };
 				targets.insert(targets.end(), uniqTargets.begin(), uniqTargets.end());
+				if (pe) computeContexts(pe, numWorkers);
 			}
 
 			double operator()(
 				const IProbEstimator* pe, Vid word1, Vid word2) const
 			{
-				const Eigen::ArrayXf& v1 = getVector(pe, word1);
-				const Eigen::ArrayXf& v2 = getVector(pe, word2);
-				return calcMeasure(v1, v2);
+				return calcMeasure(getVector(pe, word1), getVector(pe, word2));
 			}
 
 			double operator()(
 				const IProbEstimator* pe, Vid word1, const std::vector<Vid>& word2) const
 			{
-				const Eigen::ArrayXf& v1 = getVector(pe, word1);
 				Eigen::ArrayXf v2 = getVector(pe, word2[0]);
 				for (size_t i = 1; i < word2.size(); ++i)
 				{
 					v2 += getVector(pe, word2[i]);
 				}
-				return calcMeasure(v1, v2);
+				return calcMeasure(getVector(pe, word1), v2);
+			}
+
+			/*
+			scores all the segments of `words` at once, with their context vectors as the columns of a matrix.
+			The measures between all pairs or between each word and the sum of the vectors are computed by matrix operations.
+			*/
+			double getScore(const IProbEstimator* pe, Segmentation seg, const std::vector<Vid>& words) const
+			{
+				const size_t n = words.size();
+				Eigen::ArrayXXf v(targets.size(), n);
+				for (size_t i = 0; i < n; ++i) v.col(i) = getVector(pe, words[i]);
+
+				double ret = 0, cnt = 0;
+				switch (seg)
+				{
+				case Segmentation::one_one:
+				case Segmentation::one_pre:
+				case Segmentation::one_suc:
+				{
+					// the measures are symmetric, so the preceding and the succeeding pairs have the same sum
+					const Eigen::ArrayXXf m = calcPairMeasures(v);
+					for (size_t i = 0; i < n; ++i)
+					{
+						for (size_t j = 0; j < i; ++j) ret += m(i, j);
+					}
+					cnt = n * (n - 1) / 2.;
+					if (seg == Segmentation::one_one)
+					{
+						ret *= 2;
+						cnt *= 2;
+					}
+					break;
+				}
+				case Segmentation::one_set:
+				case Segmentation::one_all:
+				{
+					Eigen::ArrayXXf r = v.rowwise().sum().replicate(1, n);
+					if (seg == Segmentation::one_all) r -= v;
+					ret = calcMeasures(v, r).template cast<double>().sum();
+					cnt = n;
+					break;
+				}
+				default:
+					throw std::invalid_argument{ "invalid Segmentation `seg`" };
+				}
+				return ret / cnt;
 			}
 		};
 
@@ -232,10 +410,16 @@ namespace tomoto
 		{
 		public:
 			template<typename _TargetIter>
-			IndirectMeasurer(const _CMFunc& _cm, double _gamma, _TargetIter targetFirst, _TargetIter targetLast)
+			IndirectMeasurer(const _CMFunc& _cm, double _gamma, _TargetIter targetFirst, _TargetIter targetLast,
+				const IProbEstimator* pe = nullptr, size_t numWorkers = 1)
 				: _CMFunc{ _cm }
 			{
 			}
+
+			double getScore(const IProbEstimator* pe, Segmentation seg, const std::vector<Vid>& words) const
+			{
+				return scoreSegments(seg, static_cast<const _CMFunc&>(*this), pe, words);
+			}
 		};
 
 		class AnyConfirmMeasurer
@@ -247,6 +431,7 @@ namespace tomoto
 					const IProbEstimator* pe, Vid word1, Vid word2) const = 0;
 				virtual double operator()(
 					const IProbEstimator* pe, Vid word1, const std::vector<Vid>& word2) const = 0;
+				virtual double getScore(const IProbEstimator* pe, Segmentation seg, const std::vector<Vid>& words) const = 0;
 			};
 
 			template<typename T>
@@ -268,6 +453,11 @@ namespace tomoto
 				{
 					return object(pe, word1, word2);
 				}
+
+				double getScore(const IProbEstimator* pe, Segmentation seg, const std::vector<Vid>& words) const override
+				{
+					return object.getScore(pe, seg, words);
+				}
 			};
 
 			std::shared_ptr<const Concept> object;
@@ -293,64 +483,75 @@ namespace tomoto
 				return (*object)(pe, word1, word2);
 			}
 
+			// the score of `words` segmented by `seg`. It is safe to call from multiple threads if the measurer was made with the estimator
+			double getScore(const IProbEstimator* pe, Segmentation seg, const std::vector<Vid>& words) const
+			{
+				return object->getScore(pe, seg, words);
+			}
+
 			operator bool() const
 			{
 				return (bool)object;
 			}
 
 			template<IndirectMeasure _im, typename _TargetIter>
-			static AnyConfirmMeasurer makeIM(ConfirmMeasure cm, double eps, double gamma, _TargetIter targetFirst, _TargetIter targetLast)
+			static AnyConfirmMeasurer makeIM(ConfirmMeasure cm, double eps, double gamma, _TargetIter targetFirst, _TargetIter targetLast,
+				const IProbEstimator* pe, size_t numWorkers)
 			{
 				switch (cm)
 				{
 				case ConfirmMeasure::difference:
 					return { IndirectMeasurer<ConfirmMeasurer<ConfirmMeasure::difference>, _im>{ 
-						ConfirmMeasurer<ConfirmMeasure::difference>{ eps }, gamma, targetFirst, targetLast 
+						ConfirmMeasurer<ConfirmMeasure::difference>{ eps }, gamma, targetFirst, targetLast, pe, numWorkers
 					} };
 				case ConfirmMeasure::ratio:
 					return { IndirectMeasurer<ConfirmMeasurer<ConfirmMeasure::ratio>, _im>{
-						ConfirmMeasurer<ConfirmMeasure::ratio>{ eps }, gamma, targetFirst, targetLast
+						ConfirmMeasurer<ConfirmMeasure::ratio>{ eps }, gamma, targetFirst, targetLast, pe, numWorkers
 					} };
 				case ConfirmMeasure::pmi:
 					return { IndirectMeasurer<ConfirmMeasurer<ConfirmMeasure::pmi>, _im>{
-						ConfirmMeasurer<ConfirmMeasure::pmi>{ eps }, gamma, targetFirst, targetLast
+						ConfirmMeasurer<ConfirmMeasure::pmi>{ eps }, gamma, targetFirst, targetLast, pe, numWorkers
 					} };
 				case ConfirmMeasure::npmi:
 					return { IndirectMeasurer<ConfirmMeasurer<ConfirmMeasure::npmi>, _im>{
-						ConfirmMeasurer<ConfirmMeasure::npmi>{ eps }, gamma, targetFirst, targetLast
+						ConfirmMeasurer<ConfirmMeasure::npmi>{ eps }, gamma, targetFirst, targetLast, pe, numWorkers
 					} };
 				case ConfirmMeasure::likelihood:
 					return { IndirectMeasurer<ConfirmMeasurer<ConfirmMeasure::likelihood>, _im>{
-						ConfirmMeasurer<ConfirmMeasure::likelihood>{ eps }, gamma, targetFirst, targetLast
+						ConfirmMeasurer<ConfirmMeasure::likelihood>{ eps }, gamma, targetFirst, targetLast, pe, numWorkers
 					} };
 				case ConfirmMeasure::loglikelihood:
 					return { IndirectMeasurer<ConfirmMeasurer<ConfirmMeasure::loglikelihood>, _im>{
-						ConfirmMeasurer<ConfirmMeasure::loglikelihood>{ eps }, gamma, targetFirst, targetLast
+						ConfirmMeasurer<ConfirmMeasure::loglikelihood>{ eps }, gamma, targetFirst, targetLast, pe, numWorkers
 					} };
 				case ConfirmMeasure::logcond:
 					return { IndirectMeasurer<ConfirmMeasurer<ConfirmMeasure::logcond>, _im>{
-						ConfirmMeasurer<ConfirmMeasure::logcond>{ eps }, gamma, targetFirst, targetLast
+						ConfirmMeasurer<ConfirmMeasure::logcond>{ eps }, gamma, targetFirst, targetLast, pe, numWorkers
 					} };
 				default:
 					throw std::invalid_argument{ "invalid ConfirmMeasure `cm`" };
 				}
 			}
 
+			/*
+			If `pe` is given, an indirect measure computes the context vectors of all the targets from it at once using `numWorkers` threads,
+			and then it is read-only. It should be the estimator the measurer is used with.
+			*/
 			template<typename _TargetIter>
 			static AnyConfirmMeasurer getInstance(ConfirmMeasure cm, IndirectMeasure im, 
 				_TargetIter targetFirst, _TargetIter targetLast,
-				double eps = 1e-12, double gamma = 1)
+				double eps = 1e-12, double gamma = 1, const IProbEstimator* pe = nullptr, size_t numWorkers = 1)
 			{
 				switch (im)
 				{
 				case IndirectMeasure::none:
-					return makeIM<IndirectMeasure::none>(cm, eps, gamma, targetFirst, targetLast);
+					return makeIM<IndirectMeasure::none>(cm, eps, gamma, targetFirst, targetLast, pe, numWorkers);
 				case IndirectMeasure::cosine:
-					return makeIM<IndirectMeasure::cosine>(cm, eps, gamma, targetFirst, targetLast);
+					return makeIM<IndirectMeasure::cosine>(cm, eps, gamma, targetFirst, targetLast, pe, numWorkers);
 				case IndirectMeasure::dice:
-					return makeIM<IndirectMeasure::dice>(cm, eps, gamma, targetFirst, targetLast);
+					return makeIM<IndirectMeasure::dice>(cm, eps, gamma, targetFirst, targetLast, pe, numWorkers);
 				case IndirectMeasure::jaccard:
-					return makeIM<IndirectMeasure::jaccard>(cm, eps, gamma, targetFirst, targetLast);
+					return makeIM<IndirectMeasure::jaccard>(cm, eps, gamma, targetFirst, targetLast, pe, numWorkers);
 				default:
 					throw std::invalid_argument{ "invalid IndirectMeasure `im`" };
 				}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Common.h"
+
+namespace tomoto
+{
+	namespace coherence
+	{
+		/*
+		Inverted index of a reference corpus, which keeps the (document, position) of every occurrence of every word.
+		Once it is built, probability estimators for any target words can be filled by scanning
+		only the occurrences of those words instead of the whole corpus.
+		*/
+		class CorpusIndex
+		{
+			std::vector<uint32_t> docLens;
+			std::vector<uint64_t> wordPtr; // occurrences of word `v` are in [wordPtr[v], wordPtr[v + 1])
+			std::vector<uint32_t> occDocs, occPos;
+
+		public:
+			struct Occurrences
+			{
+				const uint32_t* docs;
+				const uint32_t* pos;
+				size_t size;
+			};
+
+			/*
+			indexes `numDocs` documents, where `docFn(i)` returns the pair of word iterators of the i-th document.
+			*/
+			template<typename _DocFn>
+			void build(size_t numDocs, _DocFn&& docFn)
+			{
+				docLens.clear();
+				wordPtr.clear();
+				for (size_t i = 0; i < numDocs; ++i)
+				{
+					auto r = docFn(i);
+					docLens.emplace_back((uint32_t)(r.second - r.first));
+					for (auto it = r.first; it != r.second; ++it)
+					{
+						Vid w = *it;
+						if (w == non_vocab_id) continue;
+						if (wordPtr.size() <= (size_t)w + 1) wordPtr.resize((size_t)w + 2);
+						wordPtr[w + 1]++;
+					}
+				}
+				if (wordPtr.empty()) wordPtr.resize(1);
+				std::partial_sum(wordPtr.begin(), wordPtr.end(), wordPtr.begin());
+
+				occDocs.resize(wordPtr.back());
+				occPos.resize(wordPtr.back());
+				std::vector<uint64_t> next{ wordPtr.begin(), wordPtr.end() - 1 };
+				for (size_t i = 0; i < numDocs; ++i)
+				{
+					auto r = docFn(i);
+					uint32_t p = 0;
+					for (auto it = r.first; it != r.second; ++it, ++p)
+					{
+						Vid w = *it;
+						if (w == non_vocab_id) continue;
+						occDocs[next[w]] = (uint32_t)i;
+						occPos[next[w]] = p;
+						next[w]++;
+					}
+				}
+			}
+
+			size_t numDocs() const
+			{
+				return docLens.size();
+			}
+
+			size_t docLen(size_t docId) const
+			{
+				return docLens[docId];
+			}
+
+			// occurrences of `word` sorted by document and then by position
+			Occurrences getOccurrences(Vid word) const
+			{
+				if ((size_t)word + 1 >= wordPtr.size()) return { nullptr, nullptr, 0 };
+				return { occDocs.data() + wordPtr[word], occPos.data() + wordPtr[word], (size_t)(wordPtr[word + 1] - wordPtr[word]) };
+			}
+
+			DEFINE_SERIALIZER(serializer::to_key("CIdx"), docLens, wordPtr, occDocs, occPos);
+		};
+	}
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Common.h"
+#include "CorpusIndex.hpp"
+#include "../Utils/sample.hpp"
 
 namespace tomoto
 {
@@ -8,153 +10,283 @@ namespace tomoto
 	{
 		namespace detail
 		{
-			struct WeightedDocId
+			// a set of segment ids, where a segment is a document or a run of windows sharing the same target words
+			using Bitset = std::vector<uint64_t>;
+
+			inline void setBit(Bitset& bits, size_t i)
 			{
-				size_t docId = 0, weight = 0;
+				if (bits.size() <= i / 64) bits.resize(i / 64 + 1);
+				bits[i / 64] |= (uint64_t)1 << (i % 64);
+			}
 
-				WeightedDocId() = default;
-				WeightedDocId(size_t _docId, size_t _weight)
-					: docId{ _docId }, weight{ _weight }
+			// ors `src` into `dest` with its bits shifted by `offset`
+			inline void orShifted(Bitset& dest, const Bitset& src, size_t offset)
+			{
+				if (src.empty()) return;
+				const size_t q = offset / 64, r = offset % 64;
+				if (dest.size() < q + src.size() + 1) dest.resize(q + src.size() + 1);
+				for (size_t k = 0; k < src.size(); ++k)
 				{
+					dest[q + k] |= src[k] << r;
+					if (r) dest[q + k + 1] |= src[k] >> (64 - r);
 				}
+			}
+
+			inline size_t popcnt64(uint64_t w)
+			{
+				return sample::popcnt((uint32_t)w) + sample::popcnt((uint32_t)(w >> 32));
+			}
+
+			template<ProbEstimation _pe>
+			class ProbEstimator;
+
+			/*
+			Target words are remapped into dense ids [0, T), so that counts of words and word pairs live in plain arrays.
+			The postings of each target are kept as a bitset over segment ids, and they are required only
+			for probabilities of more than two words. If `keepPostings` is false, no postings are collected.
+			*/
+			template<>
+			class ProbEstimator<ProbEstimation::document> : public IProbEstimator
+			{
+			protected:
+				static constexpr uint32_t nonTarget = -1;
+
+				std::unordered_map<Vid, uint32_t> targetIdx;
+				std::vector<size_t> singleCnt;
+				std::vector<size_t> jointCnt; // T * T, only the entry (i, j) with i < j is used
+				std::vector<Bitset> postings;
+				std::vector<uint32_t> segWeights; // the number of windows of each segment, empty if every segment is a document
+				size_t totDocs = 0;
+				size_t numSegs = 0;
+				bool keepPostings = true;
 
-				bool operator==(const WeightedDocId& o) const
+				uint32_t findTarget(Vid word) const
 				{
-					return docId == o.docId;
+					auto it = targetIdx.find(word);
+					if (it == targetIdx.end()) return nonTarget;
+					return it->second;
 				}
 
-				bool operator!=(const WeightedDocId& o) const
+				size_t& joint(uint32_t i, uint32_t j)
 				{
-					return operator==(o);
+					return jointCnt[(size_t)i * targetIdx.size() + j];
 				}
 
-				bool operator<(const WeightedDocId& o) const
+				size_t joint(uint32_t i, uint32_t j) const
 				{
-					return docId < o.docId;
+					return jointCnt[(size_t)i * targetIdx.size() + j];
 				}
-			};
-
 
-			struct CountIter
-			{
-				size_t count = 0;
-				CountIter& operator++() { return *this; }
-				
-				struct Wrapper
+				void requirePostings() const
 				{
-					CountIter& ci;
+					if (!keepPostings) throw exc::Unimplemented{ "probabilities of more than two words require postings, but this estimator was built without them" };
+				}
 
-					Wrapper(CountIter& _ci) : ci{ _ci }
+				size_t countBits(const Bitset& bits) const
+				{
+					size_t ret = 0;
+					for (size_t k = 0; k < bits.size(); ++k)
 					{
+						uint64_t w = bits[k];
+						if (segWeights.empty())
+						{
+							ret += popcnt64(w);
+							continue;
+						}
+						for (size_t b = 0; w; ++b, w >>= 1)
+						{
+							if (w & 1) ret += segWeights[k * 64 + b];
+						}
 					}
+					return ret;
+				}
 
-					void operator=(const size_t)
+				// returns the intersection of postings of `words`, or an empty set if any of them is not a target
+				Bitset intersectPostings(const std::vector<Vid>& words) const
+				{
+					Bitset ret;
+					for (size_t n = 0; n < words.size(); ++n)
 					{
-						++ci.count;
+						auto t = findTarget(words[n]);
+						if (t == nonTarget) return {};
+						auto& p = postings[t];
+						if (n == 0)
+						{
+							ret = p;
+							continue;
+						}
+						ret.resize(std::min(ret.size(), p.size()));
+						for (size_t k = 0; k < ret.size(); ++k) ret[k] &= p[k];
 					}
+					return ret;
+				}
 
-					void operator=(const WeightedDocId& t)
+				void resizeCounts()
+				{
+					const size_t t = targetIdx.size(), oldT = singleCnt.size();
+					std::vector<size_t> newJointCnt(t * t);
+					for (size_t i = 0; i < oldT; ++i)
 					{
-						ci.count += t.weight;
+						std::copy(jointCnt.begin() + i * oldT, jointCnt.begin() + (i + 1) * oldT, newJointCnt.begin() + i * t);
 					}
-				};
-
-				Wrapper operator*() { return { *this }; }
+					jointCnt = std::move(newJointCnt);
+					singleCnt.resize(t);
+					if (keepPostings) postings.resize(t);
+				}
 
-				using value_type = Wrapper;
-				using reference = Wrapper;
+				// counts a segment whose target words are `uniqs`, sorted and unique. Only targets >= `firstNew` and pairs including them are counted.
+				void countSegment(const std::vector<uint32_t>& uniqs, size_t segId, uint32_t firstNew)
+				{
+					for (size_t a = 0; a < uniqs.size(); ++a)
+					{
+						if (uniqs[a] >= firstNew)
+						{
+							singleCnt[uniqs[a]]++;
+							if (keepPostings) setBit(postings[uniqs[a]], segId);
+						}
+						for (size_t b = a + 1; b < uniqs.size(); ++b)
+						{
+							if (uniqs[b] >= firstNew) joint(uniqs[a], uniqs[b])++;
+						}
+					}
+				}
 
-				using pointer = void;
-				using iterator_category = std::forward_iterator_tag;
-				using difference_type = std::ptrdiff_t;
+				/*
+				calls `fn(docId, posVids)` in the order of documents for each document of `index` containing any target >= `firstNew`,
+				where `posVids` are the pairs of (position, target) of all targets in the document sorted by position.
+				*/
+				template<typename _Fn>
+				void forEachIndexedDoc(const CorpusIndex& index, uint32_t firstNew, _Fn&& fn) const
+				{
+					std::vector<Vid> vids(targetIdx.size());
+					for (auto& p : targetIdx) vids[p.second] = p.first;
 
-			};
+					std::unordered_map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> docs;
+					for (uint32_t t = firstNew; t < vids.size(); ++t)
+					{
+						auto occ = index.getOccurrences(vids[t]);
+						for (size_t i = 0; i < occ.size; ++i) docs[occ.docs[i]];
+					}
+					for (uint32_t t = 0; t < vids.size(); ++t)
+					{
+						auto occ = index.getOccurrences(vids[t]);
+						for (size_t i = 0; i < occ.size; ++i)
+						{
+							auto it = docs.find(occ.docs[i]);
+							if (it != docs.end()) it->second.emplace_back(occ.pos[i], t);
+						}
+					}
 
-			template<ProbEstimation _pe, typename DocIdType>
-			class ProbEstimator;
+					std::vector<uint32_t> docIds;
+					for (auto& p : docs) docIds.emplace_back(p.first);
+					std::sort(docIds.begin(), docIds.end());
+					for (auto d : docIds)
+					{
+						auto& posVids = docs[d];
+						std::sort(posVids.begin(), posVids.end());
+						fn(d, posVids);
+					}
+				}
 
-			template<typename DocIdType>
-			class ProbEstimator<ProbEstimation::document, DocIdType> : public IProbEstimator
-			{
-			protected:
-				std::unordered_map<Vid, size_t> singleCnt;
-				std::unordered_map<VidPair, size_t> jointCnt;
-				std::unordered_map<Vid, std::vector<DocIdType>> singleII;
-				std::unordered_map<VidPair, std::vector<DocIdType>> jointII;
-				size_t totDocs = 0;
 			public:
 				ProbEstimator() = default;
 
-				ProbEstimator(size_t windowSize)
+				ProbEstimator(size_t windowSize, bool _keepPostings = true) : keepPostings{ _keepPostings }
 				{
 				}
 
+				// returns an estimator with the same targets and no documents, which collects partial counts of a shard of documents
+				ProbEstimator makeShard() const
+				{
+					ProbEstimator ret{ 0, keepPostings };
+					ret.targetIdx = targetIdx;
+					ret.resizeCounts();
+					return ret;
+				}
+
+				// adds the counts of `o`, built from the same targets, whose documents come after the ones of this
+				void merge(ProbEstimator&& o)
+				{
+					for (size_t i = 0; i < singleCnt.size(); ++i) singleCnt[i] += o.singleCnt[i];
+					for (size_t i = 0; i < jointCnt.size(); ++i) jointCnt[i] += o.jointCnt[i];
+					for (size_t i = 0; i < postings.size(); ++i) orShifted(postings[i], o.postings[i], numSegs);
+					segWeights.insert(segWeights.end(), o.segWeights.begin(), o.segWeights.end());
+					totDocs += o.totDocs;
+					numSegs += o.numSegs;
+				}
+
 				template<typename _TargetIter>
-				void insertTargets(_TargetIter targetFirst, _TargetIter targetLast)
+				bool hasTargets(_TargetIter targetFirst, _TargetIter targetLast) const
 				{
 					for (; targetFirst != targetLast; ++targetFirst)
 					{
-						singleCnt.emplace(*targetFirst, 0);
+						if (findTarget(*targetFirst) == nonTarget) return false;
 					}
+					return true;
 				}
 
 				template<typename _TargetIter>
-				void insertDoc(_TargetIter wordFirst, _TargetIter wordLast)
+				void insertTargets(_TargetIter targetFirst, _TargetIter targetLast)
 				{
-					using iter = std::pair<const Vid, size_t>*;
-					std::unordered_set<iter> uniqs, negs;
-					for (; wordFirst != wordLast; ++wordFirst)
+					for (; targetFirst != targetLast; ++targetFirst)
 					{
-						auto it = singleCnt.find(*wordFirst);
-						if (it != singleCnt.end())
-						{
-							uniqs.emplace(&*it);
-						}
+						targetIdx.emplace(*targetFirst, (uint32_t)targetIdx.size());
 					}
+					resizeCounts();
+				}
+
+				/*
+				adds targets and counts them from `index` instead of inserting documents.
+				Only the occurrences of targets are scanned, and the counts of targets already inserted are kept as they are.
+				*/
+				template<typename _TargetIter>
+				void insertTargets(_TargetIter targetFirst, _TargetIter targetLast, const CorpusIndex& index)
+				{
+					const bool fresh = !totDocs;
+					const uint32_t firstNew = fresh ? 0 : (uint32_t)targetIdx.size();
+					insertTargets(targetFirst, targetLast);
+					if (!fresh && targetIdx.size() == firstNew) return;
 
-					for (auto& u : uniqs)
+					if (fresh) totDocs = numSegs = index.numDocs();
+					forEachIndexedDoc(index, firstNew, [&](uint32_t docId, const std::vector<std::pair<uint32_t, uint32_t>>& posVids)
 					{
-						u->second++;
-						singleII[u->first].emplace_back(totDocs);
-						for (auto& v : uniqs)
-						{
-							if (u->first < v->first)
-							{
-								jointCnt[{ u->first, v->first }]++;
-								jointII[{ u->first, v->first }].emplace_back(totDocs);
-							}
-						}
-					}
-					totDocs += 1;
+						std::vector<uint32_t> uniqs;
+						for (auto& p : posVids) uniqs.emplace_back(p.second);
+						std::sort(uniqs.begin(), uniqs.end());
+						uniqs.erase(std::unique(uniqs.begin(), uniqs.end()), uniqs.end());
+						countSegment(uniqs, docId, firstNew);
+					});
 				}
 
-				void updateII()
+				template<typename _TargetIter>
+				void insertDoc(_TargetIter wordFirst, _TargetIter wordLast)
 				{
-					for (auto& p : singleII)
+					std::vector<uint32_t> uniqs;
+					for (; wordFirst != wordLast; ++wordFirst)
 					{
-						std::sort(p.second.begin(), p.second.end());
+						auto t = findTarget(*wordFirst);
+						if (t != nonTarget) uniqs.emplace_back(t);
 					}
+					std::sort(uniqs.begin(), uniqs.end());
+					uniqs.erase(std::unique(uniqs.begin(), uniqs.end()), uniqs.end());
 
-					for (auto& p : jointII)
-					{
-						std::sort(p.second.begin(), p.second.end());
-					}
+					countSegment(uniqs, numSegs, 0);
+					totDocs += 1;
+					numSegs += 1;
 				}
 
 				double getProb(Vid word) const
 				{
-					auto it = singleCnt.find(word);
-					if (it == singleCnt.end()) return 0;
-					return it->second / (double)totDocs;
+					auto t = findTarget(word);
+					if (t == nonTarget) return 0;
+					return singleCnt[t] / (double)totDocs;
 				}
 
 				double getProb(Vid word1, Vid word2) const
 				{
-					Vid minWord = std::min(word1, word2);
-					Vid maxWord = std::max(word1, word2);
-					auto it = jointCnt.find(VidPair{ minWord, maxWord });
-					if (it == jointCnt.end()) return 0;
-					return it->second / (double)totDocs;
+					auto t1 = findTarget(word1), t2 = findTarget(word2);
+					if (t1 == nonTarget || t2 == nonTarget || t1 == t2) return 0;
+					return joint(std::min(t1, t2), std::max(t1, t2)) / (double)totDocs;
 				}
 
 				double getProb(const std::vector<Vid>& words) const
@@ -163,132 +295,111 @@ namespace tomoto
 					if (words.size() == 1) return getProb(words[0]);
 					if (words.size() == 2) return getProb(words[0], words[1]);
 
-					Vid vFirst = std::min(words[0], words[1]);
-					Vid vSecond = std::max(words[0], words[1]);
-
-					auto it = jointII.find(VidPair{ vFirst, vSecond });
-					if (it == jointII.end()) return 0;
-					std::vector<DocIdType> intersection = it->second;
-					for (size_t i = (words.size() % 2) ? 1 : 2; i < words.size(); i += 2)
-					{
-						Vid vFirst = std::min(words[i], words[i + 1]);
-						Vid vSecond = std::max(words[i], words[i + 1]);
-
-						auto it = jointII.find(VidPair{ vFirst, vSecond });
-						if (it == jointII.end()) return 0;
-						std::vector<DocIdType> intersectionT;
-						std::set_intersection(it->second.begin(), it->second.end(),
-							intersection.begin(), intersection.end(),
-							std::back_inserter(intersectionT)
-						);
-						intersectionT.swap(intersection);
-					}
-					return intersection.size() / (double)totDocs;
+					requirePostings();
+					return countBits(intersectPostings(words)) / (double)totDocs;
 				}
 
 				double getJointNotProb(Vid word1, Vid word2) const
 				{
-					std::vector<DocIdType> intersection;
-					auto it = singleII.find(word2);
-					if (it != singleII.end()) intersection = it->second;
-					if (intersection.empty()) return getProb(word1);
-
-					it = singleII.find(word1);
-					if (it == singleII.end()) return 0;
-					return std::set_difference(it->second.begin(), it->second.end(),
-						intersection.begin(), intersection.end(),
-						detail::CountIter{}
-					).count / (double)totDocs;
+					auto t1 = findTarget(word1), t2 = findTarget(word2);
+					if (t2 == nonTarget || !singleCnt[t2]) return getProb(word1);
+					if (t1 == nonTarget || t1 == t2) return 0;
+					return (singleCnt[t1] - joint(std::min(t1, t2), std::max(t1, t2))) / (double)totDocs;
 				}
 
 				double getJointNotProb(Vid word1, const std::vector<Vid>& word2) const
 				{
-					std::vector<DocIdType> intersection;
-
 					if (word2.size() == 0) return 0;
-					if (word2.size() == 1)
-					{
-						auto it = singleII.find(word2[0]);
-						if (it != singleII.end()) intersection = it->second;
-					}
-					else if (word2.size() == 2)
-					{
-						Vid vFirst = std::min(word2[0], word2[1]);
-						Vid vSecond = std::max(word2[0], word2[1]);
+					if (word2.size() == 1) return getJointNotProb(word1, word2[0]);
+
+					requirePostings();
+					Bitset intersection = intersectPostings(word2);
+					auto t1 = findTarget(word1);
+					if (t1 == nonTarget) return 0;
+					Bitset diff = postings[t1];
+					for (size_t k = 0; k < std::min(diff.size(), intersection.size()); ++k) diff[k] &= ~intersection[k];
+					return countBits(diff) / (double)totDocs;
+				}
 
-						auto it = jointII.find(VidPair{ vFirst, vSecond });
-						if (it != jointII.end()) intersection = it->second;
+				// the same as `getProb` and `getJointNotProb` of each pair, with the targets looked up once for each word
+				void getPairwiseProbs(const std::vector<Vid>& words,
+					std::vector<double>& single, std::vector<double>& joint, std::vector<double>& jointNot) const
+				{
+					const size_t n = words.size();
+					std::vector<uint32_t> ts(n);
+					for (size_t i = 0; i < n; ++i) ts[i] = findTarget(words[i]);
+					single.resize(n);
+					joint.resize(n * n);
+					jointNot.resize(n * n);
+					for (size_t i = 0; i < n; ++i)
+					{
+						single[i] = ts[i] == nonTarget ? 0 : singleCnt[ts[i]] / (double)totDocs;
 					}
-					else do
+					for (size_t i = 0; i < n; ++i)
 					{
-						Vid vFirst = std::min(word2[0], word2[1]);
-						Vid vSecond = std::max(word2[0], word2[1]);
-
-						auto it = jointII.find(VidPair{ vFirst, vSecond });
-						if (it == jointII.end()) break;
-						intersection = it->second;
-						for (size_t i = (word2.size() % 2) ? 1 : 2; i < word2.size(); i += 2)
+						const uint32_t t1 = ts[i];
+						for (size_t j = 0; j < n; ++j)
 						{
-							Vid vFirst = std::min(word2[i], word2[i + 1]);
-							Vid vSecond = std::max(word2[i], word2[i + 1]);
-
-							auto it = jointII.find(VidPair{ vFirst, vSecond });
-							if (it == jointII.end()) break;
-							std::vector<DocIdType> intersectionT;
-							std::set_intersection(it->second.begin(), it->second.end(),
-								intersection.begin(), intersection.end(),
-								std::back_inserter(intersectionT)
-							);
-							intersectionT.swap(intersection);
+							const uint32_t t2 = ts[j];
+							const bool isPair = t1 != nonTarget && t2 != nonTarget && t1 != t2;
+							const size_t cnt = isPair ? this->joint(std::min(t1, t2), std::max(t1, t2)) : 0;
+							joint[i * n + j] = isPair ? cnt / (double)totDocs : 0;
+							if (t2 == nonTarget || !singleCnt[t2]) jointNot[i * n + j] = single[i];
+							else if (!isPair) jointNot[i * n + j] = 0;
+							else jointNot[i * n + j] = (singleCnt[t1] - cnt) / (double)totDocs;
 						}
-					} while (0);
-
-					if (intersection.empty()) return getProb(word1);
-					auto it = singleII.find(word1);
-					if (it == singleII.end()) return 0;
-					return std::set_difference(it->second.begin(), it->second.end(),
-						intersection.begin(), intersection.end(),
-						detail::CountIter{}
-					).count / (double)totDocs;
+					}
 				}
 			};
 
 			template<>
-			class ProbEstimator<ProbEstimation::sliding_windows, WeightedDocId>
-				: public ProbEstimator<ProbEstimation::document, WeightedDocId>
+			class ProbEstimator<ProbEstimation::sliding_windows>
+				: public ProbEstimator<ProbEstimation::document>
 			{
 				size_t windowSize = 0;
-				size_t nextDocId = 0;
-
-			public:
-				ProbEstimator() = default;
 
-				ProbEstimator(size_t _windowSize) : windowSize{ _windowSize }
+				/*
+				counts windows of a document of length `len`, whose targets occur as `posVids`. Only targets >= `firstNew` and pairs including them are counted.
+				Instead of visiting all pairs of the current window at every step, a pair is updated only when one of its words enters or leaves:
+				the number of windows counted so far is subtracted when the pair gets into the window and added back when it gets out.
+				*/
+				void countWindows(const std::vector<std::pair<uint32_t, uint32_t>>& posVids, size_t len, uint32_t firstNew)
 				{
-				}
+					const size_t numTargets = targetIdx.size();
+					std::vector<uint32_t> vidCnts(numTargets), activePos(numTargets);
+					std::vector<size_t> enteredAt(numTargets);
+					std::vector<uint32_t> active;
+					size_t cntSoFar = 0;
 
-				template<typename _TargetIter>
-				void insertDoc(_TargetIter wordFirst, _TargetIter wordLast)
-				{
-					using iter = std::pair<const Vid, size_t>*;
-					std::vector<std::pair<uint32_t, Vid>> posVids;
-					std::unordered_map<Vid, uint32_t> vidCnts;
-					size_t len = wordLast - wordFirst;
-					for (size_t i = 0; i < len; ++i)
+					auto enter = [&](uint32_t u)
 					{
-						auto it = this->singleCnt.find(wordFirst[i]);
-						if (it != this->singleCnt.end())
+						if (vidCnts[u]++) return;
+						for (auto v : active)
 						{
-							posVids.emplace_back(i, wordFirst[i]);
+							if (std::max(u, v) >= firstNew) joint(std::min(u, v), std::max(u, v)) -= cntSoFar;
 						}
-					}
+						enteredAt[u] = cntSoFar;
+						activePos[u] = (uint32_t)active.size();
+						active.emplace_back(u);
+					};
 
-					if (posVids.empty()) return;
+					auto leave = [&](uint32_t u)
+					{
+						if (--vidCnts[u]) return;
+						active[activePos[u]] = active.back();
+						activePos[active.back()] = activePos[u];
+						active.pop_back();
+						for (auto v : active)
+						{
+							if (std::max(u, v) >= firstNew) joint(std::min(u, v), std::max(u, v)) += cntSoFar;
+						}
+						if (u >= firstNew) singleCnt[u] += cntSoFar - enteredAt[u];
+					};
 
 					size_t start = 0, end = 0, cend = std::min(windowSize, len);
 					while (end < posVids.size() && posVids[end].first < windowSize)
 					{
-						vidCnts[posVids[end].second]++;
+						enter(posVids[end].second);
 						end++;
 					}
 
@@ -297,43 +408,112 @@ namespace tomoto
 						size_t startMargin = posVids[start].first - (cend - windowSize);
 						size_t endMargin = end < posVids.size() ? (posVids[end].first - cend + 1) : -1;
 						size_t cntWindows = std::min(std::min(startMargin, endMargin), len + 1 - cend);
-						for (auto& u : vidCnts)
+						if (keepPostings)
 						{
-							if (!u.second) continue;
-							this->singleII[u.first].emplace_back(nextDocId, cntWindows);
-							this->singleCnt[u.first] += cntWindows;
-							for (auto& v : vidCnts)
-							{
-								if (!v.second) continue;
-								if (u.first < v.first)
-								{
-									this->jointII[{u.first, v.first}].emplace_back(nextDocId, cntWindows);
-									this->jointCnt[{ u.first, v.first }] += cntWindows;
-								}
-							}
+							for (auto u : active) setBit(postings[u], numSegs);
+							segWeights.emplace_back((uint32_t)cntWindows);
 						}
+						cntSoFar += cntWindows;
 
 						cend += cntWindows;
 						if (startMargin < endMargin)
 						{
-							vidCnts[posVids[start].second]--;
+							leave(posVids[start].second);
 							start++;
 						}
 						else if (startMargin > endMargin)
 						{
-							vidCnts[posVids[end].second]++;
+							enter(posVids[end].second);
 							end++;
 						}
 						else
 						{
-							vidCnts[posVids[start].second]--;
-							vidCnts[posVids[end].second]++;
+							leave(posVids[start].second);
+							enter(posVids[end].second);
 							start++;
 							end++;
 						}
-						nextDocId++;
+						numSegs++;
 					}
 
+					while (!active.empty())
+					{
+						vidCnts[active.back()] = 1;
+						leave(active.back());
+					}
+				}
+
+			public:
+				ProbEstimator() = default;
+
+				ProbEstimator(size_t _windowSize, bool _keepPostings = true)
+					: ProbEstimator<ProbEstimation::document>{ _windowSize, _keepPostings }, windowSize{ _windowSize }
+				{
+				}
+
+				ProbEstimator makeShard() const
+				{
+					ProbEstimator ret{ windowSize, keepPostings };
+					ret.targetIdx = targetIdx;
+					ret.resizeCounts();
+					return ret;
+				}
+
+				using ProbEstimator<ProbEstimation::document>::insertTargets;
+
+				template<typename _TargetIter>
+				void insertTargets(_TargetIter targetFirst, _TargetIter targetLast, const CorpusIndex& index)
+				{
+					// segments depend on the whole set of targets, so postings have to be rebuilt from scratch when targets are added.
+					const bool rebuild = !totDocs || keepPostings;
+					const size_t oldT = targetIdx.size();
+					const uint32_t firstNew = rebuild ? 0 : (uint32_t)oldT;
+					insertTargets(targetFirst, targetLast);
+					if (totDocs && targetIdx.size() == oldT) return;
+
+					if (rebuild)
+					{
+						std::fill(singleCnt.begin(), singleCnt.end(), 0);
+						std::fill(jointCnt.begin(), jointCnt.end(), 0);
+						for (auto& p : postings) p.clear();
+						segWeights.clear();
+						numSegs = 0;
+					}
+					forEachIndexedDoc(index, firstNew, [&](uint32_t docId, const std::vector<std::pair<uint32_t, uint32_t>>& posVids)
+					{
+						countWindows(posVids, index.docLen(docId), firstNew);
+					});
+
+					// as in `insertDoc`, only windows of documents containing any target are counted
+					std::unordered_set<uint32_t> docsWithTargets;
+					totDocs = 0;
+					for (auto& p : targetIdx)
+					{
+						auto occ = index.getOccurrences(p.first);
+						for (size_t i = 0; i < occ.size; ++i)
+						{
+							if (!docsWithTargets.emplace(occ.docs[i]).second) continue;
+							totDocs += std::max(index.docLen(occ.docs[i]), windowSize) - windowSize + 1;
+						}
+					}
+				}
+
+				template<typename _TargetIter>
+				void insertDoc(_TargetIter wordFirst, _TargetIter wordLast)
+				{
+					std::vector<std::pair<uint32_t, uint32_t>> posVids;
+					size_t len = wordLast - wordFirst;
+					for (size_t i = 0; i < len; ++i)
+					{
+						auto t = findTarget(wordFirst[i]);
+						if (t != nonTarget)
+						{
+							posVids.emplace_back(i, t);
+						}
+					}
+
+					if (posVids.empty()) return;
+					countWindows(posVids, len, 0);
 					this->totDocs += std::max(len, windowSize) - windowSize + 1;
 				}
 			};
@@ -344,17 +524,17 @@ namespace tomoto
 		class ProbEstimator;
 
 		template<>
-		class ProbEstimator<ProbEstimation::document> : public detail::ProbEstimator<ProbEstimation::document, size_t>
+		class ProbEstimator<ProbEstimation::document> : public detail::ProbEstimator<ProbEstimation::document>
 		{
 		public:
-			using detail::ProbEstimator<ProbEstimation::document, size_t>::ProbEstimator;
+			using detail::ProbEstimator<ProbEstimation::document>::ProbEstimator;
 		};
 
 		template<>
-		class ProbEstimator<ProbEstimation::sliding_windows> : public detail::ProbEstimator<ProbEstimation::sliding_windows, detail::WeightedDocId>
+		class ProbEstimator<ProbEstimation::sliding_windows> : public detail::ProbEstimator<ProbEstimation::sliding_windows>
 		{
 		public:
-			using detail::ProbEstimator<ProbEstimation::sliding_windows, detail::WeightedDocId>::ProbEstimator;
+			using detail::ProbEstimator<ProbEstimation::sliding_windows>::ProbEstimator;
 		};
 	}
 }
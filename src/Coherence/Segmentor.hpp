@@ -88,7 +88,7 @@ namespace tomoto
 				double n = 0;
 				for (auto it1 = wordFirst; it1 != wordLast; ++it1)
 				{
-					for (auto it2 = it1 + 1; it2 == wordLast; ++it2)
+					for (auto it2 = it1 + 1; it2 != wordLast; ++it2)
 					{
 						ret += cm(pe, *it1, *it2);
 						n += 1;
@@ -149,5 +149,26 @@ namespace tomoto
 				return ret / n;
 			}
 		};
+
+		// scores `words` with the segmentation `seg` given at runtime
+		template<typename _CMFunc>
+		double scoreSegments(Segmentation seg, const _CMFunc& cm, const IProbEstimator* pe, const std::vector<Vid>& words)
+		{
+			switch (seg)
+			{
+			case Segmentation::one_one:
+				return makeSegmentor<Segmentation::one_one>(cm, pe)(words.begin(), words.end());
+			case Segmentation::one_pre:
+				return makeSegmentor<Segmentation::one_pre>(cm, pe)(words.begin(), words.end());
+			case Segmentation::one_suc:
+				return makeSegmentor<Segmentation::one_suc>(cm, pe)(words.begin(), words.end());
+			case Segmentation::one_all:
+				return makeSegmentor<Segmentation::one_all>(cm, pe)(words.begin(), words.end());
+			case Segmentation::one_set:
+				return makeSegmentor<Segmentation::one_set>(cm, pe)(words.begin(), words.end());
+			default:
+				throw std::invalid_argument{ "invalid Segmentation `seg`" };
+			}
+		}
 	}
 }
@@ -152,10 +152,14 @@ std::vector<Candidate> tomoto::label::PMIBEExtractor::extract(const ITopicModel*
 {
 	auto& vocabFreqs = tm->getVocabCf();
 	auto& vocabDf = tm->getVocabDf();
+	PoolManager::Lease pool;
+	if (numWorkers > 1) pool = PoolManager::getInstance().borrow(numWorkers);
+	// a node of the trie takes about the size of itself and of an entry of the map of its parent
+	const size_t bytesPerNode = sizeof(TrieEx<Vid, size_t>) + 48;
 	auto candidates = phraser::extractPMIBENgrams(DocIterator{ tm, 0 }, DocIterator{ tm, tm->getNumDocs() },
 		vocabFreqs, vocabDf,
 		candMinCnt, candMinDf, minLabelLen, maxLabelLen, maxCandidates, 
-		0.f, 0.f
+		0.f, 0.f, pool.get(), memoryLimit / bytesPerNode
 	);
 	if (minLabelLen <= 1)
 	{
@@ -170,50 +174,53 @@ std::vector<Candidate> tomoto::label::PMIBEExtractor::extract(const ITopicModel*
 }
 
 
-template<bool _lock>
-const Eigen::ArrayXi& FoRelevance::updateContext(size_t docId, const tomoto::DocumentBase* doc, const tomoto::Trie<tomoto::Vid, size_t>* root)
+void FoRelevance::updateContext(size_t docId, const tomoto::DocumentBase* doc, const tomoto::FrozenTrie<tomoto::Vid, size_t>& trie,
+	Eigen::ArrayXi& df, std::vector<size_t>& lastDoc, std::vector<std::vector<CandidateMatch>>& matches)
 {
-	thread_local Eigen::ArrayXi bdf(tm->getV());
-	bdf.setZero();
-	auto node = root;
+	constexpr uint32_t npos = FrozenTrie<Vid, size_t>::npos;
+	uint32_t node = 0;
 	for (size_t j = 0; j < doc->words.size(); ++j)
 	{
 		tomoto::Vid curWord = doc->words[doc->wOrder.empty() ? j : doc->wOrder[j]];
-		if (curWord < tm->getV()) bdf[curWord] = 1;
-		auto nnode = node->getNext(curWord);
-		while (!nnode)
+		if (curWord < tm->getV() && lastDoc[curWord] != docId)
 		{
-			node = node->getFail();
-			if (node) nnode = node->getNext(curWord);
+			lastDoc[curWord] = docId;
+			df[curWord]++;
+		}
+		auto nnode = trie.getNext(node, curWord);
+		while (nnode == npos)
+		{
+			node = trie.getFail(node);
+			if (node != npos) nnode = trie.getNext(node, curWord);
 			else break;
 		}
 
-		if (nnode)
+		if (nnode != npos)
 		{
 			node = nnode;
 			do
 			{
 				// the matched candidate is found
-				if (nnode->val && nnode->val != (size_t)-1)
+				const size_t val = trie[nnode].val;
+				if (val && val != (size_t)-1)
 				{
-					tomoto::OptionalLock<_lock> lock{ mtx[(nnode->val - 1) % (pool ? pool->getNumWorkers() : 1)] };
-					auto& c = candidates[nnode->val - 1];
+					const size_t candId = val - 1;
+					auto& c = candidates[candId];
+					CandidateMatch m{ (uint32_t)candId, (uint32_t)docId, 0, 0 };
 					if (c.name.empty() && !doc->origWordPos.empty())
 					{
-						size_t start = doc->origWordPos[j + 1 - c.w.size()];
-						size_t end = doc->origWordPos[j] + doc->origWordLen[j];
-						c.names[doc->rawStr.substr(start, end - start)]++;
+						m.start = doc->origWordPos[j + 1 - c.w.size()];
+						m.end = doc->origWordPos[j] + doc->origWordLen[j];
 					}
-					c.docIds.emplace(docId);
+					matches[candId % matches.size()].emplace_back(m);
 				}
-			} while (nnode = nnode->getFail());
+			} while ((nnode = trie.getFail(nnode)) != npos);
 		}
 		else
 		{
-			node = root;
+			node = 0;
 		}
 	}
-	return bdf;
 }
 
 void FoRelevance::estimateContexts()
@@ -235,34 +242,97 @@ void FoRelevance::estimateContexts()
 		});
 	}
 	root.fillFail();
+	const FrozenTrie<Vid, size_t> trie{ root };
+	candTrie = {};
+
+	const size_t V = tm->getV();
+	const size_t numWorkers = pool ? pool->getNumWorkers() : 1;
 
-	Eigen::ArrayXi df = Eigen::ArrayXi::Zero(tm->getV());
+	// buffers of each worker, which are touched only at the words present in the documents being processed
+	struct ContextBuffer
+	{
+		Eigen::ArrayXi df, bdf, wc;
+		std::vector<size_t> lastDoc, enteredAt;
+		std::vector<Vid> touched;
+		std::vector<std::vector<CandidateMatch>> matches;
+	};
+	std::vector<ContextBuffer> bufs(numWorkers);
+	for (auto& buf : bufs) buf.matches.resize(numWorkers);
 
 	if (pool)
 	{
 		const size_t groups = pool->getNumWorkers() * 4;
-		std::vector<std::future<Eigen::ArrayXi>> futures;
+		std::vector<std::future<void>> futures;
 		futures.reserve(groups);
 		for (size_t g = 0; g < groups; ++g)
 		{
-			futures.emplace_back(pool->enqueue([&, groups](size_t, size_t g)
+			futures.emplace_back(pool->enqueue([&, groups](size_t threadId, size_t g)
 			{
-				Eigen::ArrayXi pdf = Eigen::ArrayXi::Zero(tm->getV());
+				auto& buf = bufs[threadId];
+				if (!buf.df.size())
+				{
+					buf.df = Eigen::ArrayXi::Zero(V);
+					buf.lastDoc.resize(V, (size_t)-1);
+				}
 				for (size_t i = g; i < tm->getNumDocs(); i += groups)
 				{
-					pdf += updateContext<true>(i, tm->getDoc(i), &root);
+					updateContext(i, tm->getDoc(i), trie, buf.df, buf.lastDoc, buf.matches);
 				}
-				return pdf;
 			}, g));
 		}
-		for (auto& f : futures) df += f.get();
+		for (auto& f : futures) f.get();
 	}
 	else
 	{
+		bufs[0].df = Eigen::ArrayXi::Zero(V);
+		bufs[0].lastDoc.resize(V, (size_t)-1);
 		for (size_t i = 0; i < tm->getNumDocs(); ++i)
 		{
-			df += updateContext<false>(i, tm->getDoc(i), &root);
+			updateContext(i, tm->getDoc(i), trie, bufs[0].df, bufs[0].lastDoc, bufs[0].matches);
+		}
+	}
+
+	// matches are partitioned by candidate id, so each partition is merged into its own candidates without locking
+	auto mergeMatches = [&](size_t part)
+	{
+		for (auto& buf : bufs)
+		{
+			for (auto& m : buf.matches[part])
+			{
+				auto& c = candidates[m.candId];
+				if (m.end > m.start)
+				{
+					c.names[tm->getDoc(m.docId)->rawStr.substr(m.start, m.end - m.start)]++;
+				}
+				c.docIds.emplace(m.docId);
+			}
+			buf.matches[part] = std::vector<CandidateMatch>{};
+		}
+	};
+
+	if (pool)
+	{
+		std::vector<std::future<void>> futures;
+		for (size_t part = 0; part < numWorkers; ++part)
+		{
+			futures.emplace_back(pool->enqueue([&](size_t, size_t part)
+			{
+				mergeMatches(part);
+			}, part));
 		}
+		for (auto& f : futures) f.get();
+	}
+	else
+	{
+		mergeMatches(0);
+	}
+
+	Eigen::ArrayXi df = Eigen::ArrayXi::Zero(V);
+	for (auto& buf : bufs)
+	{
+		if (buf.df.size()) df += buf.df;
+		buf.df = Eigen::ArrayXi{};
+		buf.lastDoc = std::vector<size_t>{};
 	}
 
 	Matrix wordTopicDist{ tm->getV(), tm->getK() };
@@ -272,6 +342,16 @@ void FoRelevance::estimateContexts()
 		wordTopicDist.col(i) = Eigen::Map<Vector>{ dist.data(), (Eigen::Index)dist.size() };
 	}
 
+	/*
+	The score of a candidate is sum_w wordTopicDist[w] * log((wc[w] + smoothing) * totDocCnt / docCnt / df[w]),
+	where wc[w] is the number of contexts of the candidate containing w, which is zero for most words.
+	So it is split into the terms independent of wc, computed once here,
+	and sum_w wordTopicDist[w] * (log(wc[w] + smoothing) - log(smoothing)) over only the words with nonzero wc.
+	*/
+	const Eigen::Array<Float, -1, 1> topicWordSum = wordTopicDist.colwise().sum().transpose().array();
+	const Eigen::Array<Float, -1, 1> topicLogDf = (wordTopicDist.transpose() * df.cast<Float>().log().matrix()).array();
+	const Float logSmoothing = std::log(smoothing);
+
 	size_t totDocCnt = 0;
 	if (windowSize == (size_t)-1)
 	{
@@ -287,7 +367,7 @@ void FoRelevance::estimateContexts()
 		}
 	}
 
-	auto calcScores = [&](CandidateEx& c, size_t windowSize)
+	auto calcScores = [&](CandidateEx& c, ContextBuffer& buf)
 	{
 		if (c.docIds.size() < candMinDf) return;
 		if (c.name.empty() && !c.names.empty())
@@ -303,30 +383,66 @@ void FoRelevance::estimateContexts()
 			}
 		}
 
-		size_t docCnt = 0;
-		Vector wcPMI = Vector::Zero(this->tm->getV());
+		if (!buf.bdf.size())
+		{
+			buf.bdf = Eigen::ArrayXi::Zero(V);
+			buf.wc = Eigen::ArrayXi::Zero(V);
+			buf.enteredAt.resize(V);
+		}
+
+		// a word present in the window since the `enteredAt`-th context gets the contexts counted until it leaves
+		size_t docCnt = 0, cntSoFar = 0;
+		auto addCnt = [&](Vid word, size_t cnt)
+		{
+			if (!cnt) return;
+			if (!buf.wc[word]) buf.touched.emplace_back(word);
+			buf.wc[word] += cnt;
+		};
+		auto enter = [&](Vid word)
+		{
+			if (word >= V) return;
+			if (!buf.bdf[word]++) buf.enteredAt[word] = cntSoFar;
+		};
+		auto leave = [&](Vid word)
+		{
+			if (word >= V) return;
+			if (!--buf.bdf[word]) addCnt(word, cntSoFar - buf.enteredAt[word]);
+		};
+
 		for (auto& docId : c.docIds)
 		{
-			thread_local Eigen::VectorXi bdf(this->tm->getV());
-			bdf.setZero();
 			auto doc = this->tm->getDoc(docId);
+			auto wordAt = [&](size_t i)
+			{
+				return doc->words[doc->wOrder.empty() ? i : doc->wOrder[i]];
+			};
+
 			if (doc->words.size() <= windowSize)
 			{
 				for (size_t i = 0; i < doc->words.size(); ++i)
 				{
-					if (doc->words[i] < this->tm->getV()) bdf[doc->words[i]] = 1;
+					Vid word = doc->words[i];
+					if (word < V && !buf.bdf[word])
+					{
+						buf.bdf[word] = 1;
+						addCnt(word, 1);
+					}
+				}
+				for (size_t i = 0; i < doc->words.size(); ++i)
+				{
+					if (doc->words[i] < V) buf.bdf[doc->words[i]] = 0;
 				}
 				docCnt++;
-				wcPMI += bdf.template cast<Float>();
 			}
 			else
 			{
+				cntSoFar = 0;
 				auto wit = c.w.begin();
 				std::deque<size_t> wpos;
 				for (size_t i = 0; i < windowSize; ++i)
 				{
-					Vid word = doc->words[doc->wOrder.empty() ? i : doc->wOrder[i]];
-					if (word < this->tm->getV()) bdf[word]++;
+					Vid word = wordAt(i);
+					enter(word);
 
 					if (word == *wit)
 					{
@@ -342,15 +458,15 @@ void FoRelevance::estimateContexts()
 				if (!wpos.empty())
 				{
 					docCnt++;
-					wcPMI += Eigen::bool2float(bdf.array()).matrix();
+					cntSoFar++;
 				}
 
 				for (size_t i = windowSize; i < doc->words.size(); ++i)
 				{
-					Vid oword = doc->words[doc->wOrder.empty() ? (i - windowSize) : doc->wOrder[i - windowSize]];
-					Vid word = doc->words[doc->wOrder.empty() ? i : doc->wOrder[i]];
-					if (oword < this->tm->getV()) bdf[oword]--;
-					if (word < this->tm->getV()) bdf[word]++;
+					Vid oword = wordAt(i - windowSize);
+					Vid word = wordAt(i);
+					leave(oword);
+					enter(word);
 					if (!wpos.empty() && wpos.front() - c.w.size() <= i - windowSize)
 					{
 						wpos.pop_front();
@@ -370,13 +486,24 @@ void FoRelevance::estimateContexts()
 					if (!wpos.empty())
 					{
 						docCnt++;
-						wcPMI += Eigen::bool2float(bdf.array()).matrix();
+						cntSoFar++;
 					}
 				}
+
+				for (size_t i = doc->words.size() - windowSize; i < doc->words.size(); ++i)
+				{
+					leave(wordAt(i));
+				}
 			}
 		}
-		c.scores = wordTopicDist.transpose() *
-			((wcPMI.array() + smoothing) * totDocCnt / docCnt / df.cast<Float>()).log().matrix();
+
+		c.scores = topicWordSum * std::log(smoothing * totDocCnt / docCnt) - topicLogDf;
+		for (auto word : buf.touched)
+		{
+			c.scores += wordTopicDist.row(word).transpose().array() * (std::log(buf.wc[word] + smoothing) - logSmoothing);
+			buf.wc[word] = 0;
+		}
+		buf.touched.clear();
 	};
 
 	if (pool)
@@ -386,11 +513,11 @@ void FoRelevance::estimateContexts()
 		futures.reserve(groups);
 		for (size_t g = 0; g < groups; ++g)
 		{
-			futures.emplace_back(pool->enqueue([&, groups](size_t, size_t g)
+			futures.emplace_back(pool->enqueue([&, groups](size_t threadId, size_t g)
 			{
 				for (size_t i = g; i < candidates.size(); i += groups)
 				{
-					calcScores(candidates[i], windowSize);
+					calcScores(candidates[i], bufs[threadId]);
 				}
 			}, g));
 		}
@@ -400,7 +527,7 @@ void FoRelevance::estimateContexts()
 	{
 		for (auto& c : candidates)
 		{
-			calcScores(c, windowSize);
+			calcScores(c, bufs[0]);
 		}
 	}
 
@@ -410,14 +537,13 @@ void FoRelevance::estimateContexts()
 		if (c.docIds.size() >= candMinDf) filtered.emplace_back(std::move(c));
 	}
 	filtered.swap(candidates);
-}
-
-std::vector<std::pair<std::string, float>> FoRelevance::getLabels(tomoto::Tid tid, size_t topK) const
-{
-	std::vector<std::pair<std::string, float>> scores;
 
-	for (auto& c : candidates)
+	const size_t K = tm->getK();
+	labelNames.clear();
+	relevance = Matrix::Zero(K, candidates.size());
+	for (size_t i = 0; i < candidates.size(); ++i)
 	{
+		auto& c = candidates[i];
 		std::string labels = c.name;
 		if (labels.empty())
 		{
@@ -428,14 +554,81 @@ std::vector<std::pair<std::string, float>> FoRelevance::getLabels(tomoto::Tid ti
 			}
 			labels.pop_back();
 		}
-		float s = c.scores[tid] * (1 + mu / (tm->getK() - 1)) - c.scores.sum() * mu / (tm->getK() - 1);
-		scores.emplace_back(labels, s);
+		labelNames.emplace_back(std::move(labels));
+		relevance.col(i) = c.scores.matrix();
+	}
+	// penalize candidates relevant to the other topics as well: (1 + mu / (K - 1)) * score - mu / (K - 1) * sum of scores
+	Eigen::Matrix<Float, 1, -1> scoreSum = relevance.colwise().sum();
+	relevance = (relevance * (1 + mu / (K - 1))).rowwise() - scoreSum * (mu / (K - 1));
+}
+
+std::vector<std::pair<size_t, tomoto::Float>> FoRelevance::selectTop(tomoto::Tid tid, size_t topK) const
+{
+	std::vector<std::pair<size_t, Float>> scores;
+	scores.reserve(relevance.cols());
+	for (size_t i = 0; i < (size_t)relevance.cols(); ++i)
+	{
+		scores.emplace_back(i, relevance(tid, i));
 	}
 
-	std::sort(scores.begin(), scores.end(), [](const std::pair<std::string, float>& a, const std::pair<std::string, float>& b)
+	auto mid = scores.begin() + std::min(topK, scores.size());
+	std::partial_sort(scores.begin(), mid, scores.end(), [](const std::pair<size_t, Float>& a, const std::pair<size_t, Float>& b)
 	{
 		return a.second > b.second;
 	});
-	if (scores.size() > topK) scores.erase(scores.begin() + topK, scores.end());
+	scores.erase(mid, scores.end());
 	return scores;
 }
+
+std::vector<std::pair<std::string, float>> FoRelevance::getLabels(tomoto::Tid tid, size_t topK) const
+{
+	std::vector<std::pair<size_t, Float>> top;
+	{
+		std::lock_guard<std::mutex> lock{ cacheMtx };
+		if (topK <= cachedTopK && tid < cachedTop.size()) top.assign(cachedTop[tid].begin(), cachedTop[tid].begin() + std::min(topK, cachedTop[tid].size()));
+	}
+	if (top.empty() && topK) top = selectTop(tid, topK);
+
+	std::vector<std::pair<std::string, float>> ret;
+	for (auto& p : top) ret.emplace_back(labelNames[p.first], p.second);
+	return ret;
+}
+
+std::vector<std::vector<std::pair<std::string, float>>> FoRelevance::getAllLabels(size_t numTopics, size_t topK) const
+{
+	numTopics = std::min(numTopics, (size_t)relevance.rows());
+	{
+		std::lock_guard<std::mutex> lock{ cacheMtx };
+		if (topK > cachedTopK)
+		{
+			cachedTop.resize(relevance.rows());
+			if (pool)
+			{
+				std::vector<std::future<void>> futures;
+				for (size_t k = 0; k < cachedTop.size(); ++k)
+				{
+					futures.emplace_back(pool->enqueue([&](size_t, size_t k)
+					{
+						cachedTop[k] = selectTop((Tid)k, topK);
+					}, k));
+				}
+				for (auto& f : futures) f.get();
+			}
+			else
+			{
+				for (size_t k = 0; k < cachedTop.size(); ++k) cachedTop[k] = selectTop((Tid)k, topK);
+			}
+			cachedTopK = topK;
+		}
+	}
+
+	std::vector<std::vector<std::pair<std::string, float>>> ret(numTopics);
+	for (size_t k = 0; k < numTopics; ++k)
+	{
+		for (size_t i = 0; i < std::min(topK, cachedTop[k].size()); ++i)
+		{
+			ret[k].emplace_back(labelNames[cachedTop[k][i].first], cachedTop[k][i].second);
+		}
+	}
+	return ret;
+}
@@ -35,14 +35,22 @@ namespace tomoto
 			std::vector<Candidate> extract(const ITopicModel* tm) const override;
 		};
 
+		/*
+		`numWorkers` threads count n-grams in both directions at once.
+		If `memoryLimit` (in bytes) is not zero, the tries of n-gram counts are pruned of low-count branches while counting
+		so that they stay roughly within it, at the cost of undercounting rare n-grams.
+		*/
 		class PMIBEExtractor : public IExtractor
 		{
 			size_t candMinCnt, candMinDf, minLabelLen, maxLabelLen, maxCandidates;
+			size_t numWorkers, memoryLimit;
 		public:
 			PMIBEExtractor(size_t _candMinCnt = 10, size_t _candMinDf = 2, 
-				size_t _minLabelLen = 1, size_t _maxLabelLen = 5, size_t _maxCandidates = 1000
+				size_t _minLabelLen = 1, size_t _maxLabelLen = 5, size_t _maxCandidates = 1000,
+				size_t _numWorkers = 1, size_t _memoryLimit = 0
 			)
-				: candMinCnt{ _candMinCnt }, candMinDf{ _candMinDf }, minLabelLen{ _minLabelLen }, maxLabelLen{ _maxLabelLen }, maxCandidates{ _maxCandidates }
+				: candMinCnt{ _candMinCnt }, candMinDf{ _candMinDf }, minLabelLen{ _minLabelLen }, maxLabelLen{ _maxLabelLen }, maxCandidates{ _maxCandidates },
+				numWorkers{ _numWorkers }, memoryLimit{ _memoryLimit }
 			{
 			}
 
@@ -67,19 +75,37 @@ namespace tomoto
 				}
 			};
 
+			// a candidate found in a document. [start, end) is the span of its surface form in the raw text, empty if it is not needed.
+			struct CandidateMatch
+			{
+				uint32_t candId, docId, start, end;
+			};
+
 			const ITopicModel* tm;
 			size_t candMinDf;
 			float smoothing, lambda, mu;
 			size_t windowSize;
-			std::unique_ptr<ThreadPool> pool;
-			std::unique_ptr<std::mutex[]> mtx;
+			PoolManager::Lease pool;
 			std::vector<CandidateEx> candidates;
+			std::vector<std::string> labelNames;
+			Matrix relevance; // K x candidates, the first-order relevance of each candidate for each topic
 
-			template<bool _lock>
-			const Eigen::ArrayXi& updateContext(size_t docId, const tomoto::DocumentBase* doc, const Trie<Vid, size_t>* root);
+			// top labels of all topics as (candidate index, relevance), computed at most once for each `cachedTopK`
+			mutable std::mutex cacheMtx;
+			mutable size_t cachedTopK = 0;
+			mutable std::vector<std::vector<std::pair<size_t, Float>>> cachedTop;
+
+			/*
+			finds candidates in `doc` and adds the words of `doc` to `df`, where `lastDoc` marks words already counted for the document.
+			Matches are appended to `matches[candId % matches.size()]` and merged into candidates afterwards.
+			*/
+			void updateContext(size_t docId, const tomoto::DocumentBase* doc, const FrozenTrie<Vid, size_t>& trie,
+				Eigen::ArrayXi& df, std::vector<size_t>& lastDoc, std::vector<std::vector<CandidateMatch>>& matches);
 
 			void estimateContexts();
 
+			std::vector<std::pair<size_t, Float>> selectTop(Tid tid, size_t topK) const;
+
 		public:
 			template<typename _Iter>
 			FoRelevance(const ITopicModel* _tm,
@@ -93,8 +119,7 @@ namespace tomoto
 				if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
 				if (numWorkers > 1)
 				{
-					pool = std::make_unique<ThreadPool>(numWorkers);
-					mtx = std::make_unique<std::mutex[]>(numWorkers);
+					pool = PoolManager::getInstance().borrow(numWorkers);
 				}
 
 				for (; candFirst != candEnd; ++candFirst)
@@ -106,6 +131,8 @@ namespace tomoto
 			}
 
 			std::vector<std::pair<std::string, float>> getLabels(Tid tid, size_t topK = 10) const override;
+
+			std::vector<std::vector<std::pair<std::string, float>>> getAllLabels(size_t numTopics, size_t topK = 10) const override;
 		};
 	}
 }
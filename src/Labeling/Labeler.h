@@ -46,6 +46,15 @@ namespace tomoto
 		{
 		public:
 			virtual std::vector<std::pair<std::string, float>> getLabels(Tid tid, size_t topK = 10) const = 0;
+
+			// returns the top-K labels of every topic, where the i-th element is the one of the topic `i`
+			virtual std::vector<std::vector<std::pair<std::string, float>>> getAllLabels(size_t numTopics, size_t topK = 10) const
+			{
+				std::vector<std::vector<std::pair<std::string, float>>> ret;
+				for (size_t k = 0; k < numTopics; ++k) ret.emplace_back(getLabels((Tid)k, topK));
+				return ret;
+			}
+
 			virtual ~ILabeler() {}
 		};
 	}
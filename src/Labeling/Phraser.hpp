@@ -3,6 +3,7 @@
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <atomic>
 #include "Labeler.h"
 #include "../Utils/Trie.hpp"
 
@@ -23,25 +24,166 @@ namespace tomoto
 
 		namespace detail
 		{
-			struct vvhash
+			// packs a bigram into one integer, whose order is the same as the one of `std::pair<Vid, Vid>`
+			inline uint64_t packPair(Vid a, Vid b)
 			{
-				size_t operator()(const std::pair<Vid, Vid>& k) const
+				return ((uint64_t)a << 32) | b;
+			}
+
+			inline std::pair<Vid, Vid> unpackPair(uint64_t key)
+			{
+				return std::make_pair((Vid)(key >> 32), (Vid)key);
+			}
+
+			inline uint64_t mixHash(uint64_t x)
+			{
+				x ^= x >> 30;
+				x *= 0xbf58476d1ce4e5b9ull;
+				x ^= x >> 27;
+				x *= 0x94d049bb133111ebull;
+				x ^= x >> 31;
+				return x;
+			}
+
+			struct BigramCount
+			{
+				size_t cf = 0, df = 0;
+			};
+
+			/*
+			Open addressing hash table from packed bigrams to their counts.
+			It takes 24 bytes per slot, which is a fraction of a node of `std::map` or `btree::map` with two of them.
+			*/
+			class BigramCountTable
+			{
+				static constexpr uint64_t emptyKey = (uint64_t)-1; // (non_vocab_id, non_vocab_id) is never counted
+				std::vector<uint64_t> keys;
+				std::vector<BigramCount> vals;
+				size_t filled = 0;
+
+				size_t slotOf(uint64_t key) const
+				{
+					return mixHash(key) & (keys.size() - 1);
+				}
+
+				void grow()
+				{
+					std::vector<uint64_t> oldKeys(std::max(keys.size() * 2, (size_t)1024), (uint64_t)emptyKey);
+					std::vector<BigramCount> oldVals(oldKeys.size());
+					oldKeys.swap(keys);
+					oldVals.swap(vals);
+					for (size_t i = 0; i < oldKeys.size(); ++i)
+					{
+						if (oldKeys[i] == emptyKey) continue;
+						size_t j = slotOf(oldKeys[i]);
+						while (keys[j] != emptyKey) j = (j + 1) & (keys.size() - 1);
+						keys[j] = oldKeys[i];
+						vals[j] = oldVals[i];
+					}
+				}
+
+			public:
+				BigramCount& operator[](uint64_t key)
+				{
+					if ((filled + 1) * 4 > keys.size() * 3) grow();
+					size_t i = slotOf(key);
+					while (keys[i] != key)
+					{
+						if (keys[i] == emptyKey)
+						{
+							keys[i] = key;
+							filled++;
+							break;
+						}
+						i = (i + 1) & (keys.size() - 1);
+					}
+					return vals[i];
+				}
+
+				size_t size() const
+				{
+					return filled;
+				}
+
+				template<typename _Fn>
+				void forEach(_Fn&& fn) const
+				{
+					for (size_t i = 0; i < keys.size(); ++i)
+					{
+						if (keys[i] != emptyKey) fn(keys[i], vals[i]);
+					}
+				}
+
+				void merge(BigramCountTable&& o)
 				{
-					return std::hash<Vid>{}(k.first) ^ std::hash<Vid>{}(k.second);
+					if (o.filled > filled) std::swap(*this, o);
+					o.forEach([&](uint64_t key, const BigramCount& c)
+					{
+						auto& d = (*this)[key];
+						d.cf += c.cf;
+						d.df += c.df;
+					});
 				}
 			};
+
+			/*
+			Count-min sketch of bigram frequencies, shared by all workers.
+			Every cell stops increasing once it reaches `cap`, so `mayReach(key)` is true for all bigrams occurring `cap` times or more.
+			It is used for discarding rare bigrams before they are inserted into `BigramCountTable`.
+			*/
+			class BigramSketch
+			{
+				static constexpr size_t depth = 4;
+				std::unique_ptr<std::atomic<uint32_t>[]> cells;
+				size_t width;
+				uint32_t cap;
+
+				size_t cellOf(uint64_t key, size_t row) const
+				{
+					return row * width + (mixHash(key + row * 0x9e3779b97f4a7c15ull) & (width - 1));
+				}
+
+			public:
+				BigramSketch(size_t _width, size_t _cap)
+					: cells{ new std::atomic<uint32_t>[_width * depth] }, width{ _width }, cap{ (uint32_t)std::min(_cap, (size_t)UINT32_MAX / 2) }
+				{
+					for (size_t i = 0; i < width * depth; ++i) cells[i].store(0, std::memory_order_relaxed);
+				}
+
+				void add(uint64_t key)
+				{
+					for (size_t r = 0; r < depth; ++r)
+					{
+						auto& c = cells[cellOf(key, r)];
+						if (c.load(std::memory_order_relaxed) < cap) c.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+
+				bool mayReach(uint64_t key) const
+				{
+					for (size_t r = 0; r < depth; ++r)
+					{
+						if (cells[cellOf(key, r)].load(std::memory_order_relaxed) < cap) return false;
+					}
+					return true;
+				}
+			};
+
+			// the minimum number of tokens from which bigrams are prefiltered by `BigramSketch`
+			static constexpr size_t sketchMinTokens = (size_t)1 << 22;
 		}
 
 		template<typename _DocIter>
-		void countUnigrams(std::vector<size_t>& unigramCf, std::vector<size_t>& unigramDf,
+		void countUnigramsSerial(std::vector<size_t>& unigramCf, std::vector<size_t>& unigramDf,
 			_DocIter docBegin, _DocIter docEnd
 		)
 		{
+			std::unordered_set<Vid> uniqs;
 			for (auto docIt = docBegin; docIt != docEnd; ++docIt)
 			{
 				auto doc = *docIt;
 				if (!doc.size()) continue;
-				std::unordered_set<Vid> uniqs;
+				uniqs.clear();
 				for (size_t i = 0; i < doc.size(); ++i)
 				{
 					if (doc[i] == non_vocab_id) continue;
@@ -53,9 +195,64 @@ namespace tomoto
 			}
 		}
 
+		template<typename _DocIter>
+		void countUnigrams(std::vector<size_t>& unigramCf, std::vector<size_t>& unigramDf,
+			_DocIter docBegin, _DocIter docEnd,
+			ThreadPool* pool = nullptr
+		)
+		{
+			if (pool && pool->getNumWorkers() > 1)
+			{
+				std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>> localdata(pool->getNumWorkers());
+				std::vector<std::future<void>> futures;
+				const size_t stride = pool->getNumWorkers() * 8;
+				auto docIt = docBegin;
+				for (size_t i = 0; i < stride && docIt != docEnd; ++i, ++docIt)
+				{
+					futures.emplace_back(pool->enqueue([&, docIt, stride](size_t tid)
+					{
+						auto& l = localdata[tid];
+						if (l.first.empty())
+						{
+							l.first.resize(unigramCf.size());
+							l.second.resize(unigramDf.size());
+						}
+						countUnigramsSerial(l.first, l.second, makeStrideIter(docIt, stride, docEnd), makeStrideIter(docEnd, stride, docEnd));
+					}));
+				}
+				for (auto& f : futures) f.get();
+
+				for (auto& l : localdata)
+				{
+					if (l.first.empty()) continue;
+					for (size_t i = 0; i < unigramCf.size(); ++i) unigramCf[i] += l.first[i];
+					for (size_t i = 0; i < unigramDf.size(); ++i) unigramDf[i] += l.second[i];
+				}
+				return;
+			}
+
+			countUnigramsSerial(unigramCf, unigramDf, docBegin, docEnd);
+		}
+
+		template<typename _Doc, typename _Freqs, typename _Fn>
+		void forEachBigram(const _Doc& doc, _Freqs&& vocabFreqs, _Freqs&& vocabDf,
+			size_t candMinCnt, size_t candMinDf, _Fn&& fn
+		)
+		{
+			Vid prevWord = doc[0];
+			bool prevValid = prevWord != non_vocab_id && vocabFreqs[prevWord] >= candMinCnt && vocabDf[prevWord] >= candMinDf;
+			for (size_t j = 1; j < doc.size(); ++j)
+			{
+				Vid curWord = doc[j];
+				bool curValid = curWord != non_vocab_id && vocabFreqs[curWord] >= candMinCnt && vocabDf[curWord] >= candMinDf;
+				if (prevValid && curValid) fn(detail::packPair(prevWord, curWord));
+				prevWord = curWord;
+				prevValid = curValid;
+			}
+		}
+
 		template<typename _DocIter, typename _Freqs>
-		void countBigrams(map<std::pair<Vid, Vid>, size_t>& bigramCf,
-			map<std::pair<Vid, Vid>, size_t>& bigramDf,
+		void sketchBigrams(detail::BigramSketch& sketch,
 			_DocIter docBegin, _DocIter docEnd,
 			_Freqs&& vocabFreqs, _Freqs&& vocabDf,
 			size_t candMinCnt, size_t candMinDf
@@ -63,33 +260,90 @@ namespace tomoto
 		{
 			for (auto docIt = docBegin; docIt != docEnd; ++docIt)
 			{
-				std::unordered_set<std::pair<Vid, Vid>, detail::vvhash> uniqBigram;
 				auto doc = *docIt;
 				if (!doc.size()) continue;
-				Vid prevWord = doc[0];
-				for (size_t j = 1; j < doc.size(); ++j)
+				forEachBigram(doc, vocabFreqs, vocabDf, candMinCnt, candMinDf, [&](uint64_t key)
 				{
-					Vid curWord = doc[j];
-					if (curWord != non_vocab_id && vocabFreqs[curWord] >= candMinCnt && vocabDf[curWord] >= candMinDf)
-					{
-						if (prevWord != non_vocab_id && vocabFreqs[prevWord] >= candMinCnt && vocabDf[prevWord] >= candMinDf)
-						{
-							bigramCf[std::make_pair(prevWord, curWord)]++;
-							uniqBigram.emplace(prevWord, curWord);
-						}
-					}
-					prevWord = curWord;
+					sketch.add(key);
+				});
+			}
+		}
+
+		template<typename _DocIter, typename _Freqs>
+		void countBigrams(detail::BigramCountTable& bigrams,
+			_DocIter docBegin, _DocIter docEnd,
+			_Freqs&& vocabFreqs, _Freqs&& vocabDf,
+			size_t candMinCnt, size_t candMinDf,
+			const detail::BigramSketch* sketch = nullptr
+		)
+		{
+			std::vector<uint64_t> docBigrams;
+			for (auto docIt = docBegin; docIt != docEnd; ++docIt)
+			{
+				auto doc = *docIt;
+				if (!doc.size()) continue;
+				docBigrams.clear();
+				forEachBigram(doc, vocabFreqs, vocabDf, candMinCnt, candMinDf, [&](uint64_t key)
+				{
+					if (sketch && !sketch->mayReach(key)) return;
+					docBigrams.emplace_back(key);
+				});
+
+				std::sort(docBigrams.begin(), docBigrams.end());
+				for (size_t i = 0; i < docBigrams.size(); ++i)
+				{
+					auto& c = bigrams[docBigrams[i]];
+					c.cf++;
+					if (i == 0 || docBigrams[i - 1] != docBigrams[i]) c.df++;
 				}
+			}
+		}
 
-				for (auto& p : uniqBigram) bigramDf[p]++;
+		/*
+		removes the n-grams counted less than `minCnt` times, together with all their extensions, from a trie of n-gram counts
+		and rebuilds its failure links, so that counting can go on with the pruned trie.
+		Since an n-gram is never counted more than its prefixes and suffixes, every remaining node keeps its failure target.
+		*/
+		inline void pruneNgramCounts(std::vector<TrieEx<Vid, size_t>>& nodes, size_t minCnt)
+		{
+			if (nodes.empty()) return;
+			std::vector<TrieEx<Vid, size_t>> pruned(1);
+			std::vector<std::pair<const TrieEx<Vid, size_t>*, size_t>> stack;
+			stack.emplace_back(&nodes[0], 0);
+			while (!stack.empty())
+			{
+				auto src = stack.back().first;
+				const size_t d = stack.back().second;
+				stack.pop_back();
+				for (auto& kv : src->next)
+				{
+					if (!kv.second) continue;
+					auto child = src->getNext(kv.first);
+					if (child->val < minCnt) continue;
+					const size_t c = pruned.size();
+					pruned.emplace_back();
+					pruned[d].next[kv.first] = (int32_t)(c - d);
+					pruned[c].parent = (int32_t)d - (int32_t)c;
+					pruned[c].val = child->val;
+					stack.emplace_back(child, c);
+				}
 			}
+			pruned[0].fillFail();
+			nodes.swap(pruned);
 		}
 
+		/*
+		counts n-grams of documents into a trie, whose nodes are appended to `dest`.
+		If `maxNodes` is not zero, low-count branches are pruned by `pruneNgramCounts` whenever the trie grows larger than it.
+		The threshold starts from 2 and doubles until the trie shrinks to half of `maxNodes`,
+		so an n-gram may be undercounted by the thresholds used while it was pruned.
+		*/
 		template<bool _reverse, typename _DocIter, typename _Freqs, typename _BigramPairs>
 		void countNgrams(std::vector<TrieEx<Vid, size_t>>& dest,
 			_DocIter docBegin, _DocIter docEnd,
 			_Freqs&& vocabFreqs, _Freqs&& vocabDf, _BigramPairs&& validPairs,
-			size_t candMinCnt, size_t candMinDf, size_t maxNgrams
+			size_t candMinCnt, size_t candMinDf, size_t maxNgrams,
+			size_t maxNodes = 0
 		)
 		{
 			if (dest.empty())
@@ -98,11 +352,21 @@ namespace tomoto
 				dest.reserve(1024);
 			}
 			auto allocNode = [&]() { return dest.emplace_back(), & dest.back(); };
+			size_t pruneCnt = 2;
 
 			for (auto docIt = docBegin; docIt != docEnd; ++docIt)
 			{
 				auto doc = *docIt;
 				if (!doc.size()) continue;
+				if (maxNodes && dest.size() > maxNodes)
+				{
+					pruneNgramCounts(dest, pruneCnt);
+					while (dest.size() > maxNodes / 2)
+					{
+						pruneCnt *= 2;
+						pruneNgramCounts(dest, pruneCnt);
+					}
+				}
 				if (dest.capacity() < dest.size() + doc.size() * maxNgrams)
 				{
 					dest.reserve(std::max(dest.size() + doc.size() * maxNgrams, dest.capacity() * 2));
@@ -133,7 +397,7 @@ namespace tomoto
 							labelLen--;
 						}
 
-						if (validPairs.count(_reverse ? std::make_pair(curWord, prevWord) : std::make_pair(prevWord, curWord)))
+						if (validPairs.count(_reverse ? detail::packPair(curWord, prevWord) : detail::packPair(prevWord, curWord)))
 						{
 							auto nnode = node->makeNext(curWord, allocNode);
 							node = nnode;
@@ -158,33 +422,79 @@ namespace tomoto
 			}
 		}
 
-		inline void mergeNgramCounts(std::vector<TrieEx<Vid, size_t>>& dest, std::vector<TrieEx<Vid, size_t>>&& src)
+		/*
+		merges the n-gram counts of all tries of `src` into one trie using `pool`.
+		The n-grams are split into as many shards as the workers by their first word, and each worker merges only its own shard of every trie,
+		after which the shards are concatenated under one root.
+		*/
+		inline std::vector<TrieEx<Vid, size_t>> mergeNgramCounts(std::vector<std::vector<TrieEx<Vid, size_t>>>&& src, ThreadPool& pool)
 		{
-			if (src.empty()) return;
-			if (dest.empty()) dest.resize(1);
-
-			auto allocNode = [&]() { return dest.emplace_back(), & dest.back(); };
-
-			std::vector<Vid> rkeys;
-			src[0].traverse_with_keys([&](const TrieEx<Vid, size_t>* node, const std::vector<Vid>& rkeys)
+			using Node = TrieEx<Vid, size_t>;
+			const size_t numShards = pool.getNumWorkers();
+			std::vector<std::vector<Node>> shards(numShards);
+			std::vector<std::future<void>> futures;
+			for (size_t s = 0; s < numShards; ++s)
+			{
+				futures.emplace_back(pool.enqueue([&, s](size_t)
+				{
+					auto& dest = shards[s];
+					dest.resize(1);
+					auto allocNode = [&]() { return dest.emplace_back(), & dest.back(); };
+					std::vector<Vid> rkeys;
+					for (auto& t : src)
+					{
+						if (t.empty()) continue;
+						for (auto& kv : t[0].next)
+						{
+							if (!kv.second || kv.first % numShards != s) continue;
+							rkeys.assign(1, kv.first);
+							t[0].getNext(kv.first)->traverse_with_keys([&](const Node* node, const std::vector<Vid>& rkeys)
+							{
+								if (dest.capacity() < dest.size() + rkeys.size() * rkeys.size())
+								{
+									dest.reserve(std::max(dest.size() + rkeys.size() * rkeys.size(), dest.capacity() * 2));
+								}
+								dest[0].build(rkeys.begin(), rkeys.end(), 0, allocNode)->val += node->val;
+							}, rkeys);
+						}
+					}
+				}));
+			}
+			for (auto& f : futures) f.get();
+			src.clear();
+
+			size_t total = 1;
+			for (auto& shard : shards) total += shard.size() - 1;
+			std::vector<Node> dest(1);
+			dest.reserve(total);
+			for (auto& shard : shards)
 			{
-				if (dest.capacity() < dest.size() + rkeys.size() * rkeys.size())
+				// the offsets between nodes of a shard are kept, so only the links from and to the root need to be moved
+				const size_t base = dest.size() - 1;
+				dest.insert(dest.end(), std::make_move_iterator(shard.begin() + 1), std::make_move_iterator(shard.end()));
+				for (auto& kv : shard[0].next)
 				{
-					dest.reserve(std::max(dest.size() + rkeys.size() * rkeys.size(), dest.capacity() * 2));
+					if (!kv.second) continue;
+					const size_t c = base + kv.second;
+					dest[0].next[kv.first] = (int32_t)c;
+					dest[c].parent = -(int32_t)c;
 				}
-				dest[0].build(rkeys.begin(), rkeys.end(), 0, allocNode)->val += node->val;
-			}, rkeys);
+				std::vector<Node>{}.swap(shard);
+			}
+			return dest;
 		}
 
 		inline float branchingEntropy(const TrieEx<Vid, size_t>* node, size_t minCnt)
 		{
+			// the node may be missing if it was pruned while counting
+			if (!node || !node->val) return 0;
 			float entropy = 0;
 			size_t rest = node->val;
 			for (auto n : *node)
 			{
 				float p = n.second->val / (float)node->val;
 				entropy -= p * std::log(p);
-				rest -= n.second->val;
+				rest -= std::min(rest, n.second->val);
 			}
 			if (rest > 0)
 			{
@@ -225,64 +535,102 @@ namespace tomoto
 			return std::move(data[0]);
 		}
 
+		/*
+		counts bigrams of all documents and returns the ones satisfying `candMinCnt` and `candMinDf` in the order of their keys.
+		For a large corpus, bigrams are prefiltered by a count-min sketch in a preceding pass,
+		so that only the ones possibly frequent enough are kept in the count tables.
+		*/
 		template<typename _DocIter, typename _Freqs>
-		std::vector<label::Candidate> extractPMINgrams(_DocIter docBegin, _DocIter docEnd,
+		std::vector<std::pair<uint64_t, detail::BigramCount>> countFrequentBigrams(_DocIter docBegin, _DocIter docEnd,
 			_Freqs&& vocabFreqs, _Freqs&& vocabDf,
-			size_t candMinCnt, size_t candMinDf, size_t minNgrams, size_t maxNgrams, size_t maxCandidates,
-			float minScore, bool normalized = false,
+			size_t candMinCnt, size_t candMinDf,
 			ThreadPool* pool = nullptr)
 		{
-			// counting unigrams & bigrams
-			map<std::pair<Vid, Vid>, size_t> bigramCnt, bigramDf;
+			const size_t totN = std::accumulate(vocabFreqs.begin(), vocabFreqs.end(), (size_t)0);
+			std::unique_ptr<detail::BigramSketch> sketch;
+			if (candMinCnt > 1 && totN >= detail::sketchMinTokens)
+			{
+				size_t width = 1;
+				while (width < std::min(totN / 2, (size_t)1 << 24)) width *= 2;
+				sketch = std::make_unique<detail::BigramSketch>(width, candMinCnt);
+			}
 
+			detail::BigramCountTable bigrams;
 			if (pool && pool->getNumWorkers() > 1)
 			{
-				using LocalCfDf = std::pair<
-					decltype(bigramCnt),
-					decltype(bigramDf)
-				>;
-				std::vector<LocalCfDf> localdata(pool->getNumWorkers());
-				std::vector<std::future<void>> futures;
 				const size_t stride = pool->getNumWorkers() * 8;
-				auto docIt = docBegin;
-				for (size_t i = 0; i < stride && docIt != docEnd; ++i, ++docIt)
+				const auto forEachStride = [&](auto&& fn)
 				{
-					futures.emplace_back(pool->enqueue([&, docIt, stride](size_t tid)
+					std::vector<std::future<void>> futures;
+					auto docIt = docBegin;
+					for (size_t i = 0; i < stride && docIt != docEnd; ++i, ++docIt)
 					{
-						countBigrams(localdata[tid].first, localdata[tid].second, makeStrideIter(docIt, stride, docEnd), makeStrideIter(docEnd, stride, docEnd), vocabFreqs, vocabDf, candMinCnt, candMinDf);
-					}));
+						futures.emplace_back(pool->enqueue([&, docIt, stride](size_t tid)
+						{
+							fn(tid, makeStrideIter(docIt, stride, docEnd), makeStrideIter(docEnd, stride, docEnd));
+						}));
+					}
+					for (auto& f : futures) f.get();
+				};
+
+				if (sketch)
+				{
+					forEachStride([&](size_t, auto b, auto e)
+					{
+						sketchBigrams(*sketch, b, e, vocabFreqs, vocabDf, candMinCnt, candMinDf);
+					});
 				}
 
-				for (auto& f : futures) f.get();
+				std::vector<detail::BigramCountTable> localdata(pool->getNumWorkers());
+				forEachStride([&](size_t tid, auto b, auto e)
+				{
+					countBigrams(localdata[tid], b, e, vocabFreqs, vocabDf, candMinCnt, candMinDf, sketch.get());
+				});
 
-				auto r = parallelReduce(std::move(localdata), [](LocalCfDf& dest, LocalCfDf&& src)
+				bigrams = parallelReduce(std::move(localdata), [](detail::BigramCountTable& dest, detail::BigramCountTable&& src)
 				{
-					for (auto& p : src.first) dest.first[p.first] += p.second;
-					for (auto& p : src.second) dest.second[p.first] += p.second;
+					dest.merge(std::move(src));
 				}, pool);
-
-				bigramCnt = std::move(r.first);
-				bigramDf = std::move(r.second);
 			}
 			else
 			{
-				countBigrams(bigramCnt, bigramDf, docBegin, docEnd, vocabFreqs, vocabDf, candMinCnt, candMinDf);
+				if (sketch) sketchBigrams(*sketch, docBegin, docEnd, vocabFreqs, vocabDf, candMinCnt, candMinDf);
+				countBigrams(bigrams, docBegin, docEnd, vocabFreqs, vocabDf, candMinCnt, candMinDf, sketch.get());
 			}
 
+			std::vector<std::pair<uint64_t, detail::BigramCount>> ret;
+			bigrams.forEach([&](uint64_t key, const detail::BigramCount& c)
+			{
+				if (c.cf >= candMinCnt && c.df >= candMinDf) ret.emplace_back(key, c);
+			});
+			std::sort(ret.begin(), ret.end(), [](const std::pair<uint64_t, detail::BigramCount>& a, const std::pair<uint64_t, detail::BigramCount>& b)
+			{
+				return a.first < b.first;
+			});
+			return ret;
+		}
+
+		template<typename _DocIter, typename _Freqs>
+		std::vector<label::Candidate> extractPMINgrams(_DocIter docBegin, _DocIter docEnd,
+			_Freqs&& vocabFreqs, _Freqs&& vocabDf,
+			size_t candMinCnt, size_t candMinDf, size_t minNgrams, size_t maxNgrams, size_t maxCandidates,
+			float minScore, bool normalized = false,
+			ThreadPool* pool = nullptr)
+		{
+			// counting bigrams
+			auto bigrams = countFrequentBigrams(docBegin, docEnd, vocabFreqs, vocabDf, candMinCnt, candMinDf, pool);
+
 			// counting ngrams
 			std::vector<TrieEx<Vid, size_t>> trieNodes;
 			if (maxNgrams > 2)
 			{
-				std::unordered_set<std::pair<Vid, Vid>, detail::vvhash> validPairs;
-				for (auto& p : bigramCnt)
-				{
-					if (p.second >= candMinCnt && bigramDf[p.first] >= candMinDf) validPairs.emplace(p.first);
-				}
+				std::unordered_set<uint64_t> validPairs;
+				validPairs.reserve(bigrams.size());
+				for (auto& p : bigrams) validPairs.emplace(p.first);
 
 				if (pool && pool->getNumWorkers() > 1)
 				{
-					using LocalFwBw = std::vector<TrieEx<Vid, size_t>>;
-					std::vector<LocalFwBw> localdata(pool->getNumWorkers());
+					std::vector<std::vector<TrieEx<Vid, size_t>>> localdata(pool->getNumWorkers());
 					std::vector<std::future<void>> futures;
 					const size_t stride = pool->getNumWorkers() * 8;
 					auto docIt = docBegin;
@@ -300,12 +648,7 @@ namespace tomoto
 
 					for (auto& f : futures) f.get();
 
-					auto r = parallelReduce(std::move(localdata), [&](LocalFwBw& dest, LocalFwBw&& src)
-					{
-						mergeNgramCounts(dest, std::move(src));
-					}, pool);
-
-					trieNodes = std::move(r);
+					trieNodes = mergeNgramCounts(std::move(localdata), *pool);
 				}
 				else
 				{
@@ -321,21 +664,19 @@ namespace tomoto
 
 			// calculating PMIs
 			std::vector<label::Candidate> candidates;
-			for (auto& p : bigramCnt)
+			for (auto& p : bigrams)
 			{
-				auto& bigram = p.first;
-				if (p.second < candMinCnt) continue;
-				if (bigramDf[bigram] < candMinDf) continue;
-				auto pmi = std::log(p.second * totN
+				auto bigram = detail::unpackPair(p.first);
+				auto pmi = std::log(p.second.cf * totN
 					/ vocabFreqs[bigram.first] / vocabFreqs[bigram.second]);
 				if (normalized)
 				{
-					pmi /= std::log(totN / p.second);
+					pmi /= std::log(totN / p.second.cf);
 				}
 				if (pmi < minScore) continue;
 				candidates.emplace_back(pmi, bigram.first, bigram.second);
-				candidates.back().cf = p.second;
-				candidates.back().df = bigramDf[bigram];
+				candidates.back().cf = p.second.cf;
+				candidates.back().df = p.second.df;
 			}
 
 			if (maxNgrams > 2)
@@ -367,107 +708,163 @@ namespace tomoto
 			return candidates;
 		}
 
-		template<typename _DocIter, typename _Freqs>
-		std::vector<label::Candidate> extractPMIBENgrams(_DocIter docBegin, _DocIter docEnd,
-			_Freqs&& vocabFreqs, _Freqs&& vocabDf,
-			size_t candMinCnt, size_t candMinDf, size_t minNgrams, size_t maxNgrams, size_t maxCandidates,
-			float minNPMI = 0, float minNBE = 0,
-			ThreadPool* pool = nullptr)
+		/*
+		replaces every n-gram of `doc` matched by `trie` with the concatenated word in place, and returns the number of replacements.
+		The value of each pattern in `trie` should be its index in `candVids` plus one.
+		Matching restarts after each replacement, so the replaced n-grams never overlap.
+		`origWordPos` and `origWordLen` of `doc` are merged along with its words if they are present.
+		*/
+		template<typename _Doc>
+		size_t concatNgrams(_Doc& doc, const FrozenTrie<Vid, size_t>& trie, const std::vector<Vid>& candVids)
 		{
-			// counting unigrams & bigrams
-			map<std::pair<Vid, Vid>, size_t> bigramCnt, bigramDf;
-
-			if (pool && pool->getNumWorkers() > 1)
+			constexpr uint32_t npos = FrozenTrie<Vid, size_t>::npos;
+			auto& words = doc.words;
+			auto& pos = doc.origWordPos;
+			auto& len = doc.origWordLen;
+			const bool hasPos = pos.size() == words.size() && len.size() == words.size();
+
+			size_t found = 0, o = 0;
+			uint32_t node = 0;
+			for (size_t i = 0; i < words.size(); ++i, ++o)
 			{
-				using LocalCfDf = std::pair<
-					decltype(bigramCnt),
-					decltype(bigramDf)
-				>;
-				std::vector<LocalCfDf> localdata(pool->getNumWorkers());
-				std::vector<std::future<void>> futures;
-				const size_t stride = pool->getNumWorkers() * 8;
-				auto docIt = docBegin;
-				for (size_t i = 0; i < stride && docIt != docEnd; ++i, ++docIt)
+				const Vid w = words[i];
+				words[o] = w;
+				if (hasPos)
 				{
-					futures.emplace_back(pool->enqueue([&, docIt, stride](size_t tid)
-					{
-						countBigrams(localdata[tid].first, localdata[tid].second, makeStrideIter(docIt, stride, docEnd), makeStrideIter(docEnd, stride, docEnd), vocabFreqs, vocabDf, candMinCnt, candMinDf);
-					}));
+					pos[o] = pos[i];
+					len[o] = len[i];
 				}
 
-				for (auto& f : futures) f.get();
+				auto nnode = trie.getNext(node, w);
+				while (nnode == npos)
+				{
+					node = trie.getFail(node);
+					if (node != npos) nnode = trie.getNext(node, w);
+					else break;
+				}
 
-				auto r = parallelReduce(std::move(localdata), [](LocalCfDf& dest, LocalCfDf&& src)
+				if (nnode == npos)
 				{
-					for (auto& p : src.first) dest.first[p.first] += p.second;
-					for (auto& p : src.second) dest.second[p.first] += p.second;
-				}, pool);
+					node = 0;
+					continue;
+				}
+
+				node = nnode;
+				const size_t val = trie[nnode].val;
+				if (!val || val == (size_t)-1) continue;
 
-				bigramCnt = std::move(r.first);
-				bigramDf = std::move(r.second);
+				// the matched n-gram consists of the last `depth` words written, since matching restarts after each replacement
+				const size_t start = o + 1 - trie[nnode].depth;
+				words[start] = candVids[val - 1];
+				if (hasPos)
+				{
+					const size_t end = pos[o] + len[o];
+					len[start] = (uint16_t)std::min(end - pos[start], (size_t)UINT16_MAX);
+				}
+				o = start;
+				node = 0;
+				++found;
 			}
-			else
+
+			words.resize(o);
+			if (hasPos)
 			{
-				countBigrams(bigramCnt, bigramDf, docBegin, docEnd, vocabFreqs, vocabDf, candMinCnt, candMinDf);
+				pos.resize(o);
+				len.resize(o);
 			}
+			return found;
+		}
 
-			// counting ngrams
-			std::vector<TrieEx<Vid, size_t>> trieNodes, trieNodesBw;
-			if (maxNgrams > 2)
+		template<typename _DocIter>
+		size_t concatNgrams(_DocIter docBegin, _DocIter docEnd, const FrozenTrie<Vid, size_t>& trie, const std::vector<Vid>& candVids,
+			ThreadPool* pool = nullptr)
+		{
+			const size_t numDocs = std::distance(docBegin, docEnd);
+			if (!pool || pool->getNumWorkers() <= 1)
+			{
+				size_t found = 0;
+				for (auto it = docBegin; it != docEnd; ++it) found += concatNgrams(*it, trie, candVids);
+				return found;
+			}
+
+			const size_t groups = pool->getNumWorkers() * 4;
+			std::vector<size_t> localFound(groups);
+			std::vector<std::future<void>> futures;
+			for (size_t g = 0; g < groups; ++g)
 			{
-				std::unordered_set<std::pair<Vid, Vid>, detail::vvhash> validPairs;
-				for (auto& p : bigramCnt)
+				futures.emplace_back(pool->enqueue([&, groups](size_t, size_t g)
 				{
-					if (p.second >= candMinCnt && bigramDf[p.first] >= candMinDf) validPairs.emplace(p.first);
-				}
+					for (size_t i = g; i < numDocs; i += groups)
+					{
+						localFound[g] += concatNgrams(docBegin[i], trie, candVids);
+					}
+				}, g));
+			}
+			for (auto& f : futures) f.get();
+			return std::accumulate(localFound.begin(), localFound.end(), (size_t)0);
+		}
+
+		template<typename _DocIter, typename _Freqs>
+		std::vector<label::Candidate> extractPMIBENgrams(_DocIter docBegin, _DocIter docEnd,
+			_Freqs&& vocabFreqs, _Freqs&& vocabDf,
+			size_t candMinCnt, size_t candMinDf, size_t minNgrams, size_t maxNgrams, size_t maxCandidates,
+			float minNPMI = 0, float minNBE = 0,
+			ThreadPool* pool = nullptr, size_t maxTrieNodes = 0)
+		{
+			// counting bigrams
+			auto bigrams = countFrequentBigrams(docBegin, docEnd, vocabFreqs, vocabDf, candMinCnt, candMinDf, pool);
+
+			// counting ngrams, which are needed for the branching entropies of bigrams too
+			std::vector<TrieEx<Vid, size_t>> trieNodes, trieNodesBw;
+			{
+				std::unordered_set<uint64_t> validPairs;
+				validPairs.reserve(bigrams.size());
+				for (auto& p : bigrams) validPairs.emplace(p.first);
 
 				if (pool && pool->getNumWorkers() > 1)
 				{
-					using LocalFwBw = std::pair<
-						std::vector<TrieEx<Vid, size_t>>,
-						std::vector<TrieEx<Vid, size_t>>
-					>;
-					std::vector<LocalFwBw> localdata(pool->getNumWorkers());
+					// forward and backward n-grams are counted by separate tasks, so both directions proceed at the same time
+					const size_t numWorkers = pool->getNumWorkers();
+					const size_t maxLocalNodes = maxTrieNodes ? std::max(maxTrieNodes / (numWorkers * 2), (size_t)1024) : 0;
+					std::vector<std::vector<TrieEx<Vid, size_t>>> localFw(numWorkers), localBw(numWorkers);
 					std::vector<std::future<void>> futures;
-					const size_t stride = pool->getNumWorkers() * 8;
+					const size_t stride = numWorkers * 8;
 					auto docIt = docBegin;
 					for (size_t i = 0; i < stride && docIt != docEnd; ++i, ++docIt)
 					{
 						futures.emplace_back(pool->enqueue([&, docIt, stride](size_t tid)
 						{
-							countNgrams<false>(localdata[tid].first, 
+							countNgrams<false>(localFw[tid], 
 								makeStrideIter(docIt, stride, docEnd), 
 								makeStrideIter(docEnd, stride, docEnd), 
-								vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1
+								vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1, maxLocalNodes
 							);
-							countNgrams<true>(localdata[tid].second, 
+						}));
+						futures.emplace_back(pool->enqueue([&, docIt, stride](size_t tid)
+						{
+							countNgrams<true>(localBw[tid], 
 								makeStrideIter(docIt, stride, docEnd), 
 								makeStrideIter(docEnd, stride, docEnd), 
-								vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1
+								vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1, maxLocalNodes
 							);
 						}));
 					}
 
 					for (auto& f : futures) f.get();
 
-					auto r = parallelReduce(std::move(localdata), [&](LocalFwBw& dest, LocalFwBw&& src)
-					{
-						mergeNgramCounts(dest.first, std::move(src.first));
-						mergeNgramCounts(dest.second, std::move(src.second));
-					}, pool);
-
-					trieNodes = std::move(r.first);
-					trieNodesBw = std::move(r.second);
+					trieNodes = mergeNgramCounts(std::move(localFw), *pool);
+					trieNodesBw = mergeNgramCounts(std::move(localBw), *pool);
 				}
 				else
 				{
+					const size_t maxLocalNodes = maxTrieNodes ? std::max(maxTrieNodes / 2, (size_t)1024) : 0;
 					countNgrams<false>(trieNodes, 
 						docBegin, docEnd, 
-						vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1
+						vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1, maxLocalNodes
 					);
 					countNgrams<true>(trieNodesBw, 
 						docBegin, docEnd, 
-						vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1
+						vocabFreqs, vocabDf, validPairs, candMinCnt, candMinDf, maxNgrams + 1, maxLocalNodes
 					);
 				}
 			}
@@ -477,23 +874,22 @@ namespace tomoto
 
 			// calculating PMIs
 			std::vector<label::Candidate> candidates;
-			for (auto& p : bigramCnt)
+			for (auto& p : bigrams)
 			{
-				auto& bigram = p.first;
-				if (p.second < candMinCnt) continue;
-				if (bigramDf[bigram] < candMinDf) continue;
-				float npmi = std::log(p.second * totN
+				auto bigram = detail::unpackPair(p.first);
+				float npmi = std::log(p.second.cf * totN
 					/ vocabFreqs[bigram.first] / vocabFreqs[bigram.second]);
-				npmi /= std::log(totN / p.second);
+				npmi /= std::log(totN / p.second.cf);
 				if (npmi < minNPMI) continue;
 
-				float rbe = branchingEntropy(trieNodes[0].getNext(bigram.first)->getNext(bigram.second), candMinCnt);
-				float lbe = branchingEntropy(trieNodesBw[0].getNext(bigram.second)->getNext(bigram.first), candMinCnt);
-				float nbe = std::sqrt(rbe * lbe) / (float)std::log(p.second);
+				const Vid fw[] = { bigram.first, bigram.second }, bw[] = { bigram.second, bigram.first };
+				float rbe = branchingEntropy(trieNodes[0].findNode(fw, fw + 2), candMinCnt);
+				float lbe = branchingEntropy(trieNodesBw[0].findNode(bw, bw + 2), candMinCnt);
+				float nbe = std::sqrt(rbe * lbe) / (float)std::log(p.second.cf);
 				if (nbe < minNBE) continue;
 				candidates.emplace_back(npmi * nbe, bigram.first, bigram.second);
-				candidates.back().cf = p.second;
-				candidates.back().df = bigramDf[bigram];
+				candidates.back().cf = p.second.cf;
+				candidates.back().df = p.second.df;
 			}
 
 			if (maxNgrams > 2)
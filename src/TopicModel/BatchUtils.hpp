@@ -0,0 +1,50 @@
+#pragma once
+#include <algorithm>
+#include "../Utils/Dictionary.h"
+#include "../Utils/ThreadPool.hpp"
+
+namespace tomoto
+{
+	namespace detail
+	{
+		// groups the words of `doc` into unique words and their counts
+		inline void countWords(const std::vector<Vid>& doc, std::vector<Vid>& ids, std::vector<Float>& cnts)
+		{
+			ids = doc;
+			std::sort(ids.begin(), ids.end());
+			cnts.clear();
+			size_t u = 0;
+			for (size_t i = 0; i < ids.size(); ++i)
+			{
+				if (u && ids[u - 1] == ids[i])
+				{
+					cnts[u - 1] += 1;
+					continue;
+				}
+				ids[u++] = ids[i];
+				cnts.emplace_back(1);
+			}
+			ids.resize(u);
+		}
+
+		// calls `fn(threadId, b, e)` for `numWorkers` contiguous ranges of [0, n), so the result doesn't depend on scheduling
+		template<typename _Fn>
+		void forEachRange(size_t n, size_t numWorkers, _Fn&& fn)
+		{
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			numWorkers = std::max(std::min(numWorkers, n), (size_t)1);
+			if (numWorkers == 1)
+			{
+				fn(0, 0, n);
+				return;
+			}
+			auto pool = PoolManager::getInstance().borrow(numWorkers);
+			std::vector<std::future<void>> res;
+			for (size_t t = 0; t < numWorkers; ++t)
+			{
+				res.emplace_back(pool->enqueue([&, t](size_t) { fn(t, n * t / numWorkers, n * (t + 1) / numWorkers); }));
+			}
+			for (auto& r : res) r.get();
+		}
+	}
+}
@@ -133,23 +133,14 @@ namespace tomoto
 
 			if (pool)
 			{
-				std::vector<std::future<void>> res;
-				const size_t chStride = pool->getNumWorkers() * 8;
-				size_t dist = std::distance(first, last);
-				for (size_t ch = 0; ch < chStride; ++ch)
+				// the costs of updating beta vary by document, so chunks are handed out in a guided way
+				pool->parallelFor(0, std::distance(first, last), [&](size_t threadId, size_t b, size_t e)
 				{
-					auto b = first, e = first;
-					std::advance(b, dist * ch / chStride);
-					std::advance(e, dist * (ch + 1) / chStride);
-					res.emplace_back(pool->enqueue([&, ch, chStride](size_t threadId, _DocIter b, _DocIter e)
+					for (auto doc = std::next(first, b), end = std::next(first, e); doc != end; ++doc)
 					{
-						for (auto doc = b; doc != e; ++doc)
-						{
-							updateBeta(*doc, rgs[threadId]);
-						}
-					}, b, e));
-				}
-				for (auto& r : res) r.get();
+						updateBeta(*doc, rgs[threadId]);
+					}
+				}, 1, true);
 			}
 			else
 			{
@@ -181,13 +172,46 @@ namespace tomoto
 			return 0;
 		}
 
-		void optimizeParameters(ThreadPool& pool, _ModelState* localData, _RandGen* rgs)
+		// sums `fn(acc, doc)` over all documents, accumulating each chunk of documents on the pool into its own matrix
+		template<typename _Fn>
+		Matrix reduceDocs(ThreadPool& pool, size_t rows, size_t cols, _Fn fn) const
 		{
+			const size_t chStride = std::max(std::min(pool.getNumWorkers() * 8, this->docs.size()), (size_t)1);
+			std::vector<Matrix> partials(chStride, Matrix::Zero(rows, cols));
 			std::vector<std::future<void>> res;
-			topicPrior = math::MultiNormalDistribution<Float>::estimate([this](size_t i)
+			for (size_t ch = 0; ch < chStride; ++ch)
 			{
-				return this->docs[i / numBetaSample].beta.col(i % numBetaSample);
-			}, this->docs.size() * numBetaSample);
+				res.emplace_back(pool.enqueue([&, this](size_t threadId, size_t ch)
+				{
+					for (size_t i = ch; i < this->docs.size(); i += chStride)
+					{
+						fn(partials[ch], this->docs[i]);
+					}
+				}, ch));
+			}
+			for (auto& r : res) r.get();
+			for (size_t ch = 1; ch < chStride; ++ch) partials[0] += partials[ch];
+			return std::move(partials[0]);
+		}
+
+		void optimizeParameters(ThreadPool& pool, _ModelState* localData, _RandGen* rgs)
+		{
+			const size_t len = this->docs.size() * numBetaSample;
+			if (!len) return;
+			// the same estimation as `MultiNormalDistribution::estimate`, 
+			// but the beta samples of each document are accumulated as a block with one rank-`numBetaSample` update
+			Vector mean = reduceDocs(pool, this->K, 1, [](Matrix& acc, const _DocType& doc)
+			{
+				acc += doc.beta.rowwise().sum();
+			}) / len;
+			Matrix cov = reduceDocs(pool, this->K, this->K, [&](Matrix& acc, const _DocType& doc)
+			{
+				Matrix o = doc.beta.colwise() - mean;
+				acc.noalias() += o * o.transpose();
+			});
+			cov += Matrix::Identity(this->K, this->K);
+			if (len > 1) cov /= len - 1;
+			topicPrior = math::MultiNormalDistribution<Float>::fromMeanCov(std::move(mean), std::move(cov));
 			if (!std::isfinite(topicPrior.mean[0]))
 				THROW_ERROR_WITH_INFO(exc::TrainingError, 
 					text::format("topicPrior.mean is %f", topicPrior.mean[0]));
@@ -215,6 +239,14 @@ namespace tomoto
 			return ll;
 		}
 
+		void addMemoryUsage(MemoryUsage& ret) const
+		{
+			BaseClass::addMemoryUsage(ret);
+			uint64_t betaBytes = 0;
+			for (auto& doc : this->docs) betaBytes += heapBytes(doc.beta) + heapBytes(doc.smBeta);
+			ret.emplace_back("docs.beta", betaBytes);
+		}
+
 		void prepareDoc(_DocType& doc, size_t docId, size_t wordSize) const
 		{
 			BaseClass::prepareDoc(doc, docId, wordSize);
@@ -0,0 +1,349 @@
+#include "CVB0LDA.h"
+#include "BatchUtils.hpp"
+
+namespace tomoto
+{
+	CVB0LDA::CVB0LDA(const CVB0LDAArgs& args)
+		: K{ args.k }, topK{ args.topK }, alphas(args.k, args.alpha), eta{ args.eta }, seed{ args.seed },
+		numByTopicDoc{ args.k, 0 }, numByTopicWord{ args.k, 0 }, numByTopic{ Vector::Zero(args.k) }
+	{
+		if (!K || K >= 0x8000) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong K value (K = %zd)", K));
+		if (args.alpha <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong alpha value (alpha = %f)", args.alpha));
+		if (eta <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong eta value (eta = %f)", eta));
+	}
+
+	std::vector<Vid> CVB0LDA::toWids(const std::vector<std::string>& doc, bool addNew)
+	{
+		std::vector<Vid> ret;
+		for (auto& w : doc)
+		{
+			auto id = addNew ? dict.add(w) : dict.toWid(w);
+			if (id == non_vocab_id || (!addNew && id >= (size_t)numByTopicWord.cols())) continue;
+			ret.emplace_back(id);
+		}
+		return ret;
+	}
+
+	size_t CVB0LDA::addDoc(const std::vector<Vid>& doc)
+	{
+		for (auto w : doc)
+		{
+			if (w >= dict.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("word id %u is out of the vocabulary", w));
+		}
+		words.insert(words.end(), doc.begin(), doc.end());
+		docOffsets.emplace_back(words.size());
+		return getNumDocs() - 1;
+	}
+
+	void CVB0LDA::prepare()
+	{
+		const size_t V = dict.size(), D = getNumDocs(), T = getNumKept();
+		const size_t oldV = numByTopicWord.cols(), oldD = numByTopicDoc.cols();
+		if (V > oldV)
+		{
+			numByTopicWord.conservativeResize(K, V);
+			numByTopicWord.rightCols(V - oldV).setZero();
+		}
+		if (D > oldD)
+		{
+			numByTopicDoc.conservativeResize(K, D);
+			numByTopicDoc.rightCols(D - oldD).setZero();
+		}
+		if (numInitWords == words.size()) return;
+
+		// each new token starts from a random topic, like the initialization of Gibbs sampling
+		std::mt19937_64 rg{ seed + numInitWords };
+		std::uniform_int_distribution<size_t> randomTopic{ 0, K - 1 };
+		gammaTopics.resize(words.size() * T);
+		gammaWeights.resize(words.size() * T);
+		size_t d = std::upper_bound(docOffsets.begin(), docOffsets.end(), numInitWords) - docOffsets.begin() - 1;
+		for (size_t i = numInitWords; i < words.size(); ++i)
+		{
+			while (docOffsets[d + 1] <= i) ++d;
+			const size_t z = randomTopic(rg);
+			for (size_t j = 0; j < T; ++j)
+			{
+				gammaTopics[i * T + j] = (z + j) % K;
+				gammaWeights[i * T + j] = j ? 0 : 1;
+			}
+			numByTopicDoc(z, d) += 1;
+			numByTopicWord(z, words[i]) += 1;
+			numByTopic[z] += 1;
+		}
+		numInitWords = words.size();
+	}
+
+	void CVB0LDA::rebuildCounts()
+	{
+		const size_t T = getNumKept();
+		numByTopicDoc.setZero();
+		numByTopicWord.setZero();
+		numByTopic.setZero();
+		for (size_t d = 0; d < (size_t)numByTopicDoc.cols(); ++d)
+		{
+			for (size_t i = docOffsets[d]; i < docOffsets[d + 1]; ++i)
+			{
+				for (size_t j = 0; j < T; ++j)
+				{
+					const Tid z = gammaTopics[i * T + j];
+					const Float g = gammaWeights[i * T + j];
+					numByTopicDoc(z, d) += g;
+					numByTopicWord(z, words[i]) += g;
+					numByTopic[z] += g;
+				}
+			}
+		}
+	}
+
+	Matrix CVB0LDA::getTopicWordProbs() const
+	{
+		const Float vEta = eta * numByTopicWord.cols();
+		return (numByTopicWord.array() + eta).colwise() / (numByTopic.array() + vEta);
+	}
+
+	template<typename _DocCnt, typename _WordCnt>
+	void CVB0LDA::estimate(const _DocCnt& docCnt, const _WordCnt& wordCnt, const Vector& topicCnt, Float* dist) const
+	{
+		const Float vEta = eta * numByTopicWord.cols();
+		for (size_t k = 0; k < K; ++k)
+		{
+			// the counts may drift slightly below zero by rounding errors
+			dist[k] = (std::max(docCnt[k], (Float)0) + alphas[k]) * (std::max(wordCnt[k], (Float)0) + eta)
+				/ (std::max(topicCnt[k], (Float)0) + vEta);
+		}
+	}
+
+	void CVB0LDA::train(size_t iteration, size_t numWorkers)
+	{
+		prepare();
+		const size_t D = getNumDocs(), T = getNumKept();
+		if (!D) return;
+		if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+		numWorkers = std::max(std::min(numWorkers, D), (size_t)1);
+
+		// with multiple workers, each one updates its own copy of the topic-word counts, and their changes are merged after each sweep
+		std::vector<Matrix> localWord(numWorkers > 1 ? numWorkers : 0);
+		std::vector<Vector> localTopic(localWord.size());
+		for (size_t it = 0; it < iteration; ++it)
+		{
+			for (size_t t = 0; t < localWord.size(); ++t)
+			{
+				localWord[t] = numByTopicWord;
+				localTopic[t] = numByTopic;
+			}
+
+			detail::forEachRange(D, numWorkers, [&](size_t t, size_t b, size_t e)
+			{
+				Matrix& wordCnt = localWord.empty() ? numByTopicWord : localWord[t];
+				Vector& topicCnt = localTopic.empty() ? numByTopic : localTopic[t];
+				Vector dist{ K };
+				std::vector<Tid> order(K);
+				for (size_t d = b; d < e; ++d)
+				{
+					auto docCnt = numByTopicDoc.col(d);
+					for (size_t i = docOffsets[d]; i < docOffsets[d + 1]; ++i)
+					{
+						const Vid w = words[i];
+						Tid* z = &gammaTopics[i * T];
+						Float* g = &gammaWeights[i * T];
+						for (size_t j = 0; j < T; ++j)
+						{
+							docCnt[z[j]] -= g[j];
+							wordCnt(z[j], w) -= g[j];
+							topicCnt[z[j]] -= g[j];
+						}
+
+						estimate(docCnt, wordCnt.col(w), topicCnt, dist.data());
+						if (T == K)
+						{
+							for (size_t k = 0; k < K; ++k)
+							{
+								z[k] = k;
+								g[k] = dist[k];
+							}
+						}
+						else
+						{
+							// keeps only the `T` largest probabilities
+							std::iota(order.begin(), order.end(), 0);
+							std::nth_element(order.begin(), order.begin() + T, order.end(), [&](Tid a, Tid b)
+							{
+								return dist[a] > dist[b];
+							});
+							for (size_t j = 0; j < T; ++j)
+							{
+								z[j] = order[j];
+								g[j] = dist[order[j]];
+							}
+						}
+
+						const Float sum = std::accumulate(g, g + T, (Float)0);
+						for (size_t j = 0; j < T; ++j)
+						{
+							g[j] /= sum;
+							docCnt[z[j]] += g[j];
+							wordCnt(z[j], w) += g[j];
+							topicCnt[z[j]] += g[j];
+						}
+					}
+				}
+			});
+
+			if (!localWord.empty())
+			{
+				detail::forEachRange(numByTopicWord.cols(), numWorkers, [&](size_t, size_t b, size_t e)
+				{
+					auto global = numByTopicWord.middleCols(b, e - b);
+					const Matrix base = global;
+					for (auto& l : localWord) global += l.middleCols(b, e - b) - base;
+				});
+				const Vector base = numByTopic;
+				for (auto& l : localTopic) numByTopic += l - base;
+			}
+			++globalStep;
+		}
+		// drops the rounding errors accumulated by the incremental updates
+		rebuildCounts();
+	}
+
+	double CVB0LDA::getLLPerWord(size_t numWorkers) const
+	{
+		const size_t D = numByTopicDoc.cols();
+		if (!D || !docOffsets[D]) return 0;
+		if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+		numWorkers = std::max(std::min(numWorkers, D), (size_t)1);
+
+		const Matrix phi = getTopicWordProbs();
+		Eigen::Map<const Vector> alpha{ alphas.data(), (Eigen::Index)K };
+		const Float alphaSum = alpha.sum();
+		std::vector<double> lls(numWorkers);
+		detail::forEachRange(D, numWorkers, [&](size_t t, size_t b, size_t e)
+		{
+			Vector theta{ K };
+			for (size_t d = b; d < e; ++d)
+			{
+				theta = (numByTopicDoc.col(d) + alpha) / (docOffsets[d + 1] - docOffsets[d] + alphaSum);
+				for (size_t i = docOffsets[d]; i < docOffsets[d + 1]; ++i) lls[t] += std::log(theta.dot(phi.col(words[i])));
+			}
+		});
+		return std::accumulate(lls.begin(), lls.end(), 0.) / docOffsets[D];
+	}
+
+	std::vector<std::vector<Float>> CVB0LDA::infer(const std::vector<std::vector<Vid>>& docs, size_t maxIter,
+		size_t numWorkers, std::vector<double>* ll) const
+	{
+		for (auto& doc : docs)
+		{
+			for (auto w : doc)
+			{
+				if (w >= (size_t)numByTopicWord.cols()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("word id %u is out of the vocabulary", w));
+			}
+		}
+
+		std::vector<std::vector<Float>> ret(docs.size());
+		if (ll) ll->resize(docs.size());
+		const Matrix phi = getTopicWordProbs();
+		Eigen::Map<const Vector> alpha{ alphas.data(), (Eigen::Index)K };
+		detail::forEachRange(docs.size(), numWorkers, [&](size_t, size_t b, size_t e)
+		{
+			std::vector<Vid> ids;
+			std::vector<Float> cnts;
+			Matrix gamma;
+			Vector docCnt{ K }, next{ K };
+			for (size_t i = b; i < e; ++i)
+			{
+				// the tokens of the same word share their distribution, and the topic-word distributions stay fixed
+				detail::countWords(docs[i], ids, cnts);
+				gamma.resize(K, ids.size());
+				docCnt.setZero();
+				for (size_t j = 0; j < ids.size(); ++j)
+				{
+					gamma.col(j) = phi.col(ids[j]) / phi.col(ids[j]).sum();
+					docCnt += cnts[j] * gamma.col(j);
+				}
+
+				for (size_t it = 0; it < maxIter && !ids.empty(); ++it)
+				{
+					Float diff = 0;
+					for (size_t j = 0; j < ids.size(); ++j)
+					{
+						next.array() = ((docCnt - gamma.col(j)).array().max((Float)0) + alpha.array()) * phi.col(ids[j]).array();
+						next /= next.sum();
+						diff += cnts[j] * (next - gamma.col(j)).cwiseAbs().sum();
+						docCnt += cnts[j] * (next - gamma.col(j));
+						gamma.col(j) = next;
+					}
+					if (diff < docs[i].size() * (Float)1e-3) break;
+				}
+
+				Vector theta = (docCnt + alpha) / (docs[i].size() + alpha.sum());
+				if (ll)
+				{
+					double s = 0;
+					for (size_t j = 0; j < ids.size(); ++j) s += cnts[j] * std::log(theta.dot(phi.col(ids[j])));
+					(*ll)[i] = s;
+				}
+				ret[i] = { theta.data(), theta.data() + K };
+			}
+		});
+		return ret;
+	}
+
+	std::vector<Float> CVB0LDA::getTopicWordDist(size_t k) const
+	{
+		if (k >= K) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong topic id (k = %zd)", k));
+		std::vector<Float> ret(dict.size(), eta);
+		for (Eigen::Index v = 0; v < numByTopicWord.cols(); ++v) ret[v] += numByTopicWord(k, v);
+		const Float sum = numByTopic[k] + eta * dict.size();
+		for (auto& p : ret) p /= sum;
+		return ret;
+	}
+
+	std::vector<Float> CVB0LDA::getDocTopicDist(size_t docId) const
+	{
+		if (docId >= getNumDocs()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong document id (docId = %zd)", docId));
+		std::vector<Float> ret = alphas;
+		if (docId < (size_t)numByTopicDoc.cols())
+		{
+			for (size_t k = 0; k < K; ++k) ret[k] += numByTopicDoc(k, docId);
+		}
+		const Float sum = std::accumulate(ret.begin(), ret.end(), (Float)0);
+		for (auto& p : ret) p /= sum;
+		return ret;
+	}
+
+	void CVB0LDA::write(std::ostream& writer) const
+	{
+		serializer::writeMany(writer, serializer::to_key("TCVB"), (uint32_t)0, (uint32_t)K, (uint32_t)topK,
+			alphas, eta, seed, globalStep, dict, words, docOffsets, numInitWords,
+			(uint64_t)numByTopicWord.cols(), (uint64_t)numByTopicDoc.cols(), gammaTopics, gammaWeights);
+	}
+
+	void CVB0LDA::read(std::istream& reader)
+	{
+		uint32_t version, k, t;
+		uint64_t v, d;
+		serializer::readMany(reader, serializer::to_key("TCVB"), version, k, t,
+			alphas, eta, seed, globalStep, dict, words, docOffsets, numInitWords, v, d, gammaTopics, gammaWeights);
+		if (version != 0) throw std::ios_base::failure{ "unsupported version of CVB0 LDA model" };
+		K = k;
+		topK = t;
+		const size_t T = getNumKept();
+		if (alphas.size() != K || docOffsets.empty() || docOffsets.back() != words.size()
+			|| v > dict.size() || d >= docOffsets.size() || docOffsets[d] != numInitWords
+			|| gammaTopics.size() != numInitWords * T || gammaWeights.size() != numInitWords * T) throw std::ios_base::failure{ "broken CVB0 LDA model" };
+		for (size_t i = 0; i < words.size(); ++i)
+		{
+			if (words[i] >= (i < numInitWords ? v : dict.size())) throw std::ios_base::failure{ "broken CVB0 LDA model" };
+		}
+		for (auto z : gammaTopics)
+		{
+			if (z >= K) throw std::ios_base::failure{ "broken CVB0 LDA model" };
+		}
+
+		numByTopicWord = Matrix::Zero(K, v);
+		numByTopicDoc = Matrix::Zero(K, d);
+		numByTopic = Vector::Zero(K);
+		rebuildCounts();
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "LDA.h"
+
+namespace tomoto
+{
+	struct CVB0LDAArgs
+	{
+		size_t k = 1;
+		Float alpha = (Float)0.1;
+		Float eta = (Float)0.01;
+		size_t topK = 8; // the number of topics kept in the variational distribution of each token, 0 for all topics
+		size_t seed = std::random_device{}();
+	};
+
+	/*
+	LDA trained by the zero-order collapsed variational Bayes (CVB0), which updates the topic distribution of each token
+	with the expected counts of the others. It converges in far fewer sweeps than Gibbs sampling.
+	Only the `topK` largest entries of the distribution of each token are kept, so the memory is `topK` * 6 bytes per token instead of K * 4.
+	Each sweep splits the documents into `numWorkers` ranges, and the topic-word counts updated by each worker are merged after the sweep.
+
+	* Asuncion, A., Welling, M., Smyth, P., & Teh, Y. W. (2009). On smoothing and inference for topic models. In Proceedings of the twenty-fifth conference on uncertainty in artificial intelligence (pp. 27-34).
+	*/
+	class CVB0LDA
+	{
+		size_t K = 0, topK = 0;
+		std::vector<Float> alphas; // Dim: (Topic, )
+		Float eta = 0;
+		uint64_t seed = 0, globalStep = 0;
+		Dictionary dict;
+
+		std::vector<Vid> words; // the words of all documents, concatenated
+		std::vector<uint64_t> docOffsets{ 0 }; // Dim: (Docs + 1, )
+		uint64_t numInitWords = 0; // the number of leading `words` whose gammas are initialized
+
+		// Dim: (Words, TopK), the truncated variational distribution of each token
+		std::vector<Tid> gammaTopics;
+		std::vector<Float> gammaWeights;
+
+		Matrix numByTopicDoc; // Dim: (Topic, Docs)
+		Matrix numByTopicWord; // Dim: (Topic, Vocabs)
+		Vector numByTopic; // Dim: (Topic, )
+
+		// the number of topics actually kept per token
+		size_t getNumKept() const { return std::min(topK ? topK : K, K); }
+
+		// initializes the gammas of the words added since the last call and grows the count matrices
+		void prepare();
+
+		// recomputes the counts of the initialized documents from their gammas
+		void rebuildCounts();
+
+		// Dim: (Topic, Vocabs), p(w|k) of the vocabularies used in training
+		Matrix getTopicWordProbs() const;
+
+		/*
+		computes the unnormalized distribution of a token into `dist` given the counts of its document `docCnt`,
+		of its word in each topic `wordCnt` and of each topic `topicCnt`, all of which exclude the token itself
+		*/
+		template<typename _DocCnt, typename _WordCnt>
+		void estimate(const _DocCnt& docCnt, const _WordCnt& wordCnt, const Vector& topicCnt, Float* dist) const;
+	public:
+		CVB0LDA(const CVB0LDAArgs& args = {});
+
+		size_t getK() const { return K; }
+		size_t getV() const { return dict.size(); }
+		size_t getTopK() const { return topK; }
+		Float getAlpha(size_t k) const { return alphas[k]; }
+		Float getEta() const { return eta; }
+		uint64_t getGlobalStep() const { return globalStep; }
+		size_t getNumDocs() const { return docOffsets.size() - 1; }
+		size_t getN() const { return words.size(); }
+		const Dictionary& getVocabDict() const { return dict; }
+
+		// if `addNew` is false, words out of the vocabulary are ignored
+		std::vector<Vid> toWids(const std::vector<std::string>& words, bool addNew);
+
+		// returns the index of the new document
+		size_t addDoc(const std::vector<Vid>& doc);
+
+		/*
+		runs `iteration` sweeps over all documents using `numWorkers` threads.
+		The result only depends on the seed and `numWorkers`, not on the scheduling of threads.
+		*/
+		void train(size_t iteration, size_t numWorkers);
+
+		double getLLPerWord(size_t numWorkers = 1) const;
+
+		// it returns the topic distribution of each document, and fills `ll` with the log-likelihood of each document if given
+		std::vector<std::vector<Float>> infer(const std::vector<std::vector<Vid>>& docs, size_t maxIter,
+			size_t numWorkers, std::vector<double>* ll = nullptr) const;
+
+		// p(w|k) of all vocabularies
+		std::vector<Float> getTopicWordDist(size_t k) const;
+
+		// p(k|d) of the document `docId`
+		std::vector<Float> getDocTopicDist(size_t docId) const;
+
+		void write(std::ostream& writer) const;
+		void read(std::istream& reader);
+	};
+}
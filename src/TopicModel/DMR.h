@@ -14,7 +14,7 @@ namespace tomoto
 		std::vector<uint64_t> multiMetadata;
 		Vector mdVec;
 		size_t mdHash = (size_t)-1;
-		mutable Matrix cachedAlpha;
+		mutable std::shared_ptr<const Matrix> cachedAlpha; // the alphas of an unknown metadata group, shared by `DMRModel::getCachedAlpha`
 
 		RawDoc::MiscType makeMisc(const ITopicModel* tm) const override;
 
@@ -14,6 +14,12 @@ namespace tomoto
 	struct ModelStateDMR : public ModelStateLDA<_tw>
 	{
 		Vector tmpK;
+		Vector gradBuf; // gradient and objective accumulated by the worker, Dim : (K * F * mdVecSize + 1)
+
+		uint64_t getMemoryUsage() const
+		{
+			return ModelStateLDA<_tw>::getMemoryUsage() + heapBytes(tmpK) + heapBytes(gradBuf);
+		}
 	};
 	
 	struct MdHash
@@ -55,12 +61,21 @@ namespace tomoto
 		Matrix lambda;
 		mutable std::unordered_map<std::pair<uint64_t, Vector>, size_t, MdHash> mdHashMap;
 		mutable Matrix cachedAlphas;
+		// alphas of metadata groups that only inferred documents have, shared by all documents of the same group
+		mutable std::unordered_map<std::pair<uint64_t, Vector>, std::shared_ptr<const Matrix>, MdHash> unknownAlphas;
+		static constexpr size_t maxUnknownAlphas = 65536;
+		// indices of documents grouped by `mdHash`: the group `g` is `mdGroupDocs[mdGroupPtr[g]:mdGroupPtr[g + 1]]`
+		std::vector<size_t> mdGroupPtr, mdGroupDocs;
 		Float sigma;
 		uint32_t F = 0, mdVecSize = 1;
 		uint32_t optimRepeat = 5;
 		Float alphaEps = 1e-10;
 		static constexpr Float maxLambda = 10;
 		static constexpr size_t maxBFGSIteration = 10;
+		// each evaluation is a full pass over the documents, and the line search rarely needs many since `lambda` moves little between calls
+		static constexpr size_t maxLineSearch = 8;
+		// true once `lambda` is optimized, after which `optimizeParameters` refines it instead of restarting from random points
+		bool warmLambda = false;
 
 		Dictionary metadataDict;
 		Dictionary multiMetadataDict;
@@ -72,62 +87,125 @@ namespace tomoto
 			return (x.array() - log(this->alpha)).pow(2).sum() / 2 / pow(sigma, 2);
 		}
 
+		/*
+		Documents sharing the same metadata share the same alpha, 
+		so alpha and its lgamma/digamma terms are evaluated once per group
+		and the gradient of a group is added with one outer product.
+		*/
 		Float evaluateLambdaObj(Eigen::Ref<Vector> x, Vector& g, ThreadPool& pool, _ModelState* localData) const
 		{
 			// if one of x is greater than maxLambda, return +inf for preventing searching more
 			if ((x.array() > maxLambda).any()) return INFINITY;
 
 			const auto K = this->K;
+			const size_t numGrad = K * F * mdVecSize;
+			const size_t numWorkers = pool.getNumWorkers();
+			const size_t numGroups = mdGroupPtr.empty() ? 0 : mdGroupPtr.size() - 1;
 
 			Float fx = -static_cast<const DerivedClass*>(this)->getNegativeLambdaLL(x, g);
 			Eigen::Map<Matrix> xReshaped{ x.data(), (Eigen::Index)K, (Eigen::Index)(F * mdVecSize) };
 
-			std::vector<std::future<Eigen::Array<Float, -1, 1>>> res;
-			const size_t chStride = pool.getNumWorkers() * 8;
+			for (size_t w = 0; w < numWorkers; ++w)
+			{
+				localData[w].gradBuf.setZero(numGrad + 1);
+				if (localData[w].tmpK.size() != K) localData[w].tmpK.resize(K);
+			}
+
+			std::vector<std::future<void>> res;
+			const size_t chStride = std::min(numWorkers * 8, numGroups);
 			for (size_t ch = 0; ch < chStride; ++ch)
 			{
-				res.emplace_back(pool.enqueue([&](size_t threadId)
+				res.emplace_back(pool.enqueue([&, ch](size_t threadId)
 				{
 					auto& tmpK = localData[threadId].tmpK;
-					if (!tmpK.size()) tmpK.resize(this->K);
-					Eigen::Array<Float, -1, 1> val = Eigen::Array<Float, -1, 1>::Zero(K * F * mdVecSize + 1);
+					auto& val = localData[threadId].gradBuf;
 					Eigen::Map<Matrix> grad{ val.data(), (Eigen::Index)K, (Eigen::Index)(F * mdVecSize) };
-					Float& fx = val[K * F * mdVecSize];
-					for (size_t docId = ch; docId < this->docs.size(); docId += chStride)
+					Float& fx = val[numGrad];
+					for (size_t gid = ch; gid < numGroups; gid += chStride)
 					{
-						const auto& doc = this->docs[docId];
-						auto alphaDoc = ((xReshaped.middleCols(doc.metadata * mdVecSize, mdVecSize) * doc.mdVec).array().exp() + alphaEps).matrix().eval();
+						const size_t b = mdGroupPtr[gid], e = mdGroupPtr[gid + 1];
+						const Float n = (Float)(e - b);
+						const auto& first = this->docs[mdGroupDocs[b]];
+						auto alphaDoc = ((xReshaped.middleCols(first.metadata * mdVecSize, mdVecSize) * first.mdVec).array().exp() + alphaEps).matrix().eval();
 						Float alphaSum = alphaDoc.sum();
+						const bool infSum = !std::isfinite(alphaSum) && alphaSum > 0;
+						fx -= n * Eigen::lgammaT(alphaDoc.array()).sum();
+						tmpK = (-n * Eigen::digammaT(alphaDoc.array())).matrix();
+						fx += n * math::lgammaT(alphaSum);
+						Float t = n * math::digammaT(alphaSum);
+						for (size_t i = b; i < e; ++i)
+						{
+							const auto& doc = this->docs[mdGroupDocs[i]];
+							auto shifted = doc.numByTopic.array().template cast<Float>() + alphaDoc.array();
+							fx += Eigen::lgammaT(shifted).sum();
+							tmpK.array() += Eigen::digammaT(shifted);
+							fx -= math::lgammaT(doc.getSumWordWeight() + alphaSum);
+							t -= math::digammaT(doc.getSumWordWeight() + alphaSum);
+						}
 						for (Tid k = 0; k < K; ++k)
 						{
-							fx -= math::lgammaT(alphaDoc[k]) - math::lgammaT(doc.numByTopic[k] + alphaDoc[k]);
 							if (!std::isfinite(alphaDoc[k]) && alphaDoc[k] > 0) tmpK[k] = 0;
-							else tmpK[k] = -(math::digammaT(alphaDoc[k]) - math::digammaT(doc.numByTopic[k] + alphaDoc[k]));
 						}
-						fx += math::lgammaT(alphaSum) - math::lgammaT(doc.getSumWordWeight() + alphaSum);
-						Float t = math::digammaT(alphaSum) - math::digammaT(doc.getSumWordWeight() + alphaSum);
-						if (!std::isfinite(alphaSum) && alphaSum > 0)
+						if (infSum)
 						{
 							fx = -INFINITY;
 							t = 0;
 						}
-						grad.middleCols(doc.metadata * mdVecSize, mdVecSize) -= (alphaDoc.array() * (tmpK.array() + t)).matrix() * doc.mdVec.transpose();
+						grad.middleCols(first.metadata * mdVecSize, mdVecSize) -= (alphaDoc.array() * (tmpK.array() + t)).matrix() * first.mdVec.transpose();
 					}
-					return val;
 				}));
 			}
-			for (auto& r : res)
+			for (auto& r : res) r.get();
+
+			// sums up the buffers of workers pairwise
+			for (size_t stride = 1; stride < numWorkers; stride *= 2)
 			{
-				auto ret = r.get();
-				fx += ret[K * F * mdVecSize];
-				g += ret.head(K * F * mdVecSize).matrix();
+				res.clear();
+				for (size_t w = 0; w + stride < numWorkers; w += stride * 2)
+				{
+					res.emplace_back(pool.enqueue([&, w, stride](size_t)
+					{
+						localData[w].gradBuf += localData[w + stride].gradBuf;
+					}));
+				}
+				for (auto& r : res) r.get();
 			}
+			fx += localData[0].gradBuf[numGrad];
+			g += localData[0].gradBuf.head(numGrad);
 
 			// positive fx is an error from limited precision of float.
 			if (fx > 0) return INFINITY;
 			return -fx;
 		}
 
+		void updateMdGroups()
+		{
+			const size_t numGroups = mdHashMap.size();
+			mdGroupPtr.assign(numGroups + 1, 0);
+			for (auto& doc : this->docs)
+			{
+				assert(doc.mdHash < numGroups);
+				++mdGroupPtr[doc.mdHash + 1];
+			}
+			std::partial_sum(mdGroupPtr.begin(), mdGroupPtr.end(), mdGroupPtr.begin());
+			mdGroupDocs.resize(this->docs.size());
+			std::vector<size_t> filled{ mdGroupPtr.begin(), mdGroupPtr.end() - 1 };
+			for (size_t i = 0; i < this->docs.size(); ++i)
+			{
+				mdGroupDocs[filled[this->docs[i].mdHash]++] = i;
+			}
+
+			// removes groups without documents
+			size_t numNonEmpty = 0;
+			for (size_t gid = 0; gid < numGroups; ++gid)
+			{
+				if (mdGroupPtr[gid] == mdGroupPtr[gid + 1]) continue;
+				mdGroupPtr[numNonEmpty++] = mdGroupPtr[gid];
+			}
+			mdGroupPtr[numNonEmpty] = this->docs.size();
+			mdGroupPtr.resize(numNonEmpty + 1);
+		}
+
 		void initParameters()
 		{
 			lambda = Eigen::Rand::normalLike(lambda, this->rg, 0, sigma);
@@ -137,22 +215,31 @@ namespace tomoto
 			}
 		}
 
+		/*
+		The first optimization picks the best of `optimRepeat` random starts.
+		The later ones start from the current `lambda` once, keeping the curvature pairs of the solver from the previous call,
+		so they usually converge in a few iterations, or exit after one evaluation if the gradient is already small.
+		*/
 		void optimizeParameters(ThreadPool& pool, _ModelState* localData, _RandGen* rgs)
 		{
 			Matrix bLambda;
 			Float fx = 0, bestFx = INFINITY;
-			for (size_t i = 0; i < optimRepeat; ++i)
+			size_t bestRepeat = 0;
+			updateMdGroups();
+			const size_t repeat = warmLambda ? 1 : optimRepeat;
+			for (size_t i = 0; i < repeat; ++i)
 			{
-				static_cast<DerivedClass*>(this)->initParameters();
+				if (!warmLambda) static_cast<DerivedClass*>(this)->initParameters();
 				int ret = solver.minimize([this, &pool, localData](Eigen::Ref<Vector> x, Vector& g)
 				{
 					return static_cast<DerivedClass*>(this)->evaluateLambdaObj(x, g, pool, localData);
-				}, Eigen::Map<Vector>(lambda.data(), lambda.size()), fx);
+				}, Eigen::Map<Vector>(lambda.data(), lambda.size()), fx, warmLambda);
 
 				if (fx < bestFx)
 				{
 					bLambda = lambda;
 					bestFx = fx;
+					bestRepeat = i;
 					//printf("\t(%d) %e\n", ret, fx);
 				}
 			}
@@ -160,7 +247,10 @@ namespace tomoto
 			{
 				throw exc::TrainingError{ "optimizing parameters has been failed!" };
 			}
+			// the pairs kept by the solver are those of the last start, which are useless for others
+			if (bestRepeat + 1 != repeat) solver.clearHistory();
 			lambda = bLambda;
+			warmLambda = true;
 			updateCachedAlphas();
 			//std::cerr << fx << std::endl;
 		}
@@ -169,6 +259,8 @@ namespace tomoto
 		{
 			std::cerr << "Failed to optimize! Reset prior and retry!" << std::endl;
 			lambda.setZero();
+			warmLambda = false;
+			solver.clearHistory();
 			updateCachedAlphas();
 			return 0;
 		}
@@ -181,14 +273,35 @@ namespace tomoto
 			}
 			else
 			{
-				if (!doc.cachedAlpha.size())
+				if (!doc.cachedAlpha)
 				{
-					doc.cachedAlpha = (lambda.middleCols(doc.metadata * mdVecSize, mdVecSize) * doc.mdVec).array().exp() + alphaEps;
+					auto p = std::make_pair(doc.metadata, doc.mdVec);
+					std::lock_guard<std::mutex> lock{ this->getCacheMutex() };
+					auto it = unknownAlphas.find(p);
+					if (it == unknownAlphas.end())
+					{
+						// documents keep their own references, so dropping the whole cache is safe
+						if (unknownAlphas.size() >= maxUnknownAlphas) unknownAlphas.clear();
+						auto alpha = std::make_shared<Matrix>((lambda.middleCols(doc.metadata * mdVecSize, mdVecSize) * doc.mdVec).array().exp() + alphaEps);
+						it = unknownAlphas.emplace(std::move(p), std::move(alpha)).first;
+					}
+					doc.cachedAlpha = it->second;
 				}
-				return doc.cachedAlpha.col(0);
+				return doc.cachedAlpha->col(0);
 			}
 		}
 
+		static constexpr bool isSamplingMethodSupported(SamplingMethod method)
+		{
+			return method == SamplingMethod::dense
+				|| (method == SamplingMethod::mh && std::is_same<_Derived, void>::value);
+		}
+
+		Float getTopicPrior(const _DocType& doc, Tid k) const
+		{
+			return getCachedAlpha(doc)[k];
+		}
+
 		template<bool _asymEta>
 		Float* getZLikelihoods(_ModelState& ld, const _DocType& doc, size_t docId, size_t vid) const
 		{
@@ -197,6 +310,12 @@ namespace tomoto
 			auto etaHelper = this->template getEtaHelper<_asymEta>();
 			auto alphas = getCachedAlpha(doc);
 			auto& zLikelihood = ld.zLikelihood;
+			if (!_asymEta && ld.invTopicDenom.size())
+			{
+				sample::prefixSumOfProducts(zLikelihood.data(), doc.numByTopic.data(), alphas.data(),
+					ld.numByTopicWord.col(vid).data(), this->eta, ld.invTopicDenom.data(), this->K);
+				return &zLikelihood[0];
+			}
 			zLikelihood = (doc.numByTopic.array().template cast<Float>() + alphas.array())
 				* (ld.numByTopicWord.col(vid).array().template cast<Float>() + etaHelper.getEta(vid))
 				/ (ld.numByTopic.array().template cast<Float>() + etaHelper.getEtaSum());
@@ -212,13 +331,8 @@ namespace tomoto
 
 			auto alphaDoc = getCachedAlpha(doc);
 			
-			Float ll = 0;
 			Float alphaSum = alphaDoc.sum();
-			for (Tid k = 0; k < K; ++k)
-			{
-				ll += math::lgammaT(doc.numByTopic[k] + alphaDoc[k]);
-				ll -= math::lgammaT(alphaDoc[k]);
-			}
+			Float ll = Eigen::lgammaT_subt(alphaDoc.array(), doc.numByTopic.array().template cast<Float>()).sum();
 			ll -= math::lgammaT(doc.getSumWordWeight() + alphaSum);
 			ll += math::lgammaT(alphaSum);
 			return ll;
@@ -235,11 +349,7 @@ namespace tomoto
 				auto& doc = *_first;
 				auto alphaDoc = getCachedAlpha(doc);
 				Float alphaSum = alphaDoc.sum();
-
-				for (Tid k = 0; k < K; ++k)
-				{
-					ll += math::lgammaT(doc.numByTopic[k] + alphaDoc[k]) - math::lgammaT(alphaDoc[k]);
-				}
+				ll += Eigen::lgammaT_subt(alphaDoc.array(), doc.numByTopic.array().template cast<Float>()).sum();
 				ll -= math::lgammaT(doc.getSumWordWeight() + alphaSum) - math::lgammaT(alphaSum);
 			}
 			return ll;
@@ -253,24 +363,24 @@ namespace tomoto
 			const size_t V = this->realV;
 
 			double ll = -(lambda.array() - log(alpha)).pow(2).sum() / 2 / pow(sigma, 2);
-			// topic-word distribution
-			auto lgammaEta = math::lgammaT(eta);
+			// topic-word distribution, where zero counts add exactly 0
 			ll += math::lgammaT(V*eta) * K;
 			for (Tid k = 0; k < K; ++k)
 			{
 				ll -= math::lgammaT(ld.numByTopic[k] + V * eta);
-				for (Vid v = 0; v < V; ++v)
-				{
-					if (!ld.numByTopicWord(k, v)) continue;
-					ll += math::lgammaT(ld.numByTopicWord(k, v) + eta) - lgammaEta;
-				}
 			}
+			ll += this->sumChunks(nullptr, V, this->llChunkVocabs, [&](size_t b, size_t e)
+			{
+				return (double)Eigen::lgammaT_subt(Eigen::Array<Float, -1, -1>::Constant(K, e - b, eta),
+					ld.numByTopicWord.middleCols(b, e - b).array().template cast<Float>()).sum();
+			});
 			return ll;
 		}
 
 		void updateCachedAlphas() const
 		{
 			cachedAlphas.resize(this->K, mdHashMap.size());
+			unknownAlphas.clear();
 
 			for (auto& p : mdHashMap)
 			{
@@ -289,13 +399,20 @@ namespace tomoto
 				doc.mdVec[x + 1] = 1;
 			}
 
-			auto p = std::make_pair(doc.metadata, doc.mdVec);
+			doc.mdHash = getMdHash(std::make_pair(doc.metadata, doc.mdVec), docId != (size_t)-1);
+		}
+
+		/*
+		returns the group of the metadata `p`, adding a new group if `addNew` is true.
+		Inferred documents only look their groups up, so that concurrent inference never modifies the model,
+		and those of unknown groups get their own alphas in `getCachedAlpha`.
+		*/
+		size_t getMdHash(const std::pair<uint64_t, Vector>& p, bool addNew) const
+		{
 			auto it = mdHashMap.find(p);
-			if (it == mdHashMap.end())
-			{
-				it = mdHashMap.emplace(p, mdHashMap.size()).first;
-			}
-			doc.mdHash = it->second;
+			if (it != mdHashMap.end()) return it->second;
+			if (!addNew) return -1;
+			return mdHashMap.emplace(p, mdHashMap.size()).first->second;
 		}
 
 		void initGlobalState(bool initDocs)
@@ -338,7 +455,9 @@ namespace tomoto
 			if (_Flags & flags::continuous_doc_data) this->numByTopicDoc = Eigen::Matrix<WeightType, -1, -1>::Zero(this->K, this->docs.size());
 			LBFGSpp::LBFGSParam<Float> param;
 			param.max_iterations = maxBFGSIteration;
+			param.max_linesearch = maxLineSearch;
 			solver = decltype(solver){ param };
+			warmLambda = false;
 		}
 
 		void prepareShared()
@@ -436,6 +555,11 @@ namespace tomoto
 			));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "documents of this model need misc data, so they should be added by `addDoc`.");
+		}
+
 		GETTER(F, size_t, F);
 		GETTER(MdVecSize, size_t, mdVecSize);
 		GETTER(Sigma, Float, sigma);
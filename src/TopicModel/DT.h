@@ -63,6 +63,9 @@ namespace tomoto
 		virtual void setShapeB(Float a) = 0;
 		virtual void setShapeC(Float a) = 0;
 
+		virtual bool getTimePartition() const = 0;
+		virtual void setTimePartition(bool enabled) = 0;
+
 		virtual Float getAlpha(size_t k, size_t t) const = 0;
 		virtual std::vector<Float> getPhi(size_t k, size_t t) const = 0;
 	};
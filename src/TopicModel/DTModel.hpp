@@ -21,6 +21,22 @@ namespace tomoto
 		Eigen::Matrix<WeightType, -1, -1> numByTopic; // Dim: (Topic, Time)
 		Eigen::Matrix<WeightType, -1, -1> numByTopicWord; // Dim: (Topic * Time, Vocabs)
 		//ShareableMatrix<WeightType, -1, -1> numByTopicWord; // Dim: (Topic * Time, Vocabs)
+
+		uint64_t getMemoryUsage() const
+		{
+			return heapBytes(numByTopic) + heapBytes(numByTopicWord);
+		}
+
+		uint64_t getTopicWordMemoryUsage() const
+		{
+			return heapBytes(numByTopicWord);
+		}
+
+		uint64_t getViewedMemoryUsage() const
+		{
+			return 0;
+		}
+
 		DEFINE_SERIALIZER(numByTopic, numByTopicWord);
 	};
 
@@ -55,6 +71,12 @@ namespace tomoto
 		std::vector<uint32_t> numDocsByTime; // Dim: (Time)
 		Matrix phi; // Dim: (Word, Topic * Time)
 		std::vector<sample::AliasMethod<>> wordAliasTables; // Dim: (Word * Time)
+		std::vector<Matrix> phiGradBuf; // Dim: (Worker) x (Word chunk, Time), reused by _sampleGlobalLevel
+		std::vector<Eigen::Array<Float, -1, 1>> noiseBuf; // Dim: (Worker) x (Word chunk)
+		bool timePartition = false;
+		// the documents each worker samples with `timePartition`, which are those of the timepoints it owns
+		mutable std::vector<std::vector<size_t>> docsByWorker;
+		mutable bool timePartitionedIteration = false;
 
 		template<int _inc>
 		inline void addWordTo(_ModelState& ld, _DocType& doc, size_t pid, Vid vid, Tid tid) const
@@ -140,10 +162,73 @@ namespace tomoto
 			}
 		}
 
+		/*
+		With `timePartition`, ParallelScheme::partition gives each worker whole timepoints instead of a block of the vocabulary.
+		The counts of the timepoint `t` are the rows from `K * t` of numByTopicWord and the column `t` of numByTopic,
+		which no other worker touches, so the workers sample on the global state without copying it.
+		*/
+		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
+		void performSampling(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
+			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd) const
+		{
+			if (_ps != ParallelScheme::partition || _infer || docsByWorker.size() != pool.getNumWorkers())
+			{
+				if (!_infer) timePartitionedIteration = false;
+				return BaseClass::template performSampling<_ps, _infer>(pool, localData, rgs, res, docFirst, docLast, edd);
+			}
+
+			auto& gs = const_cast<_ModelState&>(this->globalState);
+			res = pool.enqueueToAll([&](size_t threadId)
+			{
+				for (auto id : docsByWorker[threadId])
+				{
+					static_cast<const DerivedClass*>(this)->presampleDocument(docFirst[id], id, gs, rgs[threadId], this->globalStep);
+					static_cast<const DerivedClass*>(this)->template sampleDocument<ParallelScheme::none, _infer>(
+						docFirst[id], edd, id, gs, rgs[threadId], this->globalStep);
+				}
+			});
+			for (auto& r : res) r.get();
+			res.clear();
+			timePartitionedIteration = true;
+		}
+
+		// assigns the timepoints to the workers, the ones of the most words first to the least loaded worker
+		template<typename _DocIter, typename _ExtraDocData>
+		void updatePartition(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, _DocIter first, _DocIter last, _ExtraDocData& edd) const
+		{
+			docsByWorker.clear();
+			if (!timePartition) return BaseClass::updatePartition(pool, globalState, localData, first, last, edd);
+
+			const size_t numWorkers = pool.getNumWorkers();
+			std::vector<size_t> cntByTime(T), times(T), load(numWorkers), ownerOf(T);
+			for (auto it = first; it != last; ++it) cntByTime[it->timepoint] += it->words.size();
+			std::iota(times.begin(), times.end(), 0);
+			std::stable_sort(times.begin(), times.end(), [&](size_t a, size_t b) { return cntByTime[a] > cntByTime[b]; });
+			for (auto t : times)
+			{
+				ownerOf[t] = std::min_element(load.begin(), load.end()) - load.begin();
+				load[ownerOf[t]] += cntByTime[t];
+			}
+
+			docsByWorker.resize(numWorkers);
+			size_t i = 0;
+			for (auto it = first; it != last; ++it, ++i) docsByWorker[ownerOf[it->timepoint]].emplace_back(i);
+		}
+
 		template<ParallelScheme _ps, typename _ExtraDocData>
 		void mergeState(ThreadPool& pool, _ModelState& globalState, _ModelState& tState, _ModelState* localData, _RandGen*, const _ExtraDocData& edd) const
 		{
-			if (_ps == ParallelScheme::copy_merge)
+			// the workers have sampled on the global state, which only needs the weighted counts fixed
+			if (_ps == ParallelScheme::partition && timePartitionedIteration)
+			{
+				if (_tw != TermWeight::one)
+				{
+					globalState.numByTopicWord = globalState.numByTopicWord.cwiseMax(0);
+					Eigen::Map<Eigen::Matrix<WeightType, -1, 1>>{ globalState.numByTopic.data(), globalState.numByTopic.size() }
+						= globalState.numByTopicWord.rowwise().sum();
+				}
+			}
+			else if (_ps == ParallelScheme::copy_merge)
 			{
 				tState = globalState;
 				globalState = localData[0];
@@ -185,86 +270,117 @@ namespace tomoto
 		void _sampleGlobalLevel(ThreadPool* pool, _ModelState*, _RandGen* rgs, _DocIter first, _DocIter last)
 		{
 			if (!this->realV) return;
+			const size_t V = this->realV;
 			const auto K = this->K;
 			const Float eps = shapeA * (std::pow(shapeB + 1 + this->globalStep, -shapeC));
+			const size_t numWorkers = pool ? pool->getNumWorkers() : 1;
 
-			// sampling phi
-			for (size_t k = 0; k < K; ++k)
+			// calls `f(threadId, b, e)` for `numChunks` even ranges of [0, n) on the pool
+			auto forChunks = [&](size_t n, size_t numChunks, auto&& f)
 			{
-				Matrix phiGrad{ (Eigen::Index)this->realV, (Eigen::Index)T };
-				for (size_t t = 0; t < T; ++t)
+				numChunks = std::max(std::min(numChunks, n), (size_t)1);
+				if (!pool)
 				{
-					auto phi_tk = phi.col(k + K * t);
-					Vector estimatedCnt = (phi_tk.array() - phi_tk.maxCoeff()).exp();
-					estimatedCnt *= this->globalState.numByTopic(k, t) / estimatedCnt.sum();
-
-					Vector grad = this->globalState.numByTopicWord.row(k + K * t).template cast<Float>();
-					grad -= estimatedCnt;
-					auto epsNoise = Eigen::Rand::normal<Eigen::Array<Float, -1, 1>>(this->realV, 1, *rgs) * eps;
-					if (t == 0)
-					{
-						if (T > 1)
-						{
-							const Float phiVar2 = 100 / (100 + phiVar);
-							auto prior = (phi.col(k + K * (t + 1)) * phiVar2 - phi_tk) / std::max(phiVar / 2, eps * 2);
-							phiGrad.col(t) = (eps / 2) * (prior.array() + grad.array()) + epsNoise;
-						}
-						else
-						{
-							phiGrad.col(t) = (eps / 2) * grad.array() + epsNoise;
-						}
-					}
-					else if (t == T - 1)
-					{
-						auto prior = (phi.col(k + K * (t - 1)) - phi_tk) / std::max(phiVar, eps * 2);
-						phiGrad.col(t) = (eps / 2) * (prior.array() + grad.array()) + epsNoise;
-					}
-					else
+					f(0, 0, n);
+					return;
+				}
+				std::vector<std::future<void>> futures;
+				futures.reserve(numChunks);
+				for (size_t ch = 0; ch < numChunks; ++ch)
+				{
+					futures.emplace_back(pool->enqueue([&, ch](size_t threadId)
 					{
-						auto prior = (phi.col(k + K * (t + 1)) + phi.col(k + K * (t - 1)) - 2 * phi_tk) / std::max(phiVar, eps * 2);
-						phiGrad.col(t) = (eps / 2) * (prior.array() + grad.array()) + epsNoise;
-					}
+						f(threadId, n * ch / numChunks, n * (ch + 1) / numChunks);
+					}));
 				}
+				for (auto& r : futures) r.get();
+			};
 
-				for (size_t t = 0; t < T; ++t)
+			// the estimated counts are normalized over the whole vocabulary, so the normalizers are found first
+			Vector phiMax{ (Eigen::Index)(K * T) }, phiSum{ (Eigen::Index)(K * T) };
+			forChunks(K * T, numWorkers * 4, [&](size_t, size_t b, size_t e)
+			{
+				for (size_t i = b; i < e; ++i)
 				{
-					phi.col(k + K * t) += phiGrad.col(t);
+					phiMax[i] = phi.col(i).maxCoeff();
+					phiSum[i] = (phi.col(i).array() - phiMax[i]).exp().sum();
 				}
+			});
+
+			/*
+			sampling phi and updating alias tables for word proposal.
+			Each chunk of the vocabulary is updated for all topics and times by a worker,
+			so that it can rebuild the alias tables of its words as soon as their phi is done.
+			*/
+			const size_t numChunks = std::min(numWorkers * 8, V);
+			phiGradBuf.resize(numWorkers);
+			noiseBuf.resize(numWorkers);
+			for (size_t i = 0; i < numWorkers; ++i)
+			{
+				phiGradBuf[i].resize((V + numChunks - 1) / numChunks, T);
+				noiseBuf[i].resize((V + numChunks - 1) / numChunks);
 			}
 
-			Matrix newAlphas = Matrix::Zero(alphas.rows(), alphas.cols());
-			for (size_t t = 0; t < T; ++t)
+			forChunks(V, numChunks, [&](size_t threadId, size_t vb, size_t ve)
 			{
-				// update alias tables for word proposal
-				if (pool)
+				const size_t n = ve - vb;
+				auto phiGrad = phiGradBuf[threadId].topRows(n);
+				auto epsNoise = noiseBuf[threadId].head(n);
+				for (size_t k = 0; k < K; ++k)
 				{
-					const size_t chStride = pool->getNumWorkers() * 8;
-					std::vector<std::future<void>> futures;
-					futures.reserve(chStride);
-					for (size_t ch = 0; ch < chStride; ++ch)
+					for (size_t t = 0; t < T; ++t)
 					{
-						futures.emplace_back(pool->enqueue([&, ch, chStride](size_t)
+						auto phi_tk = phi.col(k + K * t).segment(vb, n);
+						Float norm = this->globalState.numByTopic(k, t) / phiSum[k + K * t];
+						auto grad = this->globalState.numByTopicWord.row(k + K * t).segment(vb, n).transpose().array().template cast<Float>()
+							- (phi_tk.array() - phiMax[k + K * t]).exp() * norm;
+						epsNoise = Eigen::Rand::normal<Eigen::Array<Float, -1, 1>>(n, 1, rgs[threadId]) * eps;
+						if (t == 0)
 						{
-							for (Vid v = ch; v < this->realV; v += chStride)
+							if (T > 1)
 							{
-								Eigen::Array<Float, -1, 1> ps = phi.row(v).segment(K * t, K);
-								ps = (ps - ps.maxCoeff()).exp();
-								wordAliasTables[v + this->realV * t].buildTable(ps.data(), ps.data() + ps.size());
+								const Float phiVar2 = 100 / (100 + phiVar);
+								auto prior = (phi.col(k + K * (t + 1)).segment(vb, n) * phiVar2 - phi_tk) / std::max(phiVar / 2, eps * 2);
+								phiGrad.col(t) = (eps / 2) * (prior.array() + grad) + epsNoise;
 							}
-						}));
+							else
+							{
+								phiGrad.col(t) = (eps / 2) * grad + epsNoise;
+							}
+						}
+						else if (t == T - 1)
+						{
+							auto prior = (phi.col(k + K * (t - 1)).segment(vb, n) - phi_tk) / std::max(phiVar, eps * 2);
+							phiGrad.col(t) = (eps / 2) * (prior.array() + grad) + epsNoise;
+						}
+						else
+						{
+							auto prior = (phi.col(k + K * (t + 1)).segment(vb, n) + phi.col(k + K * (t - 1)).segment(vb, n) - 2 * phi_tk) / std::max(phiVar, eps * 2);
+							phiGrad.col(t) = (eps / 2) * (prior.array() + grad) + epsNoise;
+						}
+					}
+
+					for (size_t t = 0; t < T; ++t)
+					{
+						phi.col(k + K * t).segment(vb, n) += phiGrad.col(t);
 					}
-					for (auto& f : futures) f.get();
 				}
-				else
+
+				Eigen::Array<Float, -1, 1> ps{ (Eigen::Index)K };
+				for (size_t t = 0; t < T; ++t)
 				{
-					for (Vid v = 0; v < this->realV; ++v)
+					for (Vid v = vb; v < ve; ++v)
 					{
-						Eigen::Array<Float, -1, 1> ps = phi.row(v).segment(K * t, K);
+						ps = phi.row(v).segment(K * t, K);
 						ps = (ps - ps.maxCoeff()).exp();
-						wordAliasTables[v + this->realV * t].buildTable(ps.data(), ps.data() + ps.size());
+						wordAliasTables[v + V * t].buildTable(ps.data(), ps.data() + ps.size());
 					}
 				}
+			});
 
+			Matrix newAlphas = Matrix::Zero(alphas.rows(), alphas.cols());
+			for (size_t t = 0; t < T; ++t)
+			{
 				// sampling alpha
 				Float lambda = 2 / alphaVar + numDocsByTime[t] / etaVar;
 
@@ -312,6 +428,13 @@ namespace tomoto
 		{
 		}
 
+		template<ParallelScheme _ps>
+		void distributeMergedState(ThreadPool& pool, _ModelState& globalState, _ModelState* localData) const
+		{
+			if (_ps == ParallelScheme::partition && timePartitionedIteration) return;
+			BaseClass::template distributeMergedState<_ps>(pool, globalState, localData);
+		}
+
 		template<typename _ExtraDocData>
 		void distributePartition(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, const _ExtraDocData& edd) const
 		{
@@ -394,6 +517,28 @@ namespace tomoto
 			return ll;
 		}
 
+		void addMemoryUsage(MemoryUsage& ret) const
+		{
+			BaseClass::addMemoryUsage(ret);
+			uint64_t aliasBytes = heapBytes(wordAliasTables);
+			for (auto& a : wordAliasTables) aliasBytes += a.getMemoryUsage();
+			ret.emplace_back("wordAliasTables", aliasBytes);
+			uint64_t phiBytes = heapBytes(phi);
+			for (auto& m : phiGradBuf) phiBytes += heapBytes(m);
+			for (auto& a : noiseBuf) phiBytes += heapBytes(a);
+			ret.emplace_back("phi", phiBytes);
+			ret.emplace_back("etaByDoc", heapBytes(etaByDoc));
+		}
+
+		// the workers of ParallelScheme::partition copy only the columns of their own vocabularies, or nothing with `timePartition`
+		uint64_t estimateTrainingOverhead(size_t numWorkers, ParallelScheme ps) const
+		{
+			if (ps != ParallelScheme::partition) return BaseClass::estimateTrainingOverhead(numWorkers, ps);
+			if (timePartition) return 0;
+			const uint64_t topicWord = this->globalState.getTopicWordMemoryUsage();
+			return numWorkers * (this->globalState.getMemoryUsage() - topicWord) + topicWord;
+		}
+
 		void initGlobalState(bool initDocs)
 		{
 			const size_t V = this->realV;
@@ -443,6 +588,12 @@ namespace tomoto
 			addWordTo<1>(ld, doc, i, w, z);
 		}
 
+		// topics of all timepoints, where topic `k` at timepoint `t` is `k + K * t`
+		size_t getNumWidsTopics() const
+		{
+			return this->K * T;
+		}
+
 		std::vector<Float> _getWidsByTopic(size_t tid, bool normalize = true) const
 		{
 			const size_t V = this->realV;
@@ -537,6 +688,11 @@ namespace tomoto
 			return std::make_unique<_DocType>(_updateDoc(doc, rawDoc.template getMisc<uint32_t>("timepoint")));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "documents of this model need misc data, so they should be added by `addDoc`.");
+		}
+
 		Float getAlpha(size_t k, size_t t) const override
 		{
 			if (alphas.size()) return alphas(k, t);
@@ -552,5 +708,8 @@ namespace tomoto
 		void setShapeA(Float a) override { shapeA = a; }
 		void setShapeB(Float b) override { shapeB = b; }
 		void setShapeC(Float c) override { shapeC = c; }
+
+		bool getTimePartition() const override { return timePartition; }
+		void setTimePartition(bool enabled) override { timePartition = enabled; }
 	};
 }
@@ -0,0 +1,235 @@
+#include <queue>
+#include "DocIndex.h"
+#include "BatchUtils.hpp"
+#include "../Utils/Half.hpp"
+
+namespace tomoto
+{
+	namespace detail
+	{
+		// the number of documents whose nearest centroids are found by one matrix product
+		static constexpr size_t docIndexBlock = 256;
+
+		// writes the index of the largest coefficient of each column of `scores` into `out`
+		inline void argmaxCols(const Matrix& scores, uint32_t* out)
+		{
+			for (Eigen::Index c = 0; c < scores.cols(); ++c)
+			{
+				Eigen::Index r;
+				scores.col(c).maxCoeff(&r);
+				out[c] = (uint32_t)r;
+			}
+		}
+	}
+
+	void DocIndex::embed(const Float* theta, Float* out) const
+	{
+		Float sum = 0;
+		for (size_t k = 0; k < K; ++k)
+		{
+			const Float t = std::isfinite(theta[k]) ? std::max(theta[k], (Float)0) : 0;
+			out[k] = metric == DocMetric::cosine ? t : std::sqrt(t);
+			sum += out[k] * out[k];
+		}
+		// a document without topics is put at the same distance from all others
+		if (!(sum > 0))
+		{
+			std::fill(out, out + K, 1 / std::sqrt((Float)K));
+			return;
+		}
+		const Float norm = 1 / std::sqrt(sum);
+		for (size_t k = 0; k < K; ++k) out[k] *= norm;
+	}
+
+	Float DocIndex::distance(const Float* q, const uint16_t* d) const
+	{
+		auto& table = detail::getHalfTable();
+		if (metric == DocMetric::js)
+		{
+			// both are the square roots of the distributions
+			Float ret = 0;
+			for (size_t k = 0; k < K; ++k)
+			{
+				const Float p = q[k] * q[k], r = table[d[k]] * table[d[k]], m = (p + r) / 2;
+				if (p > 0) ret += p * std::log(p / m);
+				if (r > 0) ret += r * std::log(r / m);
+			}
+			return std::max(ret / 2, (Float)0);
+		}
+
+		Float dot = 0;
+		for (size_t k = 0; k < K; ++k) dot += q[k] * table[d[k]];
+		if (metric == DocMetric::cosine) return std::max(1 - dot, (Float)0);
+		return std::sqrt(std::max(1 - dot, (Float)0));
+	}
+
+	void DocIndex::trainCentroids(const std::vector<uint16_t>& vecs, size_t n, const DocIndexArgs& args, size_t numWorkers)
+	{
+		auto& table = detail::getHalfTable();
+		const size_t L = centroids.cols();
+		// k-means runs on evenly spaced samples of the documents
+		const size_t numSamples = std::min(n, L * 64);
+		Matrix samples{ K, numSamples };
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			const uint16_t* v = &vecs[(n * i / numSamples) * K];
+			for (size_t k = 0; k < K; ++k) samples(k, i) = table[v[k]];
+		}
+
+		std::mt19937_64 rg{ args.seed };
+		std::vector<size_t> order(numSamples);
+		std::iota(order.begin(), order.end(), 0);
+		std::shuffle(order.begin(), order.end(), rg);
+		for (size_t l = 0; l < L; ++l) centroids.col(l) = samples.col(order[l]);
+
+		std::vector<uint32_t> assigned(numSamples);
+		for (size_t it = 0; it < args.trainIter; ++it)
+		{
+			detail::forEachRange((numSamples + detail::docIndexBlock - 1) / detail::docIndexBlock, numWorkers, [&](size_t, size_t b, size_t e)
+			{
+				Matrix scores;
+				for (size_t i = b; i < e; ++i)
+				{
+					const size_t s = i * detail::docIndexBlock, cnt = std::min(detail::docIndexBlock, numSamples - s);
+					scores.noalias() = centroids.transpose() * samples.middleCols(s, cnt);
+					detail::argmaxCols(scores, &assigned[s]);
+				}
+			});
+
+			Matrix sums = Matrix::Zero(K, L);
+			for (size_t i = 0; i < numSamples; ++i) sums.col(assigned[i]) += samples.col(i);
+			for (size_t l = 0; l < L; ++l)
+			{
+				const Float norm = sums.col(l).norm();
+				// an empty list takes a random sample again
+				if (norm > 0) centroids.col(l) = sums.col(l) / norm;
+				else centroids.col(l) = samples.col(order[rg() % numSamples]);
+			}
+		}
+	}
+
+	DocIndex::DocIndex(size_t n, size_t k, const ThetaFn& getTheta, const DocIndexArgs& args, size_t numWorkers)
+		: metric{ args.metric }, K{ k }
+	{
+		if (!K) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "wrong K value (K = 0)");
+		if ((size_t)metric >= (size_t)DocMetric::size) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "wrong metric");
+		if (!n) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "no documents to index");
+		if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+
+		std::vector<uint16_t> vecs(n * K);
+		detail::forEachRange(n, numWorkers, [&](size_t, size_t b, size_t e)
+		{
+			std::vector<Float> theta(K), emb(K);
+			for (size_t i = b; i < e; ++i)
+			{
+				getTheta(i, theta.data());
+				embed(theta.data(), emb.data());
+				for (size_t j = 0; j < K; ++j) vecs[i * K + j] = detail::floatToHalf(emb[j]);
+			}
+		});
+
+		const size_t L = std::max(std::min(args.numLists ? args.numLists : (size_t)std::round(std::sqrt((double)n)), n), (size_t)1);
+		centroids = Matrix::Zero(K, L);
+		trainCentroids(vecs, n, args, numWorkers);
+
+		auto& table = detail::getHalfTable();
+		std::vector<uint32_t> assigned(n);
+		detail::forEachRange((n + detail::docIndexBlock - 1) / detail::docIndexBlock, numWorkers, [&](size_t, size_t b, size_t e)
+		{
+			Matrix block, scores;
+			for (size_t i = b; i < e; ++i)
+			{
+				const size_t s = i * detail::docIndexBlock, cnt = std::min(detail::docIndexBlock, n - s);
+				block.resize(K, cnt);
+				for (size_t j = 0; j < cnt; ++j)
+				{
+					for (size_t t = 0; t < K; ++t) block(t, j) = table[vecs[(s + j) * K + t]];
+				}
+				scores.noalias() = centroids.transpose() * block;
+				detail::argmaxCols(scores, &assigned[s]);
+			}
+		});
+
+		// groups the documents by their lists with a counting sort, which keeps the order of documents in each list
+		listOffsets.assign(L + 1, 0);
+		for (auto l : assigned) ++listOffsets[l + 1];
+		std::partial_sum(listOffsets.begin(), listOffsets.end(), listOffsets.begin());
+		listDocs.resize(n);
+		std::vector<uint64_t> pos{ listOffsets.begin(), listOffsets.end() - 1 };
+		for (size_t i = 0; i < n; ++i) listDocs[pos[assigned[i]]++] = i;
+
+		codes.resize(n * K);
+		detail::forEachRange(n, numWorkers, [&](size_t, size_t b, size_t e)
+		{
+			for (size_t i = b; i < e; ++i)
+			{
+				std::copy(&vecs[listDocs[i] * K], &vecs[listDocs[i] * K] + K, &codes[i * K]);
+			}
+		});
+	}
+
+	void DocIndex::search(const Float* queries, size_t numQueries, size_t topN, size_t numProbes, size_t numWorkers,
+		std::vector<int64_t>& ids, std::vector<Float>& dists) const
+	{
+		ids.assign(numQueries * topN, -1);
+		dists.assign(numQueries * topN, INFINITY);
+		if (!topN || listDocs.empty()) return;
+		const size_t L = getNumLists();
+		numProbes = std::max(std::min(numProbes, L), (size_t)1);
+
+		detail::forEachRange(numQueries, numWorkers, [&](size_t, size_t b, size_t e)
+		{
+			Vector q{ K }, scores;
+			std::vector<uint32_t> lists(L);
+			std::priority_queue<std::pair<Float, uint64_t>> heap;
+			for (size_t i = b; i < e; ++i)
+			{
+				embed(queries + i * K, q.data());
+				scores.noalias() = centroids.transpose() * q;
+				std::iota(lists.begin(), lists.end(), 0);
+				std::partial_sort(lists.begin(), lists.begin() + numProbes, lists.end(), [&](uint32_t a, uint32_t c)
+				{
+					return scores[a] > scores[c];
+				});
+
+				for (size_t p = 0; p < numProbes; ++p)
+				{
+					for (size_t j = listOffsets[lists[p]]; j < listOffsets[lists[p] + 1]; ++j)
+					{
+						const Float d = distance(q.data(), &codes[j * K]);
+						if (heap.size() < topN) heap.emplace(d, listDocs[j]);
+						else if (std::make_pair(d, listDocs[j]) < heap.top())
+						{
+							heap.pop();
+							heap.emplace(d, listDocs[j]);
+						}
+					}
+				}
+
+				for (size_t r = heap.size(); r-- > 0; heap.pop())
+				{
+					ids[i * topN + r] = (int64_t)heap.top().second;
+					dists[i * topN + r] = heap.top().first;
+				}
+			}
+		});
+	}
+
+	void DocIndex::write(std::ostream& writer) const
+	{
+		serializer::writeMany(writer, serializer::to_key("TDIX"), (uint32_t)0, (uint32_t)metric, (uint32_t)K,
+			centroids, listOffsets, listDocs, codes);
+	}
+
+	void DocIndex::read(std::istream& reader)
+	{
+		uint32_t version, m, k;
+		serializer::readMany(reader, serializer::to_key("TDIX"), version, m, k, centroids, listOffsets, listDocs, codes);
+		if (version != 0) throw std::ios_base::failure{ "unsupported version of document index" };
+		metric = (DocMetric)m;
+		K = k;
+		if (m >= (uint32_t)DocMetric::size || !K || (size_t)centroids.rows() != K
+			|| listOffsets.size() != (size_t)centroids.cols() + 1 || listOffsets.front() != 0 || listOffsets.back() != listDocs.size()
+			|| codes.size() != listDocs.size() * K || !std::is_sorted(listOffsets.begin(), listOffsets.end())) throw std::ios_base::failure{ "broken document index" };
+	}
+}
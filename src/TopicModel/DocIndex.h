@@ -0,0 +1,66 @@
+#pragma once
+#include "LDA.h"
+
+namespace tomoto
+{
+	enum class DocMetric { hellinger, js, cosine, size };
+
+	struct DocIndexArgs
+	{
+		DocMetric metric = DocMetric::hellinger;
+		size_t numLists = 0; // the number of inverted lists, 0 for the square root of the number of documents
+		size_t trainIter = 10; // the number of iterations of k-means which finds the centroids of the lists
+		size_t seed = std::random_device{}();
+	};
+
+	/*
+	An approximate nearest neighbour index over the topic distributions of documents.
+	Each distribution is embedded into a unit vector, the square root of it for DocMetric::hellinger and DocMetric::js
+	and the normalized one for DocMetric::cosine, and stored as float16 in inverted lists (IVF) grouped by the nearest centroid.
+	A query scans only the `numProbes` lists whose centroids are the nearest to it.
+	*/
+	class DocIndex
+	{
+		DocMetric metric = DocMetric::hellinger;
+		size_t K = 0;
+		Matrix centroids; // Dim: (Topic, Lists), unit vectors in the embedded space
+		std::vector<uint64_t> listOffsets{ 0 }; // Dim: (Lists + 1, )
+		std::vector<uint64_t> listDocs; // Dim: (Docs, ), the document ids grouped by the lists
+		std::vector<uint16_t> codes; // Dim: (Docs, Topic), the embedded vectors in float16, in the order of `listDocs`
+
+		// embeds a topic distribution `theta` into `out`
+		void embed(const Float* theta, Float* out) const;
+
+		// the distance between the embedded vectors `q` and `d`, where `q` is already decoded
+		Float distance(const Float* q, const uint16_t* d) const;
+
+		// finds the centroids from the embedded vectors `vecs` of the documents
+		void trainCentroids(const std::vector<uint16_t>& vecs, size_t n, const DocIndexArgs& args, size_t numWorkers);
+	public:
+		using ThetaFn = std::function<void(size_t docId, Float* theta)>;
+
+		DocIndex() = default;
+
+		/*
+		builds the index of `n` documents whose topic distributions over `k` topics are written by `getTheta`,
+		which is called from `numWorkers` threads at once.
+		*/
+		DocIndex(size_t n, size_t k, const ThetaFn& getTheta, const DocIndexArgs& args, size_t numWorkers);
+
+		DocMetric getMetric() const { return metric; }
+		size_t getK() const { return K; }
+		size_t getNumDocs() const { return listDocs.size(); }
+		size_t getNumLists() const { return listOffsets.size() - 1; }
+
+		/*
+		finds the `topN` nearest documents of each of `numQueries` topic distributions in `queries` from `numProbes` lists,
+		and fills `ids` and `dists` of (numQueries, topN) sorted by distance.
+		The slots left when fewer documents are found are filled with -1 and infinity.
+		*/
+		void search(const Float* queries, size_t numQueries, size_t topN, size_t numProbes, size_t numWorkers,
+			std::vector<int64_t>& ids, std::vector<Float>& dists) const;
+
+		void write(std::ostream& writer) const;
+		void read(std::istream& reader);
+	};
+}
@@ -54,7 +54,8 @@ namespace tomoto
 			const std::vector<std::string>& multiMetadataCat,
 			size_t stride, 
 			size_t cnt, 
-			bool normalize
+			bool normalize,
+			size_t numWorkers = 1
 		) const = 0;
 
 		virtual void setMdRange(const std::vector<Float>& vMin, const std::vector<Float>& vMax) = 0;
@@ -38,6 +38,7 @@ namespace tomoto
 		std::vector<uint64_t> degreeByF;
 		Eigen::Array<Float, -1, 1> orderDecayCached;
 		size_t fCont = 1;
+		static constexpr size_t tdfBlockSize = 256; // the number of points `getTDFBatch` evaluates at once
 
 		Float getIntegratedLambdaSq(const Eigen::Ref<const Vector, 0, Eigen::InnerStride<>>& lambdas) const
 		{
@@ -85,110 +86,69 @@ namespace tomoto
 
 		Float getNegativeLambdaLL(Eigen::Ref<Vector> x, Vector& g) const
 		{
-			auto mappedX = Eigen::Map<Matrix>(x.data(), this->K, this->F);
-			auto mappedG = Eigen::Map<Matrix>(g.data(), this->K, this->F);
+			const size_t mdVecSize = this->mdVecSize;
+			auto mappedX = Eigen::Map<Matrix>(x.data(), this->K, this->F * mdVecSize);
+			auto mappedG = Eigen::Map<Matrix>(g.data(), this->K, this->F * mdVecSize);
+			const Float logAlpha = log(this->alpha), sigmaSq0 = pow(sigma0, 2), sigmaSq = pow(this->sigma, 2);
+			const auto decay = orderDecayCached.segment(1, fCont - 1).transpose();
 
+			// the same as `getIntegratedLambdaSq` and `getIntegratedLambdaSqP` over all rows, but evaluated column by column
 			Float fx = 0;
-			for (size_t k = 0; k < this->K; ++k)
+			for (size_t i = 0; i < this->F; ++i)
 			{
-				fx += getIntegratedLambdaSq(mappedX.row(k));
-				getIntegratedLambdaSqP(mappedX.row(k), mappedG.row(k));
+				auto xi = mappedX.middleCols(mdVecSize * i, mdVecSize);
+				auto gi = mappedG.middleCols(mdVecSize * i, mdVecSize);
+				fx += (xi.col(0).array() - logAlpha).pow(2).sum() / 2 / sigmaSq0;
+				gi.col(0) = (xi.col(0).array() - logAlpha) / sigmaSq0;
+				fx += (xi.middleCols(1, fCont - 1).array().pow(2).rowwise() * decay).sum() / 2 / sigmaSq;
+				gi.middleCols(1, fCont - 1) = (xi.middleCols(1, fCont - 1).array().rowwise() * decay).matrix() / sigmaSq;
+				fx += xi.rightCols(mdVecSize - fCont).array().pow(2).sum() / 2 / sigmaSq;
+				gi.rightCols(mdVecSize - fCont) = xi.rightCols(mdVecSize - fCont) / sigmaSq;
 			}
 			return fx;
 		}
 
-		/*Float evaluateLambdaObj(Eigen::Ref<Vector> x, Vector& g, ThreadPool& pool, _ModelState* localData) const
+		void getTermsFromMd(const Float* vx, Float* out, bool normalize = false) const
 		{
-			// if one of x is greater than maxLambda, return +inf for preventing search more
-			if ((x.array() > this->maxLambda).any()) return INFINITY;
-
-			const auto K = this->K;
-			const auto KF = this->K * this->F;
-
-			auto mappedX = Eigen::Map<Matrix>(x.data(), K, this->F);
-			Float fx = -static_cast<const DerivedClass*>(this)->getNegativeLambdaLL(x, g);
-
-			std::vector<std::future<Vector>> res;
-			const size_t chStride = pool.getNumWorkers() * 8;
-			for (size_t ch = 0; ch < chStride; ++ch)
-			{
-				res.emplace_back(pool.enqueue([&, this](size_t threadId)
-				{
-					auto& ld = localData[threadId];
-					thread_local Vector alphas{ K }, tmpK{ K }, terms{ fCont };
-					Vector ret = Vector::Zero(KF + 1);
-					for (size_t docId = ch; docId < this->docs.size(); docId += chStride)
-					{
-						const auto& doc = this->docs[docId];
-						const auto& vx = doc.metadataNormalized;
-						size_t xOffset = doc.metadata * fCont;
-						getTermsFromMd(&vx[0], terms.data());
-						for (Tid k = 0; k < K; ++k)
-						{
-							alphas[k] = exp(mappedX.row(k).segment(xOffset, fCont) * terms) + this->alphaEps;
-							ret[KF] -= math::lgammaT(alphas[k]) - math::lgammaT(doc.numByTopic[k] + alphas[k]);
-							assert(std::isfinite(ret[KF]));
-							if (!std::isfinite(alphas[k]) && alphas[k] > 0) tmpK[k] = 0;
-							else tmpK[k] = -(math::digammaT(alphas[k]) - math::digammaT(doc.numByTopic[k] + alphas[k]));
-						}
-						Float alphaSum = alphas.sum();
-						ret[KF] += math::lgammaT(alphaSum) - math::lgammaT(doc.getSumWordWeight() + alphaSum);
-						Float t = math::digammaT(alphaSum) - math::digammaT(doc.getSumWordWeight() + alphaSum);
-						if (!std::isfinite(alphaSum) && alphaSum > 0)
-						{
-							ret[KF] = -INFINITY;
-							t = 0;
-						}
-						for (size_t i = 0; i < fCont; ++i)
-						{
-							ret.segment((i + xOffset) * K, K).array() -= ((tmpK.array() + t) * alphas.array()) * terms[i];
-						}
-						assert(ret.allFinite());
-					}
-					return ret;
-				}));
-			}
-			for (auto& r : res)
-			{
-				auto ret = r.get();
-				fx += ret[KF];
-				g += ret.head(KF);
-			}
-
-			// positive fx is an error from limited precision of float.
-			if (fx > 0) return INFINITY;
-			return -fx;
-		}*/
+			getTermsFromMdBatch(vx, degreeByF.size(), 1, out, normalize);
+		}
 
-		void getTermsFromMd(const Float* vx, Float* out, bool normalize = false) const
+		/*
+		fills `out`, a column-major (cnt, fCont) matrix, with the terms of `cnt` points of metadata, each of which is `stride` apart in `vx`.
+		The shifted Legendre polynomials are evaluated for all points at once by the recurrence
+		(d + 1) P_{d+1}(x) = (2d + 1)(2x - 1) P_d(x) - d P_{d-1}(x), which runs on whole columns and so vectorizes over the points.
+		*/
+		void getTermsFromMdBatch(const Float* vx, size_t stride, size_t cnt, Float* out, bool normalize = false) const
 		{
-			thread_local std::vector<size_t> digit(degreeByF.size());
-			std::fill(digit.begin(), digit.end(), 0);
-			
-			thread_local std::vector<std::vector<Float>> slpCache;
-			if (slpCache.empty())
+			const size_t numF = degreeByF.size();
+			// the column d of slp[n] holds P_d of the n-th metadata at all points
+			std::vector<Eigen::Array<Float, -1, -1>> slp(numF);
+			Eigen::Array<Float, -1, 1> y{ (Eigen::Index)cnt };
+			for (size_t n = 0; n < numF; ++n)
 			{
-				for (auto& f : degreeByF)
+				for (size_t i = 0; i < cnt; ++i)
 				{
-					slpCache.emplace_back(std::vector<Float>(f));
+					const Float x = normalize ? ((vx[stride * i + n] - mdIntercepts[n]) / mdCoefs[n]) : vx[stride * i + n];
+					y[i] = 2 * x - 1;
 				}
-			}
-
-			
-			for (size_t n = 0; n < degreeByF.size(); ++n)
-			{
-				for (size_t i = 0; i < degreeByF[n]; ++i)
+				auto& p = slp[n];
+				p.resize(cnt, degreeByF[n] + 1);
+				p.col(0).setOnes();
+				if (degreeByF[n]) p.col(1) = y;
+				for (size_t d = 1; d < degreeByF[n]; ++d)
 				{
-					slpCache[n][i] = slp::slpGet(i + 1, normalize ? ((vx[n] - mdIntercepts[n]) / mdCoefs[n]) : vx[n]);
+					p.col(d + 1) = ((Float)(2 * d + 1) * y * p.col(d) - (Float)d * p.col(d - 1)) / (Float)(d + 1);
 				}
 			}
 
+			Eigen::Map<Matrix> terms{ out, (Eigen::Index)cnt, (Eigen::Index)fCont };
+			std::vector<size_t> digit(numF);
 			for (size_t i = 0; i < fCont; ++i)
 			{
-				out[i] = 1;
-				for (size_t n = 0; n < degreeByF.size(); ++n)
+				terms.col(i).setOnes();
+				for (size_t n = 0; n < numF; ++n)
 				{
-					if(digit[n]) out[i] *= slpCache[n][digit[n] - 1];
+					if (digit[n]) terms.col(i).array() *= slp[n].col(digit[n]);
 				}
 
 				for (size_t u = 0; u < digit.size() && ++digit[u] > degreeByF[u]; ++u)
@@ -278,17 +238,17 @@ namespace tomoto
 			}
 			ll /= -2 * pow(this->sigma, 2);
 
-			auto lgammaEta = math::lgammaT(eta);
+			// zero counts add exactly 0
 			ll += math::lgammaT(V*eta) * K;
 			for (Tid k = 0; k < K; ++k)
 			{
 				ll -= math::lgammaT(ld.numByTopic[k] + V * eta);
-				for (Vid v = 0; v < V; ++v)
-				{
-					if (!ld.numByTopicWord(k, v)) continue;
-					ll += math::lgammaT(ld.numByTopicWord(k, v) + eta) - lgammaEta;
-				}
 			}
+			ll += this->sumChunks(nullptr, V, this->llChunkVocabs, [&](size_t b, size_t e)
+			{
+				return (double)Eigen::lgammaT_subt(Eigen::Array<Float, -1, -1>::Constant(K, e - b, eta),
+					ld.numByTopicWord.middleCols(b, e - b).array().template cast<Float>()).sum();
+			});
 			return ll;
 		}
 
@@ -339,13 +299,7 @@ namespace tomoto
 				doc.mdVec[fCont + x] = 1;
 			}
 
-			auto p = std::make_pair(doc.metadata, doc.mdVec);
-			auto it = this->mdHashMap.find(p);
-			if (it == this->mdHashMap.end())
-			{
-				it = this->mdHashMap.emplace(p, this->mdHashMap.size()).first;
-			}
-			doc.mdHash = it->second;
+			doc.mdHash = this->getMdHash(std::make_pair(doc.metadata, doc.mdVec), docId != (size_t)-1);
 		}
 
 		void initGlobalState(bool initDocs)
@@ -406,7 +360,9 @@ namespace tomoto
 			orderDecayCached = calcOrderDecay();
 			LBFGSpp::LBFGSParam<Float> param;
 			param.max_iterations = this->maxBFGSIteration;
+			param.max_linesearch = this->maxLineSearch;
 			this->solver = decltype(this->solver){ param };
+			this->warmLambda = false;
 		}
 
 	public:
@@ -501,6 +457,11 @@ namespace tomoto
 			));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "documents of this model need misc data, so they should be added by `addDoc`.");
+		}
+
 		std::vector<Float> getTDF(const Float* metadata, const std::string& metadataCat, const std::vector<std::string>& multiMetadataCat, bool normalize) const override
 		{
 			Vector terms = Vector::Zero(this->mdVecSize);
@@ -525,31 +486,53 @@ namespace tomoto
 			return ret;
 		}
 
-		std::vector<Float> getTDFBatch(const Float* metadata, const std::string& metadataCat, const std::vector<std::string>& multiMetadataCat, size_t stride, size_t cnt, bool normalize) const override
+		std::vector<Float> getTDFBatch(const Float* metadata, const std::string& metadataCat, const std::vector<std::string>& multiMetadataCat, 
+			size_t stride, size_t cnt, bool normalize, size_t numWorkers) const override
 		{
-			Matrix terms = Matrix::Zero(this->mdVecSize, (Eigen::Index)cnt);
-			for (size_t i = 0; i < cnt; ++i)
-			{
-				getTermsFromMd(metadata + stride * i, terms.col(i).data(), true);
-			}
+			std::vector<Vid> multiIds;
 			for (auto& s : multiMetadataCat)
 			{
 				Vid x = this->multiMetadataDict.toWid(s);
 				if (x == non_vocab_id) throw exc::InvalidArgument("unknown multi_metadata " + text::quote(s));
-				terms.row(fCont + x).setOnes();
+				multiIds.emplace_back(x);
 			}
 			Vid x = this->metadataDict.toWid(metadataCat);
 			if (x == non_vocab_id) throw exc::InvalidArgument("unknown metadata " + text::quote(metadataCat));
 
+			const auto lambdaX = this->lambda.middleCols(x * this->mdVecSize, this->mdVecSize);
 			std::vector<Float> ret(this->K * cnt);
-			Eigen::Map<Eigen::Array<Float, -1, -1>> retMap{ ret.data(), (Eigen::Index)this->K, (Eigen::Index)cnt };
-			retMap = (this->lambda.middleCols(x * this->mdVecSize, this->mdVecSize) * terms).array();
-			if (normalize)
+			// the terms of a block of points are built at once and multiplied by `lambda` as one matrix product
+			auto evalBlock = [&](size_t b, size_t e)
+			{
+				Matrix terms = Matrix::Zero((Eigen::Index)(e - b), this->mdVecSize);
+				getTermsFromMdBatch(metadata + stride * b, stride, e - b, terms.data(), true);
+				for (auto m : multiIds) terms.col(fCont + m).setOnes();
+
+				Eigen::Map<Eigen::Array<Float, -1, -1>> retMap{ ret.data() + this->K * b, (Eigen::Index)this->K, (Eigen::Index)(e - b) };
+				retMap = (lambdaX * terms.transpose()).array();
+				if (normalize)
+				{
+					retMap.rowwise() -= retMap.colwise().maxCoeff();
+					retMap = retMap.exp();
+					retMap.rowwise() /= retMap.colwise().sum();
+				}
+			};
+
+			const size_t numBlocks = (cnt + tdfBlockSize - 1) / tdfBlockSize;
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			numWorkers = std::max(std::min(numWorkers, numBlocks), (size_t)1);
+			if (numWorkers == 1)
 			{
-				retMap.rowwise() -= retMap.colwise().maxCoeff();
-				retMap = retMap.exp();
-				retMap.rowwise() /= retMap.colwise().sum();
+				for (size_t c = 0; c < numBlocks; ++c) evalBlock(c * tdfBlockSize, std::min((c + 1) * tdfBlockSize, cnt));
+				return ret;
 			}
+
+			auto pool = this->getInferencePool(numWorkers, 0);
+			std::atomic<size_t> nextBlock{ 0 };
+			for (auto& r : pool->enqueueToAll([&](size_t)
+			{
+				for (size_t c; (c = nextBlock++) < numBlocks;) evalBlock(c * tdfBlockSize, std::min((c + 1) * tdfBlockSize, cnt));
+			})) r.get();
 			return ret;
 		}
 
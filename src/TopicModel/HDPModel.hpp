@@ -17,8 +17,45 @@ namespace tomoto
 		Vector tableLikelihood, topicLikelihood;
 		Eigen::Matrix<int32_t, -1, 1> numTableByTopic;
 		size_t totalTable = 0;
+		/*
+		the topic counts have rows for more topics than in use, so that new topics don't reallocate them.
+		Topics from `usedK` on are reserved, and new topics of this state take their ids from `freeTopics`
+		which holds the reserved ones and the dead ones under `usedK`.
+		*/
+		size_t usedK = 0;
+		std::vector<Tid> freeTopics;
+
+		uint64_t getMemoryUsage() const
+		{
+			return ModelStateLDA<_tw>::getMemoryUsage() + heapBytes(tableLikelihood) + heapBytes(topicLikelihood)
+				+ heapBytes(numTableByTopic) + heapBytes(freeTopics);
+		}
+
+		void serializerRead(std::istream& istr)
+		{
+			ModelStateLDA<_tw>::serializerRead(istr);
+			serializer::readMany(istr, numTableByTopic, totalTable);
+			usedK = this->numByTopic.size();
+			freeTopics.clear();
+		}
+
+		// the reserved topics are not written, so that saved models don't depend on them
+		void serializerWrite(std::ostream& ostr) const
+		{
+			if ((size_t)this->numByTopic.size() == usedK)
+			{
+				ModelStateLDA<_tw>::serializerWrite(ostr);
+				serializer::writeMany(ostr, numTableByTopic, totalTable);
+				return;
+			}
 
-		DEFINE_SERIALIZER_AFTER_BASE(ModelStateLDA<_tw>, numTableByTopic, totalTable);
+			using WeightType = typename ModelStateLDA<_tw>::WeightType;
+			ModelStateLDA<_tw> used;
+			used.numByTopic = this->numByTopic.head(usedK);
+			used.numByTopicWord.replaceData(Eigen::Matrix<WeightType, -1, -1>{ this->numByTopicWord.topRows(usedK) });
+			used.serializerWrite(ostr);
+			serializer::writeMany(ostr, Eigen::Matrix<int32_t, -1, 1>{ numTableByTopic.head(usedK) }, totalTable);
+		}
 	};
 
 	template<TermWeight _tw, typename _RandGen,
@@ -26,13 +63,13 @@ namespace tomoto
 		typename _Derived = void,
 		typename _DocType = DocumentHDP<_tw>,
 		typename _ModelState = ModelStateHDP<_tw>>
-	class HDPModel : public LDAModel<_tw, _RandGen, 0, _Interface,
+	class HDPModel : public LDAModel<_tw, _RandGen, flags::partitioned_multisampling, _Interface,
 		typename std::conditional<std::is_same<_Derived, void>::value, HDPModel<_tw, _RandGen>, _Derived>::type,
 		_DocType, _ModelState>
 	{
 	protected:
 		using DerivedClass = typename std::conditional<std::is_same<_Derived, void>::value, HDPModel<_tw, _RandGen>, _Derived>::type;
-		using BaseClass = LDAModel<_tw, _RandGen, 0, _Interface, DerivedClass, _DocType, _ModelState>;
+		using BaseClass = LDAModel<_tw, _RandGen, flags::partitioned_multisampling, _Interface, DerivedClass, _DocType, _ModelState>;
 		friend BaseClass;
 		friend typename BaseClass::BaseClass;
 		using WeightType = typename BaseClass::WeightType;
@@ -80,42 +117,120 @@ namespace tomoto
 			}, this->getLiveK(), 1, gamma, *rgs);
 		}
 
-		size_t addTopic(_ModelState& ld) const
+		/*
+		takes an id for a new topic from `ld.freeTopics`.
+		If no id is left, it enlarges the counts when `grow` is true, otherwise returns non_topic_id.
+		*/
+		Tid addTopic(_ModelState& ld, bool grow) const
+		{
+			while (!ld.freeTopics.empty() && ld.numTableByTopic[ld.freeTopics.back()]) ld.freeTopics.pop_back();
+			if (ld.freeTopics.empty())
+			{
+				if (!grow) return non_topic_id;
+				reserveTopics(ld, std::max((size_t)ld.numByTopic.size() * 2, (size_t)1));
+			}
+			Tid pos = ld.freeTopics.back();
+			ld.freeTopics.pop_back();
+			ld.usedK = std::max(ld.usedK, (size_t)pos + 1);
+			return pos;
+		}
+
+		// enlarges the counts of `ld` to `capacity` topics and frees the new ones
+		void reserveTopics(_ModelState& ld, size_t capacity) const
 		{
 			const size_t V = this->realV;
-			size_t pos;
-			for (pos = 0; pos < (size_t)ld.numTableByTopic.size(); ++pos)
+			const size_t oldSize = ld.numByTopic.size();
+			if (capacity <= oldSize) return;
+			ld.numTableByTopic.conservativeResize(capacity);
+			ld.numTableByTopic.tail(capacity - oldSize).setZero();
+			ld.numByTopic.conservativeResize(capacity);
+			ld.numByTopic.tail(capacity - oldSize).setZero();
+			ld.numByTopicWord.conservativeResize(capacity, V);
+			ld.numByTopicWord.block(oldSize, 0, capacity - oldSize, V).setZero();
+			std::vector<Tid> newTopics;
+			for (size_t k = capacity; k-- > oldSize;) newTopics.emplace_back(k);
+			ld.freeTopics.insert(ld.freeTopics.begin(), newTopics.begin(), newTopics.end());
+		}
+
+		/*
+		rebuilds `ld.freeTopics` from the dead topics and the reserved ones, keeping at least a half of `usedK` free 
+		so that `numWorkers` workers can make new topics without enlarging the counts.
+		Ids are popped from the back, so the smallest id is placed last.
+		*/
+		void refreshFreeTopics(_ModelState& ld, size_t numWorkers) const
+		{
+			const size_t capacity = ld.numByTopic.size();
+			ld.freeTopics.clear();
+			for (size_t k = capacity; k-- > 0;)
 			{
-				if (!ld.numTableByTopic[pos]) break;
+				if (k < ld.usedK && ld.numTableByTopic[k]) continue;
+				// dead topics may hold residual weights
+				if (ld.numByTopic[k])
+				{
+					ld.numByTopic[k] = 0;
+					ld.numByTopicWord.row(k).setZero();
+				}
+				ld.freeTopics.emplace_back(k);
 			}
-			
-			if (pos >= (size_t)ld.numByTopic.size())
+			const size_t minFree = std::max(ld.usedK / 2, numWorkers * 4);
+			if (ld.freeTopics.size() < minFree)
 			{
-				size_t oldSize = ld.numByTopic.size(), newSize = pos + 1;
-				ld.numTableByTopic.conservativeResize(newSize);
-				ld.numTableByTopic.tail(newSize - oldSize).setZero();
-				ld.numByTopic.conservativeResize(newSize);
-				ld.numByTopic.tail(newSize - oldSize).setZero();
-				ld.numByTopicWord.conservativeResize(newSize, V);
-				ld.numByTopicWord.block(oldSize, 0, newSize - oldSize, V).setZero();
+				reserveTopics(ld, std::max(capacity * 2, capacity + minFree - ld.freeTopics.size()));
 			}
-			else
+		}
+
+		/*
+		each worker takes every `numWorkers`-th id of the free ones, so that new topics of different workers never share an id.
+		With ParallelScheme::partition, a document visits all the workers in an iteration, 
+		so every worker should cover the topics which the others may make in its `usedK`.
+		Then only a few of the reserved ids are given to each worker to keep `usedK` small.
+		*/
+		template<ParallelScheme _ps>
+		void splitFreeTopics(_ModelState* localData, size_t numWorkers) const
+		{
+			static constexpr size_t maxReservedPerWorker = 8;
+			size_t usedK = localData[0].usedK;
+			for (size_t i = 0; i < numWorkers; ++i)
 			{
-				ld.numByTopic[pos] = 0;
-				ld.numByTopicWord.row(pos).setZero();
+				auto& ld = localData[i];
+				size_t n = 0, numReserved = 0;
+				for (size_t j = i; j < ld.freeTopics.size(); j += numWorkers)
+				{
+					ld.freeTopics[n++] = ld.freeTopics[j];
+					if (ld.freeTopics[j] >= ld.usedK) ++numReserved;
+				}
+				ld.freeTopics.resize(n);
+				// reserved ids come first in descending order
+				if (_ps == ParallelScheme::partition && numReserved > maxReservedPerWorker)
+				{
+					ld.freeTopics.erase(ld.freeTopics.begin(), ld.freeTopics.begin() + (numReserved - maxReservedPerWorker));
+				}
+				if (!ld.freeTopics.empty()) usedK = std::max(usedK, (size_t)ld.freeTopics.front() + 1);
 			}
-			return pos;
+			if (_ps == ParallelScheme::partition)
+			{
+				for (size_t i = 0; i < numWorkers; ++i) localData[i].usedK = usedK;
+			}
+		}
+
+		void copyTopicInfo(const _ModelState& globalState, _ModelState& ld) const
+		{
+			ld.numByTopic = globalState.numByTopic;
+			ld.numTableByTopic = globalState.numTableByTopic;
+			ld.totalTable = globalState.totalTable;
+			ld.usedK = globalState.usedK;
+			ld.freeTopics = globalState.freeTopics;
 		}
 
 		void calcWordTopicProb(_ModelState& ld, Vid vid) const
 		{
 			const size_t V = this->realV;
-			const auto K = ld.numByTopic.size();
+			const auto K = ld.usedK;
 			assert(vid < V);
 			auto& zLikelihood = ld.zLikelihood;
 			zLikelihood.resize(K + 1);
-			zLikelihood.head(K) = (ld.numByTopicWord.col(vid).array().template cast<Float>() + this->eta)
-				/ (ld.numByTopic.array().template cast<Float>() + V * this->eta);
+			zLikelihood.head(K) = (ld.numByTopicWord.col(vid).head(K).array().template cast<Float>() + this->eta)
+				/ (ld.numByTopic.head(K).array().template cast<Float>() + V * this->eta);
 			zLikelihood[K] = 1. / V;
 		}
 
@@ -123,7 +238,7 @@ namespace tomoto
 		{
 			assert(vid < this->realV);
 			const size_t T = doc.numTopicByTable.size();
-			const auto K = ld.numByTopic.size();
+			const auto K = ld.usedK;
 			Float acc = 0;
 			ld.tableLikelihood.resize(T + 1);
 			for (size_t t = 0; t < T; ++t)
@@ -137,16 +252,17 @@ namespace tomoto
 
 		Float* getTopicLikelihoods(_ModelState& ld) const
 		{
-			const size_t V = this->realV;
-			const auto K = ld.numByTopic.size();
+			const auto K = ld.usedK;
 			ld.topicLikelihood.resize(K + 1);
-			ld.topicLikelihood.head(K) = ld.zLikelihood.head(K).array().template cast<Float>() * ld.numTableByTopic.array().template cast<Float>();
+			// the totals of a worker of ParallelScheme::partition lack the tables removed by the others while sampling words, so they are clipped at zero
+			ld.topicLikelihood.head(K) = ld.zLikelihood.head(K).array().template cast<Float>() * ld.numTableByTopic.head(K).array().cwiseMax(0).template cast<Float>();
 			ld.topicLikelihood[K] = ld.zLikelihood[K] * gamma;
 			sample::prefixSum(ld.topicLikelihood.data(), ld.topicLikelihood.size());
 			return &ld.topicLikelihood[0];
 		}
 
-		template<int _inc>
+		// if `_atomic` is true, the topic-word counts can be updated by other workers at the same time
+		template<int _inc, bool _atomic = false>
 		inline void addOnlyWordTo(_ModelState& ld, _DocType& doc, uint32_t pid, Vid vid, Tid tid) const
 		{
 			assert(tid < ld.numTableByTopic.size());
@@ -154,9 +270,9 @@ namespace tomoto
 
 			if (_inc > 0 && tid >= doc.numByTopic.size())
 			{
-				size_t oldSize = doc.numByTopic.size();
-				doc.numByTopic.conservativeResize(tid + 1, 1);
-				doc.numByTopic.tail(tid + 1 - oldSize).setZero();
+				size_t oldSize = doc.numByTopic.size(), newSize = ld.numByTopic.size();
+				doc.numByTopic.conservativeResize(newSize, 1);
+				doc.numByTopic.tail(newSize - oldSize).setZero();
 			}
 			constexpr bool _dec = _inc < 0 && _tw != TermWeight::one;
 			typename std::conditional<_tw != TermWeight::one, float, int32_t>::type weight
@@ -164,7 +280,8 @@ namespace tomoto
 
 			updateCnt<_dec>(doc.numByTopic[tid], _inc * weight);
 			updateCnt<_dec>(ld.numByTopic[tid], _inc * weight);
-			updateCnt<_dec>(ld.numByTopicWord(tid, vid), _inc * weight);
+			if (_atomic) atomicUpdateCnt<_dec>(ld.numByTopicWord(tid, vid), (WeightType)(_inc * weight));
+			else updateCnt<_dec>(ld.numByTopicWord(tid, vid), _inc * weight);
 		}
 
 		template<int _inc> 
@@ -193,8 +310,15 @@ namespace tomoto
 		template<ParallelScheme _ps, bool _infer, typename _ExtraDocData>
 		void sampleDocument(_DocType& doc, const _ExtraDocData& edd, size_t docId, _ModelState& ld, _RandGen& rgs, size_t iterationCnt, size_t partitionId = 0) const
 		{
+			size_t b = 0, e = doc.words.size();
+			if (_ps == ParallelScheme::partition)
+			{
+				b = edd.chunkOffsetByDoc(partitionId, docId);
+				e = edd.chunkOffsetByDoc(partitionId + 1, docId);
+			}
+
 			// sample a table for each word
-			for (size_t w = 0; w < doc.words.size(); ++w)
+			for (size_t w = b; w < e; ++w)
 			{
 				if (doc.words[w] >= this->realV) continue;
 				addWordTo<-1>(ld, doc, w, doc.words[w], doc.Zs[w], doc.numTopicByTable[doc.Zs[w]].topic);
@@ -204,12 +328,13 @@ namespace tomoto
 				doc.Zs[w] = sample::sampleFromDiscreteAcc(dist, dist + doc.numTopicByTable.size() + 1, rgs);
 				if (doc.Zs[w] == doc.numTopicByTable.size()) // create new table
 				{
-					size_t K = ld.numByTopic.size();
+					size_t K = ld.usedK;
 					Tid newTopic = sample::sampleFromDiscreteAcc(topicDist, topicDist + K + (_infer ? 0 : 1), rgs);
 					if (newTopic == K) // create new topic
 					{
-						newTopic = addTopic(ld);
-						//printf("New Topic #%zd\n", newTopic);
+						newTopic = addTopic(ld, _ps == ParallelScheme::none);
+						// no id is left for this worker until the next iteration
+						if (newTopic == non_topic_id) newTopic = sample::sampleFromDiscreteAcc(topicDist, topicDist + K, rgs);
 					}
 					doc.Zs[w] = doc.addNewTable(newTopic);
 					++ld.numTableByTopic[newTopic];
@@ -218,22 +343,30 @@ namespace tomoto
 				addWordTo<1>(ld, doc, w, doc.words[w], doc.Zs[w], doc.numTopicByTable[doc.Zs[w]].topic);
 			}
 
-			// sample a topic for each table
+			// tables of ParallelScheme::partition hold words of the other workers, so they are sampled at `performSampling`
+			if (_ps != ParallelScheme::partition) sampleTables<_ps, _infer>(doc, ld, rgs);
+		}
+
+		// samples a topic for each table of `doc`
+		template<ParallelScheme _ps, bool _infer>
+		void sampleTables(_DocType& doc, _ModelState& ld, _RandGen& rgs) const
+		{
+			constexpr bool _atomic = _ps == ParallelScheme::partition;
 			for (size_t t = 0; t < doc.getNumTable(); ++t)
 			{
 				auto& curTable = doc.numTopicByTable[t];
 				if (!curTable) continue;
 				--ld.numTableByTopic[curTable.topic];
-				size_t K = ld.numByTopic.size();
+				size_t K = ld.usedK;
 				ld.zLikelihood.resize(K + 1);
 				ld.zLikelihood.setZero();
 				for (size_t w = 0; w < doc.words.size(); ++w)
 				{
 					if (doc.words[w] >= this->realV) continue;
 					if (doc.Zs[w] != t) continue;
-					addOnlyWordTo<-1>(ld, doc, w, doc.words[w], curTable.topic);
-					ld.zLikelihood.head(K).array() += ((ld.numByTopicWord.col(doc.words[w]).array().template cast<Float>() + this->eta)
-						/ (ld.numByTopic.array().template cast<Float>() + this->realV * this->eta)).log();
+					addOnlyWordTo<-1, _atomic>(ld, doc, w, doc.words[w], curTable.topic);
+					ld.zLikelihood.head(K).array() += ((ld.numByTopicWord.col(doc.words[w]).head(K).array().template cast<Float>() + this->eta)
+						/ (ld.numByTopic.head(K).array().template cast<Float>() + this->realV * this->eta)).log();
 					ld.zLikelihood[K] += log(1. / this->realV);
 				}
 
@@ -248,31 +381,91 @@ namespace tomoto
 				Tid newTopic = sample::sampleFromDiscreteAcc(topicDist, topicDist + K + (_infer ? 0 : 1), rgs);
 				if (newTopic == K) // create new topic
 				{
-					newTopic = addTopic(ld);
-					//printf("New Topic #%zd\n", newTopic);
+					newTopic = addTopic(ld, _ps == ParallelScheme::none);
+					if (newTopic == non_topic_id) newTopic = sample::sampleFromDiscreteAcc(topicDist, topicDist + K, rgs);
 				}
 				curTable.topic = newTopic;
 				for (size_t w = 0; w < doc.words.size(); ++w)
 				{
 					if (doc.words[w] >= this->realV) continue;
 					if (doc.Zs[w] != t) continue;
-					addOnlyWordTo<1>(ld, doc, w, doc.words[w], curTable.topic);
+					addOnlyWordTo<1, _atomic>(ld, doc, w, doc.words[w], curTable.topic);
 				}
 				++ld.numTableByTopic[curTable.topic];
 			}
 		}
 
+		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
+		void performSampling(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
+			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd) const
+		{
+			const size_t numWorkers = pool.getNumWorkers();
+			if (_ps != ParallelScheme::none && !_infer) splitFreeTopics<_ps>(localData, numWorkers);
+			if (_ps != ParallelScheme::partition)
+			{
+				BaseClass::template performSampling<_ps, _infer>(pool, localData, rgs, res, docFirst, docLast, edd);
+				return;
+			}
+
+			/*
+			all workers start from the same totals, but each one updates only its own copy while sampling words,
+			so a worker's table and topic totals lack the changes of the others and may even go below zero.
+			They are reconciled by adding up the changes of all workers before the tables are sampled.
+			*/
+			const Eigen::Matrix<int32_t, -1, 1> baseTables = localData[0].numTableByTopic;
+			const Eigen::Matrix<WeightType, -1, 1> baseTopics = localData[0].numByTopic;
+			const size_t baseTotalTable = localData[0].totalTable;
+			BaseClass::template performSampling<_ps, _infer>(pool, localData, rgs, res, docFirst, docLast, edd);
+
+			Eigen::Matrix<int32_t, -1, 1> numTables = baseTables;
+			Eigen::Matrix<WeightType, -1, 1> numTopics = baseTopics;
+			ptrdiff_t totalTable = baseTotalTable;
+			for (size_t i = 0; i < numWorkers; ++i)
+			{
+				numTables += localData[i].numTableByTopic - baseTables;
+				numTopics += localData[i].numByTopic - baseTopics;
+				totalTable += (ptrdiff_t)localData[i].totalTable - (ptrdiff_t)baseTotalTable;
+			}
+			if (_tw != TermWeight::one) numTopics = numTopics.cwiseMax(0);
+			for (size_t i = 0; i < numWorkers; ++i)
+			{
+				localData[i].numTableByTopic = numTables;
+				localData[i].numByTopic = numTopics;
+				localData[i].totalTable = totalTable;
+			}
+
+			// each table is sampled by the worker of its document, updating the shared topic-word counts atomically
+			const size_t numDocs = std::distance(docFirst, docLast);
+			res = pool.enqueueToAll([&](size_t threadId)
+			{
+				for (size_t i = threadId; i < numDocs; i += numWorkers)
+				{
+					sampleTables<_ps, _infer>(docFirst[i], localData[threadId], rgs[threadId]);
+				}
+			});
+			for (auto& r : res) r.get();
+			res.clear();
+		}
+
 		void updateGlobalInfo(ThreadPool& pool, _ModelState* localData)
 		{
 			std::vector<std::future<void>> res;
 			auto& K = this->K;
-			K = 0;
+			size_t capacity = 0;
+			// `usedK` of ParallelScheme::partition covers the ids given to all workers, so find the last topic made actually
 			for (size_t i = 0; i < pool.getNumWorkers(); ++i)
 			{
-				K = std::max(K, (Tid)localData[i].numByTopic.size());
+				auto& ld = localData[i];
+				for (size_t k = ld.usedK; k-- > K;)
+				{
+					if (!ld.numTableByTopic[k]) continue;
+					K = k + 1;
+					break;
+				}
+				capacity = std::max(capacity, (size_t)ld.numByTopic.size());
 			}
 
-			// synchronize topic size of all documents
+			// synchronize topic size of all documents, leaving rooms for the reserved topics
 			for (size_t i = 0; i < pool.getNumWorkers(); ++i)
 			{
 				res.emplace_back(pool.enqueue([&, this](size_t threadId, size_t b, size_t e)
@@ -282,8 +475,8 @@ namespace tomoto
 						auto& doc = this->docs[j];
 						if (doc.numByTopic.size() >= K) continue;
 						size_t oldSize = doc.numByTopic.size();
-						doc.numByTopic.conservativeResize(K, 1);
-						doc.numByTopic.tail(K - oldSize).setZero();
+						doc.numByTopic.conservativeResize(capacity, 1);
+						doc.numByTopic.tail(capacity - oldSize).setZero();
 					}
 				}, this->docs.size() * i / pool.getNumWorkers(), this->docs.size() * (i + 1) / pool.getNumWorkers()));
 			}
@@ -294,35 +487,37 @@ namespace tomoto
 		void mergeState(ThreadPool& pool, _ModelState& globalState, _ModelState& tState, _ModelState* localData, _RandGen*, const _ExtraDocData& edd) const
 		{
 			const size_t V = this->realV;
-			auto K = this->K;
 
-			if (K > globalState.numByTopic.size())
+			// workers don't enlarge their counts except ParallelScheme::none, whose state is `globalState` itself
+			if (_ps == ParallelScheme::copy_merge)
 			{
-				size_t oldSize = globalState.numByTopic.size();
-				globalState.numByTopic.conservativeResize(K);
-				globalState.numByTopic.tail(K - oldSize).setZero();
-				globalState.numTableByTopic.resize(K);
-				globalState.numByTopicWord.conservativeResize(K, V);
-				globalState.numByTopicWord.block(oldSize, 0, K - oldSize, V).setZero();
-			}
+				tState = globalState;
+				for (size_t i = 0; i < pool.getNumWorkers(); ++i)
+				{
+					size_t locK = localData[i].usedK;
+					globalState.numByTopic.head(locK) 
+						+= localData[i].numByTopic.head(locK) - tState.numByTopic.head(locK);
+					globalState.numByTopicWord.block(0, 0, locK, V)
+						+= localData[i].numByTopicWord.block(0, 0, locK, V) - tState.numByTopicWord.block(0, 0, locK, V);
+				}
 
-			tState = globalState;
-			for (size_t i = 0; i < pool.getNumWorkers(); ++i)
-			{
-				size_t locK = localData[i].numByTopic.size();
-				globalState.numByTopic.head(locK) 
-					+= localData[i].numByTopic.head(locK) - tState.numByTopic.head(locK);
-				globalState.numByTopicWord.block(0, 0, locK, V)
-					+= localData[i].numByTopicWord.block(0, 0, locK, V) - tState.numByTopicWord.block(0, 0, locK, V);
+				// make all count being positive
+				if (_tw != TermWeight::one)
+				{
+					globalState.numByTopic = globalState.numByTopic.cwiseMax(0);
+					globalState.numByTopicWord.matrix() = globalState.numByTopicWord.cwiseMax(0);
+				}
 			}
-
-			// make all count being positive
-			if (_tw != TermWeight::one)
+			else if (_ps == ParallelScheme::partition)
 			{
-				globalState.numByTopic = globalState.numByTopic.cwiseMax(0);
-				globalState.numByTopicWord.matrix() = globalState.numByTopicWord.cwiseMax(0);
+				// make all count being positive
+				if (_tw != TermWeight::one)
+				{
+					globalState.numByTopicWord.matrix() = globalState.numByTopicWord.cwiseMax(0);
+				}
+				globalState.numByTopic = globalState.numByTopicWord.rowwise().sum();
 			}
-
+			globalState.usedK = std::max(globalState.usedK, (size_t)this->K);
 
 			globalState.numTableByTopic.setZero();
 			for (auto& doc : this->docs)
@@ -333,6 +528,35 @@ namespace tomoto
 				}
 			}
 			globalState.totalTable = globalState.numTableByTopic.sum();
+			refreshFreeTopics(globalState, pool.getNumWorkers());
+		}
+
+		template<ParallelScheme _ps>
+		void distributeMergedState(ThreadPool& pool, _ModelState& globalState, _ModelState* localData) const
+		{
+			if (_ps == ParallelScheme::partition)
+			{
+				// `refreshFreeTopics` may have moved the shared counts
+				std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t threadId)
+				{
+					auto& ld = localData[threadId];
+					if (ld.numByTopicWord.data() != globalState.numByTopicWord.data())
+					{
+						ld.numByTopicWord.init(globalState.numByTopicWord.data(), globalState.numByTopicWord.rows(), globalState.numByTopicWord.cols());
+					}
+					copyTopicInfo(globalState, ld);
+				});
+				for (auto& r : res) r.get();
+				return;
+			}
+			BaseClass::template distributeMergedState<_ps>(pool, globalState, localData);
+		}
+
+		template<typename _ExtraDocData>
+		void distributePartition(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, const _ExtraDocData& edd) const
+		{
+			BaseClass::distributePartition(pool, globalState, localData, edd);
+			for (size_t i = 0; i < pool.getNumWorkers(); ++i) copyTopicInfo(globalState, localData[i]);
 		}
 
 		/* this LL calculation is based on https://github.com/blei-lab/hdp/blob/master/hdp/state.cpp */
@@ -393,6 +617,9 @@ namespace tomoto
 				//this->globalState.numByTopicWord = Eigen::Matrix<WeightType, -1, -1>::Zero(K, V);
 				this->globalState.numByTopicWord.init(nullptr, K, V);
 			}
+			this->globalState.usedK = K;
+			// the state of a loaded model may live in a mapped file, so its free topics are made after the first iteration
+			if (initDocs) refreshFreeTopics(this->globalState, 1);
 		}
 
 		void prepareDoc(_DocType& doc, size_t docId, size_t wordSize) const
@@ -497,16 +724,42 @@ namespace tomoto
 			Eigen::Map<Eigen::Array<Float, -1, 1>> m{ ret.data(), this->K };
 			if (normalize)
 			{
-				m = doc.numByTopic.array().template cast<Float>() / doc.getSumWordWeight();
+				m = doc.numByTopic.head(this->K).array().template cast<Float>() / doc.getSumWordWeight();
 			}
 			else
 			{
-				m = doc.numByTopic.array().template cast<Float>();
+				m = doc.numByTopic.head(this->K).array().template cast<Float>();
 			}
 			return ret;
 		}
 
-		std::unique_ptr<ILDAModel> convertToLDA(float topicThreshold, std::vector<Tid>& newK) const override
+		/*
+		empties this model after its documents were moved by `convertToLDA`, so that it can't be trained nor read any more.
+		The documents are kept in place but empty, so that pointers to them stay valid.
+		*/
+		void releaseMovedDocs()
+		{
+			for (auto& doc : this->docs) std::vector<typename _DocType::TableTopicInfo>{}.swap(doc.numTopicByTable);
+			auto& gs = this->globalState;
+			gs.numByTopicWord.init(nullptr, 0, 0);
+			gs.numByTopicWordTail = {};
+			gs.numByTopic.resize(0);
+			gs.numTableByTopic.resize(0);
+			gs.totalTable = 0;
+			gs.usedK = 0;
+			gs.freeTopics.clear();
+			this->realN = 0;
+			this->weightedN = 0;
+		}
+
+		/*
+		builds an LDA model of the live topics.
+		When all documents have been prepared, the new model takes their arrays over as they are:
+		the topics are remapped in place with a table from the topics of HDP to those of LDA,
+		and the topic-word counts are the rows of the live topics, plus the words of the removed topics.
+		With `moveDocs`, the arrays are moved instead of being copied, and the documents of this model are left empty.
+		*/
+		std::unique_ptr<ILDAModel> convertToLDA(float topicThreshold, std::vector<Tid>& newK, bool moveDocs) override
 		{
 			auto cnt = _getTopicsCount();
 			std::vector<std::pair<uint64_t, size_t>> cntIdx;
@@ -533,23 +786,129 @@ namespace tomoto
 			args.eta = this->eta;
 			auto lda = std::make_unique<LDAModel<_tw, _RandGen>>(args);
 			lda->dict = this->dict;
+
+			// words of the removed topics go to one of the kept topics, drawn by its proportion over the threshold.
+			// Only kept topics have positive weights, and they are the first `liveK` of `cntIdx`, so the drawn index is the new topic.
+			auto selectFirst = [&](const std::pair<size_t, size_t>& p) { return std::max(p.first / sum - topicThreshold, 0.f); };
+			const std::discrete_distribution<size_t> randomTopic{
+				makeTransformIter(cntIdx.begin(), selectFirst),
+				makeTransformIter(cntIdx.end(), selectFirst) 
+			};
+			const bool anyWeight = std::any_of(cntIdx.begin(), cntIdx.begin() + liveK, [&](const std::pair<size_t, size_t>& p) { return selectFirst(p) > 0; });
 			
-			for (auto& doc : this->docs)
+			const size_t numDocs = this->docs.size(), V = this->realV;
+			const bool prepared = this->numPreparedDocs != (size_t)-1 && !this->getNumNewDocs() && !this->docsOutOfCore
+				&& (numDocs == 0 || !this->words.empty()) && (size_t)this->globalState.numByTopicWord.cols() == V;
+			if (!prepared)
 			{
-				auto d = lda->_makeFromRawDoc(doc);
-				lda->_addDoc(d);
+				for (auto& doc : this->docs)
+				{
+					auto d = lda->_makeFromRawDoc(doc);
+					lda->_addDoc(d);
+				}
+
+				lda->realV = this->realV;
+				lda->realN = this->realN;
+				lda->weightedN = this->weightedN;
+				lda->prepare(true, 0, 0, 0, false);
+
+				std::mt19937_64 rng;
+				auto dist = randomTopic;
+				for (size_t i = 0; i < numDocs; ++i)
+				{
+					for (size_t j = 0; j < this->docs[i].Zs.size(); ++j)
+					{
+						if (this->docs[i].Zs[j] == non_topic_id)
+						{
+							lda->docs[i].Zs[j] = non_topic_id;
+							continue;
+						}
+						Tid newTopic = newK[this->docs[i].numTopicByTable[this->docs[i].Zs[j]].topic];
+						if (newTopic == (Tid)-1) newTopic = anyWeight ? (Tid)dist(rng) : 0;
+						lda->docs[i].Zs[j] = newTopic;
+					}
+				}
+
+				lda->resetStatistics();
+				lda->optimizeParameters(*(ThreadPool*)nullptr, nullptr, nullptr);
+				return lda;
 			}
 
+			lda->vocabCf = this->vocabCf;
+			lda->vocabDf = this->vocabDf;
+			lda->uidMap = this->uidMap;
+			lda->vocabWeights = this->vocabWeights;
 			lda->realV = this->realV;
 			lda->realN = this->realN;
 			lda->weightedN = this->weightedN;
-			lda->prepare(true, 0, 0, 0, false);
+			lda->wOffsetByDoc = this->wOffsetByDoc;
+			// the spans are never modified, so both models can share them
+			lda->wordSpans = this->wordSpans;
+			lda->docs.reserve(numDocs);
+			if (moveDocs)
+			{
+				// moving keeps the buffers in place, so the moved documents still view them
+				lda->words = std::move(this->words);
+				lda->sharedZs = std::move(this->sharedZs);
+				lda->sharedWordWeights = std::move(this->sharedWordWeights);
+				for (auto& doc : this->docs) lda->docs.emplace_back(std::move(static_cast<DocumentLDA<_tw>&>(doc)));
+				this->words = {};
+				this->sharedZs = {};
+				this->sharedWordWeights = {};
+				this->wOffsetByDoc.clear();
+			}
+			else
+			{
+				lda->words = this->words;
+				lda->sharedZs = this->sharedZs;
+				lda->sharedWordWeights = this->sharedWordWeights;
+				for (auto& doc : this->docs) lda->docs.emplace_back(static_cast<const DocumentLDA<_tw>&>(doc));
+				lda->updateForCopy();
+			}
 
-			auto selectFirst = [&](const std::pair<size_t, size_t>& p) { return std::max(p.first / sum - topicThreshold, 0.f); };
-			std::discrete_distribution<size_t> randomTopic{
-				makeTransformIter(cntIdx.begin(), selectFirst),
-				makeTransformIter(cntIdx.end(), selectFirst) 
-			};
+			// the tables of the documents of this model are still intact after moving, since only the bases of the documents are moved
+			const size_t numThreads = this->getNumPrepareThreads(numDocs);
+			std::vector<std::vector<std::tuple<Tid, Vid, Float>>> reassigned(numThreads);
+			this->forEachPrepareChunk(numThreads, numDocs, [&](size_t t, size_t c, size_t b, size_t e)
+			{
+				std::mt19937_64 rng{ c };
+				auto dist = randomTopic;
+				for (size_t i = b; i < e; ++i)
+				{
+					auto& from = this->docs[i];
+					auto& doc = lda->docs[i];
+					for (size_t j = 0; j < doc.Zs.size(); ++j)
+					{
+						if (doc.Zs[j] == non_topic_id) continue;
+						Tid newTopic = newK[from.numTopicByTable[doc.Zs[j]].topic];
+						if (newTopic == (Tid)-1)
+						{
+							newTopic = anyWeight ? (Tid)dist(rng) : 0;
+							if (doc.words[j] < V) reassigned[t].emplace_back(newTopic, doc.words[j], this->getWordWeight(doc, j));
+						}
+						doc.Zs[j] = newTopic;
+					}
+				}
+			});
+
+			auto& gs = lda->globalState;
+			gs.numByTopicWord.init(nullptr, liveK, V);
+			for (size_t i = 0; i < liveK; ++i)
+			{
+				gs.numByTopicWord.row(i) = this->globalState.numByTopicWord.row(cntIdx[i].second);
+			}
+			for (auto& r : reassigned)
+			{
+				for (auto& x : r) gs.numByTopicWord(std::get<0>(x), std::get<1>(x)) += std::get<2>(x);
+			}
+			gs.numByTopicWordTail = {};
+			gs.numByTopic = gs.numByTopicWord.rowwise().sum();
+			lda->prepareConverted();
+			lda->optimizeParameters(*(ThreadPool*)nullptr, nullptr, nullptr);
+			if (moveDocs) releaseMovedDocs();
+			return lda;
+		}
+	};
 			
 			std::mt19937_64 rng;
 
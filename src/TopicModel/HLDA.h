@@ -45,5 +45,9 @@ namespace tomoto
 		virtual size_t getLevelOfTopic(Tid tid) const = 0;
 		virtual size_t getParentTopicId(Tid tid) const = 0;
 		virtual std::vector<uint32_t> getChildTopicId(Tid tid) const = 0;
+		virtual size_t getPathBatch() const = 0;
+		virtual void setPathBatch(size_t) = 0;
+		virtual Float getPathPruneThreshold() const = 0;
+		virtual void setPathPruneThreshold(Float) = 0;
 	};
 }
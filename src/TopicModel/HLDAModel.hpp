@@ -119,30 +119,47 @@ namespace tomoto
 
 			DEFINE_SERIALIZER(nodes, levelBlocks);
 
+			uint64_t getMemoryUsage() const
+			{
+				return heapBytes(nodes) + heapBytes(levelBlocks) + heapBytes(nodeLikelihoods) + heapBytes(nodeWLikelihoods);
+			}
+
 			template<bool _makeNewPath = true>
 			void calcNodeLikelihood(Float gamma, size_t levelDepth)
 			{
-				nodeLikelihoods.resize(nodes.size());
-				nodeLikelihoods.array() = -INFINITY;
-				updateNodeLikelihood<_makeNewPath>(gamma, levelDepth, &nodes[0]);
+				calcNodeLikelihood<_makeNewPath>(gamma, levelDepth, nodeLikelihoods);
+			}
+
+			/*
+			writes the likelihoods into `out` instead of `nodeLikelihoods`, so that it can be called concurrently.
+			Nodes whose log-probability of being reached is below `cutoff` are left as -INFINITY with their subtrees.
+			*/
+			template<bool _makeNewPath = true>
+			void calcNodeLikelihood(Float gamma, size_t levelDepth, Vector& out, Float cutoff = -INFINITY) const
+			{
+				out.resize(nodes.size());
+				out.array() = -INFINITY;
+				updateNodeLikelihood<_makeNewPath>(gamma, levelDepth, &nodes[0], out, cutoff);
 				if (!_makeNewPath)
 				{
 					for (size_t i = 0; i < levelBlocks.size(); ++i)
 					{
-						if (levelBlocks[i] < levelDepth - 1) nodeLikelihoods.segment((i + 1) * blockSize, blockSize).array() = -INFINITY;
+						if (levelBlocks[i] < levelDepth - 1) out.segment((i + 1) * blockSize, blockSize).array() = -INFINITY;
 					}
 				}
 			}
 
 			template<bool _makeNewPath = true>
-			void updateNodeLikelihood(Float gamma, size_t levelDepth, NCRPNode* node, Float weight = 0)
+			void updateNodeLikelihood(Float gamma, size_t levelDepth, const NCRPNode* node, Vector& out, Float cutoff = -INFINITY, Float weight = 0) const
 			{
+				// the probability of reaching a node bounds those of all the pathes through it
+				if (weight < cutoff) return;
 				size_t idx = node - nodes.data();
 				const Float pNewNode = _makeNewPath ? log(gamma / (node->numCustomers + gamma)) : -INFINITY;
-				nodeLikelihoods[idx] = weight + (((size_t)node->level < levelDepth - 1) ? pNewNode : 0);
+				out[idx] = weight + (((size_t)node->level < levelDepth - 1) ? pNewNode : 0);
 				for(auto * child = node->getChild(); child; child = child->getSibling())
 				{
-					updateNodeLikelihood(gamma, levelDepth, child, weight + log(child->numCustomers / (node->numCustomers + gamma)));
+					updateNodeLikelihood<_makeNewPath>(gamma, levelDepth, child, out, cutoff, weight + log(child->numCustomers / (node->numCustomers + gamma)));
 				}
 			}
 
@@ -159,6 +176,48 @@ namespace tomoto
 				}
 			}
 
+			/*
+			moves the live blocks together in the order of their ids, so that the dead ones no longer take part in the likelihoods and the counts.
+			The first block holding the root is always kept in place. The links between the nodes are rebuilt from their parents,
+			which also drops the stale links that `dropPathOne` leaves in dead nodes.
+			It returns the new id of each old node, or -1 for the nodes of the dropped blocks.
+			*/
+			std::vector<int32_t> compact()
+			{
+				std::vector<int32_t> newIds(nodes.size(), -1);
+				std::vector<NCRPNode> newNodes{ nodes.begin(), nodes.begin() + blockSize };
+				std::vector<uint8_t> newLevelBlocks;
+				for (size_t i = 0; i < blockSize; ++i) newIds[i] = i;
+				for (size_t b = 0; b < levelBlocks.size(); ++b)
+				{
+					if (!levelBlocks[b]) continue;
+					const size_t oldStart = (b + 1) * blockSize;
+					for (size_t i = 0; i < blockSize; ++i) newIds[oldStart + i] = newNodes.size() + i;
+					newNodes.insert(newNodes.end(), nodes.begin() + oldStart, nodes.begin() + oldStart + blockSize);
+					newLevelBlocks.emplace_back(levelBlocks[b]);
+				}
+
+				std::vector<int32_t> parents(newNodes.size(), -1);
+				for (size_t i = 0; i < nodes.size(); ++i)
+				{
+					if (newIds[i] < 0 || !nodes[i] || !nodes[i].parent) continue;
+					parents[newIds[i]] = newIds[i + nodes[i].parent];
+				}
+				for (auto& node : newNodes)
+				{
+					if (!node) node = NCRPNode{};
+					node.parent = node.sibling = node.child = 0;
+				}
+				// children are prepended, so they are added from the last one to keep them in the order of their ids
+				for (size_t i = newNodes.size(); i-- > 0; )
+				{
+					if (parents[i] >= 0) newNodes[parents[i]].addChild(&newNodes[i]);
+				}
+				nodes = std::move(newNodes);
+				levelBlocks = std::move(newLevelBlocks);
+				return newIds;
+			}
+
 			NCRPNode* newNode(size_t level)
 			{
 				for (size_t b = 0; b < levelBlocks.size(); ++b)
@@ -188,42 +247,59 @@ namespace tomoto
 			void calcWordLikelihood(Float eta, size_t realV, size_t levelDepth, ThreadPool* pool,
 				const DocumentHLDA<_tw>& doc, const std::vector<Float>& newTopicWeights,
 				const ModelStateLDA<_tw>& ld)
+			{
+				calcWordLikelihood<_tw>(eta, realV, levelDepth, pool, doc, newTopicWeights, ld, nodeLikelihoods, nodeWLikelihoods);
+			}
+
+			/*
+			adds the word likelihoods to `nodeLikelihoods` using `nodeWLikelihoods` as a buffer, so that it can be called concurrently.
+			If `skipUnreachable` is true, blocks whose nodes all have -INFINITY in `nodeLikelihoods` are skipped.
+			*/
+			template<TermWeight _tw>
+			void calcWordLikelihood(Float eta, size_t realV, size_t levelDepth, ThreadPool* pool,
+				const DocumentHLDA<_tw>& doc, const std::vector<Float>& newTopicWeights,
+				const ModelStateLDA<_tw>& ld, Vector& nodeLikelihoods, Vector& nodeWLikelihoods, bool skipUnreachable = false) const
 			{
 				nodeWLikelihoods.resize(nodes.size());
 				nodeWLikelihoods.setZero();
 				std::vector<std::future<void>> futures;
 				futures.reserve(levelBlocks.size());
+				const Float logEta = log(eta);
 
 				auto calc = [&, eta, realV](size_t threadId, size_t b)
 				{
 					Float cnt = 0;
 					Vid prevWord = -1;
 					const size_t bStart = blockSize + b * blockSize;
+					if (skipUnreachable && (nodeLikelihoods.segment(bStart, blockSize).array() == -INFINITY).all()) return;
+
+					auto addWord = [&](Vid v, Float cnt)
+					{
+						auto counts = ld.numByTopicWord.col(v).segment(bStart, blockSize).array();
+						// the term doesn't depend on the node when no node of the block has the word
+						if ((counts == 0).all())
+						{
+							nodeWLikelihoods.segment(bStart, blockSize).array() += cnt == 1 ? logEta : (Float)math::lgammaSubt(eta, cnt);
+						}
+						else if (cnt == 1) nodeWLikelihoods.segment(bStart, blockSize).array()
+							+= (counts.template cast<Float>() + eta).log();
+						else nodeWLikelihoods.segment(bStart, blockSize).array()
+							+= Eigen::lgamma_subt(counts.template cast<Float>() + eta, cnt);
+					};
+
 					for (size_t w = 0; w < doc.words.size(); ++w)
 					{
 						if (doc.words[w] >= realV) break;
 						if (doc.Zs[w] != levelBlocks[b]) continue;
 						if (doc.words[w] != prevWord)
 						{
-							if (prevWord != (Vid)-1)
-							{
-								if (cnt == 1) nodeWLikelihoods.segment(bStart, blockSize).array()
-									+= (ld.numByTopicWord.col(prevWord).segment(bStart, blockSize).array().template cast<Float>() + eta).log();
-								else nodeWLikelihoods.segment(bStart, blockSize).array()
-									+= Eigen::lgamma_subt(ld.numByTopicWord.col(prevWord).segment(bStart, blockSize).array().template cast<Float>() + eta, cnt);
-							}
+							if (prevWord != (Vid)-1) addWord(prevWord, cnt);
 							cnt = 0;
 							prevWord = doc.words[w];
 						}
 						cnt += doc.getWordWeight(w);
 					}
-					if (prevWord != (Vid)-1)
-					{
-						if (cnt == 1) nodeWLikelihoods.segment(bStart, blockSize).array()
-							+= (ld.numByTopicWord.col(prevWord).segment(bStart, blockSize).array().template cast<Float>() + eta).log();
-						else nodeWLikelihoods.segment(bStart, blockSize).array()
-							+= Eigen::lgamma_subt(ld.numByTopicWord.col(prevWord).segment(bStart, blockSize).array().template cast<Float>() + eta, cnt);
-					}
+					if (prevWord != (Vid)-1) addWord(prevWord, cnt);
 					nodeWLikelihoods.segment(bStart, blockSize).array()
 						-= Eigen::lgamma_subt(ld.numByTopic.segment(bStart, blockSize).array().template cast<Float>() + realV * eta, (Float)doc.numByTopic[levelBlocks[b]]);
 				};
@@ -254,13 +330,13 @@ namespace tomoto
 					}
 				}
 				
-				updateWordLikelihood<_tw>(eta, realV, levelDepth, doc, newTopicWeights, &nodes[0]);
+				updateWordLikelihood<_tw>(eta, realV, levelDepth, doc, newTopicWeights, &nodes[0], nodeLikelihoods, nodeWLikelihoods);
 			}
 
 			template<TermWeight _tw>
 			void updateWordLikelihood(Float eta, size_t realV, size_t levelDepth,
 				const DocumentHLDA<_tw>& doc, const std::vector<Float>& newTopicWeights,
-				detail::NCRPNode* node, Float weight = 0)
+				const detail::NCRPNode* node, Vector& nodeLikelihoods, const Vector& nodeWLikelihoods, Float weight = 0) const
 			{
 				size_t idx = node - nodes.data();
 				weight += nodeWLikelihoods[idx];
@@ -271,7 +347,7 @@ namespace tomoto
 				}
 				for (auto* child = node->getChild(); child; child = child->getSibling())
 				{
-					updateWordLikelihood<_tw>(eta, realV, levelDepth, doc, newTopicWeights, child, weight);
+					updateWordLikelihood<_tw>(eta, realV, levelDepth, doc, newTopicWeights, child, nodeLikelihoods, nodeWLikelihoods, weight);
 				}
 			}
 
@@ -341,6 +417,9 @@ namespace tomoto
 		}
 
 		Float gamma;
+		size_t pathBatch = 0; // the number of documents per worker whose pathes are sampled at once, 0 for sequential sampling
+		Float pathPruneThreshold = 0; // the margin below the current path under which subtrees are skipped, 0 for the exhaustive search
+		static constexpr size_t minCompactedBlocks = 4; // the trees are compacted only when at least this many blocks are dead
 
 		void optimizeParameters(ThreadPool& pool, _ModelState* localData, _RandGen* rgs)
 		{
@@ -356,19 +435,43 @@ namespace tomoto
 		{
 			if (!doc.getSumWordWeight()) return;
 
-			if(_gs != GlobalSampler::inference) ld.nt->nodes[doc.path.back()].dropPathOne();
-			ld.nt->template calcNodeLikelihood<_gs == GlobalSampler::train>(gamma, this->K);
+			detachPath<_gs>(doc, ld);
+			size_t newPath = choosePath<_gs>(doc, pool, ld, rgs, ld.nt->nodeLikelihoods, ld.nt->nodeWLikelihoods);
+			attachPath<_gs>(doc, ld, newPath);
+		}
 
-			std::vector<Float> newTopicWeights(this->K - 1);
-			std::vector<WeightType> cntByLevel(this->K);
-			Vid prevWord = -1;
+		// removes the path and the words of `doc` from `ld`
+		template<GlobalSampler _gs>
+		void detachPath(_DocType& doc, _ModelState& ld) const
+		{
+			if(_gs != GlobalSampler::inference) ld.nt->nodes[doc.path.back()].dropPathOne();
 			for (size_t w = 0; w < doc.words.size(); ++w)
 			{
 				if (doc.words[w] >= this->realV) break;
 				addWordToOnlyLocal<-1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+			}
+		}
 
-				if (_gs == GlobalSampler::train)
+		/*
+		samples a node for `doc` from `ld` which `doc` is detached from, without modifying `ld`.
+		It returns an inner node when a new path should be made under it.
+		*/
+		template<GlobalSampler _gs>
+		size_t choosePath(const _DocType& doc, ThreadPool* pool, const _ModelState& ld, _RandGen& rgs,
+			Vector& nodeLikelihoods, Vector& nodeWLikelihoods) const
+		{
+			Float cutoff = -INFINITY;
+			if (_gs == GlobalSampler::train && pathPruneThreshold > 0) cutoff = getCurrentPathLL(doc, ld) - pathPruneThreshold;
+			ld.nt->template calcNodeLikelihood<_gs == GlobalSampler::train>(gamma, this->K, nodeLikelihoods, cutoff);
+
+			std::vector<Float> newTopicWeights(this->K - 1);
+			if (_gs == GlobalSampler::train)
+			{
+				std::vector<WeightType> cntByLevel(this->K);
+				Vid prevWord = -1;
+				for (size_t w = 0; w < doc.words.size(); ++w)
 				{
+					if (doc.words[w] >= this->realV) break;
 					if (doc.words[w] != prevWord)
 					{
 						std::fill(cntByLevel.begin(), cntByLevel.end(), 0);
@@ -381,23 +484,65 @@ namespace tomoto
 						cntByLevel[level] += doc.getWordWeight(w);
 					}
 				}
-			}
 
-			if (_gs == GlobalSampler::train)
-			{
 				for (size_t l = 1; l < this->K; ++l)
 				{
 					newTopicWeights[l - 1] -= math::lgammaT(doc.numByTopic[l] + this->realV * this->eta) - math::lgammaT(this->realV * this->eta);
 				}
 			}
 
-			ld.nt->template calcWordLikelihood<_tw>(this->eta, this->realV, this->K, pool, doc, newTopicWeights, ld);
+			ld.nt->template calcWordLikelihood<_tw>(this->eta, this->realV, this->K, pool, doc, newTopicWeights, ld, nodeLikelihoods, nodeWLikelihoods, 
+				_gs == GlobalSampler::train);
 
-			ld.nt->nodeLikelihoods = (ld.nt->nodeLikelihoods.array() - ld.nt->nodeLikelihoods.maxCoeff()).exp();
-			sample::prefixSum(ld.nt->nodeLikelihoods.data(), ld.nt->nodeLikelihoods.size());
-			size_t newPath = sample::sampleFromDiscreteAcc(ld.nt->nodeLikelihoods.data(),
-				ld.nt->nodeLikelihoods.data() + ld.nt->nodeLikelihoods.size(), rgs);
+			nodeLikelihoods = (nodeLikelihoods.array() - nodeLikelihoods.maxCoeff()).exp();
+			sample::prefixSum(nodeLikelihoods.data(), nodeLikelihoods.size());
+			return sample::sampleFromDiscreteAcc(nodeLikelihoods.data(),
+				nodeLikelihoods.data() + nodeLikelihoods.size(), rgs);
+		}
+
+		/*
+		returns the log-likelihood of the current path of `doc` in `ld` on the scale of `choosePath`, 
+		or -INFINITY if the path has disappeared.
+		It gives a lower bound of the best path, and since no word likelihood exceeds 0,
+		a subtree whose probability of being reached is far below it can be skipped.
+		*/
+		Float getCurrentPathLL(const _DocType& doc, const _ModelState& ld) const
+		{
+			auto& nodes = ld.nt->nodes;
+			if (!nodes[doc.path.back()].numCustomers) return -INFINITY;
 
+			Float ll = 0;
+			for (size_t l = 1; l < this->K; ++l)
+			{
+				ll += log(nodes[doc.path[l]].numCustomers / (nodes[doc.path[l - 1]].numCustomers + gamma));
+				ll -= math::lgammaT(ld.numByTopic[doc.path[l]] + doc.numByTopic[l] + this->realV * this->eta) 
+					- math::lgammaT(ld.numByTopic[doc.path[l]] + this->realV * this->eta);
+			}
+
+			std::vector<WeightType> cntByLevel(this->K);
+			Vid prevWord = -1;
+			for (size_t w = 0; w < doc.words.size(); ++w)
+			{
+				if (doc.words[w] >= this->realV) break;
+				if (doc.words[w] != prevWord)
+				{
+					std::fill(cntByLevel.begin(), cntByLevel.end(), 0);
+					prevWord = doc.words[w];
+				}
+				size_t level = doc.Zs[w];
+				if (level)
+				{
+					ll += log(ld.numByTopicWord(doc.path[level], doc.words[w]) + this->eta + cntByLevel[level]);
+					cntByLevel[level] += doc.getWordWeight(w);
+				}
+			}
+			return ll;
+		}
+
+		// puts `doc` back into `ld` along the path ending at `newPath`, making new nodes if it is an inner node
+		template<GlobalSampler _gs>
+		void attachPath(_DocType& doc, _ModelState& ld, size_t newPath) const
+		{
 			if(_gs == GlobalSampler::train) newPath = ld.nt->template generateLeafNode<_tw>(newPath, this->K, ld);
 			doc.path.back() = newPath;
 			for (size_t l = this->K - 2; l > 0; --l)
@@ -455,11 +600,95 @@ namespace tomoto
 		template<GlobalSampler _gs, typename _DocIter>
 		void sampleGlobalLevel(ThreadPool* pool, _ModelState* globalData, _RandGen* rgs, _DocIter first, _DocIter last) const
 		{
-			for (auto doc = first; doc != last; ++doc)
+			if (_gs != GlobalSampler::inference && pathBatch && pool && pool->getNumWorkers() > 1)
 			{
-				samplePathes<_gs>(*doc, pool, *globalData, rgs[0]);
+				samplePathesInBatch<_gs>(*pool, *globalData, rgs, first, last);
+			}
+			else
+			{
+				for (auto doc = first; doc != last; ++doc)
+				{
+					samplePathes<_gs>(*doc, pool, *globalData, rgs[0]);
+				}
 			}
 			if (_gs != GlobalSampler::inference) globalData->nt->markEmptyBlocks();
+			if (_gs == GlobalSampler::train) compactNodeTrees(*globalData, first, last);
+		}
+
+		/*
+		compacts the trees of `ld` once at least half of their blocks are dead, which happens as paths die out during long runs.
+		The rows of the counts follow the blocks they belong to, and the pathes of the documents are remapped to the new ids.
+		It runs only on the global state between the global sampling and `distributeMergedState`,
+		so the states of the workers are rebuilt from the compacted one.
+		*/
+		template<typename _DocIter>
+		void compactNodeTrees(_ModelState& ld, _DocIter first, _DocIter last) const
+		{
+			static constexpr size_t blockSize = detail::NodeTrees::blockSize;
+			auto& nt = *ld.nt;
+			const size_t emptyBlocks = std::count(nt.levelBlocks.begin(), nt.levelBlocks.end(), 0);
+			if (emptyBlocks < minCompactedBlocks || emptyBlocks * 2 < nt.levelBlocks.size()) return;
+
+			const size_t oldSize = nt.nodes.size();
+			const auto newIds = nt.compact();
+			const size_t newSize = nt.nodes.size();
+			Eigen::Matrix<WeightType, -1, 1> numByTopic = Eigen::Matrix<WeightType, -1, 1>::Zero(newSize);
+			Eigen::Matrix<WeightType, -1, -1> numByTopicWord = Eigen::Matrix<WeightType, -1, -1>::Zero(newSize, ld.numByTopicWord.cols());
+			for (size_t b = 0; b < oldSize; b += blockSize)
+			{
+				if (newIds[b] < 0) continue;
+				numByTopic.segment(newIds[b], blockSize) = ld.numByTopic.segment(b, blockSize);
+				numByTopicWord.middleRows(newIds[b], blockSize) = ld.numByTopicWord.middleRows(b, blockSize);
+			}
+			ld.numByTopic = std::move(numByTopic);
+			ld.numByTopicWord.replaceData(std::move(numByTopicWord));
+
+			for (; first != last; ++first)
+			{
+				for (auto& p : first->path)
+				{
+					if (newIds[p] >= 0) p = newIds[p];
+				}
+			}
+		}
+
+		/*
+		samples pathes of `pathBatch` documents per worker at once.
+		All documents of a batch are detached from the tree first, then each worker chooses pathes of its documents
+		against the same snapshot of the tree, and finally the documents are attached back one by one,
+		which makes new nodes for the documents that chose inner nodes.
+		*/
+		template<GlobalSampler _gs, typename _DocIter>
+		void samplePathesInBatch(ThreadPool& pool, _ModelState& ld, _RandGen* rgs, _DocIter first, _DocIter last) const
+		{
+			const size_t numWorkers = pool.getNumWorkers();
+			const size_t batchSize = pathBatch * numWorkers;
+			std::vector<Vector> buffers(numWorkers * 2);
+			std::vector<size_t> newPathes(batchSize);
+			for (; first != last; )
+			{
+				const size_t n = std::min((size_t)std::distance(first, last), batchSize);
+				for (size_t i = 0; i < n; ++i)
+				{
+					if (first[i].getSumWordWeight()) detachPath<_gs>(first[i], ld);
+				}
+
+				std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t threadId)
+				{
+					for (size_t i = threadId; i < n; i += numWorkers)
+					{
+						if (!first[i].getSumWordWeight()) continue;
+						newPathes[i] = choosePath<_gs>(first[i], nullptr, ld, rgs[threadId], buffers[threadId * 2], buffers[threadId * 2 + 1]);
+					}
+				});
+				for (auto& r : res) r.get();
+
+				for (size_t i = 0; i < n; ++i)
+				{
+					if (first[i].getSumWordWeight()) attachPath<_gs>(first[i], ld, newPathes[i]);
+				}
+				first += n;
+			}
 		}
 
 		template<typename _DocIter>
@@ -488,23 +717,31 @@ namespace tomoto
 			const size_t V = this->realV;
 			const size_t K = ld.nt->nodes.size();
 			size_t liveK = 0;
-			// topic-word distribution
-			auto lgammaEta = math::lgammaT(this->eta);
+			// topic-word distribution, where dead nodes are masked out and zero counts add exactly 0
+			Eigen::Array<Float, -1, 1> live = Eigen::Array<Float, -1, 1>::Zero(K);
 			for (Tid k = 0; k < K; ++k)
 			{
 				if (!ld.nt->nodes[k]) continue;
 				++liveK;
+				live[k] = 1;
 				ll -= math::lgammaT(ld.numByTopic[k] + V * this->eta);
-				for (Vid v = 0; v < V; ++v)
-				{
-					if (!ld.numByTopicWord(k, v)) continue;
-					ll += math::lgammaT(ld.numByTopicWord(k, v) + this->eta) - lgammaEta;
-				}
 			}
+			ll += this->sumChunks(nullptr, V, this->llChunkVocabs, [&](size_t b, size_t e)
+			{
+				return (double)(Eigen::lgammaT_subt(Eigen::Array<Float, -1, -1>::Constant(K, e - b, this->eta),
+					ld.numByTopicWord.block(0, b, K, e - b).array().template cast<Float>()).colwise() * live).sum();
+			});
 			ll += math::lgammaT(V*this->eta) * liveK;
 			return ll;
 		}
 
+		// the trees are shared by the global state and the states of the workers, so they are counted once
+		void addMemoryUsage(MemoryUsage& ret) const
+		{
+			BaseClass::addMemoryUsage(ret);
+			ret.emplace_back("nodeTrees", this->globalState.nt ? this->globalState.nt->getMemoryUsage() : 0);
+		}
+
 		void initGlobalState(bool initDocs)
 		{
 			const size_t V = this->realV;
@@ -625,6 +862,26 @@ namespace tomoto
 
 		GETTER(Gamma, Float, gamma);
 
+		size_t getPathBatch() const override
+		{
+			return pathBatch;
+		}
+
+		void setPathBatch(size_t docs) override
+		{
+			pathBatch = docs;
+		}
+
+		Float getPathPruneThreshold() const override
+		{
+			return pathPruneThreshold;
+		}
+
+		void setPathPruneThreshold(Float threshold) override
+		{
+			pathPruneThreshold = threshold;
+		}
+
 		bool isLiveTopic(Tid tid) const override
 		{
 			return this->globalState.nt->nodes[tid];
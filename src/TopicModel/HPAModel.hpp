@@ -17,9 +17,20 @@ namespace tomoto
 		std::array<Eigen::Matrix<WeightType, -1, -1>, 3> numByTopicWord;
 		std::array<Eigen::Matrix<WeightType, -1, 1>, 3> numByTopic;
 		std::array<Vector, 2> subTmp;
+		Vector superCoef; // len = K, (n_d(k+1) + alpha_(k+1)) / (n_d(k+1) + subAlphaSum_k) of the document being sampled
+		Vector subMass; // len = K2, sum of superCoef_k * (n_dkk2 + subAlpha_kk2) over k
 
 		Eigen::Matrix<WeightType, -1, -1> numByTopic1_2;
 
+		uint64_t getMemoryUsage() const
+		{
+			uint64_t ret = ModelStateLDA<_tw>::getMemoryUsage() + heapBytes(superCoef) + heapBytes(subMass) + heapBytes(numByTopic1_2);
+			for (auto& m : numByTopicWord) ret += heapBytes(m);
+			for (auto& m : numByTopic) ret += heapBytes(m);
+			for (auto& m : subTmp) ret += heapBytes(m);
+			return ret;
+		}
+
 		DEFINE_SERIALIZER_AFTER_BASE(ModelStateLDA<_tw>, numByTopicWord, numByTopic, numByTopic1_2);
 	};
 
@@ -89,6 +100,42 @@ namespace tomoto
 			return std::make_pair<size_t, size_t>(ceil(k * (float)K2 / this->K), ceil((k + 1) * (float)K2 / this->K));
 		}
 
+		/*
+		In the non-exclusive model, the likelihood of (z1 = k, z2 = k2) at the sub level is superCoef_k * (n_dkk2 + subAlpha_kk2) * p(w | k2),
+		so k2 is drawn first from subMass_k2 * p(w | k2) and then k is drawn from the column k2.
+		Keeping subMass up to date costs O(K2) per word, so each word takes O(K + K2) instead of O(K * K2).
+		*/
+		void initSubMass(_ModelState& ld, const _DocType& doc) const
+		{
+			const auto K = this->K;
+			ld.superCoef = (doc.numByTopic.tail(K).array().template cast<Float>() + this->alphas.tail(K).array())
+				/ (doc.numByTopic.tail(K).array().template cast<Float>() + subAlphaSum.array());
+			ld.subMass = ((doc.numByTopic1_2.rightCols(K2).template cast<Float>() + subAlphas.rightCols(K2)).array().colwise() * ld.superCoef.array()).colwise().sum().transpose();
+		}
+
+		// it should be called with `_attach = false` before the counts of z1 change, and with `_attach = true` after them
+		template<bool _attach>
+		void updateSubMass(_ModelState& ld, const _DocType& doc, Tid z1) const
+		{
+			if (!z1) return;
+			const Tid k = z1 - 1;
+			if (_attach) ld.superCoef[k] = (doc.numByTopic[z1] + this->alphas[z1]) / (doc.numByTopic[z1] + subAlphaSum[k]);
+			auto row = (doc.numByTopic1_2.row(k).tail(K2).transpose().array().template cast<Float>() + subAlphas.row(k).tail(K2).transpose().array()) * ld.superCoef[k];
+			if (_attach) ld.subMass.array() += row;
+			else ld.subMass.array() -= row;
+		}
+
+		// topic 1 assignment likelihoods given topic 2 (1 ~ K2) in the non-exclusive model. ret K FLOATs
+		Float* getZ1Likelihoods(_ModelState& ld, const _DocType& doc, Tid z2) const
+		{
+			auto& zLikelihood = ld.zLikelihood;
+			zLikelihood.head(this->K) = ld.superCoef.array()
+				* (doc.numByTopic1_2.col(z2).array().template cast<Float>() + subAlphas.col(z2).array());
+			sample::prefixSum(zLikelihood.data(), this->K);
+			return &zLikelihood[0];
+		}
+
+		// topic assignment likelihoods for new word. ret K2+K+1 FLOATs
 		template<bool _asymEta>
 		Float* getZLikelihoods(_ModelState& ld, const _DocType& doc, size_t docId, size_t vid) const
 		{
@@ -123,22 +170,15 @@ namespace tomoto
 			}
 			else
 			{
-				for (size_t k = 0; k < K; ++k)
-				{
-					zLikelihood.segment(K2 * k, K2) = (doc.numByTopic[k + 1] + this->alphas[k + 1])
-						* (doc.numByTopic1_2.row(k).tail(K2).array().transpose().template cast<Float>() + subAlphas.row(k).tail(K2).array().transpose()) 
-						/ (doc.numByTopic[k + 1] + subAlphaSum[k])
-						* ld.subTmp[1].array();
-				}
+				zLikelihood.head(K2) = (ld.subMass.array() * ld.subTmp[1].array()).cwiseMax(0);
 
-				zLikelihood.segment(K2 * K, K) = (doc.numByTopic.tail(K).array().template cast<Float>() + this->alphas.tail(K).array())
+				zLikelihood.segment(K2, K) = ld.superCoef.array()
 					* (doc.numByTopic1_2.col(0).array().template cast<Float>() + subAlphas.col(0).array())
-					/ (doc.numByTopic.tail(K).array().template cast<Float>() + subAlphaSum.array().template cast<Float>())
 					* ld.subTmp[0].array();
 
-				zLikelihood[K2 * K + K] = (doc.numByTopic[0] + this->alphas[0]) * rootWordProb;
+				zLikelihood[K2 + K] = (doc.numByTopic[0] + this->alphas[0]) * rootWordProb;
 			}
-			sample::prefixSum(zLikelihood.data(), zLikelihood.size());
+			sample::prefixSum(zLikelihood.data(), K2 + K + 1);
 			return &zLikelihood[0];
 		}
 
@@ -188,10 +228,13 @@ namespace tomoto
 			size_t vOffset = (_ps == ParallelScheme::partition && partitionId) ? edd.vChunkOffset[partitionId - 1] : 0;
 
 			const auto K = this->K;
+			if (!_Exclusive) initSubMass(ld, doc);
 			for (size_t w = b; w < e; ++w)
 			{
 				if (doc.words[w] >= this->realV) continue;
+				if (!_Exclusive) updateSubMass<false>(ld, doc, doc.Zs[w]);
 				addWordTo<-1>(ld, doc, w, doc.words[w] - vOffset, doc.Zs[w], doc.Z2s[w]);
+				if (!_Exclusive) updateSubMass<true>(ld, doc, doc.Zs[w]);
 				Float* dist;
 				if (this->etaByTopicWord.size())
 				{
@@ -222,15 +265,16 @@ namespace tomoto
 				}
 				else
 				{
-					auto z = sample::sampleFromDiscreteAcc(dist, dist + K * K2 + K + 1, rgs);
-					if (z < K * K2)
+					auto z = sample::sampleFromDiscreteAcc(dist, dist + K2 + K + 1, rgs);
+					if (z < K2)
 					{
-						doc.Zs[w] = (z / K2) + 1;
-						doc.Z2s[w] = (z % K2) + 1;
+						doc.Z2s[w] = z + 1;
+						dist = getZ1Likelihoods(ld, doc, doc.Z2s[w]);
+						doc.Zs[w] = sample::sampleFromDiscreteAcc(dist, dist + K, rgs) + 1;
 					}
-					else if (z < K * K2 + K)
+					else if (z < K2 + K)
 					{
-						doc.Zs[w] = z - K * K2 + 1;
+						doc.Zs[w] = z - K2 + 1;
 						doc.Z2s[w] = 0;
 					}
 					else
@@ -239,7 +283,9 @@ namespace tomoto
 						doc.Z2s[w] = 0;
 					}
 				}
+				if (!_Exclusive) updateSubMass<false>(ld, doc, doc.Zs[w]);
 				addWordTo<1>(ld, doc, w, doc.words[w] - vOffset, doc.Zs[w], doc.Z2s[w]);
+				if (!_Exclusive) updateSubMass<true>(ld, doc, doc.Zs[w]);
 			}
 		}
 
@@ -515,6 +561,19 @@ namespace tomoto
 			return extractTopN<Tid>(getSubTopicBySuperTopic(k, true), topN);
 		}
 
+		// the root topic, super topics and sub topics
+		size_t getNumWidsTopics() const
+		{
+			return 1 + this->K + K2;
+		}
+
+		// the counts of each level are stored in separate matrices, so they can't be viewed as one
+		const void* _getTopicWordCounts(size_t& rows, size_t& cols) const
+		{
+			rows = cols = 0;
+			return nullptr;
+		}
+
 		std::vector<Float> _getWidsByTopic(Tid k, bool normalize = true) const
 		{
 			const size_t V = this->realV;
@@ -0,0 +1,202 @@
+#include <array>
+#include "InferenceModel.h"
+#include "../Utils/sample.hpp"
+#include "../Utils/Half.hpp"
+
+namespace tomoto
+{
+	void InferenceModel::write(std::ostream& writer, TermWeight tw, const Dictionary& dict, size_t V,
+		const std::vector<Float>& alphas, const std::vector<Float>& vocabWeights,
+		const Matrix& phi, InferenceDType dtype)
+	{
+		const size_t K = phi.rows();
+		if (phi.cols() != V || alphas.size() != K) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "wrong size of `phi` or `alphas`");
+		if (tw != TermWeight::one && vocabWeights.size() != V) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "wrong size of `vocabWeights`");
+
+		// only the words used in the model are kept, and they always come first in the dictionary
+		Dictionary usedDict;
+		for (size_t v = 0; v < V; ++v) usedDict.add(dict.toWord(v));
+
+		std::vector<Float> scales;
+		std::vector<float> data;
+		std::vector<uint16_t> qData;
+		if (dtype == InferenceDType::float32)
+		{
+			data.resize(V * K);
+			for (size_t v = 0; v < V; ++v)
+			{
+				for (size_t k = 0; k < K; ++k) data[v * K + k] = phi(k, v);
+			}
+		}
+		else
+		{
+			// each topic is scaled by its maximum so that quantization keeps the relative precision.
+			// the smallest code is 1 rather than 0, so every topic keeps a non-zero probability for every word.
+			scales.resize(K);
+			qData.resize(V * K);
+			for (size_t k = 0; k < K; ++k)
+			{
+				Float m = phi.row(k).maxCoeff();
+				if (!(m > 0)) m = 1;
+				scales[k] = dtype == InferenceDType::uint16 ? m / 65535 : m;
+			}
+
+			for (size_t v = 0; v < V; ++v)
+			{
+				for (size_t k = 0; k < K; ++k)
+				{
+					const Float p = phi(k, v) / scales[k];
+					uint16_t q = dtype == InferenceDType::uint16
+						? (uint16_t)std::min(std::round(p), (Float)65535)
+						: detail::floatToHalf(p);
+					qData[v * K + k] = std::max(q, (uint16_t)1);
+				}
+			}
+		}
+
+		serializer::writeMany(writer, serializer::to_key("TIFM"), (uint32_t)0, (uint32_t)dtype, (uint32_t)tw, (uint32_t)K, (uint32_t)V,
+			usedDict, alphas, tw == TermWeight::one ? std::vector<Float>{} : vocabWeights, scales, data, qData);
+	}
+
+	void InferenceModel::read(std::istream& reader)
+	{
+		uint32_t version, dt, t, k, v;
+		serializer::readMany(reader, serializer::to_key("TIFM"), version, dt, t, k, v,
+			dict, alphas, vocabWeights, scales, phi, qPhi);
+		if (version != 0) throw std::ios_base::failure{ "unsupported version of inference model" };
+		if (dt >= (uint32_t)InferenceDType::size || t >= (uint32_t)TermWeight::size) throw std::ios_base::failure{ "broken inference model" };
+		dtype = (InferenceDType)dt;
+		tw = (TermWeight)t;
+		K = k;
+		V = v;
+		const bool valid = dict.size() == V && alphas.size() == K
+			&& (tw == TermWeight::one ? vocabWeights.empty() : vocabWeights.size() == V)
+			&& (dtype == InferenceDType::float32
+				? phi.size() == V * K
+				: (qPhi.size() == V * K && scales.size() == K));
+		if (!valid) throw std::ios_base::failure{ "broken inference model" };
+	}
+
+	std::vector<Vid> InferenceModel::toWids(const std::vector<std::string>& words) const
+	{
+		std::vector<Vid> ret;
+		for (auto& w : words)
+		{
+			auto id = dict.toWid(w);
+			if (id == non_vocab_id || id >= V) continue;
+			ret.emplace_back(id);
+		}
+		return ret;
+	}
+
+	void InferenceModel::getPhi(Vid w, Float* out) const
+	{
+		switch (dtype)
+		{
+		case InferenceDType::float32:
+			std::copy(phi.begin() + w * K, phi.begin() + (w + 1) * K, out);
+			break;
+		case InferenceDType::float16:
+		{
+			auto& table = detail::getHalfTable();
+			for (size_t k = 0; k < K; ++k) out[k] = table[qPhi[w * K + k]] * scales[k];
+			break;
+		}
+		case InferenceDType::uint16:
+			for (size_t k = 0; k < K; ++k) out[k] = qPhi[w * K + k] * scales[k];
+			break;
+		default:
+			break;
+		}
+	}
+
+	std::vector<Float> InferenceModel::inferOne(const std::vector<Vid>& words, size_t maxIter, size_t seed, double* ll) const
+	{
+		const size_t n = words.size();
+		ScalarRandGen rg{ seed };
+		Eigen::Map<const Vector> alpha{ alphas.data(), (Eigen::Index)K };
+		Vector cnt = Vector::Zero(K), dist{ K };
+		Matrix tokenPhi{ K, n };
+		std::vector<Tid> zs(n);
+		std::vector<Float> ws(n, 1);
+		if (tw == TermWeight::idf)
+		{
+			for (size_t i = 0; i < n; ++i) ws[i] = vocabWeights[words[i]];
+		}
+		else if (tw == TermWeight::pmi)
+		{
+			// the same weighting as `LDAModel::initializeDocState`
+			std::unordered_map<Vid, size_t> tf;
+			for (auto w : words) ++tf[w];
+			for (size_t i = 0; i < n; ++i) ws[i] = std::max((Float)std::log(tf[words[i]] / vocabWeights[words[i]] / n), (Float)0);
+		}
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			getPhi(words[i], tokenPhi.col(i).data());
+			dist = alpha.array() * tokenPhi.col(i).array();
+			sample::prefixSum(dist.data(), K);
+			zs[i] = sample::sampleFromDiscreteAcc(dist.data(), dist.data() + K, rg);
+			cnt[zs[i]] += ws[i];
+		}
+
+		for (size_t it = 0; it < maxIter; ++it)
+		{
+			for (size_t i = 0; i < n; ++i)
+			{
+				cnt[zs[i]] = std::max(cnt[zs[i]] - ws[i], (Float)0);
+				dist = (cnt + alpha).array() * tokenPhi.col(i).array();
+				sample::prefixSum(dist.data(), K);
+				zs[i] = sample::sampleFromDiscreteAcc(dist.data(), dist.data() + K, rg);
+				cnt[zs[i]] += ws[i];
+			}
+		}
+
+		Vector theta = cnt + alpha;
+		theta /= theta.sum();
+		if (ll)
+		{
+			double s = 0;
+			for (size_t i = 0; i < n; ++i) s += std::log(theta.dot(tokenPhi.col(i)));
+			*ll = s;
+		}
+		return { theta.data(), theta.data() + K };
+	}
+
+	std::vector<std::vector<Float>> InferenceModel::infer(const std::vector<std::vector<Vid>>& docs, size_t maxIter,
+		size_t numWorkers, size_t seed, std::vector<double>* ll) const
+	{
+		for (auto& doc : docs)
+		{
+			for (auto w : doc)
+			{
+				if (w >= V) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("word id %u is out of the vocabulary", w));
+			}
+		}
+
+		std::vector<std::vector<Float>> ret(docs.size());
+		if (ll) ll->resize(docs.size());
+		if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+		numWorkers = std::max(std::min(numWorkers, docs.size()), (size_t)1);
+		auto job = [&](size_t i)
+		{
+			ret[i] = inferOne(docs[i], maxIter, seed + i, ll ? &(*ll)[i] : nullptr);
+		};
+
+		if (numWorkers == 1)
+		{
+			for (size_t i = 0; i < docs.size(); ++i) job(i);
+		}
+		else
+		{
+			auto pool = PoolManager::getInstance().borrow(numWorkers);
+			std::vector<std::future<void>> res;
+			for (size_t i = 0; i < docs.size(); ++i)
+			{
+				res.emplace_back(pool->enqueue([&, i](size_t) { job(i); }));
+			}
+			for (auto& r : res) r.get();
+		}
+		return ret;
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "LDA.h"
+
+namespace tomoto
+{
+	/*
+	A read-only model which has only what inference needs: the dictionary, alpha, term weights and the normalized topic-word distribution.
+	It is exported from a trained model by `ILDAModel::exportInferenceModel` and can only infer topic distributions of unseen documents.
+	*/
+	class InferenceModel
+	{
+		InferenceDType dtype = InferenceDType::float32;
+		TermWeight tw = TermWeight::one;
+		size_t K = 0, V = 0;
+		Dictionary dict;
+		std::vector<Float> alphas; // Dim: (Topic, )
+		std::vector<Float> vocabWeights; // Dim: (Vocabs, ), the same as `LDAModel::vocabWeights`
+		std::vector<Float> scales; // Dim: (Topic, ), the factor of each topic which `qPhi` is multiplied by, for InferenceDType::float16 and uint16
+		std::vector<float> phi; // Dim: (Vocabs, Topic), p(word|topic) in word-major order
+		std::vector<uint16_t> qPhi; // quantized `phi`, for InferenceDType::float16 and uint16
+
+		void getPhi(Vid w, Float* out) const;
+		std::vector<Float> inferOne(const std::vector<Vid>& words, size_t maxIter, size_t seed, double* ll) const;
+	public:
+		/*
+		`phi` is the topic-word distribution whose row k is p(w|k).
+		`vocabWeights` is the same as `LDAModel::vocabWeights`, empty for TermWeight::one.
+		*/
+		static void write(std::ostream& writer, TermWeight tw, const Dictionary& dict, size_t V,
+			const std::vector<Float>& alphas, const std::vector<Float>& vocabWeights,
+			const Matrix& phi, InferenceDType dtype);
+
+		void read(std::istream& reader);
+
+		InferenceDType getDType() const { return dtype; }
+		TermWeight getTermWeight() const { return tw; }
+		size_t getK() const { return K; }
+		size_t getV() const { return V; }
+		const Dictionary& getVocabDict() const { return dict; }
+
+		// words out of the vocabulary are ignored
+		std::vector<Vid> toWids(const std::vector<std::string>& words) const;
+
+		// it returns the topic distribution of each document, and fills `ll` with the log-likelihood of each document if given
+		std::vector<std::vector<Float>> infer(const std::vector<std::vector<Vid>>& docs, size_t maxIter,
+			size_t numWorkers, size_t seed, std::vector<double>* ll = nullptr) const;
+	};
+}
@@ -5,11 +5,22 @@ namespace tomoto
 {
     enum class TermWeight { one, idf, pmi, size };
 
+    enum class SamplingMethod { dense, sparse, mh, size };
+
+    enum class InferenceDType { float32, float16, uint16, size };
+
+    enum class DocOrder { shuffled, vocab_block, length, word_major, size };
+
+    enum class HeldOutEstimator { left_to_right, importance_sampling, harmonic_mean, size };
+
 	template<typename _Scalar, Eigen::Index _rows, Eigen::Index _cols>
 	struct ShareableMatrix : Eigen::Map<Eigen::Matrix<_Scalar, _rows, _cols>>
 	{
 		using BaseType = Eigen::Map<Eigen::Matrix<_Scalar, _rows, _cols>>;
 		Eigen::Matrix<_Scalar, _rows, _cols> ownData;
+		// if true, the data lives in an external buffer (e.g. a memory-mapped model file) held by the model
+		// and, unlike plain views, copies of it own their data.
+		bool external = false;
 
 		ShareableMatrix(_Scalar* ptr = nullptr, Eigen::Index rows = 0, Eigen::Index cols = 0) 
 			: BaseType(nullptr, _rows != -1 ? _rows : 0, _cols != -1 ? _cols : 0)
@@ -18,12 +29,20 @@ namespace tomoto
 		}
 
 		ShareableMatrix(const ShareableMatrix& o)
-			: BaseType(nullptr, _rows != -1 ? _rows : 0, _cols != -1 ? _cols : 0), ownData{ o.ownData }
+			: BaseType(nullptr, _rows != -1 ? _rows : 0, _cols != -1 ? _cols : 0)
 		{
-			if (o.ownData.data())
+			if (o.external)
 			{
+				allocOwn(o.rows(), o.cols());
+				ownData = o;
 				new (this) BaseType(ownData.data(), ownData.rows(), ownData.cols());
 			}
+			else if (o.ownData.data())
+			{
+				allocOwn(o.ownData.rows(), o.ownData.cols());
+				ownData = o.ownData;
+				new (this) BaseType(ownData.data(), o.rows(), o.cols());
+			}
 			else
 			{
 				new (this) BaseType((_Scalar*)o.data(), o.rows(), o.cols());
@@ -34,11 +53,19 @@ namespace tomoto
 
 		ShareableMatrix& operator=(const ShareableMatrix& o)
 		{
-			if (o.ownData.data())
+			external = false;
+			if (o.external)
 			{
-				ownData = o.ownData;
+				allocOwn(o.rows(), o.cols());
+				ownData = o;
 				new (this) BaseType(ownData.data(), ownData.rows(), ownData.cols());
 			}
+			else if (o.ownData.data())
+			{
+				allocOwn(o.ownData.rows(), o.ownData.cols());
+				ownData = o.ownData;
+				new (this) BaseType(ownData.data(), o.rows(), o.cols());
+			}
 			else
 			{
 				new (this) BaseType((_Scalar*)o.data(), o.rows(), o.cols());
@@ -48,11 +75,24 @@ namespace tomoto
 
 		ShareableMatrix& operator=(ShareableMatrix&& o) = default;
 
+		/*
+		resizes the own data without initializing it.
+		A new allocation is advised to use huge pages before its pages are touched, see `HugePages`.
+		*/
+		void allocOwn(Eigen::Index rows, Eigen::Index cols)
+		{
+			if (ownData.rows() == rows && ownData.cols() == cols) return;
+			ownData.resize(rows, cols);
+			HugePages::advise(ownData.data(), sizeof(_Scalar) * ownData.size());
+		}
+
 		void init(_Scalar* ptr, Eigen::Index rows, Eigen::Index cols)
 		{
+			external = false;
 			if (!ptr && rows && cols)
 			{
-				ownData = Eigen::Matrix<_Scalar, _rows, _cols>::Zero(_rows != -1 ? _rows : rows, _cols != -1 ? _cols : cols);
+				allocOwn(_rows != -1 ? _rows : rows, _cols != -1 ? _cols : cols);
+				ownData.setZero();
 				ptr = ownData.data();
 			}
 			else
@@ -64,37 +104,123 @@ namespace tomoto
 
 		void conservativeResize(size_t newRows, size_t newCols)
 		{
+			if (external) becomeOwner();
 			ownData.conservativeResize(_rows != -1 ? _rows : newRows, _cols != -1 ? _cols : newCols);
 			new (this) BaseType(ownData.data(), ownData.rows(), ownData.cols());
 		}
 
+		/*
+		grows the number of columns to `newCols`, filling the new columns with zeros.
+		The own data keeps spare columns, so that growing one by one reallocates only O(log n) times.
+		*/
+		void growCols(size_t newCols)
+		{
+			const size_t rows = this->rows(), oldCols = this->cols();
+			if (newCols <= oldCols) return;
+			if (external || ownData.data() != this->data()) becomeOwner();
+			if ((size_t)ownData.cols() < newCols)
+			{
+				Eigen::Matrix<_Scalar, _rows, _cols> grown;
+				grown.resize(rows, std::max(newCols, oldCols + oldCols / 2));
+				HugePages::advise(grown.data(), sizeof(_Scalar) * grown.size());
+				grown.leftCols(oldCols) = ownData.leftCols(oldCols);
+				ownData = std::move(grown);
+			}
+			new (this) BaseType(ownData.data(), rows, newCols);
+			this->rightCols(newCols - oldCols).setZero();
+		}
+
+		// takes `data` as its own data in place of the current one
+		void replaceData(Eigen::Matrix<_Scalar, _rows, _cols>&& data)
+		{
+			ownData = std::move(data);
+			external = false;
+			new (this) BaseType(ownData.data(), ownData.rows(), ownData.cols());
+		}
+
 		void becomeOwner()
 		{
 			if (ownData.data() != this->m_data)
 			{
-				ownData = *this;
+				Eigen::Matrix<_Scalar, _rows, _cols> copied;
+				copied.resize(this->rows(), this->cols());
+				HugePages::advise(copied.data(), sizeof(_Scalar) * copied.size());
+				copied = *this;
+				ownData = std::move(copied);
 				new (this) BaseType(ownData.data(), ownData.rows(), ownData.cols());
 			}
+			external = false;
 		}
 
+		// the highest bit of `rows` indicates that padding for alignment precedes the data
+		static constexpr uint32_t alignedFlag = 0x80000000;
+
 		void serializerRead(std::istream& istr)
 		{
 			uint32_t rows = serializer::readFromStream<uint32_t>(istr);
 			uint32_t cols = serializer::readFromStream<uint32_t>(istr);
+			if (rows & alignedFlag)
+			{
+				rows &= ~alignedFlag;
+				uint8_t padding = serializer::readFromStream<uint8_t>(istr);
+				istr.seekg(padding, std::ios_base::cur);
+			}
+
+			// use the data in place if the stream reads a viewable memory, like a memory-mapped file
+			auto* ptr = serializer::getViewablePtr(istr);
+			if (ptr && (size_t)ptr % alignof(_Scalar) == 0 && rows && cols)
+			{
+				init((_Scalar*)ptr, rows, cols);
+				external = true;
+				if (!istr.seekg(sizeof(_Scalar) * this->size(), std::ios_base::cur) || !istr.good())
+					throw std::ios_base::failure(std::string("reading type '") + typeid(_Scalar).name() + std::string("' is failed"));
+				return;
+			}
+
 			init(nullptr, rows, cols);
 			if (!istr.read((char*)this->data(), sizeof(_Scalar) * this->size()))
 				throw std::ios_base::failure(std::string("reading type '") + typeid(_Scalar).name() + std::string("' is failed"));
 		}
 
+		// writes the header of a matrix. `rows * cols` elements in column-major order should follow it.
+		static void serializerWriteHeader(std::ostream& ostr, uint32_t rows, uint32_t cols)
+		{
+			if (serializer::isAlignedSections(ostr))
+			{
+				serializer::writeToStream<uint32_t>(ostr, rows | alignedFlag);
+				serializer::writeToStream<uint32_t>(ostr, cols);
+				auto pos = ostr.tellp();
+				uint8_t padding = 0;
+				if (pos != std::ostream::pos_type(-1))
+				{
+					padding = (uint8_t)((serializer::sectionAlignment - ((size_t)pos + 1) % serializer::sectionAlignment) % serializer::sectionAlignment);
+				}
+				serializer::writeToStream<uint8_t>(ostr, padding);
+				static const char zeros[serializer::sectionAlignment] = { 0, };
+				ostr.write(zeros, padding);
+			}
+			else
+			{
+				serializer::writeToStream<uint32_t>(ostr, rows);
+				serializer::writeToStream<uint32_t>(ostr, cols);
+			}
+		}
+
 		void serializerWrite(std::ostream& ostr) const
 		{
-			serializer::writeToStream<uint32_t>(ostr, (uint32_t)this->rows());
-			serializer::writeToStream<uint32_t>(ostr, (uint32_t)this->cols());
+			serializerWriteHeader(ostr, (uint32_t)this->rows(), (uint32_t)this->cols());
 			if (!ostr.write((const char*)this->data(), sizeof(_Scalar) * this->size()))
 				throw std::ios_base::failure(std::string("writing type '") + typeid(_Scalar).name() + std::string("' is failed"));
 		}
 	};
 
+	// only the own data is counted, so a view counts nothing
+	template<typename _Scalar, Eigen::Index _rows, Eigen::Index _cols>
+	uint64_t heapBytes(const ShareableMatrix<_Scalar, _rows, _cols>& m)
+	{
+		return heapBytes(m.ownData);
+	}
+
 	template<typename _Base, TermWeight _tw>
 	struct SumWordWeight
 	{
@@ -136,8 +262,16 @@ namespace tomoto
 		using WeightType = typename std::conditional<_tw == TermWeight::one, int32_t, float>::type;
 
 		tvector<Tid> Zs;
-		tvector<Float> wordWeights;
+		tvector<Float> wordWeights; // empty if the model shares the weight of each vocabulary (LDAArgs::compact)
+		// the frequency of the word of each token in the document, saturated at 0xFFFF. Only TermWeight::pmi with LDAArgs::compact fills it, and it is not serialized.
+		std::vector<uint16_t> wordTf;
 		ShareableMatrix<WeightType, -1, 1> numByTopic;
+		// the number of the last samplings in which each token and the whole document kept their topics, used by `freezeInterval` of plain LDA.
+		// They are empty unless it is enabled, and not serialized.
+		std::vector<uint8_t> tokenStability;
+		uint8_t docStability = 0;
+		// the number of documents this one is sampled for, 0 if it is a duplicate collapsed into another, see `collapseDuplicates` of LDAModel. Not serialized.
+		uint32_t multiplicity = 1;
 
 		DEFINE_SERIALIZER_AFTER_BASE_WITH_VERSION(DocumentBase, 0, Zs, wordWeights);
 		DEFINE_TAGGED_SERIALIZER_AFTER_BASE_WITH_VERSION(DocumentBase, 1, 0x00010001, Zs, wordWeights);
@@ -161,12 +295,44 @@ namespace tomoto
 		}
 	};
 
+	/*
+	sparse changes of the topic-word counts, which nodes of distributed training exchange after every iteration.
+	`vids` are indices into the vocabularies shared by all nodes, not the ids of a model.
+	*/
+	struct TopicWordDelta
+	{
+		std::vector<uint32_t> vids;
+		std::vector<Tid> tids;
+		std::vector<float> counts;
+	};
+
+	/*
+	sends the delta of this node and returns the deltas of all nodes, like an allreduce over MPI or a round trip to a parameter server.
+	The returned entries may repeat the same (word, topic), so simply concatenating the deltas of all nodes is enough.
+	*/
+	using TopicWordDeltaExchanger = std::function<TopicWordDelta(TopicWordDelta&&)>;
+
+	/*
+	the topics of all the words at the last checkpoint, which the next delta checkpoint is compared with.
+	Deltas are chained to the full checkpoint by `id`, so deltas left from another full checkpoint are never replayed.
+	*/
+	struct CheckpointBase
+	{
+		uint64_t id = 0;
+		size_t numDeltas = 0;
+		std::vector<Tid> zs;
+	};
+
 	struct LDAArgs
 	{
 		size_t k = 1;
 		std::vector<Float> alpha = { (Float)0.1 };
 		Float eta = (Float)0.01;
 		size_t seed = std::random_device{}();
+		// if true, TermWeight::idf shares the weight of each vocabulary instead of storing a weight per token,
+		// and TermWeight::pmi stores the 16-bit frequency of the word of each token instead of its weight
+		// The counts of documents keep WeightType, since every model reads them in Eigen expressions as columns of its doc-topic matrix.
+		bool compact = false;
 	};
 
     class ILDAModel : public ITopicModel
@@ -181,12 +347,115 @@ namespace tomoto
 		virtual void setOptimInterval(size_t) = 0;
 		virtual size_t getBurnInIteration() const = 0;
 		virtual void setBurnInIteration(size_t) = 0;
+		virtual SamplingMethod getSamplingMethod() const = 0;
+		virtual void setSamplingMethod(SamplingMethod) = 0;
+		virtual bool getDynamicBalancing() const = 0;
+		virtual void setDynamicBalancing(bool) = 0;
+		virtual size_t getAsyncStaleness() const = 0;
+		virtual void setAsyncStaleness(size_t) = 0;
+		virtual size_t getAsyncRecountInterval() const = 0;
+		virtual void setAsyncRecountInterval(size_t) = 0;
+		virtual size_t getHierarchicalGroups() const = 0;
+		virtual void setHierarchicalGroups(size_t) = 0;
+		virtual bool getPipelinedPartition() const = 0;
+		virtual void setPipelinedPartition(bool) = 0;
+		// if non-zero, ParallelScheme::partition re-cuts its vocabulary blocks by their measured costs every `partitionRebalanceInterval`-th iteration
+		virtual size_t getPartitionRebalanceInterval() const = 0;
+		virtual void setPartitionRebalanceInterval(size_t) = 0;
+		// if non-zero, plain LDA resamples stable tokens and documents less often except every `freezeInterval`-th iteration
+		virtual size_t getFreezeInterval() const = 0;
+		virtual void setFreezeInterval(size_t) = 0;
+		// whether `prepare` of plain LDA collapses the documents with the same words into one sampled for all of them
+		virtual bool getCollapseDuplicates() const = 0;
+		virtual void setCollapseDuplicates(bool) = 0;
+		virtual DocOrder getDocOrder() const = 0;
+		virtual void setDocOrder(DocOrder) = 0;
+		virtual size_t getDenseVocabSize() const = 0;
+		virtual void setDenseVocabSize(size_t) = 0;
+		virtual bool getCompact() const = 0;
+		virtual std::string getOutOfCoreDir() const = 0;
+		virtual void setOutOfCoreDir(const std::string& dir) = 0;
+		virtual size_t getNewDocSweeps() const = 0;
+		virtual void setNewDocSweeps(size_t) = 0;
+		virtual size_t getLLSampleDocs() const = 0;
+		virtual void setLLSampleDocs(size_t) = 0;
+		virtual bool getIncrementalLL() const = 0;
+		virtual void setIncrementalLL(bool) = 0;
+		// whether `eta` is optimized together with `alpha` every `optimInterval` iterations, which only plain LDA supports
+		virtual bool getOptimEta() const = 0;
+		virtual void setOptimEta(bool) = 0;
+		// whether training samples each document from its own counter-based random stream on chunks fixed regardless of the workers,
+		// so that the result doesn't depend on the number of workers, which only plain LDA supports
+		virtual bool getReproducible() const = 0;
+		virtual void setReproducible(bool) = 0;
+		// whether `infer()` samples from the cached topic-word distributions of the model, which the inferred documents don't update
+		virtual bool getFrozenInference() const = 0;
+		virtual void setFrozenInference(bool) = 0;
+		// whether `infer()` estimates the topic distributions by EM against the cached topic-word distributions, stopping each document at `tolerance`
+		virtual bool getFoldInEM() const = 0;
+		virtual void setFoldInEM(bool) = 0;
+
+		// whether documents can be added after `prepare()`, which only plain LDA supports
+		virtual bool canAppendDocs() const = 0;
+		// the number of documents added after `prepare()` and not prepared yet
+		virtual size_t getNumNewDocs() const = 0;
+		// prepares only the documents added after `prepare()`, extending the vocabularies with their new words
+		virtual void prepareNewDocs() = 0;
+
+		/*
+		makes `train()` exchange the changes of the topic-word counts with other nodes, which train on other parts of a corpus, after every iteration.
+		All nodes should be given the same `sharedVocabs` before `prepare()`, which are added to the vocabularies of the model.
+		Changes smaller than `threshold` are not sent, but kept locally until they grow. An empty `exchanger` disables it.
+		*/
+		virtual void setDistributedSync(const std::vector<std::string>& sharedVocabs, TopicWordDeltaExchanger exchanger, Float threshold = 0) = 0;
 		virtual std::vector<uint64_t> getCountByTopic() const = 0;
+		/*
+		returns the column-major (topics, vocabs) topic-word counts of the model without copying them,
+		whose type is int32_t for TermWeight::one and float for the others.
+		It returns nullptr if the model is not prepared yet, if some vocabularies are not stored densely or if the model keeps them in separate matrices.
+		The pointer is valid until the model is prepared again or its topic-word storage is changed,
+		or until it is trained while `isSharingArrays()` is true.
+		*/
+		virtual const void* getTopicWordCounts(size_t& rows, size_t& cols) const = 0;
+		// returns true if the model still shares the arrays of its documents and its topic-word counts with the models copied from or to it
+		virtual bool isSharingArrays() const = 0;
 		virtual Float getAlpha() const = 0;
 		virtual Float getAlpha(size_t k) const = 0;
 		virtual Float getEta() const = 0;
 
 		virtual std::vector<Float> getWordPrior(const std::string& word) const = 0;
 		virtual void setWordPrior(const std::string& word, const std::vector<Float>& priors) = 0;
+		/*
+		makes the next `prepare` of plain LDA draw the initial topics of the documents from the topic-word distributions of `source`,
+		whose vocabularies are aligned by their words. `source` should have the same number of topics, and nullptr cancels it.
+		*/
+		virtual void setWarmStart(const ILDAModel* source) = 0;
+
+		// it writes a compact model which can be loaded by `InferenceModel`
+		virtual void exportInferenceModel(std::ostream& writer, InferenceDType dtype) const = 0;
+
+		/*
+		estimates log p(w|phi, alpha) of each of `docs` by `method` with `numParticles` particles (or samples) per document,
+		using `numWorkers` threads. The result only depends on `seed`, not on the number of workers.
+		*/
+		virtual std::vector<double> estimateHeldOutLL(const std::vector<DocumentBase*>& docs, HeldOutEstimator method,
+			size_t numParticles, size_t numWorkers, size_t seed) const = 0;
+
+		/*
+		it writes only the topics of the words and the hyperparameters, which is much smaller and faster than `saveModel`.
+		If `base` is given, it is reset to this checkpoint, so that the following checkpoints can be written by `writeCheckpointDelta`.
+		*/
+		virtual void writeCheckpoint(std::ostream& writer, CheckpointBase* base = nullptr) const = 0;
+		/*
+		it writes only the words whose topics changed since `base` and the hyperparameters, then updates `base`.
+		It writes nothing and returns false if so many topics changed that a full checkpoint is better.
+		*/
+		virtual bool writeCheckpointDelta(std::ostream& writer, CheckpointBase& base) const = 0;
+		/*
+		it restores the state written by `writeCheckpoint` into the model prepared with the same documents,
+		replays the deltas written after it in order, and rebuilds all its counts with the prepare workers.
+		Deltas not chained to the checkpoint are ignored from the first of them. It returns the number of the deltas replayed.
+		*/
+		virtual size_t restoreCheckpoint(std::istream& reader, const std::vector<std::vector<char>>& deltas = {}) = 0;
 	};
 }
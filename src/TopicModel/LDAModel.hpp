@@ -1,12 +1,15 @@
 #pragma once
 #include <unordered_set>
+#include <unordered_map>
 #include <numeric>
 #include "TopicModel.hpp"
 #include "../Utils/EigenAddonOps.hpp"
 #include "../Utils/Utils.hpp"
 #include "../Utils/math.h"
 #include "../Utils/sample.hpp"
+#include "../Utils/Philox.hpp"
 #include "LDA.h"
+#include "InferenceModel.h"
 
 /*
 Implementation of LDA using Gibbs sampling by bab2min
@@ -51,16 +54,296 @@ Term Weighting Scheme is based on following paper:
 
 namespace tomoto
 {
+	/*
+	working buffers of the bucketed sampler (SamplingMethod::sparse)
+	*/
+	struct SparseSamplerBuffer
+	{
+		Vector invDenom; // Dim: (Topic, ), 1 / (n_k + V * eta)
+		Vector docCoef; // Dim: (Topic, ), (alpha_k + n_dk) / (n_k + V * eta)
+		Vector wordBucket; // accumulated likelihoods of topics where n_wk > 0
+		std::vector<Tid> docTopics; // topics where n_dk > 0
+		std::vector<uint32_t> docTopicPos; // position of each topic in docTopics
+		std::vector<std::vector<Tid>> topicsByWord; // topics where n_wk > 0, built lazily for each word
+		std::vector<size_t> wordStamp; // iteration when topicsByWord[w] was built
+
+		SparseSamplerBuffer() = default;
+		
+		// topicsByWord is only valid for the count matrix it was built from, so it is not copied.
+		SparseSamplerBuffer(const SparseSamplerBuffer&)
+		{
+		}
+
+		SparseSamplerBuffer(SparseSamplerBuffer&&) = default;
+
+		SparseSamplerBuffer& operator=(const SparseSamplerBuffer&)
+		{
+			topicsByWord.clear();
+			wordStamp.clear();
+			return *this;
+		}
+
+		SparseSamplerBuffer& operator=(SparseSamplerBuffer&&) = default;
+
+		uint64_t getMemoryUsage() const
+		{
+			return heapBytes(invDenom) + heapBytes(docCoef) + heapBytes(wordBucket) + heapBytes(docTopics)
+				+ heapBytes(docTopicPos) + heapBytes(topicsByWord) + heapBytes(wordStamp);
+		}
+	};
+
+	/*
+	uniforms in [0, 1) generated in bulk by the packet generator of a worker, consumed one by one by the token samplers.
+	Copies start empty, so that the states copied to the workers don't draw the same uniforms.
+	*/
+	struct UniformBuffer
+	{
+		static constexpr size_t size = 1024;
+		Eigen::Array<float, -1, 1> values;
+		size_t pos = 0;
+
+		UniformBuffer() = default;
+
+		UniformBuffer(const UniformBuffer&)
+		{
+		}
+
+		UniformBuffer(UniformBuffer&&) = default;
+
+		UniformBuffer& operator=(const UniformBuffer&)
+		{
+			return *this;
+		}
+
+		UniformBuffer& operator=(UniformBuffer&&) = default;
+	};
+
+	/*
+	wraps the generator `_Rng` so that `uniform_real` takes the next value of `UniformBuffer` and refills it when exhausted.
+	Integers are still drawn from `_Rng` directly.
+	*/
+	template<typename _Rng>
+	class BufferedUniformGen
+	{
+		_Rng& rng;
+		UniformBuffer& buf;
+	public:
+		using result_type = typename _Rng::result_type;
+
+		BufferedUniformGen(_Rng& _rng, UniformBuffer& _buf) : rng{ _rng }, buf{ _buf }
+		{
+		}
+
+		static constexpr result_type min() { return _Rng::min(); }
+		static constexpr result_type max() { return _Rng::max(); }
+
+		result_type operator()()
+		{
+			return rng();
+		}
+
+		float uniform_real()
+		{
+			if (buf.pos >= (size_t)buf.values.size())
+			{
+				buf.values = Eigen::Rand::uniformReal<Eigen::Array<float, -1, 1>>(UniformBuffer::size, 1, rng);
+				buf.pos = 0;
+			}
+			return buf.values[buf.pos++];
+		}
+	};
+
+	/*
+	stale proposal distributions of the Metropolis-Hastings sampler (SamplingMethod::mh)
+	word proposal: q_w(k) = (n_wk + eta) / (n_k + V * eta)
+	doc proposal: q_d(k) = n_dk + alpha_k
+	*/
+	struct MHProposalTable
+	{
+		struct WordProposal
+		{
+			std::vector<Tid> topics; // topics where n_wk > 0 in ascending order
+			std::vector<Float> weights; // n_wk / (n_k + V * eta) of each topic in topics
+			Float mass = 0;
+			sample::AliasMethod<> alias;
+		};
+
+		Vector alphas; // Dim: (Topic, ), alpha_k at the time of building
+		Vector smoothing; // Dim: (Topic, ), eta / (n_k + V * eta)
+		Float alphaMass = 0, smoothingMass = 0;
+		sample::AliasMethod<> alphaAlias, smoothingAlias;
+		std::vector<WordProposal> words; // Dim: (Vocabs, )
+
+		// (n_wk + eta) / (n_k + V * eta) at the time of building
+		Float getWordProposal(Vid vid, Tid k) const
+		{
+			auto& wp = words[vid];
+			auto it = std::lower_bound(wp.topics.begin(), wp.topics.end(), k);
+			Float p = smoothing[k];
+			if (it != wp.topics.end() && *it == k) p += wp.weights[it - wp.topics.begin()];
+			return p;
+		}
+
+		uint64_t getMemoryUsage() const
+		{
+			uint64_t ret = heapBytes(alphas) + heapBytes(smoothing) + alphaAlias.getMemoryUsage() + smoothingAlias.getMemoryUsage() + heapBytes(words);
+			for (auto& wp : words) ret += heapBytes(wp.topics) + heapBytes(wp.weights) + wp.alias.getMemoryUsage();
+			return ret;
+		}
+	};
+
+	/*
+	topic-word counts of the tail vocabularies in the hybrid topic-word storage
+	only non-zero counts of each word are kept as (topic, count) pairs in no particular order.
+	like a view of ShareableMatrix, a copy of a view refers to the same columns,
+	which lets the workers of ParallelScheme::partition update the global counts of their own vocabularies.
+	*/
+	template<typename _WeightType>
+	struct SparseTopicWordCounts
+	{
+		struct Entry
+		{
+			Tid topic;
+			_WeightType count;
+		};
+		using Column = std::vector<Entry>;
+
+		std::vector<Column> ownData;
+		std::vector<Column>* view = nullptr;
+		Vid offset = 0; // vocabulary id of the first column
+
+		void init(Vid _offset, size_t size)
+		{
+			view = nullptr;
+			offset = _offset;
+			ownData.clear();
+			ownData.resize(size);
+		}
+
+		void initView(SparseTopicWordCounts& o)
+		{
+			view = &o.columns();
+			offset = o.offset;
+			ownData.clear();
+		}
+
+		std::vector<Column>& columns() { return view ? *view : ownData; }
+		const std::vector<Column>& columns() const { return view ? *view : ownData; }
+
+		size_t size() const { return columns().size(); }
+
+		Column& col(Vid v) { return columns()[v - offset]; }
+		const Column& col(Vid v) const { return columns()[v - offset]; }
+
+		_WeightType get(Tid k, Vid v) const
+		{
+			for (auto& e : col(v))
+			{
+				if (e.topic == k) return e.count;
+			}
+			return 0;
+		}
+
+		template<bool _dec>
+		void add(Tid k, Vid v, _WeightType inc)
+		{
+			auto& c = col(v);
+			auto it = std::find_if(c.begin(), c.end(), [&](const Entry& e) { return e.topic == k; });
+			if (it == c.end())
+			{
+				if (inc > 0) c.emplace_back(Entry{ k, inc });
+				return;
+			}
+			updateCnt<_dec>(it->count, inc);
+			if (it->count <= 0)
+			{
+				*it = c.back();
+				c.pop_back();
+			}
+		}
+
+		void setZero()
+		{
+			for (auto& c : columns()) c.clear();
+		}
+
+		// writes the counts of word `v` into `out`, which has `k` elements
+		void fillColumn(Vid v, _WeightType* out, size_t k) const
+		{
+			std::fill(out, out + k, 0);
+			for (auto& e : col(v)) out[e.topic] = e.count;
+		}
+	};
+
 	template<TermWeight _tw>
 	struct ModelStateLDA
 	{
 		using WeightType = typename std::conditional<_tw == TermWeight::one, int32_t, float>::type;
 
 		Vector zLikelihood;
+		Vector invTopicDenom; // 1 / (numByTopic + etaSum) of the dense sampler, refreshed per document and kept up to date by addWordTo
+		Vector runLikelihood, runBlockDist; // likelihoods of each topic and prefix sums of the blocks for the run of a vocabulary sampled by `sampleRun`
+		SparseSamplerBuffer sparseBuf;
+		UniformBuffer uniforms;
+		std::vector<int32_t> mhDocCnt; // unweighted topic counts of the document being sampled by SamplingMethod::mh
 		Eigen::Matrix<WeightType, -1, 1> numByTopic; // Dim: (Topic, 1)
+		Eigen::Matrix<WeightType, -1, 1> numByTopicDelta; // changes of numByTopic not pushed yet to the shared counts by ParallelScheme::async
 		//Eigen::Matrix<WeightType, -1, -1> numByTopicWord; // Dim: (Topic, Vocabs)
-		ShareableMatrix<WeightType, -1, -1> numByTopicWord; // Dim: (Topic, Vocabs)
-		DEFINE_SERIALIZER(numByTopic, numByTopicWord);
+		ShareableMatrix<WeightType, -1, -1> numByTopicWord; // Dim: (Topic, Vocabs), or (Topic, head Vocabs) with the hybrid storage
+		SparseTopicWordCounts<WeightType> numByTopicWordTail; // Dim: (Topic, Vocabs - numByTopicWord.cols()), empty without the hybrid storage
+
+		WeightType getTopicWordCount(Tid k, Vid v) const
+		{
+			return v < (size_t)numByTopicWord.cols() ? numByTopicWord(k, v) : numByTopicWordTail.get(k, v);
+		}
+
+		// the bytes this state owns. The counts viewed from another state or a mapped file are not included
+		uint64_t getMemoryUsage() const
+		{
+			return heapBytes(zLikelihood) + heapBytes(invTopicDenom) + heapBytes(runLikelihood) + heapBytes(runBlockDist) + sparseBuf.getMemoryUsage() + heapBytes(uniforms.values)
+				+ heapBytes(mhDocCnt) + heapBytes(numByTopic) + heapBytes(numByTopicDelta)
+				+ heapBytes(numByTopicWord) + heapBytes(numByTopicWordTail.ownData);
+		}
+
+		// the bytes of the topic-word counts, whether owned or viewed
+		uint64_t getTopicWordMemoryUsage() const
+		{
+			uint64_t ret = numByTopicWord.size() * sizeof(WeightType);
+			if (numByTopicWordTail.size()) ret += heapBytes(numByTopicWordTail.columns());
+			return ret;
+		}
+
+		// the bytes of the topic-word counts this state views without owning them
+		uint64_t getViewedMemoryUsage() const
+		{
+			const uint64_t all = getTopicWordMemoryUsage(), owned = heapBytes(numByTopicWord) + heapBytes(numByTopicWordTail.ownData);
+			return all > owned ? all - owned : 0;
+		}
+
+		void serializerRead(std::istream& istr)
+		{
+			serializer::readMany(istr, numByTopic, numByTopicWord);
+			numByTopicWordTail = {};
+		}
+
+		// the hybrid storage is written in the dense layout, so that saved models don't depend on it
+		void serializerWrite(std::ostream& ostr) const
+		{
+			if (!numByTopicWordTail.size()) return serializer::writeMany(ostr, numByTopic, numByTopicWord);
+
+			serializer::writeMany(ostr, numByTopic);
+			const size_t K = numByTopicWord.rows();
+			decltype(numByTopicWord)::serializerWriteHeader(ostr, (uint32_t)K, (uint32_t)(numByTopicWord.cols() + numByTopicWordTail.size()));
+			if (!ostr.write((const char*)numByTopicWord.data(), sizeof(WeightType) * numByTopicWord.size()))
+				throw std::ios_base::failure(std::string("writing type '") + typeid(WeightType).name() + std::string("' is failed"));
+			std::vector<WeightType> col(K);
+			for (size_t i = 0; i < numByTopicWordTail.size(); ++i)
+			{
+				numByTopicWordTail.fillColumn(numByTopicWordTail.offset + i, col.data(), K);
+				if (!ostr.write((const char*)col.data(), sizeof(WeightType) * K))
+					throw std::ios_base::failure(std::string("writing type '") + typeid(WeightType).name() + std::string("' is failed"));
+			}
+		}
 	};
 
 	namespace flags
@@ -98,10 +381,10 @@ namespace tomoto
 	public:
 		EtaHelper(const _Model& p) : _this(p) {}
 
-		auto getEta(size_t vid) const
-			-> decltype(_this.etaByTopicWord.col(vid).array())
+		Eigen::Map<const Eigen::Array<Float, -1, 1>> getEta(size_t vid) const
 		{
-			return _this.etaByTopicWord.col(vid).array();
+			auto col = _this.getWordPriorCol(vid);
+			return Eigen::Map<const Eigen::Array<Float, -1, 1>>{ col.data(), col.size() };
 		}
 
 		auto getEtaSum() const
@@ -152,7 +435,7 @@ namespace tomoto
 	class HDPModel;
 
 	template<TermWeight _tw, typename _RandGen,
-		size_t _Flags = flags::partitioned_multisampling,
+		size_t _Flags = flags::partitioned_multisampling | flags::asynchronous_multisampling | flags::hierarchical_multisampling,
 		typename _Interface = ILDAModel,
 		typename _Derived = void, 
 		typename _DocType = DocumentLDA<_tw>,
@@ -167,6 +450,10 @@ namespace tomoto
 		using DerivedClass = typename std::conditional<std::is_same<_Derived, void>::value, LDAModel, _Derived>::type;
 		using BaseClass = TopicModel<_RandGen, _Flags, _Interface, DerivedClass, _DocType, _ModelState>;
 		friend BaseClass;
+		// whether the model provides ParallelScheme::async, whose code needs the members of ModelStateLDA
+		using AsyncSupported = std::integral_constant<bool, !!(_Flags & flags::asynchronous_multisampling)>;
+		// whether the model provides ParallelScheme::hierarchical, likewise
+		using HierarchicalSupported = std::integral_constant<bool, !!(_Flags & flags::hierarchical_multisampling)>;
 		friend EtaHelper<DerivedClass, true>;
 		friend EtaHelper<DerivedClass, false>;
 
@@ -194,10 +481,130 @@ namespace tomoto
 		Float alpha, eta;
 		Vector alphas;
 		std::unordered_map<std::string, std::vector<Float>> etaByWord;
-		Matrix etaByTopicWord; // (K, V)
+		Matrix etaByTopicWord; // (K, the vocabularies given their own priors), empty if there are none
 		Vector etaSumByTopic; // (K, )
+		Vector etaByTopicDefault; // (K, ) filled with `eta`, the prior of the vocabularies without their own priors
+		std::vector<uint32_t> priorColByWord; // (V, ) the column of each vocabulary in `etaByTopicWord`, or -1 for `etaByTopicDefault`
+		std::vector<Vid> priorWords; // the vocabulary of each column of `etaByTopicWord`
+		bool optimEta = false;
 		uint32_t optimInterval = 10, burnIn = 0;
+		SamplingMethod samplingMethod = SamplingMethod::dense;
+		bool dynamicBalancing = false;
+		DocOrder docOrder = DocOrder::shuffled;
+		std::vector<size_t> sampleOrder; // the order of documents visited by ParallelScheme::partition, empty if shuffled or word major
+
+		/*
+		tokens grouped by vocabulary for DocOrder::word_major.
+		A cell holds the tokens which a worker of ParallelScheme::partition samples in a round,
+		that is, the tokens of its vocabulary block in the documents of a slot, sorted by vocabulary.
+		*/
+		struct WordMajorIndex
+		{
+			std::vector<size_t> cellOffset; // Dim: (Slots * Slots + 1, ), cell `slot * numSlots + block` starts at `cellOffset[slot * numSlots + block]`
+			std::vector<uint32_t> docOf, posOf; // Dim: (Tokens, ), the document and the position in it of each token
+			size_t numSlots = 0, numDocs = 0;
+		};
+		mutable WordMajorIndex wordMajorIndex;
+		size_t asyncStaleness = 16; // the number of documents a worker of ParallelScheme::async samples between syncs of the topic totals
+		size_t asyncRecountInterval = 0; // recount all statistics every this many iterations of ParallelScheme::async, 0 for never
+		size_t hierarchicalGroups = 0; // the number of groups of ParallelScheme::hierarchical, 0 for about the square root of the number of workers
+		bool pipelinedPartition = false; // whether plain LDA runs the rounds of ParallelScheme::partition as a pipeline, see `performSamplingPipelined`
+		size_t partitionRebalanceInterval = 0; // if non-zero, ParallelScheme::partition re-cuts the vocabulary blocks every this many iterations, see `rebalanceVocabChunks`
+		mutable std::vector<double> blockCosts; // Dim: (Workers, ), the seconds spent on each vocabulary block of ParallelScheme::partition since the last rebalancing
+		size_t freezeInterval = 0; // if non-zero, plain LDA resamples stable tokens and documents less often except every this many iterations, see `isTokenSkipped`
+		bool collapseDuplicates = false; // whether `prepare` collapses the documents of plain LDA with the same words, see `collapseDuplicateDocs`
+		std::vector<std::pair<size_t, size_t>> duplicates; // (duplicate, representative) pairs of the documents collapsed by `collapseDuplicateDocs`
+
+		/*
+		the topic-word distributions of another model, from which plain LDA draws the initial topics of its documents, see `setWarmStart`.
+		It is dropped once the documents are initialized by `prepare`, so the model keeps nothing of it but the topics.
+		*/
+		struct WarmStart
+		{
+			Dictionary dict;
+			Eigen::Matrix<Float, -1, -1> phi; // Dim: (Topic, Vocabs of `dict`)
+		};
+		std::shared_ptr<const WarmStart> warmStart; // shared by the copies of the model
+		Eigen::Matrix<Float, -1, -1> warmStartPhi; // Dim: (Topic, Vocabs), `warmStart.phi` aligned to the vocabularies of this model while initializing
+		mutable Eigen::Matrix<WeightType, -1, -1> blockTopicSums; // (K, workers) the topic sums of the vocabulary block of each worker
+		mutable std::vector<Vid> placedVChunkOffset; // the vocabulary blocks which `placeColumnsOnNodes` last placed globalState.numByTopicWord for
+		mutable const void* placedTopicWord = nullptr; // the data of globalState.numByTopicWord at that time
+		mutable bool pipelinedIteration = false; // whether the last sampling was pipelined and `blockTopicSums` holds its sums
+		size_t denseVocabSize = 0; // the number of vocabularies whose topic counts are stored densely, 0 for all
+		bool compact = false;
+		MHProposalTable mhProposal;
 		Eigen::Matrix<WeightType, -1, -1> numByTopicDoc;
+		std::string outOfCoreDir; // if not empty, plain LDA keeps the arrays of its documents in temporary files in this directory
+
+		struct OutOfCoreArrays
+		{
+			MappedArray<Vid> words;
+			MappedArray<Tid> Zs;
+			MappedArray<Float> wordWeights;
+			MappedArray<WeightType> numByTopicDoc;
+
+			OutOfCoreArrays(const std::string& dir)
+				: words{ dir }, Zs{ dir }, wordWeights{ dir }, numByTopicDoc{ dir }
+			{
+			}
+		};
+		PreventCopy<std::unique_ptr<OutOfCoreArrays>> outOfCore; // null if the arrays of the documents are in memory
+
+		/*
+		arrays which plain LDA shares with the models copied from or to it, until each of them modifies its own state.
+		The documents and `globalState.numByTopicWord` of all the sharing models view them, see `shareArrays`.
+		*/
+		struct SharedArrays
+		{
+			std::vector<Vid> words;
+			std::vector<Tid> Zs;
+			std::vector<Float> wordWeights;
+			Eigen::Matrix<WeightType, -1, -1> numByTopicDoc, numByTopicWord;
+
+			uint64_t getMemoryUsage() const
+			{
+				return heapBytes(words) + heapBytes(Zs) + heapBytes(wordWeights) + heapBytes(numByTopicDoc) + heapBytes(numByTopicWord);
+			}
+		};
+		std::shared_ptr<SharedArrays> sharedArrays; // null if the model owns its arrays
+		bool docsOutOfCore = false; // unlike `outOfCore`, it is kept by copies, whose documents still view the files of the original
+		static constexpr size_t prefetchBlockSize = 1024; // the number of documents prefetched at once while sampling out of core
+		size_t newDocSweeps = 0; // the number of sweeps over only the new documents after they are prepared by `prepareNewDocs`
+		size_t numPreparedDocs = -1, numPreparedVocabs = 0; // the numbers of documents and vocabularies at the last `prepare`
+		size_t llSampleDocs = 0; // the number of documents sampled to estimate the log-likelihood, 0 for all documents
+		static constexpr size_t llChunkDocs = 1024, llChunkVocabs = 1024; // the sizes of chunks evaluated in parallel by `getLL`
+		bool incrementalLL = false; // whether `getLL` updates its cached sums only by the changed counts, see `getLLIncremental`
+		mutable Eigen::Matrix<WeightType, -1, -1> llDocCounts, llWordCounts; // the counts at the last `getLLIncremental`
+		mutable Vector llAlphas;
+		mutable Float llEta = 0;
+		mutable double llDocSum = 0, llWordSum = 0;
+
+		/*
+		with `reproducible`, each document is sampled from its own stream of `Philox4x32` keyed by (`rngSeed`, iteration, document id),
+		and ParallelScheme::copy_merge samples `reproducibleChunks` chunks each against the global state and its own changes,
+		which are gathered into `chunkDeltaByTopicWord` and `chunkDeltaByTopic`. So the result doesn't depend on the number of workers.
+		*/
+		bool reproducible = false;
+		size_t rngSeed = 0;
+		static constexpr size_t reproducibleChunks = 64;
+		mutable Eigen::Matrix<WeightType, -1, -1> chunkDeltaByTopicWord;
+		mutable Eigen::Matrix<WeightType, -1, 1> chunkDeltaByTopic;
+
+		// distributed training, see `setDistributedSync`
+		std::vector<std::string> sharedVocabs;
+		TopicWordDeltaExchanger deltaExchanger;
+		Float deltaThreshold = 0;
+		std::vector<uint32_t> sharedVidOf; // Dim: (Vocabs, ), the index into `sharedVocabs` of each vocabulary
+		std::vector<Vid> localVidOf; // Dim: (Shared vocabs, ), the inverse of `sharedVidOf`
+		std::vector<Tid> syncedZs; // the topics of all the words at the last exchange
+		std::unordered_map<uint64_t, WeightType> topicWordResidual; // changes of numByTopicWord not sent yet, keyed by `vid * K + topic`
+		mutable Eigen::Matrix<WeightType, -1, -1, Eigen::RowMajor> topicWordByRow; // row-major copy of globalState.numByTopicWord
+		mutable size_t topicWordByRowStep = -1;
+		bool frozenInference = false; // whether inference samples from `phiByWord` instead of the counts updated by the inferred documents
+		bool foldInEM = false; // whether inference estimates the topic distributions by EM against `phiByWord`, see `inferFoldIn`
+		mutable Eigen::Matrix<Float, -1, -1, Eigen::RowMajor> phiByTopic; // Dim: (Topic, Vocabs), the normalized topic-word distributions of globalState
+		mutable Eigen::Matrix<Float, -1, -1> phiByWord; // Dim: (Topic, Vocabs), column-major copy of phiByTopic for `frozenInference`
+		mutable size_t phiStep = -1, phiByWordStep = -1, proposalStep = -1; // `globalStep` at which each cache was built, see `invalidateCaches`
 		
 		struct ExtraDocData
 		{
@@ -213,771 +620,4797 @@ namespace tomoto
 			auto listExpr = Vector::NullaryExpr(len, list);
 			auto dAlpha = math::digammaT(alpha);
 
-			size_t suggested = (len + 127) / 128;
-			if (pool && suggested > pool->getNumWorkers()) suggested = pool->getNumWorkers();
-			if (suggested <= 1 || !pool)
+			if (!pool || len <= 128 || pool->getNumWorkers() <= 1)
 			{
 				return (math::digammaApprox(listExpr.array() + alpha) - dAlpha).sum();
 			}
 
-			
-			std::vector<std::future<Float>> futures;
-			for (size_t i = 0; i < suggested; ++i)
+			return pool->parallelReduce(0, len, (Float)0, [&](size_t, size_t b, size_t e) -> Float
 			{
-				size_t start = (len * i / suggested + 15) & ~0xF,
-					end = std::min((len * (i + 1) / suggested + 15) & ~0xF, len);
-				futures.emplace_back(pool->enqueue([&, start, end, dAlpha](size_t)
-				{
-					return (math::digammaApprox(listExpr.array().segment(start, end - start) + alpha) - dAlpha).sum();
-				}));
+				return (math::digammaApprox(listExpr.array().segment(b, e - b) + alpha) - dAlpha).sum();
+			}, [](Float a, Float b) { return a + b; }, 128);
+		}
+
+		/*
+		adds 1 to `hist[n]`, that is, the number of documents whose count is `n`.
+		Zero counts are not recorded since they add nothing to the sums of digamma differences.
+		*/
+		template<typename _Cnt>
+		static void addToHistogram(std::vector<_Cnt>& hist, size_t n)
+		{
+			if (!n) return;
+			if (hist.size() <= n) hist.resize(n + 1);
+			++hist[n];
+		}
+
+		/*
+		turns the histogram into the number of documents whose count exceeds each `j`, 
+		so that the sum of `digamma(n + a) - digamma(a) = sum_{j < n} 1 / (a + j)` over the documents is `sum_j exceeding[j] / (a + j)`
+		*/
+		template<typename _Cnt>
+		static void accumulateHistogram(std::vector<_Cnt>& hist)
+		{
+			_Cnt acc = 0;
+			for (size_t j = hist.size(); j-- > 0; )
+			{
+				const _Cnt c = hist[j];
+				hist[j] = acc;
+				acc += c;
 			}
-			Float ret = 0;
-			for (auto& f : futures) ret += f.get();
-			return ret;
+			while (!hist.empty() && !hist.back()) hist.pop_back();
+		}
+
+		template<typename _Cnt>
+		static Float sumOverHistogram(const std::vector<_Cnt>& exceeding, Float alpha)
+		{
+			double ret = 0;
+			for (size_t j = 0; j < exceeding.size(); ++j) ret += exceeding[j] / (alpha + (double)j);
+			return (Float)ret;
 		}
 
 		/*
 			function for optimizing hyperparameters
 		*/
 		void optimizeParameters(ThreadPool& pool, _ModelState* localData, _RandGen* rgs)
+		{
+			_optimizeParameters(&pool, std::integral_constant<bool, _tw == TermWeight::one>{});
+			if (optimEta) optimizeEta(&pool, std::integral_constant<bool, _tw == TermWeight::one>{});
+		}
+
+		// weighted counts are not integers, so the digamma sums are evaluated over all documents at each iteration
+		void _optimizeParameters(ThreadPool* pool, std::false_type)
 		{
 			const auto K = this->K;
 			for (size_t i = 0; i < 10; ++i)
 			{
-				Float denom = calcDigammaSum(&pool, [&](size_t i) { return this->docs[i].getSumWordWeight(); }, this->docs.size(), alphas.sum());
+				Float denom = calcDigammaSum(pool, [&](size_t i) { return this->docs[i].getSumWordWeight(); }, this->docs.size(), alphas.sum());
 				for (size_t k = 0; k < K; ++k)
 				{
-					Float nom = calcDigammaSum(&pool, [&](size_t i) { return this->docs[i].numByTopic[k]; }, this->docs.size(), alphas(k));
+					Float nom = calcDigammaSum(pool, [&](size_t i) { return this->docs[i].numByTopic[k]; }, this->docs.size(), alphas(k));
 					alphas(k) = std::max(nom / denom * alphas(k), 1e-5f);
 				}
 			}
 		}
 
-		template<bool _asymEta>
-		EtaHelper<DerivedClass, _asymEta> getEtaHelper() const
+		/*
+		Minka's histogram method: a single pass over the documents counts them by the length and by the count of each topic,
+		and the fixed-point iterations run over the histograms only, whose sizes don't depend on the number of documents.
+		Each worker counts a range of topics, reading only its part of the topic counts of every document.
+		*/
+		void _optimizeParameters(ThreadPool* pool, std::true_type)
 		{
-			return EtaHelper<DerivedClass, _asymEta>{ *static_cast<const DerivedClass*>(this) };
-		}
+			const size_t K = this->K, numDocs = this->docs.size();
+			std::vector<std::vector<uint32_t>> topicHists(K);
+			std::vector<uint32_t> lenHist;
+			for (size_t i = 0; i < numDocs; ++i) addToHistogram(lenHist, (size_t)this->docs[i].getSumWordWeight());
+			accumulateHistogram(lenHist);
 
-		template<bool _asymEta>
-		Float* getZLikelihoods(_ModelState& ld, const _DocType& doc, size_t docId, size_t vid) const
-		{
-			const size_t V = this->realV;
-			assert(vid < V);
-			auto etaHelper = this->template getEtaHelper<_asymEta>();
-			auto& zLikelihood = ld.zLikelihood;
-			zLikelihood = (doc.numByTopic.array().template cast<Float>() + alphas.array())
-				* (ld.numByTopicWord.col(vid).array().template cast<Float>() + etaHelper.getEta(vid))
-				/ (ld.numByTopic.array().template cast<Float>() + etaHelper.getEtaSum());
-			sample::prefixSum(zLikelihood.data(), K);
-			return &zLikelihood[0];
-		}
+			auto countTopics = [&](size_t b, size_t e)
+			{
+				for (size_t i = 0; i < numDocs; ++i)
+				{
+					auto& nbt = this->docs[i].numByTopic;
+					for (size_t k = b; k < e; ++k) addToHistogram(topicHists[k], (size_t)nbt[k]);
+				}
+				for (size_t k = b; k < e; ++k) accumulateHistogram(topicHists[k]);
+			};
 
-		template<int _inc>
-		inline void addWordTo(_ModelState& ld, _DocType& doc, size_t pid, Vid vid, Tid tid) const
-		{
-			assert(tid < K);
-			assert(vid < this->realV);
-			constexpr bool _dec = _inc < 0 && _tw != TermWeight::one;
-			typename std::conditional<_tw != TermWeight::one, float, int32_t>::type weight
-				= _tw != TermWeight::one ? doc.wordWeights[pid] : 1;
+			const size_t numWorkers = pool ? std::min(pool->getNumWorkers(), K) : 1;
+			if (numWorkers <= 1)
+			{
+				countTopics(0, K);
+			}
+			else
+			{
+				std::vector<std::future<void>> futures;
+				for (size_t w = 0; w < numWorkers; ++w)
+				{
+					futures.emplace_back(pool->enqueue([&, w](size_t)
+					{
+						countTopics(K * w / numWorkers, K * (w + 1) / numWorkers);
+					}));
+				}
+				for (auto& f : futures) f.get();
+			}
 
-			updateCnt<_dec>(doc.numByTopic[tid], _inc * weight);
-			updateCnt<_dec>(ld.numByTopic[tid], _inc * weight);
-			updateCnt<_dec>(ld.numByTopicWord(tid, vid), _inc * weight);
+			for (size_t i = 0; i < 10; ++i)
+			{
+				Float denom = sumOverHistogram(lenHist, alphas.sum());
+				for (size_t k = 0; k < K; ++k)
+				{
+					Float nom = sumOverHistogram(topicHists[k], alphas(k));
+					alphas(k) = std::max(nom / denom * alphas(k), 1e-5f);
+				}
+			}
 		}
 
-		void resetStatistics()
+		// calls `fn(count)` for every non-zero topic count of vocabulary `v` in the global state
+		template<typename _Fn>
+		void forEachTopicWordCount(size_t v, _Fn&& fn) const
 		{
-			this->globalState.numByTopic.setZero();
-			this->globalState.numByTopicWord.setZero();
-			for (auto& doc : this->docs)
+			auto& gs = this->globalState;
+			if (v < (size_t)gs.numByTopicWord.cols())
 			{
-				doc.numByTopic.setZero();
-				for (size_t w = 0; w < doc.words.size(); ++w)
+				for (Tid k = 0; k < K; ++k)
 				{
-					if (doc.words[w] >= this->realV) continue;
-					addWordTo<1>(this->globalState, doc, w, doc.words[w], doc.Zs[w]);
+					if (gs.numByTopicWord(k, v)) fn(gs.numByTopicWord(k, v));
 				}
 			}
+			else
+			{
+				for (auto& e : gs.numByTopicWordTail.col(v)) if (e.count) fn(e.count);
+			}
 		}
 
 		/*
-		called once before sampleDocument
+		Minka's fixed-point iteration of the symmetric `eta` shared by the V' vocabularies without their own priors:
+		eta <- eta * sum_{k,v} (digamma(n_kv + eta) - digamma(eta)) / (V' * sum_k (digamma(n_k + etaSum_k) - digamma(etaSum_k)))
 		*/
-		void presampleDocument(_DocType& doc, size_t docId, _ModelState& ld, _RandGen& rgs, size_t iterationCnt) const
+		template<typename _NomFn>
+		void iterateEta(_NomFn&& nomFn)
 		{
+			const size_t symV = this->realV - priorWords.size();
+			if (!symV) return;
+			Vector priorSums = Vector::Zero(K);
+			if (etaByTopicWord.size()) priorSums = etaByTopicWord.rowwise().sum();
+			for (size_t i = 0; i < 10; ++i)
+			{
+				double denom = 0;
+				for (Tid k = 0; k < K; ++k)
+				{
+					const Float etaSum = eta * symV + priorSums[k];
+					denom += math::digammaSubt(etaSum, (Float)this->globalState.numByTopic[k]);
+				}
+				denom *= symV;
+				if (denom <= 0) break;
+				eta = std::max((Float)(nomFn(eta) / denom * eta), 1e-5f);
+			}
+			updateEtaSums(K);
 		}
 
 		/*
-		main sampling procedure (can be called one or more by ParallelScheme)
+		The integer counts are reduced once, in parallel over ranges of vocabularies, into a histogram of the small counts and a list of the large ones,
+		so that the iterations cost only the size of the histogram and the number of large counts.
 		*/
-		template<ParallelScheme _ps, bool _infer, typename _ExtraDocData>
-		void sampleDocument(_DocType& doc, const _ExtraDocData& edd, size_t docId, _ModelState& ld, _RandGen& rgs, size_t iterationCnt, size_t partitionId = 0) const
+		void optimizeEta(ThreadPool* pool, std::true_type)
 		{
-			size_t b = 0, e = doc.words.size();
-			if (_ps == ParallelScheme::partition)
-			{
-				b = edd.chunkOffsetByDoc(partitionId, docId);
-				e = edd.chunkOffsetByDoc(partitionId + 1, docId);
-			}
-
-			for (size_t w = b; w < e; ++w)
+			static constexpr size_t histogramLimit = 4096;
+			const size_t V = this->realV;
+			const size_t numWorkers = pool ? std::max(std::min(pool->getNumWorkers(), V), (size_t)1) : 1;
+			std::vector<std::vector<uint64_t>> hists(numWorkers);
+			std::vector<std::vector<WeightType>> larges(numWorkers);
+			auto countWords = [&](size_t w)
 			{
-				if (doc.words[w] >= this->realV) continue;
-				static_cast<const DerivedClass*>(this)->template addWordTo<-1>(ld, doc, w, doc.words[w], doc.Zs[w]);
-				Float* dist;
-				if (etaByTopicWord.size())
+				for (size_t v = V * w / numWorkers; v < V * (w + 1) / numWorkers; ++v)
 				{
-					dist = static_cast<const DerivedClass*>(this)->template
-						getZLikelihoods<true>(ld, doc, docId, doc.words[w]);
+					if (hasOwnPrior(v)) continue;
+					forEachTopicWordCount(v, [&](WeightType n)
+					{
+						if ((size_t)n < histogramLimit) addToHistogram(hists[w], (size_t)n);
+						else larges[w].emplace_back(n);
+					});
 				}
-				else
+			};
+			if (numWorkers <= 1) countWords(0);
+			else
+			{
+				std::vector<std::future<void>> futures;
+				for (size_t w = 0; w < numWorkers; ++w)
 				{
-					dist = static_cast<const DerivedClass*>(this)->template
-						getZLikelihoods<false>(ld, doc, docId, doc.words[w]);
+					futures.emplace_back(pool->enqueue([&, w](size_t) { countWords(w); }));
 				}
-				doc.Zs[w] = sample::sampleFromDiscreteAcc(dist, dist + K, rgs);
-				static_cast<const DerivedClass*>(this)->template addWordTo<1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+				for (auto& f : futures) f.get();
 			}
-		}
 
-		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
-		void performSampling(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
-			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd) const
-		{
-			// single-threaded sampling
-			if (_ps == ParallelScheme::none)
+			auto& hist = hists[0];
+			auto& large = larges[0];
+			for (size_t w = 1; w < numWorkers; ++w)
 			{
-				forShuffled((size_t)std::distance(docFirst, docLast), rgs[0](), [&](size_t id)
-				{
-					static_cast<const DerivedClass*>(this)->presampleDocument(docFirst[id], id, *localData, *rgs, this->globalStep);
-					static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
-						docFirst[id], edd, id,
-						*localData, *rgs, this->globalStep, 0);
-
-				});
+				if (hist.size() < hists[w].size()) hist.resize(hists[w].size());
+				for (size_t j = 0; j < hists[w].size(); ++j) hist[j] += hists[w][j];
+				large.insert(large.end(), larges[w].begin(), larges[w].end());
 			}
-			// multi-threaded sampling on partition and update into global
-			else if (_ps == ParallelScheme::partition)
+			accumulateHistogram(hist);
+
+			iterateEta([&](Float eta)
 			{
-				const size_t chStride = pool.getNumWorkers();
-				for (size_t i = 0; i < chStride; ++i)
-				{
-					res = pool.enqueueToAll([&, i, chStride](size_t partitionId)
-					{
-						size_t didx = (i + partitionId) % chStride;
-						forShuffled(((size_t)std::distance(docFirst, docLast) + (chStride - 1) - didx) / chStride, rgs[partitionId](), [&](size_t id)
-						{
-							if (i == 0)
-							{
-								static_cast<const DerivedClass*>(this)->presampleDocument(
-									docFirst[id * chStride + didx], id * chStride + didx,
-									localData[partitionId], rgs[partitionId], this->globalStep
-								);
-							}
-							static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
-								docFirst[id * chStride + didx], edd, id * chStride + didx,
-								localData[partitionId], rgs[partitionId], this->globalStep, partitionId
-							);
-						});
-					});
-					for (auto& r : res) r.get();
-					res.clear();
-				}
-			}
-			// multi-threaded sampling on copy and merge into global
-			else if(_ps == ParallelScheme::copy_merge)
+				double nom = sumOverHistogram(hist, eta);
+				for (auto n : large) nom += math::digammaSubt(eta, (Float)n);
+				return nom;
+			});
+		}
+
+		// weighted counts are not integers, so each iteration sums over the non-zero counts in parallel
+		void optimizeEta(ThreadPool* pool, std::false_type)
+		{
+			const size_t V = this->realV;
+			iterateEta([&](Float eta)
 			{
-				const size_t chStride = std::min(pool.getNumWorkers() * 8, (size_t)std::distance(docFirst, docLast));
-				for (size_t ch = 0; ch < chStride; ++ch)
+				return sumChunks(pool, V, llChunkVocabs, [&](size_t b, size_t e)
 				{
-					res.emplace_back(pool.enqueue([&, ch, chStride](size_t threadId)
+					double nom = 0;
+					for (size_t v = b; v < e; ++v)
 					{
-						forShuffled(((size_t)std::distance(docFirst, docLast) + (chStride - 1) - ch) / chStride, rgs[threadId](), [&](size_t id)
-						{
-							static_cast<const DerivedClass*>(this)->presampleDocument(
-								docFirst[id * chStride + ch], id * chStride + ch, 
-								localData[threadId], rgs[threadId], this->globalStep
-							);
-							static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
-								docFirst[id * chStride + ch], edd, id * chStride + ch,
-								localData[threadId], rgs[threadId], this->globalStep, 0
-							);
-						});
-					}));
-				}
-				for (auto& r : res) r.get();
-				res.clear();
-			}
-			else
-			{
-				throw std::runtime_error{ "Unsupported ParallelScheme" };
-			}
+						if (hasOwnPrior(v)) continue;
+						forEachTopicWordCount(v, [&](WeightType n) { nom += math::digammaSubt(eta, (Float)n); });
+					}
+					return nom;
+				});
+			});
 		}
 
-		template<ParallelScheme _ps, bool _infer, typename _DocIter>
-		void performSamplingGlobal(ThreadPool* pool, _ModelState& globalState, _RandGen* rgs, 
-			_DocIter docFirst, _DocIter docLast) const
+		template<bool _asymEta>
+		EtaHelper<DerivedClass, _asymEta> getEtaHelper() const
 		{
+			return EtaHelper<DerivedClass, _asymEta>{ *static_cast<const DerivedClass*>(this) };
 		}
 
-		template<typename _DocIter, typename _ExtraDocData>
-		void updatePartition(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, _DocIter first, _DocIter last, _ExtraDocData& edd) const
+		// the topic prior of vocabulary `vid`, which is `etaByTopicDefault` unless the vocabulary has its own prior
+		Eigen::Map<const Vector> getWordPriorCol(size_t vid) const
 		{
-			size_t numPools = pool.getNumWorkers();
-			if (edd.vChunkOffset.size() != numPools)
-			{
-				edd.vChunkOffset.clear();
-				size_t totCnt = std::accumulate(this->vocabCf.begin(), this->vocabCf.begin() + this->realV, 0);
-				size_t cumCnt = 0;
-				for (size_t i = 0; i < this->realV; ++i)
-				{
-					cumCnt += this->vocabCf[i];
-					if (cumCnt * numPools >= totCnt * (edd.vChunkOffset.size() + 1)) edd.vChunkOffset.emplace_back(i + 1);
-				}
-
-				edd.chunkOffsetByDoc.resize(numPools + 1, std::distance(first, last));
-				size_t i = 0;
-				for (; first != last; ++first, ++i)
-				{
-					auto& doc = *first;
-					edd.chunkOffsetByDoc(0, i) = 0;
-					size_t g = 0;
-					for (size_t j = 0; j < doc.words.size(); ++j)
-					{
-						for (; g < numPools && doc.words[j] >= edd.vChunkOffset[g]; ++g)
-						{
-							edd.chunkOffsetByDoc(g + 1, i) = j;
-						}
-					}
-					for (; g < numPools; ++g)
-					{
-						edd.chunkOffsetByDoc(g + 1, i) = doc.words.size();
-					}
-				}
-			}
-			static_cast<const DerivedClass*>(this)->distributePartition(pool, globalState, localData, edd);
+			const uint32_t c = vid < priorColByWord.size() ? priorColByWord[vid] : (uint32_t)-1;
+			return Eigen::Map<const Vector>{ c == (uint32_t)-1 ? etaByTopicDefault.data() : etaByTopicWord.col(c).data(), 
+				etaByTopicWord.rows() };
 		}
 
-		template<typename _ExtraDocData>
-		void distributePartition(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, const _ExtraDocData& edd) const
+		bool hasOwnPrior(size_t vid) const
 		{
-			std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t partitionId)
-			{
-				size_t b = partitionId ? edd.vChunkOffset[partitionId - 1] : 0,
-					e = edd.vChunkOffset[partitionId];
+			return vid < priorColByWord.size() && priorColByWord[vid] != (uint32_t)-1;
+		}
 
-				//localData[partitionId].numByTopicWord.matrix() = globalState.numByTopicWord.block(0, b, globalState.numByTopicWord.rows(), e - b);
-				localData[partitionId].numByTopicWord.init((WeightType*)globalState.numByTopicWord.data(), globalState.numByTopicWord.rows(), globalState.numByTopicWord.cols());
-				localData[partitionId].numByTopic = globalState.numByTopic;
-				if (!localData[partitionId].zLikelihood.size()) localData[partitionId].zLikelihood = globalState.zLikelihood;
-			});
-			
-			for (auto& r : res) r.get();
+		Float getTopicEtaSum(Tid k) const
+		{
+			return etaByTopicWord.size() ? etaSumByTopic[k] : eta * this->realV;
 		}
 
-		template<ParallelScheme _ps>
-		size_t estimateMaxThreads() const
+		template<bool _asymEta>
+		Float* getZLikelihoods(_ModelState& ld, const _DocType& doc, size_t docId, size_t vid) const
 		{
-			if (_ps == ParallelScheme::partition)
+			const size_t V = this->realV;
+			assert(vid < V);
+			auto etaHelper = this->template getEtaHelper<_asymEta>();
+			auto& zLikelihood = ld.zLikelihood;
+			if (!_asymEta && vid >= (size_t)ld.numByTopicWord.cols())
 			{
-				return (this->realV + 3) / 4;
+				// a tail vocabulary of the hybrid storage, which has only a few non-zero counts
+				zLikelihood = (doc.numByTopic.array().template cast<Float>() + alphas.array())
+					* eta / (ld.numByTopic.array().template cast<Float>() + eta * V);
+				for (auto& e : ld.numByTopicWordTail.col(vid)) zLikelihood[e.topic] *= 1 + e.count / eta;
 			}
-			if (_ps == ParallelScheme::copy_merge)
+			else if (!_asymEta && ld.invTopicDenom.size())
 			{
-				return (this->docs.size() + 1) / 2;
+				sample::prefixSumOfProducts(zLikelihood.data(), doc.numByTopic.data(), alphas.data(),
+					ld.numByTopicWord.col(vid).data(), eta, ld.invTopicDenom.data(), K);
+				return &zLikelihood[0];
 			}
-			return (size_t)-1;
+			else
+			{
+				zLikelihood = (doc.numByTopic.array().template cast<Float>() + alphas.array())
+					* (ld.numByTopicWord.col(vid).array().template cast<Float>() + etaHelper.getEta(vid))
+					/ (ld.numByTopic.array().template cast<Float>() + etaHelper.getEtaSum());
+			}
+			sample::prefixSum(zLikelihood.data(), K);
+			return &zLikelihood[0];
 		}
 
-		template<ParallelScheme _ps>
-		void trainOne(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, bool freeze_topics = false)
+		void refreshInvTopicDenom(_ModelState& ld) const
 		{
-			std::vector<std::future<void>> res;
-			try
-			{
-				static_cast<DerivedClass*>(this)->template performSampling<_ps, false>(pool, localData, rgs, res,
-					this->docs.begin(), this->docs.end(), eddTrain
-				);
-				static_cast<DerivedClass*>(this)->updateGlobalInfo(pool, localData);
-				static_cast<DerivedClass*>(this)->template mergeState<_ps>(pool, this->globalState, this->tState, localData, rgs, eddTrain);
-				static_cast<DerivedClass*>(this)->template performSamplingGlobal<_ps, false>(&pool, this->globalState, rgs, 
-					this->docs.begin(), this->docs.end()
-				);
-				
-				if(freeze_topics) static_cast<DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::freeze_topics>(
-					&pool, &this->globalState, rgs, this->docs.begin(), this->docs.end()
-				);
-				else static_cast<DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::train>(
-					&pool, &this->globalState, rgs, this->docs.begin(), this->docs.end()
-				);
+			if (etaByTopicWord.size()) ld.invTopicDenom = (ld.numByTopic.array().template cast<Float>() + etaSumByTopic.array()).inverse();
+			else ld.invTopicDenom = (ld.numByTopic.array().template cast<Float>() + eta * this->realV).inverse();
+		}
 
-				static_cast<DerivedClass*>(this)->template distributeMergedState<_ps>(pool, this->globalState, localData);
-				
-				if (this->globalStep >= this->burnIn && optimInterval && (this->globalStep + 1) % optimInterval == 0)
-				{
-					static_cast<DerivedClass*>(this)->optimizeParameters(pool, localData, rgs);
-				}
-			}
-			catch (const exc::TrainingError&)
-			{
-				for (auto& r : res) if(r.valid()) r.get();
-				throw;
-			}
+		template<int _inc>
+		inline void addWordTo(_ModelState& ld, _DocType& doc, size_t pid, Vid vid, Tid tid) const
+		{
+			assert(tid < K);
+			assert(vid < this->realV);
+			constexpr bool _dec = _inc < 0 && _tw != TermWeight::one;
+			using Weight = typename std::conditional<_tw != TermWeight::one, float, int32_t>::type;
+			const Weight weight = getWordWeight(doc, pid), globalWeight = weight * (Weight)doc.multiplicity;
+
+			updateCnt<_dec>(doc.numByTopic[tid], _inc * weight);
+			updateCnt<_dec>(ld.numByTopic[tid], _inc * globalWeight);
+			if (ld.invTopicDenom.size()) ld.invTopicDenom[tid] = 1 / (ld.numByTopic[tid] + getTopicEtaSum(tid));
+			if (vid < (size_t)ld.numByTopicWord.cols()) updateCnt<_dec>(ld.numByTopicWord(tid, vid), _inc * globalWeight);
+			else ld.numByTopicWordTail.template add<_dec>(tid, vid, _inc * globalWeight);
 		}
 
 		/*
-		updates global informations after sampling documents
-		ex) update new global K at HDP model
+		same as addWordTo, but for ParallelScheme::async where `ld.numByTopicWord` is shared by all workers.
+		Changes of the topic totals are kept in `ld.numByTopicDelta` until `syncSharedTopicCounts`.
 		*/
-		void updateGlobalInfo(ThreadPool& pool, _ModelState* localData)
+		template<int _inc>
+		inline void addWordToShared(_ModelState& ld, _DocType& doc, size_t pid, Vid vid, Tid tid) const
 		{
+			constexpr bool _dec = _inc < 0 && _tw != TermWeight::one;
+			using Weight = typename std::conditional<_tw != TermWeight::one, float, int32_t>::type;
+			const Weight weight = getWordWeight(doc, pid), globalWeight = weight * (Weight)doc.multiplicity;
+
+			updateCnt<_dec>(doc.numByTopic[tid], _inc * weight);
+			updateCnt<_dec>(ld.numByTopic[tid], _inc * globalWeight);
+			ld.numByTopicDelta[tid] += _inc * globalWeight;
+			if (ld.invTopicDenom.size()) ld.invTopicDenom[tid] = 1 / (ld.numByTopic[tid] + getTopicEtaSum(tid));
+			atomicUpdateCnt<_dec>(ld.numByTopicWord(tid, vid), _inc * globalWeight);
 		}
 
 		/*
-		merges multithreaded document sampling result
+		pushes the changes of the topic totals made by a worker of ParallelScheme::async
+		and pulls the totals made by the others, which bounds the staleness of `ld.numByTopic`
 		*/
-		template<ParallelScheme _ps, typename _ExtraDocData>
-		void mergeState(ThreadPool& pool, _ModelState& globalState, _ModelState& tState, _ModelState* localData, _RandGen*, const _ExtraDocData& edd) const
+		void syncSharedTopicCounts(_ModelState& ld) const
 		{
-			if (_ps == ParallelScheme::copy_merge)
-			{
-				tState = globalState;
-				globalState = localData[0];
-				for (size_t i = 1; i < pool.getNumWorkers(); ++i)
-				{
-					globalState.numByTopicWord += localData[i].numByTopicWord - tState.numByTopicWord;
-				}
-
-				// make all count being positive
-				if (_tw != TermWeight::one)
-				{
-					globalState.numByTopicWord.matrix() = globalState.numByTopicWord.cwiseMax(0);
-				}
-				globalState.numByTopic = globalState.numByTopicWord.rowwise().sum();
-			}
-			else if (_ps == ParallelScheme::partition)
+			auto& shared = as_mutable(this)->globalState.numByTopic;
+			for (Tid k = 0; k < K; ++k)
 			{
-				// make all count being positive
-				if (_tw != TermWeight::one)
-				{
-					globalState.numByTopicWord.matrix() = globalState.numByTopicWord.cwiseMax(0);
-				}
-				globalState.numByTopic = globalState.numByTopicWord.rowwise().sum();
+				if (ld.numByTopicDelta[k]) atomicUpdateCnt<_tw != TermWeight::one>(shared[k], ld.numByTopicDelta[k]);
+				ld.numByTopic[k] = atomicLoad(shared[k]);
 			}
+			ld.numByTopicDelta.setZero();
 		}
 
-		template<ParallelScheme _ps>
-		void distributeMergedState(ThreadPool& pool, _ModelState& globalState, _ModelState* localData) const
+		// corrects the drift of the counts shared by ParallelScheme::async
+		void recountSharedStatistics(std::true_type) const
 		{
-			std::vector<std::future<void>> res;
-			if (_ps == ParallelScheme::copy_merge)
-			{
-				for (size_t i = 0; i < pool.getNumWorkers(); ++i)
-				{
-					res.emplace_back(pool.enqueue([&, i](size_t)
-					{
-						localData[i] = globalState;
-					}));
-				}
-			}
-			else if (_ps == ParallelScheme::partition)
-			{
-				res = pool.enqueueToAll([&](size_t threadId)
-				{
-					localData[threadId].numByTopic = globalState.numByTopic;
-				});
-			}
-			for (auto& r : res) r.get();
+			as_mutable(this)->resetStatistics();
 		}
 
-		/*
-		performs sampling which needs global state modification
-		ex) document pathing at hLDA model
-		* if pool is nullptr, workers has been already pooled and cannot branch works more.
-		*/
-		template<GlobalSampler _gs, typename _DocIter>
-		void sampleGlobalLevel(ThreadPool* pool, _ModelState* localData, _RandGen* rgs, _DocIter first, _DocIter last) const
+		void recountSharedStatistics(std::false_type) const
 		{
 		}
 
-		template<typename _DocIter>
-		double getLLDocs(_DocIter _first, _DocIter _last) const
+		void resetStatistics()
 		{
-			double ll = 0;
-			// doc-topic distribution
-			for (; _first != _last; ++_first)
+			this->globalState.numByTopic.setZero();
+			this->globalState.numByTopicWord.setZero();
+			this->globalState.numByTopicWordTail.setZero();
+			for (auto& doc : this->docs)
 			{
-				auto& doc = *_first;
-				ll -= math::lgammaT(doc.getSumWordWeight() + alphas.sum()) - math::lgammaT(alphas.sum());
-				for (Tid k = 0; k < K; ++k)
+				doc.numByTopic.setZero();
+				for (size_t w = 0; w < doc.words.size(); ++w)
 				{
-					ll += math::lgammaT(doc.numByTopic[k] + alphas[k]) - math::lgammaT(alphas[k]);
+					if (doc.words[w] >= this->realV) continue;
+					addWordTo<1>(this->globalState, doc, w, doc.words[w], doc.Zs[w]);
 				}
 			}
-			return ll;
 		}
 
-		double getLLRest(const _ModelState& ld) const
+		/*
+		same as `resetStatistics`, but the documents are counted by the prepare workers, which update the topic-word counts atomically.
+		The counts of the hybrid storage, whose tail can't be updated atomically, are rebuilt on one thread.
+		*/
+		void resetStatisticsParallel()
 		{
-			double ll = 0;
-			const size_t V = this->realV;
-			// topic-word distribution
-			if (etaByTopicWord.size())
+			const size_t numThreads = this->getNumPrepareThreads(this->docs.size());
+			if (numThreads <= 1 || this->globalState.numByTopicWordTail.size()) return resetStatistics();
+
+			using Weight = typename _ModelState::WeightType;
+			auto& gs = this->globalState;
+			gs.numByTopicWord.setZero();
+			std::vector<Eigen::Matrix<Weight, -1, 1>> localByTopic(numThreads, Eigen::Matrix<Weight, -1, 1>::Zero(K));
+			this->forEachPrepareChunk(numThreads, this->docs.size(), [&](size_t t, size_t, size_t b, size_t e)
 			{
-				for (Tid k = 0; k < K; ++k)
+				for (size_t i = b; i < e; ++i)
 				{
-					Float etasum = etaByTopicWord.row(k).sum();
-					ll += math::lgammaT(etasum) - math::lgammaT(ld.numByTopic[k] + etasum);
-					for (Vid v = 0; v < V; ++v)
+					auto& doc = this->docs[i];
+					doc.numByTopic.setZero();
+					for (size_t w = 0; w < doc.words.size(); ++w)
 					{
-						if (!ld.numByTopicWord(k, v)) continue;
-						ll += math::lgammaT(ld.numByTopicWord(k, v) + etaByTopicWord(k, v)) - math::lgammaT(etaByTopicWord(k, v));
-						assert(std::isfinite(ll));
+						const Vid vid = doc.words[w];
+						if (vid >= this->realV) continue;
+						const Tid z = doc.Zs[w];
+						const Weight weight = getWordWeight(doc, w), globalWeight = weight * (Weight)doc.multiplicity;
+						doc.numByTopic[z] += weight;
+						localByTopic[t][z] += globalWeight;
+						atomicUpdateCnt<false>(gs.numByTopicWord(z, vid), globalWeight);
 					}
 				}
+			});
+			gs.numByTopic.setZero();
+			for (auto& l : localByTopic) gs.numByTopic += l;
+			if (gs.invTopicDenom.size()) refreshInvTopicDenom(gs);
+		}
+
+		/*
+		collapses the documents with the same words, which templated or boilerplate texts repeat, into the first of them.
+		The representative counts once for each of its duplicates in the global counts by its `multiplicity`, so it is sampled for all of them,
+		and the duplicates, whose multiplicity is 0, are skipped by the sampling.
+		They keep copies of the topics of their representative, updated by `syncDuplicates`, so queries and saved models see every document.
+		Documents whose words only hash equally are left uncollapsed.
+		*/
+		void collapseDuplicateDocs()
+		{
+			duplicates.clear();
+			std::unordered_map<uint64_t, size_t> firstByHash;
+			for (size_t i = 0; i < this->docs.size(); ++i)
+			{
+				auto& doc = this->docs[i];
+				doc.multiplicity = 1;
+				if (doc.words.empty()) continue;
+				uint64_t h = 14695981039346656037ull;
+				for (auto w : doc.words) h = (h ^ w) * 1099511628211ull;
+				const size_t first = firstByHash.emplace(h, i).first->second;
+				if (first == i) continue;
+				auto& rep = this->docs[first];
+				if (rep.weight != doc.weight || rep.words.size() != doc.words.size()
+					|| !std::equal(doc.words.begin(), doc.words.end(), rep.words.begin())) continue;
+				++rep.multiplicity;
+				doc.multiplicity = 0;
+				duplicates.emplace_back(i, first);
 			}
-			else
+			if (duplicates.empty()) return;
+			for (auto& p : duplicates)
 			{
-				auto lgammaEta = math::lgammaT(eta);
-				ll += math::lgammaT(V * eta) * K;
-				for (Tid k = 0; k < K; ++k)
-				{
-					ll -= math::lgammaT(ld.numByTopic[k] + V * eta);
-					for (Vid v = 0; v < V; ++v)
-					{
-						if (!ld.numByTopicWord(k, v)) continue;
-						ll += math::lgammaT(ld.numByTopicWord(k, v) + eta) - lgammaEta;
-						assert(std::isfinite(ll));
-					}
-				}
+				auto& doc = this->docs[p.first];
+				std::copy(this->docs[p.second].Zs.begin(), this->docs[p.second].Zs.end(), doc.Zs.begin());
 			}
-			return ll;
+			resetStatistics();
 		}
 
-		double getLL() const
+		// copies the topics of the representatives into their collapsed duplicates
+		void syncDuplicates()
 		{
-			return static_cast<const DerivedClass*>(this)->getLLDocs(this->docs.begin(), this->docs.end())
-				+ static_cast<const DerivedClass*>(this)->getLLRest(this->globalState);
+			for (auto& p : duplicates)
+			{
+				auto& doc = this->docs[p.first];
+				auto& rep = this->docs[p.second];
+				std::copy(rep.Zs.begin(), rep.Zs.end(), doc.Zs.begin());
+				std::copy(rep.numByTopic.data(), rep.numByTopic.data() + K, doc.numByTopic.data());
+			}
 		}
 
-		void prepareShared()
+		/*
+		With `freezeInterval`, a token whose topic was kept in its last `stability` samplings is resampled with probability 2^-min(stability / 4, 2),
+		and a document whose tokens all kept their topics is visited once every 2^min(stability / 4, 2) iterations, staggered by its id.
+		Every `freezeInterval`-th iteration is a full sweep, which still updates the counters.
+		*/
+		template<typename _Rng>
+		static bool isTokenSkipped(uint8_t stability, _Rng& rgs)
 		{
-			auto txZs = [](_DocType& doc) { return &doc.Zs; };
-			tvector<Tid>::trade(sharedZs, 
-				makeTransformIter(this->docs.begin(), txZs),
-				makeTransformIter(this->docs.end(), txZs));
-			if (_tw != TermWeight::one)
+			if (stability < 4) return false;
+			return rgs.uniform_real() * ((size_t)1 << std::min(stability / 4, 2)) >= 1;
+		}
+
+		static bool isDocSkipped(uint8_t stability, size_t iterationCnt, size_t docId)
+		{
+			const size_t period = (size_t)1 << std::min(stability / 4, 2);
+			return ((iterationCnt + docId) & (period - 1)) != 0;
+		}
+
+		// returns whether the topic of the token changed
+		static bool trackToken(uint8_t& stability, Tid oldZ, Tid newZ)
+		{
+			stability = oldZ == newZ ? std::min(stability + 1, 15) : 0;
+			return oldZ != newZ;
+		}
+
+		// a document counts as stable only when all of its tokens were sampled at once, so ranges of ParallelScheme::partition don't update it
+		static void trackDocument(_DocType& doc, size_t b, size_t e, bool changed)
+		{
+			if (b != 0 || e != doc.words.size()) return;
+			doc.docStability = changed ? 0 : std::min(doc.docStability + 1, 15);
+		}
+
+		/*
+		sizes the counters of `freezeInterval` for the documents of plain LDA, or drops them if it is disabled.
+		The documents of inference never have them, so they are always sampled fully.
+		*/
+		void prepareStability()
+		{
+			if (!std::is_same<_Derived, void>::value) return;
+			for (auto& doc : this->docs)
+			{
+				if (freezeInterval && doc.tokenStability.size() != doc.words.size())
+				{
+					doc.tokenStability.resize(doc.words.size());
+				}
+				else if (!freezeInterval && !doc.tokenStability.empty())
+				{
+					doc.tokenStability = {};
+					doc.docStability = 0;
+				}
+			}
+		}
+
+		/*
+		called once before sampleDocument
+		*/
+		void presampleDocument(_DocType& doc, size_t docId, _ModelState& ld, _RandGen& rgs, size_t iterationCnt) const
+		{
+		}
+
+		/*
+		main sampling procedure (can be called one or more by ParallelScheme)
+		*/
+		template<ParallelScheme _ps, bool _infer, typename _ExtraDocData>
+		void sampleDocument(_DocType& doc, const _ExtraDocData& edd, size_t docId, _ModelState& ld, _RandGen& rgs, size_t iterationCnt, size_t partitionId = 0) const
+		{
+			size_t b = 0, e = doc.words.size();
+			if (_ps == ParallelScheme::partition || _ps == ParallelScheme::hierarchical)
+			{
+				b = edd.chunkOffsetByDoc(partitionId, docId);
+				e = edd.chunkOffsetByDoc(partitionId + 1, docId);
+			}
+
+			// the representative samples the tokens of its collapsed duplicates
+			if (!doc.multiplicity) return;
+			if (!_infer && _ps != ParallelScheme::partition && _ps != ParallelScheme::hierarchical
+				&& !doc.tokenStability.empty() && iterationCnt % freezeInterval
+				&& isDocSkipped(doc.docStability, iterationCnt, docId)) return;
+
+			BufferedUniformGen<_RandGen> bufRgs{ rgs, ld.uniforms };
+			if (_infer && frozenInference && !etaByTopicWord.size())
+			{
+				return sampleTokensFrozen(doc, ld, bufRgs, b, e);
+			}
+
+			if (_ps == ParallelScheme::async)
+			{
+				return sampleTokensShared(doc, docId, ld, rgs, iterationCnt, b, e, AsyncSupported{});
+			}
+
+			if (!_infer && reproducible)
+			{
+				Philox4x32 docRgs{ rngSeed, docId, (uint32_t)iterationCnt };
+				return static_cast<const DerivedClass*>(this)->sampleTokens(doc, docId, ld, docRgs, iterationCnt, b, e);
+			}
+			return static_cast<const DerivedClass*>(this)->sampleTokens(doc, docId, ld, bufRgs, iterationCnt, b, e);
+		}
+
+		template<typename _Rng>
+		void sampleTokens(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e) const
+		{
+			if (samplingMethod == SamplingMethod::sparse && !etaByTopicWord.size())
+			{
+				return static_cast<const DerivedClass*>(this)->sampleTokensSparse(doc, docId, ld, rgs, iterationCnt, b, e);
+			}
+
+			if (samplingMethod == SamplingMethod::mh && !etaByTopicWord.size())
+			{
+				return static_cast<const DerivedClass*>(this)->sampleTokensMH(doc, docId, ld, rgs, iterationCnt, b, e);
+			}
+
+			if (!etaByTopicWord.size() || std::is_same<_Derived, void>::value) refreshInvTopicDenom(ld);
+			return sampleTokensFixedK(doc, docId, ld, rgs, iterationCnt, b, e, std::is_same<_Derived, void>{});
+		}
+
+		// dispatches K of plain LDA to the kernels specialized for the common sizes
+		template<typename _Rng>
+		void sampleTokensFixedK(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e, std::true_type) const
+		{
+			switch (K)
+			{
+			case 8: return sampleTokensDense<8>(doc, docId, ld, rgs, iterationCnt, b, e);
+			case 16: return sampleTokensDense<16>(doc, docId, ld, rgs, iterationCnt, b, e);
+			case 32: return sampleTokensDense<32>(doc, docId, ld, rgs, iterationCnt, b, e);
+			case 64: return sampleTokensDense<64>(doc, docId, ld, rgs, iterationCnt, b, e);
+			}
+			return sampleTokensDense<0>(doc, docId, ld, rgs, iterationCnt, b, e);
+		}
+
+		template<typename _Rng>
+		void sampleTokensFixedK(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e, std::false_type) const
+		{
+			return sampleTokensDense<0>(doc, docId, ld, rgs, iterationCnt, b, e);
+		}
+
+		/*
+		dense sampling procedure, where plain LDA with `_fixedK` equal to K evaluates the likelihoods of the symmetric fast path
+		into a buffer on the stack with loops of a constant length, which the compiler unrolls. `_fixedK` is 0 for the other values of K.
+		*/
+		template<size_t _fixedK, typename _Rng>
+		void sampleTokensDense(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e) const
+		{
+			const bool tracked = !doc.tokenStability.empty(), skipping = tracked && iterationCnt % freezeInterval;
+			bool changed = false;
+			alignas(64) Float fixedDist[_fixedK ? _fixedK : 1];
+			for (size_t w = b; w < e; ++w)
+			{
+				if (doc.words[w] >= this->realV) continue;
+				if (K >= runMinTopics && w + runMinLength <= e && doc.words[w + runMinLength - 1] == doc.words[w] && isRunSampled(ld, doc.words[w]))
+				{
+					size_t runEnd = w + 1;
+					while (runEnd < e && doc.words[runEnd] == doc.words[w]) ++runEnd;
+					changed |= sampleRun(doc, ld, rgs, w, runEnd, tracked, skipping);
+					w = runEnd - 1;
+					continue;
+				}
+				if (skipping && isTokenSkipped(doc.tokenStability[w], rgs)) continue;
+				const Tid oldZ = doc.Zs[w];
+				if (_fixedK && !useAsymEta(doc.words[w]) && doc.words[w] < (size_t)ld.numByTopicWord.cols())
+				{
+					static_cast<const DerivedClass*>(this)->template addWordTo<-1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+					sample::prefixSumOfProducts(fixedDist, doc.numByTopic.data(), alphas.data(),
+						ld.numByTopicWord.col(doc.words[w]).data(), eta, ld.invTopicDenom.data(), (int)_fixedK);
+					doc.Zs[w] = sample::sampleFromDiscreteAcc(fixedDist, fixedDist + _fixedK, rgs);
+					static_cast<const DerivedClass*>(this)->template addWordTo<1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+					if (tracked) changed |= trackToken(doc.tokenStability[w], oldZ, doc.Zs[w]);
+					continue;
+				}
+				static_cast<const DerivedClass*>(this)->template addWordTo<-1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+				Float* dist;
+				if (useAsymEta(doc.words[w]))
+				{
+					dist = static_cast<const DerivedClass*>(this)->template
+						getZLikelihoods<true>(ld, doc, docId, doc.words[w]);
+				}
+				else
+				{
+					dist = static_cast<const DerivedClass*>(this)->template
+						getZLikelihoods<false>(ld, doc, docId, doc.words[w]);
+				}
+				doc.Zs[w] = sample::sampleFromDiscreteAcc(dist, dist + K, rgs);
+				static_cast<const DerivedClass*>(this)->template addWordTo<1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+				if (tracked) changed |= trackToken(doc.tokenStability[w], oldZ, doc.Zs[w]);
+			}
+			if (tracked) trackDocument(doc, b, e, changed);
+		}
+
+		/*
+		Words of a prepared document are sorted by their vocabulary, so the tokens of a vocabulary occurring more than once form a run.
+		Only the likelihoods of the old and the new topic of a token change while sampling it,
+		so plain LDA evaluates the likelihoods of all topics once per run and then updates only those of the changed topics.
+		Their prefix sums are kept per block of `runBlock` topics, so an update and a draw cost O(K / runBlock + runBlock) instead of O(K).
+		It pays off only with many topics and long runs, since the fast path recomputing all likelihoods per token is vectorized.
+		*/
+		static constexpr size_t runBlock = 32, runMinTopics = 256, runMinLength = 16;
+
+		bool isRunSampled(const _ModelState& ld, Vid vid) const
+		{
+			return std::is_same<_Derived, void>::value && ld.invTopicDenom.size()
+				&& !useAsymEta(vid) && vid < (size_t)ld.numByTopicWord.cols();
+		}
+
+		// samples the tokens [b, e) of the same vocabulary and returns whether any of their topics changed
+		template<typename _Rng>
+		bool sampleRun(_DocType& doc, _ModelState& ld, _Rng& rgs, size_t b, size_t e, bool tracked, bool skipping) const
+		{
+			const Vid vid = doc.words[b];
+			const size_t numBlocks = (K + runBlock - 1) / runBlock;
+			auto topicWord = ld.numByTopicWord.col(vid);
+			auto& likelihood = ld.runLikelihood;
+			auto& dist = ld.zLikelihood; // prefix sums restarting at each block
+			auto& blockDist = ld.runBlockDist;
+			likelihood = (doc.numByTopic.array().template cast<Float>() + alphas.array())
+				* (topicWord.array().template cast<Float>() + eta) * ld.invTopicDenom.array();
+			blockDist.resize(numBlocks);
+			Float acc = 0;
+			for (size_t j = 0; j < numBlocks; ++j)
+			{
+				Float s = 0;
+				for (size_t k = j * runBlock; k < std::min((j + 1) * runBlock, (size_t)K); ++k) dist[k] = s += likelihood[k];
+				blockDist[j] = acc += s;
+			}
+
+			auto update = [&](Tid k)
+			{
+				const Float d = ((Float)doc.numByTopic[k] + alphas[k]) * ((Float)topicWord[k] + eta) * ld.invTopicDenom[k] - likelihood[k];
+				likelihood[k] += d;
+				for (size_t i = k; i < std::min((k / runBlock + 1) * runBlock, (size_t)K); ++i) dist[i] += d;
+				for (size_t j = k / runBlock; j < numBlocks; ++j) blockDist[j] += d;
+			};
+
+			// counting the prefix sums not greater than the drawn value keeps the loops free of branches
+			auto draw = [&]()
+			{
+				Float r = rgs.uniform_real() * blockDist[numBlocks - 1];
+				size_t j = 0;
+				for (size_t i = 0; i + 1 < numBlocks; ++i) j += r >= blockDist[i];
+				if (j) r -= blockDist[j - 1];
+				size_t z = j * runBlock;
+				for (size_t k = j * runBlock; k + 1 < std::min((j + 1) * runBlock, (size_t)K); ++k) z += r >= dist[k];
+				return (Tid)z;
+			};
+
+			bool changed = false;
+			for (size_t w = b; w < e; ++w)
+			{
+				if (skipping && isTokenSkipped(doc.tokenStability[w], rgs)) continue;
+				const Tid oldZ = doc.Zs[w];
+				addWordTo<-1>(ld, doc, w, vid, oldZ);
+				update(oldZ);
+				doc.Zs[w] = draw();
+				addWordTo<1>(ld, doc, w, vid, doc.Zs[w]);
+				update(doc.Zs[w]);
+				if (tracked) changed |= trackToken(doc.tokenStability[w], oldZ, doc.Zs[w]);
+			}
+			return changed;
+		}
+
+		/*
+		dense sampling procedure over only the topics of `topics`, for the models whose documents allow only some topics,
+		so that the cost per token is proportional to the number of the allowed topics rather than K.
+		It takes the symmetric prior `eta` for all vocabularies.
+		*/
+		template<typename _Rng>
+		void sampleTokensRestricted(_DocType& doc, _ModelState& ld, _Rng& rgs, size_t b, size_t e, const std::vector<Tid>& topics) const
+		{
+			const size_t V = this->realV, L = topics.size();
+			const Float etaSum = V * eta;
+			auto& zLikelihood = ld.zLikelihood;
+			for (size_t w = b; w < e; ++w)
+			{
+				const Vid vid = doc.words[w];
+				if (vid >= V) continue;
+				static_cast<const DerivedClass*>(this)->template addWordTo<-1>(ld, doc, w, vid, doc.Zs[w]);
+				for (size_t i = 0; i < L; ++i)
+				{
+					const Tid k = topics[i];
+					zLikelihood[i] = ((Float)doc.numByTopic[k] + alphas[k]) * ((Float)ld.numByTopicWord(k, vid) + eta)
+						/ ((Float)ld.numByTopic[k] + etaSum);
+				}
+				sample::prefixSum(zLikelihood.data(), L);
+				doc.Zs[w] = topics[sample::sampleFromDiscreteAcc(zLikelihood.data(), zLikelihood.data() + L, rgs)];
+				static_cast<const DerivedClass*>(this)->template addWordTo<1>(ld, doc, w, vid, doc.Zs[w]);
+			}
+		}
+
+		/*
+		Plain LDA samples only the vocabularies with their own priors by the asymmetric path,
+		since the others differ from the symmetric fast path only by the topic sums of the priors kept in `invTopicDenom`.
+		Derived models take the asymmetric path for all vocabularies if any has its own prior.
+		*/
+		bool useAsymEta(Vid vid) const
+		{
+			if (!etaByTopicWord.size()) return false;
+			return !std::is_same<_Derived, void>::value || hasOwnPrior(vid);
+		}
+
+		/*
+		sampling procedure of inference with `frozenInference`, where the topic-word distributions are fixed to `phiByWord`.
+		The counts of `ld` are still updated, since the log-likelihood of the inferred documents is computed from them.
+		*/
+		template<typename _Rng>
+		void sampleTokensFrozen(_DocType& doc, _ModelState& ld, _Rng& rgs, size_t b, size_t e) const
+		{
+			auto& zLikelihood = ld.zLikelihood;
+			for (size_t w = b; w < e; ++w)
+			{
+				if (doc.words[w] >= this->realV) continue;
+				static_cast<const DerivedClass*>(this)->template addWordTo<-1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+				zLikelihood = (doc.numByTopic.array().template cast<Float>() + alphas.array()) * phiByWord.col(doc.words[w]).array();
+				sample::prefixSum(zLikelihood.data(), K);
+				doc.Zs[w] = sample::sampleFromDiscreteAcc(zLikelihood.data(), zLikelihood.data() + K, rgs);
+				static_cast<const DerivedClass*>(this)->template addWordTo<1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+			}
+		}
+
+		/*
+		dense sampling procedure of ParallelScheme::async, which updates the shared counts atomically
+		*/
+		void sampleTokensShared(_DocType& doc, size_t docId, _ModelState& ld, _RandGen& rgs, size_t iterationCnt, size_t b, size_t e, std::true_type) const
+		{
+			if (!etaByTopicWord.size() || std::is_same<_Derived, void>::value) refreshInvTopicDenom(ld);
+			const bool tracked = !doc.tokenStability.empty(), skipping = tracked && iterationCnt % freezeInterval;
+			bool changed = false;
+			for (size_t w = b; w < e; ++w)
+			{
+				if (doc.words[w] >= this->realV) continue;
+				if (skipping && isTokenSkipped(doc.tokenStability[w], rgs)) continue;
+				const Tid oldZ = doc.Zs[w];
+				addWordToShared<-1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+				Float* dist;
+				if (useAsymEta(doc.words[w]))
+				{
+					dist = static_cast<const DerivedClass*>(this)->template
+						getZLikelihoods<true>(ld, doc, docId, doc.words[w]);
+				}
+				else
+				{
+					dist = static_cast<const DerivedClass*>(this)->template
+						getZLikelihoods<false>(ld, doc, docId, doc.words[w]);
+				}
+				doc.Zs[w] = sample::sampleFromDiscreteAcc(dist, dist + K, rgs);
+				addWordToShared<1>(ld, doc, w, doc.words[w], doc.Zs[w]);
+				if (tracked) changed |= trackToken(doc.tokenStability[w], oldZ, doc.Zs[w]);
+			}
+			if (tracked) trackDocument(doc, b, e, changed);
+		}
+
+		void sampleTokensShared(_DocType& doc, size_t docId, _ModelState& ld, _RandGen& rgs, size_t iterationCnt, size_t b, size_t e, std::false_type) const
+		{
+		}
+
+		static constexpr bool isSamplingMethodSupported(SamplingMethod method)
+		{
+			// the bucketed and MH samplers rely on the likelihood of plain LDA
+			return method == SamplingMethod::dense
+				|| ((method == SamplingMethod::sparse || method == SamplingMethod::mh) && std::is_same<_Derived, void>::value);
+		}
+
+		/*
+		returns the document-topic prior of topic k in doc, which is used by the MH sampler
+		*/
+		Float getTopicPrior(const _DocType& doc, Tid k) const
+		{
+			return alphas[k];
+		}
+
+		/*
+		bucketed sampling procedure based on SparseLDA
+		p(z = k) is splitted into three buckets:
+			s_k = alpha_k * eta / (n_k + V * eta)
+			r_k = n_dk * eta / (n_k + V * eta)
+			q_k = (alpha_k + n_dk) * n_wk / (n_k + V * eta)
+		r and q are evaluated only for topics having non-zero n_dk and n_wk respectively,
+		and the coefficients of all buckets are updated incrementally after each token.
+		*/
+		template<typename _Rng>
+		void sampleTokensSparse(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e) const
+		{
+			const Float etaSum = eta * this->realV;
+			auto& buf = ld.sparseBuf;
+			buf.invDenom = (ld.numByTopic.array().template cast<Float>() + etaSum).inverse();
+			buf.docCoef = (doc.numByTopic.array().template cast<Float>() + alphas.array()) * buf.invDenom.array();
+			Float sSum = (alphas.array() * buf.invDenom.array()).sum() * eta;
+			Float rSum = 0;
+
+			buf.wordBucket.resize(K);
+			buf.docTopics.clear();
+			buf.docTopicPos.resize(K);
+			if (buf.topicsByWord.size() != this->realV)
+			{
+				buf.topicsByWord.clear();
+				buf.topicsByWord.resize(this->realV);
+				buf.wordStamp.clear();
+				buf.wordStamp.resize(this->realV);
+			}
+
+			for (Tid k = 0; k < K; ++k)
+			{
+				if (doc.numByTopic[k] > 0)
+				{
+					buf.docTopicPos[k] = buf.docTopics.size();
+					buf.docTopics.emplace_back(k);
+					rSum += doc.numByTopic[k] * buf.invDenom[k];
+				}
+				else buf.docTopicPos[k] = -1;
+			}
+			rSum *= eta;
+
+			auto detachTopic = [&](Tid k)
+			{
+				sSum -= alphas[k] * eta * buf.invDenom[k];
+				rSum -= doc.numByTopic[k] * eta * buf.invDenom[k];
+			};
+
+			auto attachTopic = [&](Tid k)
+			{
+				buf.invDenom[k] = 1 / (ld.numByTopic[k] + etaSum);
+				buf.docCoef[k] = (doc.numByTopic[k] + alphas[k]) * buf.invDenom[k];
+				sSum += alphas[k] * eta * buf.invDenom[k];
+				rSum += doc.numByTopic[k] * eta * buf.invDenom[k];
+				if (doc.numByTopic[k] > 0)
+				{
+					if (buf.docTopicPos[k] == (uint32_t)-1)
+					{
+						buf.docTopicPos[k] = buf.docTopics.size();
+						buf.docTopics.emplace_back(k);
+					}
+				}
+				else if (buf.docTopicPos[k] != (uint32_t)-1)
+				{
+					auto last = buf.docTopics.back();
+					buf.docTopics[buf.docTopicPos[k]] = last;
+					buf.docTopicPos[last] = buf.docTopicPos[k];
+					buf.docTopics.pop_back();
+					buf.docTopicPos[k] = -1;
+				}
+			};
+
+			const bool tracked = !doc.tokenStability.empty(), skipping = tracked && iterationCnt % freezeInterval;
+			bool changed = false;
+			for (size_t w = b; w < e; ++w)
+			{
+				const Vid vid = doc.words[w];
+				if (vid >= this->realV) continue;
+				if (skipping && isTokenSkipped(doc.tokenStability[w], rgs)) continue;
+				const bool isTail = vid >= (size_t)ld.numByTopicWord.cols();
+				const auto* col = isTail ? nullptr : ld.numByTopicWord.col(vid).data();
+				auto wordCount = [&](Tid k) -> WeightType
+				{
+					return isTail ? ld.numByTopicWordTail.get(k, vid) : col[k];
+				};
+				auto& wordTopics = buf.topicsByWord[vid];
+				if (buf.wordStamp[vid] != iterationCnt + 1)
+				{
+					// count matrix may be modified outside of the sampler, e.g. merging states
+					wordTopics.clear();
+					if (isTail)
+					{
+						for (auto& e : ld.numByTopicWordTail.col(vid)) wordTopics.emplace_back(e.topic);
+					}
+					else
+					{
+						for (Tid k = 0; k < K; ++k)
+						{
+							if (col[k] > 0) wordTopics.emplace_back(k);
+						}
+					}
+					buf.wordStamp[vid] = iterationCnt + 1;
+				}
+
+				Tid z = doc.Zs[w];
+				const Tid oldZ = z;
+				detachTopic(z);
+				static_cast<const DerivedClass*>(this)->template addWordTo<-1>(ld, doc, w, vid, z);
+				attachTopic(z);
+				if (wordCount(z) <= 0)
+				{
+					// a weighted count may have been clamped to zero before, so z is not always in the list
+					auto it = std::find(wordTopics.begin(), wordTopics.end(), z);
+					if (it != wordTopics.end()) wordTopics.erase(it);
+				}
+
+				// topic-word bucket
+				Float qSum = 0;
+				for (size_t i = 0; i < wordTopics.size(); ++i)
+				{
+					qSum += buf.docCoef[wordTopics[i]] * wordCount(wordTopics[i]);
+					buf.wordBucket[i] = qSum;
+				}
+
+				Float u = rgs.uniform_real() * (sSum + rSum + qSum);
+				if (u < qSum)
+				{
+					z = wordTopics[std::upper_bound(buf.wordBucket.data(), buf.wordBucket.data() + wordTopics.size(), u)
+						- buf.wordBucket.data()];
+				}
+				else
+				{
+					u -= qSum;
+					z = non_topic_id;
+					if (u < rSum)
+					{
+						for (auto k : buf.docTopics)
+						{
+							u -= doc.numByTopic[k] * eta * buf.invDenom[k];
+							if (u < 0)
+							{
+								z = k;
+								break;
+							}
+						}
+					}
+					else
+					{
+						u -= rSum;
+						for (Tid k = 0; k < K; ++k)
+						{
+							u -= alphas[k] * eta * buf.invDenom[k];
+							if (u < 0)
+							{
+								z = k;
+								break;
+							}
+						}
+					}
+					// fallback for the accumulated rounding error
+					if (z == non_topic_id) z = wordTopics.empty() ? K - 1 : wordTopics.back();
+				}
+				doc.Zs[w] = z;
+				// a token of zero weight doesn't make its topic non-zero
+				const bool wasZero = wordCount(z) <= 0;
+				detachTopic(z);
+				static_cast<const DerivedClass*>(this)->template addWordTo<1>(ld, doc, w, vid, z);
+				attachTopic(z);
+				if (wasZero && wordCount(z) > 0) wordTopics.emplace_back(z);
+				if (tracked) changed |= trackToken(doc.tokenStability[w], oldZ, z);
+			}
+			if (tracked) trackDocument(doc, b, e, changed);
+		}
+
+		/*
+		builds the stale proposal tables of the MH sampler from the current state
+		*/
+		void buildProposalTables(ThreadPool* pool, const _ModelState& ld)
+		{
+			const Float etaSum = eta * this->realV;
+			auto& prop = mhProposal;
+			Vector invDenom = (ld.numByTopic.array().template cast<Float>() + etaSum).inverse();
+			prop.alphas = alphas;
+			prop.alphaMass = alphas.sum();
+			prop.smoothing = invDenom * eta;
+			prop.smoothingMass = prop.smoothing.sum();
+			if (K > 1)
+			{
+				prop.alphaAlias.buildTable(prop.alphas.data(), prop.alphas.data() + K);
+				prop.smoothingAlias.buildTable(prop.smoothing.data(), prop.smoothing.data() + K);
+			}
+			prop.words.resize(this->realV);
+
+			auto buildWord = [&](Vid v)
+			{
+				auto& wp = prop.words[v];
+				wp.topics.clear();
+				wp.weights.clear();
+				if (v >= (size_t)ld.numByTopicWord.cols())
+				{
+					// topics have to be in ascending order for `getWordProposal`
+					using Entry = typename SparseTopicWordCounts<WeightType>::Entry;
+					auto entries = ld.numByTopicWordTail.col(v);
+					std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b)
+					{
+						return a.topic < b.topic;
+					});
+					for (auto& e : entries)
+					{
+						wp.topics.emplace_back(e.topic);
+						wp.weights.emplace_back(e.count * invDenom[e.topic]);
+					}
+				}
+				else
+				{
+					const auto* col = ld.numByTopicWord.col(v).data();
+					for (Tid k = 0; k < K; ++k)
+					{
+						if (col[k] <= 0) continue;
+						wp.topics.emplace_back(k);
+						wp.weights.emplace_back(col[k] * invDenom[k]);
+					}
+				}
+				wp.mass = std::accumulate(wp.weights.begin(), wp.weights.end(), (Float)0);
+				if (wp.topics.size() > 1) wp.alias.buildTable(wp.weights.begin(), wp.weights.end());
+			};
+
+			if (pool)
+			{
+				const size_t chStride = pool->getNumWorkers() * 8;
+				std::vector<std::future<void>> futures;
+				futures.reserve(chStride);
+				for (size_t ch = 0; ch < chStride; ++ch)
+				{
+					futures.emplace_back(pool->enqueue([&, ch, chStride](size_t)
+					{
+						for (Vid v = ch; v < this->realV; v += chStride) buildWord(v);
+					}));
+				}
+				for (auto& f : futures) f.get();
+			}
+			else
+			{
+				for (Vid v = 0; v < this->realV; ++v) buildWord(v);
+			}
+		}
+
+		void prepareProposalTables(ThreadPool* pool, bool rebuild, std::true_type)
+		{
+			if (samplingMethod != SamplingMethod::mh || etaByTopicWord.size()) return;
+			if (!rebuild && mhProposal.words.size() == this->realV) return;
+			static_cast<DerivedClass*>(this)->buildProposalTables(pool, this->globalState);
+		}
+
+		void prepareProposalTables(ThreadPool* pool, bool rebuild, std::false_type)
+		{
+		}
+
+		/*
+		Metropolis-Hastings sampling procedure based on LightLDA
+		a new topic is proposed alternately from the word proposal and the doc proposal of MHProposalTable,
+		and accepted with the ratio of p(z = k) to the proposal.
+		both proposals are drawn in O(1): the word proposal from the alias tables built once per iteration,
+		and the doc proposal by picking the topic of a random token in the document.
+		*/
+		template<typename _Rng>
+		void sampleTokensMH(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e) const
+		{
+			static constexpr size_t mhSteps = 4;
+			const Float etaSum = eta * this->realV;
+			const size_t len = doc.words.size();
+			auto& prop = mhProposal;
+			auto* self = static_cast<const DerivedClass*>(this);
+
+			// n_dk of weighted models differs from the number of tokens the doc proposal picks from
+			if (_tw != TermWeight::one)
+			{
+				ld.mhDocCnt.resize(K);
+				for (size_t w = 0; w < len; ++w)
+				{
+					if (doc.words[w] < this->realV) ++ld.mhDocCnt[doc.Zs[w]];
+				}
+			}
+
+			auto docCnt = [&](Tid k) -> Float
+			{
+				return _tw != TermWeight::one ? ld.mhDocCnt[k] : doc.numByTopic[k];
+			};
+
+			auto likelihood = [&](Vid vid, Tid k) -> Float
+			{
+				return (doc.numByTopic[k] + self->getTopicPrior(doc, k))
+					* (ld.getTopicWordCount(k, vid) + eta)
+					/ (ld.numByTopic[k] + etaSum);
+			};
+
+			auto drawAlias = [&](const sample::AliasMethod<>& alias, size_t size) -> size_t
+			{
+				return size > 1 ? alias(rgs) : 0;
+			};
+
+			const bool tracked = !doc.tokenStability.empty(), skipping = tracked && iterationCnt % freezeInterval;
+			bool changed = false;
+			for (size_t w = b; w < e; ++w)
+			{
+				const Vid vid = doc.words[w];
+				if (vid >= this->realV) continue;
+				if (skipping && isTokenSkipped(doc.tokenStability[w], rgs)) continue;
+				Tid z = doc.Zs[w];
+				const Tid oldZ = z;
+				self->template addWordTo<-1>(ld, doc, w, vid, z);
+				if (_tw != TermWeight::one) --ld.mhDocCnt[z];
+
+				auto& wp = prop.words[vid];
+				Float pz = likelihood(vid, z);
+				for (size_t step = 0; step < mhSteps; ++step)
+				{
+					// word proposal
+					Tid t;
+					if (rgs.uniform_real() * (wp.mass + prop.smoothingMass) < wp.mass)
+					{
+						t = wp.topics[drawAlias(wp.alias, wp.topics.size())];
+					}
+					else
+					{
+						t = drawAlias(prop.smoothingAlias, K);
+					}
+
+					if (t != z)
+					{
+						Float pt = likelihood(vid, t);
+						if (rgs.uniform_real() * pz * prop.getWordProposal(vid, t) < pt * prop.getWordProposal(vid, z))
+						{
+							z = t;
+							pz = pt;
+						}
+					}
+
+					// doc proposal, where picking the token itself or an out-of-vocabulary one keeps the current topic
+					Float u = rgs.uniform_real() * (len + prop.alphaMass);
+					if (u < len)
+					{
+						size_t j = (size_t)u;
+						t = (j == w || doc.words[j] >= this->realV) ? z : doc.Zs[j];
+					}
+					else
+					{
+						t = drawAlias(prop.alphaAlias, K);
+					}
+
+					if (t != z)
+					{
+						Float pt = likelihood(vid, t);
+						if (rgs.uniform_real() * pz * (docCnt(t) + prop.alphas[t]) < pt * (docCnt(z) + prop.alphas[z]))
+						{
+							z = t;
+							pz = pt;
+						}
+					}
+				}
+
+				doc.Zs[w] = z;
+				self->template addWordTo<1>(ld, doc, w, vid, z);
+				if (_tw != TermWeight::one) ++ld.mhDocCnt[z];
+				if (tracked) changed |= trackToken(doc.tokenStability[w], oldZ, z);
+			}
+			if (tracked) trackDocument(doc, b, e, changed);
+
+			if (_tw != TermWeight::one)
+			{
+				for (size_t w = 0; w < len; ++w)
+				{
+					if (doc.words[w] < this->realV) ld.mhDocCnt[doc.Zs[w]] = 0;
+				}
+			}
+		}
+
+		/*
+		returns the ids in [0, n) in a shuffled order, or in increasing order if the documents are out of core,
+		so that their files are read sequentially.
+		*/
+		template<bool _infer>
+		std::vector<size_t> getVisitOrder(size_t n, size_t seed) const
+		{
+			std::vector<size_t> order;
+			if (!_infer && outOfCore)
+			{
+				order.resize(n);
+				std::iota(order.begin(), order.end(), 0);
+			}
+			else
+			{
+				order.reserve(n);
+				forShuffled(n, seed, [&](size_t id) { order.emplace_back(id); });
+			}
+			return order;
+		}
+
+		/*
+		calls `fn` with the ids in [0, n) in the order of `getVisitOrder`.
+		Out of core, the documents of the next block, whose indices are `id * stride + offset`, are prefetched ahead.
+		*/
+		template<bool _infer, typename _Fn>
+		void forVisitOrder(size_t n, size_t seed, _Fn&& fn, size_t stride = 1, size_t offset = 0) const
+		{
+			if (_infer || !outOfCore)
+			{
+				forShuffled(n, seed, fn);
+				return;
+			}
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (i % prefetchBlockSize == 0)
+				{
+					prefetchDocs((i + prefetchBlockSize) * stride + offset, (i + 2 * prefetchBlockSize) * stride + offset);
+				}
+				fn(i);
+			}
+		}
+
+		// hints that the documents in [first, last) will be sampled soon, if they are out of core
+		void prefetchDocs(size_t first, size_t last) const
+		{
+			if (!outOfCore) return;
+			last = std::min(last, this->docs.size());
+			if (first >= last) return;
+			const size_t b = this->docs[first].words.data() - outOfCore->words.data();
+			const size_t e = this->docs[last - 1].words.data() + this->docs[last - 1].words.size() - outOfCore->words.data();
+			outOfCore->words.prefetch(b, e - b);
+			outOfCore->Zs.prefetch(b, e - b);
+			outOfCore->wordWeights.prefetch(b, e - b);
+			outOfCore->numByTopicDoc.prefetch(first * K, (last - first) * K);
+		}
+
+		/*
+		`reproducible` training always runs ParallelScheme::copy_merge on the fixed chunks, even with a single worker,
+		so that it gives the same result with any number of workers.
+		*/
+		ParallelScheme getTrainingScheme(ParallelScheme ps) const
+		{
+			return _getTrainingScheme(ps, std::is_same<_Derived, void>{});
+		}
+
+		// only plain LDA can be `reproducible`, and the states of the derived models may lack the hybrid storage
+		ParallelScheme _getTrainingScheme(ParallelScheme ps, std::false_type) const
+		{
+			return ps;
+		}
+
+		ParallelScheme _getTrainingScheme(ParallelScheme ps, std::true_type) const
+		{
+			if (!reproducible) return ps;
+			if (samplingMethod == SamplingMethod::sparse || this->globalState.numByTopicWordTail.size())
+			{
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+					"Reproducible training supports neither SamplingMethod::sparse nor the hybrid topic-word storage");
+			}
+			return ParallelScheme::copy_merge;
+		}
+
+		void addMemoryUsage(MemoryUsage& ret) const
+		{
+			// the weights of the vocabularies stand in for those of the words with LDAArgs::compact, see `getWordWeight`
+			uint64_t zs = heapBytes(sharedZs), weights = heapBytes(sharedWordWeights) + heapBytes(vocabWeights), topics = heapBytes(numByTopicDoc);
+			for (auto& doc : this->docs)
+			{
+				zs += heapBytes(doc.Zs);
+				weights += heapBytes(doc.wordWeights) + heapBytes(doc.wordTf);
+				topics += heapBytes(doc.numByTopic);
+			}
+			ret.emplace_back("docs.Zs", zs);
+			ret.emplace_back("docs.wordWeights", weights);
+			ret.emplace_back("docs.numByTopic", topics);
+			if (sharedArrays) ret.emplace_back("sharedArrays", sharedArrays->getMemoryUsage());
+			ret.emplace_back("wordPriors", heapBytes(etaByTopicWord) + heapBytes(priorColByWord) + heapBytes(priorWords));
+			if (warmStart) ret.emplace_back("warmStart", heapBytes(warmStart->phi));
+			ret.emplace_back("caches", mhProposal.getMemoryUsage()
+				+ heapBytes(phiByTopic) + heapBytes(phiByWord) + heapBytes(topicWordByRow) + heapBytes(syncedZs)
+				+ heapBytes(llDocCounts) + heapBytes(llWordCounts) + heapBytes(chunkDeltaByTopicWord) + heapBytes(chunkDeltaByTopic)
+				+ heapBytes(blockTopicSums) + heapBytes(wordMajorIndex.cellOffset) + heapBytes(wordMajorIndex.docOf) + heapBytes(wordMajorIndex.posOf));
+		}
+
+		/*
+		the workers of ParallelScheme::partition and async view the global topic-word counts instead of copying them,
+		those of ParallelScheme::hierarchical view the copy of their group,
+		and plain LDA merges the workers of ParallelScheme::copy_merge without `tState`.
+		*/
+		uint64_t estimateTrainingOverhead(size_t numWorkers, ParallelScheme ps) const
+		{
+			auto& gs = this->globalState;
+			const uint64_t viewed = gs.getViewedMemoryUsage(), topicWord = gs.getTopicWordMemoryUsage();
+			const uint64_t state = gs.getMemoryUsage() + viewed;
+			// the counts viewed in a mapped file are copied when training starts, and so are the shared arrays unless this is their last user
+			uint64_t ret = viewed;
+			if (sharedArrays) ret = sharedArrays.use_count() > 1 ? sharedArrays->getMemoryUsage() : 0;
+
+			switch (ps)
+			{
+			case ParallelScheme::copy_merge:
+				ret += numWorkers * state;
+				if (!std::is_same<_Derived, void>::value && !this->tState.getMemoryUsage()) ret += state;
+				if (reproducible && !chunkDeltaByTopicWord.size()) ret += topicWord;
+				break;
+			case ParallelScheme::partition:
+			case ParallelScheme::async:
+				ret += numWorkers * (state - topicWord);
+				break;
+			case ParallelScheme::hierarchical:
+				ret += getNumGroups(numWorkers) * state + numWorkers * (state - topicWord);
+				break;
+			default:
+				break;
+			}
+			return ret;
+		}
+
+		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
+		void performSampling(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
+			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd) const
+		{
+			// single-threaded sampling
+			if (_ps == ParallelScheme::none)
+			{
+				if (usesWordMajor<_infer>())
+				{
+					updateWordMajorIndex(pool, docFirst, (size_t)std::distance(docFirst, docLast), 1, edd, std::is_same<_Derived, void>{});
+					sampleCellWordMajor(docFirst, 0, *localData, *rgs, std::is_same<_Derived, void>{});
+					return;
+				}
+				forVisitOrder<_infer>((size_t)std::distance(docFirst, docLast), rgs[0](), [&](size_t id)
+				{
+					static_cast<const DerivedClass*>(this)->presampleDocument(docFirst[id], id, *localData, *rgs, this->globalStep);
+					static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
+						docFirst[id], edd, id,
+						*localData, *rgs, this->globalStep, 0);
+
+				});
+			}
+			// multi-threaded sampling on partition and update into global
+			else if (_ps == ParallelScheme::partition)
+			{
+				const size_t chStride = pool.getNumWorkers();
+				const bool wordMajor = usesWordMajor<_infer>();
+				if (wordMajor) updateWordMajorIndex(pool, docFirst, (size_t)std::distance(docFirst, docLast), chStride, edd, std::is_same<_Derived, void>{});
+				// the worker `partitionId` samples the words of its own vocabulary block in the documents of the slot `didx` at the round `i`
+				auto sampleCell = [&, chStride](size_t i, size_t partitionId)
+				{
+					size_t didx = (i + partitionId) % chStride;
+					if (wordMajor)
+					{
+						return sampleCellWordMajor(docFirst, didx * chStride + partitionId,
+							localData[partitionId], rgs[partitionId], std::is_same<_Derived, void>{});
+					}
+					// documents close in `sampleOrder` touch the same columns of `numByTopicWord`, so visit them in turn
+					if (!_infer && sampleOrder.size() == (size_t)std::distance(docFirst, docLast))
+					{
+						for (size_t p = didx; p < sampleOrder.size(); p += chStride)
+						{
+							const size_t id = sampleOrder[p];
+							if (i == 0)
+							{
+								static_cast<const DerivedClass*>(this)->presampleDocument(
+									docFirst[id], id,
+									localData[partitionId], rgs[partitionId], this->globalStep
+								);
+							}
+							static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
+								docFirst[id], edd, id,
+								localData[partitionId], rgs[partitionId], this->globalStep, partitionId
+							);
+						}
+						return;
+					}
+					forVisitOrder<_infer>(((size_t)std::distance(docFirst, docLast) + (chStride - 1) - didx) / chStride, rgs[partitionId](), [&](size_t id)
+					{
+						if (i == 0)
+						{
+							static_cast<const DerivedClass*>(this)->presampleDocument(
+								docFirst[id * chStride + didx], id * chStride + didx,
+								localData[partitionId], rgs[partitionId], this->globalStep
+							);
+						}
+						static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
+							docFirst[id * chStride + didx], edd, id * chStride + didx,
+							localData[partitionId], rgs[partitionId], this->globalStep, partitionId
+						);
+						}, chStride, didx);
+				};
+				// each cell is timed into the cost of its vocabulary block, which only its worker writes
+				const bool timed = !_infer && partitionRebalanceInterval && !reproducible;
+				if (timed && blockCosts.size() != chStride) blockCosts.assign(chStride, 0);
+				auto sampleRound = [&, timed](size_t i, size_t partitionId)
+				{
+					if (!timed) return sampleCell(i, partitionId);
+					const auto start = std::chrono::steady_clock::now();
+					sampleCell(i, partitionId);
+					blockCosts[partitionId] += std::chrono::duration<double>{ std::chrono::steady_clock::now() - start }.count();
+				};
+				if (!_infer && pipelinedPartition && std::is_same<_Derived, void>::value)
+				{
+					performSamplingPipelined(pool, localData, res, edd, sampleRound, std::is_same<_Derived, void>{});
+				}
+				else
+				{
+					if (!_infer) pipelinedIteration = false;
+					for (size_t i = 0; i < chStride; ++i)
+					{
+						res = pool.enqueueToAll([&, i](size_t partitionId)
+						{
+							sampleRound(i, partitionId);
+						});
+						for (auto& r : res) r.get();
+						res.clear();
+					}
+				}
+			}
+			// multi-threaded sampling on the shared counts without merging
+			else if (_ps == ParallelScheme::async)
+			{
+				performSamplingAsync<_ps, _infer>(pool, localData, rgs, res, docFirst, docLast, edd, AsyncSupported{});
+			}
+			// multi-threaded sampling on partition within groups, whose copies are merged into global
+			else if (_ps == ParallelScheme::hierarchical)
+			{
+				performSamplingHierarchical<_ps, _infer>(pool, localData, rgs, res, docFirst, docLast, edd, HierarchicalSupported{});
+			}
+			// multi-threaded sampling on copy and merge into global
+			else if(_ps == ParallelScheme::copy_merge)
+			{
+				/*
+				chunks are cut from a shuffled order of documents so that each one has a similar number of tokens.
+				with dynamicBalancing, chunks get smaller and each worker takes the next one
+				whenever it finishes the previous one.
+				with `reproducible`, the chunks and the order don't depend on the workers, see `flushChunkChanges`.
+				*/
+				const bool fixedChunks = !_infer && reproducible;
+				const size_t numDocs = std::distance(docFirst, docLast);
+				const size_t numChunks = std::min(fixedChunks ? reproducibleChunks : pool.getNumWorkers() * (dynamicBalancing ? 32 : 8), numDocs);
+				const size_t orderSeed = fixedChunks ? Philox4x32{ rngSeed, (uint64_t)-1, (uint32_t)this->globalStep }() : rgs[0]();
+				std::vector<size_t> order = getVisitOrder<_infer>(numDocs, orderSeed), chunkOffset(numChunks + 1, numDocs);
+				if (fixedChunks)
+				{
+					chunkDeltaByTopicWord.setZero(K, this->globalState.numByTopicWord.cols());
+					chunkDeltaByTopic.setZero(K);
+				}
+				size_t totTokens = 0, cumTokens = 0;
+				for (size_t i = 0; i < numDocs; ++i) totTokens += docFirst[i].words.size();
+				chunkOffset[0] = 0;
+				for (size_t i = 0, c = 1; i < numDocs && c < numChunks; ++i)
+				{
+					cumTokens += docFirst[order[i]].words.size();
+					for (; c < numChunks && cumTokens * numChunks >= totTokens * c; ++c) chunkOffset[c] = i + 1;
+				}
+
+				auto sampleChunk = [&](size_t ch, size_t threadId)
+				{
+					// out of core, chunks are ranges of documents and the worker will probably take the chunk of the next round after this one
+					const size_t nextCh = ch + pool.getNumWorkers();
+					if (!_infer && nextCh < numChunks) prefetchDocs(chunkOffset[nextCh], chunkOffset[nextCh + 1]);
+					std::vector<Tid> prevZs;
+					for (size_t i = chunkOffset[ch]; i < chunkOffset[ch + 1]; ++i)
+					{
+						const size_t id = order[i];
+						if (fixedChunks) prevZs.insert(prevZs.end(), docFirst[id].Zs.begin(), docFirst[id].Zs.end());
+						static_cast<const DerivedClass*>(this)->presampleDocument(
+							docFirst[id], id,
+							localData[threadId], rgs[threadId], this->globalStep
+						);
+						static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
+							docFirst[id], edd, id,
+							localData[threadId], rgs[threadId], this->globalStep, 0
+						);
+					}
+					if (fixedChunks) flushChunkChanges(localData[threadId], docFirst, order.begin() + chunkOffset[ch], order.begin() + chunkOffset[ch + 1], prevZs);
+				};
+
+				std::atomic<size_t> nextChunk{ 0 };
+				if (dynamicBalancing)
+				{
+					for (size_t i = 0; i < pool.getNumWorkers(); ++i)
+					{
+						res.emplace_back(pool.enqueue([&](size_t threadId)
+						{
+							for (size_t ch; (ch = nextChunk++) < numChunks;) sampleChunk(ch, threadId);
+						}));
+					}
+				}
+				else
+				{
+					for (size_t ch = 0; ch < numChunks; ++ch)
+					{
+						res.emplace_back(pool.enqueue([&, ch](size_t threadId)
+						{
+							sampleChunk(ch, threadId);
+						}));
+					}
+				}
+				for (auto& r : res) r.get();
+				res.clear();
+				// all the other workers' states are back to the global state, so merging them adds only the gathered changes
+				if (fixedChunks)
+				{
+					localData[0].numByTopicWord += chunkDeltaByTopicWord;
+					localData[0].numByTopic += chunkDeltaByTopic;
+				}
+			}
+			else
+			{
+				throw std::runtime_error{ "Unsupported ParallelScheme" };
+			}
+		}
+
+		/*
+		moves the changes which a chunk of `reproducible` ParallelScheme::copy_merge made to the state `ld` of its worker
+		into `chunkDeltaByTopicWord` and `chunkDeltaByTopic`, and restores `ld` to the global state for the next chunk.
+		Only the cells of the previous and the new topic of each word can differ,
+		so with `prevZs`, the topics of the words of the chunk before it was sampled, at most two cells are visited per word.
+		Integer counts are added exactly in any order, so the merged counts don't depend on which worker sampled which chunk.
+		*/
+		template<typename _DocIter, typename _IdIter>
+		void flushChunkChanges(_ModelState& ld, _DocIter docFirst, _IdIter first, _IdIter last, const std::vector<Tid>& prevZs) const
+		{
+			auto& gs = this->globalState;
+			auto flushCell = [&](Tid k, Vid vid)
+			{
+				const WeightType d = ld.numByTopicWord(k, vid) - gs.numByTopicWord(k, vid);
+				if (!d) return;
+				atomicUpdateCnt<false>(chunkDeltaByTopicWord(k, vid), d);
+				ld.numByTopicWord(k, vid) = gs.numByTopicWord(k, vid);
+			};
+			size_t pos = 0;
+			for (; first != last; ++first)
+			{
+				auto& doc = docFirst[*first];
+				for (size_t i = 0; i < doc.Zs.size(); ++i, ++pos)
+				{
+					const Vid vid = doc.words[i];
+					if (vid >= this->realV) continue;
+					// the cell of an unchanged topic is also flushed, since removing and adding back a float weight may not cancel exactly
+					flushCell(doc.Zs[i], vid);
+					if (doc.Zs[i] != prevZs[pos]) flushCell(prevZs[pos], vid);
+				}
+			}
+			for (Tid k = 0; k < K; ++k)
+			{
+				const WeightType d = ld.numByTopic[k] - gs.numByTopic[k];
+				if (!d) continue;
+				atomicUpdateCnt<false>(chunkDeltaByTopic[k], d);
+				ld.numByTopic[k] = gs.numByTopic[k];
+			}
+		}
+
+		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
+		void performSamplingAsync(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
+			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd, std::true_type) const
+		{
+			/*
+			workers take chunks of `asyncStaleness` documents from a shuffled order until none is left,
+			and sync their topic totals after each chunk. There is no barrier until all chunks are done.
+			*/
+			const size_t numDocs = std::distance(docFirst, docLast);
+			const size_t chunkSize = std::max(asyncStaleness, (size_t)1);
+			std::vector<size_t> order = getVisitOrder<_infer>(numDocs, rgs[0]());
+			std::atomic<size_t> nextChunk{ 0 };
+			res = pool.enqueueToAll([&](size_t threadId)
+			{
+				auto& ld = localData[threadId];
+				for (size_t c; (c = nextChunk++ * chunkSize) < numDocs;)
+				{
+					if (!_infer)
+					{
+						const size_t ahead = c + pool.getNumWorkers() * chunkSize;
+						prefetchDocs(ahead, ahead + chunkSize);
+					}
+					for (size_t i = c; i < std::min(c + chunkSize, numDocs); ++i)
+					{
+						const size_t id = order[i];
+						static_cast<const DerivedClass*>(this)->presampleDocument(
+							docFirst[id], id, ld, rgs[threadId], this->globalStep
+						);
+						static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
+							docFirst[id], edd, id, ld, rgs[threadId], this->globalStep, 0
+						);
+					}
+					syncSharedTopicCounts(ld);
+				}
+			});
+			for (auto& r : res) r.get();
+			res.clear();
+		}
+
+		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
+		void performSamplingAsync(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
+			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd, std::false_type) const
+		{
+		}
+
+		/*
+		the workers are split into groups of `P` workers, and the documents into `numWorkers` slots by their ids.
+		Each group samples its own `P` slots as ParallelScheme::partition does with `P` vocabulary blocks,
+		so in each of `P` rounds the workers of a group update disjoint columns of the copy of the group.
+		*/
+		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
+		void performSamplingHierarchical(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
+			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd, std::true_type) const
+		{
+			const size_t numWorkers = pool.getNumWorkers(), P = numWorkers / getNumGroups(numWorkers);
+			const size_t numDocs = std::distance(docFirst, docLast);
+			for (size_t i = 0; i < P; ++i)
+			{
+				res = pool.enqueueToAll([&, i](size_t threadId)
+				{
+					const size_t partitionId = threadId % P;
+					const size_t slot = threadId - partitionId + (i + partitionId) % P;
+					auto sample = [&](size_t id)
+					{
+						if (i == 0)
+						{
+							static_cast<const DerivedClass*>(this)->presampleDocument(
+								docFirst[id], id,
+								localData[threadId], rgs[threadId], this->globalStep
+							);
+						}
+						static_cast<const DerivedClass*>(this)->template sampleDocument<_ps, _infer>(
+							docFirst[id], edd, id,
+							localData[threadId], rgs[threadId], this->globalStep, partitionId
+						);
+					};
+					if (!_infer && sampleOrder.size() == numDocs)
+					{
+						for (size_t p = slot; p < numDocs; p += numWorkers) sample(sampleOrder[p]);
+						return;
+					}
+					forVisitOrder<_infer>((numDocs + (numWorkers - 1) - slot) / numWorkers, rgs[threadId](), [&](size_t id)
+					{
+						sample(id * numWorkers + slot);
+					}, numWorkers, slot);
+				});
+				for (auto& r : res) r.get();
+				res.clear();
+			}
+		}
+
+		template<ParallelScheme _ps, bool _infer, typename _DocIter, typename _ExtraDocData>
+		void performSamplingHierarchical(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, std::vector<std::future<void>>& res,
+			_DocIter docFirst, _DocIter docLast, const _ExtraDocData& edd, std::false_type) const
+		{
+		}
+
+		/*
+		runs the rounds of ParallelScheme::partition with `pipelinedPartition` in one task per worker without a barrier between them.
+		The documents a worker samples at a round are those the next worker sampled at the previous round,
+		so each worker waits only for the next one, and the fast workers go on while the slow ones are still sampling.
+		Since only the worker `partitionId` writes its vocabulary block, the block is final after its last round
+		and the worker merges it into `blockTopicSums` at once, so `mergeState` only adds up the sums of the blocks.
+		Each worker takes the merged topic totals when it starts, instead of waiting for `distributeMergedState`.
+		*/
+		template<typename _ExtraDocData, typename _Fn>
+		void performSamplingPipelined(ThreadPool& pool, _ModelState* localData, std::vector<std::future<void>>& res,
+			const _ExtraDocData& edd, _Fn& sampleRound, std::true_type) const
+		{
+			const size_t numWorkers = pool.getNumWorkers();
+			const size_t cols = this->globalState.numByTopicWord.cols();
+			auto blockBegin = [&](size_t j) -> size_t
+			{
+				if (j == 0) return 0;
+				if (j >= numWorkers || j > edd.vChunkOffset.size()) return cols;
+				return std::min((size_t)edd.vChunkOffset[j - 1], cols);
+			};
+			std::vector<std::atomic<size_t>> roundsDone(numWorkers);
+			for (auto& r : roundsDone) r.store(0);
+			blockTopicSums.resize(K, numWorkers);
+			res = pool.enqueueToAll([&](size_t partitionId)
+			{
+				auto& ld = localData[partitionId];
+				const size_t next = (partitionId + 1) % numWorkers;
+				try
+				{
+					ld.numByTopic = this->globalState.numByTopic;
+					for (size_t i = 0; i < numWorkers; ++i)
+					{
+						while (roundsDone[next].load(std::memory_order_acquire) < i) std::this_thread::yield();
+						sampleRound(i, partitionId);
+						roundsDone[partitionId].store(i + 1, std::memory_order_release);
+					}
+				}
+				catch (...)
+				{
+					// lets the others finish so that the error reaches the caller
+					roundsDone[partitionId].store(numWorkers, std::memory_order_release);
+					throw;
+				}
+				const size_t b = blockBegin(partitionId), e = std::max(blockBegin(partitionId + 1), b);
+				auto block = ld.numByTopicWord.middleCols(b, e - b);
+				// make all count being positive
+				if (_tw != TermWeight::one) block = block.cwiseMax(0);
+				blockTopicSums.col(partitionId) = block.rowwise().sum();
+			});
+			for (auto& r : res) r.get();
+			res.clear();
+			pipelinedIteration = true;
+		}
+
+		template<typename _ExtraDocData, typename _Fn>
+		void performSamplingPipelined(ThreadPool& pool, _ModelState* localData, std::vector<std::future<void>>& res,
+			const _ExtraDocData& edd, _Fn& sampleRound, std::false_type) const
+		{
+		}
+
+		template<ParallelScheme _ps, bool _infer, typename _DocIter>
+		void performSamplingGlobal(ThreadPool* pool, _ModelState& globalState, _RandGen* rgs, 
+			_DocIter docFirst, _DocIter docLast) const
+		{
+		}
+
+		template<typename _DocIter, typename _ExtraDocData>
+		void updatePartition(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, _DocIter first, _DocIter last, _ExtraDocData& edd) const
+		{
+			updateVocabChunks(pool.getNumWorkers(), first, last, edd);
+			// the columns are moved only when the blocks or the matrix changed, and never for the temporary states of inference
+			auto& tw = as_mutable(this)->globalState.numByTopicWord;
+			if (pool.isNumaAware() && &globalState == &this->globalState
+				&& (placedTopicWord != tw.data() || placedVChunkOffset != edd.vChunkOffset))
+			{
+				placeColumnsOnNodes(pool, tw, edd.vChunkOffset);
+				placedTopicWord = tw.data();
+				placedVChunkOffset = edd.vChunkOffset;
+			}
+			static_cast<const DerivedClass*>(this)->distributePartition(pool, globalState, localData, edd);
+		}
+
+		// cuts the vocabulary into `numPools` blocks of similar frequencies and finds the range of each block in each document
+		template<typename _DocIter, typename _ExtraDocData>
+		void updateVocabChunks(size_t numPools, _DocIter first, _DocIter last, _ExtraDocData& edd) const
+		{
+			if (edd.vChunkOffset.size() != numPools)
+			{
+				edd.vChunkOffset.clear();
+				size_t totCnt = std::accumulate(this->vocabCf.begin(), this->vocabCf.begin() + this->realV, 0);
+				size_t cumCnt = 0;
+				for (size_t i = 0; i < this->realV; ++i)
+				{
+					cumCnt += this->vocabCf[i];
+					if (cumCnt * numPools >= totCnt * (edd.vChunkOffset.size() + 1)) edd.vChunkOffset.emplace_back(i + 1);
+				}
+
+				updateChunkOffsetByDoc(numPools, first, last, edd);
+			}
+		}
+
+		// finds the range of each vocabulary block in each document, whose words are sorted by their ids
+		template<typename _DocIter, typename _ExtraDocData>
+		static void updateChunkOffsetByDoc(size_t numPools, _DocIter first, _DocIter last, _ExtraDocData& edd)
+		{
+			edd.chunkOffsetByDoc.resize(numPools + 1, std::distance(first, last));
+			size_t i = 0;
+			for (; first != last; ++first, ++i)
+			{
+				auto& doc = *first;
+				edd.chunkOffsetByDoc(0, i) = 0;
+				size_t g = 0;
+				for (size_t j = 0; j < doc.words.size(); ++j)
+				{
+					for (; g < numPools && doc.words[j] >= edd.vChunkOffset[g]; ++g)
+					{
+						edd.chunkOffsetByDoc(g + 1, i) = j;
+					}
+				}
+				for (; g < numPools; ++g)
+				{
+					edd.chunkOffsetByDoc(g + 1, i) = doc.words.size();
+				}
+			}
+		}
+
+		/*
+		re-cuts the vocabulary into `numPools` blocks of similar measured costs instead of similar frequencies.
+		The cost of a token counts not only its frequency but also the sparsity of its topics and the model-specific work,
+		so each word is weighted by its frequency times the seconds per token that `blockCosts` measured for its current block.
+		The document slots are strided over the documents and left as they are, and only the ranges of `chunkOffsetByDoc` move.
+		It returns whether the blocks changed, which they don't while the slowest block takes less than 10% more than the average.
+		*/
+		template<typename _DocIter, typename _ExtraDocData>
+		bool rebalanceVocabChunks(size_t numPools, _DocIter first, _DocIter last, _ExtraDocData& edd) const
+		{
+			if (blockCosts.size() != numPools || edd.vChunkOffset.size() != numPools) return false;
+			std::vector<double> costs(numPools);
+			costs.swap(blockCosts);
+			const double totCost = std::accumulate(costs.begin(), costs.end(), 0.);
+			if (totCost <= 0 || *std::max_element(costs.begin(), costs.end()) * numPools <= totCost * 1.1) return false;
+
+			std::vector<double> costPerToken(numPools);
+			double totCnt = 0;
+			for (size_t g = 0; g < numPools; ++g)
+			{
+				const size_t b = g ? edd.vChunkOffset[g - 1] : 0, e = std::max((size_t)edd.vChunkOffset[g], b);
+				const double cnt = std::accumulate(this->vocabCf.begin() + b, this->vocabCf.begin() + e, 0.);
+				costPerToken[g] = cnt > 0 ? costs[g] / cnt : 0;
+				totCnt += cnt;
+			}
+			// an empty block has no measurement, so it takes the average
+			for (size_t g = 0; g < numPools; ++g)
+			{
+				if (costPerToken[g] <= 0) costPerToken[g] = totCost / std::max(totCnt, 1.);
+			}
+
+			auto weightedCf = [&](size_t g, size_t v) { return this->vocabCf[v] * costPerToken[g]; };
+			double totWeight = 0;
+			for (size_t v = 0, g = 0; v < this->realV; ++v)
+			{
+				while (g + 1 < numPools && v >= edd.vChunkOffset[g]) ++g;
+				totWeight += weightedCf(g, v);
+			}
+
+			std::vector<Vid> offsets;
+			double cumWeight = 0;
+			for (size_t v = 0, g = 0; v < this->realV && offsets.size() < numPools; ++v)
+			{
+				while (g + 1 < numPools && v >= edd.vChunkOffset[g]) ++g;
+				cumWeight += weightedCf(g, v);
+				if (cumWeight * numPools >= totWeight * (offsets.size() + 1)) offsets.emplace_back(v + 1);
+			}
+			// the rounding errors may leave the last blocks uncut
+			while (offsets.size() < numPools) offsets.emplace_back(this->realV);
+			offsets.back() = this->realV;
+			if (offsets == edd.vChunkOffset) return false;
+
+			edd.vChunkOffset = std::move(offsets);
+			updateChunkOffsetByDoc(numPools, first, last, edd);
+			wordMajorIndex.numSlots = 0;
+			return true;
+		}
+
+		/*
+		moves the columns of `tw` owned by each worker of ParallelScheme::partition
+		into pages first touched by that worker, so that they are allocated on the worker's NUMA node.
+		The columns of a vocabulary chunk are contiguous since the matrix is column-major.
+		*/
+		template<typename _Scalar>
+		static void placeColumnsOnNodes(ThreadPool& pool, ShareableMatrix<_Scalar, -1, -1>& tw, const std::vector<Vid>& vChunkOffset)
+		{
+			if (!tw.size() || tw.external || tw.ownData.data() != tw.data()) return;
+			const size_t rows = tw.rows(), cols = tw.cols();
+			// a fresh allocation is left untouched until the workers write their own columns
+			Eigen::Matrix<_Scalar, -1, -1> placed{ (Eigen::Index)rows, (Eigen::Index)cols };
+			HugePages::advise(placed.data(), sizeof(_Scalar) * placed.size());
+			std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t partitionId)
+			{
+				size_t b = partitionId ? vChunkOffset[partitionId - 1] : 0,
+					e = partitionId + 1 < pool.getNumWorkers() ? vChunkOffset[partitionId] : cols;
+				b = std::min(b, cols);
+				e = std::min(e, cols);
+				if (e > b) placed.middleCols(b, e - b) = tw.middleCols(b, e - b);
+			});
+			for (auto& r : res) r.get();
+			tw.replaceData(std::move(placed));
+		}
+
+		// the counts of other types are left as they are
+		template<typename _Other>
+		static void placeColumnsOnNodes(ThreadPool&, _Other&, const std::vector<Vid>&)
+		{
+		}
+
+		/*
+		lets all workers of ParallelScheme::async share `globalState.numByTopicWord`.
+		Each worker keeps its own topic totals, which are synced with the shared ones by `syncSharedTopicCounts`.
+		*/
+		void prepareAsync(ThreadPool& pool, _ModelState& globalState, _ModelState* localData) const
+		{
+			prepareAsync(pool, globalState, localData, AsyncSupported{});
+		}
+
+		void prepareAsync(ThreadPool& pool, _ModelState& globalState, _ModelState* localData, std::false_type) const
+		{
+			THROW_ERROR_WITH_INFO(exc::InvalidArgument, "This model doesn't provide ParallelScheme::async");
+		}
+
+		void prepareAsync(ThreadPool& pool, _ModelState& globalState, _ModelState* localData, std::true_type) const
+		{
+			if (!std::is_same<_Derived, void>::value || samplingMethod != SamplingMethod::dense || globalState.numByTopicWordTail.size())
+			{
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument, 
+					"ParallelScheme::async supports only SamplingMethod::dense without the hybrid topic-word storage");
+			}
+			std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t threadId)
+			{
+				auto& ld = localData[threadId];
+				ld.numByTopicWord.init(globalState.numByTopicWord.data(), globalState.numByTopicWord.rows(), globalState.numByTopicWord.cols());
+				ld.numByTopic = globalState.numByTopic;
+				ld.numByTopicDelta = Eigen::Matrix<WeightType, -1, 1>::Zero(K);
+				ld.zLikelihood = Vector::Zero(K);
+			});
+			for (auto& r : res) r.get();
+		}
+
+		/*
+		the number of groups of ParallelScheme::hierarchical for `numWorkers` workers,
+		`hierarchicalGroups` or the nearest to the square root of `numWorkers` if it is 0,
+		reduced to a divisor of `numWorkers` so that all groups have the same number of workers.
+		*/
+		size_t getNumGroups(size_t numWorkers) const
+		{
+			size_t g = hierarchicalGroups ? hierarchicalGroups : (size_t)std::lround(std::sqrt((double)numWorkers));
+			g = std::max(std::min(g, numWorkers), (size_t)1);
+			while (numWorkers % g) --g;
+			return g;
+		}
+
+		/*
+		appends a copy of the global state for each group of ParallelScheme::hierarchical to `localData`,
+		and lets each worker view the topic-word counts of the copy of its group.
+		Each group copies the global state on the node of its first worker.
+		*/
+		template<typename _ExtraDocData>
+		void prepareHierarchical(ThreadPool& pool, _ModelState& globalState, std::vector<_ModelState>& localData, _ExtraDocData& edd) const
+		{
+			prepareHierarchical(pool, globalState, localData, edd, HierarchicalSupported{});
+		}
+
+		template<typename _ExtraDocData>
+		void prepareHierarchical(ThreadPool& pool, _ModelState& globalState, std::vector<_ModelState>& localData, _ExtraDocData& edd, std::false_type) const
+		{
+			THROW_ERROR_WITH_INFO(exc::InvalidArgument, "This model doesn't provide ParallelScheme::hierarchical");
+		}
+
+		template<typename _ExtraDocData>
+		void prepareHierarchical(ThreadPool& pool, _ModelState& globalState, std::vector<_ModelState>& localData, _ExtraDocData& edd, std::true_type) const
+		{
+			if (!std::is_same<_Derived, void>::value || reproducible || globalState.numByTopicWordTail.size())
+			{
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+					"ParallelScheme::hierarchical supports neither `reproducible` nor the hybrid topic-word storage");
+			}
+			const size_t numWorkers = pool.getNumWorkers(), P = numWorkers / getNumGroups(numWorkers);
+			updateVocabChunks(P, this->docs.begin(), this->docs.end(), edd);
+			localData.resize(numWorkers + numWorkers / P);
+			_ModelState* groupStates = localData.data() + numWorkers;
+			std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t threadId)
+			{
+				if (threadId % P == 0) groupStates[threadId / P] = globalState;
+			});
+			for (auto& r : res) r.get();
+			res = pool.enqueueToAll([&](size_t threadId)
+			{
+				auto& ld = localData[threadId];
+				auto& tw = groupStates[threadId / P].numByTopicWord;
+				ld.numByTopicWord.init(tw.data(), tw.rows(), tw.cols());
+				ld.numByTopic = globalState.numByTopic;
+				if (!ld.zLikelihood.size()) ld.zLikelihood = globalState.zLikelihood;
+			});
+			for (auto& r : res) r.get();
+		}
+
+		template<typename _ExtraDocData>
+		void distributePartition(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, const _ExtraDocData& edd) const
+		{
+			std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t partitionId)
+			{
+				size_t b = partitionId ? edd.vChunkOffset[partitionId - 1] : 0,
+					e = edd.vChunkOffset[partitionId];
+
+				//localData[partitionId].numByTopicWord.matrix() = globalState.numByTopicWord.block(0, b, globalState.numByTopicWord.rows(), e - b);
+				localData[partitionId].numByTopicWord.init((WeightType*)globalState.numByTopicWord.data(), globalState.numByTopicWord.rows(), globalState.numByTopicWord.cols());
+				localData[partitionId].numByTopicWordTail.initView(const_cast<_ModelState&>(globalState).numByTopicWordTail);
+				localData[partitionId].numByTopic = globalState.numByTopic;
+				if (!localData[partitionId].zLikelihood.size()) localData[partitionId].zLikelihood = globalState.zLikelihood;
+			});
+			
+			for (auto& r : res) r.get();
+		}
+
+		/*
+		builds `sampleOrder` according to `docOrder`.
+		With DocOrder::vocab_block, the vocabulary is cut into blocks whose topic counts fit in L2 cache
+		and documents are grouped by the block holding most of their words, longer ones first.
+		Since vocabularies are numbered by frequency at `removeStopwords`, the blocks of frequent words come first.
+		*/
+		void updateSampleOrder()
+		{
+			sampleOrder.clear();
+			wordMajorIndex = {};
+			if (docOrder == DocOrder::shuffled || docOrder == DocOrder::word_major || this->docs.empty()) return;
+
+			const size_t numDocs = this->docs.size();
+			std::vector<size_t> blockOf(numDocs), lengthOf(numDocs);
+			const size_t blockSize = std::max((size_t)1, ((size_t)256 * 1024) / (std::max((size_t)K, (size_t)1) * sizeof(WeightType)));
+			std::vector<size_t> cntByBlock;
+			for (size_t i = 0; i < numDocs; ++i)
+			{
+				auto& doc = this->docs[i];
+				lengthOf[i] = doc.words.size();
+				if (docOrder != DocOrder::vocab_block) continue;
+				cntByBlock.assign(this->realV / blockSize + 1, 0);
+				for (auto w : doc.words)
+				{
+					if (w < this->realV) ++cntByBlock[w / blockSize];
+				}
+				blockOf[i] = std::max_element(cntByBlock.begin(), cntByBlock.end()) - cntByBlock.begin();
+			}
+
+			sampleOrder.resize(numDocs);
+			std::iota(sampleOrder.begin(), sampleOrder.end(), 0);
+			std::stable_sort(sampleOrder.begin(), sampleOrder.end(), [&](size_t a, size_t b)
+			{
+				if (blockOf[a] != blockOf[b]) return blockOf[a] < blockOf[b];
+				return lengthOf[a] > lengthOf[b];
+			});
+		}
+
+		/*
+		returns true if the tokens are sampled word by word over `wordMajorIndex`.
+		The other samplers and the reproducible or out-of-core training keep visiting them document by document.
+		*/
+		template<bool _infer>
+		bool usesWordMajor() const
+		{
+			return !_infer && docOrder == DocOrder::word_major && std::is_same<_Derived, void>::value
+				&& samplingMethod == SamplingMethod::dense && !reproducible && !outOfCore;
+		}
+
+		/*
+		builds `wordMajorIndex` for `numSlots` workers unless it is already built for them and the same documents.
+		Each cell is sorted by a counting sort over the vocabularies it holds, keeping the order of documents within a vocabulary.
+		*/
+		template<typename _DocIter, typename _ExtraDocData>
+		void updateWordMajorIndex(ThreadPool& pool, _DocIter docFirst, size_t numDocs, size_t numSlots, const _ExtraDocData& edd, std::true_type) const
+		{
+			auto& idx = wordMajorIndex;
+			if (idx.numSlots == numSlots && idx.numDocs == numDocs) return;
+
+			const size_t numCells = numSlots * numSlots, numWorkers = pool.getNumWorkers();
+			auto tokenRange = [&](size_t block, size_t docId)
+			{
+				if (!docFirst[docId].multiplicity) return std::make_pair((size_t)0, (size_t)0);
+				if (numSlots == 1) return std::make_pair((size_t)0, docFirst[docId].words.size());
+				return std::make_pair((size_t)edd.chunkOffsetByDoc(block, docId), (size_t)edd.chunkOffsetByDoc(block + 1, docId));
+			};
+			auto forEachCell = [&](const std::function<void(size_t, size_t, size_t)>& fn)
+			{
+				auto res = pool.enqueueToAll([&](size_t threadId)
+				{
+					for (size_t c = threadId; c < numCells; c += numWorkers) fn(c, c / numSlots, c % numSlots);
+				});
+				for (auto& r : res) r.get();
+			};
+
+			std::vector<size_t> cellSize(numCells);
+			std::vector<Vid> minVid(numCells, (Vid)-1), maxVid(numCells, 0);
+			forEachCell([&](size_t c, size_t slot, size_t block)
+			{
+				for (size_t d = slot; d < numDocs; d += numSlots)
+				{
+					auto& words = docFirst[d].words;
+					const auto r = tokenRange(block, d);
+					for (size_t j = r.first; j < r.second && words[j] < this->realV; ++j)
+					{
+						minVid[c] = std::min(minVid[c], words[j]);
+						maxVid[c] = std::max(maxVid[c], words[j]);
+						++cellSize[c];
+					}
+				}
+			});
+
+			idx.cellOffset.resize(numCells + 1);
+			idx.cellOffset[0] = 0;
+			for (size_t c = 0; c < numCells; ++c) idx.cellOffset[c + 1] = idx.cellOffset[c] + cellSize[c];
+			idx.docOf.resize(idx.cellOffset.back());
+			idx.posOf.resize(idx.cellOffset.back());
+			forEachCell([&](size_t c, size_t slot, size_t block)
+			{
+				if (!cellSize[c]) return;
+				std::vector<size_t> pos(maxVid[c] - minVid[c] + 1);
+				for (size_t d = slot; d < numDocs; d += numSlots)
+				{
+					auto& words = docFirst[d].words;
+					const auto r = tokenRange(block, d);
+					for (size_t j = r.first; j < r.second && words[j] < this->realV; ++j) ++pos[words[j] - minVid[c]];
+				}
+				size_t acc = idx.cellOffset[c];
+				for (auto& p : pos)
+				{
+					const size_t n = p;
+					p = acc;
+					acc += n;
+				}
+				for (size_t d = slot; d < numDocs; d += numSlots)
+				{
+					auto& words = docFirst[d].words;
+					const auto r = tokenRange(block, d);
+					for (size_t j = r.first; j < r.second && words[j] < this->realV; ++j)
+					{
+						const size_t t = pos[words[j] - minVid[c]]++;
+						idx.docOf[t] = (uint32_t)d;
+						idx.posOf[t] = (uint32_t)j;
+					}
+				}
+			});
+			idx.numSlots = numSlots;
+			idx.numDocs = numDocs;
+		}
+
+		template<typename _DocIter, typename _ExtraDocData>
+		void updateWordMajorIndex(ThreadPool& pool, _DocIter docFirst, size_t numDocs, size_t numSlots, const _ExtraDocData& edd, std::false_type) const
+		{
+		}
+
+		/*
+		samples the tokens of a cell of `wordMajorIndex`, so that all occurrences of a vocabulary are sampled in turn
+		while its column of `numByTopicWord` stays in the cache. It is the same Gibbs sampling as `sampleTokens` in another order.
+		*/
+		template<typename _DocIter>
+		void sampleCellWordMajor(_DocIter docFirst, size_t cell, _ModelState& ld, _RandGen& rgs, std::true_type) const
+		{
+			auto& idx = wordMajorIndex;
+			BufferedUniformGen<_RandGen> bufRgs{ rgs, ld.uniforms };
+			refreshInvTopicDenom(ld);
+			for (size_t t = idx.cellOffset[cell]; t < idx.cellOffset[cell + 1]; ++t)
+			{
+				const size_t docId = idx.docOf[t], w = idx.posOf[t];
+				auto& doc = docFirst[docId];
+				const Vid vid = doc.words[w];
+				addWordTo<-1>(ld, doc, w, vid, doc.Zs[w]);
+				Float* dist = useAsymEta(vid) ? getZLikelihoods<true>(ld, doc, docId, vid) : getZLikelihoods<false>(ld, doc, docId, vid);
+				doc.Zs[w] = sample::sampleFromDiscreteAcc(dist, dist + K, bufRgs);
+				addWordTo<1>(ld, doc, w, vid, doc.Zs[w]);
+			}
+		}
+
+		template<typename _DocIter>
+		void sampleCellWordMajor(_DocIter docFirst, size_t cell, _ModelState& ld, _RandGen& rgs, std::false_type) const
+		{
+		}
+
+		template<ParallelScheme _ps>
+		size_t estimateMaxThreads() const
+		{
+			if (_ps == ParallelScheme::partition)
+			{
+				return (this->realV + 3) / 4;
+			}
+			if (_ps == ParallelScheme::copy_merge || _ps == ParallelScheme::async || _ps == ParallelScheme::hierarchical)
+			{
+				return (this->docs.size() + 1) / 2;
+			}
+			return (size_t)-1;
+		}
+
+		template<ParallelScheme _ps>
+		void trainOne(ThreadPool& pool, _ModelState* localData, _RandGen* rgs, bool freeze_topics = false)
+		{
+			std::vector<std::future<void>> res;
+			auto& stats = this->trainingStats;
+			auto* trace = this->trace.get();
+			// adds the time since the last call to `phase`, and traces it as `name` while the tasks of the next phase are named `next`
+			auto last = std::chrono::steady_clock::now();
+			if (trace) trace->setPhase("sampling");
+			auto lap = [&](double& phase, const char* name, const char* next)
+			{
+				const auto now = std::chrono::steady_clock::now();
+				phase += std::chrono::duration<double>{ now - last }.count();
+				if (trace)
+				{
+					trace->record(0, name, "phase", -1, trace->toNanos(last), trace->toNanos(now));
+					trace->setPhase(next);
+				}
+				last = now;
+			};
+			try
+			{
+				prepareStability();
+				prepareProposalTables(&pool, true,
+					std::integral_constant<bool, DerivedClass::isSamplingMethodSupported(SamplingMethod::mh)>{}
+				);
+				static_cast<DerivedClass*>(this)->template performSampling<_ps, false>(pool, localData, rgs, res,
+					this->docs.begin(), this->docs.end(), eddTrain
+				);
+				lap(stats.sampling, "sampling", "merging");
+				static_cast<DerivedClass*>(this)->updateGlobalInfo(pool, localData);
+				static_cast<DerivedClass*>(this)->template mergeState<_ps>(pool, this->globalState, this->tState, localData, rgs, eddTrain);
+				if (deltaExchanger) exchangeTopicWordDelta(std::is_same<_Derived, void>{});
+				stats.mergeBytes += getMergeBytes<_ps>(pool);
+				lap(stats.merging, "merging", "global_sampling");
+				static_cast<DerivedClass*>(this)->template performSamplingGlobal<_ps, false>(&pool, this->globalState, rgs, 
+					this->docs.begin(), this->docs.end()
+				);
+				lap(stats.globalSampling, "global_sampling", "global_level");
+				
+				if(freeze_topics) static_cast<DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::freeze_topics>(
+					&pool, &this->globalState, rgs, this->docs.begin(), this->docs.end()
+				);
+				else static_cast<DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::train>(
+					&pool, &this->globalState, rgs, this->docs.begin(), this->docs.end()
+				);
+				lap(stats.globalLevel, "global_level", "distributing");
+
+				static_cast<DerivedClass*>(this)->template distributeMergedState<_ps>(pool, this->globalState, localData);
+				if (_ps == ParallelScheme::partition && partitionRebalanceInterval && (this->globalStep + 1) % partitionRebalanceInterval == 0
+					&& rebalanceVocabChunks(pool.getNumWorkers(), this->docs.begin(), this->docs.end(), eddTrain))
+				{
+					static_cast<DerivedClass*>(this)->updatePartition(pool, this->globalState, localData, this->docs.begin(), this->docs.end(), eddTrain);
+				}
+				lap(stats.distributing, "distributing", "optimizing");
+				
+				if (this->globalStep >= this->burnIn && optimInterval && (this->globalStep + 1) % optimInterval == 0)
+				{
+					static_cast<DerivedClass*>(this)->optimizeParameters(pool, localData, rgs);
+				}
+				lap(stats.optimizing, "optimizing", "task");
+				syncDuplicates();
+			}
+			catch (const exc::TrainingError&)
+			{
+				for (auto& r : res) if(r.valid()) r.get();
+				throw;
+			}
+		}
+
+		/*
+		the bytes of the workers' states which `mergeState` reads: the whole topic-word counts of every worker for ParallelScheme::copy_merge,
+		only the topic totals for ParallelScheme::partition, whose workers update the disjoint blocks of the global counts in place,
+		and the topic-word counts of every group for ParallelScheme::hierarchical.
+		*/
+		template<ParallelScheme _ps>
+		uint64_t getMergeBytes(ThreadPool& pool) const
+		{
+			auto& gs = this->globalState;
+			if (_ps == ParallelScheme::copy_merge)
+			{
+				return pool.getNumWorkers() * (gs.getTopicWordMemoryUsage() + K * sizeof(WeightType));
+			}
+			if (_ps == ParallelScheme::partition) return pool.getNumWorkers() * K * sizeof(WeightType);
+			if (_ps == ParallelScheme::hierarchical) return getNumGroups(pool.getNumWorkers()) * gs.getTopicWordMemoryUsage();
+			return 0;
+		}
+
+		void exchangeTopicWordDelta(std::false_type)
+		{
+		}
+
+		/*
+		exchanges the changes of numByTopicWord since the last exchange with other nodes of distributed training.
+		The changes are found from the words whose topics differ from `syncedZs`, so only the touched cells are visited.
+		Only the changes not smaller than `deltaThreshold` are sent, as (word, topic, count) triples,
+		and the rest stays in `topicWordResidual`, to be sent when it grows.
+		Then the deltas of the other nodes are added to the counts in place.
+		*/
+		void exchangeTopicWordDelta(std::true_type)
+		{
+			auto& gs = this->globalState;
+			if (gs.numByTopicWordTail.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"Distributed training doesn't support the hybrid topic-word storage");
+			if (sharedVidOf.size() != this->realV) mapSharedVocabs();
+
+			// words of the documents appended after the last exchange have no topic to be compared with, so all of them are sent
+			size_t pos = 0;
+			for (auto& doc : this->docs)
+			{
+				for (size_t i = 0; i < doc.Zs.size(); ++i, ++pos)
+				{
+					const Vid v = doc.words[i];
+					if (v >= this->realV) continue;
+					const Tid z = doc.Zs[i];
+					const bool known = pos < syncedZs.size();
+					if (known && syncedZs[pos] == z) continue;
+					const WeightType weight = (WeightType)getWordWeight(doc, i) * (WeightType)doc.multiplicity;
+					if (known) topicWordResidual[(uint64_t)v * K + syncedZs[pos]] -= weight;
+					topicWordResidual[(uint64_t)v * K + z] += weight;
+				}
+			}
+			syncedZs.resize(pos);
+			pos = 0;
+			for (auto& doc : this->docs)
+			{
+				std::copy(doc.Zs.begin(), doc.Zs.end(), syncedZs.begin() + pos);
+				pos += doc.Zs.size();
+			}
+
+			TopicWordDelta delta;
+			for (auto it = topicWordResidual.begin(); it != topicWordResidual.end();)
+			{
+				const WeightType d = it->second;
+				if (d && std::abs((Float)d) < deltaThreshold)
+				{
+					++it;
+					continue;
+				}
+				if (d)
+				{
+					const Vid v = (Vid)(it->first / K);
+					const Tid k = (Tid)(it->first % K);
+					delta.vids.emplace_back(sharedVidOf[v]);
+					delta.tids.emplace_back(k);
+					delta.counts.emplace_back((float)d);
+					// the change of this node comes back in the exchanged deltas, so it is taken out here not to be counted twice
+					gs.numByTopicWord(k, v) -= d;
+					gs.numByTopic[k] -= d;
+				}
+				it = topicWordResidual.erase(it);
+			}
+
+			TopicWordDelta all = deltaExchanger(std::move(delta));
+			if (all.vids.size() != all.tids.size() || all.vids.size() != all.counts.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"The exchanged delta has arrays of different lengths");
+			for (size_t i = 0; i < all.vids.size(); ++i)
+			{
+				if (all.vids[i] >= localVidOf.size() || all.tids[i] >= K) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+					text::format("The exchanged delta has a wrong entry (vid = %u, tid = %u)", all.vids[i], (uint32_t)all.tids[i]));
+				const WeightType c = _tw == TermWeight::one ? (WeightType)std::round(all.counts[i]) : (WeightType)all.counts[i];
+				gs.numByTopicWord(all.tids[i], localVidOf[all.vids[i]]) += c;
+				gs.numByTopic[all.tids[i]] += c;
+			}
+			if (gs.invTopicDenom.size()) refreshInvTopicDenom(gs);
+		}
+
+		// all nodes number their vocabularies differently, so they are translated through `sharedVocabs`
+		void mapSharedVocabs()
+		{
+			const size_t V = this->realV;
+			if (V != sharedVocabs.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				text::format("The model uses %zd vocabularies, but %zd are shared. Shared vocabularies should not be removed by the filters of `prepare`.",
+					V, sharedVocabs.size()));
+			sharedVidOf.assign(V, 0);
+			localVidOf.assign(V, non_vocab_id);
+			for (size_t i = 0; i < sharedVocabs.size(); ++i)
+			{
+				const Vid v = this->dict.toWid(sharedVocabs[i]);
+				if (v >= V || localVidOf[i] != non_vocab_id) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+					"The shared vocabulary '" + sharedVocabs[i] + "' is not used by the model or duplicated");
+				sharedVidOf[v] = i;
+				localVidOf[i] = v;
+			}
+		}
+
+		/*
+		updates global informations after sampling documents
+		ex) update new global K at HDP model
+		*/
+		void updateGlobalInfo(ThreadPool& pool, _ModelState* localData)
+		{
+		}
+
+		/*
+		merges numByTopicWord of all workers into globalState and updates numByTopic.
+		The vocabulary is split into contiguous column ranges, and each range is reduced over all workers by one task,
+		so neither a copy of the previous global state nor a serial pass over K * V on the calling thread is needed.
+		The tail vocabularies of the hybrid storage are merged in the same way, visiting only their non-zero counts.
+		*/
+		void mergeCountsByColumns(ThreadPool& pool, _ModelState& globalState, _ModelState* localData) const
+		{
+			const size_t numWorkers = pool.getNumWorkers();
+			const size_t K = globalState.numByTopicWord.rows(), V = globalState.numByTopicWord.cols();
+			const size_t tailV = globalState.numByTopicWordTail.size();
+			const size_t numChunks = std::max(std::min(numWorkers * 4, V), (size_t)1);
+			const size_t numTailChunks = std::min(numWorkers * 4, tailV);
+			Eigen::Matrix<WeightType, -1, -1> partialSums = Eigen::Matrix<WeightType, -1, -1>::Zero(K, numChunks + numTailChunks);
+
+			std::vector<std::future<void>> res;
+			for (size_t c = 0; c < numChunks; ++c)
+			{
+				res.emplace_back(pool.enqueue([&, c](size_t)
+				{
+					const size_t b = V * c / numChunks, e = V * (c + 1) / numChunks;
+					auto global = globalState.numByTopicWord.middleCols(b, e - b);
+					Eigen::Matrix<WeightType, -1, -1> merged = localData[0].numByTopicWord.middleCols(b, e - b);
+					for (size_t i = 1; i < numWorkers; ++i)
+					{
+						merged += localData[i].numByTopicWord.middleCols(b, e - b) - global;
+					}
+
+					// make all count being positive
+					if (_tw != TermWeight::one)
+					{
+						merged = merged.cwiseMax(0);
+					}
+					global = merged;
+					partialSums.col(c) = merged.rowwise().sum();
+				}));
+			}
+
+			for (size_t c = 0; c < numTailChunks; ++c)
+			{
+				res.emplace_back(pool.enqueue([&, c](size_t)
+				{
+					const Vid offset = globalState.numByTopicWordTail.offset;
+					const Vid b = offset + tailV * c / numTailChunks, e = offset + tailV * (c + 1) / numTailChunks;
+					std::vector<WeightType> acc(K);
+					std::vector<char> seen(K);
+					std::vector<Tid> touched;
+					auto accumulate = [&](const typename SparseTopicWordCounts<WeightType>::Column& col, WeightType scale)
+					{
+						for (auto& en : col)
+						{
+							if (!seen[en.topic]) touched.emplace_back(en.topic);
+							seen[en.topic] = 1;
+							acc[en.topic] += en.count * scale;
+						}
+					};
+
+					for (Vid v = b; v < e; ++v)
+					{
+						auto& global = globalState.numByTopicWordTail.col(v);
+						for (size_t i = 0; i < numWorkers; ++i) accumulate(localData[i].numByTopicWordTail.col(v), 1);
+						accumulate(global, -(WeightType)(numWorkers - 1));
+						global.clear();
+						for (auto k : touched)
+						{
+							// make all count being positive
+							if (acc[k] > 0)
+							{
+								global.emplace_back(typename SparseTopicWordCounts<WeightType>::Entry{ k, acc[k] });
+								partialSums(k, numChunks + c) += acc[k];
+							}
+							acc[k] = 0;
+							seen[k] = 0;
+						}
+						touched.clear();
+					}
+				}));
+			}
+			for (auto& r : res) r.get();
+			globalState.numByTopic = partialSums.rowwise().sum();
+		}
+
+		/*
+		merges multithreaded document sampling result
+		*/
+		template<ParallelScheme _ps, typename _ExtraDocData>
+		void mergeState(ThreadPool& pool, _ModelState& globalState, _ModelState& tState, _ModelState* localData, _RandGen*, const _ExtraDocData& edd) const
+		{
+			if (_ps == ParallelScheme::copy_merge)
+			{
+				mergeCountsByColumns(pool, globalState, localData);
+			}
+			else if (_ps == ParallelScheme::partition)
+			{
+				// the blocks are already merged by the workers of a pipelined sampling
+				if (pipelinedIteration && &globalState == &this->globalState)
+				{
+					globalState.numByTopic = blockTopicSums.rowwise().sum();
+				}
+				else
+				{
+					// make all count being positive
+					if (_tw != TermWeight::one)
+					{
+						globalState.numByTopicWord.matrix() = globalState.numByTopicWord.cwiseMax(0);
+					}
+					globalState.numByTopic = globalState.numByTopicWord.rowwise().sum();
+				}
+				for (auto& col : globalState.numByTopicWordTail.columns())
+				{
+					for (auto& e : col) globalState.numByTopic[e.topic] += e.count;
+				}
+			}
+			// all workers have pushed their changes into the shared counts at the end of performSampling
+			else if (_ps == ParallelScheme::async)
+			{
+				if (asyncRecountInterval && (this->globalStep + 1) % asyncRecountInterval == 0)
+				{
+					recountSharedStatistics(AsyncSupported{});
+				}
+			}
+			else if (_ps == ParallelScheme::hierarchical)
+			{
+				mergeGroupStates(pool, globalState, localData, HierarchicalSupported{});
+			}
+		}
+
+		/*
+		merges the copies of the groups of ParallelScheme::hierarchical, which follow the states of the workers,
+		as ParallelScheme::copy_merge merges those of the workers. Each worker merges its own range of columns.
+		*/
+		void mergeGroupStates(ThreadPool& pool, _ModelState& globalState, _ModelState* localData, std::true_type) const
+		{
+			const size_t numWorkers = pool.getNumWorkers(), numGroups = getNumGroups(numWorkers);
+			const _ModelState* groupStates = localData + numWorkers;
+			const size_t cols = globalState.numByTopicWord.cols();
+			std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t threadId)
+			{
+				const size_t b = cols * threadId / numWorkers, e = cols * (threadId + 1) / numWorkers;
+				if (b >= e) return;
+				auto merged = globalState.numByTopicWord.middleCols(b, e - b);
+				merged *= -(WeightType)(numGroups - 1);
+				for (size_t g = 0; g < numGroups; ++g) merged += groupStates[g].numByTopicWord.middleCols(b, e - b);
+				// make all count being positive
+				if (_tw != TermWeight::one) merged = merged.cwiseMax(0);
+			});
+			for (auto& r : res) r.get();
+			globalState.numByTopic = globalState.numByTopicWord.rowwise().sum();
+		}
+
+		void mergeGroupStates(ThreadPool& pool, _ModelState& globalState, _ModelState* localData, std::false_type) const
+		{
+		}
+
+		template<ParallelScheme _ps>
+		void distributeMergedState(ThreadPool& pool, _ModelState& globalState, _ModelState* localData) const
+		{
+			std::vector<std::future<void>> res;
+			if (_ps == ParallelScheme::copy_merge)
+			{
+				if (pool.isNumaAware())
+				{
+					// keep each worker's copy on the node where the worker allocated it
+					res = pool.enqueueToAll([&](size_t threadId)
+					{
+						localData[threadId] = globalState;
+					});
+				}
+				else
+				{
+					for (size_t i = 0; i < pool.getNumWorkers(); ++i)
+					{
+						res.emplace_back(pool.enqueue([&, i](size_t)
+						{
+							localData[i] = globalState;
+						}));
+					}
+				}
+			}
+			// the workers of a pipelined sampling take the topic totals when they start the next one
+			else if (_ps == ParallelScheme::partition && pipelinedIteration && &globalState == &this->globalState)
+			{
+				pipelinedIteration = false;
+			}
+			else if (_ps == ParallelScheme::partition || _ps == ParallelScheme::async)
+			{
+				res = pool.enqueueToAll([&](size_t threadId)
+				{
+					localData[threadId].numByTopic = globalState.numByTopic;
+				});
+			}
+			else if (_ps == ParallelScheme::hierarchical)
+			{
+				distributeGroupStates(pool, globalState, localData, HierarchicalSupported{});
+			}
+			for (auto& r : res) r.get();
+		}
+
+		// the workers keep viewing the copies of their groups, so the merged counts are copied into them in place
+		void distributeGroupStates(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, std::true_type) const
+		{
+			const size_t numWorkers = pool.getNumWorkers(), numGroups = getNumGroups(numWorkers);
+			const size_t cols = globalState.numByTopicWord.cols();
+			std::vector<std::future<void>> res = pool.enqueueToAll([&](size_t threadId)
+			{
+				const size_t b = cols * threadId / numWorkers, e = cols * (threadId + 1) / numWorkers;
+				for (size_t g = 0; b < e && g < numGroups; ++g)
+				{
+					localData[numWorkers + g].numByTopicWord.middleCols(b, e - b) = globalState.numByTopicWord.middleCols(b, e - b);
+				}
+				localData[threadId].numByTopic = globalState.numByTopic;
+			});
+			for (auto& r : res) r.get();
+		}
+
+		void distributeGroupStates(ThreadPool& pool, const _ModelState& globalState, _ModelState* localData, std::false_type) const
+		{
+		}
+
+		/*
+		performs sampling which needs global state modification
+		ex) document pathing at hLDA model
+		* if pool is nullptr, workers has been already pooled and cannot branch works more.
+		*/
+		template<GlobalSampler _gs, typename _DocIter>
+		void sampleGlobalLevel(ThreadPool* pool, _ModelState* localData, _RandGen* rgs, _DocIter first, _DocIter last) const
+		{
+		}
+
+		template<typename _DocIter>
+		double getLLDocs(_DocIter _first, _DocIter _last) const
+		{
+			double ll = 0;
+			const Float alphaSum = alphas.sum();
+			// doc-topic distribution
+			for (; _first != _last; ++_first)
+			{
+				auto& doc = *_first;
+				ll -= math::lgammaSubt(alphaSum, (Float)doc.getSumWordWeight());
+				ll += Eigen::lgamma_subt(alphas.array(), doc.numByTopic.array().template cast<Float>()).sum();
+			}
+			return ll;
+		}
+
+		// sums `fn(b, e)` over fixed-size chunks [b, e) of [0, n), so the result doesn't depend on the number of workers
+		template<typename _Fn>
+		static double sumChunks(ThreadPool* pool, size_t n, size_t chunkSize, _Fn&& fn)
+		{
+			const size_t numChunks = (n + chunkSize - 1) / chunkSize;
+			std::vector<double> lls(numChunks);
+			if (pool && numChunks > 1)
+			{
+				std::vector<std::future<void>> res;
+				for (size_t i = 0; i < numChunks; ++i)
+				{
+					res.emplace_back(pool->enqueue([&, i](size_t)
+					{
+						lls[i] = fn(i * chunkSize, std::min((i + 1) * chunkSize, n));
+					}));
+				}
+				for (auto& r : res) r.get();
+			}
+			else
+			{
+				for (size_t i = 0; i < numChunks; ++i) lls[i] = fn(i * chunkSize, std::min((i + 1) * chunkSize, n));
+			}
+			return std::accumulate(lls.begin(), lls.end(), 0.);
+		}
+
+		// the terms of getLLRest except those of the dense topic-word counts
+		double getLLRestByTopic(const _ModelState& ld) const
+		{
+			double ll = 0;
+			for (Tid k = 0; k < K; ++k)
+			{
+				const Float etasum = getTopicEtaSum(k);
+				ll += math::lgammaT(etasum) - math::lgammaT(ld.numByTopic[k] + etasum);
+			}
+			// the hybrid storage is not used with word priors, so the tail vocabularies have `eta`
+			for (auto& col : ld.numByTopicWordTail.columns())
+			{
+				for (auto& e : col) ll += math::lgammaSubt(eta, (Float)e.count);
+			}
+			return ll;
+		}
+
+		// the columns of topic-word counts are evaluated in parallel by `pool` if given
+		double getLLRest(const _ModelState& ld, ThreadPool* pool = nullptr) const
+		{
+			double ll = getLLRestByTopic(ld);
+			const size_t V = this->realV;
+			// topic-word distribution, where the vocabularies with their own priors are corrected after all are evaluated with `eta`
+			const size_t denseV = std::min((size_t)ld.numByTopicWord.cols(), V);
+			ll += sumChunks(pool, denseV, llChunkVocabs, [&](size_t b, size_t e)
+			{
+				return (double)Eigen::lgamma_subt(Eigen::Array<Float, -1, -1>::Constant(K, e - b, eta),
+					ld.numByTopicWord.middleCols(b, e - b).array().template cast<Float>()).sum();
+			});
+			for (size_t c = 0; c < priorWords.size(); ++c)
+			{
+				auto cnt = ld.numByTopicWord.col(priorWords[c]).array().template cast<Float>();
+				ll += (double)(Eigen::lgamma_subt(etaByTopicWord.col(c).array(), cnt) 
+					- Eigen::lgamma_subt(Eigen::Array<Float, -1, 1>::Constant(K, eta), cnt)).sum();
+			}
+			return ll;
+		}
+
+		/*
+		returns `getLLRest(ld) - gllRest`, where `ld` differs from the global state only by the words of `doc`
+		and `gllRest` is `getLLRest(globalState)`. Plain LDA evaluates only the columns of those words.
+		*/
+		double getLLRestDelta(const _ModelState& ld, const _DocType& doc, double gllRest) const
+		{
+			return _getLLRestDelta(ld, doc, gllRest, std::integral_constant<bool, 
+				std::is_same<_Derived, void>::value && DerivedClass::hasDocLocalInferenceState()
+			>{});
+		}
+
+		double _getLLRestDelta(const _ModelState& ld, const _DocType& doc, double gllRest, std::false_type) const
+		{
+			return static_cast<const DerivedClass*>(this)->getLLRest(ld) - gllRest;
+		}
+
+		double _getLLRestDelta(const _ModelState& ld, const _DocType& doc, double gllRest, std::true_type) const
+		{
+			const size_t V = this->realV;
+			auto& gs = this->globalState;
+			std::vector<Vid> ws;
+			for (auto w : doc.words) if (w < V) ws.emplace_back(w);
+			std::sort(ws.begin(), ws.end());
+			ws.erase(std::unique(ws.begin(), ws.end()), ws.end());
+
+			double ll = 0;
+			for (Tid k = 0; k < K; ++k)
+			{
+				const Float etasum = getTopicEtaSum(k);
+				ll -= math::lgammaT(ld.numByTopic[k] + etasum) - math::lgammaT(gs.numByTopic[k] + etasum);
+				for (auto v : ws)
+				{
+					const Float e = etaByTopicWord.size() ? getWordPriorCol(v)[k] : eta;
+					ll += math::lgammaT(ld.getTopicWordCount(k, v) + e) - math::lgammaT(gs.getTopicWordCount(k, v) + e);
+				}
+			}
+			return ll;
+		}
+
+		/*
+		returns the same value as getLL, but updates the cached sums of lgamma only by the counts changed since the last call.
+		The cache is rebuilt from scratch when the numbers of documents, topics or vocabularies, or the priors have changed.
+		*/
+		double getLLIncremental(ThreadPool* pool) const
+		{
+			auto& gs = this->globalState;
+			const size_t numDocs = this->docs.size() - getNumNewDocs();
+			const size_t denseV = std::min((size_t)gs.numByTopicWord.cols(), (size_t)this->realV);
+			if ((size_t)llDocCounts.cols() != numDocs || (size_t)llDocCounts.rows() != K || (size_t)llWordCounts.cols() != denseV
+				|| llAlphas.size() != alphas.size() || llAlphas != alphas || llEta != eta)
+			{
+				llDocCounts = Eigen::Matrix<WeightType, -1, -1>::Zero(K, numDocs);
+				llWordCounts = Eigen::Matrix<WeightType, -1, -1>::Zero(K, denseV);
+				llAlphas = alphas;
+				llEta = eta;
+				llWordSum = 0;
+				llDocSum = 0;
+				const Float alphaSum = alphas.sum();
+				for (size_t i = 0; i < numDocs; ++i) llDocSum -= math::lgammaSubt(alphaSum, (Float)this->docs[i].getSumWordWeight());
+			}
+
+			// lgamma(n + z) - lgamma(z), which is exactly 0 if n is 0
+			auto lgammaDiff = [](Float z, WeightType n) -> double
+			{
+				return n ? math::lgammaSubt(z, (Float)n) : 0;
+			};
+			llDocSum += sumChunks(pool, numDocs, llChunkDocs, [&](size_t b, size_t e)
+			{
+				double d = 0;
+				for (size_t i = b; i < e; ++i)
+				{
+					auto& doc = this->docs[i];
+					auto cached = llDocCounts.col(i);
+					for (Tid k = 0; k < K; ++k)
+					{
+						if (doc.numByTopic[k] == cached[k]) continue;
+						d += lgammaDiff(alphas[k], doc.numByTopic[k]) - lgammaDiff(alphas[k], cached[k]);
+						cached[k] = doc.numByTopic[k];
+					}
+				}
+				return d;
+			});
+			llWordSum += sumChunks(pool, denseV, llChunkVocabs, [&](size_t b, size_t e)
+			{
+				double d = 0;
+				for (size_t v = b; v < e; ++v)
+				{
+					auto cached = llWordCounts.col(v);
+					const Float* priors = hasOwnPrior(v) ? getWordPriorCol(v).data() : nullptr;
+					for (Tid k = 0; k < K; ++k)
+					{
+						const WeightType n = gs.numByTopicWord(k, v);
+						if (n == cached[k]) continue;
+						const Float z = priors ? priors[k] : eta;
+						d += lgammaDiff(z, n) - lgammaDiff(z, cached[k]);
+						cached[k] = n;
+					}
+				}
+				return d;
+			});
+			return llDocSum + llWordSum + getLLRestByTopic(gs);
+		}
+
+		double _getLLIncremental(ThreadPool* pool, std::false_type) const
+		{
+			return 0;
+		}
+
+		double _getLLIncremental(ThreadPool* pool, std::true_type) const
+		{
+			return getLLIncremental(pool);
+		}
+
+		double _getLLRest(ThreadPool* pool, std::false_type) const
+		{
+			return static_cast<const DerivedClass*>(this)->getLLRest(this->globalState);
+		}
+
+		double _getLLRest(ThreadPool* pool, std::true_type) const
+		{
+			return getLLRest(this->globalState, pool);
+		}
+
+		/*
+		The documents and the topic-word counts are evaluated in parallel by the pool of the last training.
+		If `llSampleDocs` is set, only that many documents sampled at random are evaluated and their sum is scaled up to all documents.
+		`incrementalLL` takes precedence over it.
+		The sample is the same for every call as long as the number of documents doesn't change.
+		*/
+		double getLL() const
+		{
+			// documents added after `prepare` have no topics until they are prepared
+			const size_t numDocs = this->docs.size() - getNumNewDocs();
+			ThreadPool* pool = this->cachedPool && this->cachedPool->getNumWorkers() > 1 ? this->cachedPool.get() : nullptr;
+			if (incrementalLL) return _getLLIncremental(pool, std::is_same<_Derived, void>{});
+			double ll;
+			if (llSampleDocs && llSampleDocs < numDocs)
+			{
+				// Floyd's algorithm draws the sample in O(llSampleDocs)
+				std::mt19937_64 rng{ numDocs };
+				std::vector<char> picked(numDocs);
+				for (size_t j = numDocs - llSampleDocs; j < numDocs; ++j)
+				{
+					const size_t t = std::uniform_int_distribution<size_t>{ 0, j }(rng);
+					picked[picked[t] ? j : t] = 1;
+				}
+				std::vector<size_t> sample;
+				for (size_t i = 0; i < numDocs; ++i) if (picked[i]) sample.emplace_back(i);
+				ll = sumChunks(pool, sample.size(), llChunkDocs, [&](size_t b, size_t e)
+				{
+					double s = 0;
+					for (size_t i = b; i < e; ++i)
+					{
+						auto doc = this->docs.begin() + sample[i];
+						s += static_cast<const DerivedClass*>(this)->getLLDocs(doc, doc + 1);
+					}
+					return s;
+				}) * numDocs / sample.size();
+			}
+			else
+			{
+				ll = sumChunks(pool, numDocs, llChunkDocs, [&](size_t b, size_t e)
+				{
+					return static_cast<const DerivedClass*>(this)->getLLDocs(this->docs.begin() + b, this->docs.begin() + e);
+				});
+			}
+			return ll + _getLLRest(pool, std::is_same<_Derived, void>{});
+		}
+
+		void prepareShared()
+		{
+			auto txZs = [](_DocType& doc) { return &doc.Zs; };
+			tvector<Tid>::trade(sharedZs, 
+				makeTransformIter(this->docs.begin(), txZs),
+				makeTransformIter(this->docs.end(), txZs));
+			if (_tw != TermWeight::one && !usesSharedWordWeights())
+			{
+				auto txWeights = [](_DocType& doc) { return &doc.wordWeights; };
+				tvector<Float>::trade(sharedWordWeights,
+					makeTransformIter(this->docs.begin(), txWeights),
+					makeTransformIter(this->docs.end(), txWeights));
+			}
+		}
+
+		// serializes `copy` of the models sharing arrays, which converts the source model and flips `external` of its counts meanwhile
+		static std::mutex& getShareMutex()
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
+
+		/*
+		moves the arrays of the documents and the topic-word counts into `sharedArrays`, which copies of the model share instead of copying them.
+		Moving keeps the buffers in place, so the documents still view them.
+		*/
+		void shareArrays()
+		{
+			_shareArrays(std::is_same<_Derived, void>{});
+		}
+
+		void _shareArrays(std::false_type)
+		{
+		}
+
+		void _shareArrays(std::true_type)
+		{
+			auto& tw = this->globalState.numByTopicWord;
+			if (sharedArrays || docsOutOfCore || this->mappedFile || this->words.empty()) return;
+			if (tw.external || tw.ownData.data() != tw.data()) return;
+			// spare columns reserved by `growCols` are dropped first, so that the shared matrix has the exact shape
+			if (tw.ownData.cols() != tw.cols())
+			{
+				Eigen::Matrix<WeightType, -1, -1> exact = tw;
+				tw.replaceData(std::move(exact));
+			}
+
+			auto arrays = std::make_shared<SharedArrays>();
+			arrays->words = std::move(this->words);
+			arrays->Zs = std::move(sharedZs);
+			arrays->wordWeights = std::move(sharedWordWeights);
+			arrays->numByTopicDoc = std::move(numByTopicDoc);
+			const auto rows = tw.rows(), cols = tw.cols();
+			arrays->numByTopicWord = std::move(tw.ownData);
+			this->words = {};
+			sharedZs = {};
+			sharedWordWeights = {};
+			numByTopicDoc.resize(0, 0);
+			// like the state in a mapped file, scratch copies of the state made by inference own their counts
+			tw.init(arrays->numByTopicWord.data(), rows, cols);
+			tw.external = true;
+			sharedArrays = std::move(arrays);
+		}
+
+		/*
+		gives the model its own copies of the arrays in `sharedArrays`. It should be called before the model modifies them.
+		The last model sharing them takes them over without copying.
+		*/
+		void detachShared()
+		{
+			_detachShared(std::is_same<_Derived, void>{});
+		}
+
+		void _detachShared(std::false_type)
+		{
+		}
+
+		void _detachShared(std::true_type)
+		{
+			if (!sharedArrays) return;
+			auto arrays = std::move(sharedArrays);
+			auto& tw = this->globalState.numByTopicWord;
+			if (arrays.use_count() == 1)
+			{
+				this->words = std::move(arrays->words);
+				sharedZs = std::move(arrays->Zs);
+				sharedWordWeights = std::move(arrays->wordWeights);
+				numByTopicDoc = std::move(arrays->numByTopicDoc);
+				tw.replaceData(std::move(arrays->numByTopicWord));
+			}
+			else
+			{
+				this->words = arrays->words;
+				sharedZs = arrays->Zs;
+				sharedWordWeights = arrays->wordWeights;
+				numByTopicDoc = arrays->numByTopicDoc;
+				tw.becomeOwner();
+			}
+			// the documents are bound to the own arrays the same way as those of a copied model
+			updateForCopy();
+		}
+
+		void updateForCopy()
+		{
+			// the copied documents keep viewing the shared arrays
+			if (sharedArrays) return;
+			if (docsOutOfCore)
+			{
+				// the copied documents still view the files of the original model, so the copy moves them into its own files
+				moveDocsOutOfCore();
+				return;
+			}
+			BaseClass::updateForCopy();
+			size_t offset = 0;
+			for (auto& doc : this->docs)
+			{
+				if (doc.words.isOwner()) continue;
+				size_t size = doc.Zs.size();
+				doc.Zs = tvector<Tid>{ sharedZs.data() + offset, size };
+				if (_tw != TermWeight::one && !usesSharedWordWeights())
+				{
+					doc.wordWeights = tvector<Float>{ sharedWordWeights.data() + offset, size };
+				}
+				offset += size;
+			}
+
+			// the copied documents still view the topic counts of the original model
+			if (hasContinuousDocData() && (size_t)numByTopicDoc.cols() + getNumNewDocs() == this->docs.size())
+			{
+				size_t docId = 0;
+				for (auto& doc : this->docs)
+				{
+					if (doc.numByTopic.size()) doc.numByTopic.init(getTopicDocPtr(docId), K, 1);
+					++docId;
+				}
+			}
+		}
+		
+		/*
+		returns true if the topic counts of the documents are columns of `numByTopicDoc`, instead of separate allocations.
+		Derived models may resize or redirect the counts of each document, so only plain LDA does it without `flags::continuous_doc_data`.
+		*/
+		static constexpr bool hasContinuousDocData()
+		{
+			return (m_flags & flags::continuous_doc_data) || std::is_same<_Derived, void>::value;
+		}
+
+		WeightType* getTopicDocPtr(size_t docId) const
+		{
+			if (!hasContinuousDocData() || docId == (size_t)-1) return nullptr;
+			if (outOfCore && !numByTopicDoc.size()) return outOfCore->numByTopicDoc.data() + K * docId;
+			return (WeightType*)numByTopicDoc.col(docId).data();
+		}
+
+		/*
+		moves the words, topics, weights and topic counts of all documents into new temporary files in `outOfCoreDir`,
+		so that the OS keeps in memory only the pages being sampled, along with the topic-word counts.
+		The documents may view the arrays of the model, its old files or the files of the model it was copied from.
+		*/
+		void moveDocsOutOfCore()
+		{
+			auto arrays = std::make_unique<OutOfCoreArrays>(outOfCoreDir);
+			auto txWords = [](_DocType& doc) { return &doc.words; };
+			tvector<Vid>::trade(arrays->words,
+				makeTransformIter(this->docs.begin(), txWords),
+				makeTransformIter(this->docs.end(), txWords));
+			auto txZs = [](_DocType& doc) { return &doc.Zs; };
+			tvector<Tid>::trade(arrays->Zs,
+				makeTransformIter(this->docs.begin(), txZs),
+				makeTransformIter(this->docs.end(), txZs));
+			if (_tw != TermWeight::one && !usesSharedWordWeights())
+			{
+				auto txWeights = [](_DocType& doc) { return &doc.wordWeights; };
+				tvector<Float>::trade(arrays->wordWeights,
+					makeTransformIter(this->docs.begin(), txWeights),
+					makeTransformIter(this->docs.end(), txWeights));
+			}
+			arrays->numByTopicDoc.resize(K * this->docs.size());
+			size_t docId = 0;
+			for (auto& doc : this->docs)
+			{
+				WeightType* ptr = arrays->numByTopicDoc.data() + K * docId++;
+				if (!doc.numByTopic.size()) continue;
+				Eigen::Map<Eigen::Matrix<WeightType, -1, 1>>{ ptr, K } = doc.numByTopic;
+				doc.numByTopic.init(ptr, K, 1);
+			}
+
+			outOfCore = std::move(arrays);
+			docsOutOfCore = true;
+			this->words = std::vector<Vid>{};
+			sharedZs = std::vector<Tid>{};
+			sharedWordWeights = std::vector<Float>{};
+			numByTopicDoc.resize(0, 0);
+		}
+
+		// moves the arrays of all documents from the temporary files back into memory
+		void moveDocsIntoMemory()
+		{
+			auto txWords = [](_DocType& doc) { return &doc.words; };
+			tvector<Vid>::trade(this->words,
+				makeTransformIter(this->docs.begin(), txWords),
+				makeTransformIter(this->docs.end(), txWords));
+			prepareShared();
+			numByTopicDoc.resize(K, this->docs.size());
+			size_t docId = 0;
+			for (auto& doc : this->docs)
+			{
+				if (doc.numByTopic.size())
+				{
+					numByTopicDoc.col(docId) = doc.numByTopic;
+					doc.numByTopic.init(numByTopicDoc.col(docId).data(), K, 1);
+				}
+				++docId;
+			}
+
+			outOfCore.reset();
+			docsOutOfCore = false;
+		}
+
+		/*
+		* called only when initializing a new doc, not when loading from saved model
+		*/
+		void prepareDoc(_DocType& doc, size_t docId, size_t wordSize) const
+		{
+			sortAndWriteOrder(doc.words, doc.wOrder);
+			doc.numByTopic.init(getTopicDocPtr(docId), K, 1);
+			doc.Zs = tvector<Tid>(wordSize, non_topic_id);
+			if(_tw != TermWeight::one && !usesSharedWordWeights()) doc.wordWeights = tvector<Float>(wordSize, 0);
+			doc.wordTf.clear();
+			updateWordTf(doc);
+		}
+
+		/*
+		fills `wordTf` of a document of TermWeight::pmi whose weights are not stored, see `getWordWeight`.
+		The words of a prepared document are sorted, so the frequency of a word is the length of its run.
+		*/
+		void updateWordTf(_DocType& doc) const
+		{
+			if (_tw != TermWeight::pmi || !usesSharedWordWeights() || doc.wordTf.size() == doc.words.size()) return;
+			doc.wordTf.resize(doc.words.size());
+			for (size_t b = 0, e; b < doc.words.size(); b = e)
+			{
+				for (e = b + 1; e < doc.words.size() && doc.words[e] == doc.words[b]; ++e);
+				std::fill(doc.wordTf.begin() + b, doc.wordTf.begin() + e, (uint16_t)std::min(e - b, (size_t)0xFFFF));
+			}
+		}
+
+		/*
+		returns true if the weights are not stored per token, but computed from the vocabulary by `getWordWeight`.
+		Derived models read `wordWeights` directly, so only plain LDA supports it.
+		*/
+		bool usesSharedWordWeights() const
+		{
+			return compact && _tw != TermWeight::one && std::is_same<_Derived, void>::value;
+		}
+
+		void updateSumWordWeight(_DocType& doc) const
+		{
+			doc.updateSumWordWeight(this->realV);
+			if (_tw == TermWeight::one || !doc.wordWeights.empty()) return;
+			// loaded documents have no `wordTf` yet
+			updateWordTf(doc);
+			Float sum = 0;
+			for (size_t i = 0; i < doc.words.size(); ++i)
+			{
+				if (doc.words[i] < this->realV) sum += getWordWeight(doc, i);
+			}
+			doc.sumWordWeight = sum;
+		}
+
+		/*
+		Only the vocabularies given their own priors have columns in `etaByTopicWord`, in the order of their ids,
+		so that the others stay on the symmetric path of sampling. `rows` is the number of topics the priors are given over.
+		*/
+		void buildWordPriors(size_t rows)
+		{
+			if (etaByWord.empty()) return;
+			priorWords.clear();
+			for (auto& it : etaByWord)
+			{
+				auto id = this->dict.toWid(it.first);
+				if (id == (Vid)-1 || id >= this->realV) continue;
+				priorWords.emplace_back(id);
+			}
+			std::sort(priorWords.begin(), priorWords.end());
+			etaByTopicWord.resize(rows, priorWords.size());
+			priorColByWord.assign(this->realV, (uint32_t)-1);
+			for (size_t c = 0; c < priorWords.size(); ++c)
+			{
+				auto& priors = etaByWord.find(this->dict.toWord(priorWords[c]))->second;
+				etaByTopicWord.col(c) = Eigen::Map<const Vector>{ priors.data(), (Eigen::Index)priors.size() };
+				priorColByWord[priorWords[c]] = c;
+			}
+			updateEtaSums(rows);
+		}
+
+		// it should be called whenever `eta` is changed
+		void updateEtaSums(size_t rows)
+		{
+			if (!etaByTopicWord.size()) return;
+			etaByTopicDefault = Vector::Constant(rows, eta);
+			etaSumByTopic = etaByTopicDefault * (Float)(this->realV - priorWords.size()) + etaByTopicWord.rowwise().sum();
+		}
+
+		void prepareWordPriors()
+		{
+			buildWordPriors(K);
+		}
+
+		void initGlobalState(bool initDocs)
+		{
+			const size_t V = this->realV;
+			this->globalState.zLikelihood = Vector::Zero(K);
+			if (initDocs)
+			{
+				this->globalState.numByTopic = Eigen::Matrix<WeightType, -1, 1>::Zero(K);
+				//this->globalState.numByTopicWord = Eigen::Matrix<WeightType, -1, -1>::Zero(K, V);
+				const size_t denseV = getNumDenseVocabs();
+				this->globalState.numByTopicWord.init(nullptr, K, denseV);
+				if (denseV < V) this->globalState.numByTopicWordTail.init(denseV, V - denseV);
+				else this->globalState.numByTopicWordTail = {};
+			}
+			else
+			{
+				updateTopicWordLayout();
+			}
+			if (hasContinuousDocData()) numByTopicDoc = Eigen::Matrix<WeightType, -1, -1>::Zero(K, this->docs.size());
+		}
+
+		/*
+		returns the number of vocabularies whose topic counts are stored densely.
+		The hybrid storage is used only by plain LDA without word priors, like the bucketed and MH samplers.
+		*/
+		size_t getNumDenseVocabs() const
+		{
+			const size_t V = this->realV;
+			if (!std::is_same<_Derived, void>::value || !etaByWord.empty() || !denseVocabSize) return V;
+			return std::min(denseVocabSize, V);
+		}
+
+		/*
+		moves the topic counts of globalState between numByTopicWord and numByTopicWordTail
+		so that the first `getNumDenseVocabs()` vocabularies, which are the most frequent ones, are stored densely
+		*/
+		void updateTopicWordLayout()
+		{
+			// derived models may have their own layouts of numByTopicWord
+			_updateTopicWordLayout(std::is_same<_Derived, void>{});
+			invalidateCaches();
+		}
+
+		void _updateTopicWordLayout(std::false_type)
+		{
+		}
+
+		void _updateTopicWordLayout(std::true_type)
+		{
+			auto& gs = this->globalState;
+			const size_t V = this->realV, denseV = getNumDenseVocabs(), curDenseV = gs.numByTopicWord.cols();
+			if (!gs.numByTopicWord.size() || curDenseV == denseV || curDenseV + gs.numByTopicWordTail.size() != V) return;
+			detachShared();
+
+			std::vector<typename SparseTopicWordCounts<WeightType>::Column> tail(V - denseV);
+			if (denseV < curDenseV)
+			{
+				for (size_t v = denseV; v < curDenseV; ++v)
+				{
+					auto& col = tail[v - denseV];
+					for (Tid k = 0; k < K; ++k)
+					{
+						if (gs.numByTopicWord(k, v) > 0) col.emplace_back(typename SparseTopicWordCounts<WeightType>::Entry{ k, gs.numByTopicWord(k, v) });
+					}
+				}
+				for (size_t v = curDenseV; v < V; ++v) tail[v - denseV] = std::move(gs.numByTopicWordTail.col(v));
+				gs.numByTopicWord.conservativeResize(K, denseV);
+			}
+			else
+			{
+				gs.numByTopicWord.conservativeResize(K, denseV);
+				for (size_t v = curDenseV; v < denseV; ++v)
+				{
+					gs.numByTopicWordTail.fillColumn(v, gs.numByTopicWord.col(v).data(), K);
+				}
+				for (size_t v = denseV; v < V; ++v) tail[v - denseV] = std::move(gs.numByTopicWordTail.col(v));
+			}
+			gs.numByTopicWordTail.init(denseV, 0);
+			gs.numByTopicWordTail.ownData = std::move(tail);
+		}
+
+		/*
+		makes the words, which first appear in the documents from `first`, used vocabularies if they pass the filters of `prepare`.
+		They are numbered right after the current used vocabularies, by frequency, and the removed vocabularies are moved behind them.
+		The words removed at `prepare` stay removed, so the documents prepared already keep their vocabularies and their order.
+		*/
+		void addNewVocabs(size_t first)
+		{
+			const size_t V = this->dict.size(), oldV = this->realV;
+			this->vocabCf.resize(V);
+			this->vocabDf.resize(V);
+			std::vector<Vid> added;
+			for (size_t v = numPreparedVocabs; v < V; ++v)
+			{
+				if (this->vocabCf[v] < this->minWordCf || this->vocabDf[v] < this->minWordDf) continue;
+				added.emplace_back(v);
+			}
+			if (added.empty()) return;
+			std::stable_sort(added.begin(), added.end(), [&](Vid a, Vid b)
+			{
+				return std::make_pair(this->vocabCf[a], this->vocabDf[a]) > std::make_pair(this->vocabCf[b], this->vocabDf[b]);
+			});
+
+			std::vector<Vid> order(V, non_vocab_id);
+			for (size_t i = 0; i < added.size(); ++i) order[added[i]] = oldV + i;
+			Vid next = 0;
+			for (size_t v = 0; v < V; ++v)
+			{
+				if (order[v] != non_vocab_id) continue;
+				if (next == oldV) next += added.size();
+				order[v] = next++;
+			}
+
+			std::vector<uint64_t> cf(V), df(V);
+			for (size_t v = 0; v < V; ++v)
+			{
+				cf[order[v]] = this->vocabCf[v];
+				df[order[v]] = this->vocabDf[v];
+			}
+			this->vocabCf.swap(cf);
+			this->vocabDf.swap(df);
+			this->dict.reorder(order);
+			this->forEachPrepareChunk(this->getNumPrepareThreads(this->docs.size()), this->docs.size(), [&](size_t, size_t, size_t b, size_t e)
+			{
+				for (size_t i = b; i < e; ++i)
+				{
+					for (auto& w : this->docs[i].words)
+					{
+						if (w >= oldV) w = order[w];
+					}
+				}
+			});
+			this->realV = oldV + added.size();
+		}
+
+		/*
+		adds the columns of the vocabularies appended by `addNewVocabs` to the topic-word counts.
+		They go to the dense columns, whose capacity grows geometrically, until the hybrid storage needs the tail.
+		*/
+		void growTopicWordCounts()
+		{
+			auto& gs = this->globalState;
+			const size_t V = this->realV;
+			if (gs.numByTopicWordTail.size())
+			{
+				gs.numByTopicWordTail.columns().resize(V - gs.numByTopicWordTail.offset);
+				return;
+			}
+			const size_t denseV = getNumDenseVocabs();
+			gs.numByTopicWord.growCols(denseV);
+			if (denseV < V) gs.numByTopicWordTail.init(denseV, V - denseV);
+		}
+
+		struct Generator
+		{
+			Eigen::Rand::DiscreteGen<int32_t> theta;
+			const Eigen::Matrix<Float, -1, -1>* warmPhi = nullptr;
+			Vector dist;
+		};
+
+		Generator makeGeneratorForInit(const _DocType*) const
+		{
+			Generator g;
+			g.theta = Eigen::Rand::DiscreteGen<int32_t>{ alphas.data(), alphas.data() + alphas.size() };
+			if (warmStartPhi.size()) g.warmPhi = &warmStartPhi;
+			return g;
+		}
+
+		/*
+		draws the initial topic of the i-th token from the topics of the tokens of the document drawn before it
+		and the topic-word distributions of the warm start, as a single sweep of inference against them.
+		The vocabularies unknown to the warm start have a flat distribution.
+		*/
+		Tid drawWarmTopic(Generator& g, _RandGen& rgs, const _DocType& doc, size_t i) const
+		{
+			const Vid w = doc.words[i];
+			if (hasOwnPrior(w)) return drawInitialTopic(g, rgs, w);
+			g.dist = (doc.numByTopic.array().template cast<Float>() + alphas.array()) * g.warmPhi->col(w).array();
+			sample::prefixSum(g.dist.data(), K);
+			return sample::sampleFromDiscreteAcc(g.dist.data(), g.dist.data() + K, rgs);
+		}
+
+		// aligns the topic-word distributions of `warmStart` to the vocabularies of this model by their words
+		void alignWarmStart()
+		{
+			const size_t V = this->realV;
+			warmStartPhi.resize(K, V);
+			for (size_t v = 0; v < V; ++v)
+			{
+				const Vid w = warmStart->dict.toWid(this->dict.toWord(v));
+				if (w < (size_t)warmStart->phi.cols()) warmStartPhi.col(v) = warmStart->phi.col(w);
+				else warmStartPhi.col(v).setConstant(1 / (Float)K);
+			}
+		}
+
+		Tid drawInitialTopic(Generator& g, _RandGen& rgs, Vid w) const
+		{
+			if (hasOwnPrior(w))
+			{
+				auto col = getWordPriorCol(w);
+				return sample::sampleFromDiscrete(col.data(), col.data() + col.size(), rgs);
+			}
+			// the others have a flat prior over the topics once any vocabulary has its own prior
+			if (etaByTopicWord.size()) return std::uniform_int_distribution<Tid>{ 0, (Tid)(K - 1) }(rgs);
+			return g.theta(rgs);
+		}
+
+		template<bool _Infer>
+		void updateStateWithDoc(Generator& g, _ModelState& ld, _RandGen& rgs, _DocType& doc, size_t i) const
+		{
+			auto w = doc.words[i];
+			auto z = doc.Zs[i] = drawInitialTopic(g, rgs, w);
+			addWordTo<1>(ld, doc, i, w, z);
+		}
+
+		template<bool _Infer, typename _Generator>
+		void sampleInitialTopic(std::false_type, _Generator& g, _ModelState& ld, _RandGen& rgs, _DocType& doc, size_t i) const
+		{
+			static_cast<const DerivedClass*>(this)->template updateStateWithDoc<_Infer>(g, ld, rgs, doc, i);
+		}
+
+		// counts the topic only in the document, so that documents can be initialized in parallel. see `initializeDocs`
+		template<bool _Infer>
+		void sampleInitialTopic(std::true_type, Generator& g, _ModelState&, _RandGen& rgs, _DocType& doc, size_t i) const
+		{
+			auto z = doc.Zs[i] = g.warmPhi ? drawWarmTopic(g, rgs, doc, i) : drawInitialTopic(g, rgs, doc.words[i]);
+			updateCnt<false>(doc.numByTopic[z], (WeightType)getWordWeight(doc, i));
+		}
+
+		template<bool _Infer, typename _Generator, typename _DocOnly = std::false_type>
+		void initializeDocState(_DocType& doc, size_t docId, _Generator& g, _ModelState& ld, _RandGen& rgs) const
+		{
+			std::vector<uint32_t> tf(_tw == TermWeight::pmi ? this->realV : 0);
+			static_cast<const DerivedClass*>(this)->prepareDoc(doc, docId, doc.words.size());
+			// a copy of a trained document is always sampled fully in inference
+			if (_Infer) doc.tokenStability = {};
+			_Generator g2;
+			_Generator* selectedG = &g;
+			if (m_flags & flags::generator_by_doc)
+			{
+				g2 = static_cast<const DerivedClass*>(this)->makeGeneratorForInit(&doc);
+				selectedG = &g2;
+			}
+			if (_tw == TermWeight::pmi)
+			{
+				std::fill(tf.begin(), tf.end(), 0);
+				for (auto& w : doc.words) if(w < this->realV) ++tf[w];
+			}
+
+			for (size_t i = 0; i < doc.words.size(); ++i)
+			{
+				if (doc.words[i] >= this->realV) continue;
+				if (_tw == TermWeight::idf)
+				{
+					if (!usesSharedWordWeights()) doc.wordWeights[i] = vocabWeights[doc.words[i]];
+				}
+				else if (_tw == TermWeight::pmi)
+				{
+					if (!usesSharedWordWeights()) doc.wordWeights[i] = std::max((Float)log(tf[doc.words[i]] / vocabWeights[doc.words[i]] / doc.words.size()), (Float)0);
+				}
+				sampleInitialTopic<_Infer>(_DocOnly{}, *selectedG, ld, rgs, doc, i);
+			}
+			static_cast<const DerivedClass*>(this)->updateSumWordWeight(doc);
+		}
+
+		/*
+		Derived models may use the global state while initializing a document, so their documents are initialized one by one.
+		*/
+		template<typename _Generator>
+		void initializeDocs(std::false_type, _Generator& generator)
+		{
+			for (auto& doc : this->docs)
+			{
+				initializeDocState<false>(doc, &doc - &this->docs[0], generator, this->globalState, this->rg);
+			}
+		}
+
+		/*
+		Plain LDA draws the initial topics of each chunk of documents in parallel from its own random stream, 
+		which is seeded by `rg` in the order of chunks, so the result doesn't depend on the number of threads.
+		The global counts are accumulated after all documents are initialized.
+		*/
+		void initializeDocs(std::true_type, Generator& generator, size_t first = 0)
+		{
+			const size_t numDocs = this->docs.size() - first;
+			std::vector<decltype(this->rg())> seeds(this->getNumPrepareChunks(numDocs));
+			for (auto& seed : seeds) seed = this->rg();
+			this->forEachPrepareChunk(this->getNumPrepareThreads(numDocs), numDocs, [&](size_t, size_t c, size_t b, size_t e)
+			{
+				_RandGen rgc{ seeds[c] };
+				Generator g = generator;
+				for (size_t i = first + b; i < first + e; ++i)
+				{
+					initializeDocState<false, Generator, std::true_type>(this->docs[i], i, g, this->globalState, rgc);
+				}
+			});
+
+			auto& ld = this->globalState;
+			for (auto it = this->docs.begin() + first; it != this->docs.end(); ++it)
+			{
+				auto& doc = *it;
+				for (size_t i = 0; i < doc.words.size(); ++i)
+				{
+					const Vid w = doc.words[i];
+					if (w >= this->realV) continue;
+					const Tid z = doc.Zs[i];
+					const WeightType weight = getWordWeight(doc, i);
+					updateCnt<false>(ld.numByTopic[z], weight);
+					if (w < (size_t)ld.numByTopicWord.cols()) updateCnt<false>(ld.numByTopicWord(z, w), weight);
+					else ld.numByTopicWordTail.template add<false>(z, w, weight);
+				}
+			}
+			if (ld.invTopicDenom.size()) refreshInvTopicDenom(ld);
+		}
+
+		std::vector<uint64_t> _getTopicsCount() const
+		{
+			std::vector<uint64_t> cnt(K);
+			for (auto& doc : this->docs)
+			{
+				for (size_t i = 0; i < doc.Zs.size(); ++i)
+				{
+					if (doc.words[i] < this->realV) ++cnt[doc.Zs[i]];
+				}
+			}
+			return cnt;
+		}
+
+		std::vector<Float> _getWidsByTopic(size_t tid, bool normalize = true) const
+		{
+			assert(tid < this->globalState.numByTopic.rows());
+			const size_t V = this->realV;
+			if (normalize)
+			{
+				auto r = getPhiByTopic().row(tid);
+				return { r.data(), r.data() + V };
+			}
+			std::vector<Float> ret(V);
+			auto r = getTopicWordByRow().row(tid);
+			const size_t denseV = std::min((size_t)r.size(), V);
+			for (size_t v = 0; v < denseV; ++v)
+			{
+				ret[v] = r[v] + eta;
+			}
+			for (size_t v = denseV; v < V; ++v)
+			{
+				ret[v] = this->globalState.numByTopicWordTail.get(tid, v) + eta;
+			}
+			return ret;
+		}
+
+		/*
+		serializes the building of the lazy caches below.
+		Readers check the step of a cache with `atomicLoadAcquire` first, so they take the lock only when the cache is stale.
+		*/
+		static std::mutex& getCacheMutex()
+		{
+			static std::mutex mutex;
+			return mutex;
+		}
+
+		// should be called whenever globalState changes without increasing `globalStep`
+		void invalidateCaches()
+		{
+			topicWordByRowStep = -1;
+			phiStep = -1;
+			phiByWordStep = -1;
+			proposalStep = -1;
+		}
+
+		/*
+		returns a row-major copy of the topic-word counts of the global state,
+		so that reading all words of a topic doesn't stride over the column-major layout.
+		The copy is refreshed lazily when the model has been trained or prepared since.
+		*/
+		const Eigen::Matrix<WeightType, -1, -1, Eigen::RowMajor>& getTopicWordByRow() const
+		{
+			if (atomicLoadAcquire(topicWordByRowStep) == this->globalStep) return topicWordByRow;
+			std::lock_guard<std::mutex> lock{ getCacheMutex() };
+			if (topicWordByRowStep != this->globalStep)
+			{
+				topicWordByRow = this->globalState.numByTopicWord;
+				atomicStoreRelease(topicWordByRowStep, this->globalStep);
+			}
+			return topicWordByRow;
+		}
+
+		// should be called with the lock of `getCacheMutex`
+		void buildPhiByTopic() const
+		{
+			const auto& gs = this->globalState;
+			const size_t V = this->realV;
+			const size_t denseV = std::min((size_t)gs.numByTopicWord.cols(), V);
+			phiByTopic.resize(gs.numByTopic.rows(), V);
+			phiByTopic.leftCols(denseV) = gs.numByTopicWord.leftCols(denseV).template cast<Float>();
+			phiByTopic.rightCols(V - denseV).setZero();
+			for (size_t v = denseV; v < V; ++v)
+			{
+				for (auto& e : gs.numByTopicWordTail.col(v)) phiByTopic(e.topic, v) = e.count;
+			}
+			phiByTopic.array() += eta;
+			phiByTopic.array().colwise() /= gs.numByTopic.array().template cast<Float>() + V * eta;
+			atomicStoreRelease(phiStep, this->globalStep);
+		}
+
+		/*
+		returns the normalized topic-word distributions of the global state in the layout of topics,
+		which is built lazily like `getTopicWordByRow` and shared by all queries until the model changes.
+		*/
+		const Eigen::Matrix<Float, -1, -1, Eigen::RowMajor>& getPhiByTopic() const
+		{
+			if (atomicLoadAcquire(phiStep) == this->globalStep) return phiByTopic;
+			std::lock_guard<std::mutex> lock{ getCacheMutex() };
+			if (phiStep != this->globalStep) buildPhiByTopic();
+			return phiByTopic;
+		}
+
+		/*
+		prepares `phiByWord` if `frozenInference` or `foldInEM` is set and the model supports it,
+		and returns whether inference should use it.
+		It should be called before the workers of inference start, since they read it without synchronization.
+		*/
+		bool preparePhiByWord(std::false_type) const
+		{
+			return false;
+		}
+
+		bool preparePhiByWord(std::true_type) const
+		{
+			if (!(frozenInference || foldInEM) || etaByTopicWord.size()) return false;
+			if (atomicLoadAcquire(phiByWordStep) == this->globalStep) return true;
+			std::lock_guard<std::mutex> lock{ getCacheMutex() };
+			if (phiByWordStep != this->globalStep)
+			{
+				if (phiStep != this->globalStep) buildPhiByTopic();
+				phiByWord = phiByTopic;
+				atomicStoreRelease(phiByWordStep, this->globalStep);
+			}
+			return true;
+		}
+
+		// proposal tables are not serialized, so a loaded model builds them at its first inference
+		template<typename _Supported>
+		void prepareProposalTablesForInference(_Supported) const
+		{
+			if (!_Supported::value || samplingMethod != SamplingMethod::mh || etaByTopicWord.size()) return;
+			if (atomicLoadAcquire(proposalStep) == this->globalStep) return;
+			std::lock_guard<std::mutex> lock{ getCacheMutex() };
+			if (proposalStep != this->globalStep)
+			{
+				as_mutable(this)->prepareProposalTables(nullptr, false, _Supported{});
+				atomicStoreRelease(proposalStep, this->globalStep);
+			}
+		}
+
+		/*
+		borrows a pool for inference without a session from `PoolManager`, so repeated calls reuse live workers
+		and concurrent calls never share a pool. It may have fewer workers than `numWorkers` when the global cap is reached.
+		*/
+		static PoolManager::Lease getInferencePool(size_t numWorkers, size_t maxQueued)
+		{
+			return PoolManager::getInstance().borrow(numWorkers, maxQueued);
+		}
+
+		template<bool together, ParallelScheme _ps, typename _Iter>
+		std::vector<double> _infer(_Iter docFirst, _Iter docLast, size_t maxIter, Float tolerance, size_t numWorkers,
+			typename BaseClass::InferenceContextType* ctx = nullptr, const InferenceDeadline& deadline = {}, uint32_t* iterations = nullptr) const
+		{
+			const auto callEnd = InferenceDeadline::after(deadline.seconds);
+			decltype(static_cast<const DerivedClass*>(this)->makeGeneratorForInit(nullptr)) generator;
+			if (!(m_flags & flags::generator_by_doc))
+			{
+				generator = static_cast<const DerivedClass*>(this)->makeGeneratorForInit(nullptr);
+			}
+
+			const bool fixedPhi = preparePhiByWord(std::is_same<_Derived, void>{});
+			if (foldInEM && fixedPhi)
+			{
+				auto ll = inferFoldIn(docFirst, docLast, maxIter, tolerance, numWorkers, callEnd, deadline.secondsPerDoc, iterations, std::is_same<_Derived, void>{});
+				if (together) return { std::accumulate(ll.begin(), ll.end(), 0.) };
+				return ll;
+			}
+
+			prepareProposalTablesForInference(std::integral_constant<bool, DerivedClass::isSamplingMethodSupported(SamplingMethod::mh)>{});
+
+			if (together)
+			{
+				numWorkers = std::min(numWorkers, this->maxThreads[(size_t)_ps]);
+				// the session's pool is reused only if it has the right number of workers for `_ps`
+				if (ctx && ctx->pool->getNumWorkers() != numWorkers) ctx = nullptr;
+				PoolManager::Lease lease;
+				if (!ctx) lease = getInferencePool(numWorkers, 0);
+				ThreadPool& pool = ctx ? *ctx->pool : *lease;
+				// temporary state variable
+				_RandGen rgc{};
+				auto tmpState = this->globalState, tState = this->globalState;
+				size_t numDocs = 0;
+				for (auto d = docFirst; d != docLast; ++d, ++numDocs)
+				{
+					initializeDocState<true>(*d, -1, generator, tmpState, rgc);
+				}
+
+				std::vector<_ModelState> ownLocalData;
+				auto& localData = (ctx && !(m_flags & flags::shared_state)) ? ctx->states : ownLocalData;
+				localData.resize((m_flags & flags::shared_state) ? 0 : pool.getNumWorkers());
+				for (auto& l : localData) l = tmpState;
+				if (ctx) ctx->synced.clear();
+				std::vector<_RandGen> ownRgs;
+				if (!ctx) for (size_t i = 0; i < pool.getNumWorkers(); ++i) ownRgs.emplace_back(rgc());
+				auto& rgs = ctx ? ctx->rgs : ownRgs;
+
+				ExtraDocData edd;
+				if (_ps == ParallelScheme::partition)
+				{
+					updatePartition(pool, tmpState, localData.data(), docFirst, docLast, edd);
+				}
+
+				size_t i = 0;
+				for (; i < maxIter && !InferenceDeadline::passed(callEnd); ++i)
+				{
+					std::vector<std::future<void>> res;
+					static_cast<const DerivedClass*>(this)->template performSampling<_ps, true>(pool,
+						(m_flags & flags::shared_state) ? &tmpState : localData.data(), rgs.data(), res,
+						docFirst, docLast, edd
+					);
+					static_cast<const DerivedClass*>(this)->template mergeState<_ps>(pool, tmpState, tState, localData.data(), rgs.data(), edd);
+					static_cast<const DerivedClass*>(this)->template performSamplingGlobal<_ps, true>(&pool, tmpState, rgs.data(),
+						docFirst, docLast
+					);
+					static_cast<const DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::inference>(
+						&pool, (m_flags & flags::shared_state) ? &tmpState : localData.data(), rgs.data(), docFirst, docLast
+					);
+					static_cast<const DerivedClass*>(this)->template distributeMergedState<_ps>(pool, tmpState, localData.data());
+				}
+				if (iterations) std::fill(iterations, iterations + numDocs, (uint32_t)i);
+				double ll = static_cast<const DerivedClass*>(this)->getLLRest(tmpState) - static_cast<const DerivedClass*>(this)->getLLRest(this->globalState);
+				ll += static_cast<const DerivedClass*>(this)->template getLLDocs<>(docFirst, docLast);
+				return { ll };
+			}
+			else
+			{
+				ExtraDocData edd;
+				const double gllRest = static_cast<const DerivedClass*>(this)->getLLRest(this->globalState);
+				auto inferDoc = [&](_DocType& doc, size_t docIdx, _ModelState& tmpState, _RandGen& rgc, ThreadPool* globalPool)
+				{
+					const auto end = std::min(callEnd, InferenceDeadline::after(deadline.secondsPerDoc));
+					initializeDocState<true>(doc, -1, generator, tmpState, rgc);
+					size_t i = 0;
+					for (; i < maxIter && !InferenceDeadline::passed(end); ++i)
+					{
+						static_cast<const DerivedClass*>(this)->presampleDocument(doc, -1, tmpState, rgc, i);
+						static_cast<const DerivedClass*>(this)->template sampleDocument<ParallelScheme::none, true>(
+							doc, edd, -1, tmpState, rgc, i
+						);
+						static_cast<const DerivedClass*>(this)->template performSamplingGlobal<_ps, true>(globalPool, tmpState, &rgc,
+							&doc, &doc + 1);
+						static_cast<const DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::inference>(
+							globalPool, &tmpState, &rgc, &doc, &doc + 1
+						);
+					}
+					if (iterations) iterations[docIdx] = (uint32_t)i;
+					double ll = static_cast<const DerivedClass*>(this)->getLLRestDelta(tmpState, doc, gllRest);
+					ll += static_cast<const DerivedClass*>(this)->template getLLDocs<>(&doc, &doc + 1);
+					return ll;
+				};
+
+				PoolManager::Lease lease;
+				if (!ctx) lease = getInferencePool(numWorkers, (m_flags & flags::shared_state) ? 0 : numWorkers * 8);
+				ThreadPool& pool = ctx ? *ctx->pool : *lease;
+
+				// each worker copies the global state once into its scratch state.
+				// if the model supports it, only the counts touched by a document are restored after inferring it,
+				// otherwise the whole state is copied again for the next document.
+				std::vector<_ModelState> ownStates;
+				std::vector<char> ownSynced;
+				auto& states = ctx ? ctx->states : ownStates;
+				auto& synced = ctx ? ctx->synced : ownSynced;
+				const size_t numStates = (m_flags & flags::shared_state) ? 1 : pool.getNumWorkers();
+				if (ctx && ctx->syncedStep != this->globalStep)
+				{
+					synced.clear();
+					ctx->syncedStep = this->globalStep;
+				}
+				states.resize(numStates);
+				synced.resize(numStates, 0);
+				auto acquireState = [&](size_t id) -> _ModelState&
+				{
+					if (!synced[id]) states[id] = this->globalState;
+					synced[id] = 1;
+					return states[id];
+				};
+				auto releaseState = [&](size_t id, const _DocType& doc)
+				{
+					if (DerivedClass::hasDocLocalInferenceState()) static_cast<const DerivedClass*>(this)->restoreInferenceState(states[id], doc);
+					else synced[id] = 0;
+				};
+
+				std::vector<double> ret;
+				if (m_flags & flags::shared_state)
+				{
+					size_t docIdx = 0;
+					for (auto d = docFirst; d != docLast; ++d, ++docIdx)
+					{
+						auto& tmpState = acquireState(0);
+						if (ctx)
+						{
+							ret.emplace_back(inferDoc(*d, docIdx, tmpState, ctx->rgs[0], &pool));
+						}
+						else
+						{
+							_RandGen rgc{};
+							ret.emplace_back(inferDoc(*d, docIdx, tmpState, rgc, &pool));
+						}
+						releaseState(0, *d);
+					}
+				}
+				else
+				{
+					std::vector<std::future<double>> res;
+					size_t docIdx = 0;
+					for (auto d = docFirst; d != docLast; ++d, ++docIdx)
+					{
+						res.emplace_back(pool.enqueue([&, d, docIdx](size_t threadId)
+						{
+							auto& tmpState = acquireState(threadId);
+							double ll;
+							if (ctx)
+							{
+								ll = inferDoc(*d, docIdx, tmpState, ctx->rgs[threadId], nullptr);
+							}
+							else
+							{
+								_RandGen rgc{};
+								ll = inferDoc(*d, docIdx, tmpState, rgc, nullptr);
+							}
+							releaseState(threadId, *d);
+							return ll;
+						}));
+					}
+					for (auto& r : res) ret.emplace_back(r.get());
+				}
+				return ret;
+			}
+		}
+
+		template<typename _Iter>
+		std::vector<double> inferFoldIn(_Iter docFirst, _Iter docLast, size_t maxIter, Float tolerance, size_t numWorkers,
+			InferenceDeadline::Clock::time_point callEnd, double secondsPerDoc, uint32_t* iterations, std::false_type) const
+		{
+			return {};
+		}
+
+		/*
+		folds `docs` in by EM with the topic-word distributions fixed to `phiByWord`.
+		For each document, it alternates the responsibilities of its unique words and its topic distribution theta,
+		until the mean change of theta gets smaller than `tolerance` (1e-3 if it is not positive), `maxIter` iterations pass or its deadline is reached.
+		Then the topic of each word is drawn from its final responsibility, so that the document has a state like one inferred by Gibbs sampling.
+		It returns the log-likelihood of each document given theta and phi.
+		*/
+		template<typename _Iter>
+		std::vector<double> inferFoldIn(_Iter docFirst, _Iter docLast, size_t maxIter, Float tolerance, size_t numWorkers,
+			InferenceDeadline::Clock::time_point callEnd, double secondsPerDoc, uint32_t* iterations, std::true_type) const
+		{
+			if (tolerance <= 0) tolerance = (Float)1e-3;
+			std::vector<_DocType*> docs;
+			for (auto d = docFirst; d != docLast; ++d) docs.emplace_back(&*d);
+			std::vector<double> ret(docs.size());
+			const Float alphaSum = alphas.sum();
+
+			this->forRowRanges(*getInferencePool(numWorkers, 0), 0, docs.size(), [&](size_t b, size_t e)
+			{
+				Generator generator = makeGeneratorForInit(nullptr);
+				_ModelState unused;
+				std::vector<std::pair<Vid, Float>> wordWeights;
+				Matrix phi;
+				Vector cnts, theta{ K }, nextTheta{ K }, denom;
+				for (size_t i = b; i < e; ++i)
+				{
+					auto& doc = *docs[i];
+					const auto end = std::min(callEnd, InferenceDeadline::after(secondsPerDoc));
+					_RandGen rgc{};
+					initializeDocState<true, Generator, std::true_type>(doc, -1, generator, unused, rgc);
+
+					// the words of the document are merged into unique words with the sums of their weights
+					wordWeights.clear();
+					for (size_t j = 0; j < doc.words.size(); ++j)
+					{
+						if (doc.words[j] < this->realV) wordWeights.emplace_back(doc.words[j], getWordWeight(doc, j));
+					}
+					std::sort(wordWeights.begin(), wordWeights.end());
+					size_t u = 0;
+					for (size_t j = 0; j < wordWeights.size(); ++j)
+					{
+						if (u && wordWeights[u - 1].first == wordWeights[j].first) wordWeights[u - 1].second += wordWeights[j].second;
+						else wordWeights[u++] = wordWeights[j];
+					}
+					wordWeights.resize(u);
+					phi.resize(K, u);
+					cnts.resize(u);
+					for (size_t j = 0; j < u; ++j)
+					{
+						phi.col(j) = phiByWord.col(wordWeights[j].first);
+						cnts[j] = wordWeights[j].second;
+					}
+					const Float total = cnts.sum();
+
+					theta = (alphas.array() + total / K) / (alphaSum + total);
+					size_t it = 0;
+					while (it < maxIter && !InferenceDeadline::passed(end))
+					{
+						denom = phi.transpose() * theta;
+						nextTheta = (theta.array() * (phi * (cnts.array() / denom.array()).matrix()).array() + alphas.array()) / (alphaSum + total);
+						const Float diff = (nextTheta - theta).cwiseAbs().mean();
+						theta.swap(nextTheta);
+						++it;
+						if (diff < tolerance) break;
+					}
+					if (iterations) iterations[i] = (uint32_t)it;
+					denom = phi.transpose() * theta;
+					ret[i] = (cnts.array() * denom.array().log()).sum();
+
+					doc.numByTopic.setZero();
+					for (size_t j = 0; j < doc.words.size(); ++j)
+					{
+						const Vid v = doc.words[j];
+						if (v >= this->realV) continue;
+						nextTheta = theta.array() * phiByWord.col(v).array();
+						sample::prefixSum(nextTheta.data(), K);
+						doc.Zs[j] = sample::sampleFromDiscreteAcc(nextTheta.data(), nextTheta.data() + K, rgc);
+						updateCnt<false>(doc.numByTopic[doc.Zs[j]], (WeightType)getWordWeight(doc, j));
+					}
+				}
+			});
+			return ret;
+		}
+
+		/*
+		returns true if inferring a document changes only `numByTopic` and the columns of `numByTopicWord` for its words,
+		which holds for the models sharing ModelStateLDA
+		*/
+		static constexpr bool hasDocLocalInferenceState()
+		{
+			return std::is_same<_ModelState, ModelStateLDA<_tw>>::value;
+		}
+
+		/*
+		restores the scratch state `ld` used for inferring `doc` back to the global state, in O(doc length * K)
+		*/
+		void restoreInferenceState(_ModelState& ld, const _DocType& doc) const
+		{
+			_restoreInferenceState(ld, doc, std::integral_constant<bool, DerivedClass::hasDocLocalInferenceState()>{});
+		}
+
+		void _restoreInferenceState(_ModelState& ld, const _DocType& doc, std::false_type) const
+		{
+		}
+
+		void _restoreInferenceState(_ModelState& ld, const _DocType& doc, std::true_type) const
+		{
+			ld.numByTopic = this->globalState.numByTopic;
+			for (auto w : doc.words)
 			{
-				auto txWeights = [](_DocType& doc) { return &doc.wordWeights; };
-				tvector<Float>::trade(sharedWordWeights,
-					makeTransformIter(this->docs.begin(), txWeights),
-					makeTransformIter(this->docs.end(), txWeights));
+				if (w >= this->realV) continue;
+				if (w < (size_t)ld.numByTopicWord.cols()) ld.numByTopicWord.col(w) = this->globalState.numByTopicWord.col(w);
+				else ld.numByTopicWordTail.col(w) = this->globalState.numByTopicWordTail.col(w);
 			}
 		}
 
-		void updateForCopy()
+	public:
+		DEFINE_SERIALIZER_WITH_VERSION(0, vocabWeights, alpha, alphas, eta, K);
+
+		DEFINE_TAGGED_SERIALIZER_WITH_VERSION(1, 0x00010001, vocabWeights, alpha, alphas, eta, K, etaByWord,
+			burnIn, optimInterval, compact);
+
+		LDAModel(const LDAArgs& args, bool checkAlpha = true)
+			: BaseClass(args.seed), K(args.k), alpha(args.alpha[0]), eta(args.eta), compact(args.compact), rngSeed(args.seed)
 		{
-			BaseClass::updateForCopy();
-			size_t offset = 0;
-			for (auto& doc : this->docs)
+			if (compact && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument, 
+				"This model doesn't support the compact storage");
+			if (K == 0 || K >= 0x80000000) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong K value (K = %zd)", K));
+
+			if (args.alpha.size() == 1)
 			{
-				size_t size = doc.Zs.size();
-				doc.Zs = tvector<Tid>{ sharedZs.data() + offset, size };
-				if (_tw != TermWeight::one)
+				alphas = Vector::Constant(K, alpha);
+			}
+			else if (args.alpha.size() == args.k)
+			{
+				alphas = Eigen::Map<const Vector>(args.alpha.data(), args.alpha.size());
+			}
+			else if (checkAlpha)
+			{
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong alpha value (len = %zd)", args.alpha.size()));
+			}
+
+			if ((alphas.array() <= 0).any()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "wrong alpha value");
+			if (eta <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong eta value (eta = %f)", eta));
+		}
+
+		GETTER(K, size_t, K);
+		GETTER(Alpha, Float, alpha);
+		GETTER(Eta, Float, eta);
+		GETTER(OptimInterval, size_t, optimInterval);
+		GETTER(BurnInIteration, size_t, burnIn);
+
+		Float getAlpha(size_t k1) const override { return alphas[k1]; }
+
+		SamplingMethod getSamplingMethod() const override
+		{
+			return samplingMethod;
+		}
+
+		void setSamplingMethod(SamplingMethod method) override
+		{
+			if (!DerivedClass::isSamplingMethodSupported(method)) THROW_ERROR_WITH_INFO(exc::InvalidArgument, 
+				text::format("This model doesn't support the sampling method (method = %d)", (int)method));
+			samplingMethod = method;
+		}
+
+		bool getDynamicBalancing() const override
+		{
+			return dynamicBalancing;
+		}
+
+		void setDynamicBalancing(bool enabled) override
+		{
+			dynamicBalancing = enabled;
+		}
+
+		size_t getAsyncStaleness() const override
+		{
+			return asyncStaleness;
+		}
+
+		void setAsyncStaleness(size_t docs) override
+		{
+			if (!docs) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "`asyncStaleness` must be positive");
+			asyncStaleness = docs;
+		}
+
+		size_t getAsyncRecountInterval() const override
+		{
+			return asyncRecountInterval;
+		}
+
+		void setAsyncRecountInterval(size_t interval) override
+		{
+			asyncRecountInterval = interval;
+		}
+
+		size_t getHierarchicalGroups() const override
+		{
+			return hierarchicalGroups;
+		}
+
+		void setHierarchicalGroups(size_t groups) override
+		{
+			hierarchicalGroups = groups;
+		}
+
+		bool getPipelinedPartition() const override
+		{
+			return pipelinedPartition;
+		}
+
+		void setPipelinedPartition(bool enabled) override
+		{
+			pipelinedPartition = enabled;
+		}
+
+		size_t getPartitionRebalanceInterval() const override
+		{
+			return partitionRebalanceInterval;
+		}
+
+		void setPartitionRebalanceInterval(size_t interval) override
+		{
+			partitionRebalanceInterval = interval;
+			blockCosts.clear();
+		}
+
+		size_t getFreezeInterval() const override
+		{
+			return freezeInterval;
+		}
+
+		void setFreezeInterval(size_t interval) override
+		{
+			freezeInterval = interval;
+		}
+
+		bool getCollapseDuplicates() const override
+		{
+			return collapseDuplicates;
+		}
+
+		void setCollapseDuplicates(bool collapse) override
+		{
+			collapseDuplicates = collapse;
+		}
+
+		DocOrder getDocOrder() const override
+		{
+			return docOrder;
+		}
+
+		void setDocOrder(DocOrder order) override
+		{
+			docOrder = order;
+			updateSampleOrder();
+		}
+
+		size_t getDenseVocabSize() const override
+		{
+			return denseVocabSize;
+		}
+
+		void setDenseVocabSize(size_t size) override
+		{
+			if (size && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument, 
+				"This model doesn't support the hybrid topic-word storage");
+			denseVocabSize = size;
+			updateTopicWordLayout();
+		}
+
+		const void* _getTopicWordCounts(size_t& rows, size_t& cols) const
+		{
+			const auto& tw = this->globalState.numByTopicWord;
+			rows = tw.rows();
+			cols = tw.cols();
+			if (!tw.size() || cols != this->realV) return nullptr;
+			return tw.data();
+		}
+
+		const void* getTopicWordCounts(size_t& rows, size_t& cols) const override
+		{
+			return static_cast<const DerivedClass*>(this)->_getTopicWordCounts(rows, cols);
+		}
+
+		bool isSharingArrays() const override
+		{
+			return !!sharedArrays;
+		}
+
+		/*
+		Plain LDA shares the arrays of its documents and its topic-word counts with the copy until either of them modifies them,
+		so that many copies forked from a trained model don't multiply its memory.
+		*/
+		std::unique_ptr<ITopicModel> copy() const override
+		{
+			return _copy(std::is_same<_Derived, void>{});
+		}
+
+		std::unique_ptr<ITopicModel> _copy(std::false_type) const
+		{
+			return BaseClass::copy();
+		}
+
+		std::unique_ptr<ITopicModel> _copy(std::true_type) const
+		{
+			std::lock_guard<std::mutex> lock{ getShareMutex() };
+			auto* self = as_mutable(this);
+			self->shareArrays();
+			if (!sharedArrays) return BaseClass::copy();
+
+			// the copy should view the shared counts, while copies of the state made by inference own theirs
+			auto& tw = self->globalState.numByTopicWord;
+			tw.external = false;
+			std::unique_ptr<ITopicModel> ret;
+			try
+			{
+				ret = BaseClass::copy();
+			}
+			catch (...)
+			{
+				tw.external = true;
+				throw;
+			}
+			tw.external = true;
+			static_cast<DerivedClass*>(ret.get())->globalState.numByTopicWord.external = true;
+			return ret;
+		}
+
+		bool getCompact() const override
+		{
+			return compact;
+		}
+
+		double getLLPerWord() const override
+		{
+			// the words of the documents out of core or shared with copies are not in `this->words`
+			if (docsOutOfCore || sharedArrays) return static_cast<const DerivedClass*>(this)->getLL() / this->weightedN;
+			return BaseClass::getLLPerWord();
+		}
+
+		std::string getOutOfCoreDir() const override
+		{
+			return outOfCoreDir;
+		}
+
+		void setOutOfCoreDir(const std::string& dir) override
+		{
+			if (!dir.empty() && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support out-of-core training");
+			outOfCoreDir = dir;
+			if (!docsOutOfCore) return;
+			detachShared();
+			if (dir.empty()) moveDocsIntoMemory();
+			else moveDocsOutOfCore();
+		}
+
+		size_t getNewDocSweeps() const override
+		{
+			return newDocSweeps;
+		}
+
+		void setNewDocSweeps(size_t sweeps) override
+		{
+			if (sweeps && !canAppendDocs()) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support adding documents after prepare()");
+			newDocSweeps = sweeps;
+		}
+
+		size_t getLLSampleDocs() const override
+		{
+			return llSampleDocs;
+		}
+
+		void setLLSampleDocs(size_t n) override
+		{
+			llSampleDocs = n;
+		}
+
+		bool getIncrementalLL() const override
+		{
+			return incrementalLL;
+		}
+
+		void setIncrementalLL(bool incremental) override
+		{
+			if (incremental && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support the incremental log-likelihood");
+			incrementalLL = incremental;
+			// the cache is not kept up to date while disabled
+			llDocCounts.resize(0, 0);
+			llWordCounts.resize(0, 0);
+		}
+
+		bool getOptimEta() const override
+		{
+			return optimEta;
+		}
+
+		void setOptimEta(bool optim) override
+		{
+			if (optim && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support optimizing eta");
+			optimEta = optim;
+		}
+
+		bool getReproducible() const override
+		{
+			return reproducible;
+		}
+
+		void setReproducible(bool r) override
+		{
+			if (r && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support reproducible training");
+			reproducible = r;
+		}
+
+		bool getFrozenInference() const override
+		{
+			return frozenInference;
+		}
+
+		void setFrozenInference(bool frozen) override
+		{
+			if (frozen && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support the frozen inference");
+			frozenInference = frozen;
+		}
+
+		bool getFoldInEM() const override
+		{
+			return foldInEM;
+		}
+
+		void setFoldInEM(bool foldIn) override
+		{
+			if (foldIn && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support the fold-in inference");
+			foldInEM = foldIn;
+		}
+
+		void setDistributedSync(const std::vector<std::string>& vocabs, TopicWordDeltaExchanger exchanger, Float threshold) override
+		{
+			if (exchanger && !std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support distributed training");
+			if (threshold < 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong threshold value (threshold = %f)", threshold));
+			deltaExchanger = std::move(exchanger);
+			deltaThreshold = threshold;
+			sharedVidOf.clear();
+			localVidOf.clear();
+			// the counts of a model trained alone are all sent at the first exchange
+			syncedZs.clear();
+			topicWordResidual.clear();
+			if (!deltaExchanger)
+			{
+				sharedVocabs.clear();
+				return;
+			}
+			sharedVocabs = vocabs;
+			if (getNumNewDocs() || numPreparedDocs == (size_t)-1)
+			{
+				for (auto& w : sharedVocabs) this->dict.add(w);
+				if (this->dict.size() > this->vocabCf.size())
+				{
+					this->vocabCf.resize(this->dict.size());
+					this->vocabDf.resize(this->dict.size());
+				}
+			}
+		}
+
+		bool canAppendDocs() const override
+		{
+			return std::is_same<_Derived, void>::value;
+		}
+
+		size_t getNumNewDocs() const override
+		{
+			return this->docs.size() - std::min(numPreparedDocs, this->docs.size());
+		}
+
+		void prepareNewDocs() override
+		{
+			// derived models have their own states of documents
+			_prepareNewDocs(std::is_same<_Derived, void>{});
+		}
+
+		void _prepareNewDocs(std::false_type)
+		{
+			THROW_ERROR_WITH_INFO(exc::InvalidArgument, "This model doesn't support adding documents after prepare()");
+		}
+
+		/*
+		The new vocabularies get their own weights, while the weights of the others are kept,
+		since the documents prepared already have their weights and topic counts based on them.
+		Then only the new documents are initialized, and sampled `newDocSweeps` times before the others join at `train`.
+		*/
+		void _prepareNewDocs(std::true_type)
+		{
+			const size_t first = this->docs.size() - getNumNewDocs(), numDocs = this->docs.size();
+			if (first == numDocs) return;
+			detachShared();
+
+			const size_t oldV = this->realV;
+			invalidateCaches();
+			addNewVocabs(first);
+			growTopicWordCounts();
+			prepareWordPriors();
+			if (_tw != TermWeight::one)
+			{
+				const double totCf = std::accumulate(this->vocabCf.begin(), this->vocabCf.end(), 0.);
+				vocabWeights.resize(this->realV);
+				for (size_t v = oldV; v < this->realV; ++v)
+				{
+					vocabWeights[v] = _tw == TermWeight::idf ? (Float)log(numDocs / (double)this->vocabDf[v])
+						: (Float)(this->vocabCf[v] / totCf);
+				}
+			}
+
+			// the topic counts of the new documents are appended after those of the others, which may move all of them
+			if (outOfCore) outOfCore->numByTopicDoc.resize(K * numDocs);
+			else
+			{
+				numByTopicDoc.conservativeResize(K, numDocs);
+				numByTopicDoc.rightCols(numDocs - first).setZero();
+			}
+			for (size_t i = 0; i < first; ++i)
+			{
+				auto& doc = this->docs[i];
+				if (doc.numByTopic.size()) doc.numByTopic.init(getTopicDocPtr(i), K, 1);
+			}
+			Generator generator = makeGeneratorForInit(nullptr);
+			initializeDocs(std::true_type{}, generator, first);
+
+			// the arrays shared by the documents are rebuilt, keeping the old ones alive until they are copied
+			if (outOfCore) moveDocsOutOfCore();
+			else
+			{
+				auto oldWords = std::move(this->words);
+				auto oldZs = std::move(sharedZs);
+				auto oldWordWeights = std::move(sharedWordWeights);
+				this->words = {};
+				sharedZs = {};
+				sharedWordWeights = {};
+				this->wOffsetByDoc.clear();
+				this->updateWeakArray();
+				prepareShared();
+			}
+			eddTrain = {};
+			updateSampleOrder();
+			numPreparedDocs = numDocs;
+			numPreparedVocabs = this->dict.size();
+			BaseClass::prepare(false);
+
+			prepareProposalTables(nullptr, true, std::integral_constant<bool, isSamplingMethodSupported(SamplingMethod::mh)>{});
+			for (size_t it = 0; it < newDocSweeps; ++it)
+			{
+				for (size_t i = first; i < numDocs; ++i)
 				{
-					doc.wordWeights = tvector<Float>{ sharedWordWeights.data() + offset, size };
+					presampleDocument(this->docs[i], i, this->globalState, this->rg, this->globalStep);
+					this->template sampleDocument<ParallelScheme::none, false>(this->docs[i], eddTrain, i, this->globalState, this->rg, this->globalStep);
 				}
-				offset += size;
 			}
 		}
-		
-		WeightType* getTopicDocPtr(size_t docId) const
-		{
-			if (!(m_flags & flags::continuous_doc_data) || docId == (size_t)-1) return nullptr;
-			return (WeightType*)numByTopicDoc.col(docId).data();
-		}
 
 		/*
-		* called only when initializing a new doc, not when loading from saved model
+		returns the weight of the `pid`-th word of `doc`, which is computed from the vocabulary if `doc.wordWeights` is empty.
+		The weight of TermWeight::pmi also depends on the frequency of the word in the document, which is kept in `wordTf`.
+		Only words occurring 0xFFFF times or more, or loaded documents before `prepare` fills it, look the frequency up in their sorted words.
 		*/
-		void prepareDoc(_DocType& doc, size_t docId, size_t wordSize) const
+		template<typename _Doc>
+		Float getWordWeight(const _Doc& doc, size_t pid) const
 		{
-			sortAndWriteOrder(doc.words, doc.wOrder);
-			doc.numByTopic.init(getTopicDocPtr(docId), K, 1);
-			doc.Zs = tvector<Tid>(wordSize, non_topic_id);
-			if(_tw != TermWeight::one) doc.wordWeights.resize(wordSize);
-		}
+			if (_tw == TermWeight::one) return 1;
+			if (!doc.wordWeights.empty()) return doc.wordWeights[pid];
+			const Vid w = doc.words[pid];
+			if (_tw == TermWeight::idf) return vocabWeights[w];
 
-		void prepareWordPriors()
-		{
-			if (etaByWord.empty()) return;
-			etaByTopicWord.resize(K, this->realV);
-			etaSumByTopic.resize(K);
-			etaByTopicWord.array() = eta;
-			for (auto& it : etaByWord)
+			size_t tf = doc.wordTf.size() == doc.words.size() ? doc.wordTf[pid] : 0xFFFF;
+			if (tf == 0xFFFF)
 			{
-				auto id = this->dict.toWid(it.first);
-				if (id == (Vid)-1 || id >= this->realV) continue;
-				etaByTopicWord.col(id) = Eigen::Map<Vector>{ it.second.data(), (Eigen::Index)it.second.size() };
+				auto run = std::equal_range(doc.words.begin(), doc.words.end(), w);
+				tf = run.second - run.first;
 			}
-			etaSumByTopic = etaByTopicWord.rowwise().sum();
+			return std::max((Float)log(tf / vocabWeights[w] / doc.words.size()), (Float)0);
 		}
 
-		void initGlobalState(bool initDocs)
+		void exportInferenceModel(std::ostream& writer, InferenceDType dtype) const override
 		{
-			const size_t V = this->realV;
-			this->globalState.zLikelihood = Vector::Zero(K);
-			if (initDocs)
+			if ((size_t)dtype >= (size_t)InferenceDType::size)
 			{
-				this->globalState.numByTopic = Eigen::Matrix<WeightType, -1, 1>::Zero(K);
-				//this->globalState.numByTopicWord = Eigen::Matrix<WeightType, -1, -1>::Zero(K, V);
-				this->globalState.numByTopicWord.init(nullptr, K, V);
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("unknown dtype (dtype = %d)", (int)dtype));
 			}
-			if(m_flags & flags::continuous_doc_data) numByTopicDoc = Eigen::Matrix<WeightType, -1, -1>::Zero(K, this->docs.size());
+			// derived models have their own states which cannot be reduced into a single topic-word distribution
+			_exportInferenceModel(writer, dtype, std::is_same<_Derived, void>{});
 		}
 
-		struct Generator
-		{
-			Eigen::Rand::DiscreteGen<int32_t> theta;
-		};
-
-		Generator makeGeneratorForInit(const _DocType*) const
+		void _exportInferenceModel(std::ostream& writer, InferenceDType dtype, std::false_type) const
 		{
-			Generator g;
-			g.theta = Eigen::Rand::DiscreteGen<int32_t>{ alphas.data(), alphas.data() + alphas.size() };
-			return g;
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "only LDAModel supports exporting an inference model");
 		}
 
-		template<bool _Infer>
-		void updateStateWithDoc(Generator& g, _ModelState& ld, _RandGen& rgs, _DocType& doc, size_t i) const
+		void _exportInferenceModel(std::ostream& writer, InferenceDType dtype, std::true_type) const
 		{
-			auto& z = doc.Zs[i];
-			auto w = doc.words[i];
-			if (etaByTopicWord.size())
+			if (!this->globalState.numByTopicWord.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the model is not trained yet");
+
+			Matrix phi{ (Eigen::Index)K, (Eigen::Index)this->realV };
+			for (size_t k = 0; k < K; ++k)
 			{
-				auto col = etaByTopicWord.col(w);
-				z = sample::sampleFromDiscrete(col.data(), col.data() + col.size(), rgs);
+				auto d = _getWidsByTopic(k, true);
+				phi.row(k) = Eigen::Map<Vector>{ d.data(), (Eigen::Index)d.size() }.transpose();
 			}
-			else
+			std::vector<Float> weights{ vocabWeights.begin(), vocabWeights.begin() + std::min(vocabWeights.size(), this->realV) };
+			InferenceModel::write(writer, _tw, this->dict, this->realV,
+				std::vector<Float>{ alphas.data(), alphas.data() + K }, weights, phi, dtype);
+		}
+
+		std::vector<double> estimateHeldOutLL(const std::vector<DocumentBase*>& docs, HeldOutEstimator method,
+			size_t numParticles, size_t numWorkers, size_t seed) const override
+		{
+			if ((size_t)method >= (size_t)HeldOutEstimator::size)
 			{
-				z = g.theta(rgs);
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("unknown estimator (method = %d)", (int)method));
 			}
-			addWordTo<1>(ld, doc, i, w, z);
+			if (!numParticles) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "`numParticles` must be positive");
+			// derived models have their own priors on the topic distributions of documents
+			return _estimateHeldOutLL(docs, method, numParticles, numWorkers, seed, std::is_same<_Derived, void>{});
 		}
 
-		template<bool _Infer, typename _Generator>
-		void initializeDocState(_DocType& doc, size_t docId, _Generator& g, _ModelState& ld, _RandGen& rgs) const
+		std::vector<double> _estimateHeldOutLL(const std::vector<DocumentBase*>& docs, HeldOutEstimator method,
+			size_t numParticles, size_t numWorkers, size_t seed, std::false_type) const
 		{
-			std::vector<uint32_t> tf(this->realV);
-			static_cast<const DerivedClass*>(this)->prepareDoc(doc, docId, doc.words.size());
-			_Generator g2;
-			_Generator* selectedG = &g;
-			if (m_flags & flags::generator_by_doc)
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "only LDAModel supports the held-out estimators");
+		}
+
+		/*
+		The estimators treat each token as a count of one regardless of the term weighting, and skip the words out of the vocabulary.
+		Each document draws from its own generator seeded by `seed` and its index, and reads p(w|k) from the cached `phiByTopic`.
+
+		* Wallach, H. M., Murray, I., Salakhutdinov, R., & Mimno, D. (2009). Evaluation methods for topic models. In Proceedings of the 26th annual international conference on machine learning (pp. 1105-1112).
+		*/
+		std::vector<double> _estimateHeldOutLL(const std::vector<DocumentBase*>& docs, HeldOutEstimator method,
+			size_t numParticles, size_t numWorkers, size_t seed, std::true_type) const
+		{
+			if (!this->globalState.numByTopicWord.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the model is not trained yet");
+			const auto& phis = getPhiByTopic();
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			std::vector<double> ret(docs.size());
+			this->forRowRanges(*getInferencePool(numWorkers, 0), 0, docs.size(), [&](size_t b, size_t e)
 			{
-				g2 = static_cast<const DerivedClass*>(this)->makeGeneratorForInit(&doc);
-				selectedG = &g2;
-			}
-			if (_tw == TermWeight::pmi)
+				Matrix phi;
+				for (size_t i = b; i < e; ++i)
+				{
+					auto& words = docs[i]->words;
+					phi.resize(K, words.size());
+					size_t n = 0;
+					for (auto w : words)
+					{
+						if (w < this->realV) phi.col(n++) = phis.col(w);
+					}
+					_RandGen rg{ seed + i };
+					switch (method)
+					{
+					case HeldOutEstimator::left_to_right:
+						ret[i] = heldOutLeftToRight(phi.leftCols(n), numParticles, rg);
+						break;
+					case HeldOutEstimator::importance_sampling:
+						ret[i] = heldOutImportanceSampling(phi.leftCols(n), numParticles, rg);
+						break;
+					default:
+						ret[i] = heldOutHarmonicMean(phi.leftCols(n), numParticles, rg);
+						break;
+					}
+				}
+			});
+			return ret;
+		}
+
+		/*
+		the left-to-right estimator, which accumulates p(w_n|w_<n) averaged over `numParticles` particles.
+		Before each step, every particle resamples the topics of the preceding words, so the cost is quadratic in the length of the document.
+		*/
+		template<typename _Phi>
+		double heldOutLeftToRight(const _Phi& phi, size_t numParticles, _RandGen& rg) const
+		{
+			const size_t n = phi.cols();
+			const Float alphaSum = alphas.sum();
+			std::vector<double> probs(n);
+			std::vector<Tid> zs(n);
+			Vector cnt{ K }, dist{ K };
+			for (size_t r = 0; r < numParticles; ++r)
 			{
-				std::fill(tf.begin(), tf.end(), 0);
-				for (auto& w : doc.words) if(w < this->realV) ++tf[w];
+				cnt.setZero();
+				for (size_t i = 0; i < n; ++i)
+				{
+					for (size_t j = 0; j < i; ++j)
+					{
+						cnt[zs[j]] -= 1;
+						dist = (cnt + alphas).array() * phi.col(j).array();
+						sample::prefixSum(dist.data(), K);
+						zs[j] = sample::sampleFromDiscreteAcc(dist.data(), dist.data() + K, rg);
+						cnt[zs[j]] += 1;
+					}
+					dist = (cnt + alphas).array() * phi.col(i).array();
+					probs[i] += dist.sum() / (i + alphaSum);
+					sample::prefixSum(dist.data(), K);
+					zs[i] = sample::sampleFromDiscreteAcc(dist.data(), dist.data() + K, rg);
+					cnt[zs[i]] += 1;
+				}
 			}
+			double ll = 0;
+			for (auto p : probs) ll += std::log(p / numParticles);
+			return ll;
+		}
 
-			for (size_t i = 0; i < doc.words.size(); ++i)
+		// importance sampling whose proposal draws the topic of each word independently in proportion to alpha_k * p(w|k)
+		template<typename _Phi>
+		double heldOutImportanceSampling(const _Phi& phi, size_t numParticles, _RandGen& rg) const
+		{
+			const size_t n = phi.cols();
+			const Float alphaSum = alphas.sum();
+			std::vector<double> logWeights(numParticles);
+			Matrix proposal = phi.array().colwise() * alphas.array();
+			Vector norms = proposal.colwise().sum().transpose();
+			// the columns are not aligned for the SIMD kernels of `sample`, so they are accumulated and searched by the standard algorithms
+			for (size_t i = 0; i < n; ++i) std::partial_sum(proposal.col(i).data(), proposal.col(i).data() + K, proposal.col(i).data());
+			Vector cnt{ K };
+			for (size_t r = 0; r < numParticles; ++r)
 			{
-				if (doc.words[i] >= this->realV) continue;
-				if (_tw == TermWeight::idf)
+				// log p(w, z) - log q(z), where log p(w|z) - log q(z) sums log(|q_i| / alpha_z) over the words
+				double lw = -math::lgammaSubt(alphaSum, (Float)n);
+				cnt.setZero();
+				for (size_t i = 0; i < n; ++i)
 				{
-					doc.wordWeights[i] = vocabWeights[doc.words[i]];
+					const Float* acc = proposal.col(i).data();
+					const Tid z = (Tid)std::min((size_t)(std::upper_bound(acc, acc + K, rg.uniform_real() * acc[K - 1]) - acc), (size_t)K - 1);
+					lw += std::log(norms[i] / alphas[z]);
+					cnt[z] += 1;
 				}
-				else if (_tw == TermWeight::pmi)
+				for (size_t k = 0; k < K; ++k)
 				{
-					doc.wordWeights[i] = std::max((Float)log(tf[doc.words[i]] / vocabWeights[doc.words[i]] / doc.words.size()), (Float)0);
+					if (cnt[k] > 0) lw += math::lgammaSubt(alphas[k], cnt[k]);
 				}
-				static_cast<const DerivedClass*>(this)->template updateStateWithDoc<_Infer>(*selectedG, ld, rgs, doc, i);
+				logWeights[r] = lw;
 			}
-			doc.updateSumWordWeight(this->realV);
+			return logSumExp(logWeights) - std::log((double)numParticles);
 		}
 
-		std::vector<uint64_t> _getTopicsCount() const
+		// the harmonic mean of p(w|z) over `numParticles` samples of Gibbs sampling after as many sweeps of burn-in
+		template<typename _Phi>
+		double heldOutHarmonicMean(const _Phi& phi, size_t numParticles, _RandGen& rg) const
 		{
-			std::vector<uint64_t> cnt(K);
-			for (auto& doc : this->docs)
+			const size_t n = phi.cols();
+			std::vector<double> negLLs(numParticles);
+			std::vector<Tid> zs(n);
+			Vector cnt = Vector::Zero(K), dist{ K };
+			for (size_t i = 0; i < n; ++i)
 			{
-				for (size_t i = 0; i < doc.Zs.size(); ++i)
+				dist = alphas.array() * phi.col(i).array();
+				sample::prefixSum(dist.data(), K);
+				zs[i] = sample::sampleFromDiscreteAcc(dist.data(), dist.data() + K, rg);
+				cnt[zs[i]] += 1;
+			}
+			for (size_t it = 0; it < numParticles * 2; ++it)
+			{
+				double ll = 0;
+				for (size_t i = 0; i < n; ++i)
 				{
-					if (doc.words[i] < this->realV) ++cnt[doc.Zs[i]];
+					cnt[zs[i]] -= 1;
+					dist = (cnt + alphas).array() * phi.col(i).array();
+					sample::prefixSum(dist.data(), K);
+					zs[i] = sample::sampleFromDiscreteAcc(dist.data(), dist.data() + K, rg);
+					cnt[zs[i]] += 1;
+					ll += std::log(phi(zs[i], i));
 				}
+				if (it >= numParticles) negLLs[it - numParticles] = -ll;
 			}
-			return cnt;
+			return -(logSumExp(negLLs) - std::log((double)numParticles));
 		}
 
-		std::vector<Float> _getWidsByTopic(size_t tid, bool normalize = true) const
+		static double logSumExp(const std::vector<double>& xs)
 		{
-			assert(tid < this->globalState.numByTopic.rows());
-			const size_t V = this->realV;
-			std::vector<Float> ret(V);
-			Float sum = this->globalState.numByTopic[tid] + V * eta;
-			if (!normalize) sum = 1;
-			auto r = this->globalState.numByTopicWord.row(tid);
-			for (size_t v = 0; v < V; ++v)
+			const double m = *std::max_element(xs.begin(), xs.end());
+			double s = 0;
+			for (auto x : xs) s += std::exp(x - m);
+			return m + std::log(s);
+		}
+
+		// a cheap fingerprint of the words of all documents, so that a checkpoint is not restored into other documents
+		uint64_t hashDocWords() const
+		{
+			uint64_t h = 0xcbf29ce484222325ull;
+			for (auto& doc : this->docs)
 			{
-				ret[v] = (r[v] + eta) / sum;
+				for (auto w : doc.words) h = (h ^ w) * 0x100000001b3ull;
+				h = (h ^ 0xFFFFFFFFu) * 0x100000001b3ull;
 			}
-			return ret;
+			return h;
 		}
 
-		template<bool together, ParallelScheme _ps, typename _Iter>
-		std::vector<double> _infer(_Iter docFirst, _Iter docLast, size_t maxIter, Float tolerance, size_t numWorkers) const
+		/*
+		A checkpoint holds only the topic assignments and the hyperparameters,
+		since all the counts can be rebuilt from them by `resetStatistics`.
+		A delta checkpoint holds only the assignments changed since the previous checkpoint, as gaps between the indices of the changed words
+		encoded in LEB128 varints and their new topics, which are bit-packed by compressed streams.
+		*/
+		void writeCheckpoint(std::ostream& writer, CheckpointBase* base) const override
 		{
-			decltype(static_cast<const DerivedClass*>(this)->makeGeneratorForInit(nullptr)) generator;
-			if (!(m_flags & flags::generator_by_doc))
+			_writeCheckpoint(writer, base, std::is_same<_Derived, void>{});
+		}
+
+		void _writeCheckpoint(std::ostream& writer, CheckpointBase* base, std::false_type) const
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "only LDAModel supports checkpoints");
+		}
+
+		void _writeCheckpoint(std::ostream& writer, CheckpointBase* base, std::true_type) const
+		{
+			if (!this->globalState.numByTopic.size() || getNumNewDocs()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the model is not prepared yet");
+
+			uint64_t numTokens = 0;
+			for (auto& doc : this->docs) numTokens += doc.Zs.size();
+			uint64_t id = 0;
+			if (base)
 			{
-				generator = static_cast<const DerivedClass*>(this)->makeGeneratorForInit(nullptr);
+				std::random_device rd;
+				while (!id) id = ((uint64_t)rd() << 32) | rd();
+				base->id = id;
+				base->numDeltas = 0;
+				base->zs.clear();
+				base->zs.reserve(numTokens);
+				for (auto& doc : this->docs) base->zs.insert(base->zs.end(), doc.Zs.begin(), doc.Zs.end());
 			}
-
-			if (together)
+			serializer::writeMany(writer, serializer::to_key("TLCP"), (uint32_t)1, (uint32_t)K,
+				(uint64_t)this->docs.size(), numTokens, hashDocWords(), (uint64_t)this->globalStep, id,
+				alpha, alphas, eta);
+			for (auto& doc : this->docs)
 			{
-				numWorkers = std::min(numWorkers, this->maxThreads[(size_t)_ps]);
-				ThreadPool pool{ numWorkers };
-				// temporary state variable
-				_RandGen rgc{};
-				auto tmpState = this->globalState, tState = this->globalState;
-				for (auto d = docFirst; d != docLast; ++d)
-				{
-					initializeDocState<true>(*d, -1, generator, tmpState, rgc);
-				}
+				writer.write((const char*)doc.Zs.data(), sizeof(Tid) * doc.Zs.size());
+			}
+		}
 
-				std::vector<decltype(tmpState)> localData((m_flags & flags::shared_state) ? 0 : pool.getNumWorkers(), tmpState);
-				std::vector<_RandGen> rgs;
-				for (size_t i = 0; i < pool.getNumWorkers(); ++i) rgs.emplace_back(rgc());
+		bool writeCheckpointDelta(std::ostream& writer, CheckpointBase& base) const override
+		{
+			return _writeCheckpointDelta(writer, base, std::is_same<_Derived, void>{});
+		}
 
-				ExtraDocData edd;
-				if (_ps == ParallelScheme::partition)
-				{
-					updatePartition(pool, tmpState, localData.data(), docFirst, docLast, edd);
-				}
+		bool _writeCheckpointDelta(std::ostream& writer, CheckpointBase& base, std::false_type) const
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "only LDAModel supports checkpoints");
+		}
 
-				for (size_t i = 0; i < maxIter; ++i)
-				{
-					std::vector<std::future<void>> res;
-					static_cast<const DerivedClass*>(this)->template performSampling<_ps, true>(pool,
-						(m_flags & flags::shared_state) ? &tmpState : localData.data(), rgs.data(), res,
-						docFirst, docLast, edd
-					);
-					static_cast<const DerivedClass*>(this)->template mergeState<_ps>(pool, tmpState, tState, localData.data(), rgs.data(), edd);
-					static_cast<const DerivedClass*>(this)->template performSamplingGlobal<_ps, true>(&pool, tmpState, rgs.data(),
-						docFirst, docLast
-					);
-					static_cast<const DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::inference>(
-						&pool, (m_flags & flags::shared_state) ? &tmpState : localData.data(), rgs.data(), docFirst, docLast
-					);
-					static_cast<const DerivedClass*>(this)->template distributeMergedState<_ps>(pool, tmpState, localData.data());
-				}
-				double ll = static_cast<const DerivedClass*>(this)->getLLRest(tmpState) - static_cast<const DerivedClass*>(this)->getLLRest(this->globalState);
-				ll += static_cast<const DerivedClass*>(this)->template getLLDocs<>(docFirst, docLast);
-				return { ll };
-			}
-			else if (m_flags & flags::shared_state)
+		bool _writeCheckpointDelta(std::ostream& writer, CheckpointBase& base, std::true_type) const
+		{
+			if (!this->globalState.numByTopic.size() || getNumNewDocs()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the model is not prepared yet");
+			if (!base.id) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "a full checkpoint should be written first");
+
+			uint64_t numTokens = 0;
+			for (auto& doc : this->docs) numTokens += doc.Zs.size();
+			if (numTokens != base.zs.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the documents have changed since the full checkpoint");
+
+			// beyond a quarter of the words, a delta is hardly smaller than a full checkpoint and slower to replay
+			const uint64_t maxChanges = std::min(numTokens / 4, (uint64_t)0x10000000);
+			std::vector<uint8_t> gaps;
+			std::vector<Tid> topics;
+			uint64_t pos = 0, last = 0;
+			for (auto& doc : this->docs)
 			{
-				ThreadPool pool{ numWorkers };
-				ExtraDocData edd;
-				std::vector<double> ret;
-				const double gllRest = static_cast<const DerivedClass*>(this)->getLLRest(this->globalState);
-				for (auto d = docFirst; d != docLast; ++d)
+				for (size_t i = 0; i < doc.Zs.size(); ++i, ++pos)
 				{
-					_RandGen rgc{};
-					auto tmpState = this->globalState;
-					initializeDocState<true>(*d, -1, generator, tmpState, rgc);
-					for (size_t i = 0; i < maxIter; ++i)
-					{
-						static_cast<const DerivedClass*>(this)->presampleDocument(*d, -1, tmpState, rgc, i);
-						static_cast<const DerivedClass*>(this)->template sampleDocument<ParallelScheme::none, true>(*d, edd, -1, tmpState, rgc, i);
-						static_cast<const DerivedClass*>(this)->template performSamplingGlobal<_ps, true>(&pool, tmpState, &rgc,
-							&*d, &*d + 1);
-						static_cast<const DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::inference>(
-							&pool, &tmpState, &rgc, &*d, &*d + 1);
-					}
-					double ll = static_cast<const DerivedClass*>(this)->getLLRest(tmpState) - gllRest;
-					ll += static_cast<const DerivedClass*>(this)->template getLLDocs<>(&*d, &*d + 1);
-					ret.emplace_back(ll);
+					if (doc.Zs[i] == base.zs[pos]) continue;
+					if (topics.size() >= maxChanges) return false;
+					uint64_t gap = pos - last;
+					for (; gap >= 0x80; gap >>= 7) gaps.emplace_back((uint8_t)(gap | 0x80));
+					gaps.emplace_back((uint8_t)gap);
+					topics.emplace_back(doc.Zs[i]);
+					last = pos;
 				}
-				return ret;
 			}
-			else
+
+			serializer::writeMany(writer, serializer::to_key("TLCD"), (uint32_t)0, base.id, (uint64_t)(base.numDeltas + 1),
+				numTokens, (uint64_t)this->globalStep, alpha, alphas, eta,
+				gaps, tvector<Tid>{ topics.data(), topics.size() });
+
+			pos = 0;
+			for (auto& doc : this->docs)
 			{
-				ThreadPool pool{ numWorkers, numWorkers * 8 };
-				ExtraDocData edd;
-				std::vector<std::future<double>> res;
-				const double gllRest = static_cast<const DerivedClass*>(this)->getLLRest(this->globalState);
-				for (auto d = docFirst; d != docLast; ++d)
-				{
-					res.emplace_back(pool.enqueue([&, d](size_t threadId)
-					{
-						_RandGen rgc{};
-						auto tmpState = this->globalState;
-						initializeDocState<true>(*d, -1, generator, tmpState, rgc);
-						for (size_t i = 0; i < maxIter; ++i)
-						{
-							static_cast<const DerivedClass*>(this)->presampleDocument(*d, -1, tmpState, rgc, i);
-							static_cast<const DerivedClass*>(this)->template sampleDocument<ParallelScheme::none, true>(
-								*d, edd, -1, tmpState, rgc, i
-							);
-							static_cast<const DerivedClass*>(this)->template performSamplingGlobal<_ps, true>(nullptr, tmpState, &rgc,
-								&*d, &*d + 1);
-							static_cast<const DerivedClass*>(this)->template sampleGlobalLevel<GlobalSampler::inference>(
-								nullptr, &tmpState, &rgc, &*d, &*d + 1
-							);
-						}
-						double ll = static_cast<const DerivedClass*>(this)->getLLRest(tmpState) - gllRest;
-						ll += static_cast<const DerivedClass*>(this)->template getLLDocs<>(&*d, &*d + 1);
-						return ll;
-					}));
-				}
-				std::vector<double> ret;
-				for (auto& r : res) ret.emplace_back(r.get());
-				return ret;
+				std::copy(doc.Zs.begin(), doc.Zs.end(), base.zs.begin() + pos);
+				pos += doc.Zs.size();
 			}
+			++base.numDeltas;
+			return true;
 		}
 
-	public:
-		DEFINE_SERIALIZER_WITH_VERSION(0, vocabWeights, alpha, alphas, eta, K);
+		size_t restoreCheckpoint(std::istream& reader, const std::vector<std::vector<char>>& deltas) override
+		{
+			return _restoreCheckpoint(reader, deltas, std::is_same<_Derived, void>{});
+		}
 
-		DEFINE_TAGGED_SERIALIZER_WITH_VERSION(1, 0x00010001, vocabWeights, alpha, alphas, eta, K, etaByWord,
-			burnIn, optimInterval);
+		size_t _restoreCheckpoint(std::istream& reader, const std::vector<std::vector<char>>& deltas, std::false_type)
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "only LDAModel supports checkpoints");
+		}
 
-		LDAModel(const LDAArgs& args, bool checkAlpha = true)
-			: BaseClass(args.seed), K(args.k), alpha(args.alpha[0]), eta(args.eta)
+		size_t _restoreCheckpoint(std::istream& reader, const std::vector<std::vector<char>>& deltas, std::true_type)
 		{
-			if (K == 0 || K >= 0x80000000) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong K value (K = %zd)", K));
+			if (!this->globalState.numByTopic.size() || getNumNewDocs()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the model is not prepared yet");
 
-			if (args.alpha.size() == 1)
+			uint32_t version, k;
+			uint64_t numDocs, numTokens, wordHash, step, id = 0;
+			Float newAlpha, newEta;
+			Vector newAlphas;
+			serializer::readMany(reader, serializer::to_key("TLCP"), version, k, numDocs, numTokens, wordHash, step);
+			if (version > 1) throw std::ios_base::failure{ text::format("unsupported checkpoint version (%u)", version) };
+			// checkpoints of version 0 have no deltas
+			if (version >= 1) serializer::readMany(reader, id);
+			serializer::readMany(reader, newAlpha, newAlphas, newEta);
+
+			uint64_t myTokens = 0;
+			for (auto& doc : this->docs) myTokens += doc.Zs.size();
+			if (k != K || numDocs != this->docs.size() || numTokens != myTokens || wordHash != hashDocWords())
 			{
-				alphas = Vector::Constant(K, alpha);
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the checkpoint was written by a model with other topics or documents");
 			}
-			else if (args.alpha.size() == args.k)
+
+			// nothing is changed until the whole checkpoint and its deltas are read and validated
+			std::vector<Tid> zs(numTokens);
+			reader.read((char*)zs.data(), sizeof(Tid) * zs.size());
+			if (!reader) throw std::ios_base::failure{ "the checkpoint is truncated" };
+			if (std::any_of(zs.begin(), zs.end(), [&](Tid z) { return z >= K; }))
 			{
-				alphas = Eigen::Map<const Vector>(args.alpha.data(), args.alpha.size());
+				THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the checkpoint has a wrong topic assignment");
 			}
-			else if (checkAlpha)
+
+			size_t numReplayed = 0;
+			for (auto& delta : deltas)
 			{
-				THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong alpha value (len = %zd)", args.alpha.size()));
+				if (!id) break;
+				serializer::imstream dstr{ delta.data(), (std::ptrdiff_t)delta.size() };
+				uint32_t dVersion;
+				uint64_t dId, seq, dTokens;
+				serializer::readMany(dstr, serializer::to_key("TLCD"), dVersion);
+				if (dVersion != 0) throw std::ios_base::failure{ text::format("unsupported delta checkpoint version (%u)", dVersion) };
+				serializer::readMany(dstr, dId, seq);
+				if (dId != id || seq != numReplayed + 1) break;
+
+				std::vector<uint8_t> gaps;
+				tvector<Tid> topics;
+				serializer::readMany(dstr, dTokens, step, newAlpha, newAlphas, newEta, gaps, topics);
+				if (dTokens != numTokens) throw std::ios_base::failure{ "the delta checkpoint doesn't match the checkpoint" };
+				size_t p = 0;
+				uint64_t pos = 0;
+				for (auto z : topics)
+				{
+					uint64_t gap = 0;
+					for (size_t shift = 0; ; shift += 7)
+					{
+						if (p >= gaps.size() || shift > 63) throw std::ios_base::failure{ "the delta checkpoint is broken" };
+						const uint8_t b = gaps[p++];
+						gap |= (uint64_t)(b & 0x7F) << shift;
+						if (!(b & 0x80)) break;
+					}
+					pos += gap;
+					if (pos >= numTokens || z >= K) throw std::ios_base::failure{ "the delta checkpoint is broken" };
+					zs[pos] = z;
+				}
+				if (p != gaps.size()) throw std::ios_base::failure{ "the delta checkpoint is broken" };
+				++numReplayed;
 			}
 
-			if ((alphas.array() <= 0).any()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "wrong alpha value");
-			if (eta <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong eta value (eta = %f)", eta));
+			detachShared();
+			invalidateCaches();
+			size_t offset = 0;
+			for (auto& doc : this->docs)
+			{
+				std::copy(zs.begin() + offset, zs.begin() + offset + doc.Zs.size(), doc.Zs.begin());
+				offset += doc.Zs.size();
+			}
+			alpha = newAlpha;
+			alphas = newAlphas;
+			eta = newEta;
+			this->globalStep = step;
+			resetStatisticsParallel();
+			prepareProposalTables(nullptr, true, std::integral_constant<bool, isSamplingMethodSupported(SamplingMethod::mh)>{});
+			return numReplayed;
 		}
 
-		GETTER(K, size_t, K);
-		GETTER(Alpha, Float, alpha);
-		GETTER(Eta, Float, eta);
-		GETTER(OptimInterval, size_t, optimInterval);
-		GETTER(BurnInIteration, size_t, burnIn);
-
-		Float getAlpha(size_t k1) const override { return alphas[k1]; }
-
 		TermWeight getTermWeight() const override
 		{
 			return _tw;
@@ -1015,6 +5448,33 @@ namespace tomoto
 			return std::make_unique<_DocType>(as_mutable(this)->template _makeFromRawDoc<true>(rawDoc));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			return this->_addDocs(batch, numWorkers);
+		}
+
+		void setWarmStart(const ILDAModel* source) override
+		{
+			if (!source)
+			{
+				warmStart.reset();
+				return;
+			}
+			if (!std::is_same<_Derived, void>::value) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				"This model doesn't support warm start");
+			if (source->getK() != K) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+				text::format("the source of warm start should have the same number of topics (K = %zd, source K = %zd)", K, source->getK()));
+			auto ws = std::make_shared<WarmStart>();
+			ws->dict = source->getVocabDict();
+			ws->phi.resize(K, source->getV());
+			for (size_t k = 0; k < K; ++k)
+			{
+				auto d = source->getWidsByTopic(k, true);
+				ws->phi.row(k) = Eigen::Map<const Eigen::Matrix<Float, 1, -1>>{ d.data(), (Eigen::Index)d.size() };
+			}
+			warmStart = std::move(ws);
+		}
+
 		void setWordPrior(const std::string& word, const std::vector<Float>& priors) override
 		{
 			if (priors.size() != K) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "priors.size() must be equal to K.");
@@ -1037,7 +5497,7 @@ namespace tomoto
 			{
 				auto id = this->dict.toWid(word);
 				if (id == (Vid)-1) return {};
-				auto col = etaByTopicWord.col(id);
+				auto col = getWordPriorCol(id);
 				return std::vector<Float>{ col.data(), col.data() + col.size() };
 			}
 			else
@@ -1057,8 +5517,34 @@ namespace tomoto
 			}
 		}
 
+		/*
+		prepares the model whose documents already view `words`, `sharedZs` and `sharedWordWeights` with their final topics
+		and whose globalState holds their topic-word counts, like the one built by `HDPModel::convertToLDA`.
+		Unlike `prepare(false)`, it takes the arrays as they are instead of trading them into new ones.
+		*/
+		void prepareConverted()
+		{
+			invalidateCaches();
+			static_cast<DerivedClass*>(this)->initGlobalState(false);
+			static_cast<DerivedClass*>(this)->prepareWordPriors();
+			this->forEachPrepareChunk(this->getNumPrepareThreads(this->docs.size()), this->docs.size(), [&](size_t, size_t, size_t b, size_t e)
+			{
+				for (size_t i = b; i < e; ++i)
+				{
+					this->docs[i].template update<>(getTopicDocPtr(i), *static_cast<DerivedClass*>(this));
+					static_cast<DerivedClass*>(this)->updateSumWordWeight(this->docs[i]);
+				}
+			});
+			updateSampleOrder();
+			numPreparedDocs = this->docs.size();
+			numPreparedVocabs = this->dict.size();
+			BaseClass::prepare(false, 0, 0, 0, false);
+		}
+
 		void prepare(bool initDocs = true, size_t minWordCnt = 0, size_t minWordDf = 0, size_t removeTopN = 0, bool updateStopwords = true) override
 		{
+			detachShared();
+			invalidateCaches();
 			if (initDocs && updateStopwords) this->removeStopwords(minWordCnt, minWordDf, removeTopN);
 			static_cast<DerivedClass*>(this)->updateWeakArray();
 			static_cast<DerivedClass*>(this)->initGlobalState(initDocs);
@@ -1075,14 +5561,29 @@ namespace tomoto
 				if (_tw != TermWeight::one)
 				{
 					df.resize(V);
-					tf.resize(V);
-					for (auto& doc : this->docs)
+					const size_t numThreads = this->getNumPrepareThreads(this->docs.size());
+					std::vector<std::vector<uint32_t>> localDf(numThreads);
+					std::vector<std::vector<size_t>> lastDoc(numThreads);
+					this->forEachPrepareChunk(numThreads, this->docs.size(), [&](size_t t, size_t, size_t b, size_t e)
 					{
-						for (auto w : std::unordered_set<Vid>{ doc.words.begin(), doc.words.end() })
+						if (localDf[t].empty())
+						{
+							localDf[t].resize(V);
+							lastDoc[t].resize(V, (size_t)-1);
+						}
+						for (size_t i = b; i < e; ++i)
 						{
-							if (w >= this->realV) continue;
-							++df[w];
+							for (auto w : this->docs[i].words)
+							{
+								if (w >= this->realV || lastDoc[t][w] == i) continue;
+								lastDoc[t][w] = i;
+								++localDf[t][w];
+							}
 						}
+					});
+					for (auto& l : localDf)
+					{
+						for (size_t i = 0; i < l.size(); ++i) df[i] += l[i];
 					}
 					totCf = std::accumulate(this->vocabCf.begin(), this->vocabCf.end(), 0);
 				}
@@ -1103,19 +5604,24 @@ namespace tomoto
 					}
 				}
 
+				if (warmStart) alignWarmStart();
 				decltype(static_cast<DerivedClass*>(this)->makeGeneratorForInit(nullptr)) generator;
 				if(!(m_flags & flags::generator_by_doc)) generator = static_cast<DerivedClass*>(this)->makeGeneratorForInit(nullptr);
-				for (auto& doc : this->docs)
-				{
-					initializeDocState<false>(doc, &doc - &this->docs[0], generator, this->globalState, this->rg);
-				}
+				static_cast<DerivedClass*>(this)->initializeDocs(std::integral_constant<bool, std::is_same<_Derived, void>::value>{}, generator);
+				warmStart.reset();
+				warmStartPhi = {};
+				if (collapseDuplicates && std::is_same<_Derived, void>::value && outOfCoreDir.empty()) collapseDuplicateDocs();
 			}
 			else
 			{
 				static_cast<DerivedClass*>(this)->updateDocs();
-				for (auto& doc : this->docs) doc.updateSumWordWeight(this->realV);
+				for (auto& doc : this->docs) static_cast<DerivedClass*>(this)->updateSumWordWeight(doc);
 			}
 			static_cast<DerivedClass*>(this)->prepareShared();
+			if (!outOfCoreDir.empty()) moveDocsOutOfCore();
+			updateSampleOrder();
+			numPreparedDocs = this->docs.size();
+			numPreparedVocabs = this->dict.size();
 			BaseClass::prepare(initDocs, minWordCnt, minWordDf, removeTopN, updateStopwords);
 		}
 
@@ -1150,7 +5656,7 @@ namespace tomoto
 		for (size_t i = 0; i < Zs.size(); ++i)
 		{
 			if (this->words[i] >= mdl.getV()) continue;
-			numByTopic[Zs[i]] += _tw != TermWeight::one ? wordWeights[i] : 1;
+			numByTopic[Zs[i]] += mdl.getWordWeight(*this, i);
 		}
 	}
 }
\ No newline at end of file
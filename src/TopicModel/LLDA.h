@@ -10,6 +10,20 @@ namespace tomoto
 		using DocumentLDA<_tw>::DocumentLDA;
 		using WeightType = typename DocumentLDA<_tw>::WeightType;
 		Eigen::Matrix<int8_t, -1, 1> labelMask;
+		std::vector<Tid> labelTopics; // the topics allowed by `labelMask` in ascending order, filled when the document is sampled first
+
+		// fills `labelTopics` from `labelMask` if it is empty
+		const std::vector<Tid>& getLabelTopics()
+		{
+			if (labelTopics.empty())
+			{
+				for (Eigen::Index k = 0; k < labelMask.size(); ++k)
+				{
+					if (labelMask[k]) labelTopics.emplace_back((Tid)k);
+				}
+			}
+			return labelTopics;
+		}
 
 		DEFINE_SERIALIZER_AFTER_BASE_WITH_VERSION(BaseDocument, 0, labelMask);
 		DEFINE_TAGGED_SERIALIZER_AFTER_BASE_WITH_VERSION(BaseDocument, 1, 0x00010001, labelMask);
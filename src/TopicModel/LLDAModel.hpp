@@ -47,9 +47,36 @@ namespace tomoto
 			return &zLikelihood[0];
 		}
 
+		/*
+		samples only over the topics allowed by the labels of `doc`, which `getZLikelihoods` masks out of all K topics,
+		so documents with a few of many labels are sampled in the time proportional to their labels.
+		*/
+		template<typename _Rng>
+		void sampleTokens(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e) const
+		{
+			if (this->samplingMethod == SamplingMethod::dense)
+			{
+				auto& topics = doc.getLabelTopics();
+				if (!topics.empty() && topics.size() < this->K) return this->sampleTokensRestricted(doc, ld, rgs, b, e, topics);
+			}
+			return BaseClass::sampleTokens(doc, docId, ld, rgs, iterationCnt, b, e);
+		}
+
+		static constexpr bool isSamplingMethodSupported(SamplingMethod method)
+		{
+			return method == SamplingMethod::dense
+				|| (method == SamplingMethod::mh && std::is_same<_Derived, void>::value);
+		}
+
+		Float getTopicPrior(const _DocType& doc, Tid k) const
+		{
+			return doc.labelMask[k] ? this->alphas[k] : 0;
+		}
+
 		void prepareDoc(_DocType& doc, size_t docId, size_t wordSize) const
 		{
 			BaseClass::prepareDoc(doc, docId, wordSize);
+			doc.labelTopics.clear();
 			if (doc.labelMask.size() == 0)
 			{
 				doc.labelMask.resize(this->K);
@@ -93,7 +120,7 @@ namespace tomoto
 			auto w = doc.words[i];
 			if (this->etaByTopicWord.size())
 			{
-				Eigen::Array<Float, -1, 1> col = this->etaByTopicWord.col(w);
+				Eigen::Array<Float, -1, 1> col = this->getWordPriorCol(w);
 				col *= g.p;
 				z = sample::sampleFromDiscrete(col.data(), col.data() + col.size(), rgs);
 			}
@@ -174,6 +201,11 @@ namespace tomoto
 			return std::make_unique<_DocType>(as_mutable(this)->template _updateDoc<true>(doc, rawDoc.template getMiscDefault<std::vector<std::string>>("labels")));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "documents of this model need misc data, so they should be added by `addDoc`.");
+		}
+
 		std::vector<Float> _getTopicsByDoc(const _DocType& doc, bool normalize) const
 		{
 			if (!doc.numByTopic.size()) return {};
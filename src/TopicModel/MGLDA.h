@@ -17,10 +17,35 @@ namespace tomoto
 		std::vector<uint8_t> Vs; // window assignment
 		WeightType numGl = 0; // number of words assigned as gl.
 		//std::vector<uint32_t> numByTopic; // len = K + KL
-		Eigen::Matrix<WeightType, -1, -1> numBySentWin; // len = S * T
-		Eigen::Matrix<WeightType, -1, 1> numByWinL; // number of words assigned as loc. in the window (len = S + T - 1)
-		Eigen::Matrix<WeightType, -1, 1> numByWin; // number of words in the window (len = S + T - 1)
-		Eigen::Matrix<WeightType, -1, -1> numByWinTopicL; // number of words in the loc. topic in the window (len = KL * (S + T - 1))
+		// window counts below are views into a single arena shared by all documents of a prepared model
+		ShareableMatrix<WeightType, -1, -1> numBySentWin; // len = S * T
+		ShareableMatrix<WeightType, -1, 1> numByWinL; // number of words assigned as loc. in the window (len = S + T - 1)
+		ShareableMatrix<WeightType, -1, 1> numByWin; // number of words in the window (len = S + T - 1)
+		ShareableMatrix<WeightType, -1, -1> numByWinTopicL; // number of words in the loc. topic in the window (len = KL * (S + T - 1))
+
+		size_t getWindowCountSize() const
+		{
+			return numBySentWin.size() + numByWinL.size() + numByWin.size() + numByWinTopicL.size();
+		}
+
+		// makes the window counts views into `ptr`, copying their current values into it if `copy` is true
+		void bindWindowCounts(WeightType* ptr, bool copy)
+		{
+			for (auto* m : { &numBySentWin, &numByWinTopicL })
+			{
+				const auto rows = m->rows(), cols = m->cols();
+				if (copy) std::copy(m->data(), m->data() + m->size(), ptr);
+				m->init(ptr, rows, cols);
+				ptr += rows * cols;
+			}
+			for (auto* m : { &numByWinL, &numByWin })
+			{
+				const auto rows = m->rows();
+				if (copy) std::copy(m->data(), m->data() + m->size(), ptr);
+				m->init(ptr, rows, 1);
+				ptr += rows;
+			}
+		}
 
 		DEFINE_SERIALIZER_AFTER_BASE_WITH_VERSION(BaseDocument, 0, sents, Vs, numGl, numBySentWin, numByWinL, numByWin, numByWinTopicL);
 		DEFINE_TAGGED_SERIALIZER_AFTER_BASE_WITH_VERSION(BaseDocument, 1, 0x00010001, sents, Vs, numGl, numBySentWin, numByWinL, numByWin, numByWinTopicL);
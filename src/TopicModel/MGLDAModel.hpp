@@ -33,8 +33,14 @@ namespace tomoto
 		Float gamma;
 		Tid KL;
 		uint32_t T; // window size
-
-		// window and gl./loc. and topic assignment likelihoods for new word. ret T*(K+KL) FLOATs
+		std::vector<WeightType> sharedWinCounts;
+
+		/*
+		window and gl./loc. and topic assignment likelihoods for new word.
+		The global part factorizes into a window term and a topic term, so it takes only one entry after the local ones
+		and the window and the topic are drawn separately from the T and K FLOATs that follow it.
+		ret T*KL+1 FLOATs (accumulated), T FLOATs, K FLOATs
+		*/
 		Float* getVZLikelihoods(_ModelState& ld, const _DocType& doc, Vid vid, uint16_t s) const
 		{
 			const auto V = this->realV;
@@ -43,22 +49,27 @@ namespace tomoto
 			const auto eta = this->eta;
 			assert(vid < V);
 			auto& zLikelihood = ld.zLikelihood;
+			const size_t nLocal = T * KL;
+			auto winLikelihood = zLikelihood.segment(nLocal + 1, T);
 			for (size_t v = 0; v < T; ++v)
 			{
 				Float pLoc = (doc.numByWinL[s + v] + alphaML) / (doc.numByWin[s + v] + alphaM + alphaML);
 				Float pW = doc.numBySentWin(s, v) + gamma;
-				if (K)
-				{
-					zLikelihood.segment(v * (K + KL), K) = (1 - pLoc) * pW
-						* (doc.numByTopic.segment(0, K).array().template cast<Float>() + alpha) / (doc.numGl + K * alpha)
-						* (ld.numByTopicWord.block(0, vid, K, 1).array().template cast<Float>() + eta) / (ld.numByTopic.segment(0, K).array().template cast<Float>() + V * eta);
-				}
-				zLikelihood.segment(v * (K + KL) + K, KL) = pLoc * pW
+				winLikelihood[v] = (1 - pLoc) * pW;
+				zLikelihood.segment(v * KL, KL) = pLoc * pW
 					* (doc.numByWinTopicL.col(s + v).array().template cast<Float>()) / (doc.numByWinL[s + v] + KL * alphaL)
 					* (ld.numByTopicWord.block(K, vid, KL, 1).array().template cast<Float>() + etaL) / (ld.numByTopic.segment(K, KL).array().template cast<Float>() + V * etaL);
 			}
 
-			sample::prefixSum(zLikelihood.data(), T * (K + KL));
+			sample::prefixSum(zLikelihood.data(), nLocal);
+			zLikelihood[nLocal] = nLocal ? zLikelihood[nLocal - 1] : 0;
+			if (K)
+			{
+				auto topicLikelihood = zLikelihood.segment(nLocal + 1 + T, K);
+				topicLikelihood = (doc.numByTopic.segment(0, K).array().template cast<Float>() + alpha) / (doc.numGl + K * alpha)
+					* (ld.numByTopicWord.block(0, vid, K, 1).array().template cast<Float>() + eta) / (ld.numByTopic.segment(0, K).array().template cast<Float>() + V * eta);
+				zLikelihood[nLocal] += winLikelihood.sum() * topicLikelihood.sum();
+			}
 			return &zLikelihood[0];
 		}
 
@@ -113,9 +124,18 @@ namespace tomoto
 				if (doc.words[w] >= this->realV) continue;
 				addWordTo<-1>(ld, doc, w, doc.words[w], doc.Zs[w] - (doc.Zs[w] < K ? 0 : K), doc.sents[w], doc.Vs[w], doc.Zs[w] < K ? 0 : 1);
 				auto dist = getVZLikelihoods(ld, doc, doc.words[w], doc.sents[w]);
-				auto vz = sample::sampleFromDiscreteAcc(dist, dist + T * (K + KL), rgs);
-				doc.Vs[w] = vz / (K + KL);
-				doc.Zs[w] = vz % (K + KL);
+				const size_t nLocal = T * KL;
+				auto vz = sample::sampleFromDiscreteAcc(dist, dist + nLocal + (K ? 1 : 0), rgs);
+				if (vz < nLocal)
+				{
+					doc.Vs[w] = vz / KL;
+					doc.Zs[w] = vz % KL + K;
+				}
+				else
+				{
+					doc.Vs[w] = sample::sampleFromDiscrete(dist + nLocal + 1, dist + nLocal + 1 + T, rgs);
+					doc.Zs[w] = sample::sampleFromDiscrete(dist + nLocal + 1 + T, dist + nLocal + 1 + T + K, rgs);
+				}
 				addWordTo<1>(ld, doc, w, doc.words[w], doc.Zs[w] - (doc.Zs[w] < K ? 0 : K), doc.sents[w], doc.Vs[w], doc.Zs[w] < K ? 0 : 1);
 			}
 		}
@@ -293,16 +313,46 @@ namespace tomoto
 			doc.Vs.resize(wordSize);
 			if (_tw != TermWeight::one) doc.wordWeights.resize(wordSize);
 			doc.numByTopic.init(nullptr, this->K + KL, 1);
-			doc.numBySentWin = Eigen::Matrix<WeightType, -1, -1>::Zero(S, T);
-			doc.numByWin = Eigen::Matrix<WeightType, -1, 1>::Zero(S + T - 1);
-			doc.numByWinL = Eigen::Matrix<WeightType, -1, 1>::Zero(S + T - 1);
-			doc.numByWinTopicL = Eigen::Matrix<WeightType, -1, -1>::Zero(KL, S + T - 1);
+			doc.numBySentWin.init(nullptr, S, T);
+			doc.numByWin.init(nullptr, S + T - 1, 1);
+			doc.numByWinL.init(nullptr, S + T - 1, 1);
+			doc.numByWinTopicL.init(nullptr, KL, S + T - 1);
+		}
+
+		/*
+		moves the window counts of all documents into `sharedWinCounts`,
+		so that they take one allocation instead of four per document and lie next to each other in the order of documents
+		*/
+		void prepareShared()
+		{
+			BaseClass::prepareShared();
+			size_t total = 0;
+			for (auto& doc : this->docs) total += doc.getWindowCountSize();
+			std::vector<WeightType> arena(total);
+			size_t offset = 0;
+			for (auto& doc : this->docs)
+			{
+				doc.bindWindowCounts(arena.data() + offset, true);
+				offset += doc.getWindowCountSize();
+			}
+			sharedWinCounts = std::move(arena);
+		}
+
+		void updateForCopy()
+		{
+			BaseClass::updateForCopy();
+			size_t offset = 0;
+			for (auto& doc : this->docs)
+			{
+				doc.bindWindowCounts(sharedWinCounts.data() + offset, false);
+				offset += doc.getWindowCountSize();
+			}
 		}
 
 		void initGlobalState(bool initDocs)
 		{
 			const size_t V = this->realV;
-			this->globalState.zLikelihood = Vector::Zero(T * (this->K + KL));
+			this->globalState.zLikelihood = Vector::Zero(T * KL + 1 + T + this->K);
 			if (initDocs)
 			{
 				this->globalState.numByTopic = Eigen::Matrix<WeightType, -1, 1>::Zero(this->K + KL);
@@ -335,7 +385,7 @@ namespace tomoto
 			size_t r, z;
 			if (this->etaByTopicWord.size())
 			{
-				Eigen::Array<Float, -1, 1> col = this->etaByTopicWord.col(w);
+				Eigen::Array<Float, -1, 1> col = this->getWordPriorCol(w);
 				col.head(this->K) *= alphaM / this->K;
 				col.tail(this->KL) *= alphaML / this->KL;
 				doc.Zs[i] = z = sample::sampleFromDiscrete(col.data(), col.data() + col.size(), rgs);
@@ -516,6 +566,11 @@ namespace tomoto
 			return std::make_unique<_DocType>(as_mutable(this)->template _makeFromRawDoc<true>(rawDoc));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "documents of this model need misc data, so they should be added by `addDoc`.");
+		}
+
 		void setWordPrior(const std::string& word, const std::vector<Float>& priors) override
 		{
 			if (priors.size() != this->K + KL) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "priors.size() must be equal to K.");
@@ -543,6 +598,12 @@ namespace tomoto
 			return ret;
 		}
 
+		// global topics followed by local topics
+		size_t getNumWidsTopics() const
+		{
+			return this->K + KL;
+		}
+
 		GETTER(KL, size_t, KL);
 		GETTER(T, size_t, T);
 		GETTER(Gamma, Float, gamma);
@@ -0,0 +1,334 @@
+#include "MultiChainLDA.h"
+#include "BatchUtils.hpp"
+#include "../Utils/math.h"
+
+namespace tomoto
+{
+	namespace detail
+	{
+		// runs `fn(i)` for i in [0, n) on `pool` if given, and waits for all of them
+		template<typename _Fn>
+		void runTasks(ThreadPool* pool, size_t n, _Fn&& fn)
+		{
+			if (!pool || n <= 1)
+			{
+				for (size_t i = 0; i < n; ++i) fn(i);
+				return;
+			}
+			std::vector<std::future<void>> res;
+			for (size_t i = 0; i < n; ++i)
+			{
+				res.emplace_back(pool->enqueue([&, i](size_t) { fn(i); }));
+			}
+			for (auto& r : res) r.get();
+		}
+	}
+
+	MultiChainLDA::MultiChainLDA(const MultiChainLDAArgs& args)
+		: alpha{ args.alpha }, eta{ args.eta }
+	{
+		if (args.ks.empty() || !args.chainsPerK) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "at least one chain is required");
+		if (alpha <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong alpha value (alpha = %f)", alpha));
+		if (eta <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong eta value (eta = %f)", eta));
+		for (auto k : args.ks)
+		{
+			if (!k || k >= 0x8000) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong K value (K = %zd)", k));
+			for (size_t i = 0; i < args.chainsPerK; ++i)
+			{
+				chains.emplace_back();
+				auto& c = chains.back();
+				c.K = k;
+				c.seed = args.seed + chains.size() - 1;
+				c.numByTopicDoc = Counts::Zero(k, 0);
+				c.numByTopicWord = Counts::Zero(k, 0);
+				c.numByTopic = CountVector::Zero(k);
+			}
+		}
+	}
+
+	const MultiChainLDA::Chain& MultiChainLDA::getChain(size_t chainId) const
+	{
+		if (chainId >= chains.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong chain id (chainId = %zd)", chainId));
+		return chains[chainId];
+	}
+
+	std::vector<Vid> MultiChainLDA::toWids(const std::vector<std::string>& doc, bool addNew)
+	{
+		std::vector<Vid> ret;
+		for (auto& w : doc)
+		{
+			auto id = addNew ? dict.add(w) : dict.toWid(w);
+			if (id == non_vocab_id) continue;
+			ret.emplace_back(id);
+		}
+		return ret;
+	}
+
+	size_t MultiChainLDA::addDoc(const std::vector<Vid>& doc)
+	{
+		for (auto w : doc)
+		{
+			if (w >= dict.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("word id %u is out of the vocabulary", w));
+		}
+		words.insert(words.end(), doc.begin(), doc.end());
+		docOffsets.emplace_back(words.size());
+		return getNumDocs() - 1;
+	}
+
+	void MultiChainLDA::prepare(Chain& c) const
+	{
+		const size_t V = dict.size(), D = getNumDocs();
+		const size_t oldV = c.numByTopicWord.cols(), oldD = c.numByTopicDoc.cols();
+		if (V > oldV)
+		{
+			c.numByTopicWord.conservativeResize(c.K, V);
+			c.numByTopicWord.rightCols(V - oldV).setZero();
+		}
+		if (D > oldD)
+		{
+			c.numByTopicDoc.conservativeResize(c.K, D);
+			c.numByTopicDoc.rightCols(D - oldD).setZero();
+		}
+		if (c.Zs.size() == words.size()) return;
+
+		std::mt19937_64 rg{ c.seed + c.Zs.size() };
+		std::uniform_int_distribution<size_t> randomTopic{ 0, c.K - 1 };
+		size_t d = std::upper_bound(docOffsets.begin(), docOffsets.end(), c.Zs.size()) - docOffsets.begin() - 1;
+		for (size_t i = c.Zs.size(); i < words.size(); ++i)
+		{
+			while (docOffsets[d + 1] <= i) ++d;
+			const Tid z = (Tid)randomTopic(rg);
+			c.Zs.emplace_back(z);
+			++c.numByTopicDoc(z, d);
+			++c.numByTopicWord(z, words[i]);
+			++c.numByTopic[z];
+		}
+	}
+
+	void MultiChainLDA::rebuildCounts(Chain& c) const
+	{
+		c.numByTopicDoc.setZero();
+		c.numByTopicWord.setZero();
+		c.numByTopic.setZero();
+		for (size_t d = 0; d < (size_t)c.numByTopicDoc.cols(); ++d)
+		{
+			for (size_t i = docOffsets[d]; i < docOffsets[d + 1]; ++i)
+			{
+				const Tid z = c.Zs[i];
+				++c.numByTopicDoc(z, d);
+				++c.numByTopicWord(z, words[i]);
+				++c.numByTopic[z];
+			}
+		}
+	}
+
+	double MultiChainLDA::getLL(const Chain& c) const
+	{
+		const size_t D = c.numByTopicDoc.cols(), V = c.numByTopicWord.cols();
+		if (!D || !docOffsets[D]) return 0;
+		double ll = 0;
+		const Float alphaSum = alpha * c.K, vEta = eta * V;
+		// the terms of zero counts vanish, so only the nonzero ones are evaluated
+		for (size_t d = 0; d < D; ++d)
+		{
+			ll -= math::lgammaSubt(alphaSum, (Float)(docOffsets[d + 1] - docOffsets[d]));
+			for (size_t k = 0; k < c.K; ++k)
+			{
+				if (c.numByTopicDoc(k, d)) ll += math::lgammaSubt(alpha, (Float)c.numByTopicDoc(k, d));
+			}
+		}
+		for (size_t k = 0; k < c.K; ++k)
+		{
+			ll -= math::lgammaSubt(vEta, (Float)c.numByTopic[k]);
+		}
+		for (size_t v = 0; v < V; ++v)
+		{
+			for (size_t k = 0; k < c.K; ++k)
+			{
+				if (c.numByTopicWord(k, v)) ll += math::lgammaSubt(eta, (Float)c.numByTopicWord(k, v));
+			}
+		}
+		return ll / docOffsets[D];
+	}
+
+	void MultiChainLDA::train(size_t iteration, size_t numWorkers)
+	{
+		for (auto& c : chains) prepare(c);
+		const size_t D = getNumDocs(), V = dict.size();
+		if (!D) return;
+		if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+		numWorkers = std::max(numWorkers, (size_t)1);
+
+		// the workers left over by the chains split the documents of each chain
+		const size_t numParts = std::max(std::min(numWorkers / chains.size(), D), (size_t)1);
+		std::unique_ptr<ThreadPool> pool;
+		if (numWorkers > 1) pool = std::make_unique<ThreadPool>(std::min(numWorkers, chains.size() * numParts));
+
+		// with multiple parts, each one updates its own copy of the topic-word counts, and their changes are merged after each sweep
+		std::vector<std::vector<Counts>> localWord(chains.size());
+		std::vector<std::vector<CountVector>> localTopic(chains.size());
+		const Float vEta = eta * V;
+		for (size_t it = 0; it < iteration; ++it)
+		{
+			if (numParts > 1)
+			{
+				for (size_t c = 0; c < chains.size(); ++c)
+				{
+					localWord[c].assign(numParts, chains[c].numByTopicWord);
+					localTopic[c].assign(numParts, chains[c].numByTopic);
+				}
+			}
+
+			detail::runTasks(pool.get(), chains.size() * numParts, [&](size_t task)
+			{
+				const size_t ci = task / numParts, p = task % numParts;
+				auto& c = chains[ci];
+				Counts& wordCnt = numParts > 1 ? localWord[ci][p] : c.numByTopicWord;
+				CountVector& topicCnt = numParts > 1 ? localTopic[ci][p] : c.numByTopic;
+				std::seed_seq seq{ c.seed, globalStep, (uint64_t)p };
+				std::mt19937_64 rg{ seq };
+				std::uniform_real_distribution<Float> unif;
+				std::vector<Float> dist(c.K);
+				for (size_t d = D * p / numParts; d < D * (p + 1) / numParts; ++d)
+				{
+					auto docCnt = c.numByTopicDoc.col(d);
+					for (size_t i = docOffsets[d]; i < docOffsets[d + 1]; ++i)
+					{
+						const Vid w = words[i];
+						Tid& z = c.Zs[i];
+						--docCnt[z];
+						--wordCnt(z, w);
+						--topicCnt[z];
+
+						Float acc = 0;
+						for (size_t k = 0; k < c.K; ++k)
+						{
+							acc += (docCnt[k] + alpha) * (wordCnt(k, w) + eta) / (topicCnt[k] + vEta);
+							dist[k] = acc;
+						}
+						z = (Tid)std::min((size_t)(std::upper_bound(dist.begin(), dist.end(), unif(rg) * acc) - dist.begin()), c.K - 1);
+
+						++docCnt[z];
+						++wordCnt(z, w);
+						++topicCnt[z];
+					}
+				}
+			});
+
+			detail::runTasks(pool.get(), chains.size(), [&](size_t ci)
+			{
+				auto& c = chains[ci];
+				if (numParts > 1)
+				{
+					const Counts base = c.numByTopicWord;
+					for (auto& l : localWord[ci]) c.numByTopicWord += l - base;
+					const CountVector baseTopic = c.numByTopic;
+					for (auto& l : localTopic[ci]) c.numByTopic += l - baseTopic;
+				}
+				c.llHistory.emplace_back(getLL(c));
+			});
+			++globalStep;
+		}
+	}
+
+	double MultiChainLDA::getRhat(const std::vector<size_t>& chainIds, size_t window) const
+	{
+		if (chainIds.size() < 2) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "at least two chains are required");
+		size_t minLen = -1;
+		for (auto id : chainIds)
+		{
+			auto& c = getChain(id);
+			if (c.K != getChain(chainIds[0]).K) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "all chains should have the same K");
+			minLen = std::min(minLen, c.llHistory.size());
+		}
+		if (!window) window = minLen / 2;
+		if (window < 2 || window > minLen) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+			text::format("wrong window (window = %zd, the number of sweeps = %zd)", window, minLen));
+
+		const size_t m = chainIds.size(), n = window;
+		std::vector<double> means(m), vars(m);
+		for (size_t j = 0; j < m; ++j)
+		{
+			auto& h = chains[chainIds[j]].llHistory;
+			auto first = h.end() - n;
+			means[j] = std::accumulate(first, h.end(), 0.) / n;
+			for (auto it = first; it != h.end(); ++it) vars[j] += (*it - means[j]) * (*it - means[j]);
+			vars[j] /= n - 1;
+		}
+		const double mean = std::accumulate(means.begin(), means.end(), 0.) / m;
+		double b = 0;
+		for (auto x : means) b += (x - mean) * (x - mean);
+		b *= (double)n / (m - 1);
+		const double w = std::accumulate(vars.begin(), vars.end(), 0.) / m;
+		if (w <= 0) return b > 0 ? INFINITY : 1;
+		return std::sqrt(((n - 1) * w / n + b / n) / w);
+	}
+
+	std::vector<Float> MultiChainLDA::getTopicWordDist(size_t chainId, size_t k) const
+	{
+		auto& c = getChain(chainId);
+		if (k >= c.K) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong topic id (k = %zd)", k));
+		std::vector<Float> ret(dict.size(), eta);
+		for (Eigen::Index v = 0; v < c.numByTopicWord.cols(); ++v) ret[v] += c.numByTopicWord(k, v);
+		const Float sum = c.numByTopic[k] + eta * dict.size();
+		for (auto& p : ret) p /= sum;
+		return ret;
+	}
+
+	std::vector<Float> MultiChainLDA::getDocTopicDist(size_t chainId, size_t docId) const
+	{
+		auto& c = getChain(chainId);
+		if (docId >= getNumDocs()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong document id (docId = %zd)", docId));
+		std::vector<Float> ret(c.K, alpha);
+		if (docId < (size_t)c.numByTopicDoc.cols())
+		{
+			for (size_t k = 0; k < c.K; ++k) ret[k] += c.numByTopicDoc(k, docId);
+		}
+		const Float sum = std::accumulate(ret.begin(), ret.end(), (Float)0);
+		for (auto& p : ret) p /= sum;
+		return ret;
+	}
+
+	void MultiChainLDA::write(std::ostream& writer) const
+	{
+		serializer::writeMany(writer, serializer::to_key("TMCL"), (uint32_t)0, alpha, eta, globalStep,
+			dict, words, docOffsets, (uint64_t)chains.size());
+		for (auto& c : chains)
+		{
+			serializer::writeMany(writer, (uint32_t)c.K, c.seed, c.Zs, c.llHistory,
+				(uint64_t)c.numByTopicWord.cols(), (uint64_t)c.numByTopicDoc.cols());
+		}
+	}
+
+	void MultiChainLDA::read(std::istream& reader)
+	{
+		uint32_t version;
+		uint64_t numChains;
+		serializer::readMany(reader, serializer::to_key("TMCL"), version, alpha, eta, globalStep,
+			dict, words, docOffsets, numChains);
+		if (version != 0) throw std::ios_base::failure{ "unsupported version of multi-chain LDA model" };
+		if (docOffsets.empty() || docOffsets.back() != words.size() || !numChains) throw std::ios_base::failure{ "broken multi-chain LDA model" };
+		chains.clear();
+		chains.resize(numChains);
+		for (auto& c : chains)
+		{
+			uint32_t k;
+			uint64_t v, d;
+			serializer::readMany(reader, k, c.seed, c.Zs, c.llHistory, v, d);
+			c.K = k;
+			if (!c.K || v > dict.size() || d >= docOffsets.size() || docOffsets[d] != c.Zs.size()) throw std::ios_base::failure{ "broken multi-chain LDA model" };
+			for (size_t i = 0; i < c.Zs.size(); ++i)
+			{
+				if (c.Zs[i] >= c.K || words[i] >= v) throw std::ios_base::failure{ "broken multi-chain LDA model" };
+			}
+			c.numByTopicWord = Counts::Zero(c.K, v);
+			c.numByTopicDoc = Counts::Zero(c.K, d);
+			c.numByTopic = CountVector::Zero(c.K);
+			rebuildCounts(c);
+		}
+		for (auto w : words)
+		{
+			if (w >= dict.size()) throw std::ios_base::failure{ "broken multi-chain LDA model" };
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include "LDA.h"
+
+namespace tomoto
+{
+	struct MultiChainLDAArgs
+	{
+		std::vector<size_t> ks = { 1 }; // the number of topics of each configuration
+		size_t chainsPerK = 1; // the number of chains with different seeds for each value of `ks`
+		Float alpha = (Float)0.1;
+		Float eta = (Float)0.01;
+		size_t seed = std::random_device{}();
+	};
+
+	/*
+	Several LDA chains trained by collapsed Gibbs sampling over one read-only store of documents.
+	Each chain holds only its topic assignments and counts, so a sweep over configurations and seeds
+	keeps a single copy of the corpus. All chains are sampled by one thread pool, and the log-likelihood
+	recorded after each sweep lets the chains of the same K be compared by the potential scale reduction factor.
+	*/
+	class MultiChainLDA
+	{
+		using Counts = Eigen::Matrix<int32_t, -1, -1>;
+		using CountVector = Eigen::Matrix<int32_t, -1, 1>;
+
+		struct Chain
+		{
+			size_t K = 0;
+			uint64_t seed = 0;
+			std::vector<Tid> Zs; // Dim: (Words, ), the topics of the initialized words
+			Counts numByTopicDoc; // Dim: (Topic, Docs)
+			Counts numByTopicWord; // Dim: (Topic, Vocabs)
+			CountVector numByTopic; // Dim: (Topic, )
+			std::vector<double> llHistory; // the log-likelihood per word after each sweep
+		};
+
+		Float alpha = 0, eta = 0;
+		uint64_t globalStep = 0;
+		Dictionary dict;
+
+		std::vector<Vid> words; // the words of all documents, concatenated and shared by all chains
+		std::vector<uint64_t> docOffsets{ 0 }; // Dim: (Docs + 1, )
+		std::vector<Chain> chains;
+
+		// assigns random topics to the words of `c` added since the last call and grows its count matrices
+		void prepare(Chain& c) const;
+
+		// recomputes the counts of `c` from its topic assignments
+		void rebuildCounts(Chain& c) const;
+
+		// the log-likelihood of the words and the topic assignments of `c`
+		double getLL(const Chain& c) const;
+
+		const Chain& getChain(size_t chainId) const;
+	public:
+		MultiChainLDA(const MultiChainLDAArgs& args = {});
+
+		size_t getNumChains() const { return chains.size(); }
+		size_t getK(size_t chainId) const { return getChain(chainId).K; }
+		uint64_t getSeed(size_t chainId) const { return getChain(chainId).seed; }
+		const std::vector<double>& getLLHistory(size_t chainId) const { return getChain(chainId).llHistory; }
+		size_t getV() const { return dict.size(); }
+		Float getAlpha() const { return alpha; }
+		Float getEta() const { return eta; }
+		uint64_t getGlobalStep() const { return globalStep; }
+		size_t getNumDocs() const { return docOffsets.size() - 1; }
+		size_t getN() const { return words.size(); }
+		const Dictionary& getVocabDict() const { return dict; }
+
+		// if `addNew` is false, words out of the vocabulary are ignored
+		std::vector<Vid> toWids(const std::vector<std::string>& words, bool addNew);
+
+		// returns the index of the new document
+		size_t addDoc(const std::vector<Vid>& doc);
+
+		/*
+		runs `iteration` sweeps of all chains using `numWorkers` threads.
+		When there are more workers than chains, the documents of each chain are split into ranges
+		whose topic-word counts are merged after each sweep.
+		The result only depends on the seeds and `numWorkers`, not on the scheduling of threads.
+		*/
+		void train(size_t iteration, size_t numWorkers);
+
+		/*
+		returns the potential scale reduction factor (R-hat) of Gelman and Rubin over the last `window` log-likelihoods
+		of `chainIds`, all of which should have the same K. If `window` is 0, the last half of the sweeps is used.
+		*/
+		double getRhat(const std::vector<size_t>& chainIds, size_t window = 0) const;
+
+		// p(w|k) of all vocabularies in the chain `chainId`
+		std::vector<Float> getTopicWordDist(size_t chainId, size_t k) const;
+
+		// p(k|d) of the document `docId` in the chain `chainId`
+		std::vector<Float> getDocTopicDist(size_t chainId, size_t docId) const;
+
+		void write(std::ostream& writer) const;
+		void read(std::istream& reader);
+	};
+}
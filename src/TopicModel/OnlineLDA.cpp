@@ -0,0 +1,219 @@
+#include "OnlineLDA.h"
+#include "../Utils/math.h"
+#include "BatchUtils.hpp"
+
+namespace tomoto
+{
+	OnlineLDA::OnlineLDA(const OnlineLDAArgs& args)
+		: K{ args.k }, alphas(args.k, args.alpha), eta{ args.eta }, tau0{ args.tau0 }, kappa{ args.kappa },
+		totalDocs{ args.totalDocs }, seed{ args.seed }, lambda{ args.k, 0 }, rg{ args.seed }
+	{
+		if (!K || K >= 0x80000000) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong K value (K = %zd)", K));
+		if (args.alpha <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong alpha value (alpha = %f)", args.alpha));
+		if (eta <= 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong eta value (eta = %f)", eta));
+		if (tau0 < 0) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong tau0 value (tau0 = %f)", tau0));
+		if (kappa <= 0.5 || kappa > 1) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong kappa value (kappa = %f)", kappa));
+	}
+
+	void OnlineLDA::warmStart(const ILDAModel& mdl)
+	{
+		const size_t V = mdl.getV();
+		K = mdl.getK();
+		alphas.resize(K);
+		for (size_t k = 0; k < K; ++k) alphas[k] = mdl.getAlpha(k);
+		eta = mdl.getEta();
+		numDocs = mdl.getNumDocs();
+		numUpdates = 0;
+
+		// the words used in the model always come first in its dictionary
+		dict = Dictionary{};
+		for (size_t v = 0; v < V; ++v) dict.add(mdl.getVocabDict().toWord(v));
+		lambda.resize(K, V);
+		for (size_t k = 0; k < K; ++k)
+		{
+			// unnormalized, they are the topic-word counts plus `eta`
+			auto row = mdl.getWidsByTopic(k, false);
+			lambda.row(k) = Eigen::Map<const Vector>{ row.data(), (Eigen::Index)V }.transpose();
+		}
+	}
+
+	std::vector<Vid> OnlineLDA::toWids(const std::vector<std::string>& words, bool addNew)
+	{
+		std::vector<Vid> ret;
+		for (auto& w : words)
+		{
+			auto id = addNew ? dict.add(w) : dict.toWid(w);
+			if (id == non_vocab_id || (!addNew && id >= (size_t)lambda.cols())) continue;
+			ret.emplace_back(id);
+		}
+		return ret;
+	}
+
+	void OnlineLDA::growVocab()
+	{
+		const size_t oldV = lambda.cols(), V = dict.size();
+		if (V <= oldV) return;
+		lambda.conservativeResize(K, V);
+		// random initial values break the symmetry between topics
+		std::gamma_distribution<Float> gamma{ 100, (Float)0.01 };
+		for (size_t v = oldV; v < V; ++v)
+		{
+			for (size_t k = 0; k < K; ++k) lambda(k, v) = gamma(rg);
+		}
+	}
+
+	Matrix OnlineLDA::getExpElogbeta() const
+	{
+		Matrix ret{ K, lambda.cols() };
+		for (size_t k = 0; k < K; ++k)
+		{
+			const Float d = math::digammaT(lambda.row(k).sum());
+			for (Eigen::Index v = 0; v < lambda.cols(); ++v) ret(k, v) = std::exp(math::digammaT(lambda(k, v)) - d);
+		}
+		return ret;
+	}
+
+	double OnlineLDA::inferOne(const std::vector<Vid>& ids, const std::vector<Float>& cnts, const Matrix& expElogbeta,
+		size_t maxIter, Vector& gamma, Matrix* sstats) const
+	{
+		const size_t n = ids.size();
+		Eigen::Map<const Vector> alpha{ alphas.data(), (Eigen::Index)K };
+		Vector expElogtheta{ K }, acc{ K }, lastGamma{ K };
+		std::vector<Float> phiNorm(n);
+		auto update = [&]()
+		{
+			const Float d = math::digammaT(gamma.sum());
+			for (size_t k = 0; k < K; ++k) expElogtheta[k] = std::exp(math::digammaT(gamma[k]) - d);
+			for (size_t i = 0; i < n; ++i) phiNorm[i] = expElogtheta.dot(expElogbeta.col(ids[i])) + (Float)1e-30;
+		};
+
+		gamma.array() = alpha.array() + std::accumulate(cnts.begin(), cnts.end(), (Float)0) / K;
+		update();
+		for (size_t it = 0; it < maxIter; ++it)
+		{
+			lastGamma = gamma;
+			acc.setZero();
+			for (size_t i = 0; i < n; ++i) acc += expElogbeta.col(ids[i]) * (cnts[i] / phiNorm[i]);
+			gamma.array() = alpha.array() + expElogtheta.array() * acc.array();
+			update();
+			if ((gamma - lastGamma).cwiseAbs().mean() < (Float)1e-3) break;
+		}
+
+		double ll = 0;
+		for (size_t i = 0; i < n; ++i)
+		{
+			ll += cnts[i] * std::log(phiNorm[i]);
+			if (sstats) sstats->col(ids[i]) += expElogtheta * (cnts[i] / phiNorm[i]);
+		}
+		return ll;
+	}
+
+	double OnlineLDA::partialFit(const std::vector<std::vector<Vid>>& docs, size_t maxIter, size_t numWorkers)
+	{
+		if (docs.empty()) return 0;
+		for (auto& doc : docs)
+		{
+			for (auto w : doc)
+			{
+				if (w >= dict.size()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("word id %u is out of the vocabulary", w));
+			}
+		}
+		growVocab();
+
+		// E-step: each worker accumulates the statistics of its own range of documents
+		const Matrix expElogbeta = getExpElogbeta();
+		if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+		numWorkers = std::max(std::min(numWorkers, docs.size()), (size_t)1);
+		std::vector<Matrix> sstats(numWorkers);
+		std::vector<double> lls(numWorkers);
+		detail::forEachRange(docs.size(), numWorkers, [&](size_t t, size_t b, size_t e)
+		{
+			sstats[t] = Matrix::Zero(K, lambda.cols());
+			std::vector<Vid> ids;
+			std::vector<Float> cnts;
+			Vector gamma{ K };
+			for (size_t i = b; i < e; ++i)
+			{
+				detail::countWords(docs[i], ids, cnts);
+				lls[t] += inferOne(ids, cnts, expElogbeta, maxIter, gamma, &sstats[t]);
+			}
+		});
+		for (size_t t = 1; t < numWorkers; ++t) sstats[0] += sstats[t];
+
+		// M-step: a natural gradient step whose size decays as `(tau0 + t)^-kappa` with t counted from 1, so that rho <= 1 for any tau0 >= 0
+		numDocs += docs.size();
+		const Float rho = std::pow(tau0 + numUpdates + 1, -kappa);
+		const Float scale = (Float)(totalDocs ? totalDocs : numDocs) / docs.size();
+		lambda.array() = (1 - rho) * lambda.array() + rho * (eta + scale * sstats[0].array() * expElogbeta.array());
+		++numUpdates;
+
+		size_t numWords = 0;
+		for (auto& doc : docs) numWords += doc.size();
+		return numWords ? std::accumulate(lls.begin(), lls.end(), 0.) / numWords : 0;
+	}
+
+	std::vector<std::vector<Float>> OnlineLDA::infer(const std::vector<std::vector<Vid>>& docs, size_t maxIter,
+		size_t numWorkers, std::vector<double>* ll) const
+	{
+		for (auto& doc : docs)
+		{
+			for (auto w : doc)
+			{
+				if (w >= (size_t)lambda.cols()) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("word id %u is out of the vocabulary", w));
+			}
+		}
+
+		std::vector<std::vector<Float>> ret(docs.size());
+		if (ll) ll->resize(docs.size());
+		const Matrix expElogbeta = getExpElogbeta();
+		Matrix beta = lambda;
+		for (size_t k = 0; k < K; ++k) beta.row(k) /= beta.row(k).sum();
+		detail::forEachRange(docs.size(), numWorkers, [&](size_t, size_t b, size_t e)
+		{
+			std::vector<Vid> ids;
+			std::vector<Float> cnts;
+			Vector gamma{ K };
+			for (size_t i = b; i < e; ++i)
+			{
+				detail::countWords(docs[i], ids, cnts);
+				inferOne(ids, cnts, expElogbeta, maxIter, gamma, nullptr);
+				Vector theta = gamma / gamma.sum();
+				if (ll)
+				{
+					double s = 0;
+					for (size_t j = 0; j < ids.size(); ++j) s += cnts[j] * std::log(theta.dot(beta.col(ids[j])));
+					(*ll)[i] = s;
+				}
+				ret[i] = { theta.data(), theta.data() + K };
+			}
+		});
+		return ret;
+	}
+
+	std::vector<Float> OnlineLDA::getTopicWordDist(size_t k) const
+	{
+		if (k >= K) THROW_ERROR_WITH_INFO(exc::InvalidArgument, text::format("wrong topic id (k = %zd)", k));
+		std::vector<Float> ret(dict.size(), eta);
+		const Float sum = lambda.row(k).sum() + eta * (dict.size() - lambda.cols());
+		for (Eigen::Index v = 0; v < lambda.cols(); ++v) ret[v] = lambda(k, v);
+		for (auto& p : ret) p /= sum;
+		return ret;
+	}
+
+	void OnlineLDA::write(std::ostream& writer) const
+	{
+		serializer::writeMany(writer, serializer::to_key("TOLD"), (uint32_t)0, (uint32_t)K,
+			alphas, eta, tau0, kappa, totalDocs, numDocs, numUpdates, seed, dict, lambda);
+	}
+
+	void OnlineLDA::read(std::istream& reader)
+	{
+		uint32_t version, k;
+		serializer::readMany(reader, serializer::to_key("TOLD"), version, k,
+			alphas, eta, tau0, kappa, totalDocs, numDocs, numUpdates, seed, dict, lambda);
+		if (version != 0) throw std::ios_base::failure{ "unsupported version of online LDA model" };
+		K = k;
+		if (alphas.size() != K || (size_t)lambda.rows() != K || (size_t)lambda.cols() > dict.size()) throw std::ios_base::failure{ "broken online LDA model" };
+		rg.seed(seed + numUpdates);
+	}
+}
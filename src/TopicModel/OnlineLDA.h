@@ -0,0 +1,81 @@
+#pragma once
+#include "LDA.h"
+
+namespace tomoto
+{
+	struct OnlineLDAArgs
+	{
+		size_t k = 1;
+		Float alpha = (Float)0.1;
+		Float eta = (Float)0.01;
+		Float tau0 = 64; // delays the decay of the learning rate
+		Float kappa = (Float)0.7; // the rate of the decay, which should be in (0.5, 1]
+		uint64_t totalDocs = 0; // the number of documents of the whole stream, 0 for the number of documents seen so far
+		size_t seed = std::random_device{}();
+	};
+
+	/*
+	LDA trained by stochastic variational inference on minibatches of documents.
+	It keeps only the variational parameters of the topic-word distributions, so documents are dropped after each update.
+
+	* Hoffman, M., Bach, F. R., & Blei, D. M. (2010). Online learning for latent dirichlet allocation. In Advances in neural information processing systems (pp. 856-864).
+	*/
+	class OnlineLDA
+	{
+		size_t K = 0;
+		std::vector<Float> alphas; // Dim: (Topic, )
+		Float eta = 0, tau0 = 0, kappa = 0;
+		uint64_t totalDocs = 0, numDocs = 0, numUpdates = 0, seed = 0;
+		Dictionary dict;
+		Matrix lambda; // Dim: (Topic, Vocabs), the variational parameters of the topic-word distributions
+		std::mt19937_64 rg;
+
+		// adds the columns of the words added to `dict` since the last call
+		void growVocab();
+		Matrix getExpElogbeta() const;
+
+		/*
+		updates `gamma`, the variational parameters of the topic distribution of a document given as unique words `ids` and their counts `cnts`,
+		and adds its sufficient statistics into `sstats` if given. It returns the sum of the log normalizers of the words.
+		*/
+		double inferOne(const std::vector<Vid>& ids, const std::vector<Float>& cnts, const Matrix& expElogbeta,
+			size_t maxIter, Vector& gamma, Matrix* sstats) const;
+	public:
+		OnlineLDA(const OnlineLDAArgs& args = {});
+
+		// starts from the topic-word counts, the priors and the vocabularies of a trained `mdl`
+		void warmStart(const ILDAModel& mdl);
+
+		size_t getK() const { return K; }
+		size_t getV() const { return dict.size(); }
+		Float getAlpha(size_t k) const { return alphas[k]; }
+		Float getEta() const { return eta; }
+		Float getTau0() const { return tau0; }
+		Float getKappa() const { return kappa; }
+		uint64_t getTotalDocs() const { return totalDocs; }
+		void setTotalDocs(uint64_t n) { totalDocs = n; }
+		uint64_t getNumDocs() const { return numDocs; }
+		uint64_t getNumUpdates() const { return numUpdates; }
+		const Dictionary& getVocabDict() const { return dict; }
+
+		// if `addNew` is false, words out of the vocabulary are ignored
+		std::vector<Vid> toWids(const std::vector<std::string>& words, bool addNew);
+
+		/*
+		updates the model with a minibatch `docs` by one step of stochastic variational inference.
+		The E-step of each document runs at most `maxIter` iterations using `numWorkers` threads.
+		It returns the lower bound of the log-likelihood per word of `docs` estimated before the update.
+		*/
+		double partialFit(const std::vector<std::vector<Vid>>& docs, size_t maxIter, size_t numWorkers);
+
+		// it returns the topic distribution of each document, and fills `ll` with the log-likelihood of each document if given
+		std::vector<std::vector<Float>> infer(const std::vector<std::vector<Vid>>& docs, size_t maxIter,
+			size_t numWorkers, std::vector<double>* ll = nullptr) const;
+
+		// p(w|k) of all vocabularies
+		std::vector<Float> getTopicWordDist(size_t k) const;
+
+		void write(std::ostream& writer) const;
+		void read(std::istream& reader);
+	};
+}
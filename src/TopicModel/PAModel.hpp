@@ -17,6 +17,14 @@ namespace tomoto
 		Eigen::Matrix<WeightType, -1, -1> numByTopic1_2;
 		Eigen::Matrix<WeightType, -1, 1> numByTopic2;
 		Vector subTmp;
+		Vector superCoef; // len = K, (n_dk1 + alpha) / (n_dk1 + subAlphaSum_k1) of the document being sampled
+		Vector subMass; // len = K2, sum of superCoef_k1 * (n_dk1k2 + subAlpha_k1k2) over k1
+
+		uint64_t getMemoryUsage() const
+		{
+			return ModelStateLDA<_tw>::getMemoryUsage() + heapBytes(numByTopic1_2) + heapBytes(numByTopic2)
+				+ heapBytes(subTmp) + heapBytes(superCoef) + heapBytes(subMass);
+		}
 
 		DEFINE_SERIALIZER_AFTER_BASE(ModelStateLDA<_tw>, numByTopic1_2, numByTopic2);
 	};
@@ -66,12 +74,33 @@ namespace tomoto
 			for (auto& r : res) r.get();
 		}
 
-		// topic 1 & 2 assignment likelihoods for new word. ret K*K2 FLOATs
+		/*
+		The likelihood of (z1 = k1, z2 = k2) is superCoef_k1 * (n_dk1k2 + subAlpha_k1k2) * p(w | k2),
+		so k2 is drawn first from subMass_k2 * p(w | k2) and then k1 is drawn from the column k2.
+		Keeping subMass up to date costs O(K2) per word, so each word takes O(K + K2) instead of O(K * K2).
+		*/
+		void initSubMass(_ModelState& ld, const _DocType& doc) const
+		{
+			ld.superCoef = (doc.numByTopic.array().template cast<Float>() + this->alpha)
+				/ (doc.numByTopic.array().template cast<Float>() + subAlphaSum.array());
+			ld.subMass = ((doc.numByTopic1_2.template cast<Float>() + subAlphas).array().colwise() * ld.superCoef.array()).colwise().sum().transpose();
+		}
+
+		// it should be called with `_attach = false` before the counts of k1 change, and with `_attach = true` after them
+		template<bool _attach>
+		void updateSubMass(_ModelState& ld, const _DocType& doc, Tid k1) const
+		{
+			if (_attach) ld.superCoef[k1] = (doc.numByTopic[k1] + this->alpha) / (doc.numByTopic[k1] + subAlphaSum[k1]);
+			auto row = (doc.numByTopic1_2.row(k1).transpose().array().template cast<Float>() + subAlphas.row(k1).transpose().array()) * ld.superCoef[k1];
+			if (_attach) ld.subMass.array() += row;
+			else ld.subMass.array() -= row;
+		}
+
+		// topic 2 assignment likelihoods for new word. ret K2 FLOATs
 		template<bool _asymEta>
 		Float* getZLikelihoods(_ModelState& ld, const _DocType& doc, size_t docId, size_t vid) const
 		{
 			const size_t V = this->realV;
-			const auto eta = this->eta;
 			assert(vid < V);
 			auto etaHelper = this->template getEtaHelper<_asymEta>();
 			auto& zLikelihood = ld.zLikelihood;
@@ -79,13 +108,18 @@ namespace tomoto
 			ld.subTmp = (ld.numByTopicWord.col(vid).array().template cast<Float>() + etaHelper.getEta(vid))
 				/ (ld.numByTopic2.array().template cast<Float>() + etaHelper.getEtaSum());
 
-			for (size_t k = 0; k < this->K; ++k)
-			{
-				zLikelihood.segment(K2 * k, K2) = (doc.numByTopic[k] + this->alpha)
-					* (doc.numByTopic1_2.row(k).transpose().array().template cast<Float>() + subAlphas.row(k).transpose().array()) / (doc.numByTopic[k] + subAlphaSum[k])
-					* ld.subTmp.array();
-			}
-			sample::prefixSum(zLikelihood.data(), zLikelihood.size());
+			zLikelihood.head(K2) = (ld.subMass.array() * ld.subTmp.array()).cwiseMax(0);
+			sample::prefixSum(zLikelihood.data(), K2);
+			return &zLikelihood[0];
+		}
+
+		// topic 1 assignment likelihoods given topic 2. ret K FLOATs
+		Float* getZ1Likelihoods(_ModelState& ld, const _DocType& doc, Tid z2) const
+		{
+			auto& zLikelihood = ld.zLikelihood;
+			zLikelihood.head(this->K) = ld.superCoef.array()
+				* (doc.numByTopic1_2.col(z2).array().template cast<Float>() + subAlphas.col(z2).array());
+			sample::prefixSum(zLikelihood.data(), this->K);
 			return &zLikelihood[0];
 		}
 
@@ -116,10 +150,13 @@ namespace tomoto
 			}
 
 			size_t vOffset = (_ps == ParallelScheme::partition && partitionId) ? edd.vChunkOffset[partitionId - 1] : 0;
+			initSubMass(ld, doc);
 			for (size_t w = b; w < e; ++w)
 			{
 				if (doc.words[w] >= this->realV) continue;
+				updateSubMass<false>(ld, doc, doc.Zs[w]);
 				addWordTo<-1>(ld, doc, w, doc.words[w] - vOffset, doc.Zs[w], doc.Z2s[w]);
+				updateSubMass<true>(ld, doc, doc.Zs[w]);
 				Float* dist;
 				if (this->etaByTopicWord.size())
 				{
@@ -129,10 +166,12 @@ namespace tomoto
 				{
 					dist = getZLikelihoods<false>(ld, doc, docId, doc.words[w] - vOffset);
 				}
-				auto z = sample::sampleFromDiscreteAcc(dist, dist + this->K * K2, rgs);
-				doc.Zs[w] = z / K2;
-				doc.Z2s[w] = z % K2;
+				doc.Z2s[w] = sample::sampleFromDiscreteAcc(dist, dist + K2, rgs);
+				dist = getZ1Likelihoods(ld, doc, doc.Z2s[w]);
+				doc.Zs[w] = sample::sampleFromDiscreteAcc(dist, dist + this->K, rgs);
+				updateSubMass<false>(ld, doc, doc.Zs[w]);
 				addWordTo<1>(ld, doc, w, doc.words[w] - vOffset, doc.Zs[w], doc.Z2s[w]);
+				updateSubMass<true>(ld, doc, doc.Zs[w]);
 			}
 		}
 
@@ -291,17 +330,8 @@ namespace tomoto
 
 		void prepareWordPriors()
 		{
-			if (this->etaByWord.empty()) return;
-			this->etaByTopicWord.resize(K2, this->realV);
-			this->etaSumByTopic.resize(K2);
-			this->etaByTopicWord.array() = this->eta;
-			for (auto& it : this->etaByWord)
-			{
-				auto id = this->dict.toWid(it.first);
-				if (id == (Vid)-1 || id >= this->realV) continue;
-				this->etaByTopicWord.col(id) = Eigen::Map<Vector>{ it.second.data(), (Eigen::Index)it.second.size() };
-			}
-			this->etaSumByTopic = this->etaByTopicWord.rowwise().sum();
+			// the word priors are given over the sub-topics
+			this->buildWordPriors(K2);
 		}
 
 		void initGlobalState(bool initDocs)
@@ -338,7 +368,7 @@ namespace tomoto
 			doc.Zs[i] = g.theta(rgs);
 			if (this->etaByTopicWord.size())
 			{
-				auto col = this->etaByTopicWord.col(w);
+				auto col = this->getWordPriorCol(w);
 				doc.Z2s[i] = sample::sampleFromDiscrete(col.data(), col.data() + col.size(), rgs);
 			}
 			else
@@ -445,6 +475,11 @@ namespace tomoto
 			return extractTopN<Tid>(getSubTopicsByDoc(doc, true), topN);
 		}
 
+		size_t getNumWidsTopics() const
+		{
+			return K2;
+		}
+
 		std::vector<Float> _getWidsByTopic(Tid k2, bool normalize = true) const
 		{
 			assert(k2 < K2);
@@ -50,9 +50,33 @@ namespace tomoto
 			return &zLikelihood[0];
 		}
 
+		// samples only over the topics allowed by the labels of `doc`, as LLDAModel does, if no vocabulary has its own prior
+		template<typename _Rng>
+		void sampleTokens(_DocType& doc, size_t docId, _ModelState& ld, _Rng& rgs, size_t iterationCnt, size_t b, size_t e) const
+		{
+			if (this->samplingMethod == SamplingMethod::dense && !this->etaByTopicWord.size())
+			{
+				auto& topics = doc.getLabelTopics();
+				if (!topics.empty() && topics.size() < this->K) return this->sampleTokensRestricted(doc, ld, rgs, b, e, topics);
+			}
+			return BaseClass::sampleTokens(doc, docId, ld, rgs, iterationCnt, b, e);
+		}
+
+		static constexpr bool isSamplingMethodSupported(SamplingMethod method)
+		{
+			return method == SamplingMethod::dense
+				|| (method == SamplingMethod::mh && std::is_same<_Derived, void>::value);
+		}
+
+		Float getTopicPrior(const _DocType& doc, Tid k) const
+		{
+			return doc.labelMask[k] ? this->alphas[k] : 0;
+		}
+
 		void prepareDoc(_DocType& doc, size_t docId, size_t wordSize) const
 		{
 			BaseClass::prepareDoc(doc, docId, wordSize);
+			doc.labelTopics.clear();
 			if (doc.labelMask.size() == 0)
 			{
 				doc.labelMask.resize(this->K);
@@ -97,7 +121,7 @@ namespace tomoto
 			auto w = doc.words[i];
 			if (this->etaByTopicWord.size())
 			{
-				Eigen::Array<Float, -1, 1> col = this->etaByTopicWord.col(w);
+				Eigen::Array<Float, -1, 1> col = this->getWordPriorCol(w);
 				col *= g.p;
 				z = sample::sampleFromDiscrete(col.data(), col.data() + col.size(), rgs);
 			}
@@ -181,6 +205,11 @@ namespace tomoto
 			return std::make_unique<_DocType>(as_mutable(this)->template _updateDoc<true>(doc, rawDoc.template getMiscDefault<std::vector<std::string>>("labels")));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "documents of this model need misc data, so they should be added by `addDoc`.");
+		}
+
 		std::vector<Float> _getTopicsByDoc(const _DocType& doc, bool normalize) const
 		{
 			if (!doc.numByTopic.size()) return {};
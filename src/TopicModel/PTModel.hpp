@@ -15,10 +15,14 @@ namespace tomoto
 	{
 		using WeightType = typename ModelStateLDA<_tw>::WeightType;
 
-		Eigen::Array<Float, -1, 1> pLikelihood;
 		Eigen::ArrayXi numDocsByPDoc;
 		Eigen::Matrix<WeightType, -1, -1> numByTopicPDoc;
 
+		uint64_t getMemoryUsage() const
+		{
+			return ModelStateLDA<_tw>::getMemoryUsage() + heapBytes(numDocsByPDoc) + heapBytes(numByTopicPDoc);
+		}
+
 		//DEFINE_SERIALIZER_AFTER_BASE(ModelStateLDA<_tw>);
 	};
 
@@ -46,6 +50,7 @@ namespace tomoto
 		uint64_t numPDocs;
 		Float lambda;
 		uint32_t pseudoDocSamplingInterval = 10;
+		size_t pseudoDocMHSteps = 0;
 
 		void optimizeParameters(ThreadPool& pool, _ModelState* localData, _RandGen* rgs)
 		{
@@ -61,69 +66,156 @@ namespace tomoto
 			}
 		}
 
-		void samplePseudoDoc(ThreadPool* pool, _ModelState& ld, _RandGen& rgs, _DocType& doc) const
+		// buffers of a worker choosing pseudo documents
+		struct PseudoDocBuffer
 		{
-			if (doc.getSumWordWeight() == 0) return;
-			Eigen::Array<WeightType, -1, 1> docTopicDist = Eigen::Array<WeightType, -1, 1>::Zero(this->K);
+			Eigen::Array<WeightType, -1, 1> docTopicDist;
+			Eigen::Array<Float, -1, 1> pLikelihood;
+		};
+
+		// log-likelihood of putting the topic counts `dist` of a document currently in `curP` into the pseudo document `p`
+		Float getPseudoDocLL(const _ModelState& ld, const Eigen::Array<WeightType, -1, 1>& dist, size_t p, size_t curP) const
+		{
+			auto fdist = dist.template cast<Float>();
+			auto ll = [&](const auto& cnt)
+			{
+				return math::lgammaSubt(cnt + this->alphas.array(), fdist).sum()
+					- math::lgammaSubt(cnt.sum() + this->alphas.sum(), fdist.sum());
+			};
+			if (p == curP) return ll(ld.numByTopicPDoc.col(p).array().template cast<Float>() - fdist);
+			return ll(ld.numByTopicPDoc.col(p).array().template cast<Float>());
+		}
+
+		/*
+		chooses a new pseudo document of `doc` without modifying `ld`, so that workers can choose for different documents at once.
+		If `pseudoDocMHSteps` > 0, the exhaustive scan over all pseudo documents is replaced with MH steps
+		whose proposal is proportional to `numDocsByPDoc + lambda`, drawn by picking the pseudo document of a random document in [docFirst, docLast).
+		*/
+		template<bool _infer, typename _DocIter>
+		size_t choosePseudoDoc(const _ModelState& ld, _RandGen& rgs, const _DocType& doc, PseudoDocBuffer& buf,
+			_DocIter docFirst, _DocIter docLast, size_t totalDocs) const
+		{
+			if (doc.getSumWordWeight() == 0) return doc.pseudoDoc;
+			auto& docTopicDist = buf.docTopicDist;
+			docTopicDist = Eigen::Array<WeightType, -1, 1>::Zero(this->K);
 			for (size_t i = 0; i < doc.words.size(); ++i)
 			{
 				if (doc.words[i] >= this->realV) continue;
-				this->template addWordTo<-1>(ld, doc, i, doc.words[i], doc.Zs[i]);
-				typename std::conditional<_tw != TermWeight::one, float, int32_t>::type weight
-					= _tw != TermWeight::one ? doc.wordWeights[i] : 1;
-				docTopicDist[doc.Zs[i]] += weight;
+				docTopicDist[doc.Zs[i]] += this->getWordWeight(doc, i);
 			}
-			--ld.numDocsByPDoc[doc.pseudoDoc];
-			
-			if (pool)
+
+			const size_t curP = doc.pseudoDoc;
+			if (!_infer && pseudoDocMHSteps)
 			{
-				std::vector<std::future<void>> futures;
-				for (size_t w = 0; w < pool->getNumWorkers(); ++w)
+				const size_t numDocs = std::distance(docFirst, docLast);
+				const Float otherDocs = (Float)totalDocs - 1;
+				size_t p = curP;
+				Float ll = getPseudoDocLL(ld, docTopicDist, p, curP);
+				for (size_t step = 0; step < pseudoDocMHSteps; ++step)
 				{
-					futures.emplace_back(pool->enqueue([&](size_t, size_t w)
+					size_t proposal;
+					if (rgs.uniform_real() * (otherDocs + lambda * numPDocs) < lambda * numPDocs || otherDocs <= 0)
+					{
+						proposal = rgs() % numPDocs;
+					}
+					else
 					{
-						for (size_t p = w; p < numPDocs; p += pool->getNumWorkers())
+						// when almost all the other documents are empty or have only removed words, it falls back to a uniform proposal instead of retrying forever
+						const _DocType* other = nullptr;
+						for (size_t retry = 0; retry < 64 && !other; ++retry)
 						{
-							Float ax = math::lgammaSubt(ld.numByTopicPDoc.col(p).array().template cast<Float>() + this->alphas.array(), docTopicDist.template cast<Float>()).sum();
-							Float bx = math::lgammaSubt(ld.numByTopicPDoc.col(p).sum() + this->alphas.sum(), docTopicDist.sum());
-							ld.pLikelihood[p] = ax - bx;
+							const _DocType* d = &docFirst[rgs() % numDocs];
+							if (d != &doc && d->getSumWordWeight()) other = d;
 						}
-					}, w));
+						proposal = other ? other->pseudoDoc : rgs() % numPDocs;
+					}
+					if (proposal == p) continue;
+					Float newLL = getPseudoDocLL(ld, docTopicDist, proposal, curP);
+					if (newLL >= ll || rgs.uniform_real() < std::exp(newLL - ll))
+					{
+						p = proposal;
+						ll = newLL;
+					}
 				}
-				for (auto& f : futures) f.get();
+				return p;
 			}
-			else
+
+			auto& pLikelihood = buf.pLikelihood;
+			pLikelihood.resize(numPDocs);
+			for (size_t p = 0; p < numPDocs; ++p)
 			{
-				for (size_t p = 0; p < numPDocs; ++p)
-				{
-					Float ax = math::lgammaSubt(ld.numByTopicPDoc.col(p).array().template cast<Float>() + this->alphas.array(), docTopicDist.template cast<Float>()).sum();
-					Float bx = math::lgammaSubt(ld.numByTopicPDoc.col(p).sum() + this->alphas.sum(), docTopicDist.sum());
-					ld.pLikelihood[p] = ax - bx;
-				}
+				pLikelihood[p] = getPseudoDocLL(ld, docTopicDist, p, curP);
 			}
-			ld.pLikelihood = (ld.pLikelihood - ld.pLikelihood.maxCoeff()).exp();
-			ld.pLikelihood *= ld.numDocsByPDoc.template cast<Float>() + lambda;
+			pLikelihood = (pLikelihood - pLikelihood.maxCoeff()).exp();
+			pLikelihood *= ld.numDocsByPDoc.template cast<Float>() + lambda;
+			pLikelihood[curP] -= pLikelihood[curP] / (ld.numDocsByPDoc[curP] + lambda);
 
-			sample::prefixSum(ld.pLikelihood.data(), numPDocs);
-			doc.pseudoDoc = sample::sampleFromDiscreteAcc(ld.pLikelihood.data(), ld.pLikelihood.data() + numPDocs, rgs);
+			sample::prefixSum(pLikelihood.data(), numPDocs);
+			return sample::sampleFromDiscreteAcc(pLikelihood.data(), pLikelihood.data() + numPDocs, rgs);
+		}
 
-			++ld.numDocsByPDoc[doc.pseudoDoc];
-			doc.numByTopic.init(ld.numByTopicPDoc.col(doc.pseudoDoc).data(), this->K, 1);
-			for (size_t i = 0; i < doc.words.size(); ++i)
-			{
-				if (doc.words[i] >= this->realV) continue;
-				this->template addWordTo<1>(ld, doc, i, doc.words[i], doc.Zs[i]);
-			}
+		// moves `doc` with its topic counts `dist` into the pseudo document `newP`
+		void movePseudoDoc(_ModelState& ld, _DocType& doc, const Eigen::Array<WeightType, -1, 1>& dist, size_t newP) const
+		{
+			if (newP == doc.pseudoDoc) return;
+			ld.numByTopicPDoc.col(doc.pseudoDoc).array() -= dist;
+			ld.numByTopicPDoc.col(newP).array() += dist;
+			--ld.numDocsByPDoc[doc.pseudoDoc];
+			++ld.numDocsByPDoc[newP];
+			doc.pseudoDoc = newP;
+			doc.numByTopic.init(ld.numByTopicPDoc.col(newP).data(), this->K, 1);
 		}
 
+		/*
+		With a pool, documents are processed in rounds: workers choose new pseudo documents for the documents of a round
+		against the counts at the start of the round, and then the moves are applied to the counts at once.
+		*/
 		template<ParallelScheme _ps, bool _infer, typename _DocIter>
 		void performSamplingGlobal(ThreadPool* pool, _ModelState& globalState, _RandGen* rgs,
 			_DocIter docFirst, _DocIter docLast) const
 		{
 			if (this->globalStep % pseudoDocSamplingInterval) return;
-			for (; docFirst != docLast; ++docFirst)
+			const size_t numWorkers = pool ? pool->getNumWorkers() : 1;
+			std::vector<PseudoDocBuffer> bufs(numWorkers);
+
+			const size_t numDocs = std::distance(docFirst, docLast);
+			const size_t totalDocs = globalState.numDocsByPDoc.sum();
+			if (numWorkers <= 1)
+			{
+				for (auto it = docFirst; it != docLast; ++it)
+				{
+					size_t p = choosePseudoDoc<_infer>(globalState, rgs[0], *it, bufs[0], docFirst, docLast, totalDocs);
+					if ((*it).getSumWordWeight()) movePseudoDoc(globalState, *it, bufs[0].docTopicDist, p);
+				}
+				return;
+			}
+
+			const size_t roundSize = numWorkers * 64;
+			std::vector<size_t> newPDocs(roundSize);
+			for (size_t b = 0; b < numDocs; b += roundSize)
 			{
-				samplePseudoDoc(pool, globalState, rgs[0], *docFirst);
+				const size_t e = std::min(b + roundSize, numDocs);
+				for (auto& r : pool->enqueueToAll([&](size_t threadId)
+				{
+					for (size_t i = b + threadId; i < e; i += numWorkers)
+					{
+						newPDocs[i - b] = choosePseudoDoc<_infer>(globalState, rgs[threadId], docFirst[i], bufs[threadId], docFirst, docLast, totalDocs);
+					}
+				})) r.get();
+
+				auto& dist = bufs[0].docTopicDist;
+				for (size_t i = b; i < e; ++i)
+				{
+					auto& doc = docFirst[i];
+					if (newPDocs[i - b] == doc.pseudoDoc) continue;
+					dist = Eigen::Array<WeightType, -1, 1>::Zero(this->K);
+					for (size_t w = 0; w < doc.words.size(); ++w)
+					{
+						if (doc.words[w] >= this->realV) continue;
+						dist[doc.Zs[w]] += this->getWordWeight(doc, w);
+					}
+					movePseudoDoc(globalState, doc, dist, newPDocs[i - b]);
+				}
 			}
 		}
 		
@@ -167,12 +259,21 @@ namespace tomoto
 
 		void initGlobalState(bool initDocs)
 		{
-			this->globalState.pLikelihood = Vector::Zero(numPDocs);
 			this->globalState.numDocsByPDoc = Eigen::ArrayXi::Zero(numPDocs);
 			this->globalState.numByTopicPDoc = Eigen::Matrix<WeightType, -1, -1>::Zero(this->K, numPDocs);
 			BaseClass::initGlobalState(initDocs);
 		}
 
+		void updateForCopy()
+		{
+			BaseClass::updateForCopy();
+			// documents view the topic counts of their pseudo documents, not the columns of `numByTopicDoc`
+			for (auto& doc : this->docs)
+			{
+				if (doc.numByTopic.size()) doc.numByTopic.init(this->globalState.numByTopicPDoc.col(doc.pseudoDoc).data(), this->K, 1);
+			}
+		}
+
 		struct Generator
 		{
 			std::uniform_int_distribution<uint64_t> psi;
@@ -200,7 +301,7 @@ namespace tomoto
 			auto w = doc.words[i];
 			if (this->etaByTopicWord.size())
 			{
-				auto col = this->etaByTopicWord.col(w);
+				auto col = this->getWordPriorCol(w);
 				z = sample::sampleFromDiscrete(col.data(), col.data() + col.size(), rgs);
 			}
 			else
@@ -258,6 +359,12 @@ namespace tomoto
 		DEFINE_TAGGED_SERIALIZER_AFTER_BASE_WITH_VERSION(BaseClass, 1, 0x00010001, numPDocs, lambda);
 
 		GETTER(P, size_t, numPDocs);
+		GETTER(PseudoDocMHSteps, size_t, pseudoDocMHSteps);
+
+		void setPseudoDocMHSteps(size_t steps) override
+		{
+			pseudoDocMHSteps = steps;
+		}
 
 		PTModel(const PTArgs& args)
 			: BaseClass(args), numPDocs(args.p), lambda(args.lambda)
@@ -39,6 +39,12 @@ namespace tomoto
 		virtual std::vector<Float> getRegressionCoef(size_t f) const = 0;
 		virtual GLM getTypeOfVar(size_t f) const = 0;
 		virtual std::vector<Float> estimateVars(const DocumentBase* doc) const = 0;
+		/*
+		fills a (documents, response variables) matrix from `alloc` with the estimates of all `docs`, using `numWorkers` threads.
+		Each thread normalizes the topic counts of its own range of documents into a matrix and evaluates all the variables with one product.
+		The rows of documents which don't belong to this model are filled with NaN.
+		*/
+		virtual void estimateVarsByDocs(const std::vector<const DocumentBase*>& docs, const MatrixAllocator& alloc, size_t numWorkers) const = 0;
 	};
 
 	struct SLDAArgs : public LDAArgs
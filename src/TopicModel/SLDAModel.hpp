@@ -33,7 +33,8 @@ namespace tomoto
 			virtual void optimizeCoef(
 				const Matrix& normZ,
 				Float mu, Float nuSq,
-				Eigen::Block<Matrix, -1, 1, true> ys
+				Eigen::Block<Matrix, -1, 1, true> ys,
+				ThreadPool* pool, size_t seed
 			) = 0;
 
 			virtual double getLL(Float y, const Eigen::Matrix<_WeightType, -1, 1>& numByTopic,
@@ -90,7 +91,8 @@ namespace tomoto
 			void optimizeCoef(
 				const Matrix& normZ,
 				Float mu, Float nuSq,
-				Eigen::Block<Matrix, -1, 1, true> ys
+				Eigen::Block<Matrix, -1, 1, true> ys,
+				ThreadPool* pool, size_t seed
 			) override
 			{
 				Matrix selectedNormZ = normZ.array().rowwise() * (!ys.array().transpose().isNaN()).template cast<Float>();
@@ -119,6 +121,8 @@ namespace tomoto
 		template<typename _WeightType>
 		struct BinaryLogisticFunctor : public GLMFunctor<_WeightType>
 		{
+			static constexpr size_t drawChunkSize = 256;
+
 			Float b = 1;
 			Vector omega;
 
@@ -148,7 +152,8 @@ namespace tomoto
 			void optimizeCoef(
 				const Matrix& normZ,
 				Float mu, Float nuSq,
-				Eigen::Block<Matrix, -1, 1, true> ys
+				Eigen::Block<Matrix, -1, 1, true> ys,
+				ThreadPool* pool, size_t seed
 			) override
 			{
 				Matrix selectedNormZ = normZ.array().rowwise() * (!ys.array().transpose().isNaN()).template cast<Float>();
@@ -159,11 +164,36 @@ namespace tomoto
 					.colPivHouseholderQr().solve(selectedNormZ * ys.array().isNaN().select(0, b * (ys.array() - 0.5f)).matrix()
 						+ Vector::Constant(selectedNormZ.rows(), mu / nuSq));
 
-				RandGen rng;
-				for (size_t i = 0; i < (size_t)omega.size(); ++i)
+				// computes z of all documents with one product, then draws omega in fixed-size chunks.
+				// Each chunk has its own generator seeded by its index, so the result doesn't depend on the number of workers.
+				const Vector zs = normZ.transpose() * this->regressionCoef;
+				const size_t numChunks = (omega.size() + drawChunkSize - 1) / drawChunkSize;
+				auto drawChunk = [&](size_t c)
+				{
+					RandGen rng{ seed + c };
+					const size_t e = std::min((c + 1) * drawChunkSize, (size_t)omega.size());
+					for (size_t i = c * drawChunkSize; i < e; ++i)
+					{
+						if (std::isnan(ys[i])) continue;
+						omega[i] = math::drawPolyaGamma(b, zs[i], rng);
+					}
+				};
+
+				if (pool && numChunks > 1)
+				{
+					std::vector<std::future<void>> res;
+					for (size_t c = 0; c < numChunks; ++c)
+					{
+						res.emplace_back(pool->enqueue([&, c](size_t)
+						{
+							drawChunk(c);
+						}));
+					}
+					for (auto& r : res) r.get();
+				}
+				else
 				{
-					if (std::isnan(ys[i])) continue;
-					omega[i] = math::drawPolyaGamma(b, (this->regressionCoef.array() * normZ.col(i).array()).sum(), rng);
+					for (size_t c = 0; c < numChunks; ++c) drawChunk(c);
 				}
 			}
 
@@ -253,7 +283,7 @@ namespace tomoto
 			return &zLikelihood[0];
 		}
 
-		void optimizeRegressionCoef()
+		void optimizeRegressionCoef(ThreadPool* pool = nullptr)
 		{
 			for (size_t i = 0; i < this->docs.size(); ++i)
 			{
@@ -261,9 +291,27 @@ namespace tomoto
 					std::max((Float)this->docs[i].getSumWordWeight(), 0.01f);
 			}
 
-			for (size_t f = 0; f < F; ++f)
+			const size_t seed = this->rg();
+			// response variables are independent of each other, so they are optimized concurrently if there are many.
+			// Otherwise the pool is handed to the functor, which draws its auxiliary variables in parallel.
+			if (pool && F > 1)
 			{
-				responseVars[f]->optimizeCoef(normZ, mu[f], nuSq[f], Ys.col(f));
+				std::vector<std::future<void>> res;
+				for (size_t f = 0; f < F; ++f)
+				{
+					res.emplace_back(pool->enqueue([&, f](size_t)
+					{
+						responseVars[f]->optimizeCoef(normZ, mu[f], nuSq[f], Ys.col(f), nullptr, seed + f * 0x10000);
+					}));
+				}
+				for (auto& r : res) r.get();
+			}
+			else
+			{
+				for (size_t f = 0; f < F; ++f)
+				{
+					responseVars[f]->optimizeCoef(normZ, mu[f], nuSq[f], Ys.col(f), pool, seed + f * 0x10000);
+				}
 			}
 		}
 
@@ -274,7 +322,7 @@ namespace tomoto
 
 		void updateGlobalInfo(ThreadPool& pool, _ModelState* localData)
 		{
-			optimizeRegressionCoef();
+			optimizeRegressionCoef(&pool);
 		}
 
 		template<typename _DocIter>
@@ -453,6 +501,11 @@ namespace tomoto
 			return std::make_unique<_DocType>(as_mutable(this)->template _updateDoc<true>(doc, rawDoc.template getMiscDefault<std::vector<Float>>("y")));
 		}
 
+		std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) override
+		{
+			THROW_ERROR_WITH_INFO(exc::Unimplemented, "documents of this model need misc data, so they should be added by `addDoc`.");
+		}
+
 		std::vector<Float> estimateVars(const DocumentBase* doc) const override
 		{
 			std::vector<Float> ret;
@@ -464,6 +517,39 @@ namespace tomoto
 			}
 			return ret;
 		}
+
+		void estimateVarsByDocs(const std::vector<const DocumentBase*>& docs, const MatrixAllocator& alloc, size_t numWorkers) const override
+		{
+			Matrix coefs{ (Eigen::Index)this->K, (Eigen::Index)F };
+			for (size_t f = 0; f < F; ++f) coefs.col(f) = responseVars[f]->regressionCoef;
+			Float* out = alloc(docs.size(), F);
+			this->forRowRanges(0, docs.size(), numWorkers, [&](size_t b, size_t e)
+			{
+				// Dim: (Topic, Docs), the topic proportions of the range in the same scale as `GLMFunctor::estimate`
+				Matrix normZ{ (Eigen::Index)this->K, (Eigen::Index)(e - b) };
+				std::vector<size_t> foreign;
+				for (size_t i = b; i < e; ++i)
+				{
+					auto pdoc = dynamic_cast<const _DocType*>(docs[i]);
+					if (!pdoc)
+					{
+						normZ.col(i - b).setZero();
+						foreign.emplace_back(i - b);
+						continue;
+					}
+					normZ.col(i - b) = pdoc->numByTopic.template cast<Float>() / std::max((Float)pdoc->getSumWordWeight(), (Float)0.01f);
+				}
+
+				// the rows of the output are the columns of a (Variables, Docs) column-major matrix
+				Eigen::Map<Matrix> ys{ out + b * F, (Eigen::Index)F, (Eigen::Index)(e - b) };
+				ys.noalias() = coefs.transpose() * normZ;
+				for (size_t f = 0; f < F; ++f)
+				{
+					if (varTypes[f] == ISLDAModel::GLM::binary_logistic) ys.row(f) = (1 + (-ys.row(f).array()).exp()).inverse();
+				}
+				for (auto i : foreign) ys.col(i).setConstant(std::numeric_limits<Float>::quiet_NaN());
+			});
+		}
 	};
 
 	template<typename _WeightType>
@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include <numeric>
 #include <unordered_set>
+#include <chrono>
+#include <exception>
+#include <limits>
 #include "../Utils/Utils.hpp"
 #include "../Utils/Dictionary.h"
 #include "../Utils/tvector.hpp"
@@ -8,6 +11,8 @@
 #include "../Utils/serializer.hpp"
 #include "../Utils/exception.h"
 #include "../Utils/SharedString.hpp"
+#include "../Utils/MMap.hpp"
+#include "../Utils/HugePages.hpp"
 #include <EigenRand/EigenRand>
 #include <mapbox/variant.hpp>
 
@@ -24,8 +29,9 @@ namespace tomoto
 		Float weight = 1;
 		SharedString docUid;
 		SharedString rawStr;
-		std::vector<uint32_t> origWordPos;
-		std::vector<uint16_t> origWordLen;
+		// the span of each word in `rawStr`. The documents of a model view the arrays packed by the model, see `TopicModel::updateWeakArray`
+		tvector<uint32_t> origWordPos;
+		tvector<uint16_t> origWordLen;
 
 		RawDocKernel(const RawDocKernel&) = default;
 		RawDocKernel(RawDocKernel&&) = default;
@@ -108,6 +114,9 @@ namespace tomoto
 		virtual operator RawDoc() const
 		{
 			RawDoc raw{ *this };
+			// the spans may view the arrays of the model, which the raw document should not outlive
+			raw.origWordPos = tvector<uint32_t>((uint32_t*)origWordPos.begin(), (uint32_t*)origWordPos.end());
+			raw.origWordLen = tvector<uint16_t>((uint16_t*)origWordLen.begin(), (uint16_t*)origWordLen.end());
 			if (wOrder.empty())
 			{
 				raw.words.insert(raw.words.begin(), words.begin(), words.end());
@@ -125,13 +134,36 @@ namespace tomoto
 		}
 
 		DEFINE_SERIALIZER_WITH_VERSION(0, serializer::to_key("Docu"), weight, words, wOrder);
-		DEFINE_TAGGED_SERIALIZER_WITH_VERSION(1, 0x00010001, weight, words, wOrder, 
-			rawStr, origWordPos, origWordLen,
-			docUid
-		);
+
+		void serializerRead(serializer::version_holder<1>, std::istream& istr)
+		{
+			serializer::readTaggedMany(istr, 0x00010001, 
+				serializer::to_keyz("weight"), weight, serializer::to_keyz("words"), words, serializer::to_keyz("wOrder"), wOrder,
+				serializer::to_keyz("rawStr"), rawStr, serializer::to_keyz("origWordPos"), origWordPos, serializer::to_keyz("origWordLen"), origWordLen,
+				serializer::to_keyz("docUid"), docUid
+			);
+		}
+
+		// the raw text and the spans are left out if the model writes them as columns
+		void serializerWrite(serializer::version_holder<1>, std::ostream& ostr) const
+		{
+			if (serializer::isRawTextColumns(ostr))
+			{
+				serializer::writeTaggedMany(ostr, 0x00010001,
+					serializer::to_keyz("weight"), weight, serializer::to_keyz("words"), words, serializer::to_keyz("wOrder"), wOrder,
+					serializer::to_keyz("docUid"), docUid
+				);
+				return;
+			}
+			serializer::writeTaggedMany(ostr, 0x00010001, 
+				serializer::to_keyz("weight"), weight, serializer::to_keyz("words"), words, serializer::to_keyz("wOrder"), wOrder,
+				serializer::to_keyz("rawStr"), rawStr, serializer::to_keyz("origWordPos"), origWordPos, serializer::to_keyz("origWordLen"), origWordLen,
+				serializer::to_keyz("docUid"), docUid
+			);
+		}
 	};
 
-	enum class ParallelScheme { default_, none, copy_merge, partition, size };
+	enum class ParallelScheme { default_, none, copy_merge, partition, async, auto_, hierarchical, size };
 	enum class GlobalSampler { train, freeze_topics, inference, size };
 
 	inline const char* toString(ParallelScheme ps)
@@ -142,6 +174,9 @@ namespace tomoto
 		case ParallelScheme::none: return "none";
 		case ParallelScheme::copy_merge: return "copy_merge";
 		case ParallelScheme::partition: return "partition";
+		case ParallelScheme::async: return "async";
+		case ParallelScheme::auto_: return "auto";
+		case ParallelScheme::hierarchical: return "hierarchical";
 		default: return "unknown";
 		}
 	}
@@ -216,6 +251,217 @@ namespace tomoto
 		}
 	};
 
+	struct TrainingProgress
+	{
+		const ITopicModel* model = nullptr;
+		size_t iteration = 0; // the number of iterations finished in the current training
+		size_t totalIteration = 0;
+		size_t globalStep = 0;
+		double elapsed = 0; // in seconds
+		double tokensPerSec = 0;
+
+		// it is calculated on demand, because calculating log-likelihood is not cheap
+		double getLLPerWord() const;
+	};
+
+	/*
+	the breakdown of the last call of `train`. The phases are those of `trainOne` and their times are wall times summed over the iterations.
+	Only a few clock reads per iteration and per task of the workers are needed to collect it, so it is always collected.
+	*/
+	struct TrainingStats
+	{
+		size_t iterations = 0;
+		double elapsed = 0; // in seconds, including the callbacks
+		double sampling = 0, merging = 0, globalSampling = 0, globalLevel = 0, distributing = 0, optimizing = 0; // in seconds
+		uint64_t tokens = 0; // the number of tokens sampled
+		uint64_t mergeBytes = 0; // the bytes of the workers' states merged into the global state
+		std::vector<double> workerBusy, workerIdle; // the time each worker spent running tasks or waiting for them, in seconds
+		ParallelScheme scheme = ParallelScheme::none; // the scheme the iterations ran with, chosen by the tuner with ParallelScheme::auto_
+		size_t workers = 0;
+
+		// a candidate tried by ParallelScheme::auto_
+		struct Trial
+		{
+			ParallelScheme scheme;
+			size_t workers;
+			double secPerIter; // -1 if the candidate failed or was skipped
+			uint64_t memory; // the estimate of `ITopicModel::estimateTrainingMemory`
+		};
+		std::vector<Trial> tuning; // empty if the decision of an earlier call was reused
+
+		double getTokensPerSec() const
+		{
+			return sampling > 0 ? tokens / sampling : 0;
+		}
+
+		// adds the stats of another call of `train`, whose scheme and workers become those of this
+		void accumulate(const TrainingStats& o)
+		{
+			iterations += o.iterations;
+			elapsed += o.elapsed;
+			sampling += o.sampling;
+			merging += o.merging;
+			globalSampling += o.globalSampling;
+			globalLevel += o.globalLevel;
+			distributing += o.distributing;
+			optimizing += o.optimizing;
+			tokens += o.tokens;
+			mergeBytes += o.mergeBytes;
+			workerBusy.resize(std::max(workerBusy.size(), o.workerBusy.size()));
+			workerIdle.resize(std::max(workerIdle.size(), o.workerIdle.size()));
+			for (size_t i = 0; i < o.workerBusy.size(); ++i) workerBusy[i] += o.workerBusy[i];
+			for (size_t i = 0; i < o.workerIdle.size(); ++i) workerIdle[i] += o.workerIdle[i];
+			scheme = o.scheme;
+			workers = o.workers;
+		}
+	};
+
+	// the names of the structures of a model and the bytes each of them holds, see `ITopicModel::getMemoryUsage`
+	using MemoryUsage = std::vector<std::pair<std::string, uint64_t>>;
+
+	/*
+	the bytes allocated for the elements of a container.
+	Non-owning `tvector`s count nothing, so that the arrays they view are counted once by their owner.
+	*/
+	template<typename _Ty>
+	uint64_t heapBytes(const std::vector<_Ty>& v)
+	{
+		return v.capacity() * sizeof(_Ty);
+	}
+
+	template<typename _Ty>
+	uint64_t heapBytes(const std::vector<std::vector<_Ty>>& v)
+	{
+		uint64_t ret = v.capacity() * sizeof(std::vector<_Ty>);
+		for (auto& e : v) ret += heapBytes(e);
+		return ret;
+	}
+
+	template<typename _Ty>
+	uint64_t heapBytes(const tvector<_Ty>& v)
+	{
+		return v.isOwner() ? v.capacity() * sizeof(_Ty) : 0;
+	}
+
+	template<typename _Derived>
+	uint64_t heapBytes(const Eigen::PlainObjectBase<_Derived>& m)
+	{
+		return m.size() * sizeof(typename _Derived::Scalar);
+	}
+
+	// training stops after the current iteration if the callback returns false
+	using TrainingCallback = std::function<bool(const TrainingProgress&)>;
+
+	// returns a buffer for a row-major matrix of the given shape, which the callee fills
+	using MatrixAllocator = std::function<Float*(size_t rows, size_t cols)>;
+
+	class TrainingHandle
+	{
+		friend class ITopicModel;
+		std::atomic<bool> cancelled{ false };
+		std::shared_future<int> result;
+	public:
+		// training stops at the next callback point after `cancel` is called
+		void cancel() { cancelled = true; }
+		bool isCancelled() const { return cancelled; }
+		bool isDone() const { return result.wait_for(std::chrono::seconds{ 0 }) == std::future_status::ready; }
+
+		// it waits for the training to finish and returns the result of `ITopicModel::train`
+		int get() { return result.get(); }
+	};
+
+	/*
+	wall-clock limits of inference, which bound its latency regardless of `maxIter`.
+	When a limit is reached, the sampling of each document stops at the end of its current iteration
+	and its topics at that point are the estimate. A document begun after the limit keeps its initial topics.
+	*/
+	struct InferenceDeadline
+	{
+		using Clock = std::chrono::steady_clock;
+
+		double seconds = 0; // the limit of a whole call, 0 for no limit
+		double secondsPerDoc = 0; // the limit of each document, 0 for no limit. It is ignored when the documents are inferred together.
+
+		// returns the time point `s` seconds after now, or the farthest time point if `s` is not positive
+		static Clock::time_point after(double s)
+		{
+			if (s <= 0) return Clock::time_point::max();
+			return Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{ s });
+		}
+
+		static bool passed(Clock::time_point end)
+		{
+			return end != Clock::time_point::max() && Clock::now() >= end;
+		}
+	};
+
+	/*
+	A session keeps a thread pool, scratch states and random generators alive between calls of `infer`,
+	so repeated inference of small batches doesn't pay for creating them every time.
+	The model must not be trained or destroyed while its sessions are in use.
+	*/
+	class IInferenceSession
+	{
+	public:
+		virtual ~IInferenceSession() {}
+		// it works the same as `ITopicModel::infer`. Calls from multiple threads are serialized.
+		virtual std::vector<double> infer(const std::vector<DocumentBase*>& docs, size_t maxIter, Float tolerance, bool together,
+			const InferenceDeadline& deadline = {}, std::vector<uint32_t>* iterations = nullptr) = 0;
+		virtual size_t getNumWorkers() const = 0;
+		virtual ParallelScheme getParallelScheme() const = 0;
+	};
+
+	template<typename _RandGen, typename _ModelState>
+	struct InferenceContext
+	{
+		std::unique_ptr<ThreadPool> pool;
+		std::vector<_ModelState> states; // scratch state of each worker
+		std::vector<_RandGen> rgs; // random generator of each worker
+		std::vector<char> synced; // whether each scratch state equals the global state of the model
+		size_t syncedStep = -1; // `globalStep` of the model when `states` were synced
+	};
+
+	template<typename _Model, typename _Context>
+	class InferenceSession : public IInferenceSession
+	{
+		const _Model* model;
+		size_t numWorkers;
+		ParallelScheme ps;
+		_Context ctx;
+		std::mutex mtx;
+	public:
+		InferenceSession(const _Model* _model, size_t _numWorkers, ParallelScheme _ps, _Context&& _ctx)
+			: model{ _model }, numWorkers{ _numWorkers }, ps{ _ps }, ctx{ std::move(_ctx) }
+		{
+		}
+
+		std::vector<double> infer(const std::vector<DocumentBase*>& docs, size_t maxIter, Float tolerance, bool together,
+			const InferenceDeadline& deadline = {}, std::vector<uint32_t>* iterations = nullptr) override
+		{
+			std::lock_guard<std::mutex> lock{ mtx };
+			return model->inferWithContext(docs, maxIter, tolerance, numWorkers, ps, together, &ctx, deadline, iterations);
+		}
+
+		size_t getNumWorkers() const override { return numWorkers; }
+		ParallelScheme getParallelScheme() const override { return ps; }
+	};
+
+	/*
+	A batch of documents whose word ids are laid out in one contiguous buffer,
+	which can be added to a model at once by `ITopicModel::addDocs`.
+	*/
+	struct DocBatch
+	{
+		const Vid* words = nullptr; // word ids of all documents concatenated
+		const size_t* offsets = nullptr; // words of the i-th document are in [offsets[i], offsets[i + 1])
+		size_t size = 0; // the number of documents
+		const Vid* vocabRemap = nullptr; // maps a word id of `words` into the model's one or into `non_vocab_id` to drop the word. null means the identity.
+
+		// fills the weight, uid, raw string and word positions of the i-th document.
+		// `kept` has the indices of its words which are not dropped. it is called from multiple threads at once.
+		std::function<void(size_t i, RawDocKernel& doc, const std::vector<uint32_t>& kept)> fillKernel;
+	};
+
 	class ITopicModel
 	{
 	public:
@@ -223,6 +469,9 @@ namespace tomoto
 			const std::vector<uint8_t>* extra_data = nullptr) const = 0;
 		virtual void loadModel(std::istream& reader, 
 			std::vector<uint8_t>* extra_data = nullptr) = 0;
+		// large arrays of the model use the mapped memory in place, if they were saved with `serializer::setAlignedSections`
+		virtual void loadModel(const std::shared_ptr<MMap>& mapped,
+			std::vector<uint8_t>* extra_data = nullptr) = 0;
 
 		virtual std::unique_ptr<ITopicModel> copy() const = 0;
 
@@ -237,6 +486,10 @@ namespace tomoto
 		virtual size_t addDoc(const RawDoc& rawDoc) = 0;
 		virtual std::unique_ptr<DocumentBase> makeDoc(const RawDoc& rawDoc) const = 0;
 
+		// it adds all documents of `batch` using `numWorkers` threads and returns the id of each document, or -1 for an empty one.
+		// only models whose documents need no misc data support it.
+		virtual std::vector<size_t> addDocs(const DocBatch& batch, size_t numWorkers) = 0;
+
 		virtual bool updateVocab(const std::vector<std::string>& words) = 0;
 
 		virtual double getDocLL(const DocumentBase* doc) const = 0;
@@ -252,8 +505,49 @@ namespace tomoto
 		virtual std::vector<double> getVocabWeightedCf() const = 0;
 		virtual const std::vector<uint64_t>& getVocabDf() const = 0;
 
-		virtual int train(size_t iteration, size_t numWorkers, ParallelScheme ps = ParallelScheme::default_, bool freeze_topics = false) = 0;
+		virtual int train(size_t iteration, size_t numWorkers, ParallelScheme ps = ParallelScheme::default_, bool freeze_topics = false,
+			const TrainingCallback& callback = {}, size_t callbackInterval = 1) = 0;
+
+		// it runs `train` in a background thread. The model must not be accessed until the training is done, except in `callback`.
+		std::unique_ptr<TrainingHandle> trainAsync(size_t iteration, size_t numWorkers, ParallelScheme ps = ParallelScheme::default_, bool freeze_topics = false,
+			TrainingCallback callback = {}, size_t callbackInterval = 1)
+		{
+			auto handle = std::make_unique<TrainingHandle>();
+			auto* h = handle.get();
+			handle->result = std::async(std::launch::async, [=]()
+			{
+				return train(iteration, numWorkers, ps, freeze_topics, [=](const TrainingProgress& p)
+				{
+					if (h->isCancelled()) return false;
+					return callback ? callback(p) : true;
+				}, callbackInterval);
+			}).share();
+			return handle;
+		}
 		virtual size_t getGlobalStep() const = 0;
+		virtual const TrainingStats& getTrainingStats() const = 0;
+		/*
+		the bytes held by each structure of the model. The states of the workers (`localData[i]`) are those at the end of the last `train`,
+		which are freed when it returns. Arrays mapped from a file are not counted,
+		and arrays shared with copies of the model are reported as `sharedArrays` by each of the sharing models.
+		*/
+		virtual MemoryUsage getMemoryUsage() const = 0;
+		// the peak bytes expected while `train` runs with the given workers and scheme, resolved the same way as `train` does
+		virtual uint64_t estimateTrainingMemory(size_t numWorkers, ParallelScheme ps = ParallelScheme::default_) const = 0;
+		virtual uint64_t getAutoMemoryLimit() const = 0;
+		// the candidates of ParallelScheme::auto_ whose `estimateTrainingMemory` exceeds it are skipped, 0 for no limit
+		virtual void setAutoMemoryLimit(uint64_t) = 0;
+		virtual bool getNumaAware() const = 0;
+		// if true, `train` binds workers to NUMA nodes and lets each worker allocate its own state
+		virtual void setNumaAware(bool) = 0;
+		virtual bool getTracing() const = 0;
+		// if true, `train` records the spans of its phases and of the tasks of its workers, see `TraceRecorder`
+		virtual void setTracing(bool) = 0;
+		// writes the trace of the last `train` in the Chrome trace event format. It throws if the last `train` was not traced.
+		virtual void writeTrace(std::ostream& ostr) const = 0;
+		virtual size_t getPrepareWorkers() const = 0;
+		// the number of threads used by `prepare`, 0 for all cores. it doesn't change the result of `prepare`.
+		virtual void setPrepareWorkers(size_t) = 0;
 		virtual void prepare(bool initDocs = true, size_t minWordCnt = 0, size_t minWordDf = 0, size_t removeTopN = 0, bool updateStopwords = true) = 0;
 		
 		virtual size_t getK() const = 0;
@@ -264,25 +558,218 @@ namespace tomoto
 		
 		virtual std::vector<Float> getTopicsByDoc(const DocumentBase* doc, bool normalize = true) const = 0;
 		virtual std::vector<std::pair<Tid, Float>> getTopicsByDocSorted(const DocumentBase* doc, size_t topN) const = 0;
-		virtual std::vector<double> infer(const std::vector<DocumentBase*>& docs, size_t maxIter, Float tolerance, size_t numWorkers, ParallelScheme ps, bool together) const = 0;
+
+		// fills a (topics, vocabs) matrix from `alloc` with getWidsByTopic of all topics, using `numWorkers` threads
+		virtual void getWidsByTopics(const MatrixAllocator& alloc, bool normalize, size_t numWorkers) const = 0;
+		/*
+		fills a (documents, topics) matrix from `alloc` with getTopicsByDoc of all documents of the model, using `numWorkers` threads.
+		The rows of documents which have no topics yet are filled with NaN.
+		*/
+		virtual void getTopicsByDocs(const MatrixAllocator& alloc, bool normalize, size_t numWorkers) const = 0;
+		/*
+		fills `vids` and `weights` with the `topN` most probable words of all topics, which are concatenated in the order of topics,
+		using `numWorkers` threads. It returns the number of words per topic, which is `topN` or the number of vocabularies if smaller.
+		*/
+		virtual size_t getWidsByTopicsSorted(size_t topN, size_t numWorkers, std::vector<Vid>& vids, std::vector<Float>& weights) const = 0;
+		/*
+		infers the topic distributions of `docs`, which are not added to the model.
+		It never modifies the model, so multiple threads may call it on the same model at the same time,
+		as long as none of them modifies the model (by `train`, `prepare` and so on) meanwhile.
+		*/
+		/*
+		With `deadline`, the sampling stops when its limits are reached, see `InferenceDeadline`.
+		If `iterations` is not null, it receives the number of iterations done for each document.
+		*/
+		virtual std::vector<double> infer(const std::vector<DocumentBase*>& docs, size_t maxIter, Float tolerance, size_t numWorkers, ParallelScheme ps, bool together,
+			const InferenceDeadline& deadline = {}, std::vector<uint32_t>* iterations = nullptr) const = 0;
+		virtual std::unique_ptr<IInferenceSession> makeInferenceSession(size_t numWorkers, ParallelScheme ps) const = 0;
 		virtual ~ITopicModel() {}
 	};
 
+	inline double TrainingProgress::getLLPerWord() const
+	{
+		return model->getLLPerWord();
+	}
+
+	/*
+	the table of contents written as the last tagged data of the header of model files.
+	The offsets are from the start of the model, and the counts are 0 if the documents were not saved.
+	It has a fixed size so that it can be written before the sections and filled in after them.
+	*/
+	struct ModelFileToc
+	{
+		static constexpr size_t serializedSize = sizeof(uint64_t) * 6;
+
+		uint64_t params = 0; // the parameters of the model
+		uint64_t state = 0; // the topic counts of the global state
+		uint64_t docs = 0;
+		uint64_t end = 0;
+		uint64_t numDocs = 0, numWords = 0;
+
+		DEFINE_SERIALIZER(params, state, docs, end, numDocs, numWords);
+	};
+
+	/*
+	the raw texts and the spans of the words of all the documents, written as a tagged data of the header of model files
+	instead of the fields of each document, see `serializer::setRawTextColumns`.
+	Each column is written as one array, and the documents are delimited by the offsets, so no document has its own framing.
+	Versions prior to 0.12.3 ignore it and load the documents without their raw texts.
+	*/
+	struct RawTextColumns
+	{
+		// the documents to be written
+		size_t numDocs = 0;
+		std::function<const RawDocKernel&(size_t)> getDoc;
+
+		// the columns read, where the text and the spans of the i-th document are in [offsets[i], offsets[i + 1])
+		SharedString text;
+		std::vector<uint64_t> textOffsets, spanOffsets;
+		std::vector<uint32_t> wordPos;
+		std::vector<uint16_t> wordLen;
+
+		void serializerWrite(std::ostream& ostr) const
+		{
+			std::vector<uint64_t> offsets(numDocs + 1);
+			for (size_t i = 0; i < numDocs; ++i) offsets[i + 1] = offsets[i] + getDoc(i).rawStr.size();
+			serializer::writeMany(ostr, (uint64_t)numDocs);
+			writeColumn(ostr, offsets.data(), offsets.size());
+			for (size_t i = 0; i < numDocs; ++i) writeColumn(ostr, getDoc(i).rawStr.data(), getDoc(i).rawStr.size());
+
+			for (size_t i = 0; i < numDocs; ++i)
+			{
+				auto& doc = getDoc(i);
+				if (doc.origWordPos.size() != doc.origWordLen.size()) throw std::ios_base::failure("the spans of words are mismatched");
+				offsets[i + 1] = offsets[i] + doc.origWordPos.size();
+			}
+			writeColumn(ostr, offsets.data(), offsets.size());
+			for (size_t i = 0; i < numDocs; ++i) writeColumn(ostr, getDoc(i).origWordPos.data(), getDoc(i).origWordPos.size());
+			for (size_t i = 0; i < numDocs; ++i) writeColumn(ostr, getDoc(i).origWordLen.data(), getDoc(i).origWordLen.size());
+		}
+
+		void serializerRead(std::istream& istr)
+		{
+			numDocs = serializer::readFromStream<uint64_t>(istr);
+			textOffsets.resize(numDocs + 1);
+			readColumn(istr, textOffsets.data(), textOffsets.size());
+			text = SharedString::build(textOffsets.back(), [&](char* data)
+			{
+				readColumn(istr, data, textOffsets.back());
+			});
+			spanOffsets.resize(numDocs + 1);
+			readColumn(istr, spanOffsets.data(), spanOffsets.size());
+			wordPos.resize(spanOffsets.back());
+			readColumn(istr, wordPos.data(), wordPos.size());
+			wordLen.resize(spanOffsets.back());
+			readColumn(istr, wordLen.data(), wordLen.size());
+		}
+
+	private:
+		template<typename _Ty>
+		static void writeColumn(std::ostream& ostr, const _Ty* data, size_t size)
+		{
+			if (!ostr.write((const char*)data, sizeof(_Ty) * size))
+				throw std::ios_base::failure("writing the raw texts is failed");
+		}
+
+		template<typename _Ty>
+		static void readColumn(std::istream& istr, _Ty* data, size_t size)
+		{
+			if (!istr.read((char*)data, sizeof(_Ty) * size))
+				throw std::ios_base::failure("reading the raw texts is failed");
+		}
+	};
+
+	// what `readModelInfo` reads from a model file without loading the model
+	struct ModelInfo
+	{
+		std::string tmid, twid; // the keys of the model type and its term weighting, like "LDA" and "one"
+		Dictionary dict;
+		uint64_t realV = 0;
+		size_t globalStep = 0;
+		std::vector<uint8_t> extra;
+		size_t k = 0;
+		Float alpha = 0, eta = 0;
+		bool hasToc = false; // files saved by older versions have no table of contents
+		ModelFileToc toc;
+	};
+
+	/*
+	reads the header and the common parameters of the model saved in `reader`, seeking over all the other data.
+	The documents and the topic counts, which make up most of a model file, are never read.
+	*/
+	inline ModelInfo readModelInfo(std::istream& reader)
+	{
+		ModelInfo info;
+		const std::streampos start = reader.tellg();
+		// the keys are zero-terminated and those shorter than 4 characters are padded with zeros
+		auto readKey = [&]()
+		{
+			std::string ret;
+			for (int c; (c = reader.get()) > 0; ) ret.push_back((char)c);
+			if (!reader) throw std::ios_base::failure("reading the model key is failed");
+			while (reader.peek() == 0) reader.get();
+			return ret;
+		};
+		info.tmid = readKey();
+		info.twid = readKey();
+
+		serializer::TaggedDataHeader header;
+		if (!serializer::readTaggedDataHeader(reader, header))
+		{
+			throw std::ios_base::failure("the model file is saved by an old version, which has no tagged header");
+		}
+		while (true)
+		{
+			if (header.key == "dict") serializer::readMany(reader, info.dict);
+			else if (header.key == "realV") serializer::readMany(reader, info.realV);
+			else if (header.key == "globalStep") serializer::readMany(reader, info.globalStep);
+			else if (header.key == "extra") serializer::readMany(reader, info.extra);
+			else if (header.key == "toc")
+			{
+				serializer::readMany(reader, info.toc);
+				info.hasToc = true;
+			}
+			reader.seekg(header.endPos);
+			if (!header.trailingCnt) break;
+			if (!serializer::readTaggedDataHeader(reader, header)) throw std::ios_base::failure("broken header of the model file");
+		}
+
+		// the parameters are the tagged data of each class of the model, followed by the global state
+		if (info.hasToc) reader.seekg(start + (std::streamoff)info.toc.params);
+		while ((!info.hasToc || reader.tellg() < start + (std::streamoff)info.toc.state)
+			&& serializer::readTaggedDataHeader(reader, header))
+		{
+			if (header.key == "K")
+			{
+				Tid k;
+				serializer::readMany(reader, k);
+				info.k = k;
+			}
+			else if (header.key == "alpha") serializer::readMany(reader, info.alpha);
+			else if (header.key == "eta") serializer::readMany(reader, info.eta);
+			reader.seekg(header.endPos);
+		}
+		return info;
+	}
+
 	template<class _TyKey, class _TyValue>
 	static std::vector<std::pair<_TyKey, _TyValue>> extractTopN(const std::vector<_TyValue>& vec, size_t topN)
 	{
 		typedef std::pair<_TyKey, _TyValue> pair_t;
 		std::vector<pair_t> ret;
+		ret.reserve(vec.size());
 		_TyKey k = 0;
 		for (auto& t : vec)
 		{
 			ret.emplace_back(std::make_pair(k++, t));
 		}
-		std::sort(ret.begin(), ret.end(), [](const pair_t& a, const pair_t& b)
+		// only the first `topN` are sorted, and ties are broken by the key so that the result is deterministic
+		topN = std::min(topN, ret.size());
+		std::partial_sort(ret.begin(), ret.begin() + topN, ret.end(), [](const pair_t& a, const pair_t& b)
 		{
-			return a.second > b.second;
+			return a.second > b.second || (a.second == b.second && a.first < b.first);
 		});
-		if (topN < ret.size()) ret.erase(ret.begin() + topN, ret.end());
+		ret.erase(ret.begin() + topN, ret.end());
 		return ret;
 	}
 
@@ -293,7 +780,9 @@ namespace tomoto
 			continuous_doc_data = 1 << 0,
 			shared_state = 1 << 1,
 			partitioned_multisampling = 1 << 2,
-			end_flag_of_TopicModel = 1 << 3,
+			asynchronous_multisampling = 1 << 3,
+			hierarchical_multisampling = 1 << 4,
+			end_flag_of_TopicModel = 1 << 5,
 		};
 	}
 
@@ -312,10 +801,22 @@ namespace tomoto
 		std::vector<uint32_t> wOffsetByDoc;
 
 		std::vector<DocType> docs;
+		/*
+		the arrays of the spans viewed by `origWordPos` and `origWordLen` of the documents.
+		They are never modified after being packed, so copies of the model share them.
+		*/
+		struct WordSpans
+		{
+			std::vector<uint32_t> pos;
+			std::vector<uint16_t> len;
+		};
+		std::shared_ptr<const WordSpans> wordSpans;
 		std::vector<uint64_t> vocabCf;
 		std::vector<uint64_t> vocabDf;
 		std::unordered_map<SharedString, size_t> uidMap;
 		size_t globalStep = 0;
+		TrainingStats trainingStats;
+		std::vector<uint64_t> localDataMemory; // the bytes of each worker's state at the end of the last `train`
 		_ModelState globalState, tState;
 		Dictionary dict;
 		uint64_t realV = 0; // vocab size after removing stopwords
@@ -325,9 +826,30 @@ namespace tomoto
 		size_t minWordCf = 0, minWordDf = 0, removeTopN = 0;
 
 		PreventCopy<std::unique_ptr<ThreadPool>> cachedPool;
-
+		bool numaAware = false;
+		bool tracing = false;
+		// the trace of the last `train`, which the phases of `trainOne` are recorded into while it runs
+		PreventCopy<std::unique_ptr<TraceRecorder>> trace;
+
+		/*
+		ParallelScheme::auto_ trains `autoTuneIterations` iterations with each candidate of `getAutoCandidates` and goes on with the fastest one.
+		The decision is reused by later calls with the same number of workers, until the number of documents changes.
+		*/
+		static constexpr size_t autoTuneIterations = 2;
+		uint64_t autoMemoryLimit = 0;
+		ParallelScheme tunedScheme = ParallelScheme::default_;
+		size_t tunedWorkers = 0, tunedForWorkers = 0, tunedForDocs = 0;
+		size_t prepareWorkers = 0;
+		std::shared_ptr<MMap> mappedFile; // keeps the memory alive when the model state points into a mapped file
+
+		/*
+		The table of contents is written last in the header, where older versions skip it,
+		and is filled in when the offsets of all the sections are known, see `readModelInfo`.
+		*/
 		void _saveModel(std::ostream& writer, bool fullModel, const std::vector<uint8_t>* extra_data) const
 		{
+			const std::streampos start = writer.tellp();
+			ModelFileToc toc;
 			serializer::writeMany(writer,
 				serializer::to_keyz(static_cast<const _Derived*>(this)->tmid()),
 				serializer::to_keyz(static_cast<const _Derived*>(this)->twid())
@@ -338,23 +860,40 @@ namespace tomoto
 				serializer::to_keyz("vocabDf"), vocabDf,
 				serializer::to_keyz("realV"), realV,
 				serializer::to_keyz("globalStep"), globalStep,
-				serializer::to_keyz("extra"), extra_data ? *extra_data : std::vector<uint8_t>(0)
+				serializer::to_keyz("extra"), extra_data ? *extra_data : std::vector<uint8_t>(0),
+				serializer::to_keyz("rawText"), makeRawTextColumns(fullModel),
+				serializer::to_keyz("toc"), toc
 			);
+			const std::streampos tocEnd = writer.tellp();
+			toc.params = tocEnd - start;
 			serializer::writeMany(writer, *static_cast<const _Derived*>(this));
+			toc.state = writer.tellp() - start;
 			globalState.serializerWrite(writer);
+			toc.docs = writer.tellp() - start;
 			if (fullModel)
 			{
+				const bool rawTextColumns = serializer::isRawTextColumns(writer);
+				serializer::setRawTextColumns(writer);
 				serializer::writeMany(writer, docs);
+				serializer::setRawTextColumns(writer, rawTextColumns);
+				toc.numDocs = docs.size();
+				toc.numWords = realN;
 			}
 			else
 			{
 				serializer::writeMany(writer, std::vector<size_t>{});
 			}
+			const std::streampos end = writer.tellp();
+			toc.end = end - start;
+			writer.seekp(tocEnd - (std::streamoff)ModelFileToc::serializedSize);
+			serializer::writeMany(writer, toc);
+			writer.seekp(end);
 		}
 
 		void _loadModel(std::istream& reader, std::vector<uint8_t>* extra_data)
 		{
 			auto start_pos = reader.tellg();
+			RawTextColumns rawText;
 			try
 			{
 				std::vector<uint8_t> extra;
@@ -368,7 +907,8 @@ namespace tomoto
 					serializer::to_keyz("vocabDf"), vocabDf,
 					serializer::to_keyz("realV"), realV,
 					serializer::to_keyz("globalStep"), globalStep,
-					serializer::to_keyz("extra"), extra);
+					serializer::to_keyz("extra"), extra,
+					serializer::to_keyz("rawText"), rawText);
 				if (extra_data) *extra_data = std::move(extra);
 			}
 			catch (const std::ios_base::failure&)
@@ -383,6 +923,7 @@ namespace tomoto
 			serializer::readMany(reader, *static_cast<_Derived*>(this));
 			globalState.serializerRead(reader);
 			serializer::readMany(reader, docs);
+			if (rawText.numDocs && rawText.numDocs == docs.size()) setRawTextColumns(std::move(rawText));
 			auto p = countRealN();
 			realN = p.first;
 			weightedN = p.second;
@@ -410,6 +951,103 @@ namespace tomoto
 			return docs.size() - 1;
 		}
 
+		std::vector<size_t> _addDocs(const DocBatch& batch, size_t numWorkers)
+		{
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			numWorkers = std::max(std::min(numWorkers, batch.size / 256), (size_t)1);
+			const size_t V = dict.size();
+			std::vector<DocType> newDocs(batch.size);
+			std::vector<std::vector<uint64_t>> localCf(numWorkers), localDf(numWorkers);
+
+			// each worker builds a contiguous range of documents and counts their words on its own
+			auto build = [&](size_t w)
+			{
+				auto& cf = localCf[w];
+				auto& df = localDf[w];
+				cf.resize(V);
+				df.resize(V);
+				std::vector<size_t> lastDoc(V, (size_t)-1);
+				std::vector<uint32_t> kept;
+				for (size_t i = batch.size * w / numWorkers; i < batch.size * (w + 1) / numWorkers; ++i)
+				{
+					auto& doc = newDocs[i];
+					const Vid* src = batch.words + batch.offsets[i];
+					const size_t len = batch.offsets[i + 1] - batch.offsets[i];
+					kept.clear();
+					doc.words.resize(len);
+					for (size_t j = 0; j < len; ++j)
+					{
+						Vid v = src[j];
+						if (v == non_vocab_id) continue;
+						if (batch.vocabRemap) v = batch.vocabRemap[v];
+						if (v == non_vocab_id) continue;
+						if (v >= V) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "word id " + std::to_string(v) + " is out of the vocabulary.");
+						doc.words[kept.size()] = v;
+						kept.emplace_back((uint32_t)j);
+						++cf[v];
+						if (lastDoc[v] != i)
+						{
+							lastDoc[v] = i;
+							++df[v];
+						}
+					}
+					doc.words.resize(kept.size());
+					if (batch.fillKernel) batch.fillKernel(i, doc, kept);
+				}
+			};
+
+			if (numWorkers > 1)
+			{
+				auto pool = PoolManager::getInstance().borrow(numWorkers);
+				std::vector<std::future<void>> futures;
+				for (size_t w = 0; w < numWorkers; ++w)
+				{
+					futures.emplace_back(pool->enqueue([&, w](size_t) { build(w); }));
+				}
+				for (auto& f : futures) f.get();
+			}
+			else build(0);
+
+			// uids are checked before any document is added, so that a failure leaves the model unchanged
+			std::unordered_set<SharedString> batchUids;
+			for (auto& doc : newDocs)
+			{
+				if (doc.words.empty() || doc.docUid.empty()) continue;
+				if (uidMap.count(doc.docUid) || !batchUids.emplace(doc.docUid).second)
+					throw exc::InvalidArgument{ "there is a document with uid = '" + std::string{ doc.docUid } + "' already." };
+			}
+
+			if (vocabCf.size() < V)
+			{
+				vocabCf.resize(V);
+				vocabDf.resize(V);
+			}
+			for (size_t w = 0; w < numWorkers; ++w)
+			{
+				for (size_t v = 0; v < V; ++v)
+				{
+					vocabCf[v] += localCf[w][v];
+					vocabDf[v] += localDf[w][v];
+				}
+			}
+
+			std::vector<size_t> ret;
+			ret.reserve(batch.size);
+			docs.reserve(docs.size() + batch.size);
+			for (auto& doc : newDocs)
+			{
+				if (doc.words.empty())
+				{
+					ret.emplace_back(-1);
+					continue;
+				}
+				if (!doc.docUid.empty()) uidMap.emplace(doc.docUid, docs.size());
+				ret.emplace_back(docs.size());
+				docs.emplace_back(std::move(doc));
+			}
+			return ret;
+		}
+
 		template<bool _const = false>
 		DocType _makeFromRawDoc(const RawDoc& rawDoc)
 		{
@@ -485,6 +1123,73 @@ namespace tomoto
 				makeTransformIter(docs.begin(), tx),
 				makeTransformIter(docs.end(), tx)
 			);
+			packRawText();
+		}
+
+		/*
+		packs the raw texts and the uids of all documents into one block each, and the spans of their words into `wordSpans`,
+		so that the documents refer to them by offsets instead of owning many small allocations.
+		*/
+		void packRawText()
+		{
+			auto txRaw = [](_DocType& doc) { return &doc.rawStr; };
+			SharedString::trade(makeTransformIter(docs.begin(), txRaw), makeTransformIter(docs.end(), txRaw));
+			auto txUid = [](_DocType& doc) { return &doc.docUid; };
+			SharedString::trade(makeTransformIter(docs.begin(), txUid), makeTransformIter(docs.end(), txUid));
+			// the keys of `uidMap` would keep the old blocks alive
+			if (!uidMap.empty())
+			{
+				uidMap.clear();
+				for (size_t i = 0; i < docs.size(); ++i)
+				{
+					if (!docs[i].docUid.empty()) uidMap.emplace(docs[i].docUid, i);
+				}
+			}
+
+			// the old spans are kept alive until they are copied, since the documents may view them
+			auto oldSpans = std::move(wordSpans);
+			auto spans = std::make_shared<WordSpans>();
+			auto txPos = [](_DocType& doc) { return &doc.origWordPos; };
+			tvector<uint32_t>::trade(spans->pos, makeTransformIter(docs.begin(), txPos), makeTransformIter(docs.end(), txPos));
+			auto txLen = [](_DocType& doc) { return &doc.origWordLen; };
+			tvector<uint16_t>::trade(spans->len, makeTransformIter(docs.begin(), txLen), makeTransformIter(docs.end(), txLen));
+			if (!spans->pos.empty() || !spans->len.empty()) wordSpans = std::move(spans);
+		}
+
+		RawTextColumns makeRawTextColumns(bool fullModel) const
+		{
+			RawTextColumns ret;
+			if (!fullModel) return ret;
+			ret.numDocs = docs.size();
+			ret.getDoc = [this](size_t i) -> const RawDocKernel& { return docs[i]; };
+			return ret;
+		}
+
+		// makes the documents loaded by `_loadModel` refer to the columns of their raw texts and spans
+		void setRawTextColumns(RawTextColumns&& columns)
+		{
+			auto spans = std::make_shared<WordSpans>();
+			spans->pos = std::move(columns.wordPos);
+			spans->len = std::move(columns.wordLen);
+			for (size_t i = 0; i < docs.size(); ++i)
+			{
+				auto& doc = docs[i];
+				const uint64_t b = columns.textOffsets[i], e = columns.textOffsets[i + 1];
+				const uint64_t sb = columns.spanOffsets[i], se = columns.spanOffsets[i + 1];
+				if (b > e || e > columns.text.size() || sb > se || se > spans->pos.size())
+				{
+					throw std::ios_base::failure("broken raw texts of the documents");
+				}
+				doc.rawStr = columns.text.slice(b, e - b);
+				doc.origWordPos = tvector<uint32_t>{ spans->pos.data() + sb, (size_t)(se - sb) };
+				doc.origWordLen = tvector<uint16_t>{ spans->len.data() + sb, (size_t)(se - sb) };
+			}
+			wordSpans = std::move(spans);
+		}
+
+		// gives the model its own copies of the arrays it shares with its copies, before it modifies them
+		void detachShared()
+		{
 		}
 
 		void updateForCopy()
@@ -492,6 +1197,8 @@ namespace tomoto
 			size_t offset = 0;
 			for (auto& doc : docs)
 			{
+				// documents not prepared yet own their words, which are copied with them
+				if (doc.words.isOwner()) continue;
 				size_t size = doc.words.size();
 				doc.words = tvector<Vid>{ words.data() + offset, size };
 				offset += size;
@@ -510,13 +1217,56 @@ namespace tomoto
 					if (w < realV)
 					{
 						++n;
-						weighted += doc.wordWeights.empty() ? 1 : doc.wordWeights[i];
+						weighted += static_cast<const _Derived*>(this)->getWordWeight(doc, i);
 					}
 				}
 			}
 			return std::make_pair(n, weighted);
 		}
 
+		static constexpr size_t prepareChunkSize = 4096;
+
+		size_t getNumPrepareChunks(size_t n) const
+		{
+			return (n + prepareChunkSize - 1) / prepareChunkSize;
+		}
+
+		size_t getNumPrepareThreads(size_t n) const
+		{
+			size_t numWorkers = prepareWorkers ? prepareWorkers : std::thread::hardware_concurrency();
+			return std::max(std::min(numWorkers, getNumPrepareChunks(n)), (size_t)1);
+		}
+
+		/*
+		calls `fn(threadId, chunkId, begin, end)` for every chunk of [0, n) on `numThreads` threads.
+		Chunks have a fixed size regardless of `numThreads`, so work seeded by `chunkId` gives the same result for any number of threads.
+		*/
+		template<typename _Fn>
+		void forEachPrepareChunk(size_t numThreads, size_t n, _Fn&& fn) const
+		{
+			const size_t numChunks = getNumPrepareChunks(n);
+			if (numThreads <= 1)
+			{
+				for (size_t c = 0; c < numChunks; ++c) fn(0, c, c * prepareChunkSize, std::min((c + 1) * prepareChunkSize, n));
+				return;
+			}
+
+			auto pool = PoolManager::getInstance().borrow(numThreads);
+			std::atomic<size_t> nextChunk{ 0 };
+			std::vector<std::future<void>> futures;
+			for (size_t t = 0; t < numThreads; ++t)
+			{
+				futures.emplace_back(pool->enqueue([&, t](size_t)
+				{
+					for (size_t c; (c = nextChunk++) < numChunks;)
+					{
+						fn(t, c, c * prepareChunkSize, std::min((c + 1) * prepareChunkSize, n));
+					}
+				}));
+			}
+			for (auto& f : futures) f.get();
+		}
+
 		void removeStopwords(size_t minWordCnt, size_t minWordDf, size_t removeTopN)
 		{
 			if (minWordCnt <= 1 && minWordDf <= 1 && removeTopN == 0) realV = dict.size();
@@ -558,10 +1308,19 @@ namespace tomoto
 			}
 
 			dict.reorder(order);
-			for (auto& doc : docs)
+			forEachPrepareChunk(getNumPrepareThreads(docs.size()), docs.size(), [&](size_t, size_t, size_t b, size_t e)
 			{
-				for (auto& w : doc.words) w = order[w];
-			}
+				for (size_t i = b; i < e; ++i)
+				{
+					for (auto& w : docs[i].words) w = order[w];
+				}
+			});
+		}
+
+		template<typename _Doc>
+		Float getWordWeight(const _Doc& doc, size_t pid) const
+		{
+			return doc.wordWeights.empty() ? 1 : doc.wordWeights[pid];
 		}
 
 		int restoreFromTrainingError(const exc::TrainingError& e, ThreadPool& pool, _ModelState* localData, _RandGen* rgs)
@@ -569,6 +1328,179 @@ namespace tomoto
 			throw e;
 		}
 
+		// the scheme `train` runs with, after `ps` is resolved and reduced for the number of workers
+		ParallelScheme getTrainingScheme(ParallelScheme ps) const
+		{
+			return ps;
+		}
+
+		// appends the structures of the derived model to the report of `getMemoryUsage`
+		void addMemoryUsage(MemoryUsage& ret) const
+		{
+		}
+
+		/*
+		the bytes `train` allocates in addition to the current structures when `numWorkers` workers train with `ps`,
+		which is the already resolved scheme of `getTrainingScheme`.
+		By default, every worker and the snapshot of the global state merged against (`tState`) copy the global state.
+		*/
+		uint64_t estimateTrainingOverhead(size_t numWorkers, ParallelScheme ps) const
+		{
+			if (ps == ParallelScheme::none) return 0;
+			const uint64_t state = globalState.getMemoryUsage();
+			return numWorkers * state + (tState.getMemoryUsage() ? 0 : state);
+		}
+
+		// the candidates of ParallelScheme::auto_: each scheme the model provides with all the workers and with half of them
+		std::vector<std::pair<ParallelScheme, size_t>> getAutoCandidates(size_t numWorkers) const
+		{
+			std::vector<std::pair<ParallelScheme, size_t>> ret;
+			if (numWorkers > 1 && !(_Flags & flags::shared_state))
+			{
+				for (auto ps : { ParallelScheme::copy_merge, ParallelScheme::partition, ParallelScheme::async, ParallelScheme::hierarchical })
+				{
+					if (ps == ParallelScheme::partition && !(_Flags & flags::partitioned_multisampling)) continue;
+					if (ps == ParallelScheme::async && !(_Flags & flags::asynchronous_multisampling)) continue;
+					if (ps == ParallelScheme::hierarchical && !(_Flags & flags::hierarchical_multisampling)) continue;
+					for (size_t w : { numWorkers, numWorkers / 2 })
+					{
+						if (maxThreads[(size_t)ps]) w = std::min(w, maxThreads[(size_t)ps]);
+						if (w < 2) continue;
+						auto c = std::make_pair(ps, w);
+						if (std::find(ret.begin(), ret.end(), c) == ret.end()) ret.emplace_back(c);
+					}
+				}
+			}
+			if (ret.empty()) ret.emplace_back(ParallelScheme::none, 1);
+			return ret;
+		}
+
+		int trainAuto(size_t iteration, size_t numWorkers, bool freeze_topics, const TrainingCallback& callback, size_t callbackInterval)
+		{
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			TrainingStats total;
+			size_t done = 0;
+			bool stopped = false;
+			// the callback sees the iterations of all the calls of `train` below as those of one call
+			TrainingCallback innerCallback;
+			if (callback) innerCallback = [&](const TrainingProgress& p)
+			{
+				const size_t i = done + p.iteration;
+				if (i % callbackInterval && i != iteration) return true;
+				TrainingProgress q = p;
+				q.iteration = i;
+				q.totalIteration = iteration;
+				q.elapsed += total.elapsed;
+				q.tokensPerSec = q.elapsed > 0 ? realN * (double)i / q.elapsed : 0;
+				if (callback(q)) return true;
+				stopped = true;
+				return false;
+			};
+			auto run = [&](size_t iters, ParallelScheme ps, size_t workers)
+			{
+				const int ret = train(iters, workers, ps, freeze_topics, innerCallback, 1);
+				total.accumulate(trainingStats);
+				done += trainingStats.iterations;
+				return ret;
+			};
+
+			if (tunedScheme == ParallelScheme::default_ || tunedForWorkers != numWorkers || tunedForDocs != docs.size())
+			{
+				double bestTime = std::numeric_limits<double>::infinity();
+				uint64_t leastMemory = -1;
+				ParallelScheme bestScheme = ParallelScheme::default_, leastScheme = ParallelScheme::default_;
+				size_t bestWorkers = 0, leastWorkers = 0;
+				bool complete = true;
+				std::exception_ptr lastError;
+				for (auto& c : getAutoCandidates(numWorkers))
+				{
+					TrainingStats::Trial trial{ c.first, c.second, -1, 0 };
+					try
+					{
+						trial.memory = estimateTrainingMemory(c.second, c.first);
+						if (autoMemoryLimit && trial.memory > autoMemoryLimit)
+						{
+							if (trial.memory < leastMemory)
+							{
+								leastMemory = trial.memory;
+								leastScheme = c.first;
+								leastWorkers = c.second;
+							}
+						}
+						else if (stopped || done + autoTuneIterations > iteration)
+						{
+							complete = false;
+						}
+						else
+						{
+							const int ret = run(autoTuneIterations, c.first, c.second);
+							if (ret < 0)
+							{
+								trainingStats = std::move(total);
+								return ret;
+							}
+							if (trainingStats.iterations == autoTuneIterations) trial.secPerIter = trainingStats.elapsed / autoTuneIterations;
+							else complete = false;
+						}
+					}
+					catch (const exc::InvalidArgument&)
+					{
+						// the scheme is not available with the current settings of the model
+						lastError = std::current_exception();
+					}
+					total.tuning.emplace_back(trial);
+					if (trial.secPerIter >= 0 && trial.secPerIter < bestTime)
+					{
+						bestTime = trial.secPerIter;
+						bestScheme = c.first;
+						bestWorkers = c.second;
+					}
+				}
+
+				if (bestScheme == ParallelScheme::default_)
+				{
+					if (!complete)
+					{
+						// too few iterations to try the candidates
+						bestWorkers = numWorkers;
+					}
+					else if (leastScheme != ParallelScheme::default_)
+					{
+						// all the available candidates exceed the limit
+						bestScheme = leastScheme;
+						bestWorkers = leastWorkers;
+					}
+					else std::rethrow_exception(lastError);
+				}
+				if (complete)
+				{
+					tunedScheme = bestScheme;
+					tunedWorkers = bestWorkers;
+					tunedForWorkers = numWorkers;
+					tunedForDocs = docs.size();
+				}
+				total.scheme = bestScheme;
+				total.workers = bestWorkers;
+			}
+			else
+			{
+				total.scheme = tunedScheme;
+				total.workers = tunedWorkers;
+			}
+
+			if (!stopped && done < iteration)
+			{
+				const int ret = run(iteration - done, total.scheme, total.workers);
+				if (ret < 0)
+				{
+					trainingStats = total;
+					return ret;
+				}
+			}
+			trainingStats = std::move(total);
+			return 0;
+		}
+
 	public:
 		TopicModel(size_t _rg) : rg(_rg)
 		{
@@ -613,8 +1545,11 @@ namespace tomoto
 
 			maxThreads[(size_t)ParallelScheme::default_] = -1;
 			maxThreads[(size_t)ParallelScheme::none] = -1;
+			maxThreads[(size_t)ParallelScheme::auto_] = -1;
 			maxThreads[(size_t)ParallelScheme::copy_merge] = static_cast<_Derived*>(this)->template estimateMaxThreads<ParallelScheme::copy_merge>();
 			maxThreads[(size_t)ParallelScheme::partition] = static_cast<_Derived*>(this)->template estimateMaxThreads<ParallelScheme::partition>();
+			maxThreads[(size_t)ParallelScheme::async] = static_cast<_Derived*>(this)->template estimateMaxThreads<ParallelScheme::async>();
+			maxThreads[(size_t)ParallelScheme::hierarchical] = static_cast<_Derived*>(this)->template estimateMaxThreads<ParallelScheme::hierarchical>();
 		}
 
 		static ParallelScheme getRealScheme(ParallelScheme ps)
@@ -622,6 +1557,7 @@ namespace tomoto
 			switch (ps)
 			{
 			case ParallelScheme::default_:
+			case ParallelScheme::auto_:
 				if ((_Flags & flags::partitioned_multisampling)) return ParallelScheme::partition;
 				if ((_Flags & flags::shared_state)) return ParallelScheme::none;
 				return ParallelScheme::copy_merge;
@@ -633,22 +1569,68 @@ namespace tomoto
 				if (!(_Flags & flags::partitioned_multisampling)) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
 					std::string{ "This model doesn't provide ParallelScheme::" } + toString(ps));
 				break;
+			case ParallelScheme::async:
+				if (!(_Flags & flags::asynchronous_multisampling)) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+					std::string{ "This model doesn't provide ParallelScheme::" } + toString(ps));
+				break;
+			case ParallelScheme::hierarchical:
+				if (!(_Flags & flags::hierarchical_multisampling)) THROW_ERROR_WITH_INFO(exc::InvalidArgument,
+					std::string{ "This model doesn't provide ParallelScheme::" } + toString(ps));
+				break;
 			}
 			return ps;
 		}
 
-		int train(size_t iteration, size_t numWorkers, ParallelScheme ps, bool freeze_topics = false) override
+		int train(size_t iteration, size_t numWorkers, ParallelScheme ps, bool freeze_topics = false,
+			const TrainingCallback& callback = {}, size_t callbackInterval = 1) override
 		{
+			if (!callbackInterval) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "`callbackInterval` must be positive");
+			if (ps == ParallelScheme::auto_) return trainAuto(iteration, numWorkers, freeze_topics, callback, callbackInterval);
+			if (mappedFile)
+			{
+				// training modifies the state, so it should not be kept in the memory shared with the mapped file
+				_ModelState owned = globalState;
+				globalState = owned;
+				mappedFile.reset();
+			}
+			static_cast<_Derived*>(this)->detachShared();
+			const auto startTime = std::chrono::steady_clock::now();
 			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
 			ps = getRealScheme(ps);
 			numWorkers = std::min(numWorkers, maxThreads[(size_t)ps]);
 			if (numWorkers == 1 || (_Flags & flags::shared_state)) ps = ParallelScheme::none;
-			if (!cachedPool || cachedPool->getNumWorkers() != numWorkers)
+			ps = static_cast<_Derived*>(this)->getTrainingScheme(ps);
+			if (!cachedPool || cachedPool->getNumWorkers() != numWorkers || cachedPool->isNumaRequested() != numaAware)
 			{
-				cachedPool = std::make_unique<ThreadPool>(numWorkers);
+				cachedPool = std::make_unique<ThreadPool>(numWorkers, 0, numaAware);
 			}
-
+			trainingStats = {};
+			trainingStats.scheme = ps;
+			trainingStats.workers = numWorkers;
+			trace.reset();
+			if (tracing)
+			{
+				trace = std::make_unique<TraceRecorder>(numWorkers);
+				trace->setPhase("setup");
+			}
+			cachedPool->setTracer(trace.get());
 			std::vector<_ModelState> localData;
+			std::vector<double> busyAtStart(numWorkers);
+			for (size_t i = 0; i < numWorkers; ++i) busyAtStart[i] = cachedPool->getWorkerBusyTime(i);
+			auto finishStats = [&]()
+			{
+				trainingStats.elapsed = std::chrono::duration<double>{ std::chrono::steady_clock::now() - startTime }.count();
+				trainingStats.workerBusy.resize(numWorkers);
+				trainingStats.workerIdle.resize(numWorkers);
+				for (size_t i = 0; i < numWorkers; ++i)
+				{
+					trainingStats.workerBusy[i] = cachedPool->getWorkerBusyTime(i) - busyAtStart[i];
+					trainingStats.workerIdle[i] = std::max(trainingStats.elapsed - trainingStats.workerBusy[i], 0.);
+				}
+				cachedPool->setTracer(nullptr);
+				localDataMemory.clear();
+				for (auto& ld : localData) localDataMemory.emplace_back(ld.getMemoryUsage());
+			};
 
 			while(localRG.size() < numWorkers)
 			{
@@ -657,9 +1639,21 @@ namespace tomoto
 
 			if (ps == ParallelScheme::copy_merge)
 			{
-				for (size_t i = 0; i < numWorkers; ++i)
+				if (cachedPool->isNumaAware())
 				{
-					localData.emplace_back(static_cast<_Derived*>(this)->globalState);
+					// each worker copies its own state so that the memory is allocated on the worker's node
+					localData.resize(numWorkers);
+					for (auto& r : cachedPool->enqueueToAll([&](size_t threadId)
+					{
+						localData[threadId] = static_cast<_Derived*>(this)->globalState;
+					})) r.get();
+				}
+				else
+				{
+					for (size_t i = 0; i < numWorkers; ++i)
+					{
+						localData.emplace_back(static_cast<_Derived*>(this)->globalState);
+					}
 				}
 			}
 			else if (ps == ParallelScheme::partition)
@@ -670,6 +1664,20 @@ namespace tomoto
 					static_cast<_Derived*>(this)->eddTrain
 				);
 			}
+			else if (ps == ParallelScheme::async)
+			{
+				localData.resize(numWorkers);
+				static_cast<_Derived*>(this)->prepareAsync(*cachedPool, globalState, localData.data());
+			}
+			else if (ps == ParallelScheme::hierarchical)
+			{
+				// the states of the groups follow those of the workers in `localData`
+				static_cast<_Derived*>(this)->prepareHierarchical(*cachedPool, globalState, localData, 
+					static_cast<_Derived*>(this)->eddTrain
+				);
+			}
+
+			if (trace) trace->record(0, "setup", "phase", -1, 0, trace->now());
 
 			auto state = ps == ParallelScheme::none ? &globalState : localData.data();
 			for (size_t i = 0; i < iteration; ++i)
@@ -692,6 +1700,14 @@ namespace tomoto
 							static_cast<_Derived*>(this)->template trainOne<ParallelScheme::partition>(
 								*cachedPool, state, localRG.data(), freeze_topics);
 							break;
+						case ParallelScheme::async:
+							static_cast<_Derived*>(this)->template trainOne<ParallelScheme::async>(
+								*cachedPool, state, localRG.data(), freeze_topics);
+							break;
+						case ParallelScheme::hierarchical:
+							static_cast<_Derived*>(this)->template trainOne<ParallelScheme::hierarchical>(
+								*cachedPool, state, localRG.data(), freeze_topics);
+							break;
 						}
 						break;
 					}
@@ -700,14 +1716,88 @@ namespace tomoto
 						std::cerr << e.what() << std::endl;
 						int ret = static_cast<_Derived*>(this)->restoreFromTrainingError(
 							e, *cachedPool, state, localRG.data());
-						if(ret < 0) return ret;
+						if (ret < 0)
+						{
+							finishStats();
+							return ret;
+						}
 					}
 				}
 				++globalStep;
+				++trainingStats.iterations;
+				trainingStats.tokens += realN;
+
+				if (callback && ((i + 1) % callbackInterval == 0 || i + 1 == iteration))
+				{
+					// checkpoints are also taken in the callback, so its time is traced as a phase
+					const int64_t callbackBegin = trace ? trace->now() : 0;
+					TrainingProgress progress;
+					progress.model = this;
+					progress.iteration = i + 1;
+					progress.totalIteration = iteration;
+					progress.globalStep = globalStep;
+					progress.elapsed = std::chrono::duration<double>{ std::chrono::steady_clock::now() - startTime }.count();
+					progress.tokensPerSec = progress.elapsed > 0 ? realN * (double)(i + 1) / progress.elapsed : 0;
+					const bool goOn = callback(progress);
+					if (trace) trace->record(0, "callback", "phase", -1, callbackBegin, trace->now());
+					if (!goOn) break;
+				}
 			}
+			finishStats();
 			return 0;
 		}
 
+		const TrainingStats& getTrainingStats() const override
+		{
+			return trainingStats;
+		}
+
+		MemoryUsage getMemoryUsage() const override
+		{
+			MemoryUsage ret;
+			ret.emplace_back("dictionary", dict.getMemoryUsage());
+			ret.emplace_back("vocabCf", heapBytes(vocabCf));
+			ret.emplace_back("vocabDf", heapBytes(vocabDf));
+
+			uint64_t docBytes = docs.capacity() * sizeof(DocType), wordBytes = heapBytes(words);
+			for (auto& doc : docs)
+			{
+				docBytes += heapBytes(doc.wOrder) + heapBytes(doc.origWordPos) + heapBytes(doc.origWordLen);
+				wordBytes += heapBytes(doc.words);
+			}
+			if (wordSpans) docBytes += heapBytes(wordSpans->pos) + heapBytes(wordSpans->len);
+			ret.emplace_back("docs", docBytes);
+			ret.emplace_back("docs.words", wordBytes);
+
+			ret.emplace_back("globalState", globalState.getMemoryUsage());
+			ret.emplace_back("tState", tState.getMemoryUsage());
+			for (size_t i = 0; i < localDataMemory.size(); ++i)
+			{
+				ret.emplace_back("localData[" + std::to_string(i) + "]", localDataMemory[i]);
+			}
+			static_cast<const _Derived*>(this)->addMemoryUsage(ret);
+			return ret;
+		}
+
+		uint64_t estimateTrainingMemory(size_t numWorkers, ParallelScheme ps) const override
+		{
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			ps = getRealScheme(ps);
+			// the limits are known only after `prepare`
+			if (maxThreads[(size_t)ps]) numWorkers = std::min(numWorkers, maxThreads[(size_t)ps]);
+			if (numWorkers == 1 || (_Flags & flags::shared_state)) ps = ParallelScheme::none;
+			ps = static_cast<const _Derived*>(this)->getTrainingScheme(ps);
+
+			uint64_t ret = 0;
+			for (auto& p : getMemoryUsage())
+			{
+				// the states of the previous `train` are already freed
+				if (p.first.compare(0, 10, "localData[") == 0) continue;
+				ret += p.second;
+			}
+			return ret + static_cast<const _Derived*>(this)->estimateTrainingOverhead(numWorkers, ps);
+		}
+
 		double getLLPerWord() const override
 		{
 			return words.empty() ? 0 : static_cast<const _Derived*>(this)->getLL() / weightedN;
@@ -773,11 +1863,41 @@ namespace tomoto
 			return static_cast<const _Derived*>(this)->getLLRest(this->globalState);
 		}
 
-		std::vector<double> infer(const std::vector<DocumentBase*>& docs, size_t maxIter, Float tolerance, size_t numWorkers, ParallelScheme ps, bool together) const override
+		using InferenceContextType = InferenceContext<_RandGen, _ModelState>;
+
+		std::vector<double> infer(const std::vector<DocumentBase*>& docs, size_t maxIter, Float tolerance, size_t numWorkers, ParallelScheme ps, bool together,
+			const InferenceDeadline& deadline = {}, std::vector<uint32_t>* iterations = nullptr) const override
+		{
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			ps = getRealScheme(ps);
+			// inference doesn't update the shared counts, so it runs the asynchronous and hierarchical schemes as copy_merge
+			if (ps == ParallelScheme::async || ps == ParallelScheme::hierarchical) ps = ParallelScheme::copy_merge;
+			if (numWorkers == 1) ps = ParallelScheme::none;
+			return inferWithContext(docs, maxIter, tolerance, numWorkers, ps, together, nullptr, deadline, iterations);
+		}
+
+		std::unique_ptr<IInferenceSession> makeInferenceSession(size_t numWorkers, ParallelScheme ps) const override
 		{
 			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
 			ps = getRealScheme(ps);
+			// inference doesn't update the shared counts, so it runs the asynchronous and hierarchical schemes as copy_merge
+			if (ps == ParallelScheme::async || ps == ParallelScheme::hierarchical) ps = ParallelScheme::copy_merge;
 			if (numWorkers == 1) ps = ParallelScheme::none;
+
+			InferenceContextType ctx;
+			ctx.pool = std::make_unique<ThreadPool>(numWorkers);
+			ctx.states.resize(numWorkers);
+			_RandGen rgc{};
+			for (size_t i = 0; i < numWorkers; ++i) ctx.rgs.emplace_back(rgc());
+			return std::make_unique<InferenceSession<TopicModel, InferenceContextType>>(this, numWorkers, ps, std::move(ctx));
+		}
+
+		// `numWorkers` and `ps` should be already resolved. `ctx` may be null.
+		std::vector<double> inferWithContext(const std::vector<DocumentBase*>& docs, size_t maxIter, Float tolerance, size_t numWorkers, ParallelScheme ps, bool together,
+			InferenceContextType* ctx, const InferenceDeadline& deadline = {}, std::vector<uint32_t>* iterations = nullptr) const
+		{
+			if (iterations) iterations->assign(docs.size(), 0);
+			uint32_t* iters = iterations ? iterations->data() : nullptr;
 			auto tx = [](DocumentBase* p)->DocType& { return *static_cast<DocType*>(p); };
 			auto b = makeTransformIter(docs.begin(), tx), e = makeTransformIter(docs.end(), tx);
 
@@ -786,11 +1906,11 @@ namespace tomoto
 				switch (ps)
 				{
 				case ParallelScheme::none:
-					return static_cast<const _Derived*>(this)->template _infer<true, ParallelScheme::none>(b, e, maxIter, tolerance, numWorkers);
+					return static_cast<const _Derived*>(this)->template _infer<true, ParallelScheme::none>(b, e, maxIter, tolerance, numWorkers, ctx, deadline, iters);
 				case ParallelScheme::copy_merge:
-					return static_cast<const _Derived*>(this)->template _infer<true, ParallelScheme::copy_merge>(b, e, maxIter, tolerance, numWorkers);
+					return static_cast<const _Derived*>(this)->template _infer<true, ParallelScheme::copy_merge>(b, e, maxIter, tolerance, numWorkers, ctx, deadline, iters);
 				case ParallelScheme::partition:
-					return static_cast<const _Derived*>(this)->template _infer<true, ParallelScheme::partition>(b, e, maxIter, tolerance, numWorkers);
+					return static_cast<const _Derived*>(this)->template _infer<true, ParallelScheme::partition>(b, e, maxIter, tolerance, numWorkers, ctx, deadline, iters);
 				}
 			}
 			else
@@ -798,11 +1918,11 @@ namespace tomoto
 				switch (ps)
 				{
 				case ParallelScheme::none:
-					return static_cast<const _Derived*>(this)->template _infer<false, ParallelScheme::none>(b, e, maxIter, tolerance, numWorkers);
+					return static_cast<const _Derived*>(this)->template _infer<false, ParallelScheme::none>(b, e, maxIter, tolerance, numWorkers, ctx, deadline, iters);
 				case ParallelScheme::copy_merge:
-					return static_cast<const _Derived*>(this)->template _infer<false, ParallelScheme::copy_merge>(b, e, maxIter, tolerance, numWorkers);
+					return static_cast<const _Derived*>(this)->template _infer<false, ParallelScheme::copy_merge>(b, e, maxIter, tolerance, numWorkers, ctx, deadline, iters);
 				case ParallelScheme::partition:
-					return static_cast<const _Derived*>(this)->template _infer<false, ParallelScheme::partition>(b, e, maxIter, tolerance, numWorkers);
+					return static_cast<const _Derived*>(this)->template _infer<false, ParallelScheme::partition>(b, e, maxIter, tolerance, numWorkers, ctx, deadline, iters);
 				}
 			}
 			THROW_ERROR_WITH_INFO(exc::InvalidArgument, "invalid ParallelScheme");
@@ -818,6 +1938,115 @@ namespace tomoto
 			return extractTopN<Tid>(getTopicsByDoc(doc, true), topN);
 		}
 
+		// calls `fn(b, e)` for `numWorkers` contiguous ranges of [first, last)
+		template<typename _Fn>
+		static void forRowRanges(size_t first, size_t last, size_t numWorkers, _Fn&& fn)
+		{
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			numWorkers = std::max(std::min(numWorkers, last - first), (size_t)1);
+			if (numWorkers == 1)
+			{
+				fn(first, last);
+				return;
+			}
+			forRowRanges(*PoolManager::getInstance().borrow(numWorkers), first, last, fn);
+		}
+
+		// same as above, but with the workers of `pool`
+		template<typename _Fn>
+		static void forRowRanges(ThreadPool& pool, size_t first, size_t last, _Fn&& fn)
+		{
+			const size_t numWorkers = std::max(std::min(pool.getNumWorkers(), last - first), (size_t)1);
+			if (numWorkers == 1)
+			{
+				fn(first, last);
+				return;
+			}
+			std::vector<std::future<void>> futures;
+			for (size_t w = 0; w < numWorkers; ++w)
+			{
+				futures.emplace_back(pool.enqueue([&, w](size_t)
+				{
+					fn(first + (last - first) * w / numWorkers, first + (last - first) * (w + 1) / numWorkers);
+				}));
+			}
+			for (auto& f : futures) f.get();
+		}
+
+		// the number of topics which `_getWidsByTopic` accepts
+		size_t getNumWidsTopics() const
+		{
+			return static_cast<const _Derived*>(this)->getK();
+		}
+
+		void getWidsByTopics(const MatrixAllocator& alloc, bool normalize, size_t numWorkers) const override
+		{
+			const size_t K = static_cast<const _Derived*>(this)->getNumWidsTopics();
+			if (!K)
+			{
+				alloc(0, realV);
+				return;
+			}
+			// the first topic is computed alone, since it may build caches shared by all topics
+			auto first = static_cast<const _Derived*>(this)->_getWidsByTopic(0, normalize);
+			const size_t cols = first.size();
+			Float* out = alloc(K, cols);
+			std::copy(first.begin(), first.end(), out);
+			forRowRanges(1, K, numWorkers, [&](size_t b, size_t e)
+			{
+				for (size_t k = b; k < e; ++k)
+				{
+					auto d = static_cast<const _Derived*>(this)->_getWidsByTopic(k, normalize);
+					std::copy(d.begin(), d.end(), out + k * cols);
+				}
+			});
+		}
+
+		size_t getWidsByTopicsSorted(size_t topN, size_t numWorkers, std::vector<Vid>& vids, std::vector<Float>& weights) const override
+		{
+			const size_t K = static_cast<const _Derived*>(this)->getNumWidsTopics();
+			topN = std::min(topN, (size_t)realV);
+			vids.resize(K * topN);
+			weights.resize(K * topN);
+			auto fill = [&](size_t k)
+			{
+				auto top = extractTopN<Vid>(static_cast<const _Derived*>(this)->_getWidsByTopic(k, true), topN);
+				for (size_t i = 0; i < top.size(); ++i)
+				{
+					vids[k * topN + i] = top[i].first;
+					weights[k * topN + i] = top[i].second;
+				}
+			};
+			if (!K) return topN;
+			// the first topic is computed alone, since it may build caches shared by all topics
+			fill(0);
+			forRowRanges(1, K, numWorkers, [&](size_t b, size_t e)
+			{
+				for (size_t k = b; k < e; ++k) fill(k);
+			});
+			return topN;
+		}
+
+		void getTopicsByDocs(const MatrixAllocator& alloc, bool normalize, size_t numWorkers) const override
+		{
+			size_t cols = 0;
+			for (auto& doc : docs)
+			{
+				cols = static_cast<const _Derived*>(this)->_getTopicsByDoc(doc, normalize).size();
+				if (cols) break;
+			}
+			Float* out = alloc(docs.size(), cols);
+			forRowRanges(0, docs.size(), numWorkers, [&](size_t b, size_t e)
+			{
+				for (size_t i = b; i < e; ++i)
+				{
+					auto d = static_cast<const _Derived*>(this)->_getTopicsByDoc(docs[i], normalize);
+					if (d.size() == cols) std::copy(d.begin(), d.end(), out + i * cols);
+					else std::fill(out + i * cols, out + (i + 1) * cols, std::numeric_limits<Float>::quiet_NaN());
+				}
+			});
+		}
+
 		const DocumentBase* getDoc(size_t docId) const override
 		{
 			return &_getDoc(docId);
@@ -835,6 +2064,52 @@ namespace tomoto
 			return globalStep;
 		}
 
+		uint64_t getAutoMemoryLimit() const override
+		{
+			return autoMemoryLimit;
+		}
+
+		void setAutoMemoryLimit(uint64_t limit) override
+		{
+			autoMemoryLimit = limit;
+		}
+
+		bool getNumaAware() const override
+		{
+			return numaAware;
+		}
+
+		void setNumaAware(bool enabled) override
+		{
+			numaAware = enabled;
+		}
+
+		bool getTracing() const override
+		{
+			return tracing;
+		}
+
+		void setTracing(bool enabled) override
+		{
+			tracing = enabled;
+		}
+
+		void writeTrace(std::ostream& ostr) const override
+		{
+			if (!trace) THROW_ERROR_WITH_INFO(exc::InvalidArgument, "the last `train` was not traced");
+			trace->writeChromeTrace(ostr);
+		}
+
+		size_t getPrepareWorkers() const override
+		{
+			return prepareWorkers;
+		}
+
+		void setPrepareWorkers(size_t numWorkers) override
+		{
+			prepareWorkers = numWorkers;
+		}
+
 		const Dictionary& getVocabDict() const override
 		{
 			return dict;
@@ -853,7 +2128,7 @@ namespace tomoto
 				for (size_t i = 0; i < doc.words.size(); ++i)
 				{
 					if (doc.words[i] >= realV) continue;
-					ret[doc.words[i]] += doc.wordWeights.empty() ? 1 : doc.wordWeights[i];
+					ret[doc.words[i]] += static_cast<const _Derived*>(this)->getWordWeight(doc, i);
 				}
 			}
 			return ret;
@@ -874,6 +2149,13 @@ namespace tomoto
 			static_cast<_Derived*>(this)->_loadModel(reader, extra_data);
 			static_cast<_Derived*>(this)->prepare(false);
 		}
+
+		void loadModel(const std::shared_ptr<MMap>& mapped, std::vector<uint8_t>* extra_data) override
+		{
+			mappedFile = mapped;
+			serializer::imstream reader{ mapped->get(), (std::ptrdiff_t)mapped->size(), true };
+			loadModel(reader, extra_data);
+		}
 	};
 
 }
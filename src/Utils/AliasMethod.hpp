@@ -142,6 +142,11 @@ namespace tomoto
 				}
 			}
 
+			size_t getMemoryUsage() const
+			{
+				return arr ? ((size_t)1 << bitsize) * (sizeof(_Precision) + sizeof(size_t)) : 0;
+			}
+
 			template<typename _Rng>
 			size_t operator()(_Rng& rng) const
 			{
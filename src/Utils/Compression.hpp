@@ -0,0 +1,463 @@
+#pragma once
+#include <cstring>
+#include <deque>
+#include "serializer.hpp"
+#include "ThreadPool.hpp"
+
+/*
+
+A compressed container of model files, written by `serializer::ozstream` in tomotopy 0.12.3
+
+struct CompressedFile
+{
+	char[4] magic_id; // "TMZC"
+	uint32_t version, block_size;
+	Block blocks[...]; // terminated by a block whose raw_size is 0
+	uint64_t patch_cnt;
+	Patch patches[patch_cnt];
+}
+
+struct Block
+{
+	uint32_t raw_size, packed_size;
+	uint8_t codec;
+	char[packed_size - 1] data;
+}
+
+struct Patch
+{
+	uint64_t offset;
+	uint32_t size;
+	char[size] data; // overwrites the decompressed data at `offset`
+}
+
+*/
+
+namespace tomoto
+{
+	namespace serializer
+	{
+		static constexpr char compressedMagic[4] = { 'T', 'M', 'Z', 'C' };
+
+		namespace lz
+		{
+			static constexpr size_t hashBits = 16, minMatch = 4, maxOffset = 0xFFFF;
+
+			inline void writeLength(std::vector<uint8_t>& out, size_t len)
+			{
+				for (; len >= 255; len -= 255) out.emplace_back(255);
+				out.emplace_back((uint8_t)len);
+			}
+
+			inline void writeSequence(std::vector<uint8_t>& out, const uint8_t* lit, size_t litLen, size_t offset, size_t matchLen)
+			{
+				out.emplace_back((uint8_t)((std::min(litLen, (size_t)15) << 4) | (matchLen ? std::min(matchLen - minMatch, (size_t)15) : 0)));
+				if (litLen >= 15) writeLength(out, litLen - 15);
+				out.insert(out.end(), lit, lit + litLen);
+				if (!matchLen) return;
+				out.emplace_back((uint8_t)offset);
+				out.emplace_back((uint8_t)(offset >> 8));
+				if (matchLen - minMatch >= 15) writeLength(out, matchLen - minMatch - 15);
+			}
+
+			/*
+			appends `src` compressed by LZ77 into `out`, as sequences of (token, literals, offset, match length) like the block format of LZ4.
+			The last sequence has only literals.
+			*/
+			inline void compress(const uint8_t* src, size_t n, std::vector<uint8_t>& out)
+			{
+				std::vector<uint32_t> table(1 << hashBits); // the last position + 1 of each hash of 4 bytes
+				size_t anchor = 0, i = 0;
+				while (i + minMatch <= n)
+				{
+					uint32_t seq;
+					std::memcpy(&seq, src + i, minMatch);
+					const size_t h = (seq * 2654435761u) >> (32 - hashBits);
+					const size_t cand = table[h];
+					table[h] = (uint32_t)(i + 1);
+					if (cand && i + 1 - cand <= maxOffset && !std::memcmp(src + cand - 1, src + i, minMatch))
+					{
+						const size_t m = cand - 1;
+						size_t len = minMatch;
+						while (i + len < n && src[m + len] == src[i + len]) ++len;
+						writeSequence(out, src + anchor, i - anchor, i - m, len);
+						i += len;
+						anchor = i;
+					}
+					else
+					{
+						// it skips faster over incompressible data
+						i += 1 + ((i - anchor) >> 6);
+					}
+				}
+				writeSequence(out, src + anchor, n - anchor, 0, 0);
+			}
+
+			inline void decompress(const uint8_t* src, size_t n, uint8_t* dst, size_t rawSize)
+			{
+				size_t ip = 0, op = 0;
+				auto readLength = [&](size_t len)
+				{
+					if (len < 15) return len;
+					uint8_t b;
+					do
+					{
+						if (ip >= n) throw std::ios_base::failure("broken compressed block");
+						b = src[ip++];
+						len += b;
+					} while (b == 255);
+					return len;
+				};
+
+				while (ip < n)
+				{
+					const uint8_t token = src[ip++];
+					const size_t litLen = readLength(token >> 4);
+					if (litLen > n - ip || litLen > rawSize - op) throw std::ios_base::failure("broken compressed block");
+					std::memcpy(dst + op, src + ip, litLen);
+					ip += litLen;
+					op += litLen;
+					if (ip == n) break;
+
+					if (n - ip < 2) throw std::ios_base::failure("broken compressed block");
+					const size_t offset = src[ip] | ((size_t)src[ip + 1] << 8);
+					ip += 2;
+					const size_t matchLen = readLength(token & 15) + minMatch;
+					if (!offset || offset > op || matchLen > rawSize - op) throw std::ios_base::failure("broken compressed block");
+					if (offset >= matchLen) std::memcpy(dst + op, dst + op - offset, matchLen);
+					else for (size_t j = 0; j < matchLen; ++j) dst[op + j] = dst[op + j - offset];
+					op += matchLen;
+				}
+				if (op != rawSize) throw std::ios_base::failure("broken compressed block");
+			}
+		}
+
+		enum class BlockCodec : uint8_t
+		{
+			stored,
+			lz,
+			shuffledLz, // bytes of 4-byte lanes are grouped by their position before lz, which suits arrays of integers and floats
+		};
+
+		// groups the `k`-th bytes of all 4-byte lanes of `src` together, leaving the remainder as is
+		inline void shuffleLanes(const uint8_t* src, size_t n, uint8_t* dst)
+		{
+			const size_t m = n / 4;
+			for (size_t b = 0; b < 4; ++b)
+			{
+				for (size_t j = 0; j < m; ++j) dst[b * m + j] = src[j * 4 + b];
+			}
+			std::memcpy(dst + m * 4, src + m * 4, n - m * 4);
+		}
+
+		inline void unshuffleLanes(const uint8_t* src, size_t n, uint8_t* dst)
+		{
+			const size_t m = n / 4;
+			for (size_t b = 0; b < 4; ++b)
+			{
+				for (size_t j = 0; j < m; ++j) dst[j * 4 + b] = src[b * m + j];
+			}
+			std::memcpy(dst + m * 4, src + m * 4, n - m * 4);
+		}
+
+		// returns the codec byte followed by the data of the block, using whichever codec gives the smallest one
+		inline std::vector<uint8_t> encodeBlock(const uint8_t* src, size_t n)
+		{
+			std::vector<uint8_t> ret, shuffled(n), alt;
+			ret.reserve(n + n / 255 + 16);
+			ret.emplace_back((uint8_t)BlockCodec::lz);
+			lz::compress(src, n, ret);
+
+			shuffleLanes(src, n, shuffled.data());
+			alt.reserve(ret.size());
+			alt.emplace_back((uint8_t)BlockCodec::shuffledLz);
+			lz::compress(shuffled.data(), n, alt);
+			if (alt.size() < ret.size()) ret.swap(alt);
+
+			if (ret.size() > n)
+			{
+				ret.assign(1, (uint8_t)BlockCodec::stored);
+				ret.insert(ret.end(), src, src + n);
+			}
+			return ret;
+		}
+
+		inline void decodeBlock(const uint8_t* src, size_t n, uint8_t* dst, size_t rawSize)
+		{
+			if (!n) throw std::ios_base::failure("broken compressed block");
+			switch ((BlockCodec)src[0])
+			{
+			case BlockCodec::stored:
+				if (n - 1 != rawSize) throw std::ios_base::failure("broken compressed block");
+				std::memcpy(dst, src + 1, rawSize);
+				break;
+			case BlockCodec::lz:
+				lz::decompress(src + 1, n - 1, dst, rawSize);
+				break;
+			case BlockCodec::shuffledLz:
+			{
+				std::vector<uint8_t> shuffled(rawSize);
+				lz::decompress(src + 1, n - 1, shuffled.data(), rawSize);
+				unshuffleLanes(shuffled.data(), rawSize, dst);
+				break;
+			}
+			default:
+				throw std::ios_base::failure("unknown codec of compressed block");
+			}
+		}
+
+		/*
+		A streambuf which compresses what is written into blocks of `blockSize` bytes with `numWorkers` threads,
+		and writes them into `sink` in order, keeping at most two blocks per worker in memory.
+		Seeking back to what was already compressed, like writing the size of tagged data, is recorded as a patch applied when reading.
+		*/
+		class ozbuf : public std::streambuf
+		{
+			std::ostream& sink;
+			size_t blockSize, maxPending;
+			std::unique_ptr<ThreadPool> pool;
+			std::vector<char> block;
+			uint64_t flushed = 0, pos = 0;
+			std::deque<std::pair<uint32_t, std::future<std::vector<uint8_t>>>> pending; // raw size and packed data of each block
+			std::vector<std::pair<uint64_t, std::string>> patches;
+			bool closed = false;
+
+			void writeBlock(const std::vector<uint8_t>& packed, uint32_t rawSize)
+			{
+				writeMany(sink, rawSize, (uint32_t)packed.size());
+				if (!sink.write((const char*)packed.data(), packed.size()))
+					throw std::ios_base::failure("writing compressed block is failed");
+			}
+
+			void writeFront()
+			{
+				auto packed = pending.front().second.get();
+				const uint32_t rawSize = pending.front().first;
+				pending.pop_front();
+				writeBlock(packed, rawSize);
+			}
+
+			void submit()
+			{
+				if (block.empty()) return;
+				flushed += block.size();
+				if (!pool)
+				{
+					writeBlock(encodeBlock((const uint8_t*)block.data(), block.size()), (uint32_t)block.size());
+					block.clear();
+					return;
+				}
+
+				auto raw = std::make_shared<std::vector<char>>(std::move(block));
+				block = {};
+				pending.emplace_back((uint32_t)raw->size(), pool->enqueue([raw](size_t)
+				{
+					return encodeBlock((const uint8_t*)raw->data(), raw->size());
+				}));
+				while (pending.size() > maxPending) writeFront();
+			}
+
+		protected:
+			std::streamsize xsputn(const char* s, std::streamsize n) override
+			{
+				if (closed) return 0;
+				std::streamsize done = 0;
+				while (done < n)
+				{
+					size_t k = n - done;
+					if (pos < flushed)
+					{
+						k = (size_t)std::min<uint64_t>(k, flushed - pos);
+						patches.emplace_back(pos, std::string{ s + done, k });
+					}
+					else
+					{
+						const size_t off = pos - flushed;
+						if (off == blockSize)
+						{
+							submit();
+							continue;
+						}
+						k = std::min(k, blockSize - off);
+						if (off + k > block.size()) block.resize(off + k);
+						std::memcpy(block.data() + off, s + done, k);
+					}
+					done += k;
+					pos += k;
+				}
+				if (pos == flushed + blockSize) submit();
+				return n;
+			}
+
+			int_type overflow(int_type c) override
+			{
+				if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+				const char ch = traits_type::to_char_type(c);
+				return xsputn(&ch, 1) == 1 ? c : traits_type::eof();
+			}
+
+			pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+			{
+				if (!(which & std::ios_base::out)) return pos_type(off_type(-1));
+				const uint64_t end = flushed + block.size();
+				off_type target = off;
+				if (dir == std::ios_base::cur) target += (off_type)pos;
+				else if (dir == std::ios_base::end) target += (off_type)end;
+				if (target < 0 || (uint64_t)target > end) return pos_type(off_type(-1));
+				pos = (uint64_t)target;
+				return pos_type(target);
+			}
+
+			pos_type seekpos(pos_type sp, std::ios_base::openmode which) override
+			{
+				return seekoff(sp - pos_type(off_type(0)), std::ios_base::beg, which);
+			}
+
+		public:
+			static constexpr size_t defaultBlockSize = 4 << 20;
+
+			ozbuf(std::ostream& _sink, size_t numWorkers = 1, size_t _blockSize = defaultBlockSize)
+				: sink{ _sink }, blockSize{ _blockSize }
+			{
+				if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+				if (numWorkers > 1) pool = std::make_unique<ThreadPool>(numWorkers);
+				maxPending = numWorkers * 2;
+				if (!sink.write(compressedMagic, sizeof(compressedMagic)))
+					throw std::ios_base::failure("writing compressed header is failed");
+				writeMany(sink, (uint32_t)0, (uint32_t)blockSize);
+			}
+
+			// writes the rest and the patches. It should be called once after all the data are written.
+			void close()
+			{
+				if (closed) return;
+				submit();
+				while (!pending.empty()) writeFront();
+				writeMany(sink, (uint32_t)0, (uint32_t)0, (uint64_t)patches.size());
+				for (auto& p : patches)
+				{
+					writeMany(sink, p.first, (uint32_t)p.second.size());
+					if (!sink.write(p.second.data(), p.second.size()))
+						throw std::ios_base::failure("writing compressed patch is failed");
+				}
+				closed = true;
+			}
+		};
+
+		/*
+		An output stream which writes into `sink` in the compressed container.
+		Arrays of ids are written compactly as well, see `setCompactArrays`. `close` should be called after writing all.
+		*/
+		class ozstream : public std::ostream
+		{
+			ozbuf buf;
+		public:
+			ozstream(std::ostream& sink, size_t numWorkers = 1, size_t blockSize = ozbuf::defaultBlockSize)
+				: std::ostream(&buf), buf(sink, numWorkers, blockSize)
+			{
+				setCompactArrays(*this);
+			}
+
+			void close()
+			{
+				buf.close();
+			}
+		};
+
+		// returns true if `istr` starts with the compressed container at its current position, without consuming it
+		inline bool isCompressed(std::istream& istr)
+		{
+			const auto start = istr.tellg();
+			char magic[sizeof(compressedMagic)];
+			const bool ret = !!istr.read(magic, sizeof(magic)) && !std::memcmp(magic, compressedMagic, sizeof(magic));
+			istr.clear();
+			istr.seekg(start);
+			return ret;
+		}
+
+		// returns true if the memory starts with the compressed container
+		inline bool isCompressed(const char* data, size_t size)
+		{
+			return size >= sizeof(compressedMagic) && !std::memcmp(data, compressedMagic, sizeof(compressedMagic));
+		}
+
+		/*
+		decompresses the whole container from `istr` with `numWorkers` threads.
+		The headers of the blocks are read first, so that each block is decoded directly into its place in the result.
+		*/
+		inline std::vector<char> decompress(std::istream& istr, size_t numWorkers = 1)
+		{
+			char magic[sizeof(compressedMagic)];
+			if (!istr.read(magic, sizeof(magic)) || std::memcmp(magic, compressedMagic, sizeof(magic)))
+				throw std::ios_base::failure("not a compressed model file");
+			uint32_t version, blockSize;
+			readMany(istr, version, blockSize);
+			if (version != 0) throw std::ios_base::failure(text::format("unsupported version of compressed model file (version = %u)", version));
+
+			struct BlockInfo
+			{
+				uint64_t rawOffset;
+				uint32_t rawSize, packedSize;
+				std::streampos pos;
+			};
+			std::vector<BlockInfo> blocks;
+			uint64_t total = 0;
+			while (true)
+			{
+				BlockInfo b;
+				readMany(istr, b.rawSize, b.packedSize);
+				if (!b.rawSize) break;
+				b.rawOffset = total;
+				b.pos = istr.tellg();
+				total += b.rawSize;
+				blocks.emplace_back(b);
+				if (!istr.seekg(b.packedSize, std::ios_base::cur)) throw std::ios_base::failure("broken compressed model file");
+			}
+
+			uint64_t numPatches;
+			readMany(istr, numPatches);
+			std::vector<std::pair<uint64_t, std::string>> patches(numPatches);
+			for (auto& p : patches)
+			{
+				uint32_t size;
+				readMany(istr, p.first, size);
+				p.second.resize(size);
+				if (!istr.read(&p.second[0], size) || p.first + size > total) throw std::ios_base::failure("broken compressed model file");
+			}
+			const auto end = istr.tellg();
+
+			std::vector<char> ret(total);
+			if (!numWorkers) numWorkers = std::thread::hardware_concurrency();
+			std::unique_ptr<ThreadPool> pool;
+			if (numWorkers > 1 && blocks.size() > 1) pool = std::make_unique<ThreadPool>(numWorkers);
+			std::deque<std::future<void>> pending;
+			for (auto& b : blocks)
+			{
+				auto packed = std::make_shared<std::vector<uint8_t>>(b.packedSize);
+				istr.seekg(b.pos);
+				if (!istr.read((char*)packed->data(), b.packedSize)) throw std::ios_base::failure("broken compressed model file");
+				uint8_t* dst = (uint8_t*)ret.data() + b.rawOffset;
+				const size_t rawSize = b.rawSize;
+				if (!pool)
+				{
+					decodeBlock(packed->data(), packed->size(), dst, rawSize);
+					continue;
+				}
+				pending.emplace_back(pool->enqueue([packed, dst, rawSize](size_t)
+				{
+					decodeBlock(packed->data(), packed->size(), dst, rawSize);
+				}));
+				while (pending.size() > numWorkers * 2)
+				{
+					pending.front().get();
+					pending.pop_front();
+				}
+			}
+			for (auto& f : pending) f.get();
+
+			for (auto& p : patches) std::memcpy(ret.data() + p.first, p.second.data(), p.second.size());
+			istr.seekg(end);
+			return ret;
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace tomoto
+{
+	/*
+	Approximate counter of words in a fixed amount of memory.
+	Each word is counted in `depth` rows of `width` counters, and its count is estimated as the minimum of them,
+	so the estimate never underestimates the true count and overestimates it only by the collisions in every row.
+	Conservative update (increasing only the counters below the new estimate) keeps the overestimation small.
+	*/
+	class CountMinSketch
+	{
+		std::vector<uint32_t> counters;
+		size_t width, depth;
+
+		// double hashing gives `depth` independent enough positions from one 64-bit hash
+		template<typename _Fn>
+		void forEachCounter(const std::string& word, _Fn&& fn)
+		{
+			const uint64_t h = std::hash<std::string>{}(word);
+			const uint64_t h1 = h * 0x9E3779B97F4A7C15ull, h2 = ((h ^ (h >> 29)) * 0xBF58476D1CE4E5B9ull) | 1;
+			for (size_t d = 0; d < depth; ++d)
+			{
+				fn(counters[d * width + (size_t)((h1 + d * h2) >> 32) % width]);
+			}
+		}
+
+	public:
+		CountMinSketch(size_t _width = 1 << 20, size_t _depth = 4)
+			: counters(std::max(_width, (size_t)1) * std::max(_depth, (size_t)1)), width{ std::max(_width, (size_t)1) }, depth{ std::max(_depth, (size_t)1) }
+		{
+		}
+
+		// adds `cnt` to the count of `word` and returns its new estimate
+		size_t add(const std::string& word, size_t cnt = 1)
+		{
+			const size_t est = estimate(word) + cnt;
+			const uint32_t sat = (uint32_t)std::min(est, (size_t)UINT32_MAX);
+			forEachCounter(word, [&](uint32_t& c)
+			{
+				c = std::max(c, sat);
+			});
+			return est;
+		}
+
+		size_t estimate(const std::string& word) const
+		{
+			uint32_t ret = UINT32_MAX;
+			const_cast<CountMinSketch*>(this)->forEachCounter(word, [&](uint32_t& c)
+			{
+				ret = std::min(ret, c);
+			});
+			return ret;
+		}
+
+		size_t getMemoryUsage() const
+		{
+			return counters.capacity() * sizeof(uint32_t);
+		}
+	};
+}
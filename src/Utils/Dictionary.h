@@ -6,6 +6,7 @@
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <algorithm>
 #include "serializer.hpp"
 
 namespace tomoto
@@ -21,25 +22,87 @@ namespace tomoto
 		using std::pair<Vid, Vid>::pair;
 	};
 
+	/*
+	Bidirectional map between words and their ids.
+	Each word is stored only once in `id2word`, and the lookup from a word to its id is done by
+	an open addressing hash table of ids, whose slots also keep a part of the hash to skip most of string comparisons.
+	*/
 	class Dictionary
 	{
 	protected:
-		std::unordered_map<std::string, Vid> dict;
+		struct Slot
+		{
+			Vid id = non_vocab_id;
+			uint32_t tag = 0;
+		};
+
 		std::vector<std::string> id2word;
+		std::vector<Slot> slots; // empty or its size is a power of two
+
+		static size_t hashWord(const std::string& word)
+		{
+			return std::hash<std::string>{}(word);
+		}
+
+		// returns the slot of `word` or the empty slot where it should be inserted
+		size_t findSlot(const std::string& word, size_t h) const
+		{
+			const size_t mask = slots.size() - 1;
+			const uint32_t tag = (uint32_t)(h >> 32) ^ (uint32_t)h;
+			for (size_t i = h & mask; ; i = (i + 1) & mask)
+			{
+				auto& s = slots[i];
+				if (s.id == non_vocab_id || (s.tag == tag && id2word[s.id] == word)) return i;
+			}
+		}
+
+		void rebuildSlots(size_t capacity)
+		{
+			size_t cap = 16;
+			while (cap < capacity * 2) cap *= 2;
+			slots.assign(cap, Slot{});
+			for (size_t i = 0; i < id2word.size(); ++i)
+			{
+				const size_t h = hashWord(id2word[i]);
+				auto& s = slots[findSlot(id2word[i], h)];
+				s.id = (Vid)i;
+				s.tag = (uint32_t)(h >> 32) ^ (uint32_t)h;
+			}
+		}
+
 	public:
 		Vid add(const std::string& word)
 		{
-			auto it = dict.find(word);
-			if (it == dict.end())
+			if ((id2word.size() + 1) * 2 > slots.size()) rebuildSlots(std::max(id2word.size() * 2, (size_t)8));
+			const size_t h = hashWord(word);
+			auto& s = slots[findSlot(word, h)];
+			if (s.id == non_vocab_id)
 			{
-				dict.emplace(word, (Vid)dict.size());
+				s.id = (Vid)id2word.size();
+				s.tag = (uint32_t)(h >> 32) ^ (uint32_t)h;
 				id2word.emplace_back(word);
-				return (Vid)(dict.size() - 1);
 			}
-			return it->second;
+			return s.id;
+		}
+
+		void reserve(size_t n)
+		{
+			id2word.reserve(n);
+			if (n * 2 > slots.size()) rebuildSlots(n);
 		}
 
-		size_t size() const { return dict.size(); }
+		size_t size() const { return id2word.size(); }
+
+		// the bytes held by the dictionary, where the characters of short words kept inside `std::string` are not counted again
+		size_t getMemoryUsage() const
+		{
+			size_t ret = id2word.capacity() * sizeof(std::string) + slots.capacity() * sizeof(Slot);
+			for (auto& w : id2word)
+			{
+				if (w.capacity() > std::string{}.capacity()) ret += w.capacity() + 1;
+			}
+			return ret;
+		}
 		
 		const std::string& toWord(Vid vid) const
 		{
@@ -49,9 +112,8 @@ namespace tomoto
 		
 		Vid toWid(const std::string& word) const
 		{
-			auto it = dict.find(word);
-			if (it == dict.end()) return non_vocab_id;
-			return it->second;
+			if (slots.empty()) return non_vocab_id;
+			return slots[findSlot(word, hashWord(word))].id;
 		}
 
 		void serializerWrite(std::ostream& writer) const
@@ -62,24 +124,26 @@ namespace tomoto
 		void serializerRead(std::istream& reader)
 		{
 			serializer::readMany(reader, serializer::to_key("Dict"), id2word);
-			for (size_t i = 0; i < id2word.size(); ++i)
-			{
-				dict.emplace(id2word[i], (Vid)i);
-			}
+			rebuildSlots(id2word.size());
 		}
 
 		void swap(Dictionary& rhs)
 		{
-			std::swap(dict, rhs.dict);
+			std::swap(slots, rhs.slots);
 			std::swap(id2word, rhs.id2word);
 		}
 
 		void reorder(const std::vector<Vid>& order)
 		{
-			for (auto& p : dict)
+			std::vector<std::string> reordered(id2word.size());
+			for (size_t i = 0; i < id2word.size(); ++i)
+			{
+				reordered[order[i]] = std::move(id2word[i]);
+			}
+			id2word.swap(reordered);
+			for (auto& s : slots)
 			{
-				p.second = order[p.second];
-				id2word[p.second] = p.first;
+				if (s.id != non_vocab_id) s.id = order[s.id];
 			}
 		}
 
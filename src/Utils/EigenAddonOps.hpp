@@ -21,6 +21,41 @@ namespace Eigen
 	}
 }
 
+#ifdef EIGEN_VECTORIZE_AVX512
+#include <immintrin.h>
+#include "avx512_gamma.h"
+
+namespace Eigen
+{
+	namespace internal
+	{
+		template<> struct to_int_packet<Packet16f>
+		{
+			typedef Packet16i type;
+		};
+
+		template<> struct to_float_packet<Packet16i>
+		{
+			typedef Packet16f type;
+		};
+
+		EIGEN_STRONG_INLINE Packet16f p_to_f32(const Packet16i& a)
+		{
+			return _mm512_cvtepi32_ps(a);
+		}
+
+		EIGEN_STRONG_INLINE Packet16f p_bool2float(const Packet16f& a)
+		{
+			return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(a, _mm512_set1_ps(0), _CMP_NEQ_OQ), _mm512_set1_ps(1));
+		}
+
+		EIGEN_STRONG_INLINE Packet16f p_bool2float(const Packet16i& a)
+		{
+			return p_bool2float(_mm512_castsi512_ps(a));
+		}
+	}
+}
+#endif
 #ifdef EIGEN_VECTORIZE_AVX
 #include <immintrin.h>
 #include "avx_gamma.h"
@@ -91,11 +126,164 @@ namespace Eigen
 	}
 }
 #endif
+#if defined(EIGEN_VECTORIZE_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#include "neon_gamma.h"
+
+namespace Eigen
+{
+	namespace internal
+	{
+		template<> struct to_int_packet<Packet4f>
+		{
+			typedef Packet4i type;
+		};
+
+		template<> struct to_float_packet<Packet4i>
+		{
+			typedef Packet4f type;
+		};
+
+		EIGEN_STRONG_INLINE Packet4f p_to_f32(const Packet4i& a)
+		{
+			return vcvtq_f32_s32(a);
+		}
+
+		EIGEN_STRONG_INLINE Packet4f p_bool2float(const Packet4f& a)
+		{
+			return vreinterpretq_f32_u32(vandq_u32(vmvnq_u32(vceqq_f32(a, vdupq_n_f32(0))), vreinterpretq_u32_f32(vdupq_n_f32(1))));
+		}
+
+		EIGEN_STRONG_INLINE Packet4f p_bool2float(const Packet4i& a)
+		{
+			return p_bool2float(vreinterpretq_f32_s32(a));
+		}
+	}
+}
+#endif
 
 namespace Eigen
 {
 	namespace internal
 	{
+		// applies `fn` to each lane of `x`, for packets without vectorized versions
+		template<typename Packet, typename _Fn>
+		EIGEN_STRONG_INLINE Packet papply_lanes(const Packet& x, _Fn&& fn)
+		{
+			typedef typename unpacket_traits<Packet>::type Scalar;
+			Scalar buf[unpacket_traits<Packet>::size];
+			pstoreu(buf, x);
+			for (auto& v : buf) v = fn(v);
+			return ploadu<Packet>(buf);
+		}
+
+		// vectorized lookups of `tomoto::math::lgammaT` and `digammaT`, which gather from their tables where AVX2 or AVX-512 is available.
+		// Without gathers, a lane-by-lane lookup is slower than the scalar one, so the ops below are not vectorized then.
+#if defined(__AVX2__) || defined(EIGEN_VECTORIZE_AVX512)
+		static constexpr bool hasLutGather = true;
+#else
+		static constexpr bool hasLutGather = false;
+#endif
+		template<typename Packet>
+		EIGEN_STRONG_INLINE Packet plgammaT(const Packet& x)
+		{
+			return papply_lanes(x, [](float v) { return tomoto::math::lgammaT(v); });
+		}
+
+		template<typename Packet>
+		EIGEN_STRONG_INLINE Packet pdigammaT(const Packet& x)
+		{
+			return papply_lanes(x, [](float v) { return tomoto::math::digammaT(v); });
+		}
+
+#ifdef __AVX2__
+		EIGEN_STRONG_INLINE Packet8f plgammaT(const Packet8f& x)
+		{
+			return lut3_ps<tomoto::math::detail::LUT_lgamma>(x, [](__m256 v) { return lgamma_large_ps(v); });
+		}
+
+		EIGEN_STRONG_INLINE Packet8f pdigammaT(const Packet8f& x)
+		{
+			return lut3_ps<tomoto::math::detail::LUT_digamma>(x, [](__m256 v) { return digamma_large_ps(v); });
+		}
+#endif
+#ifdef EIGEN_VECTORIZE_AVX512
+		EIGEN_STRONG_INLINE Packet16f plgammaT(const Packet16f& x)
+		{
+			return lut3_ps<tomoto::math::detail::LUT_lgamma>(x, [](__m512 v) { return lgamma_large_ps(v); });
+		}
+
+		EIGEN_STRONG_INLINE Packet16f pdigammaT(const Packet16f& x)
+		{
+			return lut3_ps<tomoto::math::detail::LUT_digamma>(x, [](__m512 v) { return digamma_large_ps(v); });
+		}
+#endif
+
+		template<typename Scalar> struct scalar_lgammaT_op {
+			EIGEN_EMPTY_STRUCT_CTOR(scalar_lgammaT_op)
+			EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE const Scalar operator() (const Scalar& x) const { return tomoto::math::lgammaT(x); }
+			template<typename Packet>
+			EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE const Packet packetOp(const Packet& x) const
+			{
+				return plgammaT(x);
+			}
+		};
+
+		template<typename Scalar>
+		struct functor_traits<scalar_lgammaT_op<Scalar> >
+		{
+			enum {
+				Cost = 10 * NumTraits<Scalar>::MulCost,
+				PacketAccess = hasLutGather && std::is_same<Scalar, float>::value
+			};
+		};
+
+		template<typename Scalar> struct scalar_digammaT_op {
+			EIGEN_EMPTY_STRUCT_CTOR(scalar_digammaT_op)
+			EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE const Scalar operator() (const Scalar& x) const { return tomoto::math::digammaT(x); }
+			template<typename Packet>
+			EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE const Packet packetOp(const Packet& x) const
+			{
+				return pdigammaT(x);
+			}
+		};
+
+		template<typename Scalar>
+		struct functor_traits<scalar_digammaT_op<Scalar> >
+		{
+			enum {
+				Cost = 10 * NumTraits<Scalar>::MulCost,
+				PacketAccess = hasLutGather && std::is_same<Scalar, float>::value
+			};
+		};
+
+		/*
+		lgammaT(z + a) - lgammaT(z).
+		Both terms of a lane are looked up in the same way, so the difference is exactly 0 where `a` is 0,
+		while the scalar lookups for the remainder of an array might differ from the vectorized ones in the last bit.
+		*/
+		template<typename Scalar> struct scalar_lgammaT_subt_op {
+			EIGEN_EMPTY_STRUCT_CTOR(scalar_lgammaT_subt_op)
+			EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE const Scalar operator() (const Scalar& z, const Scalar& a) const 
+			{ 
+				return tomoto::math::lgammaT(z + a) - tomoto::math::lgammaT(z); 
+			}
+			template<typename Packet>
+			EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE const Packet packetOp(const Packet& z, const Packet& a) const
+			{
+				return psub(plgammaT(padd(z, a)), plgammaT(z));
+			}
+		};
+
+		template<typename Scalar>
+		struct functor_traits<scalar_lgammaT_subt_op<Scalar> >
+		{
+			enum {
+				Cost = 20 * NumTraits<Scalar>::MulCost,
+				PacketAccess = hasLutGather && std::is_same<Scalar, float>::value
+			};
+		};
+
 		template<typename Scalar, typename Scalar2> struct scalar_lgamma_subt_op {
 			EIGEN_EMPTY_STRUCT_CTOR(scalar_lgamma_subt_op)
 			EIGEN_DEVICE_FUNC EIGEN_STRONG_INLINE const Scalar operator() (const Scalar& z, const Scalar2& a) const { return tomoto::math::lgammaSubt(z, a); }
@@ -267,7 +455,8 @@ namespace Eigen
 
 	}
 
-	template <typename Derived, typename T> EIGEN_DEVICE_FUNC inline 
+	// `T` is restricted to scalars, otherwise this would be chosen over the overload below for two arrays
+	template <typename Derived, typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0> EIGEN_DEVICE_FUNC inline 
 		const CwiseBinaryOp<internal::scalar_lgamma_subt_op< typename internal::traits<Derived>::Scalar, T >, const Derived,
 		const typename internal::plain_constant_type<Derived, T>::type>
 		lgamma_subt(const Eigen::ArrayBase<Derived>& x, const T& scalar)  {
@@ -289,6 +478,27 @@ namespace Eigen
 	}
 
 
+	template<typename Derived>
+	inline const CwiseUnaryOp<internal::scalar_lgammaT_op<typename Derived::Scalar>, const Derived>
+		lgammaT(const Eigen::ArrayBase<Derived>& x)
+	{
+		return CwiseUnaryOp<internal::scalar_lgammaT_op<typename Derived::Scalar>, const Derived>(x.derived());
+	}
+
+	template<typename Derived>
+	inline const CwiseUnaryOp<internal::scalar_digammaT_op<typename Derived::Scalar>, const Derived>
+		digammaT(const Eigen::ArrayBase<Derived>& x)
+	{
+		return CwiseUnaryOp<internal::scalar_digammaT_op<typename Derived::Scalar>, const Derived>(x.derived());
+	}
+
+	template<typename Derived, typename Derived2>
+	inline const CwiseBinaryOp<internal::scalar_lgammaT_subt_op<typename Derived::Scalar>, const Derived, const Derived2>
+		lgammaT_subt(const Eigen::ArrayBase<Derived>& z, const Eigen::ArrayBase<Derived2>& a)
+	{
+		return CwiseBinaryOp<internal::scalar_lgammaT_subt_op<typename Derived::Scalar>, const Derived, const Derived2>(z.derived(), a.derived());
+	}
+
 	template<typename Derived>
 	inline const CwiseUnaryOp<internal::scalar_bool2float, const Derived>
 		bool2float(const Eigen::ArrayBase<Derived>& x)
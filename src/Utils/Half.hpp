@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace tomoto
+{
+	// conversions between float and IEEE 754 half precision numbers stored in uint16_t
+	namespace detail
+	{
+		inline uint16_t floatToHalf(float f)
+		{
+			uint32_t x;
+			std::memcpy(&x, &f, sizeof(x));
+			const uint16_t sign = (x >> 16) & 0x8000;
+			const int32_t exp = (int32_t)((x >> 23) & 0xFF) - 127 + 15;
+			uint32_t mant = x & 0x7FFFFF;
+			if (exp >= 31) return sign | 0x7C00;
+			if (exp <= 0)
+			{
+				// subnormal
+				if (exp < -10) return sign;
+				mant |= 0x800000;
+				const uint32_t shift = 14 - exp;
+				uint32_t h = mant >> shift;
+				if ((mant >> (shift - 1)) & 1) ++h;
+				return sign | (uint16_t)h;
+			}
+			uint32_t h = ((uint32_t)exp << 10) | (mant >> 13);
+			// a carry from the mantissa correctly increases the exponent
+			if (mant & 0x1000) ++h;
+			return sign | (uint16_t)h;
+		}
+
+		inline float halfToFloat(uint16_t h)
+		{
+			uint32_t sign = (uint32_t)(h & 0x8000) << 16, exp = (h >> 10) & 0x1F, mant = h & 0x3FF, x;
+			if (exp == 0)
+			{
+				if (!mant) x = sign;
+				else
+				{
+					// subnormal
+					exp = 127 - 15 + 1;
+					while (!(mant & 0x400))
+					{
+						mant <<= 1;
+						--exp;
+					}
+					x = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+				}
+			}
+			else if (exp == 31) x = sign | 0x7F800000 | (mant << 13);
+			else x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+			float f;
+			std::memcpy(&f, &x, sizeof(f));
+			return f;
+		}
+
+		inline const std::array<float, 65536>& getHalfTable()
+		{
+			static const std::array<float, 65536> table = []()
+			{
+				std::array<float, 65536> t;
+				for (size_t i = 0; i < t.size(); ++i) t[i] = halfToFloat((uint16_t)i);
+				return t;
+			}();
+			return table;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+namespace tomoto
+{
+	/*
+	Transparent huge pages for large arrays.
+	Random accesses into a multi-GB array, like columns of the topic-word counts, miss the TLB on most accesses with 4 KB pages.
+	Arrays advised by `advise` are backed by 2 MB pages, if the OS supports transparent huge pages, which cuts the misses.
+	It does nothing on the other OSes or while it is disabled, which is the default.
+	*/
+	class HugePages
+	{
+		static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+		static std::atomic<size_t>*& minBytesSlot()
+		{
+			static std::atomic<size_t> v{ 0 };
+			static std::atomic<size_t>* cur = &v;
+			return cur;
+		}
+
+		static std::atomic<size_t>& minBytes()
+		{
+			return *minBytesSlot();
+		}
+
+	public:
+		using State = std::atomic<size_t>;
+
+		// the setting of this module, which modules built separately share by `share`
+		static State& getState()
+		{
+			return minBytes();
+		}
+
+		static void share(State& state)
+		{
+			minBytesSlot() = &state;
+		}
+
+		// arrays of at least `bytes` bytes are advised. 0 disables it.
+		static void setMinBytes(size_t bytes)
+		{
+			minBytes() = bytes;
+		}
+
+		static size_t getMinBytes()
+		{
+			return minBytes();
+		}
+
+		static constexpr bool isSupported()
+		{
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		/*
+		advises the OS to back [ptr, ptr + bytes) with huge pages.
+		Only the 2 MB-aligned part of the range can be, and it should be called before the pages are touched first,
+		since pages already faulted in are promoted only later by the background compaction of the OS.
+		*/
+		static void advise(void* ptr, size_t bytes)
+		{
+			const size_t minB = minBytes();
+			if (!minB || bytes < minB) return;
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+			const uintptr_t b = ((uintptr_t)ptr + hugePageSize - 1) / hugePageSize * hugePageSize;
+			const uintptr_t e = ((uintptr_t)ptr + bytes) / hugePageSize * hugePageSize;
+			// failures (e.g. huge pages disabled in the kernel) leave normal pages, so they are ignored
+			if (e > b) madvise((void*)b, e - b, MADV_HUGEPAGE);
+#else
+			(void)ptr;
+#endif
+		}
+	};
+}
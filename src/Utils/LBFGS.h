@@ -39,6 +39,9 @@ namespace LBFGSpp {
 		Vector                    m_grad;   // New gradient
 		Vector                    m_gradp;  // Old gradient
 		Vector                    m_drt;    // Moving direction
+		int                       m_numPairs = 0; // The number of (s, y) pairs kept in the history
+		int                       m_end = 0;      // The column where the next pair is stored
+		Scalar                    m_gamma = 1;    // The scale of the initial Hessian approximation, y's / y'y of the last pair
 
 		inline void reset(int n)
 		{
@@ -53,6 +56,34 @@ namespace LBFGSpp {
 			m_drt.resize(n);
 			if (m_param.past > 0)
 				m_fx.resize(m_param.past);
+			clearHistory();
+		}
+
+		// Recursive formula to compute d = -H * g from the kept pairs
+		inline void computeDirection()
+		{
+			const int n = m_grad.size();
+			m_drt.noalias() = -m_grad;
+			int j = m_end;
+			for (int i = 0; i < m_numPairs; i++)
+			{
+				j = (j + m_param.m - 1) % m_param.m;
+				MapVec sj(&m_s(0, j), n);
+				MapVec yj(&m_y(0, j), n);
+				m_alpha[j] = sj.dot(m_drt) / m_ys[j];
+				m_drt.noalias() -= m_alpha[j] * yj;
+			}
+
+			m_drt *= m_gamma;
+
+			for (int i = 0; i < m_numPairs; i++)
+			{
+				MapVec sj(&m_s(0, j), n);
+				MapVec yj(&m_y(0, j), n);
+				Scalar beta = yj.dot(m_drt) / m_ys[j];
+				m_drt.noalias() += (m_alpha[j] - beta) * sj;
+				j = (j + 1) % m_param.m;
+			}
 		}
 
 	public:
@@ -68,6 +99,16 @@ namespace LBFGSpp {
 			m_param.check_param();
 		}
 
+		///
+		/// Drops the curvature pairs kept for warm starts.
+		///
+		inline void clearHistory()
+		{
+			m_numPairs = 0;
+			m_end = 0;
+			m_gamma = Scalar(1);
+		}
+
 		///
 		/// Minimizing a multivariate function using LBFGS algorithm.
 		/// Exceptions will be thrown if error occurs.
@@ -78,15 +119,18 @@ namespace LBFGSpp {
 		/// \param x  In: An initial guess of the optimal point. Out: The best point
 		///           found.
 		/// \param fx Out: The objective function value at `x`.
+		/// \param warm If true, the curvature pairs of the previous call are kept
+		///        and the first direction is computed from them, which suits
+		///        a series of similar problems of the same size.
 		///
 		/// \return Number of iterations used.
 		///
 		template <typename Foo>
-		inline int minimize(Foo&& f, Eigen::Ref<Vector> x, Scalar& fx)
+		inline int minimize(Foo&& f, Eigen::Ref<Vector> x, Scalar& fx, bool warm = false)
 		{
 			const int n = x.size();
 			const int fpast = m_param.past;
-			reset(n);
+			if (!warm || m_s.rows() != n) reset(n);
 
 			// Evaluate function and compute gradient
 			fx = f(x, m_grad);
@@ -102,22 +146,39 @@ namespace LBFGSpp {
 				return 1;
 			}
 
-			// Initial direction
-			m_drt.noalias() = -m_grad;
-			// Initial step
-			Scalar step = Scalar(1.0) / m_drt.norm();
+			// Initial direction, from the kept pairs if it descends
+			Scalar step = Scalar(1.0);
+			if (m_numPairs)
+			{
+				computeDirection();
+				if (!(m_grad.dot(m_drt) < 0)) clearHistory();
+			}
+			if (!m_numPairs)
+			{
+				m_drt.noalias() = -m_grad;
+				step = Scalar(1.0) / m_drt.norm();
+			}
 
 			int k = 1;
-			int end = 0;
 			for (; ; )
 			{
 				// Save the curent x and gradient
 				m_xp.noalias() = x;
 				m_gradp.noalias() = m_grad;
+				const Scalar fxp = fx;
 
 				// Line search to update x, fx and gradient
 				LineSearch<Scalar>::LineSearch(f, fx, x, m_grad, step, m_drt, m_xp, m_param);
 
+				// The line search ran out of its evaluations without decreasing the objective, so the last point is the best found
+				if (!(fx < fxp))
+				{
+					x = m_xp;
+					m_grad = m_gradp;
+					fx = fxp;
+					return k;
+				}
+
 				// New x norm and gradient norm
 				xnorm = x.norm();
 				gnorm = m_grad.norm();
@@ -144,8 +205,8 @@ namespace LBFGSpp {
 				// Update s and y
 				// s_{k+1} = x_{k+1} - x_k
 				// y_{k+1} = g_{k+1} - g_k
-				MapVec svec(&m_s(0, end), n);
-				MapVec yvec(&m_y(0, end), n);
+				MapVec svec(&m_s(0, m_end), n);
+				MapVec yvec(&m_y(0, m_end), n);
 				svec.noalias() = x - m_xp;
 				yvec.noalias() = m_grad - m_gradp;
 
@@ -160,32 +221,12 @@ namespace LBFGSpp {
 					ys += epsilon;
 					yy += epsilon;
 				}
-				m_ys[end] = ys;
-
-				// Recursive formula to compute d = -H * g
-				m_drt.noalias() = -m_grad;
-				int bound = std::min(m_param.m, k);
-				end = (end + 1) % m_param.m;
-				int j = end;
-				for (int i = 0; i < bound; i++)
-				{
-					j = (j + m_param.m - 1) % m_param.m;
-					MapVec sj(&m_s(0, j), n);
-					MapVec yj(&m_y(0, j), n);
-					m_alpha[j] = sj.dot(m_drt) / m_ys[j];
-					m_drt.noalias() -= m_alpha[j] * yj;
-				}
-
-				m_drt *= (ys / yy);
+				m_ys[m_end] = ys;
+				m_gamma = ys / yy;
+				m_end = (m_end + 1) % m_param.m;
+				m_numPairs = std::min(m_numPairs + 1, m_param.m);
 
-				for (int i = 0; i < bound; i++)
-				{
-					MapVec sj(&m_s(0, j), n);
-					MapVec yj(&m_y(0, j), n);
-					Scalar beta = yj.dot(m_drt) / m_ys[j];
-					m_drt.noalias() += (m_alpha[j] - beta) * sj;
-					j = (j + 1) % m_param.m;
-				}
+				computeDirection();
 
 				// step = 1.0 as initial guess
 				step = Scalar(1.0);
@@ -66,6 +66,14 @@ namespace tomoto
 					return points[idx] + a * (points[idx + 1] - points[idx]);
 				}
 			public:
+				// the layout of the table, which vectorized lookups (`lut3_ps` of *_gamma.h) follow
+				using Func = _Func;
+				static constexpr size_t segN = N, segM = M;
+				static constexpr _Prec stepP = P, stepQ = Q, stepR = R;
+				static constexpr _Prec tableEnd = N * P + M * Q + (L - 1) * R;
+
+				const _Prec* data() const { return points.data(); }
+
 				static const LUT3& getInst()
 				{
 					static LUT3 lg;
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <string>
+#include <ios>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace tomoto
+{
+	/*
+	Memory mapping of a whole file.
+	Pages are mapped copy-on-write, so writing into them never changes the file,
+	and processes mapping the same file share one copy of the page cache until they modify it.
+	*/
+	class MMap
+	{
+		char* view = nullptr;
+		size_t len = 0;
+#ifdef _WIN32
+		HANDLE hFile = INVALID_HANDLE_VALUE, hMap = nullptr;
+#else
+		int fd = -1;
+#endif
+
+		void close()
+		{
+#ifdef _WIN32
+			if (view) UnmapViewOfFile(view);
+			if (hMap) CloseHandle(hMap);
+			if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+			hMap = nullptr;
+			hFile = INVALID_HANDLE_VALUE;
+#else
+			if (view) munmap(view, len);
+			if (fd >= 0) ::close(fd);
+			fd = -1;
+#endif
+			view = nullptr;
+			len = 0;
+		}
+
+	public:
+		MMap(const std::string& path)
+		{
+#ifdef _WIN32
+			hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (hFile == INVALID_HANDLE_VALUE) throw std::ios_base::failure{ "cannot open file '" + path + "'" };
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(hFile, &size))
+			{
+				close();
+				throw std::ios_base::failure{ "cannot get the size of file '" + path + "'" };
+			}
+			len = (size_t)size.QuadPart;
+			if (!len) return;
+			hMap = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+			if (!hMap)
+			{
+				close();
+				throw std::ios_base::failure{ "cannot map file '" + path + "'" };
+			}
+			view = (char*)MapViewOfFile(hMap, FILE_MAP_COPY, 0, 0, 0);
+			if (!view)
+			{
+				close();
+				throw std::ios_base::failure{ "cannot map file '" + path + "'" };
+			}
+#else
+			fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) throw std::ios_base::failure{ "cannot open file '" + path + "'" };
+			struct stat st;
+			if (fstat(fd, &st) < 0)
+			{
+				close();
+				throw std::ios_base::failure{ "cannot get the size of file '" + path + "'" };
+			}
+			len = (size_t)st.st_size;
+			if (!len) return;
+			void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (p == MAP_FAILED)
+			{
+				len = 0;
+				close();
+				throw std::ios_base::failure{ "cannot map file '" + path + "'" };
+			}
+			view = (char*)p;
+#endif
+		}
+
+		MMap(const MMap&) = delete;
+		MMap& operator=(const MMap&) = delete;
+
+		~MMap()
+		{
+			close();
+		}
+
+		const char* get() const { return view; }
+		size_t size() const { return len; }
+	};
+
+	/*
+	Growable array of trivially copyable `T` in a temporary file, which is mapped into memory.
+	Pages are shared with the file, so the OS can write them back and drop them instead of keeping the whole array in memory.
+	The file is removed when the array is destroyed.
+	Resizing remaps the file, so it invalidates pointers into the array.
+	*/
+	template<typename T>
+	class MappedArray
+	{
+		T* view = nullptr;
+		size_t len = 0;
+#ifdef _WIN32
+		HANDLE hFile = INVALID_HANDLE_VALUE, hMap = nullptr;
+#else
+		int fd = -1;
+#endif
+
+		void unmap()
+		{
+#ifdef _WIN32
+			if (view) UnmapViewOfFile(view);
+			if (hMap) CloseHandle(hMap);
+			hMap = nullptr;
+#else
+			if (view) munmap(view, len * sizeof(T));
+#endif
+			view = nullptr;
+		}
+
+	public:
+		// creates an empty array whose file is made in the directory `dir`
+		MappedArray(const std::string& dir)
+		{
+#ifdef _WIN32
+			char path[MAX_PATH];
+			if (!GetTempFileNameA(dir.c_str(), "tmt", 0, path)) throw std::ios_base::failure{ "cannot create a temporary file in '" + dir + "'" };
+			hFile = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+				FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+			if (hFile == INVALID_HANDLE_VALUE) throw std::ios_base::failure{ "cannot create a temporary file in '" + dir + "'" };
+#else
+			std::string path = dir + "/tomotoXXXXXX";
+			fd = mkstemp(&path[0]);
+			if (fd < 0) throw std::ios_base::failure{ "cannot create a temporary file in '" + dir + "'" };
+			// the file stays until `fd` is closed
+			unlink(path.c_str());
+#endif
+		}
+
+		MappedArray(const MappedArray&) = delete;
+		MappedArray& operator=(const MappedArray&) = delete;
+
+		~MappedArray()
+		{
+			unmap();
+#ifdef _WIN32
+			if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+#else
+			if (fd >= 0) ::close(fd);
+#endif
+		}
+
+		// newly added elements are zero
+		void resize(size_t n)
+		{
+			unmap();
+			len = 0;
+			const size_t bytes = n * sizeof(T);
+#ifdef _WIN32
+			LARGE_INTEGER size;
+			size.QuadPart = (LONGLONG)bytes;
+			if (!SetFilePointerEx(hFile, size, nullptr, FILE_BEGIN) || !SetEndOfFile(hFile)) throw std::ios_base::failure{ "cannot resize a temporary file" };
+			if (!n) return;
+			hMap = CreateFileMappingA(hFile, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+			if (!hMap) throw std::ios_base::failure{ "cannot map a temporary file" };
+			view = (T*)MapViewOfFile(hMap, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+			if (!view) throw std::ios_base::failure{ "cannot map a temporary file" };
+#else
+			if (ftruncate(fd, (off_t)bytes) < 0) throw std::ios_base::failure{ "cannot resize a temporary file" };
+			if (!n) return;
+			void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (p == MAP_FAILED) throw std::ios_base::failure{ "cannot map a temporary file" };
+			view = (T*)p;
+#endif
+			len = n;
+		}
+
+		/*
+		hints that the elements in [first, first + n) will be accessed soon,
+		so that the OS starts reading them from the file in the background.
+		*/
+		void prefetch(size_t first, size_t n) const
+		{
+			if (first >= len || !n) return;
+			n = std::min(n, len - first);
+#ifdef _WIN32
+#if _WIN32_WINNT >= 0x0602
+			WIN32_MEMORY_RANGE_ENTRY range{ (PVOID)(view + first), n * sizeof(T) };
+			PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+			const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+			const size_t b = (size_t)(view + first) / page * page;
+			const size_t e = (size_t)(view + first + n);
+			madvise((void*)b, e - b, MADV_WILLNEED);
+#endif
+		}
+
+		T* data() { return view; }
+		const T* data() const { return view; }
+		size_t size() const { return len; }
+	};
+}
@@ -51,14 +51,29 @@ namespace tomoto
 					}
 					if (len > 1) newDist.cov /= len - 1;
 				}
-				Eigen::MatrixXd l = newDist.cov.template cast<double>().llt().matrixL();
-				newDist.l = l.template cast<float>();
-				newDist.logDet = l.diagonal().array().log().sum();
+				newDist.decompose();
+				return newDist;
+			}
+
+			// builds a distribution from `mean` and `cov`, which were estimated elsewhere (e.g. reduced in parallel)
+			static MultiNormalDistribution<_Ty> fromMeanCov(Eigen::Matrix<_Ty, -1, 1> mean, Eigen::Matrix<_Ty, -1, -1> cov)
+			{
+				MultiNormalDistribution<_Ty> newDist;
+				newDist.mean = std::move(mean);
+				newDist.cov = std::move(cov);
+				newDist.decompose();
 				return newDist;
 			}
 
 			DEFINE_SERIALIZER_CALLBACK(onRead, mean, cov);
 		private:
+			void decompose()
+			{
+				Eigen::MatrixXd l = cov.template cast<double>().llt().matrixL();
+				this->l = l.template cast<_Ty>();
+				logDet = l.diagonal().array().log().sum();
+			}
+
 			void onRead() 
 			{
 				l = cov.llt().matrixL();
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+namespace tomoto
+{
+	/*
+	Philox4x32-10, the counter-based random generator of Salmon et al. (2011).
+	Each output block is a keyed bijection of a 128-bit counter, so a stream is identified by its key and counter
+	and can be created at any point without any state carried over from other streams.
+	Here the key is a 64-bit seed, and the counter holds (block index, stream id, iteration),
+	so that (seed, iteration, stream id) gives an independent stream of 2^32 blocks of four 32-bit integers.
+	*/
+	class Philox4x32
+	{
+		uint32_t key[2];
+		uint32_t ctr[4];
+		uint32_t buf[4];
+		uint32_t pos = 4;
+
+		static void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo)
+		{
+			const uint64_t p = (uint64_t)a * b;
+			hi = (uint32_t)(p >> 32);
+			lo = (uint32_t)p;
+		}
+
+		void generate()
+		{
+			uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+			uint32_t k0 = key[0], k1 = key[1];
+			for (int r = 0; r < 10; ++r)
+			{
+				uint32_t hi0, lo0, hi1, lo1;
+				mulhilo(0xD2511F53, c0, hi0, lo0);
+				mulhilo(0xCD9E8D57, c2, hi1, lo1);
+				c0 = hi1 ^ c1 ^ k0;
+				c1 = lo1;
+				c2 = hi0 ^ c3 ^ k1;
+				c3 = lo0;
+				k0 += 0x9E3779B9;
+				k1 += 0xBB67AE85;
+			}
+			buf[0] = c0; buf[1] = c1; buf[2] = c2; buf[3] = c3;
+			++ctr[0];
+			pos = 0;
+		}
+
+	public:
+		using result_type = uint32_t;
+
+		Philox4x32(uint64_t seed, uint64_t streamId, uint32_t iteration)
+			: key{ (uint32_t)seed, (uint32_t)(seed >> 32) },
+			ctr{ 0, (uint32_t)streamId, (uint32_t)(streamId >> 32), iteration }
+		{
+		}
+
+		static constexpr result_type min() { return 0; }
+		static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+		result_type operator()()
+		{
+			if (pos >= 4) generate();
+			return buf[pos++];
+		}
+
+		// a float in [0, 1) with 24 random bits, like `uniform_real` of the generators of EigenRand
+		float uniform_real()
+		{
+			return (operator()() >> 8) * (1.f / (1 << 24));
+		}
+	};
+}
@@ -1,20 +1,30 @@
 #pragma once
 
 #include <string>
+#include <atomic>
+#include <new>
 #include "serializer.hpp"
 
 namespace tomoto
 {
+	/*
+	SharedString is a reference-counted immutable string.
+	Several strings can be slices of one block, see `trade`, which stores the texts of many documents in one allocation.
+	Since a slice is not terminated by a zero, there is no `c_str()`.
+	*/
 	class SharedString
 	{
-		const char* ptr = nullptr;
-		size_t len = 0;
+		using RefCount = std::atomic<size_t>;
+		static constexpr size_t headerSize = sizeof(RefCount);
+
+		const char* ptr = nullptr; // the block, starting with the reference count
+		size_t off = 0, len = 0;
 
 		void incref()
 		{
 			if (ptr)
 			{
-				++*(size_t*)ptr;
+				((RefCount*)ptr)->fetch_add(1, std::memory_order_relaxed);
 			}
 		}
 
@@ -22,21 +32,35 @@ namespace tomoto
 		{
 			if (ptr)
 			{
-				if (--*(size_t*)ptr == 0)
+				if (((RefCount*)ptr)->fetch_sub(1, std::memory_order_acq_rel) == 1)
 				{
+					((RefCount*)ptr)->~RefCount();
 					delete[] ptr;
 					ptr = nullptr;
 				}
 			}
 		}
 
+		static char* allocate(size_t size)
+		{
+			char* block = new char[size + headerSize];
+			new (block) RefCount{ 1 };
+			return block;
+		}
+
 		void init(const char* _begin, const char* _end)
 		{
-			ptr = new char[_end - _begin + 9];
-			*(size_t*)ptr = 1;
+			char* block = allocate(_end - _begin);
+			std::memcpy(block + headerSize, _begin, _end - _begin);
+			ptr = block;
+			off = 0;
 			len = _end - _begin;
-			std::memcpy((void*)(ptr + 8), _begin, _end - _begin);
-			((char*)ptr)[_end - _begin + 8] = 0;
+		}
+
+		SharedString(const char* _ptr, size_t _off, size_t _len)
+			: ptr{ _ptr }, off{ _off }, len{ _len }
+		{
+			incref();
 		}
 
 	public:
@@ -67,7 +91,7 @@ namespace tomoto
 		}
 
 		SharedString(const SharedString& o) noexcept
-			: ptr{ o.ptr }, len{ o.len }
+			: ptr{ o.ptr }, off{ o.off }, len{ o.len }
 		{
 			incref();
 		}
@@ -75,6 +99,7 @@ namespace tomoto
 		SharedString(SharedString&& o) noexcept
 		{
 			std::swap(ptr, o.ptr);
+			std::swap(off, o.off);
 			std::swap(len, o.len);
 		}
 
@@ -89,6 +114,7 @@ namespace tomoto
 			{
 				decref();
 				ptr = o.ptr;
+				off = o.off;
 				len = o.len;
 				incref();
 			}
@@ -98,6 +124,7 @@ namespace tomoto
 		SharedString& operator=(SharedString&& o) noexcept
 		{
 			std::swap(ptr, o.ptr);
+			std::swap(off, o.off);
 			std::swap(len, o.len);
 			return *this;
 		}
@@ -116,18 +143,13 @@ namespace tomoto
 		operator std::string() const
 		{
 			if (!ptr) return {};
-			return { ptr + 8, ptr + 8 + len };
-		}
-
-		const char* c_str() const
-		{
-			if (!ptr) return "";
-			return ptr + 8;
+			return { data(), data() + len };
 		}
 
 		const char* data() const
 		{
-			return c_str();
+			if (!ptr) return "";
+			return ptr + headerSize + off;
 		}
 
 		const char* begin() const
@@ -140,14 +162,35 @@ namespace tomoto
 			return data() + size();
 		}
 
+		// a slice of [start, start + len) sharing the block of this string
+		SharedString slice(size_t start, size_t len) const
+		{
+			if (!len) return {};
+			return SharedString{ ptr, off + start, len };
+		}
+
+		// makes a string of `len` bytes whose content is written by `fill(char*)`, without copying it from another buffer
+		template<class _Fn>
+		static SharedString build(size_t len, _Fn&& fill)
+		{
+			SharedString ret;
+			if (!len) return ret;
+			char* block = allocate(len);
+			ret.ptr = block;
+			ret.len = len;
+			fill(block + headerSize);
+			return ret;
+		}
+
 		std::string substr(size_t start, size_t len) const
 		{
-			return { c_str() + start, c_str() + start + len };
+			return { data() + start, data() + start + len };
 		}
 
+		// the slices of the same block are equal only if they are at the same range
 		bool operator==(const SharedString& o) const
 		{
-			if (ptr == o.ptr) return true;
+			if (ptr == o.ptr && off == o.off && len == o.len) return true;
 			if (size() != o.size()) return false;
 			return std::equal(begin(), end(), o.begin());
 		}
@@ -167,6 +210,31 @@ namespace tomoto
 		{
 			return !operator==(o);
 		}
+
+		/*
+		copies all the strings pointed by [srcBegin, srcEnd) into one block and makes each of them a slice of it,
+		like `tvector::trade` does for arrays.
+		The blocks the strings had before are released when no other string refers to them.
+		*/
+		template<class _Iter>
+		static void trade(_Iter srcBegin, _Iter srcEnd)
+		{
+			size_t totalLen = 0;
+			for (auto it = srcBegin; it != srcEnd; ++it) totalLen += (*it)->size();
+			if (!totalLen) return;
+			char* block = allocate(totalLen);
+			size_t o = 0;
+			for (auto it = srcBegin; it != srcEnd; ++it)
+			{
+				auto& s = **it;
+				if (s.empty()) continue;
+				std::memcpy(block + headerSize + o, s.data(), s.size());
+				s = SharedString{ block, o, s.size() };
+				o += s.size();
+			}
+			// the reference made by `allocate` is dropped, so the block lives as long as its slices
+			((RefCount*)block)->fetch_sub(1, std::memory_order_relaxed);
+		}
 	};
 
 	namespace serializer
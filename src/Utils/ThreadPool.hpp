@@ -3,86 +3,537 @@
 /*
 A simple C++11 Thread Pool implementation(https://github.com/progschj/ThreadPool)
 modified by bab2min to have additional parameter threadId
+
+Each worker owns a deque of tasks and its own lock & condition variable.
+`enqueue` puts a task into the deque of an idle worker (or the next one in round-robin order) and wakes up that worker,
+or, if it is busy, another one which is asleep. Workers which run out of their own tasks steal ones from the back of the others' deques.
+Tasks enqueued by `enqueueToAll` are pinned to their worker and never stolen.
+If `numaAware` is set, workers are bound to the cpus of NUMA nodes (Linux only) which the process is allowed to run on,
+spread over the nodes in proportion to their allowed cpus with consecutive workers on the same node,
+so that the memory each worker touches first is allocated on its own node.
+If a worker can't be bound, the pool falls back to being not NUMA-aware.
+Each worker accumulates the time it spends running tasks, see `getWorkerBusyTime`.
+With a `TraceRecorder` set by `setTracer`, every task and every chunk of parallel loops is also recorded with the time it was queued,
+started and finished. Without it, tasks are not wrapped at all.
+
+`parallelFor` and `parallelReduce` split a range of indices into chunks and let the workers claim them from a shared cursor.
+Unlike `enqueue`, they don't allocate any task, `std::function` or future per call,
+so they suit short loops which are run many times, like the per-topic sums of parameter optimization.
+The caller spins for a while before blocking until all chunks are done, and idle workers spin briefly before going to sleep
+so that back-to-back loops don't pay for waking them up.
+
+`PoolManager` keeps the pools which are not in use across calls, so that inference and auxiliary computations
+borrow live workers instead of spawning and joining threads every time.
+It also caps the number of workers of all the pools borrowed at the same time.
 */
 
 #include <vector>
-#include <queue>
+#include <algorithm>
+#include <deque>
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
+#include <chrono>
 #include <future>
 #include <functional>
 #include <stdexcept>
+#include <exception>
+#include <type_traits>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include "Trace.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace tomoto
 {
 	class ThreadPool {
 	public:
-		ThreadPool(size_t threads = 0, size_t maxQueued = 0);
+		ThreadPool(size_t threads = 0, size_t maxQueued = 0, bool numaAware = false);
 		template<class F, class... Args>
 		auto enqueue(F&& f, Args&&... args)
 			->std::future<typename std::result_of<F(size_t, Args...)>::type>;
-		
+
 		template<class F, class... Args>
 		auto enqueueToAll(F&& f, Args&&... args)
 			->std::vector<std::future<typename std::result_of<F(size_t, Args...)>::type>>;
 
+		/*
+		calls `fn(threadId, b, e)` over subranges [b, e) covering [first, last) in parallel and waits for all of them.
+		Subranges are aligned to `grain`. By default the range is split statically into one chunk per worker,
+		while `guided` hands out decreasing chunks (half of the remaining range divided by the number of workers)
+		which balances bodies of uneven cost.
+		The first exception thrown by `fn` is rethrown after all chunks are finished.
+		It must not be called from the workers of the same pool.
+		*/
+		template<class F>
+		void parallelFor(size_t first, size_t last, F&& fn, size_t grain = 1, bool guided = false);
+
+		/*
+		computes `fn(threadId, b, e)` over statically split subranges of [first, last) in parallel
+		and folds the results into `init` with `reduce` in the order of the subranges,
+		so the result doesn't depend on the scheduling. `T` should be default-constructible.
+		*/
+		template<class T, class F, class R>
+		T parallelReduce(size_t first, size_t last, T init, F&& fn, R&& reduce, size_t grain = 1);
+
 		~ThreadPool();
-		
+
 		size_t getNumWorkers() const { return workers.size(); }
-		size_t getNumEnqued() const { return tasks.size(); }
+		size_t getNumEnqued() const { return numPending.load(); }
+		// whether the workers are bound to NUMA nodes, which may be false even if the pool was created with `numaAware` when binding failed
+		bool isNumaAware() const { return numaAware; }
+		bool isNumaRequested() const { return numaRequested; }
+		// the NUMA node which the `i`-th worker is bound to, always 0 if the pool isn't NUMA-aware
+		size_t getWorkerNode(size_t i) const { return workerNodes.empty() ? 0 : workerNodes[i]; }
+
+		// the total time in seconds which the `i`-th worker has spent running tasks
+		double getWorkerBusyTime(size_t i) const { return queues[i].busyNanos.load(std::memory_order_relaxed) * 1e-9; }
+
+		// returns the list of cpus of each NUMA node which the process is allowed to run on. It has only one node when the topology is unknown.
+		static std::vector<std::vector<size_t>> getNumaNodes();
+
+		// `tracer` should have a buffer for each worker, and it should be changed only while no task is queued or running. nullptr stops tracing.
+		void setTracer(TraceRecorder* _tracer) { tracer = _tracer; }
+		TraceRecorder* getTracer() const { return tracer; }
 	private:
+		using Task = std::function<void(size_t)>;
+
+		struct WorkerQueue
+		{
+			std::mutex mutex;
+			std::condition_variable condition;
+			std::deque<Task> tasks; // stealable tasks
+			std::deque<Task> pinned; // tasks which should be run by this worker
+			std::atomic<bool> sleeping{ false };
+			std::atomic<uint64_t> busyNanos{ 0 };
+		};
+
+		bool popTask(size_t i, Task& task);
+		void pushTask(size_t i, Task&& task, bool pin);
+
+		// type-erased body of parallel loops, called as (fn, threadId, chunkId, b, e)
+		using ForInvoker = void(*)(void*, size_t, size_t, size_t, size_t);
+		static constexpr size_t forChunkBits = 40;
+		static constexpr uint64_t forChunkMask = ((uint64_t)1 << forChunkBits) - 1;
+		static constexpr size_t forCallerSpins = 4096, forWorkerSpins = 64;
+
+		// runs the loop and returns the number of chunks
+		size_t runFor(size_t first, size_t last, size_t grain, bool guided, ForInvoker invoke, void* fn);
+		void makeForBounds(size_t first, size_t last, size_t grain, bool guided);
+		bool hasForChunks() const
+		{
+			return (forCursor.load() & forChunkMask) < forNumChunks.load();
+		}
+		// claims and runs chunks of the current loop until none remains, returns whether it ran any
+		bool runForChunks(size_t i);
+
 		// need to keep track of threads so we can join them
 		std::vector< std::thread > workers;
-		// the task queue
-		std::queue< std::function<void(size_t)> > shared_task;
-		std::vector< std::queue< std::function<void(size_t)> > > tasks;
-		// synchronization
-		std::mutex queue_mutex;
-		std::condition_variable condition, inputCnd;
+		std::unique_ptr<WorkerQueue[]> queues;
+		size_t numQueues;
+		// the number of stealable tasks which are not started yet
+		std::atomic<size_t> numPending{ 0 };
+		std::atomic<size_t> nextWorker{ 0 };
+		// synchronization for maxQueued
+		std::mutex input_mutex;
+		std::condition_variable inputCnd;
 		size_t maxQueued;
-		bool stop;
+		std::atomic<bool> stop;
+		bool numaAware, numaRequested;
+		std::vector<size_t> workerNodes;
+
+		// state of the current parallel loop, guarded by `forMutex` on the caller side
+		std::mutex forMutex;
+		std::vector<size_t> forBounds;
+		ForInvoker forInvoke = nullptr;
+		void* forFn = nullptr;
+		uint64_t forEpoch = 0;
+		// the epoch of the loop in the upper bits and the next chunk to be claimed in the lower `forChunkBits` bits
+		std::atomic<uint64_t> forCursor{ forChunkMask };
+		std::atomic<size_t> forNumChunks{ 0 };
+		std::atomic<size_t> forDoneChunks{ 0 };
+		std::exception_ptr forError;
+		std::mutex forDoneMutex;
+		std::condition_variable forDoneCnd;
+
+		TraceRecorder* tracer = nullptr;
+		// the phase and the time when the current parallel loop was opened, only while tracing
+		const char* forPhase = nullptr;
+		int64_t forOpened = 0;
 	};
 
+	inline std::vector<std::vector<size_t>> ThreadPool::getNumaNodes()
+	{
+		std::vector<std::vector<size_t>> nodes;
+#ifdef __linux__
+		// cpus outside of the affinity mask of the process, like those excluded by taskset or cgroups, are skipped
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		const bool hasMask = sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == 0;
+		auto isAllowed = [&](size_t c) { return !hasMask || (c < CPU_SETSIZE && CPU_ISSET(c, &allowed)); };
+		for (size_t n = 0; ; ++n)
+		{
+			std::ifstream ifs{ "/sys/devices/system/node/node" + std::to_string(n) + "/cpulist" };
+			if (!ifs) break;
+			// cpulist is a comma-separated list of ranges like "0-7,16-23"
+			std::vector<size_t> cpus;
+			std::string range;
+			while (std::getline(ifs, range, ','))
+			{
+				size_t b = 0, e = 0;
+				char dash = 0;
+				std::istringstream iss{ range };
+				if (!(iss >> b)) continue;
+				if (!(iss >> dash >> e)) e = b;
+				for (size_t c = b; c <= e; ++c)
+				{
+					if (isAllowed(c)) cpus.emplace_back(c);
+				}
+			}
+			if (!cpus.empty()) nodes.emplace_back(std::move(cpus));
+		}
+		if (nodes.empty() && hasMask)
+		{
+			nodes.emplace_back();
+			for (size_t c = 0; c < CPU_SETSIZE; ++c)
+			{
+				if (CPU_ISSET(c, &allowed)) nodes[0].emplace_back(c);
+			}
+			if (nodes[0].empty()) nodes.clear();
+		}
+#endif
+		if (nodes.empty())
+		{
+			nodes.emplace_back();
+			for (size_t c = 0; c < std::max(std::thread::hardware_concurrency(), 1u); ++c) nodes[0].emplace_back(c);
+		}
+		return nodes;
+	}
+
+	inline bool ThreadPool::popTask(size_t i, Task& task)
+	{
+		{
+			auto& q = queues[i];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (!q.pinned.empty())
+			{
+				task = std::move(q.pinned.front());
+				q.pinned.pop_front();
+				return true;
+			}
+			if (!q.tasks.empty())
+			{
+				task = std::move(q.tasks.front());
+				q.tasks.pop_front();
+				--numPending;
+				return true;
+			}
+		}
+
+		// steal from the back of the others
+		for (size_t j = 1; j < numQueues && numPending.load(); ++j)
+		{
+			auto& q = queues[(i + j) % numQueues];
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (q.tasks.empty()) continue;
+			task = std::move(q.tasks.back());
+			q.tasks.pop_back();
+			--numPending;
+			return true;
+		}
+		return false;
+	}
+
+	inline void ThreadPool::pushTask(size_t i, Task&& task, bool pin)
+	{
+		auto& q = queues[i];
+		{
+			std::lock_guard<std::mutex> lock(q.mutex);
+			// don't allow enqueueing after stopping the pool
+			if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
+			if (pin)
+			{
+				q.pinned.emplace_back(std::move(task));
+			}
+			else
+			{
+				q.tasks.emplace_back(std::move(task));
+				++numPending;
+			}
+		}
+		q.condition.notify_one();
+		if (pin || q.sleeping.load()) return;
+
+		/*
+		the owner is busy, so another worker which is asleep is woken up to steal the task.
+		A worker stores `sleeping` before checking `numPending`, and `numPending` is increased above before `sleeping` is loaded here,
+		so a worker falling asleep at the same time either sees the task or is seen here. Taking its lock makes sure it is waiting when notified.
+		*/
+		for (size_t j = 1; j < numQueues; ++j)
+		{
+			auto& other = queues[(i + j) % numQueues];
+			if (!other.sleeping.load()) continue;
+			{
+				std::lock_guard<std::mutex> lock(other.mutex);
+			}
+			other.condition.notify_one();
+			break;
+		}
+	}
+
+	inline bool ThreadPool::runForChunks(size_t i)
+	{
+		bool ran = false;
+		uint64_t c = forCursor.load(std::memory_order_acquire);
+		while (1)
+		{
+			const size_t chunk = c & forChunkMask;
+			const size_t n = forNumChunks.load(std::memory_order_relaxed);
+			if (chunk >= n) break;
+			// fails if another worker has claimed the chunk or the loop has been replaced, then `c` is reloaded
+			if (!forCursor.compare_exchange_weak(c, c + 1, std::memory_order_acq_rel, std::memory_order_acquire)) continue;
+
+			ran = true;
+			const auto start = std::chrono::steady_clock::now();
+			try
+			{
+				forInvoke(forFn, i, chunk, forBounds[chunk], forBounds[chunk + 1]);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(forDoneMutex);
+				if (!forError) forError = std::current_exception();
+			}
+			const auto end = std::chrono::steady_clock::now();
+			queues[i].busyNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+				std::memory_order_relaxed);
+			if (tracer) tracer->record(i + 1, forPhase, "chunk", forOpened, tracer->toNanos(start), tracer->toNanos(end));
+
+			if (forDoneChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == n)
+			{
+				std::lock_guard<std::mutex> lock(forDoneMutex);
+				forDoneCnd.notify_all();
+			}
+			c = forCursor.load(std::memory_order_acquire);
+		}
+		return ran;
+	}
+
+	inline void ThreadPool::makeForBounds(size_t first, size_t last, size_t grain, bool guided)
+	{
+		const size_t n = last - first, w = numQueues;
+		forBounds.clear();
+		forBounds.emplace_back(first);
+		if (guided)
+		{
+			for (size_t b = 0; b < n;)
+			{
+				size_t s = std::max((n - b + 2 * w - 1) / (2 * w), grain);
+				s = (s + grain - 1) / grain * grain;
+				b = std::min(b + s, n);
+				forBounds.emplace_back(first + b);
+			}
+		}
+		else
+		{
+			const size_t numChunks = std::min(w, (n + grain - 1) / grain);
+			for (size_t c = 1; c < numChunks; ++c)
+			{
+				const size_t b = std::min((n * c / numChunks + grain - 1) / grain * grain, n);
+				if (first + b > forBounds.back()) forBounds.emplace_back(first + b);
+			}
+			if (forBounds.back() < last) forBounds.emplace_back(last);
+		}
+	}
+
+	inline size_t ThreadPool::runFor(size_t first, size_t last, size_t grain, bool guided, ForInvoker invoke, void* fn)
+	{
+		std::lock_guard<std::mutex> forLock(forMutex);
+		makeForBounds(first, last, std::max(grain, (size_t)1), guided);
+		const size_t numChunks = forBounds.size() - 1;
+		forInvoke = invoke;
+		forFn = fn;
+		forError = nullptr;
+		if (tracer)
+		{
+			forPhase = tracer->getPhase();
+			forOpened = tracer->now();
+		}
+		forDoneChunks.store(0, std::memory_order_relaxed);
+		forNumChunks.store(numChunks, std::memory_order_relaxed);
+		forEpoch = (forEpoch + 1) & ((uint64_t)-1 >> forChunkBits);
+		// publishing the new epoch opens the loop.
+		// Together with `sleeping` being stored before the workers check the cursor, this makes sure that any worker either sees the loop or gets notified.
+		forCursor.store(forEpoch << forChunkBits);
+		for (size_t i = 0; i < numQueues; ++i)
+		{
+			auto& q = queues[i];
+			if (!q.sleeping.load()) continue;
+			{
+				std::lock_guard<std::mutex> lock(q.mutex);
+			}
+			q.condition.notify_one();
+		}
+
+		for (size_t s = 0; forDoneChunks.load(std::memory_order_acquire) < numChunks; ++s)
+		{
+			if (s < forCallerSpins)
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(forDoneMutex);
+			forDoneCnd.wait(lock, [&]() { return forDoneChunks.load(std::memory_order_acquire) >= numChunks; });
+			break;
+		}
+		// closes the loop so that workers holding a stale cursor can't claim a chunk of the next one
+		forCursor.store(forCursor.load() | forChunkMask);
+
+		std::exception_ptr err;
+		{
+			std::lock_guard<std::mutex> lock(forDoneMutex);
+			std::swap(err, forError);
+		}
+		if (err) std::rethrow_exception(err);
+		return numChunks;
+	}
+
+	template<class F>
+	void ThreadPool::parallelFor(size_t first, size_t last, F&& fn, size_t grain, bool guided)
+	{
+		if (first >= last) return;
+		if (workers.empty())
+		{
+			fn((size_t)0, first, last);
+			return;
+		}
+		using Fn = typename std::remove_reference<F>::type;
+		ForInvoker invoke = [](void* f, size_t threadId, size_t, size_t b, size_t e)
+		{
+			(*(Fn*)f)(threadId, b, e);
+		};
+		runFor(first, last, grain, guided, invoke, const_cast<void*>(static_cast<const void*>(std::addressof(fn))));
+	}
+
+	template<class T, class F, class R>
+	T ThreadPool::parallelReduce(size_t first, size_t last, T init, F&& fn, R&& reduce, size_t grain)
+	{
+		if (first >= last) return init;
+		if (workers.empty()) return reduce(std::move(init), fn((size_t)0, first, last));
+
+		// static splitting yields at most one chunk per worker, and the buffer is reused by later calls on this thread
+		static thread_local std::vector<T> partials;
+		if (partials.size() < workers.size()) partials.resize(workers.size());
+
+		using Fn = typename std::remove_reference<F>::type;
+		struct Body
+		{
+			Fn* fn;
+			T* out;
+		} body{ std::addressof(fn), partials.data() };
+		ForInvoker invoke = [](void* f, size_t threadId, size_t chunk, size_t b, size_t e)
+		{
+			auto& self = *(Body*)f;
+			self.out[chunk] = (*self.fn)(threadId, b, e);
+		};
+		const size_t numChunks = runFor(first, last, grain, false, invoke, &body);
+		for (size_t c = 0; c < numChunks; ++c) init = reduce(std::move(init), std::move(partials[c]));
+		return init;
+	}
 
 	// the constructor just launches some amount of workers
-	inline ThreadPool::ThreadPool(size_t threads, size_t _maxQueued)
-		: tasks(threads), maxQueued(_maxQueued), stop(false)
+	inline ThreadPool::ThreadPool(size_t threads, size_t _maxQueued, bool _numaAware)
+		: queues(new WorkerQueue[threads]), numQueues(threads), maxQueued(_maxQueued), stop(false), numaAware(_numaAware), numaRequested(_numaAware)
 	{
+		std::vector<size_t> workerCpus;
+		if (numaAware)
+		{
+			auto nodes = getNumaNodes();
+			size_t totCpus = 0;
+			for (auto& n : nodes) totCpus += n.size();
+			// spread workers over the nodes in proportion to their cpus, keeping consecutive workers on the same node
+			for (size_t i = 0; i < threads; ++i)
+			{
+				size_t slot = i * totCpus / threads, node = 0;
+				for (; slot >= nodes[node].size(); ++node) slot -= nodes[node].size();
+				workerNodes.emplace_back(node);
+				workerCpus.emplace_back(nodes[node][slot]);
+			}
+		}
+
+		// workers wait for being bound before they start, so that they touch no memory on another node
+		std::promise<void> bound;
+		std::shared_future<void> started = bound.get_future().share();
 		for (size_t i = 0; i < threads; ++i)
 		{
-			workers.emplace_back([this, i]
+			workers.emplace_back([this, i, started]
 			{
+				started.wait();
+				auto& q = this->queues[i];
 				while (1)
 				{
-					std::function<void(size_t)> task;
-
+					Task task;
+					if (!this->popTask(i, task))
 					{
-						std::unique_lock<std::mutex> lock(this->queue_mutex);
-						this->condition.wait(lock,
-							[this, i] { return this->stop || !this->shared_task.empty() || !this->tasks[i].empty(); });
-						if (this->stop && this->shared_task.empty() && this->tasks[i].empty()) return;
-						if (this->tasks[i].empty())
-						{
-							task = std::move(this->shared_task.front());
-							this->shared_task.pop();
-						}
-						else
+						if (this->runForChunks(i)) continue;
+
+						// spins briefly since parallel loops are often issued back to back
+						bool found = false;
+						for (size_t s = 0; s < forWorkerSpins && !found; ++s)
 						{
-							task = std::move(this->tasks[i].front());
-							this->tasks[i].pop();
+							std::this_thread::yield();
+							found = this->hasForChunks() || this->numPending.load();
 						}
-						
-						if (this->maxQueued) this->inputCnd.notify_all();
+						if (found) continue;
+
+						std::unique_lock<std::mutex> lock(q.mutex);
+						q.sleeping = true;
+						q.condition.wait(lock,
+							[&] { return this->stop || !q.pinned.empty() || !q.tasks.empty() || this->numPending.load() || this->hasForChunks(); });
+						q.sleeping = false;
+						if (this->stop && q.pinned.empty() && q.tasks.empty() && !this->numPending.load()) return;
+						continue;
 					}
 
-					//std::cout << "Start #" << i << std::endl;
+					if (this->maxQueued)
+					{
+						std::lock_guard<std::mutex> lock(this->input_mutex);
+						this->inputCnd.notify_all();
+					}
+
+					const auto start = std::chrono::steady_clock::now();
 					task(i);
-					//std::cout << "End #" << i << std::endl;
+					q.busyNanos.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+						std::memory_order_relaxed);
 				}
 			});
 		}
+
+#ifdef __linux__
+		for (size_t i = 0; i < threads && numaAware; ++i)
+		{
+			const size_t cpu = workerCpus[i];
+			cpu_set_t cpuset;
+			CPU_ZERO(&cpuset);
+			if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpuset);
+			if (cpu >= CPU_SETSIZE || pthread_setaffinity_np(workers[i].native_handle(), sizeof(cpu_set_t), &cpuset) != 0)
+			{
+				numaAware = false;
+				workerNodes.clear();
+			}
+		}
+#else
+		numaAware = false;
+		workerNodes.clear();
+#endif
+		bound.set_value();
 	}
 
 	// add new work item to the pool
@@ -96,18 +547,38 @@ namespace tomoto
 			std::bind(std::forward<F>(f), std::placeholders::_1, std::forward<Args>(args)...));
 
 		std::future<return_type> res = task->get_future();
+		if (maxQueued)
 		{
-			std::unique_lock<std::mutex> lock(queue_mutex);
+			std::unique_lock<std::mutex> lock(input_mutex);
+			inputCnd.wait(lock, [&]() { return numPending.load() < maxQueued; });
+		}
 
-			// don't allow enqueueing after stopping the pool
-			if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
-			if (maxQueued && shared_task.size() >= maxQueued)
+		const size_t n = numQueues;
+		if (!n) throw std::runtime_error("enqueue on ThreadPool without workers");
+
+		// prefer sleeping workers, otherwise distribute tasks in round-robin order
+		const size_t start = nextWorker++ % n;
+		size_t target = start;
+		for (size_t j = 0; j < n; ++j)
+		{
+			if (queues[(start + j) % n].sleeping.load())
 			{
-				inputCnd.wait(lock, [&]() { return shared_task.size() < maxQueued; });
+				target = (start + j) % n;
+				break;
 			}
-			shared_task.emplace([task](size_t id) { (*task)(id); });
 		}
-		condition.notify_one();
+		if (auto* tr = tracer)
+		{
+			const char* phase = tr->getPhase();
+			const int64_t queued = tr->now();
+			pushTask(target, [task, tr, phase, queued](size_t id)
+			{
+				const int64_t begin = tr->now();
+				(*task)(id);
+				tr->record(id + 1, phase, "task", queued, begin, tr->now());
+			}, false);
+		}
+		else pushTask(target, [task](size_t id) { (*task)(id); }, false);
 		return res;
 	}
 
@@ -118,33 +589,213 @@ namespace tomoto
 		using return_type = typename std::result_of<F(size_t, Args...)>::type;
 
 		std::vector<std::future<return_type> > ret;
-		std::unique_lock<std::mutex> lock(queue_mutex);
 		for (size_t i = 0; i < workers.size(); ++i)
 		{
 			auto task = std::make_shared< std::packaged_task<return_type(size_t)> >(
 				std::bind(f, std::placeholders::_1, args...));
 
 			ret.emplace_back(task->get_future());
-
+			if (auto* tr = tracer)
 			{
-				// don't allow enqueueing after stopping the pool
-				if (stop) throw std::runtime_error("enqueue on stopped ThreadPool");
-				tasks[i].emplace([task](size_t id) { (*task)(id); });
+				const char* phase = tr->getPhase();
+				const int64_t queued = tr->now();
+				pushTask(i, [task, tr, phase, queued](size_t id)
+				{
+					const int64_t begin = tr->now();
+					(*task)(id);
+					tr->record(id + 1, phase, "task", queued, begin, tr->now());
+				}, true);
 			}
+			else pushTask(i, [task](size_t id) { (*task)(id); }, true);
 		}
-		condition.notify_all();
 		return ret;
 	}
 
 	// the destructor joins all threads
 	inline ThreadPool::~ThreadPool()
 	{
+		stop = true;
+		for (size_t i = 0; i < workers.size(); ++i)
 		{
-			std::unique_lock<std::mutex> lock(queue_mutex);
-			stop = true;
+			// taking the lock prevents the worker from missing the notification
+			{
+				std::lock_guard<std::mutex> lock(queues[i].mutex);
+			}
+			queues[i].condition.notify_all();
 		}
-		condition.notify_all();
 		for (std::thread &worker : workers)
 			worker.join();
 	}
+
+	/*
+	A process-wide registry of pools shared by inference and auxiliary computations.
+	`borrow` hands out an idle pool with the requested number of workers if any, otherwise it creates a new one.
+	The workers of all the pools, borrowed or idle, are limited to `getMaxWorkers()`:
+	idle pools are destroyed to make room for a new one, and a request exceeding the remaining room gets fewer workers (but at least one),
+	so callers should rely on `getNumWorkers()` of the borrowed pool rather than on the requested number.
+	Pools are returned when their `Lease` is destroyed.
+	*/
+	class PoolManager
+	{
+	public:
+		class Lease
+		{
+			friend class PoolManager;
+			std::unique_ptr<ThreadPool> pool;
+			size_t maxQueued = 0;
+
+			Lease(std::unique_ptr<ThreadPool>&& _pool, size_t _maxQueued)
+				: pool{ std::move(_pool) }, maxQueued{ _maxQueued }
+			{
+			}
+		public:
+			Lease() = default;
+			Lease(Lease&&) = default;
+			Lease& operator=(Lease&& o)
+			{
+				release();
+				pool = std::move(o.pool);
+				maxQueued = o.maxQueued;
+				return *this;
+			}
+			~Lease() { release(); }
+
+			ThreadPool& operator*() const { return *pool; }
+			ThreadPool* operator->() const { return pool.get(); }
+			ThreadPool* get() const { return pool.get(); }
+			explicit operator bool() const { return !!pool; }
+
+			void release()
+			{
+				if (pool) PoolManager::getInstance().giveBack(std::move(pool), maxQueued);
+			}
+		};
+
+		static PoolManager& getInstance()
+		{
+			return *instanceSlot();
+		}
+
+		/*
+		makes `getInstance` return `inst` from now on.
+		Modules built separately have their own copy of this class, so they share the instance of the main module by this.
+		It should be called before any pool is borrowed.
+		*/
+		static void share(PoolManager& inst)
+		{
+			instanceSlot() = &inst;
+		}
+
+		Lease borrow(size_t numWorkers, size_t maxQueued = 0);
+
+		// 0 means the number of hardware threads
+		void setMaxWorkers(size_t n);
+		size_t getMaxWorkers() const
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			return maxWorkers;
+		}
+
+		// the number of workers of all live pools, including idle ones
+		size_t getNumLiveWorkers() const
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			return liveWorkers;
+		}
+
+	private:
+		PoolManager() : maxWorkers{ defaultMaxWorkers() } {}
+
+		static PoolManager*& instanceSlot()
+		{
+			static PoolManager inst;
+			static PoolManager* cur = &inst;
+			return cur;
+		}
+
+		static size_t defaultMaxWorkers() { return std::max(std::thread::hardware_concurrency(), 1u); }
+
+		// destroys idle pools until `need` more workers fit into the cap. Destroyed pools are moved into `trash` to be joined outside the lock.
+		void evictIdle(size_t need, std::vector<std::unique_ptr<ThreadPool>>& trash);
+		void giveBack(std::unique_ptr<ThreadPool>&& pool, size_t maxQueued);
+
+		mutable std::mutex mutex;
+		size_t maxWorkers;
+		size_t liveWorkers = 0, idleWorkers = 0;
+		// idle pools with their `maxQueued`, the most recently returned one last
+		std::vector<std::pair<size_t, std::unique_ptr<ThreadPool>>> idle;
+	};
+
+	inline void PoolManager::evictIdle(size_t need, std::vector<std::unique_ptr<ThreadPool>>& trash)
+	{
+		// the least recently returned pools go first
+		size_t i = 0;
+		for (; i < idle.size() && liveWorkers + need > maxWorkers; ++i)
+		{
+			const size_t n = idle[i].second->getNumWorkers();
+			liveWorkers -= n;
+			idleWorkers -= n;
+			trash.emplace_back(std::move(idle[i].second));
+		}
+		idle.erase(idle.begin(), idle.begin() + i);
+	}
+
+	inline PoolManager::Lease PoolManager::borrow(size_t numWorkers, size_t maxQueued)
+	{
+		std::vector<std::unique_ptr<ThreadPool>> trash;
+		std::unique_lock<std::mutex> lock{ mutex };
+		const size_t busy = liveWorkers - idleWorkers;
+		const size_t grant = std::max(std::min(numWorkers, maxWorkers > busy ? maxWorkers - busy : (size_t)0), (size_t)1);
+		for (size_t i = idle.size(); i-- > 0;)
+		{
+			if (idle[i].first != maxQueued || idle[i].second->getNumWorkers() != grant) continue;
+			auto pool = std::move(idle[i].second);
+			idle.erase(idle.begin() + i);
+			idleWorkers -= grant;
+			return Lease{ std::move(pool), maxQueued };
+		}
+
+		evictIdle(grant, trash);
+		liveWorkers += grant;
+		lock.unlock();
+		try
+		{
+			return Lease{ std::make_unique<ThreadPool>(grant, maxQueued), maxQueued };
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> relock{ mutex };
+			liveWorkers -= grant;
+			throw;
+		}
+	}
+
+	inline void PoolManager::giveBack(std::unique_ptr<ThreadPool>&& pool, size_t maxQueued)
+	{
+		std::vector<std::unique_ptr<ThreadPool>> trash;
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			const size_t n = pool->getNumWorkers();
+			if (liveWorkers > maxWorkers)
+			{
+				// the cap has been lowered or exceeded by minimal grants, so the pool is dropped
+				liveWorkers -= n;
+				trash.emplace_back(std::move(pool));
+			}
+			else
+			{
+				idleWorkers += n;
+				idle.emplace_back(maxQueued, std::move(pool));
+			}
+		}
+	}
+
+	inline void PoolManager::setMaxWorkers(size_t n)
+	{
+		std::vector<std::unique_ptr<ThreadPool>> trash;
+		std::lock_guard<std::mutex> lock{ mutex };
+		maxWorkers = n ? n : defaultMaxWorkers();
+		evictIdle(0, trash);
+	}
 }
+
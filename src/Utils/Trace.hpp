@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+#include <vector>
+
+namespace tomoto
+{
+	/*
+	Spans of the caller thread and of the tasks of a `ThreadPool`, written in the Chrome trace event format
+	which chrome://tracing and Perfetto (ui.perfetto.dev) open.
+	The caller is thread 0 and the `i`-th worker of the pool is thread `i + 1`. Each thread appends only to its own buffer, so recording takes no lock.
+	Tasks are named after the phase set by `setPhase` when they are enqueued, and also record how long they waited to be started.
+	*/
+	class TraceRecorder
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		struct Event
+		{
+			const char* name;
+			const char* cat;
+			int64_t queued, begin, end; // in nanoseconds since the recorder was created. `queued` is -1 for spans not queued
+		};
+
+		explicit TraceRecorder(size_t numWorkers) : origin{ Clock::now() }, threads(numWorkers + 1)
+		{
+		}
+
+		int64_t toNanos(Clock::time_point t) const
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(t - origin).count();
+		}
+
+		int64_t now() const
+		{
+			return toNanos(Clock::now());
+		}
+
+		// `name` and `cat` should live as long as the recorder, like string literals, since only the pointers are kept
+		void record(size_t thread, const char* name, const char* cat, int64_t queued, int64_t begin, int64_t end)
+		{
+			if (thread < threads.size()) threads[thread].events.emplace_back(Event{ name, cat, queued, begin, end });
+		}
+
+		void setPhase(const char* name)
+		{
+			phase.store(name, std::memory_order_relaxed);
+		}
+
+		const char* getPhase() const
+		{
+			return phase.load(std::memory_order_relaxed);
+		}
+
+		size_t getNumEvents() const
+		{
+			size_t n = 0;
+			for (auto& t : threads) n += t.events.size();
+			return n;
+		}
+
+		// it should be called after all the recording threads are done
+		void writeChromeTrace(std::ostream& ostr) const
+		{
+			char buf[256];
+			ostr << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+			for (size_t t = 0; t < threads.size(); ++t)
+			{
+				if (t) std::snprintf(buf, sizeof(buf), ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"worker %zu\"}}", t, t - 1);
+				else std::snprintf(buf, sizeof(buf), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"caller\"}}");
+				ostr << buf;
+			}
+			for (size_t t = 0; t < threads.size(); ++t)
+			{
+				for (auto& e : threads[t].events)
+				{
+					// timestamps are in microseconds
+					int n = std::snprintf(buf, sizeof(buf), ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f",
+						e.name, e.cat, t, e.begin * 1e-3, (e.end - e.begin) * 1e-3);
+					ostr.write(buf, n);
+					if (e.queued >= 0)
+					{
+						n = std::snprintf(buf, sizeof(buf), ",\"args\":{\"wait_us\":%.3f}", (e.begin - e.queued) * 1e-3);
+						ostr.write(buf, n);
+					}
+					ostr << '}';
+				}
+			}
+			ostr << "]}";
+		}
+
+	private:
+		// padded so that the buffers of different threads don't share a cache line
+		struct ThreadEvents
+		{
+			std::vector<Event> events;
+			char pad[64 - sizeof(std::vector<Event>) % 64];
+		};
+
+		Clock::time_point origin;
+		std::vector<ThreadEvents> threads;
+		std::atomic<const char*> phase{ "task" };
+	};
+}
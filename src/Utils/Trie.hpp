@@ -4,6 +4,7 @@
 #include <deque>
 #include <functional>
 #include <iterator>
+#include <algorithm>
 #include "serializer.hpp"
 
 namespace tomoto
@@ -273,4 +274,129 @@ namespace tomoto
 			return (TrieEx*)this + parent;
 		}
 	};
-}
\ No newline at end of file
+
+	/*
+	Read-only copy of a Trie with its failure links, whose nodes are stored in breadth-first order
+	and whose children are kept in flat arrays sorted by key.
+	The children of the root, which are looked up most often, are indexed directly by the key if they are dense enough.
+	It is intended for Aho-Corasick matching over a large corpus with a fixed set of patterns.
+	*/
+	template<class _Key, class _Value>
+	class FrozenTrie
+	{
+	public:
+		static constexpr uint32_t npos = (uint32_t)-1;
+
+		struct Node
+		{
+			uint32_t firstChild = 0, numChildren = 0;
+			uint32_t fail = npos;
+			uint32_t depth = 0;
+			_Value val = {};
+		};
+
+	private:
+		std::vector<Node> nodes;
+		std::vector<_Key> childKeys;
+		std::vector<uint32_t> childNodes;
+		std::vector<uint32_t> rootNext; // empty if the children of the root are not dense
+
+	public:
+		FrozenTrie() = default;
+
+		// `root` should have its failure links filled by `fillFail()`
+		template<class _Trie>
+		explicit FrozenTrie(const _Trie& root)
+		{
+			std::unordered_map<const _Trie*, uint32_t> index;
+			std::vector<const _Trie*> order{ &root };
+			index.emplace(&root, 0);
+			std::vector<std::pair<_Key, const _Trie*>> children;
+			for (size_t i = 0; i < order.size(); ++i)
+			{
+				children.clear();
+				for (auto p : *order[i])
+				{
+					if (p.second != order[i]) children.emplace_back(p.first, p.second);
+				}
+				std::sort(children.begin(), children.end(), [](const std::pair<_Key, const _Trie*>& a, const std::pair<_Key, const _Trie*>& b)
+				{
+					return a.first < b.first;
+				});
+
+				Node n;
+				n.firstChild = (uint32_t)childKeys.size();
+				n.numChildren = (uint32_t)children.size();
+				n.depth = order[i]->depth;
+				n.val = order[i]->val;
+				nodes.emplace_back(n);
+				for (auto& c : children)
+				{
+					index.emplace(c.second, (uint32_t)order.size());
+					childKeys.emplace_back(c.first);
+					childNodes.emplace_back((uint32_t)order.size());
+					order.emplace_back(c.second);
+				}
+			}
+
+			for (size_t i = 0; i < order.size(); ++i)
+			{
+				auto f = order[i]->getFail();
+				if (f) nodes[i].fail = index[f];
+			}
+
+			const auto& r = nodes[0];
+			if (r.numChildren)
+			{
+				size_t maxKey = (size_t)childKeys[r.firstChild + r.numChildren - 1];
+				if (maxKey < (size_t)r.numChildren * 16 + 1024)
+				{
+					rootNext.resize(maxKey + 1, npos);
+					for (size_t i = 0; i < r.numChildren; ++i)
+					{
+						rootNext[childKeys[r.firstChild + i]] = childNodes[r.firstChild + i];
+					}
+				}
+			}
+		}
+
+		size_t size() const
+		{
+			return nodes.size();
+		}
+
+		const Node& operator[](uint32_t node) const
+		{
+			return nodes[node];
+		}
+
+		// returns the child of `node` for `key` or `npos` if it does not exist
+		uint32_t getNext(uint32_t node, _Key key) const
+		{
+			if (node == 0 && !rootNext.empty())
+			{
+				return (size_t)key < rootNext.size() ? rootNext[key] : npos;
+			}
+
+			auto& n = nodes[node];
+			auto first = childKeys.begin() + n.firstChild, last = first + n.numChildren;
+			if (n.numChildren <= 8)
+			{
+				for (auto it = first; it != last; ++it)
+				{
+					if (*it == key) return childNodes[it - childKeys.begin()];
+				}
+				return npos;
+			}
+			auto it = std::lower_bound(first, last, key);
+			if (it == last || *it != key) return npos;
+			return childNodes[it - childKeys.begin()];
+		}
+
+		// returns the failure link of `node` or `npos` if `node` is the root
+		uint32_t getFail(uint32_t node) const
+		{
+			return nodes[node].fail;
+		}
+	};
+}
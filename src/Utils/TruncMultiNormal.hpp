@@ -18,7 +18,7 @@ namespace tomoto
 		)
 		{
 			const size_t K = ret.size();
-			Eigen::Matrix<_Ty, -1, -1> l = multiNormal.getCovL();
+			const auto& l = multiNormal.getCovL();
 			ret = (lowerBound + upperBound) / 2;
 			Eigen::Matrix<_Ty, -1, 1> z = l.template triangularView<Eigen::Lower>().solve(ret - multiNormal.mean),
 				a = lowerBound - multiNormal.mean,
@@ -26,16 +26,20 @@ namespace tomoto
 				t, at, bt;
 			for (size_t i = 0; i < burnIn; ++i)
 			{
+				// `t = l * z` is kept up to date with rank-1 updates instead of being recomputed for every coordinate.
+				// Since `l` is lower triangular, coordinate `j` only touches the rows from `j`.
+				t = l.template triangularView<Eigen::Lower>() * z;
 				for (size_t j = 0; j < K; ++j)
 				{
-					auto lj = l.col(j);
+					const size_t n = K - j;
+					auto lj = l.col(j).tail(n);
+					t.tail(n) -= lj * z[j];
 					z[j] = 0;
-					t = l * z;
 					_Ty lower_pos = -INFINITY, upper_pos = INFINITY,
 						lower_neg = -INFINITY, upper_neg = INFINITY;
-					at = ((a - t).array() / lj.array()).matrix();
-					bt = ((b - t).array() / lj.array()).matrix();
-					for (size_t k = 0; k < K; ++k)
+					at = ((a.tail(n) - t.tail(n)).array() / lj.array()).matrix();
+					bt = ((b.tail(n) - t.tail(n)).array() / lj.array()).matrix();
+					for (size_t k = 0; k < n; ++k)
 					{
 						if (lj[k] > 0)
 						{
@@ -60,6 +64,7 @@ namespace tomoto
 					{
 						z[j] = (_Ty)rtnorm::rtnorm(rng, lower_pos, upper_pos);
 					}
+					t.tail(n) += lj * z[j];
 				}
 			}
 			ret = (l * z) + multiNormal.mean;
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <iterator>
 
 namespace tomoto
@@ -154,6 +155,41 @@ namespace tomoto
 		return ret;
 	}
 
+	/*
+	same as updateCnt, but `val` may be updated by other threads at the same time.
+	It uses relaxed ordering, since counts are only required not to lose any update.
+	*/
+	template<bool _Dec, typename _Ty> _Ty atomicUpdateCnt(_Ty& val, _Ty inc)
+	{
+		static_assert(sizeof(std::atomic<_Ty>) == sizeof(_Ty), "std::atomic<_Ty> should have the same layout as _Ty");
+		auto& a = reinterpret_cast<std::atomic<_Ty>&>(val);
+		_Ty old = a.load(std::memory_order_relaxed), next;
+		do
+		{
+			next = _Dec ? std::max(old + inc, (_Ty)0) : old + inc;
+		} while (!a.compare_exchange_weak(old, next, std::memory_order_relaxed));
+		return next;
+	}
+
+	template<typename _Ty> _Ty atomicLoad(const _Ty& val)
+	{
+		return reinterpret_cast<const std::atomic<_Ty>&>(val).load(std::memory_order_relaxed);
+	}
+
+	/*
+	`atomicStoreRelease` publishes the data written before it to the threads which read `val` by `atomicLoadAcquire`.
+	They are used as the flags of the caches built lazily by one thread and read by the others without a lock.
+	*/
+	template<typename _Ty> _Ty atomicLoadAcquire(const _Ty& val)
+	{
+		return reinterpret_cast<const std::atomic<_Ty>&>(val).load(std::memory_order_acquire);
+	}
+
+	template<typename _Ty> void atomicStoreRelease(_Ty& val, _Ty newVal)
+	{
+		reinterpret_cast<std::atomic<_Ty>&>(val).store(newVal, std::memory_order_release);
+	}
+
 	template<class UnaryFunction>
 	UnaryFunction forShuffled(size_t N, size_t seed, UnaryFunction f)
 	{
@@ -0,0 +1,106 @@
+#pragma once
+#include <cmath>
+#include "avx512_mathfun.h"
+
+// approximation : lgamma(z) ~= (z+2.5)ln(z+3) - z - 3 + 0.5 ln (2pi) + 1/12/(z + 3) - ln (z(z+1)(z+2))
+inline __m512 lgamma_ps(__m512 x)
+{
+	__m512 x_3 = _mm512_add_ps(x, _mm512_set1_ps(3));
+	__m512 ret = _mm512_mul_ps(_mm512_add_ps(x_3, _mm512_set1_ps(-0.5f)), log_ps(x_3));
+	ret = _mm512_sub_ps(ret, x_3);
+	ret = _mm512_add_ps(ret, _mm512_set1_ps(0.91893853f));
+	ret = _mm512_add_ps(ret, _mm512_div_ps(_mm512_set1_ps(1 / 12.f), x_3));
+	ret = _mm512_sub_ps(ret, log_ps(_mm512_mul_ps(
+		_mm512_mul_ps(_mm512_sub_ps(x_3, _mm512_set1_ps(1)), _mm512_sub_ps(x_3, _mm512_set1_ps(2))), x)));
+	return ret;
+}
+
+// approximation : lgamma(z + a) - lgamma(z) = (z + a + 1.5) * log(z + a + 2) - (z + 1.5) * log(z + 2) - a + (1. / (z + a + 2) - 1. / (z + 2)) / 12. - log(((z + a) * (z + a + 1)) / (z * (z + 1)))
+inline __m512 lgamma_subt(__m512 z, __m512 a)
+{
+	__m512 _1p5 = _mm512_set1_ps(1.5);
+	__m512 _2 = _mm512_set1_ps(2);
+	__m512 za = _mm512_add_ps(z, a);
+	__m512 ret = _mm512_mul_ps(_mm512_add_ps(za, _1p5), log_ps(_mm512_add_ps(za, _2)));
+	ret = _mm512_sub_ps(ret, _mm512_mul_ps(_mm512_add_ps(z, _1p5), log_ps(_mm512_add_ps(z, _2))));
+	ret = _mm512_sub_ps(ret, a);
+	__m512 _1 = _mm512_set1_ps(1);
+	__m512 _1_12 = _mm512_set1_ps(1 / 12.f);
+	ret = _mm512_add_ps(ret, _mm512_sub_ps(_mm512_div_ps(_1_12, _mm512_add_ps(za, _2)), _mm512_div_ps(_1_12, _mm512_add_ps(z, _2))));
+	ret = _mm512_sub_ps(ret, log_ps(_mm512_div_ps(_mm512_div_ps(_mm512_mul_ps(za, _mm512_add_ps(za, _1)), z), _mm512_add_ps(z, _1))));
+	return ret;
+}
+
+
+// approximation : digamma(z) ~= ln(z+4) - 1/2/(z+4) - 1/12/(z+4)^2 - 1/z - 1/(z+1) - 1/(z+2) - 1/(z+3)
+inline __m512 digamma_ps(__m512 x)
+{
+	__m512 x_4 = _mm512_add_ps(x, _mm512_set1_ps(4));
+	__m512 ret = log_ps(x_4);
+	ret = _mm512_sub_ps(ret, _mm512_div_ps(_mm512_set1_ps(1 / 2.f), x_4));
+	ret = _mm512_sub_ps(ret, _mm512_div_ps(_mm512_div_ps(_mm512_set1_ps(1 / 12.f), x_4), x_4));
+	ret = _mm512_sub_ps(ret, _mm512_rcp14_ps(_mm512_sub_ps(x_4, _mm512_set1_ps(1))));
+	ret = _mm512_sub_ps(ret, _mm512_rcp14_ps(_mm512_sub_ps(x_4, _mm512_set1_ps(2))));
+	ret = _mm512_sub_ps(ret, _mm512_rcp14_ps(_mm512_sub_ps(x_4, _mm512_set1_ps(3))));
+	ret = _mm512_sub_ps(ret, _mm512_rcp14_ps(_mm512_sub_ps(x_4, _mm512_set1_ps(4))));
+	return ret;
+}
+
+/*
+looks up `_Lut`, an instance of `tomoto::math::detail::LUT3`, for 16 lanes at once with gathers, which gives the same values as `_Lut::get`.
+Lanes over the table are computed by `large`, and the other lanes out of the table (small, negative or non-finite ones) by `_Lut::get` one by one.
+*/
+template<typename _Lut, typename _Large>
+inline __m512 lut3_ps(__m512 x, _Large&& large)
+{
+	const float* table = _Lut::getInst().data();
+	const __m512 end0 = _mm512_set1_ps(_Lut::segN * _Lut::stepP), end1 = _mm512_set1_ps(_Lut::segN * _Lut::stepP + _Lut::segM * _Lut::stepQ);
+	const __mmask16 inSeg0 = _mm512_cmp_ps_mask(x, end0, _CMP_LT_OQ), inSeg1 = _mm512_cmp_ps_mask(x, end1, _CMP_LT_OQ);
+	const __m512 base = _mm512_mask_blend_ps(inSeg0, _mm512_mask_blend_ps(inSeg1, end1, end0), _mm512_setzero_ps());
+	const __m512 step = _mm512_mask_blend_ps(inSeg0, _mm512_mask_blend_ps(inSeg1, _mm512_set1_ps(_Lut::stepR), _mm512_set1_ps(_Lut::stepQ)), _mm512_set1_ps(_Lut::stepP));
+	const __m512 offset = _mm512_mask_blend_ps(inSeg0, _mm512_mask_blend_ps(inSeg1, _mm512_set1_ps((float)(_Lut::segN + _Lut::segM)), _mm512_set1_ps((float)_Lut::segN)), _mm512_setzero_ps());
+
+	const __m512 nx = _mm512_sub_ps(x, base);
+	const __m512 fidx = _mm512_roundscale_ps(_mm512_div_ps(nx, step), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+	const __m512 a = _mm512_div_ps(_mm512_sub_ps(nx, _mm512_mul_ps(fidx, step)), step);
+	// NaN fails both comparisons, so it is not in the table
+	const __mmask16 inTable = _mm512_cmp_ps_mask(x, _mm512_set1_ps(_Lut::Func::smallThreshold), _CMP_GE_OQ) 
+		& _mm512_cmp_ps_mask(x, _mm512_set1_ps(_Lut::tableEnd), _CMP_LT_OQ);
+	// lanes out of the table read the first entry, so that every gather stays in the table
+	const __m512i idx = _mm512_maskz_cvttps_epi32(inTable, _mm512_add_ps(fidx, offset));
+	const __m512 p0 = _mm512_i32gather_ps(idx, table, 4), p1 = _mm512_i32gather_ps(idx, table + 1, 4);
+	__m512 ret = _mm512_add_ps(p0, _mm512_mul_ps(a, _mm512_sub_ps(p1, p0)));
+
+	const __mmask16 isLarge = _mm512_cmp_ps_mask(x, _mm512_set1_ps(_Lut::tableEnd), _CMP_GE_OQ)
+		& _mm512_cmp_ps_mask(x, _mm512_set1_ps(INFINITY), _CMP_LT_OQ);
+	if (isLarge) ret = _mm512_mask_blend_ps(isLarge, ret, large(x));
+	const __mmask16 covered = inTable | isLarge;
+	if (covered != 0xFFFF)
+	{
+		alignas(64) float xs[16], rs[16];
+		_mm512_store_ps(xs, x);
+		_mm512_store_ps(rs, ret);
+		for (int i = 0; i < 16; ++i)
+		{
+			if (!(covered & (1 << i))) rs[i] = _Lut::get(xs[i]);
+		}
+		ret = _mm512_load_ps(rs);
+	}
+	return ret;
+}
+
+// lgamma(x) ~= (x - 0.5) ln(x) - x + 0.5 ln(2pi) + 1/12/x, which `LUT_lgamma` uses over its table
+inline __m512 lgamma_large_ps(__m512 x)
+{
+	__m512 ret = _mm512_mul_ps(_mm512_sub_ps(x, _mm512_set1_ps(0.5f)), log_ps(x));
+	ret = _mm512_sub_ps(ret, x);
+	ret = _mm512_add_ps(ret, _mm512_set1_ps(0.91893853f));
+	return _mm512_add_ps(ret, _mm512_div_ps(_mm512_set1_ps(1 / 12.f), x));
+}
+
+// digamma(x) ~= ln(x) - 1/2/x - 1/12/x^2, which `LUT_digamma` uses over its table
+inline __m512 digamma_large_ps(__m512 x)
+{
+	__m512 ret = _mm512_sub_ps(log_ps(x), _mm512_div_ps(_mm512_set1_ps(0.5f), x));
+	return _mm512_sub_ps(ret, _mm512_div_ps(_mm512_set1_ps(1 / 12.f), _mm512_mul_ps(x, x)));
+}
@@ -0,0 +1,55 @@
+#pragma once
+/*
+AVX-512 implementation of log
+
+Port of log256_ps in "avx_mathfun.h", which is based on "sse_mathfun.h" by Julien Pommier
+(http://gruntthepeon.free.fr/ssemath/) and distributed under the zlib license.
+The exponent and the mantissa are extracted with getexp/getmant instead of integer shifts.
+*/
+
+#include <immintrin.h>
+
+inline __m512 log_ps(__m512 x)
+{
+	const __m512 one = _mm512_set1_ps(1.f);
+	__mmask16 invalid_mask = _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LE_OS);
+
+	/* cut off denormalized stuff */
+	x = _mm512_max_ps(x, _mm512_castsi512_ps(_mm512_set1_epi32(0x00800000)));
+
+	/* x = m * 2^e, m in [0.5, 1) */
+	__m512 e = _mm512_add_ps(_mm512_getexp_ps(x), one);
+	x = _mm512_getmant_ps(x, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_zero);
+
+	/* part2:
+	if( x < SQRTHF ) {
+	e -= 1;
+	x = x + x - 1.0;
+	} else { x = x - 1.0; }
+	*/
+	__mmask16 mask = _mm512_cmp_ps_mask(x, _mm512_set1_ps(0.707106781186547524f), _CMP_LT_OS);
+	e = _mm512_mask_sub_ps(e, mask, e, one);
+	x = _mm512_mask_add_ps(x, mask, x, x);
+	x = _mm512_sub_ps(x, one);
+
+	__m512 z = _mm512_mul_ps(x, x);
+
+	__m512 y = _mm512_set1_ps(7.0376836292E-2f);
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(-1.1514610310E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(1.1676998740E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(-1.2420140846E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(+1.4249322787E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(-1.6668057665E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(+2.0000714765E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(-2.4999993993E-1f));
+	y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(+3.3333331174E-1f));
+	y = _mm512_mul_ps(y, x);
+	y = _mm512_mul_ps(y, z);
+
+	y = _mm512_fmadd_ps(e, _mm512_set1_ps(-2.12194440e-4f), y);
+	y = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), y);
+
+	x = _mm512_add_ps(x, y);
+	x = _mm512_fmadd_ps(e, _mm512_set1_ps(0.693359375f), x);
+	return _mm512_mask_mov_ps(x, invalid_mask, _mm512_set1_ps(NAN)); // negative arg will be NAN
+}
@@ -44,3 +44,62 @@ inline __m256 digamma_ps(__m256 x)
 	ret = _mm256_sub_ps(ret, _mm256_rcp_ps(_mm256_sub_ps(x_4, _mm256_set1_ps(4))));
 	return ret;
 }
+
+#ifdef __AVX2__
+/*
+looks up `_Lut`, an instance of `tomoto::math::detail::LUT3`, for 8 lanes at once with gathers, which gives the same values as `_Lut::get`.
+Lanes over the table are computed by `large`, and the other lanes out of the table (small, negative or non-finite ones) by `_Lut::get` one by one.
+*/
+template<typename _Lut, typename _Large>
+inline __m256 lut3_ps(__m256 x, _Large&& large)
+{
+	const float* table = _Lut::getInst().data();
+	const __m256 end0 = _mm256_set1_ps(_Lut::segN * _Lut::stepP), end1 = _mm256_set1_ps(_Lut::segN * _Lut::stepP + _Lut::segM * _Lut::stepQ);
+	const __m256 inSeg0 = _mm256_cmp_ps(x, end0, _CMP_LT_OQ), inSeg1 = _mm256_cmp_ps(x, end1, _CMP_LT_OQ);
+	const __m256 base = _mm256_blendv_ps(_mm256_blendv_ps(end1, end0, inSeg1), _mm256_setzero_ps(), inSeg0);
+	const __m256 step = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_set1_ps(_Lut::stepR), _mm256_set1_ps(_Lut::stepQ), inSeg1), _mm256_set1_ps(_Lut::stepP), inSeg0);
+	const __m256 offset = _mm256_blendv_ps(_mm256_blendv_ps(_mm256_set1_ps((float)(_Lut::segN + _Lut::segM)), _mm256_set1_ps((float)_Lut::segN), inSeg1), _mm256_setzero_ps(), inSeg0);
+
+	const __m256 nx = _mm256_sub_ps(x, base);
+	const __m256 fidx = _mm256_floor_ps(_mm256_div_ps(nx, step));
+	const __m256 a = _mm256_div_ps(_mm256_sub_ps(nx, _mm256_mul_ps(fidx, step)), step);
+	// NaN fails both comparisons, so it is not in the table
+	const __m256 inTable = _mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(_Lut::Func::smallThreshold), _CMP_GE_OQ), _mm256_cmp_ps(x, _mm256_set1_ps(_Lut::tableEnd), _CMP_LT_OQ));
+	// lanes out of the table read the first entry, so that every gather stays in the table
+	const __m256i idx = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_add_ps(fidx, offset)), _mm256_castps_si256(inTable));
+	const __m256 p0 = _mm256_i32gather_ps(table, idx, 4), p1 = _mm256_i32gather_ps(table + 1, idx, 4);
+	__m256 ret = _mm256_add_ps(p0, _mm256_mul_ps(a, _mm256_sub_ps(p1, p0)));
+
+	const __m256 isLarge = _mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(_Lut::tableEnd), _CMP_GE_OQ), _mm256_cmp_ps(x, _mm256_set1_ps(INFINITY), _CMP_LT_OQ));
+	if (_mm256_movemask_ps(isLarge)) ret = _mm256_blendv_ps(ret, large(x), isLarge);
+	if (_mm256_movemask_ps(_mm256_or_ps(inTable, isLarge)) != 0xFF)
+	{
+		alignas(32) float xs[8], rs[8];
+		const int covered = _mm256_movemask_ps(_mm256_or_ps(inTable, isLarge));
+		_mm256_store_ps(xs, x);
+		_mm256_store_ps(rs, ret);
+		for (int i = 0; i < 8; ++i)
+		{
+			if (!(covered & (1 << i))) rs[i] = _Lut::get(xs[i]);
+		}
+		ret = _mm256_load_ps(rs);
+	}
+	return ret;
+}
+
+// lgamma(x) ~= (x - 0.5) ln(x) - x + 0.5 ln(2pi) + 1/12/x, which `LUT_lgamma` uses over its table
+inline __m256 lgamma_large_ps(__m256 x)
+{
+	__m256 ret = _mm256_mul_ps(_mm256_sub_ps(x, _mm256_set1_ps(0.5f)), log_ps(x));
+	ret = _mm256_sub_ps(ret, x);
+	ret = _mm256_add_ps(ret, _mm256_set1_ps(0.91893853f));
+	return _mm256_add_ps(ret, _mm256_div_ps(_mm256_set1_ps(1 / 12.f), x));
+}
+
+// digamma(x) ~= ln(x) - 1/2/x - 1/12/x^2, which `LUT_digamma` uses over its table
+inline __m256 digamma_large_ps(__m256 x)
+{
+	__m256 ret = _mm256_sub_ps(log_ps(x), _mm256_div_ps(_mm256_set1_ps(0.5f), x));
+	return _mm256_sub_ps(ret, _mm256_div_ps(_mm256_set1_ps(1 / 12.f), _mm256_mul_ps(x, x)));
+}
+#endif
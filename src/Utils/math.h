@@ -180,7 +180,7 @@ namespace tomoto
 		{
 			return log((z + a + 2) / (z + 2)) - (1 / (z + a + 2) - 1 / (z + 2)) / 2 - (1 / (z + a + 2) / (z + a + 2) - 1 / (z + 2) / (z + 2)) / 12
 				- 1. / (z + a) - 1. / (z + a + 1)
-				- 1. / z - 1. / (z + 1);
+				+ 1. / z + 1. / (z + 1);
 		}
 
 		template <typename RealType = double>
@@ -0,0 +1,62 @@
+#pragma once
+/*
+NEON implementation of log for aarch64
+
+Port of log_ps in "sse_mathfun.h" by Julien Pommier
+(http://gruntthepeon.free.fr/ssemath/), which is distributed under the zlib license.
+*/
+
+#include <arm_neon.h>
+
+inline float32x4_t log_ps(float32x4_t x)
+{
+	const float32x4_t one = vdupq_n_f32(1.f);
+	uint32x4_t invalid_mask = vcleq_f32(x, vdupq_n_f32(0));
+
+	/* cut off denormalized stuff */
+	x = vmaxq_f32(x, vreinterpretq_f32_u32(vdupq_n_u32(0x00800000u)));
+
+	int32x4_t ux = vreinterpretq_s32_f32(x);
+	float32x4_t e = vcvtq_f32_s32(vsubq_s32(vshrq_n_s32(ux, 23), vdupq_n_s32(0x7f)));
+
+	/* keep only the fractional part */
+	ux = vandq_s32(ux, vdupq_n_s32(~0x7f800000));
+	ux = vorrq_s32(ux, vreinterpretq_s32_f32(vdupq_n_f32(0.5f)));
+	x = vreinterpretq_f32_s32(ux);
+
+	e = vaddq_f32(e, one);
+
+	/* part2:
+	if( x < SQRTHF ) {
+	e -= 1;
+	x = x + x - 1.0;
+	} else { x = x - 1.0; }
+	*/
+	uint32x4_t mask = vcltq_f32(x, vdupq_n_f32(0.707106781186547524f));
+	float32x4_t tmp = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(x), mask));
+	x = vsubq_f32(x, one);
+	e = vsubq_f32(e, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(one), mask)));
+	x = vaddq_f32(x, tmp);
+
+	float32x4_t z = vmulq_f32(x, x);
+
+	float32x4_t y = vdupq_n_f32(7.0376836292E-2f);
+	y = vfmaq_f32(vdupq_n_f32(-1.1514610310E-1f), y, x);
+	y = vfmaq_f32(vdupq_n_f32(1.1676998740E-1f), y, x);
+	y = vfmaq_f32(vdupq_n_f32(-1.2420140846E-1f), y, x);
+	y = vfmaq_f32(vdupq_n_f32(+1.4249322787E-1f), y, x);
+	y = vfmaq_f32(vdupq_n_f32(-1.6668057665E-1f), y, x);
+	y = vfmaq_f32(vdupq_n_f32(+2.0000714765E-1f), y, x);
+	y = vfmaq_f32(vdupq_n_f32(-2.4999993993E-1f), y, x);
+	y = vfmaq_f32(vdupq_n_f32(+3.3333331174E-1f), y, x);
+	y = vmulq_f32(y, x);
+	y = vmulq_f32(y, z);
+
+	y = vfmaq_f32(y, e, vdupq_n_f32(-2.12194440e-4f));
+	y = vfmsq_f32(y, z, vdupq_n_f32(0.5f));
+
+	x = vaddq_f32(x, y);
+	x = vfmaq_f32(x, e, vdupq_n_f32(0.693359375f));
+	x = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(x), invalid_mask)); // negative arg will be NAN
+	return x;
+}
@@ -5,6 +5,8 @@
 #include <immintrin.h>
 #elif defined(__SSE2__) || defined(_WIN64)
 #include <xmmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
 #else
 
 #endif
@@ -56,7 +58,37 @@ namespace tomoto
 #endif
 
 
-#if defined(__SSE2__) || defined(_WIN64)
+#ifdef __AVX512F__
+		inline __m512 scan_AVX512(__m512 x)
+		{
+			const __m512i zero = _mm512_setzero_si512();
+			x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 16 - 1)));
+			x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 16 - 2)));
+			x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 16 - 4)));
+			x = _mm512_add_ps(x, _mm512_castsi512_ps(_mm512_alignr_epi32(_mm512_castps_si512(x), zero, 16 - 8)));
+			return x;
+		}
+
+		// unaligned loads are used because buffers are not always 64-byte aligned
+		inline void prefixSum(float* arr, int n)
+		{
+			int n16 = n & ~15;
+			__m512 offset = _mm512_setzero_ps();
+			for (int i = 0; i < n16; i += 16)
+			{
+				__m512 x = _mm512_loadu_ps(&arr[i]);
+				__m512 out = scan_AVX512(x);
+				out = _mm512_add_ps(out, offset);
+				_mm512_storeu_ps(&arr[i], out);
+				offset = _mm512_permutexvar_ps(_mm512_set1_epi32(15), out);
+			}
+			if (!n16) n16 = 1;
+			for (int i = n16; i < n; ++i)
+			{
+				arr[i] += arr[i - 1];
+			}
+		}
+#elif defined(__SSE2__) || defined(_WIN64)
 		inline __m128 scan_SSE(__m128 x)
 		{
 			x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
@@ -82,6 +114,33 @@ namespace tomoto
 				arr[i] += arr[i - 1];
 			}
 		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		inline float32x4_t scan_NEON(float32x4_t x)
+		{
+			const float32x4_t zero = vdupq_n_f32(0);
+			x = vaddq_f32(x, vextq_f32(zero, x, 3));
+			x = vaddq_f32(x, vextq_f32(zero, x, 2));
+			return x;
+		}
+
+		inline void prefixSum(float* arr, int n)
+		{
+			int n4 = n & ~3;
+			float32x4_t offset = vdupq_n_f32(0);
+			for (int i = 0; i < n4; i += 4)
+			{
+				float32x4_t x = vld1q_f32(&arr[i]);
+				float32x4_t out = scan_NEON(x);
+				out = vaddq_f32(out, offset);
+				vst1q_f32(&arr[i], out);
+				offset = vdupq_laneq_f32(out, 3);
+			}
+			if (!n4) n4 = 1;
+			for (int i = n4; i < n; ++i)
+			{
+				arr[i] += arr[i - 1];
+			}
+		}
 #else
 		inline void prefixSum(float* arr, int n)
 		{
@@ -115,6 +174,91 @@ namespace tomoto
 		}
 #endif
 
+		namespace detail
+		{
+#ifdef __AVX512F__
+			inline __m512 loadPacket16(const float* p) { return _mm512_loadu_ps(p); }
+			inline __m512 loadPacket16(const int32_t* p) { return _mm512_cvtepi32_ps(_mm512_loadu_si512(p)); }
+#elif defined(__AVX__)
+			inline __m256 loadPacket8(const float* p) { return _mm256_loadu_ps(p); }
+			inline __m256 loadPacket8(const int32_t* p) { return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)p)); }
+#elif defined(__SSE2__) || defined(_WIN64)
+			inline __m128 loadPacket4(const float* p) { return _mm_loadu_ps(p); }
+			inline __m128 loadPacket4(const int32_t* p) { return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)p)); }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+			inline float32x4_t loadPacket4(const float* p) { return vld1q_f32(p); }
+			inline float32x4_t loadPacket4(const int32_t* p) { return vcvtq_f32_s32(vld1q_s32(p)); }
+#endif
+		}
+
+		/*
+		writes the running sum of (a[i] + aOffset[i]) * (b[i] + bOffset) * c[i] into out[i] in a single pass,
+		which fuses the evaluation of unnormalized likelihoods and `prefixSum`.
+		*/
+		template<typename _A, typename _B>
+		inline void prefixSumOfProducts(float* out, const _A* a, const float* aOffset, const _B* b, float bOffset, const float* c, int n)
+		{
+			int i = 0;
+#ifdef __AVX512F__
+			const __m512 mb = _mm512_set1_ps(bOffset);
+			__m512 offset = _mm512_setzero_ps();
+			for (; i < (n & ~15); i += 16)
+			{
+				__m512 x = _mm512_add_ps(detail::loadPacket16(a + i), _mm512_loadu_ps(aOffset + i));
+				x = _mm512_mul_ps(x, _mm512_add_ps(detail::loadPacket16(b + i), mb));
+				x = _mm512_mul_ps(x, _mm512_loadu_ps(c + i));
+				x = _mm512_add_ps(scan_AVX512(x), offset);
+				_mm512_storeu_ps(out + i, x);
+				offset = _mm512_permutexvar_ps(_mm512_set1_epi32(15), x);
+			}
+#elif defined(__AVX__)
+			const __m256 mb = _mm256_set1_ps(bOffset);
+			__m128 offset = _mm_setzero_ps();
+			for (; i < (n & ~7); i += 8)
+			{
+				__m256 x = _mm256_add_ps(detail::loadPacket8(a + i), _mm256_loadu_ps(aOffset + i));
+				x = _mm256_mul_ps(x, _mm256_add_ps(detail::loadPacket8(b + i), mb));
+				x = _mm256_mul_ps(x, _mm256_loadu_ps(c + i));
+				__m128 lo = _mm_add_ps(scan_SSE(_mm256_castps256_ps128(x)), offset);
+				offset = _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(3, 3, 3, 3));
+				__m128 hi = _mm_add_ps(scan_SSE(_mm256_extractf128_ps(x, 1)), offset);
+				offset = _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(3, 3, 3, 3));
+				_mm_storeu_ps(out + i, lo);
+				_mm_storeu_ps(out + i + 4, hi);
+			}
+#elif defined(__SSE2__) || defined(_WIN64)
+			const __m128 mb = _mm_set1_ps(bOffset);
+			__m128 offset = _mm_setzero_ps();
+			for (; i < (n & ~3); i += 4)
+			{
+				__m128 x = _mm_add_ps(detail::loadPacket4(a + i), _mm_loadu_ps(aOffset + i));
+				x = _mm_mul_ps(x, _mm_add_ps(detail::loadPacket4(b + i), mb));
+				x = _mm_mul_ps(x, _mm_loadu_ps(c + i));
+				x = _mm_add_ps(scan_SSE(x), offset);
+				_mm_storeu_ps(out + i, x);
+				offset = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+			}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+			const float32x4_t mb = vdupq_n_f32(bOffset);
+			float32x4_t offset = vdupq_n_f32(0);
+			for (; i < (n & ~3); i += 4)
+			{
+				float32x4_t x = vaddq_f32(detail::loadPacket4(a + i), vld1q_f32(aOffset + i));
+				x = vmulq_f32(x, vaddq_f32(detail::loadPacket4(b + i), mb));
+				x = vmulq_f32(x, vld1q_f32(c + i));
+				x = vaddq_f32(scan_NEON(x), offset);
+				vst1q_f32(out + i, x);
+				offset = vdupq_laneq_f32(x, 3);
+			}
+#endif
+			float acc = i ? out[i - 1] : 0;
+			for (; i < n; ++i)
+			{
+				acc += (a[i] + aOffset[i]) * (b[i] + bOffset) * c[i];
+				out[i] = acc;
+			}
+		}
+
 		template<class RealIt, class Random>
 		inline size_t sampleFromDiscrete(RealIt begin, RealIt end, Random& rg)
 		{
@@ -134,7 +278,22 @@ namespace tomoto
 			auto r = rg.uniform_real() * *(end - 1);
 			size_t K = std::distance(begin, end);
 			size_t z = 0;
-#ifdef __AVX__
+#ifdef __AVX512F__
+			__m512 mr = _mm512_set1_ps(r);
+			uint32_t mask;
+			for (; z < (K >> 5) << 5; z += 32)
+			{
+				mask = _mm512_cmp_ps_mask(mr, _mm512_loadu_ps(&begin[z]), _CMP_LT_OQ);
+				if (mask) return z + 16 - popcnt(mask);
+				mask = _mm512_cmp_ps_mask(mr, _mm512_loadu_ps(&begin[z + 16]), _CMP_LT_OQ);
+				if (mask) return z + 32 - popcnt(mask);
+			}
+			for (; z < (K >> 4) << 4; z += 16)
+			{
+				mask = _mm512_cmp_ps_mask(mr, _mm512_loadu_ps(&begin[z]), _CMP_LT_OQ);
+				if (mask) return z + 16 - popcnt(mask);
+			}
+#elif defined(__AVX__)
 			__m256 mr = _mm256_set1_ps(r), mz;
 			int mask;
 			for (; z < (K >> 5) << 5; z += 32)
@@ -166,6 +325,13 @@ namespace tomoto
 				int mask = _mm_movemask_ps(_mm_cmplt_ps(mr, mz));
 				if (mask) return z + 4 - popcnt(mask);
 			}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+			float32x4_t mr = vdupq_n_f32(r);
+			for (; z < (K >> 2) << 2; z += 4)
+			{
+				uint32x4_t mask = vcltq_f32(mr, vld1q_f32(&begin[z]));
+				if (vmaxvq_u32(mask)) return z + 4 - vaddvq_u32(vshrq_n_u32(mask, 31));
+			}
 #else
 			for (; z < (K >> 3) << 3; z += 8)
 			{
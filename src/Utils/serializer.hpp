@@ -32,11 +32,20 @@ namespace tomoto
 	{
 		struct membuf : std::streambuf 
 		{
-			membuf(char* base, std::ptrdiff_t n) 
+			// if true, readers may keep pointers into the buffer instead of copying data from it
+			bool viewable;
+
+			membuf(char* base, std::ptrdiff_t n, bool _viewable = false) 
+				: viewable{ _viewable }
 			{
 				this->setg(base, base, base + n);
 			}
 
+			const char* current() const
+			{
+				return gptr();
+			}
+
 			pos_type seekpos(pos_type sp, std::ios_base::openmode which) override {
 				return seekoff(sp - pos_type(off_type(0)), std::ios_base::beg, which);
 			}
@@ -44,12 +53,15 @@ namespace tomoto
 			pos_type seekoff(off_type off,
 				std::ios_base::seekdir dir,
 				std::ios_base::openmode which = std::ios_base::in) override {
+				char* target = gptr();
 				if (dir == std::ios_base::cur)
-					gbump(off);
+					target = gptr() + off;
 				else if (dir == std::ios_base::end)
-					setg(eback(), egptr() + off, egptr());
+					target = egptr() + off;
 				else if (dir == std::ios_base::beg)
-					setg(eback(), eback() + off, egptr());
+					target = eback() + off;
+				if (target < eback() || target > egptr()) return pos_type(off_type(-1));
+				setg(eback(), target, egptr());
 				return gptr() - eback();
 			}
 		};
@@ -58,12 +70,101 @@ namespace tomoto
 		{
 			membuf buf;
 		public:
-			imstream(const char* base, std::ptrdiff_t n)
-				: std::istream(&buf), buf((char*)base, n)
+			imstream(const char* base, std::ptrdiff_t n, bool viewable = false)
+				: std::istream(&buf), buf((char*)base, n, viewable)
 			{
 			}
 		};
 
+		/*
+		It returns the pointer to the current reading position of `istr` 
+		if `istr` reads a viewable memory buffer which outlives the objects being read, otherwise nullptr.
+		*/
+		inline const char* getViewablePtr(std::istream& istr)
+		{
+			auto* buf = dynamic_cast<membuf*>(istr.rdbuf());
+			if (!buf || !buf->viewable) return nullptr;
+			return buf->current();
+		}
+
+		// alignment of the large array sections written into streams marked by `setAlignedSections`
+		static constexpr size_t sectionAlignment = 64;
+
+		/*
+		indices of the flags of streams allocated by `std::ios_base::xalloc`.
+		Modules built separately allocate their own ones, so they share the indices of the main module by assigning them.
+		*/
+		struct StreamFlagIndices
+		{
+			int alignedSections = std::ios_base::xalloc();
+			int compactArrays = std::ios_base::xalloc();
+			int rawTextColumns = std::ios_base::xalloc();
+		};
+
+		inline StreamFlagIndices& streamFlagIndices()
+		{
+			static StreamFlagIndices idx;
+			return idx;
+		}
+
+		inline int alignedSectionsIndex()
+		{
+			return streamFlagIndices().alignedSections;
+		}
+
+		/*
+		If it is set, large arrays are written with padding so that they start at an offset aligned to `sectionAlignment` 
+		and can be used in place when the file is memory-mapped.
+		Files written in this way cannot be read by versions prior to 0.12.3.
+		*/
+		inline void setAlignedSections(std::ios_base& str, bool aligned = true)
+		{
+			str.iword(alignedSectionsIndex()) = aligned;
+		}
+
+		inline bool isAlignedSections(std::ios_base& str)
+		{
+			return !!str.iword(alignedSectionsIndex());
+		}
+
+		inline int compactArraysIndex()
+		{
+			return streamFlagIndices().compactArrays;
+		}
+
+		/*
+		If it is set, arrays of word ids are written as varints and arrays of topic ids are bit-packed, see `Serializer<tvector<_Ty>>`.
+		Readers detect it by themselves. Files written in this way cannot be read by versions prior to 0.12.3.
+		*/
+		inline void setCompactArrays(std::ios_base& str, bool compact = true)
+		{
+			str.iword(compactArraysIndex()) = compact;
+		}
+
+		inline bool isCompactArrays(std::ios_base& str)
+		{
+			return !!str.iword(compactArraysIndex());
+		}
+
+		inline int rawTextColumnsIndex()
+		{
+			return streamFlagIndices().rawTextColumns;
+		}
+
+		/*
+		If it is set, documents don't write their raw texts and the spans of their words,
+		since the model writes those of all the documents at once as columns, see `RawTextColumns`.
+		*/
+		inline void setRawTextColumns(std::ios_base& str, bool columns = true)
+		{
+			str.iword(rawTextColumnsIndex()) = columns;
+		}
+
+		inline bool isRawTextColumns(std::ios_base& str)
+		{
+			return !!str.iword(rawTextColumnsIndex());
+		}
+
 		namespace detail
 		{
 			template<class _T> using Invoke = typename _T::type;
@@ -722,6 +823,41 @@ namespace tomoto
 			readTaggedMany(istr, version, std::forward<_Rest>(rest)...);
 		}
 
+		// the header of a tagged data read by `readTaggedDataHeader`
+		struct TaggedDataHeader
+		{
+			std::string key; // without the trailing zeros
+			uint32_t trailingCnt = 0;
+			std::streampos dataPos, endPos;
+		};
+
+		/*
+		reads the header of the tagged data at the position of `istr` and leaves `istr` at the start of its data.
+		Unlike `readTaggedData` it accepts any key, so that the reader can read only the data it needs and seek over the others.
+		It returns false with the position restored if no tagged data starts there.
+		*/
+		inline bool readTaggedDataHeader(std::istream& istr, TaggedDataHeader& header)
+		{
+			std::streampos start_pos = istr.tellg();
+			if (!readTest(istr, taggedDataKey))
+			{
+				istr.clear();
+				istr.seekg(start_pos);
+				return false;
+			}
+			uint32_t version, keysize;
+			uint64_t totsize;
+			readMany(istr, version);
+			std::streampos totsize_pos = istr.tellg();
+			readMany(istr, totsize, keysize, header.trailingCnt);
+			header.key.resize(keysize);
+			if (keysize && !istr.read(&header.key[0], keysize)) throw std::ios_base::failure("reading the key of tagged data is failed");
+			while (!header.key.empty() && !header.key.back()) header.key.pop_back();
+			header.dataPos = istr.tellg();
+			header.endPos = totsize_pos + (std::streamoff)totsize;
+			return true;
+		}
+
 		inline void writeTaggedMany(std::ostream& ostr, uint32_t version)
 		{
 			// do nothing
@@ -39,6 +39,58 @@ namespace tomoto
 			return stream.str();
 		}
 
+		// whitespaces of Python's `str.isspace()` and ASCII punctuations excluded by the default pattern of `tomotopy.utils.SimpleTokenizer`
+		inline bool isSimpleDelimiter(uint32_t c)
+		{
+			if (c < 0x80)
+			{
+				if ((c >= 0x09 && c <= 0x0D) || (c >= 0x1C && c <= 0x20)) return true;
+				static const char punct[] = ".,;:'\"?!<>(){}[]\\/`~@#$%^&*|";
+				return std::find(punct, punct + sizeof(punct) - 1, (char)c) != punct + sizeof(punct) - 1;
+			}
+			return c == 0x85 || c == 0xA0 || c == 0x1680 || (c >= 0x2000 && c <= 0x200A)
+				|| c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000;
+		}
+
+		/*
+		splits an UTF-8 string `raw` into tokens in the same way as `tomotopy.utils.SimpleTokenizer` with its default pattern
+		and calls `fn(token, pos, len)` for each token, whose position and length are counted in code points.
+		If `lowercase` is true, ASCII letters of tokens are lowercased.
+		*/
+		template<typename _Fn>
+		void tokenizeSimple(const std::string& raw, bool lowercase, _Fn&& fn)
+		{
+			std::string token;
+			uint32_t pos = 0, start = 0;
+			for (size_t i = 0; i < raw.size(); ++pos)
+			{
+				const uint8_t b = raw[i];
+				size_t n = 1;
+				uint32_t c = b;
+				if (b >= 0xF0) n = 4, c = b & 0x07;
+				else if (b >= 0xE0) n = 3, c = b & 0x0F;
+				else if (b >= 0xC0) n = 2, c = b & 0x1F;
+				for (size_t j = 1; j < n && i + j < raw.size(); ++j) c = (c << 6) | (raw[i + j] & 0x3F);
+
+				if (isSimpleDelimiter(c))
+				{
+					if (!token.empty())
+					{
+						fn(token, start, pos - start);
+						token.clear();
+					}
+				}
+				else
+				{
+					if (token.empty()) start = pos;
+					if (lowercase && c >= 'A' && c <= 'Z') token.push_back((char)(c + ('a' - 'A')));
+					else token.append(raw, i, n);
+				}
+				i += n;
+			}
+			if (!token.empty()) fn(token, start, pos - start);
+		}
+
 		inline std::vector<std::string> split(const std::string& str, const std::string& delim)
 		{
 			std::vector<std::string> tokens;
@@ -548,12 +548,130 @@ namespace tomoto
 
 	namespace serializer
 	{
+		// set on the size of an array written by `CompactArray`
+		static constexpr uint32_t compactArrayFlag = 0x80000000;
+
+		/*
+		encodings of arrays used for streams marked by `setCompactArrays`.
+		Only the arrays of word ids (`uint32_t`) and topic ids (`uint16_t`) have one, the others are written as is.
+		*/
+		template<typename _Ty>
+		struct CompactArray
+		{
+			static constexpr bool available = false;
+
+			static void write(std::ostream& ostr, const _Ty* data, size_t size)
+			{
+			}
+
+			static void read(std::istream& istr, _Ty* data, size_t size)
+			{
+				throw std::ios_base::failure(std::string("reading compact array of type '") + typeid(_Ty).name() + std::string("' is not supported"));
+			}
+		};
+
+		// word ids are written as LEB128 varints, since frequent words have small ids
+		template<>
+		struct CompactArray<uint32_t>
+		{
+			static constexpr bool available = true;
+
+			static void write(std::ostream& ostr, const uint32_t* data, size_t size)
+			{
+				std::vector<uint8_t> buf;
+				buf.reserve(size * 2);
+				for (size_t i = 0; i < size; ++i)
+				{
+					uint32_t v = data[i];
+					for (; v >= 0x80; v >>= 7) buf.emplace_back((uint8_t)(v | 0x80));
+					buf.emplace_back((uint8_t)v);
+				}
+				writeToStream(ostr, (uint64_t)buf.size());
+				if (!ostr.write((const char*)buf.data(), buf.size()))
+					throw std::ios_base::failure("writing compact array is failed");
+			}
+
+			static void read(std::istream& istr, uint32_t* data, size_t size)
+			{
+				auto n = readFromStream<uint64_t>(istr);
+				if (n < size || n > size * 5) throw std::ios_base::failure("broken compact array");
+				std::vector<uint8_t> buf(n);
+				if (!istr.read((char*)buf.data(), n))
+					throw std::ios_base::failure("reading compact array is failed");
+				size_t p = 0;
+				for (size_t i = 0; i < size; ++i)
+				{
+					uint32_t v = 0;
+					for (size_t shift = 0; ; shift += 7)
+					{
+						if (p >= n || shift > 28) throw std::ios_base::failure("broken compact array");
+						const uint8_t b = buf[p++];
+						v |= (uint32_t)(b & 0x7F) << shift;
+						if (!(b & 0x80)) break;
+					}
+					data[i] = v;
+				}
+				if (p != n) throw std::ios_base::failure("broken compact array");
+			}
+		};
+
+		// topic ids are bit-packed with the bit width of the largest one
+		template<>
+		struct CompactArray<uint16_t>
+		{
+			static constexpr bool available = true;
+
+			static void write(std::ostream& ostr, const uint16_t* data, size_t size)
+			{
+				const uint16_t maxV = size ? *std::max_element(data, data + size) : 0;
+				uint8_t bits = 0;
+				while (bits < 16 && (1u << bits) <= maxV) ++bits;
+				std::vector<uint8_t> buf((size * bits + 7) / 8);
+				uint64_t acc = 0;
+				size_t accBits = 0, p = 0;
+				for (size_t i = 0; i < size; ++i)
+				{
+					acc |= (uint64_t)data[i] << accBits;
+					for (accBits += bits; accBits >= 8; accBits -= 8, acc >>= 8) buf[p++] = (uint8_t)acc;
+				}
+				if (accBits) buf[p++] = (uint8_t)acc;
+				writeToStream(ostr, bits);
+				if (!ostr.write((const char*)buf.data(), buf.size()))
+					throw std::ios_base::failure("writing compact array is failed");
+			}
+
+			static void read(std::istream& istr, uint16_t* data, size_t size)
+			{
+				auto bits = readFromStream<uint8_t>(istr);
+				if (bits > 16) throw std::ios_base::failure("broken compact array");
+				std::vector<uint8_t> buf((size * bits + 7) / 8);
+				if (!istr.read((char*)buf.data(), buf.size()))
+					throw std::ios_base::failure("reading compact array is failed");
+				const uint64_t mask = (1u << bits) - 1;
+				uint64_t acc = 0;
+				size_t accBits = 0, p = 0;
+				for (size_t i = 0; i < size; ++i)
+				{
+					for (; accBits < bits; accBits += 8) acc |= (uint64_t)buf[p++] << accBits;
+					data[i] = (uint16_t)(acc & mask);
+					acc >>= bits;
+					accBits -= bits;
+				}
+			}
+		};
+
 		template<typename _Ty>
 		struct Serializer<tvector<_Ty>, typename std::enable_if<std::is_fundamental<_Ty>::value>::type>
 		{
 			using VTy = tvector<_Ty>;
 			void write(std::ostream& ostr, const VTy& v)
 			{
+				if (CompactArray<_Ty>::available && isCompactArrays(ostr))
+				{
+					writeToStream(ostr, (uint32_t)v.size() | compactArrayFlag);
+					CompactArray<_Ty>::write(ostr, v.data(), v.size());
+					return;
+				}
 				writeToStream(ostr, (uint32_t)v.size());
 				if (!ostr.write((const char*)v.data(), sizeof(_Ty) * v.size()))
 					throw std::ios_base::failure(std::string("writing type '") + typeid(_Ty).name() + std::string("' is failed"));
@@ -562,6 +680,12 @@ namespace tomoto
 			void read(std::istream& istr, VTy& v)
 			{
 				auto size = readFromStream<uint32_t>(istr);
+				if (size & compactArrayFlag)
+				{
+					v.resize(size & ~compactArrayFlag);
+					CompactArray<_Ty>::read(istr, v.data(), v.size());
+					return;
+				}
 				v.resize(size);
 				if (!istr.read((char*)v.data(), sizeof(_Ty) * size))
 					throw std::ios_base::failure(std::string("reading type '") + typeid(_Ty).name() + std::string("' is failed"));
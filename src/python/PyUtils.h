@@ -158,6 +158,47 @@ namespace py
 	using UniqueObj = UniqueCObj<>;
 	using SharedObj = SharedCObj<>;
 
+	/*
+	Releases the GIL during its lifetime so that other Python threads can run while native code is working.
+	No Python API may be called in its scope.
+	*/
+	class GILReleaser
+	{
+		PyThreadState* state;
+	public:
+		GILReleaser() : state{ PyEval_SaveThread() }
+		{
+		}
+
+		~GILReleaser()
+		{
+			PyEval_RestoreThread(state);
+		}
+
+		GILReleaser(const GILReleaser&) = delete;
+		GILReleaser& operator=(const GILReleaser&) = delete;
+	};
+
+	/*
+	Acquires the GIL during its lifetime, so that native code running without the GIL can call Python API in its scope.
+	*/
+	class GILAcquirer
+	{
+		PyGILState_STATE state;
+	public:
+		GILAcquirer() : state{ PyGILState_Ensure() }
+		{
+		}
+
+		~GILAcquirer()
+		{
+			PyGILState_Release(state);
+		}
+
+		GILAcquirer(const GILAcquirer&) = delete;
+		GILAcquirer& operator=(const GILAcquirer&) = delete;
+	};
+
 	class ExcPropagation : public std::runtime_error
 	{
 	public:
@@ -14,6 +14,7 @@ struct CoherenceObject
 	PyObject_HEAD;
 	CorpusObject* corpus;
 	Segmentation seg;
+	size_t numWorkers;
 	union { tomoto::coherence::CoherenceModel model; };
 	union { tomoto::coherence::AnyConfirmMeasurer cm; };
 	static int init(CoherenceObject* self, PyObject* args, PyObject* kwargs);
@@ -21,6 +22,21 @@ struct CoherenceObject
 	static void dealloc(CoherenceObject* self);
 
 	static PyObject* getScore(CoherenceObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getScores(CoherenceObject* self, PyObject* args, PyObject* kwargs);
 };
 
+struct CoherenceIndexObject
+{
+	PyObject_HEAD;
+	union { tomoto::coherence::IndexedEstimators inst; };
+	static CoherenceIndexObject* _new(PyTypeObject* subtype, PyObject* args, PyObject* kwargs);
+	static int init(CoherenceIndexObject* self, PyObject* args, PyObject* kwargs);
+	static void dealloc(CoherenceIndexObject* self);
+	static PyObject* getstate(CoherenceIndexObject* self, PyObject*);
+	static PyObject* setstate(CoherenceIndexObject* self, PyObject* args);
+	static PyObject* getNumDocs(CoherenceIndexObject* self, void* closure);
+};
+
+extern PyTypeObject CoherenceIndex_type;
+
 void addCoherenceTypes(PyObject* gModule);
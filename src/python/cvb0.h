@@ -0,0 +1,35 @@
+#pragma once
+
+#include "module.h"
+#include "../TopicModel/CVB0LDA.h"
+
+struct CVB0LDAObject
+{
+	PyObject_HEAD;
+	union { tomoto::CVB0LDA model; };
+	static int init(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* repr(CVB0LDAObject* self);
+	static void dealloc(CVB0LDAObject* self);
+
+	static PyObject* load(PyObject*, PyObject* args, PyObject* kwargs);
+	static PyObject* save(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* addDoc(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* train(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* infer(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getTopicWords(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getTopicWordDist(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getDocTopicDist(CVB0LDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getK(CVB0LDAObject* self, void* closure);
+	static PyObject* getAlpha(CVB0LDAObject* self, void* closure);
+	static PyObject* getEta(CVB0LDAObject* self, void* closure);
+	static PyObject* getTopK(CVB0LDAObject* self, void* closure);
+	static PyObject* getNumDocs(CVB0LDAObject* self, void* closure);
+	static PyObject* getNumWords(CVB0LDAObject* self, void* closure);
+	static PyObject* getGlobalStep(CVB0LDAObject* self, void* closure);
+	static PyObject* getLLPerWord(CVB0LDAObject* self, void* closure);
+	static PyObject* getVocabs(CVB0LDAObject* self, void* closure);
+};
+
+extern PyTypeObject CVB0LDA_type;
+
+void addCVB0Types(PyObject* gModule);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "module.h"
+#include "../TopicModel/DocIndex.h"
+
+struct DocIndexObject
+{
+	PyObject_HEAD;
+	union { tomoto::DocIndex index; };
+	static int init(DocIndexObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* repr(DocIndexObject* self);
+	static void dealloc(DocIndexObject* self);
+
+	static PyObject* load(PyObject*, PyObject* args, PyObject* kwargs);
+	static PyObject* save(DocIndexObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* search(DocIndexObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getMetric(DocIndexObject* self, void* closure);
+	static PyObject* getK(DocIndexObject* self, void* closure);
+	static PyObject* getNumDocs(DocIndexObject* self, void* closure);
+	static PyObject* getNumLists(DocIndexObject* self, void* closure);
+};
+
+extern PyTypeObject DocIndex_type;
+
+void addDocIndexTypes(PyObject* gModule);
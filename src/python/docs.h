@@ -11,6 +11,120 @@
 #define DOC_VARIABLE_EN_KO(name, en, ko) PyDoc_STRVAR(name, en)
 #endif
 
+/*
+    module functions
+*/
+DOC_SIGNATURE_EN_KO(load_info__doc__,
+    "load_info(filename)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return a `dict` describing the model saved in the file `filename`, without loading the model.
+Only the header and the parameters at the start of the file are read. The documents and the topic counts are skipped,
+so this is much faster than `tomotopy.LDAModel.load` for a large model. Files saved with `compress=True` are decompressed first.
+
+The `dict` has the following keys.
+
+* `model_key`: the type key of the model, like `'LDA'`. Models derived from another model without their own key share its key.
+* `tw`: the term weighting scheme, which is one of `tomotopy.TermWeight`
+* `k`, `alpha`, `eta`: the number of topics and the hyperparameters of `tomotopy.LDAModel`
+* `global_step`: the number of iterations the model was trained for
+* `vocabs`: the list of the vocabularies used by the model, which is the same as `tomotopy.LDAModel.used_vocabs`
+* `init_params`: the parameters the model was created with, or `None` if unknown
+* `num_docs`, `num_words`: the numbers of the documents and the words saved in the file, 0 if saved with `full=False`.
+  They are `None` for files saved by versions prior to 0.12.3.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`filename` 경로에 저장된 모델을 읽어들이지 않고, 그 모델을 설명하는 `dict`를 반환합니다.
+파일 앞부분의 헤더와 파라미터만 읽고 문헌과 토픽별 개수는 건너뛰므로, 큰 모델에 대해서 `tomotopy.LDAModel.load`보다 훨씬 빠릅니다.
+`compress=True`로 저장된 파일은 먼저 압축을 풉니다.
+
+`dict`는 다음 키들을 가집니다.
+
+* `model_key`: `'LDA'`와 같은 모델의 타입 키. 자신의 키가 없는 파생 모델은 기반 모델의 키를 공유합니다.
+* `tw`: `tomotopy.TermWeight` 중 하나인 용어 가중치 기법
+* `k`, `alpha`, `eta`: `tomotopy.LDAModel`의 토픽 개수와 하이퍼 파라미터
+* `global_step`: 모델이 학습된 반복 횟수
+* `vocabs`: `tomotopy.LDAModel.used_vocabs`와 같은, 모델이 사용하는 어휘들의 리스트
+* `init_params`: 모델을 생성할 때 사용된 파라미터, 알 수 없는 경우 `None`
+* `num_docs`, `num_words`: 파일에 저장된 문헌과 단어의 개수, `full=False`로 저장된 경우 0.
+  0.12.3 이전 버전에서 저장된 파일에서는 `None`입니다.)"");
+
+DOC_SIGNATURE_EN_KO(set_max_workers__doc__,
+    "set_max_workers(n)",
+    u8R""(.. versionadded:: 0.12.3
+
+Set the maximum number of workers shared by inference and auxiliary computations like
+`tomotopy.LDAModel.infer`, `tomotopy.coherence.Coherence`, `tomotopy.label.FoRelevance` and `tomotopy.utils.Corpus.extract_ngrams`.
+Their workers are kept alive between calls and reused, and the calls running at the same time together use at most `n` workers,
+so a call may run with fewer workers than its `workers` argument while others are running. Each call gets at least one worker.
+`n=0` sets it to the number of hardware threads, which is the default. Training with `tomotopy.LDAModel.train` is not limited by it.
+
+Parameters
+----------
+n : int
+    the maximum number of workers)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.infer`, `tomotopy.coherence.Coherence`, `tomotopy.label.FoRelevance`, `tomotopy.utils.Corpus.extract_ngrams`와 같은
+추론 및 보조 계산들이 공유하는 작업자의 최대 개수를 설정합니다.
+이들의 작업자는 호출 사이에도 유지되어 재사용되며, 동시에 실행되는 호출들은 합쳐서 최대 `n`개의 작업자를 사용합니다.
+따라서 다른 호출이 실행 중일 때는 `workers` 인자보다 적은 작업자로 실행될 수 있습니다. 각 호출은 최소 1개의 작업자를 받습니다.
+`n=0`이면 하드웨어 스레드의 개수로 설정되며, 이것이 기본값입니다. `tomotopy.LDAModel.train`을 통한 학습은 이 제한을 받지 않습니다.
+
+Parameters
+----------
+n : int
+    작업자의 최대 개수)"");
+
+DOC_SIGNATURE_EN_KO(get_max_workers__doc__,
+    "get_max_workers()",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the maximum number of workers shared by inference and auxiliary computations. See `tomotopy.set_max_workers`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+추론 및 보조 계산들이 공유하는 작업자의 최대 개수를 반환합니다. `tomotopy.set_max_workers`를 참조하십시오.)"");
+
+DOC_SIGNATURE_EN_KO(set_alloc_policy__doc__,
+    "set_alloc_policy(policy, min_size=16777216)",
+    u8R""(.. versionadded:: 0.12.3
+
+Set how large count matrices of topic models, like the topic-word counts and their copies for each worker, are allocated.
+With `policy='huge_pages'`, matrices of at least `min_size` bytes are backed by 2 MB huge pages using the transparent huge pages of Linux,
+which reduces TLB misses of random accesses into multi-GB matrices during training and inference.
+It takes effect on matrices allocated after the call, and it does nothing if the kernel disables transparent huge pages.
+`policy='default'` uses normal pages, which is the default.
+
+Parameters
+----------
+policy : str
+    one of `'default'` and `'huge_pages'`
+min_size : int
+    the minimum size in bytes of matrices backed by huge pages)"",
+    u8R""(.. versionadded:: 0.12.3
+
+토픽-단어 카운트 및 작업자별 복사본과 같은 토픽 모델의 큰 카운트 행렬을 할당하는 방식을 설정합니다.
+`policy='huge_pages'`이면 `min_size` 바이트 이상의 행렬은 Linux의 transparent huge pages를 이용해 2MB 크기의 huge page에 할당되며,
+이로써 학습 및 추론 중 수 GB 크기의 행렬에 무작위로 접근할 때의 TLB 미스가 줄어듭니다.
+호출 이후에 할당되는 행렬에만 적용되며, 커널이 transparent huge pages를 비활성화한 경우에는 아무 효과가 없습니다.
+`policy='default'`는 일반 페이지를 사용하며, 이것이 기본값입니다.
+
+Parameters
+----------
+policy : str
+    `'default'`, `'huge_pages'` 중 하나
+min_size : int
+    huge page에 할당될 행렬의 최소 바이트 크기)"");
+
+DOC_SIGNATURE_EN_KO(get_alloc_policy__doc__,
+    "get_alloc_policy()",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the allocation policy and its minimum size as a tuple of (`str`, `int`). See `tomotopy.set_alloc_policy`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+할당 방식과 최소 크기를 (`str`, `int`) 튜플로 반환합니다. `tomotopy.set_alloc_policy`를 참조하십시오.)"");
+
 /*
     class Document
 */
@@ -239,6 +353,42 @@ DOC_VARIABLE_EN_KO(Document_span__doc__,
     u8R""(a span (tuple of a start position and a end position in bytes) for each word token in the document (read-only))"",
     u8R""(문헌의 각 단어 토큰의 구간(바이트 단위 시작 지점과 끝 지점의 tuple) (읽기전용))"");
 
+DOC_VARIABLE_EN_KO(Document_words_view__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+a read-only `numpy.ndarray` viewing the vocabulary ids of the words of the document stored in the model, without copying them.
+The words are in the order the model stores them, which may differ from `tomotopy.Document.words`, and are aligned with `tomotopy.Document.topics_view`.
+The view keeps the model alive, and the model can't prepare new documents while views exist.
+It is available only for the documents of a trained model.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+모델에 저장된 문헌의 단어들의 어휘 id를 복사하지 않고 보여주는 읽기 전용 `numpy.ndarray`.
+단어들은 모델이 저장하는 순서대로 있으며 `tomotopy.Document.words`와 순서가 다를 수 있고, `tomotopy.Document.topics_view`와 순서가 일치합니다.
+뷰는 모델을 살려두며, 뷰가 존재하는 동안 모델은 새 문헌을 준비할 수 없습니다.
+학습된 모델의 문헌에서만 사용할 수 있습니다.)"");
+
+DOC_VARIABLE_EN_KO(Document_topics_view__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+a read-only `numpy.ndarray` viewing the topic assignments of the words of the document without copying them, aligned with `tomotopy.Document.words_view`.
+They are the raw assignments of the model: the table ids for `tomotopy.HDPModel` and the levels for `tomotopy.HLDAModel`,
+and 65535 for the words without a topic. Values change as the model is trained.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+문헌의 단어들에 할당된 토픽을 복사하지 않고 보여주는 읽기 전용 `numpy.ndarray`로, `tomotopy.Document.words_view`와 순서가 일치합니다.
+모델 내부의 할당값 그대로이므로 `tomotopy.HDPModel`에서는 테이블 id, `tomotopy.HLDAModel`에서는 레벨이며,
+토픽이 없는 단어는 65535입니다. 모델이 학습되면 값이 바뀝니다.)"");
+
+DOC_VARIABLE_EN_KO(Document_count_by_topics_view__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+a read-only `numpy.ndarray` viewing the number of words allocated to each topic in the document without copying them.
+Its type is `int32` for `TermWeight.ONE` and `float32` for the others.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+문헌 내에서 각 토픽에 할당된 단어의 개수를 복사하지 않고 보여주는 읽기 전용 `numpy.ndarray`.
+`TermWeight.ONE`에서는 `int32`, 그 외에는 `float32` 타입입니다.)"");
+
 DOC_VARIABLE_EN_KO(Document_pseudo_doc_id__doc__,
     u8R""(id of a pseudo document where the document is allocated to (for only `tomotopy.PTModel` model, read-only)
 
@@ -251,7 +401,7 @@ u8R""(문헌이 할당된 가상 문헌의 id (`tomotopy.PTModel` 모형에서
     class LDA
 */
 DOC_SIGNATURE_EN_KO(LDA___init____doc__,
-    "LDAModel(tw=TermWeight.ONE, min_cf=0, min_df=0, rm_top=0, k=1, alpha=0.1, eta=0.01, seed=None, corpus=None, transform=None)",
+    "LDAModel(tw=TermWeight.ONE, min_cf=0, min_df=0, rm_top=0, k=1, alpha=0.1, eta=0.01, seed=None, corpus=None, transform=None, compact=False)",
     u8R""(This type provides Latent Dirichlet Allocation(LDA) topic model and its implementation is based on following papers:
 	
 > * Blei, D.M., Ng, A.Y., &Jordan, M.I. (2003).Latent dirichlet allocation.Journal of machine Learning research, 3(Jan), 993 - 1022.
@@ -290,6 +440,18 @@ transform : Callable[dict, dict]
     .. versionadded:: 0.6.0
 
     a callable object to manipulate arbitrary keyword arguments for a specific topic model
+compact : bool
+    .. versionadded:: 0.12.3
+
+    if True, the weights of `tomotopy.TermWeight.IDF` and `tomotopy.TermWeight.PMI` are computed from the vocabulary
+    instead of being stored for each word of documents, which saves 4 bytes per word for `tomotopy.TermWeight.IDF`.
+    For `tomotopy.TermWeight.PMI`, the 2-byte frequency of each word in its document is stored instead of its weight, which saves 2 bytes per word.
+    It has no effect on `tomotopy.TermWeight.ONE`. The topics of words are always stored in 2 bytes,
+    and the topic counts of documents keep 4 bytes per topic with or without this option.
+
+    .. versionchanged:: 0.12.3
+
+        `tomotopy.TermWeight.PMI` is supported.
 )"",
 u8R""(이 타입은 Latent Dirichlet Allocation(LDA) 토픽 모델의 구현체를 제공합니다. 주요 알고리즘은 다음 논문에 기초하고 있습니다:
 	
@@ -330,12 +492,28 @@ transform : Callable[dict, dict]
     .. versionadded:: 0.6.0
 
     특정한 토픽 모델에 맞춰 임의 키워드 인자를 조작하기 위한 호출가능한 객체
+compact : bool
+    .. versionadded:: 0.12.3
+
+    True인 경우 `tomotopy.TermWeight.IDF`와 `tomotopy.TermWeight.PMI`의 가중치를 문헌의 단어마다 저장하지 않고 어휘로부터 계산하여, `tomotopy.TermWeight.IDF`에서는 단어당 4바이트를 절약합니다.
+    `tomotopy.TermWeight.PMI`에서는 가중치 대신 문헌 내 각 단어의 빈도를 2바이트로 저장하므로, 단어당 2바이트를 절약합니다.
+    `tomotopy.TermWeight.ONE`에는 영향을 주지 않습니다. 단어의 주제는 항상 2바이트로 저장되며,
+    문헌의 주제별 개수는 이 옵션과 관계없이 주제당 4바이트를 유지합니다.
+
+    .. versionchanged:: 0.12.3
+
+        `tomotopy.TermWeight.PMI`가 지원됩니다.
 )"");
 
 DOC_SIGNATURE_EN_KO(LDA_add_doc__doc__,
     "add_doc(self, words)",
     u8R""(Add a new document into the model instance and return an index of the inserted document. This method should be called before calling the `tomotopy.LDAModel.train`.
 
+.. versionchanged:: 0.12.3
+
+    `tomotopy.LDAModel` accepts new documents after `tomotopy.LDAModel.train` too.
+    They are prepared at the next call of `tomotopy.LDAModel.train`, which also adds their new words to the vocabularies. See `tomotopy.LDAModel.new_doc_sweeps`.
+
 Parameters
 ----------
 words : Iterable[str]
@@ -343,6 +521,11 @@ words : Iterable[str]
 )"",
 u8R""(현재 모델에 새로운 문헌을 추가하고 추가된 문헌의 인덱스 번호를 반환합니다. 이 메소드는 `tomotopy.LDAModel.train`를 호출하기 전에만 사용될 수 있습니다.
 
+.. versionchanged:: 0.12.3
+
+    `tomotopy.LDAModel`은 `tomotopy.LDAModel.train` 이후에도 새 문헌을 받습니다.
+    이 문헌들은 다음 `tomotopy.LDAModel.train` 호출 시 준비되며, 이때 새 단어들도 어휘 목록에 추가됩니다. `tomotopy.LDAModel.new_doc_sweeps`를 참조하세요.
+
 Parameters
 ----------
 words : Iterable[str]
@@ -374,6 +557,54 @@ transform : Callable[dict, dict]
     특정한 토픽 모델에 맞춰 임의 키워드 인자를 조작하기 위한 호출가능한 객체
 )"");
 
+DOC_SIGNATURE_EN_KO(LDA_add_token_arrays__doc__,
+    "add_token_arrays(self, vocabs, token_ids, offsets, uids=None, workers=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Add documents given as arrays of token ids into the model instance at once and return the list of their indices.
+The i-th document consists of `vocabs[token_ids[j]]` for `offsets[i] <= j < offsets[i + 1]`.
+The arrays are read through the array interface of NumPy, so that NumPy arrays, `memoryview`s and Arrow arrays can be passed without copying if their types are already `int32` and `int64`.
+The documents are built in parallel without calling Python for each one, which is much faster than calling `tomotopy.LDAModel.add_doc` repeatedly.
+An empty document is ignored and its index is given as -1.
+This method should be called before calling the `tomotopy.LDAModel.train` and is not supported for models requiring extra arguments per document (e.g. `tomotopy.DMRModel`).
+
+Parameters
+----------
+vocabs : Iterable[str]
+    the vocabulary which `token_ids` refers to. Only the words actually used are added into the model.
+token_ids : array_like of int32
+    token ids of all documents concatenated. A token id of -1 means a dropped token.
+offsets : array_like of int64
+    an array with `len(docs) + 1` non-decreasing elements
+uids : Iterable[str]
+    unique ids of the documents
+workers : int
+    an integer indicating the number of workers to build documents in parallel.
+    If `workers` is 0, the number of cores in the system will be used.
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+토큰 id 배열로 주어진 문헌들을 한 번에 현재 모델에 추가하고 추가된 문헌들의 인덱스 리스트를 반환합니다.
+i번째 문헌은 `offsets[i] <= j < offsets[i + 1]`인 `vocabs[token_ids[j]]`들로 구성됩니다.
+배열은 NumPy의 배열 인터페이스로 읽히므로, NumPy 배열, `memoryview`, Arrow 배열 등을 넘길 수 있으며 타입이 이미 `int32`와 `int64`라면 복사가 일어나지 않습니다.
+각 문헌마다 Python을 호출하지 않고 병렬로 문헌을 생성하므로 `tomotopy.LDAModel.add_doc`을 반복해서 호출하는 것보다 훨씬 빠릅니다.
+빈 문헌은 무시되며 그 인덱스는 -1로 주어집니다.
+이 메소드는 `tomotopy.LDAModel.train`를 호출하기 전에만 사용될 수 있으며, 문헌마다 추가 인자가 필요한 모델(예: `tomotopy.DMRModel`)에서는 지원되지 않습니다.
+
+Parameters
+----------
+vocabs : Iterable[str]
+    `token_ids`가 가리키는 어휘 목록. 실제로 사용된 단어만 모델에 추가됩니다.
+token_ids : array_like of int32
+    모든 문헌의 토큰 id를 이어붙인 배열. -1은 제외된 토큰을 뜻합니다.
+offsets : array_like of int64
+    감소하지 않는 `len(docs) + 1`개의 원소로 구성된 배열
+uids : Iterable[str]
+    각 문헌의 고유 id
+workers : int
+    병렬로 문헌을 생성할 작업자의 수. 0으로 설정할 경우 시스템 내의 가용 코어 수가 사용됩니다.
+)"");
+
 DOC_SIGNATURE_EN_KO(LDA_make_doc__doc__,
     "make_doc(self, words)",
     u8R""(Return a new `tomotopy.Document` instance for an unseen document with `words` that can be used for `tomotopy.LDAModel.infer` method.
@@ -397,6 +628,11 @@ DOC_SIGNATURE_EN_KO(LDA_set_word_prior__doc__,
 
 Set word-topic prior. This method should be called before calling the `tomotopy.LDAModel.train`.
 
+.. versionchanged:: 0.12.3
+
+    Only the words given their own priors are sampled with them, while the others keep the fast path of the symmetric `eta`.
+    So setting priors of a few words no longer slows down the training of `tomotopy.LDAModel` noticeably.
+
 Parameters
 ----------
 word : str
@@ -408,6 +644,11 @@ u8R""(.. versionadded:: 0.6.0
 
 어휘-주제 사전 분포를 설정합니다. 이 메소드는 `tomotopy.LDAModel.train`를 호출하기 전에만 사용될 수 있습니다.
 
+.. versionchanged:: 0.12.3
+
+    사전 분포가 지정된 단어들만 이를 사용하여 샘플링되고, 나머지 단어들은 대칭 `eta`의 빠른 경로를 유지합니다.
+    따라서 몇몇 단어에 사전 분포를 지정해도 `tomotopy.LDAModel`의 학습이 눈에 띄게 느려지지 않습니다.
+
 Parameters
 ----------
 word : str
@@ -437,8 +678,87 @@ word : str
     어휘
 )"");
 
+DOC_SIGNATURE_EN_KO(LDA_set_warm_start__doc__,
+    "set_warm_start(self, model)",
+    u8R""(.. versionadded:: 0.12.3
+
+Make the first `tomotopy.LDAModel.train` draw the initial topics of the documents from the topic-word distributions of a trained `model`
+instead of the prior, which is useful for retraining on a corpus overlapping with that of `model`.
+Each document is initialized by a single sweep of inference against `model`, so the training converges in far fewer iterations.
+The vocabularies are matched by their words, and the words unknown to `model` are initialized with a flat distribution.
+Only the initial topics are taken from `model`, so the result is still a new model not depending on `model`.
+This method should be called before calling the `tomotopy.LDAModel.train`, and currently it is supported only by `tomotopy.LDAModel`.
+
+Parameters
+----------
+model : tomotopy.LDAModel
+    a trained model with the same number of topics as this model. If it is `None`, the warm start is canceled.
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+첫 `tomotopy.LDAModel.train` 시 문헌들의 초기 주제를 사전 분포 대신 학습된 `model`의 주제-단어 분포로부터 추출하도록 합니다.
+`model`의 말뭉치와 많이 겹치는 말뭉치로 다시 학습할 때 유용합니다.
+각 문헌은 `model`에 대한 한 번의 추론으로 초기화되므로, 학습이 훨씬 적은 반복만에 수렴합니다.
+어휘는 단어를 기준으로 대응되며, `model`에 없는 단어는 균등 분포로 초기화됩니다.
+`model`로부터는 초기 주제만을 가져오므로 결과는 여전히 `model`에 의존하지 않는 새 모델입니다.
+이 메소드는 `tomotopy.LDAModel.train`를 호출하기 전에만 사용될 수 있으며, 현재는 `tomotopy.LDAModel`만 지원합니다.
+
+Parameters
+----------
+model : tomotopy.LDAModel
+    이 모델과 주제 개수가 같은 학습된 모델. `None`인 경우 웜 스타트를 취소합니다.
+)"");
+
+DOC_SIGNATURE_EN_KO(LDA_set_distributed_sync__doc__,
+    "set_distributed_sync(self, vocabs, exchange, threshold=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Make `tomotopy.LDAModel.train` exchange the changes of the topic-word counts with the models on other nodes after every iteration,
+so that models trained on different parts of a corpus share their topics. Each node trains its own documents with any parallel scheme.
+The changes are sent sparsely, as the arrays of (word, topic, count) whose counts are not zero.
+
+All nodes should call it with the same `vocabs` before the first `tomotopy.LDAModel.train`.
+The words of `vocabs` are added to the vocabularies of the model, and `min_cf`, `min_df` and `rm_top` should not remove any of them.
+Currently it is supported only by `tomotopy.LDAModel`.
+
+Parameters
+----------
+vocabs : Iterable[str]
+    the vocabularies shared by all nodes. The words in exchanged arrays are their indices.
+exchange : Callable[[numpy.ndarray, numpy.ndarray, numpy.ndarray], Tuple]
+    a callable receiving the arrays `vids`, `tids` and `counts` of the changes of this node,
+    and returning a tuple of the same arrays of all nodes, like an allreduce.
+    Simply concatenating the arrays of all nodes, as `allgather` of `mpi4py` does, is enough.
+    If it is `None`, the exchange is disabled.
+threshold : float
+    the changes whose absolute values are smaller than it are not sent, but kept locally until they grow.
+    The default value is 0, which sends all changes.
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.train`이 매 반복마다 다른 노드의 모델들과 주제-단어 개수의 변화량을 교환하도록 설정합니다.
+따라서 말뭉치의 서로 다른 부분으로 학습되는 모델들이 주제를 공유하게 됩니다. 각 노드는 자신의 문헌을 어떤 병렬화 방법으로든 학습합니다.
+변화량은 개수가 0이 아닌 (단어, 주제, 개수)의 배열로 희소하게 전송됩니다.
+
+모든 노드는 첫 `tomotopy.LDAModel.train` 전에 같은 `vocabs`로 이 메소드를 호출해야 합니다.
+`vocabs`의 단어들은 모델의 어휘 목록에 추가되며, `min_cf`, `min_df`, `rm_top`에 의해 제거되어서는 안 됩니다.
+현재 `tomotopy.LDAModel`에서만 지원됩니다.
+
+Parameters
+----------
+vocabs : Iterable[str]
+    모든 노드가 공유하는 어휘 목록. 교환되는 배열에서 단어는 이 목록에서의 인덱스로 표현됩니다.
+exchange : Callable[[numpy.ndarray, numpy.ndarray, numpy.ndarray], Tuple]
+    이 노드의 변화량인 `vids`, `tids`, `counts` 배열을 받아, 모든 노드의 같은 배열들을 tuple로 반환하는 호출 가능한 객체입니다. allreduce와 비슷합니다.
+    `mpi4py`의 `allgather`처럼 모든 노드의 배열들을 단순히 이어붙이는 것으로 충분합니다.
+    `None`인 경우 교환을 중단합니다.
+threshold : float
+    절대값이 이 값보다 작은 변화량은 전송되지 않고 커질 때까지 노드에 보관됩니다.
+    기본값은 0으로, 모든 변화량을 전송합니다.
+)"");
+
 DOC_SIGNATURE_EN_KO(LDA_train__doc__,
-    "train(self, iter=10, workers=0, parallel=0, freeze_topics=False)",
+    "train(self, iter=10, workers=0, parallel=0, freeze_topics=False, callback=None, callback_interval=1, checkpoint=None, checkpoint_interval=10, checkpoint_deltas=0)",
     u8R""(Train the model using Gibbs-sampling with `iter` iterations. Return `None`. 
 After calling this method, you cannot `tomotopy.LDAModel.add_doc` or `tomotopy.LDAModel.set_word_prior` more.
 
@@ -457,6 +777,36 @@ freeze_topics : bool
     .. versionadded:: 0.10.1
 
     prevents to create a new topic when training. Only valid for `tomotopy.HLDAModel`
+callback : Callable[[dict], Optional[bool]]
+    .. versionadded:: 0.12.3
+
+    a callable object called every `callback_interval` iterations and after the last iteration.
+    It receives a dict with keys `iteration`, `global_step`, `ll_per_word`, `elapsed` (in seconds) and `tokens_per_sec`.
+    If it returns `False`, the training stops there. The model can be safely read inside the callback.
+callback_interval : int
+    .. versionadded:: 0.12.3
+
+    the number of iterations between calls of `callback`
+checkpoint : str
+    .. versionadded:: 0.12.3
+
+    path of the checkpoint written every `checkpoint_interval` iterations and after the last iteration.
+    A checkpoint has only the topics of the words and the hyperparameters, and can be restored by `tomotopy.LDAModel.restore_checkpoint`.
+    Only taking the snapshot pauses the sampling, while it is compressed and written on a background thread.
+    The file is replaced only after the new checkpoint is written completely. It is supported only for `tomotopy.LDAModel` itself.
+checkpoint_interval : int
+    .. versionadded:: 0.12.3
+
+    the number of iterations between checkpoints
+checkpoint_deltas : int
+    .. versionadded:: 0.12.3
+
+    the number of delta checkpoints written after each full checkpoint. 0 writes every checkpoint in full.
+    A delta has only the topics of the words changed since the previous checkpoint and the hyperparameters,
+    and is appended to `checkpoint + '.delta'`, which is removed when the next full checkpoint is written.
+    It is much smaller than a full checkpoint late in the training, when the topics of few words change.
+    If so many topics changed that a delta would be hardly smaller, a full checkpoint is written instead.
+    The first checkpoint of each call of `train` is always a full one.
 )"",
 u8R""(깁스 샘플링을 `iter` 회 반복하여 현재 모델을 학습시킵니다. 반환값은 `None`입니다. 
 이 메소드가 호출된 이후에는 더 이상 `tomotopy.LDAModel.add_doc`로 현재 모델에 새로운 학습 문헌을 추가시킬 수 없습니다.
@@ -476,6 +826,35 @@ freeze_topics : bool
     .. versionadded:: 0.10.1
 
     학습 시 새로운 토픽을 생성하지 못하도록 합니다. 이 파라미터는 오직 `tomotopy.HLDAModel`에만 유효합니다.
+callback : Callable[[dict], Optional[bool]]
+    .. versionadded:: 0.12.3
+
+    `callback_interval` 회 반복마다, 그리고 마지막 반복 후에 호출되는 호출가능한 객체입니다.
+    `iteration`, `global_step`, `ll_per_word`, `elapsed`(초 단위), `tokens_per_sec`를 키로 가지는 dict를 인자로 받습니다.
+    `False`를 반환하면 학습이 그 자리에서 중단됩니다. 콜백 내에서는 모델을 안전하게 읽을 수 있습니다.
+callback_interval : int
+    .. versionadded:: 0.12.3
+
+    `callback`이 호출되는 반복 간격
+checkpoint : str
+    .. versionadded:: 0.12.3
+
+    `checkpoint_interval` 회 반복마다, 그리고 마지막 반복 후에 저장되는 체크포인트의 경로.
+    체크포인트는 단어들의 토픽과 하이퍼 파라미터만을 가지며, `tomotopy.LDAModel.restore_checkpoint`로 복원할 수 있습니다.
+    샘플링은 스냅샷을 뜨는 동안에만 멈추고, 압축과 저장은 백그라운드 스레드에서 진행됩니다.
+    파일은 새 체크포인트가 완전히 저장된 뒤에만 교체됩니다. `tomotopy.LDAModel`에서만 지원됩니다.
+checkpoint_interval : int
+    .. versionadded:: 0.12.3
+
+    체크포인트가 저장되는 반복 간격
+checkpoint_deltas : int
+    .. versionadded:: 0.12.3
+
+    전체 체크포인트마다 그 뒤에 저장되는 델타 체크포인트의 개수. 0이면 모든 체크포인트를 전체로 저장합니다.
+    델타는 이전 체크포인트 이후 토픽이 바뀐 단어들과 하이퍼 파라미터만을 가지며, `checkpoint + '.delta'`에 덧붙여지고
+    이 파일은 다음 전체 체크포인트가 저장될 때 삭제됩니다. 토픽이 바뀌는 단어가 적은 학습 후반부에는 전체 체크포인트보다 훨씬 작습니다.
+    토픽이 너무 많이 바뀌어서 델타가 별로 작지 않을 때에는 전체 체크포인트가 대신 저장됩니다.
+    `train`을 호출할 때마다 첫 체크포인트는 항상 전체로 저장됩니다.
 )"");
 
 DOC_SIGNATURE_EN_KO(LDA_get_topic_words__doc__,
@@ -524,13 +903,129 @@ normalize : bool
     참일 경우 총합이 1이 되는 확률 분포를 반환하고, 거짓일 경우 정규화되지 않는 값을 그대로 반환합니다.
 )"");
 
+DOC_SIGNATURE_EN_KO(LDA_get_topic_word_dists__doc__,
+    "get_topic_word_dists(self, normalize=True, workers=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the word distributions of all topics at once as a `numpy.ndarray` of float32 with shape (`k`, `len(vocabs)`),
+whose `i`-th row equals `get_topic_word_dist(i, normalize)`.
+For derived models, it has a row for every topic id accepted by their `get_topic_word_dist`.
+It fills the rows in parallel without building an intermediate `list` for each topic.
+
+Parameters
+----------
+normalize : bool
+    If True, each row is the probability distribution with the sum being 1. Otherwise it holds the distribution of raw values.
+workers : int
+    the number of threads used to fill the rows. If 0, all cores of the system are used.
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+모든 토픽의 단어 분포를 (`k`, `len(vocabs)`) 모양의 float32 `numpy.ndarray`로 한 번에 반환합니다.
+`i`번째 행은 `get_topic_word_dist(i, normalize)`와 같습니다.
+파생 모델의 경우 각 모델의 `get_topic_word_dist`가 받는 모든 토픽 번호에 대해 행을 가집니다.
+토픽마다 중간 `list`를 만들지 않고 각 행을 병렬로 채웁니다.
+
+Parameters
+----------
+normalize : bool
+    참일 경우 각 행은 총합이 1이 되는 확률 분포이고, 거짓일 경우 정규화되지 않는 값입니다.
+workers : int
+    행을 채우는 데 사용할 스레드의 개수. 0일 경우 시스템의 모든 코어를 사용합니다.
+)"");
+
+DOC_SIGNATURE_EN_KO(LDA_get_doc_topic_dists__doc__,
+    "get_doc_topic_dists(self, normalize=True, workers=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the topic distributions of all documents in `tomotopy.LDAModel.docs` at once as a `numpy.ndarray` of float32
+with shape (`len(docs)`, `k`), whose `i`-th row equals `docs[i].get_topic_dist(normalize)`.
+The rows of documents whose topics are not sampled yet are filled with NaN.
+
+Parameters
+----------
+normalize : bool
+    If True, each row is the probability distribution with the sum being 1. Otherwise it holds the distribution of raw values.
+workers : int
+    the number of threads used to fill the rows. If 0, all cores of the system are used.
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.docs`의 모든 문헌의 토픽 분포를 (`len(docs)`, `k`) 모양의 float32 `numpy.ndarray`로 한 번에 반환합니다.
+`i`번째 행은 `docs[i].get_topic_dist(normalize)`와 같습니다.
+아직 토픽이 샘플링되지 않은 문헌의 행은 NaN으로 채워집니다.
+
+Parameters
+----------
+normalize : bool
+    참일 경우 각 행은 총합이 1이 되는 확률 분포이고, 거짓일 경우 정규화되지 않는 값입니다.
+workers : int
+    행을 채우는 데 사용할 스레드의 개수. 0일 경우 시스템의 모든 코어를 사용합니다.
+)"");
+
+DOC_SIGNATURE_EN_KO(LDA_get_all_topic_words__doc__,
+    "get_all_topic_words(self, top_n=10, workers=0, return_words=False)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the `top_n` words with the highest probability of all topics at once as a tuple of two `numpy.ndarray`s,
+the vocabulary ids of type uint32 and their probabilities of type float32, both with shape (number of topics, `top_n`).
+The `i`-th rows are the same as the result of `get_topic_words(i, top_n)`, and they can be mapped to words by `tomotopy.LDAModel.vocabs`.
+The topics are selected in parallel without building a `list` of words for each topic.
+
+Parameters
+----------
+top_n : int
+    the number of words of each topic. If it exceeds the number of vocabularies, all vocabularies are returned.
+workers : int
+    the number of threads used to select the words. If 0, all cores of the system are used.
+return_words : bool
+    If True, the words themselves are returned as a `list` of `list`s of `str` in place of the vocabulary ids.
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+모든 토픽의 확률이 높은 상위 `top_n`개 단어를 두 `numpy.ndarray`의 튜플로 한 번에 반환합니다.
+첫번째는 uint32 타입의 어휘 번호, 두번째는 float32 타입의 확률이며 둘 다 (토픽 개수, `top_n`) 모양입니다.
+`i`번째 행은 `get_topic_words(i, top_n)`의 결과와 같으며, 어휘 번호는 `tomotopy.LDAModel.vocabs`로 단어로 바꿀 수 있습니다.
+토픽마다 단어의 `list`를 만들지 않고 병렬로 단어들을 선택합니다.
+
+Parameters
+----------
+top_n : int
+    각 토픽의 단어 개수. 어휘의 개수보다 큰 경우 모든 어휘가 반환됩니다.
+workers : int
+    단어 선택에 사용할 스레드의 개수. 0일 경우 시스템의 모든 코어를 사용합니다.
+return_words : bool
+    참일 경우 어휘 번호 대신 단어 자체를 `str`의 `list`의 `list`로 반환합니다.
+)"");
+
 DOC_SIGNATURE_EN_KO(LDA_get_count_by_topics__doc__,
     "get_count_by_topics(self)",
     u8R""(Return the number of words allocated to each topic.)"",
     u8R""(각각의 토픽에 할당된 단어의 개수를 `list`형태로 반환합니다.)"");
 
+DOC_SIGNATURE_EN_KO(LDA_export_assignments__doc__,
+    "export_assignments(self)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the words and the topics of all the documents of the model at once, as a tuple of three `numpy.ndarray`s in the CSR layout:
+
+* `doc_offsets` (`int64`, length `len(docs) + 1`): the words of the `i`-th document are at `doc_offsets[i]:doc_offsets[i + 1]`
+* `word_ids` (`uint32`): the vocabulary ids of the words, the same as `tomotopy.Document.words` of each document
+* `topic_ids` (`int16`): the topics of the words, the same as `tomotopy.Document.topics` of each document, -1 for the words without a topic
+
+This is much faster than iterating `docs` since it doesn't create any Python object per document.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+모델의 모든 문헌의 단어와 토픽을 한 번에, CSR 형태의 세 `numpy.ndarray`의 tuple로 반환합니다.
+
+* `doc_offsets` (`int64`, 길이 `len(docs) + 1`): `i`번째 문헌의 단어들은 `doc_offsets[i]:doc_offsets[i + 1]`에 위치합니다
+* `word_ids` (`uint32`): 각 문헌의 `tomotopy.Document.words`와 같은 단어들의 어휘 id
+* `topic_ids` (`int16`): 각 문헌의 `tomotopy.Document.topics`와 같은 단어들의 토픽, 토픽이 없는 단어는 -1
+
+문헌마다 Python 객체를 생성하지 않으므로 `docs`를 순회하는 것보다 훨씬 빠릅니다.)"");
+
 DOC_SIGNATURE_EN_KO(LDA_infer__doc__,
-    "infer(self, doc, iter=100, tolerance=-1, workers=0, parallel=0, together=False, transform=None)",
+    "infer(self, doc, iter=100, tolerance=-1, workers=0, parallel=0, together=False, transform=None, timeout=0, doc_timeout=0)",
     u8R""(Return the inferred topic distribution from unseen `doc`s.
 
 Parameters
@@ -548,7 +1043,7 @@ iter : int
     an integer indicating the number of iteration to estimate the distribution of topics of `doc`.
     The higher value will generate a more accuracy result.
 tolerance : float
-    isn't currently used.
+    isn't currently used, except by `tomotopy.LDAModel.fold_in_em`.
 workers : int
     an integer indicating the number of workers to perform samplings. 
     If `workers` is 0, the number of cores in the system will be used.
@@ -575,6 +1070,21 @@ result : Union[List[float], List[List[float]], tomotopy.utils.Corpus]
     You can get topic distribution for each document using `tomotopy.Document.get_topic_dist`.
 log_ll : List[float]
     a list of log-likelihoods for each `doc`s
+
+.. versionchanged:: 0.12.3
+
+    `infer` doesn't modify the model and runs without the GIL, so multiple threads can call it on the same model at the same time
+    if each thread infers its own documents.
+    While any of them is running, methods modifying the model such as `tomotopy.LDAModel.train` raise `RuntimeError`.
+
+.. versionadded:: 0.12.3
+
+    `timeout` and `doc_timeout` bound the wall-clock time of inference, in seconds, for the whole call and for each document respectively.
+    When a limit is reached, the sampling of each document stops after its current iteration,
+    and its topics at that point are the result, so the latency doesn't depend on `iter` or the lengths of the documents.
+    Documents not begun before `timeout` keep their initial topics. `doc_timeout` is ignored if `together` is `True`.
+    If any of them is positive, the number of iterations done is returned as the third element of the result,
+    which is an `int` for a single document or for `together=True`, and a `List[int]` for each document otherwise.
 )"",
 u8R""(새로운 문헌인 `doc`에 대해 각각의 주제 분포를 추론하여 반환합니다.
 반환 타입은 (`doc`의 주제 분포, 로그가능도) 또는 (`doc`의 주제 분포로 구성된 `list`, 로그가능도)입니다.
@@ -594,7 +1104,7 @@ iter : int
     `doc`의 주제 분포를 추론하기 위해 학습을 반복할 횟수입니다.
     이 값이 클 수록 더 정확한 결과를 낼 수 있습니다.
 tolerance : float
-    현재는 사용되지 않음
+    `tomotopy.LDAModel.fold_in_em`을 제외하면 현재는 사용되지 않음
 workers : int
     깁스 샘플링을 수행하는 데에 사용할 스레드의 개수입니다. 
     만약 이 값을 0으로 설정할 경우 시스템 내의 가용한 모든 코어가 사용됩니다.
@@ -622,10 +1132,217 @@ result : Union[List[float], List[List[float]], tomotopy.utils.Corpus]
     각 문헌별 토픽 분포를 얻기 위해서는 `tomotopy.Document.get_topic_dist`를 사용하면 됩니다.
 log_ll : float
     각 문헌별 로그 가능도의 리스트
+
+.. versionchanged:: 0.12.3
+
+    `infer`는 모델을 변경하지 않으며 GIL 없이 실행되므로, 각 스레드가 서로 다른 문헌을 추론하는 경우
+    여러 스레드에서 동시에 같은 모델의 `infer`를 호출할 수 있습니다.
+    이들 중 하나라도 실행 중인 동안 `tomotopy.LDAModel.train`과 같이 모델을 변경하는 메소드는 `RuntimeError`를 발생시킵니다.
+
+.. versionadded:: 0.12.3
+
+    `timeout`과 `doc_timeout`은 각각 호출 전체와 각 문헌의 추론에 걸리는 실제 시간을 초 단위로 제한합니다.
+    제한에 도달하면 각 문헌의 샘플링은 현재 반복이 끝난 뒤 멈추고 그 시점의 주제가 결과가 되므로,
+    지연 시간이 `iter`나 문헌의 길이에 의존하지 않습니다.
+    `timeout` 전에 시작하지 못한 문헌은 초기 주제를 유지합니다. `together`가 `True`이면 `doc_timeout`은 무시됩니다.
+    둘 중 하나라도 양수이면 수행된 반복 횟수가 결과의 세 번째 원소로 반환되며,
+    이는 단일 문헌이나 `together=True`인 경우 `int`, 그 외에는 각 문헌별 `List[int]`입니다.
+)"");
+
+DOC_SIGNATURE_EN_KO(LDA_infer_matrix__doc__,
+    "infer_matrix(self, doc, iter=100, tolerance=-1, workers=0, parallel=0, batch_size=4096, transform=None)",
+    u8R""(.. versionadded:: 0.12.3
+
+Infer the topic distributions of all documents of a corpus and return them as a matrix, for scoring a large corpus.
+Unlike `tomotopy.LDAModel.infer`, it creates no Python object for each document.
+Instead, it infers the documents in batches of `batch_size`, so only one batch of inferred documents exists at a time,
+and writes the results directly into the returned arrays.
+
+Parameters
+----------
+doc : tomotopy.utils.Corpus
+    a corpus of documents to be inferred
+iter : int
+    an integer indicating the number of iteration to estimate the distribution of topics of each document
+tolerance : float
+    isn't currently used, except by `tomotopy.LDAModel.fold_in_em`.
+workers : int
+    an integer indicating the number of workers to perform samplings. If `workers` is 0, the number of cores in the system will be used.
+parallel : Union[int, tomotopy.ParallelScheme]
+    the parallelism scheme for inference
+batch_size : int
+    the number of documents inferred at once
+transform : Callable[dict, dict]
+    a callable object to manipulate arbitrary keyword arguments for a specific topic model
+
+Returns
+-------
+theta : numpy.ndarray
+    a float32 array with shape (`len(doc)`, `k`), whose `i`-th row is the topic distribution of the `i`-th document of `doc`.
+    The rows of documents without any word known to the model are filled with NaN.
+log_ll : numpy.ndarray
+    a float64 array of the log-likelihoods of the documents, which is 0 for the documents without any known word
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+말뭉치의 모든 문헌의 주제 분포를 추론하여 행렬로 반환합니다. 대규모 말뭉치를 평가하는 데 사용합니다.
+`tomotopy.LDAModel.infer`와 달리 문헌마다 파이썬 객체를 생성하지 않습니다.
+대신 문헌들을 `batch_size`개씩 나누어 추론하므로 한 번에 한 묶음의 추론된 문헌만 존재하며,
+결과는 반환되는 배열에 바로 기록됩니다.
+
+Parameters
+----------
+doc : tomotopy.utils.Corpus
+    추론할 문헌들의 말뭉치
+iter : int
+    각 문헌의 주제 분포를 추정하는 데 사용할 반복 횟수
+tolerance : float
+    `tomotopy.LDAModel.fold_in_em`을 제외하고는 현재 사용되지 않습니다.
+workers : int
+    샘플링을 수행하는 데에 사용할 스레드의 개수입니다. 만약 이 값을 0으로 설정할 경우 시스템 내의 가용한 모든 코어가 사용됩니다.
+parallel : Union[int, tomotopy.ParallelScheme]
+    추론에 사용할 병렬화 방법
+batch_size : int
+    한 번에 추론할 문헌의 개수
+transform : Callable[dict, dict]
+    특정한 토픽 모델에 맞춰 임의 키워드 인자를 조작하기 위한 호출가능한 객체
+
+Returns
+-------
+theta : numpy.ndarray
+    (`len(doc)`, `k`) 모양의 float32 배열로, `i`번째 행은 `doc`의 `i`번째 문헌의 주제 분포입니다.
+    모델이 아는 단어가 하나도 없는 문헌의 행은 NaN으로 채워집니다.
+log_ll : numpy.ndarray
+    문헌들의 로그 가능도를 담은 float64 배열로, 아는 단어가 없는 문헌은 0입니다.
+)"");
+
+DOC_SIGNATURE_EN_KO(LDA_estimate_held_out_ll__doc__,
+    "estimate_held_out_ll(self, doc, method=HeldOutEstimator.LEFT_TO_RIGHT, particles=10, workers=0, seed=None, transform=None)",
+    u8R""(.. versionadded:: 0.12.3
+
+Estimate the held-out log-likelihood log p(w|phi, alpha) of each of `doc`s with the topic-word distribution of the model fixed.
+Unlike the log-likelihood returned by `tomotopy.LDAModel.infer`, which comes from a single state of a short Gibbs sampling,
+it marginalizes the topics of the words, so it can be compared between models for model selection.
+The held-out perplexity is `exp(-sum(log_ll) / (the total number of words))`.
+Every token counts as one regardless of the term weighting, and the words out of the vocabulary are skipped.
+This is supported only for `tomotopy.LDAModel` itself, not for its derived models.
+
+Parameters
+----------
+doc : Union[tomotopy.Document, Iterable[tomotopy.Document], tomotopy.utils.Corpus]
+    an instance of `tomotopy.Document`, a `list` of them or a raw corpus of `tomotopy.utils.Corpus`.
+    The documents are not modified.
+method : Union[int, tomotopy.HeldOutEstimator]
+    the estimator to be used
+particles : int
+    the number of particles of the left-to-right estimator, the number of samples of importance sampling,
+    or the number of samples (and of burn-in sweeps) of the harmonic mean per document
+workers : int
+    an integer indicating the number of workers. Each worker estimates its own range of documents.
+    If `workers` is 0, the number of cores in the system will be used.
+seed : int
+    the seed of the random generators. The result depends only on `seed`, not on `workers`. If omitted, a random seed is used.
+transform : Callable[dict, dict]
+    a callable object to manipulate arbitrary keyword arguments for a specific topic model. 
+    Available when `doc` is given as an instance of `tomotopy.utils.Corpus`.
+
+Returns
+-------
+log_ll : Union[float, List[float]]
+    the estimated log-likelihood of `doc` if it is a single `tomotopy.Document`, otherwise a list of them for each document
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+모델의 토픽-단어 분포를 고정한 채로 각 `doc`의 held-out 로그 가능도 log p(w|phi, alpha)를 추정합니다.
+짧은 깁스 샘플링의 한 상태로부터 얻는 `tomotopy.LDAModel.infer`의 로그 가능도와 달리, 단어들의 주제를 주변화하므로
+모델 선택을 위해 모델 간에 비교할 수 있습니다.
+held-out perplexity는 `exp(-sum(log_ll) / (전체 단어 수))`입니다.
+단어 가중치와 상관없이 모든 토큰은 1개로 세어지며, 어휘 사전에 없는 단어는 건너뜁니다.
+`tomotopy.LDAModel`에서만 지원되며, 이로부터 파생된 모델들에서는 지원되지 않습니다.
+
+Parameters
+----------
+doc : Union[tomotopy.Document, Iterable[tomotopy.Document], tomotopy.utils.Corpus]
+    `tomotopy.Document`의 인스턴스, 이들의 `list` 혹은 `tomotopy.utils.Corpus`의 인스턴스.
+    문헌들은 변경되지 않습니다.
+method : Union[int, tomotopy.HeldOutEstimator]
+    사용할 추정 방법
+particles : int
+    문헌마다 left-to-right 추정법의 입자 수, 중요도 샘플링의 표본 수, 혹은 조화 평균의 표본 수(와 번인 반복 횟수)
+workers : int
+    사용할 스레드의 개수. 각 스레드는 문헌의 일부 구간을 추정합니다.
+    만약 이 값을 0으로 설정할 경우 시스템 내의 가용한 모든 코어가 사용됩니다.
+seed : int
+    난수 생성기의 시드. 결과는 `workers`와 상관없이 `seed`에만 의존합니다. 생략하면 무작위 시드가 사용됩니다.
+transform : Callable[dict, dict]
+    특정한 토픽 모델에 맞춰 임의 키워드 인자를 조작하기 위한 호출가능한 객체.
+    `doc`이 `tomotopy.utils.Corpus`의 인스턴스로 주어진 경우에만 사용 가능합니다.
+
+Returns
+-------
+log_ll : Union[float, List[float]]
+    `doc`이 하나의 `tomotopy.Document`이면 그 로그 가능도의 추정치, 그렇지 않으면 각 문헌의 추정치로 구성된 `list`
 )"");
 
+DOC_SIGNATURE_EN_KO(LDA_make_inference_session__doc__,
+    "make_inference_session(self, workers=0, parallel=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return a new `tomotopy.InferenceSession` which keeps worker threads, scratch states and random generators between calls.
+Use it instead of `tomotopy.LDAModel.infer` when inferring many small batches of documents.
+
+Parameters
+----------
+workers : int
+    the number of worker threads kept by the session. If 0, it uses all available cores of the system.
+parallel : Union[int, tomotopy.ParallelScheme]
+    parallelism scheme for inference. The default value is ParallelScheme.DEFAULT, which lets tomotopy choose the best scheme by model.)"",
+u8R""(.. versionadded:: 0.12.3
+
+호출 사이에 작업 스레드, 임시 상태, 난수 생성기를 유지하는 새 `tomotopy.InferenceSession`을 반환합니다.
+작은 묶음의 문헌들을 여러 번 추론할 때 `tomotopy.LDAModel.infer` 대신 사용하십시오.
+
+Parameters
+----------
+workers : int
+    세션이 유지할 작업 스레드의 개수. 0일 경우 시스템 내의 가용한 모든 코어가 사용됩니다.
+parallel : Union[int, tomotopy.ParallelScheme]
+    추론에 사용할 병렬화 방법. 기본값은 ParallelScheme.DEFAULT로 이는 모델에 따라 최적의 방법을 tomotopy가 알아서 선택하도록 합니다.)"");
+
+DOC_SIGNATURE_EN_KO(InferenceSession___init____doc__,
+    "InferenceSession()",
+    u8R""(.. versionadded:: 0.12.3
+
+This type keeps resources for inference alive between calls. An instance of this type can be acquired from `tomotopy.LDAModel.make_inference_session`.
+Each document is sampled with the random generator of the worker it is assigned to, so the results are not reproducible across runs when `workers` is more than 1.
+Do not train the model while a call of `tomotopy.InferenceSession.infer` is running.)"",
+u8R""(.. versionadded:: 0.12.3
+
+이 타입은 추론에 사용되는 자원들을 호출 사이에 유지합니다. 이 타입의 인스턴스는 `tomotopy.LDAModel.make_inference_session`으로 얻을 수 있습니다.
+각 문헌은 그 문헌이 배정된 작업 스레드의 난수 생성기로 샘플링되므로, `workers`가 1보다 클 경우 실행마다 결과가 달라질 수 있습니다.
+`tomotopy.InferenceSession.infer`가 실행되는 동안 모델을 학습시키지 마십시오.)"");
+
+DOC_SIGNATURE_EN_KO(InferenceSession_infer__doc__,
+    "infer(self, doc, iter=100, tolerance=-1, together=False, transform=None, timeout=0, doc_timeout=0)",
+    u8R""(Return the inferred topic distribution from unseen `doc`s.
+The arguments and the return value are the same as `tomotopy.LDAModel.infer`, except that the workers and the parallelism scheme of the session are used.)"",
+u8R""(새로운 문헌인 `doc`에 대해 각각의 주제 분포를 추론하여 반환합니다.
+세션의 작업 스레드와 병렬화 방법이 사용된다는 점을 제외하면 인자와 반환값은 `tomotopy.LDAModel.infer`와 동일합니다.)"");
+
+DOC_VARIABLE_EN_KO(InferenceSession_workers__doc__,
+    u8R""(the number of worker threads of the session (read-only))"",
+    u8R""(세션의 작업 스레드 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(InferenceSession_parallel__doc__,
+    u8R""(the parallelism scheme of the session, see `tomotopy.ParallelScheme` (read-only))"",
+    u8R""(세션의 병렬화 방법, `tomotopy.ParallelScheme` 참조 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(InferenceSession_model__doc__,
+    u8R""(the topic model which the session infers with (read-only))"",
+    u8R""(세션이 추론에 사용하는 토픽 모델 (읽기전용))"");
+
 DOC_SIGNATURE_EN_KO(LDA_save__doc__,
-    "save(self, filename, full=True)",
+    "save(self, filename, full=True, aligned=False, compress=False, workers=0)",
     u8R""(Save the model instance to file `filename`. Return `None`.
 
 If `full` is `True`, the model with its all documents and state will be saved. If you want to train more after, use full model.
@@ -635,6 +1352,20 @@ If `False`, only topic parameters of the model will be saved. This model can be
 
 Since version 0.6.0, the model file format has been changed. 
 Thus model files saved in version 0.6.0 or later are not compatible with versions prior to 0.5.2.
+
+.. versionadded:: 0.12.3
+
+If `aligned` is `True`, large arrays like topic-word distributions are aligned in the file so that `tomotopy.LDAModel.load` with `mmap=True` can use them in place.
+Model files saved with `aligned=True` cannot be read by versions prior to 0.12.3.
+
+If `compress` is `True`, the words and topics of the documents are packed into fewer bits and the file is compressed block by block using `workers` threads
+(all cores if `workers` is 0). `tomotopy.LDAModel.load` detects and decompresses such files by itself, but versions prior to 0.12.3 cannot read them.
+It cannot be used together with `aligned`. The GIL is released while saving, so `tomotopy.SaveHandle` can save a snapshot of the model in the background.
+
+.. versionchanged:: 0.12.3
+
+The raw texts of the documents and the spans of their words are written as a few arrays for all the documents, instead of fields of each document.
+Versions prior to 0.12.3 can still read such files, but the documents loaded by them have no raw texts.
 )"",
 u8R""(현재 모델을 `filename` 경로의 파일에 저장합니다. `None`을 반환합니다.
 
@@ -645,10 +1376,24 @@ u8R""(현재 모델을 `filename` 경로의 파일에 저장합니다. `None`을
 
 0.6.0 버전부터 모델 파일 포맷이 변경되었습니다.
 따라서 0.6.0 이후 버전에서 저장된 모델 파일 포맷은 0.5.2 버전 이전과는 호환되지 않습니다.
+
+.. versionadded:: 0.12.3
+
+`aligned`가 `True`일 경우, 토픽-단어 분포 같은 큰 배열들을 파일 내에 정렬하여 저장합니다. 이렇게 저장된 파일은 `tomotopy.LDAModel.load`에 `mmap=True`를 주어 읽을 때 복사 없이 그대로 사용됩니다.
+`aligned=True`로 저장된 모델 파일은 0.12.3 이전 버전에서 읽을 수 없습니다.
+
+`compress`가 `True`일 경우, 문헌들의 단어와 주제를 더 적은 비트로 압축하고 파일을 블록 단위로 `workers`개의 스레드를 사용해 압축합니다(`workers`가 0이면 모든 코어를 사용).
+`tomotopy.LDAModel.load`는 이렇게 저장된 파일을 알아서 감지하여 압축을 풀지만, 0.12.3 이전 버전에서는 읽을 수 없습니다.
+`aligned`와 함께 사용할 수 없습니다. 저장하는 동안에는 GIL이 해제되므로 `tomotopy.SaveHandle`로 모델의 스냅샷을 백그라운드에서 저장할 수 있습니다.
+
+.. versionchanged:: 0.12.3
+
+문헌들의 원본 텍스트와 단어들의 위치는 각 문헌의 필드가 아니라 전체 문헌에 대한 몇 개의 배열로 저장됩니다.
+0.12.3 이전 버전에서도 이렇게 저장된 파일을 읽을 수 있지만, 읽어들인 문헌들에는 원본 텍스트가 없습니다.
 )"");
 
 DOC_SIGNATURE_EN_KO(LDA_saves__doc__,
-    "saves(self, full=True)",
+    "saves(self, full=True, compress=False, workers=0)",
     u8R""(.. versionadded:: 0.11.0
 
 Serialize the model instance into `bytes` object and return it. The arguments work the same as `tomotopy.LDAModel.save`.)"",
@@ -657,26 +1402,177 @@ u8R""(.. versionadded:: 0.11.0
 현재 모델을 직렬화하여 `bytes`로 만든 뒤 이를 반환합니다. 인자는 `tomotopy.LDAModel.save`와 동일하게 작동합니다.)"");
 
 
-DOC_SIGNATURE_EN_KO(LDA_load__doc__,
-    "load(filename)",
-    u8R""(Return the model instance loaded from file `filename`.)"",
-    u8R""(`filename` 경로의 파일로부터 모델 인스턴스를 읽어들여 반환합니다.)"");
+DOC_SIGNATURE_EN_KO(LDA_export_inference__doc__,
+    "export_inference(self, filename, dtype='float32')",
+    u8R""(.. versionadded:: 0.12.3
 
-DOC_SIGNATURE_EN_KO(LDA_loads__doc__,
-    "loads(data)",
-    u8R""(Return the model instance loaded from `data` in bytes-like object.)"",
-    u8R""(bytes-like object인 `data`로로부터 모델 인스턴스를 읽어들여 반환합니다.)"");
+Save only what inference needs (the vocabulary, alpha, term weights and the topic-word distribution) into file `filename`.
+The file can be loaded by `tomotopy.InferenceModel.load` and is much smaller than the one written by `tomotopy.LDAModel.save`, since it has no documents and no counts.
+This is supported only for `tomotopy.LDAModel` itself, not for its derived models.
 
-DOC_SIGNATURE_EN_KO(LDA_copy__doc__,
-    "copy(self)",
+Parameters
+----------
+filename : str
+    path of the file to be written
+dtype : str
+    storage type of the topic-word distribution, one of
+
+    - `'float32'`: 32-bit floats, the same precision as the model
+    - `'float16'`: 16-bit floats, half the size
+    - `'uint16'`: 16-bit integers scaled per topic, half the size with a uniform precision for each topic)"",
+u8R""(.. versionadded:: 0.12.3
+
+추론에 필요한 것들(어휘 사전, alpha, 단어 가중치, 토픽-단어 분포)만을 `filename` 경로의 파일에 저장합니다.
+이 파일은 `tomotopy.InferenceModel.load`로 읽어들일 수 있으며, 문헌과 카운트가 없으므로 `tomotopy.LDAModel.save`로 저장한 파일보다 훨씬 작습니다.
+`tomotopy.LDAModel`에서만 지원되며, 이로부터 파생된 모델들에서는 지원되지 않습니다.
+
+Parameters
+----------
+filename : str
+    저장될 파일의 경로
+dtype : str
+    토픽-단어 분포가 저장될 형식으로 다음 중 하나입니다.
+
+    - `'float32'`: 32비트 실수, 모델과 동일한 정밀도
+    - `'float16'`: 16비트 실수, 절반의 크기
+    - `'uint16'`: 토픽별로 축척된 16비트 정수, 절반의 크기로 토픽마다 균일한 정밀도를 가짐)"");
+
+DOC_SIGNATURE_EN_KO(LDA_restore_checkpoint__doc__,
+    "restore_checkpoint(self, filename, workers=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Restore the topics of the words and the hyperparameters from the checkpoint `filename` written by `tomotopy.LDAModel.train` with `checkpoint`,
+replay the deltas of it in `filename + '.delta'` in order if any, and rebuild all the counts from them with `workers` threads.
+A delta cut by a crash during writing is ignored with those after it. Return the number of the deltas replayed. The model should have the same documents, in the same order, and the same `k` as the model which wrote it,
+so it is usually built in the same way as that model. If the model is not prepared yet, it is prepared first with `workers` threads.
+The training can be resumed by `tomotopy.LDAModel.train` after it, though the state of the random number generator is not restored.
+This is supported only for `tomotopy.LDAModel` itself, not for its derived models.
+
+Parameters
+----------
+filename : str
+    path of the checkpoint
+workers : int
+    the number of threads to prepare the model and to rebuild the counts with. If it is 0, all the cores are used.)"",
+u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.train`에 `checkpoint`를 주어 저장한 체크포인트 `filename`으로부터 단어들의 토픽과 하이퍼 파라미터를 복원하고,
+`filename + '.delta'`에 그 델타들이 있다면 순서대로 재생한 뒤, 이로부터 모든 카운트를 `workers`개의 스레드로 다시 계산합니다.
+저장 중 중단되어 잘린 델타는 그 뒤의 델타들과 함께 무시됩니다. 재생된 델타의 개수를 반환합니다. 현재 모델은 체크포인트를 저장한 모델과 같은 문헌들을 같은 순서로, 같은 `k`를 가져야 하므로
+보통 그 모델과 같은 방식으로 생성합니다. 모델이 아직 준비되지 않았다면 `workers`개의 스레드로 먼저 준비합니다.
+이후 `tomotopy.LDAModel.train`으로 학습을 이어갈 수 있지만, 난수 생성기의 상태는 복원되지 않습니다.
+`tomotopy.LDAModel`에서만 지원되며, 이로부터 파생된 모델들에서는 지원되지 않습니다.
+
+Parameters
+----------
+filename : str
+    체크포인트 파일의 경로
+workers : int
+    모델을 준비하고 카운트를 다시 계산하는 데에 사용할 스레드의 개수. 0일 경우 모든 코어가 사용됩니다.)"");
+
+DOC_SIGNATURE_EN_KO(LDA_save_trace__doc__,
+    "save_trace(self, filename)",
+    u8R""(.. versionadded:: 0.12.3
+
+Save the trace of the last `tomotopy.LDAModel.train`, which was called with `tomotopy.LDAModel.tracing` set to `True`, into `filename`
+in the JSON format of Chrome trace events. It can be opened by https://ui.perfetto.dev or chrome://tracing.
+The calling thread is shown as `caller` and the workers as `worker 0`, `worker 1`, ..., and the times are in microseconds from the start of the training.
+
+Parameters
+----------
+filename : str
+    path of the file to be written)"",
+u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.tracing`을 `True`로 설정하고 호출한 마지막 `tomotopy.LDAModel.train`의 트레이스를 Chrome trace event의 JSON 형식으로 `filename`에 저장합니다.
+https://ui.perfetto.dev 나 chrome://tracing 에서 열 수 있습니다.
+호출한 스레드는 `caller`로, 작업자들은 `worker 0`, `worker 1`, ...로 표시되며, 시간은 학습 시작 시점부터의 마이크로초 단위입니다.
+
+Parameters
+----------
+filename : str
+    저장될 파일의 경로)"");
+
+DOC_SIGNATURE_EN_KO(LDA_load__doc__,
+    "load(filename, mmap=False)",
+    u8R""(Return the model instance loaded from file `filename`.
+
+.. versionadded:: 0.12.3
+
+If `mmap` is `True`, the file is memory-mapped and large arrays saved with `aligned=True` in `tomotopy.LDAModel.save` are used in place without copying.
+Processes loading the same file in this way share one copy of it in memory, as long as they only infer with the model.
+The mapping is copy-on-write, so the file itself is never modified.
+Files saved with `compress=True` are decompressed into memory using all cores, even if `mmap` is `True`.)"",
+    u8R""(`filename` 경로의 파일로부터 모델 인스턴스를 읽어들여 반환합니다.
+
+.. versionadded:: 0.12.3
+
+`mmap`이 `True`일 경우, 파일을 메모리에 매핑하고 `tomotopy.LDAModel.save`에서 `aligned=True`로 저장된 큰 배열들을 복사 없이 그대로 사용합니다.
+같은 파일을 이렇게 읽어들인 프로세스들은 모델로 추론만 수행하는 한 메모리 상의 사본 하나를 공유합니다.
+매핑은 쓰기 시 복사 방식이므로 파일 자체는 절대 변경되지 않습니다.
+`compress=True`로 저장된 파일은 `mmap`이 `True`이더라도 모든 코어를 사용해 메모리에 압축을 풀어 읽어들입니다.)"");
+
+DOC_SIGNATURE_EN_KO(LDA_loads__doc__,
+    "loads(data)",
+    u8R""(Return the model instance loaded from `data` in bytes-like object.)"",
+    u8R""(bytes-like object인 `data`로로부터 모델 인스턴스를 읽어들여 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(LDA_copy__doc__,
+    "copy(self)",
     u8R""(.. versionadded:: 0.12.0
 
-Return a new deep-copied instance of the current instance)"",
+Return a new deep-copied instance of the current instance
+
+.. versionchanged:: 0.12.3
+
+    For `tomotopy.LDAModel`, the copy shares the words and topics of the documents and the topic-word counts with the current instance,
+    and each of them copies them only when it is trained or prepared for the first time.
+    So forking many copies from a trained model doesn't take memory for the shared data until they are trained.
+    Since this converts the current instance to share its data, it cannot be called while `train`, `infer` or `save` is running on the instance.)"",
 u8R""(.. versionadded:: 0.12.0
 
-깊게 복사된 새 인스턴스를 반환합니다.)"");
+깊게 복사된 새 인스턴스를 반환합니다.
+
+.. versionchanged:: 0.12.3
+
+    `tomotopy.LDAModel`의 경우, 복사본은 문헌들의 단어와 주제, 주제-단어 개수를 현재 인스턴스와 공유하며,
+    각 인스턴스는 처음 학습되거나 준비될 때에야 이들을 복사합니다.
+    따라서 학습된 모델로부터 여러 복사본을 만들어도 학습하기 전까지는 공유되는 데이터를 위한 메모리가 추가로 필요하지 않습니다.
+    이를 위해 현재 인스턴스를 데이터를 공유하는 형태로 바꾸므로, 인스턴스에서 `train`, `infer`, `save`가 실행 중인 동안에는 호출할 수 없습니다.)"");
 
 
+DOC_SIGNATURE_EN_KO(LDA_estimate_train_memory__doc__,
+    "estimate_train_memory(self, workers=0, parallel=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the peak bytes expected while `tomotopy.LDAModel.train` runs with the given `workers` and `parallel`,
+which are resolved to the real number of workers and scheme the same way as `train` does.
+It is the sum of the current `tomotopy.LDAModel.memory_usage`, except the states of the workers of the previous training,
+and the states which `train` allocates for the workers, so that a feasible configuration can be chosen before training.
+If the model is not prepared yet, it is prepared first as `train` would do.
+Buffers which the samplers grow while sampling are not included.
+
+Parameters
+----------
+workers : int
+    the number of workers as in `tomotopy.LDAModel.train`
+parallel : Union[int, tomotopy.ParallelScheme]
+    the parallelism scheme as in `tomotopy.LDAModel.train`)"",
+u8R""(.. versionadded:: 0.12.3
+
+주어진 `workers`와 `parallel`로 `tomotopy.LDAModel.train`을 실행할 때 예상되는 최대 바이트 수를 반환합니다.
+작업자 수와 병렬화 방법은 `train`과 같은 방식으로 실제 값으로 결정됩니다.
+이전 학습의 작업자 상태를 제외한 현재의 `tomotopy.LDAModel.memory_usage`와 `train`이 작업자들을 위해 할당하는 상태의 합이므로, 학습 전에 실행 가능한 설정을 고를 수 있습니다.
+모델이 아직 준비되지 않았다면 `train`처럼 먼저 준비합니다.
+샘플링 중에 샘플러가 늘려가는 버퍼는 포함하지 않습니다.
+
+Parameters
+----------
+workers : int
+    `tomotopy.LDAModel.train`과 같은 작업자 수
+parallel : Union[int, tomotopy.ParallelScheme]
+    `tomotopy.LDAModel.train`과 같은 병렬화 방법)"");
+
 DOC_SIGNATURE_EN_KO(LDA_summary__doc__,
     "summary(self, initial_hp=True, params=True, topic_word_top_n=5, file=None, flush=False)",
     u8R""(.. versionadded:: 0.9.0
@@ -821,6 +1717,70 @@ u8R""(현재까지 수행된 학습의 총 반복 횟수 (읽기전용)
 
 .. versionadded:: 0.9.0)"");
 
+DOC_VARIABLE_EN_KO(LDA_train_stats__doc__,
+    u8R""(the time breakdown of the last call of `tomotopy.LDAModel.train` as a `dict` (read-only)
+
+.. versionadded:: 0.12.3
+
+It has the following keys. All times are in seconds, and the times of the phases are summed over the iterations.
+
+* `iterations`, `elapsed`: the number of iterations performed and the wall time of the whole training including callbacks
+* `sampling`: sampling the topics of the documents by the workers
+* `merging`: merging the states of the workers into the global state
+* `global_sampling`, `global_level`: sampling the model-wide variables, like the trees of `tomotopy.HLDAModel` or the tables of `tomotopy.HDPModel`
+* `distributing`: copying the merged state back to the workers
+* `optimizing`: optimizing the hyperparameters
+* `tokens`, `tokens_per_sec`: the number of tokens sampled and the number per second of `sampling`
+* `merge_bytes`: the bytes of the workers' states read by merging
+* `worker_busy`, `worker_idle`: the time each worker spent running tasks and waiting for them
+* `scheme`, `workers`: the `tomotopy.ParallelScheme` and the number of workers the last iterations ran with
+* `tuning`: the candidates tried by `tomotopy.ParallelScheme.AUTO` in this call, as a list of dicts with keys `scheme`, `workers`, `sec_per_iter` and `memory`.
+  `sec_per_iter` is -1 for the candidates which were not tried. It is empty if the decision of an earlier call was reused.
+
+The stats are collected at a few clock reads per iteration and per task, so they are always available.)"",
+u8R""(마지막 `tomotopy.LDAModel.train` 호출의 단계별 소요 시간을 담은 `dict` (읽기전용)
+
+.. versionadded:: 0.12.3
+
+다음의 키를 가집니다. 모든 시간은 초 단위이며, 각 단계의 시간은 모든 반복에 걸쳐 합산됩니다.
+
+* `iterations`, `elapsed`: 수행된 반복 횟수와 콜백을 포함한 전체 학습의 경과 시간
+* `sampling`: 작업자들이 문헌의 주제를 샘플링하는 단계
+* `merging`: 작업자들의 상태를 전역 상태로 병합하는 단계
+* `global_sampling`, `global_level`: `tomotopy.HLDAModel`의 트리나 `tomotopy.HDPModel`의 테이블처럼 모델 전체에 걸친 변수를 샘플링하는 단계
+* `distributing`: 병합된 상태를 작업자들에게 다시 복사하는 단계
+* `optimizing`: 하이퍼파라미터를 최적화하는 단계
+* `tokens`, `tokens_per_sec`: 샘플링된 토큰의 수와 `sampling` 단계의 초당 토큰 수
+* `merge_bytes`: 병합 단계에서 읽은 작업자 상태의 바이트 수
+* `worker_busy`, `worker_idle`: 각 작업자가 작업을 수행한 시간과 작업을 기다린 시간
+* `scheme`, `workers`: 마지막 반복들에 사용된 `tomotopy.ParallelScheme`과 작업자 수
+* `tuning`: 이번 호출에서 `tomotopy.ParallelScheme.AUTO`가 시도한 후보들로, `scheme`, `workers`, `sec_per_iter`, `memory`를 키로 갖는 dict의 리스트입니다.
+  시도되지 않은 후보의 `sec_per_iter`는 -1입니다. 이전 호출의 결정을 재사용한 경우 비어 있습니다.
+
+통계는 반복과 작업마다 몇 번의 시간 측정만으로 수집되므로 항상 제공됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_memory_usage__doc__,
+    u8R""(the bytes held by each structure of the model as a `dict` (read-only)
+
+.. versionadded:: 0.12.3
+
+The keys are the names of the structures, like `dictionary`, `vocabCf`, `docs.words`, `docs.Zs`, `docs.numByTopic`, `globalState` and `tState`,
+followed by the structures of each model such as `nodeTrees` of `tomotopy.HLDAModel`, `wordAliasTables` of `tomotopy.DTModel` or `docs.beta` of `tomotopy.CTModel`.
+`localData[i]` is the state of the `i`-th worker at the end of the last `tomotopy.LDAModel.train`, which is already freed.
+Arrays mapped from a file are not counted, and arrays shared with copies of the model are counted as `sharedArrays` by every model sharing them.
+
+See also `tomotopy.LDAModel.estimate_train_memory`.)"",
+u8R""(모델의 각 구조체가 차지하는 바이트 수를 담은 `dict` (읽기전용)
+
+.. versionadded:: 0.12.3
+
+키는 `dictionary`, `vocabCf`, `docs.words`, `docs.Zs`, `docs.numByTopic`, `globalState`, `tState` 같은 구조체의 이름이며,
+`tomotopy.HLDAModel`의 `nodeTrees`, `tomotopy.DTModel`의 `wordAliasTables`, `tomotopy.CTModel`의 `docs.beta` 같은 각 모델의 구조체가 뒤따릅니다.
+`localData[i]`는 마지막 `tomotopy.LDAModel.train`이 끝날 때의 `i`번째 작업자의 상태로, 이미 해제된 메모리입니다.
+파일에서 매핑된 배열은 세지 않으며, 모델의 복사본과 공유하는 배열은 공유하는 모든 모델에서 `sharedArrays`로 셉니다.
+
+`tomotopy.LDAModel.estimate_train_memory`도 참조하십시오.)"");
+
 DOC_VARIABLE_EN_KO(LDA_optim_interval__doc__,
     u8R""(get or set the interval for optimizing parameters
 
@@ -829,6 +1789,44 @@ u8R""(파라미터 최적화의 주기를 얻거나 설정합니다.
 
 기본값은 10이며, 0으로 설정할 경우 학습 과정에서 파라미터 최적화를 수행하지 않습니다.)"");
 
+DOC_VARIABLE_EN_KO(LDA_optim_eta__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether `eta` is optimized together with `alpha` every `tomotopy.LDAModel.optim_interval` iterations
+
+`eta` is optimized by Minka's fixed-point iteration, shared by all the words without their own priors set by `tomotopy.LDAModel.set_word_prior`.
+The topic-word counts are reduced in parallel once per optimization. The optimized value can be read from `tomotopy.LDAModel.eta`.
+The default value is `False`. Currently it is supported only by `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.optim_interval` 회 반복마다 `alpha`와 함께 `eta`를 최적화할지 여부를 얻거나 설정합니다.
+
+`eta`는 Minka의 고정점 반복법으로 최적화되며, `tomotopy.LDAModel.set_word_prior`로 사전 분포가 지정되지 않은 모든 단어들이 공유합니다.
+주제-단어 빈도는 최적화마다 한 번씩 병렬로 집계됩니다. 최적화된 값은 `tomotopy.LDAModel.eta`로 읽을 수 있습니다.
+기본값은 `False`입니다. 현재 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_reproducible__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether the training gives the same result with any number of workers for the same `seed`
+
+If it is `True`, each document is sampled from its own counter-based random stream (Philox4x32-10) keyed by the seed, the iteration and the document, 
+and the documents are split into a fixed number of chunks, each sampled against the topic-word counts of the previous iteration and its own changes.
+So the training always runs with `tomotopy.ParallelScheme.COPY_MERGE`, whatever `parallel` is given to `tomotopy.LDAModel.train`.
+The results are bit-identical with `tomotopy.TermWeight.ONE`, while the weighted counts of the other term weights may differ by rounding errors.
+It doesn't support `tomotopy.SamplingMethod.SPARSE` nor `tomotopy.LDAModel.dense_vocab_size`.
+The default value is `False`. Currently it is supported only by `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+같은 `seed`에 대해 작업자 수와 무관하게 같은 학습 결과를 얻을지 여부를 얻거나 설정합니다.
+
+`True`이면 각 문헌은 시드, 반복 횟수, 문헌으로 정해지는 자신만의 카운터 기반 난수열(Philox4x32-10)로 샘플링되고, 
+문헌들은 고정된 개수의 묶음으로 나뉘어 각각 이전 반복의 주제-단어 빈도와 자신의 변경분만을 바탕으로 샘플링됩니다.
+따라서 `tomotopy.LDAModel.train`에 주어진 `parallel`과 관계없이 항상 `tomotopy.ParallelScheme.COPY_MERGE`로 학습합니다.
+`tomotopy.TermWeight.ONE`에서는 결과가 비트 단위로 같으며, 다른 용어 가중치의 가중 빈도는 반올림 오차만큼 다를 수 있습니다.
+`tomotopy.SamplingMethod.SPARSE`와 `tomotopy.LDAModel.dense_vocab_size`는 지원하지 않습니다.
+기본값은 `False`입니다. 현재 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
 DOC_VARIABLE_EN_KO(LDA_burn_in__doc__,
     u8R""(get or set the burn-in iterations for optimizing parameters
 
@@ -837,6 +1835,399 @@ u8R""(파라미터 학습 초기의 Burn-in 단계의 반복 횟수를 얻거나
 
 기본값은 0입니다.)"");
 
+DOC_VARIABLE_EN_KO(LDA_sampling_method__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the sampling method used at Gibbs sampling, which is one of `tomotopy.SamplingMethod`
+
+Its default value is `tomotopy.SamplingMethod.DENSE`. Currently `tomotopy.SamplingMethod.SPARSE` is supported only by `tomotopy.LDAModel`,
+and `tomotopy.SamplingMethod.MH` is supported by `tomotopy.LDAModel`, `tomotopy.DMRModel`, `tomotopy.LLDAModel` and `tomotopy.PLDAModel`.)"",
+u8R""(.. versionadded:: 0.12.3
+
+깁스 샘플링에 사용할 샘플링 기법을 얻거나 설정합니다. 이 값은 `tomotopy.SamplingMethod` 중 하나입니다.
+
+기본값은 `tomotopy.SamplingMethod.DENSE`입니다. 현재 `tomotopy.SamplingMethod.SPARSE`는 `tomotopy.LDAModel`에서만 지원되며,
+`tomotopy.SamplingMethod.MH`는 `tomotopy.LDAModel`, `tomotopy.DMRModel`, `tomotopy.LLDAModel`, `tomotopy.PLDAModel`에서 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_dynamic_balancing__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether documents are distributed to workers dynamically during an iteration when `tomotopy.ParallelScheme.COPY_MERGE` is used
+
+`tomotopy.ParallelScheme.COPY_MERGE` splits documents into chunks having similar numbers of words.
+If it is `False`(default), each worker takes a fixed number of chunks at the start of an iteration.
+If it is `True`, chunks get smaller and each worker takes the next one whenever it finishes the previous one,
+which is useful when the sampling costs of documents vary a lot.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.COPY_MERGE`를 사용할 때 반복 도중에 문헌을 작업자에게 동적으로 분배할지 여부를 얻거나 설정합니다.
+
+`tomotopy.ParallelScheme.COPY_MERGE`는 문헌들을 단어 개수가 비슷한 묶음으로 나눕니다.
+`False`(기본값)인 경우 각 작업자는 반복이 시작될 때 정해진 수의 묶음을 맡습니다.
+`True`인 경우 묶음을 더 작게 나누고 각 작업자는 이전 묶음을 마칠 때마다 다음 묶음을 가져가므로,
+문헌마다 샘플링 비용이 크게 다를 때 유용합니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_doc_order__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the order in which workers visit documents when `tomotopy.ParallelScheme.PARTITION` is used, which is one of `tomotopy.DocOrder`
+
+Its default value is `tomotopy.DocOrder.SHUFFLED`. The other orders visit documents sharing vocabularies in turn,
+so that the topic counts of those vocabularies stay in the CPU cache. The order of `tomotopy.LDAModel.docs` itself is not changed.
+`tomotopy.DocOrder.WORD_MAJOR` visits tokens word by word and also applies to the single-threaded training.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.PARTITION`을 사용할 때 작업자가 문헌을 방문하는 순서를 얻거나 설정합니다. 이 값은 `tomotopy.DocOrder` 중 하나입니다.
+
+기본값은 `tomotopy.DocOrder.SHUFFLED`입니다. 나머지 순서들은 어휘를 공유하는 문헌들을 연달아 방문하므로,
+해당 어휘들의 주제별 개수가 CPU 캐시에 머무르게 됩니다. `tomotopy.LDAModel.docs` 자체의 순서는 바뀌지 않습니다.
+`tomotopy.DocOrder.WORD_MAJOR`는 토큰을 단어 단위로 방문하며, 단일 스레드 학습에도 적용됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_async_staleness__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the number of documents each worker samples between syncs of the topic totals when `tomotopy.ParallelScheme.ASYNC` is used
+
+Workers see the changes of the topic totals made by the others only when they sync, so a larger value is faster but samples from staler counts.
+Its default value is 16.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.ASYNC`를 사용할 때 각 작업자가 주제별 합계를 동기화하기 전까지 샘플링하는 문헌의 개수를 얻거나 설정합니다.
+
+작업자는 동기화할 때에만 다른 작업자가 바꾼 주제별 합계를 보게 되므로, 값이 클수록 빠르지만 더 오래된 개수로부터 샘플링하게 됩니다.
+기본값은 16입니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_async_recount_interval__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the interval of iterations at which all counts are recounted from the topic assignments when `tomotopy.ParallelScheme.ASYNC` is used
+
+Recounting corrects the drift of the shared counts, which may come from rounding errors with `tomotopy.TermWeight.IDF` or `tomotopy.TermWeight.PMI`.
+If it is 0(default), the counts are never recounted.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.ASYNC`를 사용할 때 주제 할당으로부터 모든 개수를 다시 세는 반복 간격을 얻거나 설정합니다.
+
+다시 세기는 `tomotopy.TermWeight.IDF`나 `tomotopy.TermWeight.PMI`에서 반올림 오차 등으로 인해 공유 개수가 어긋나는 것을 바로잡습니다.
+0(기본값)인 경우 다시 세지 않습니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_hierarchical_groups__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the number of groups into which the workers are split when `tomotopy.ParallelScheme.HIERARCHICAL` is used
+
+Each group keeps one copy of the topic-word counts, so more groups use more memory but cut the vocabulary into fewer and larger blocks.
+It is reduced to a divisor of the number of workers. If it is 0(default), it is about the square root of the number of workers.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.HIERARCHICAL`을 사용할 때 작업자들을 나눌 그룹의 개수를 얻거나 설정합니다.
+
+각 그룹은 토픽-단어 개수의 사본을 하나씩 가지므로, 그룹이 많을수록 메모리를 더 사용하지만 어휘 집합을 더 적고 큰 블록으로 나눕니다.
+작업자 수의 약수로 줄여서 사용됩니다. 0(기본값)인 경우 작업자 수의 제곱근 정도가 됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_pipelined_partition__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether the rounds of `tomotopy.ParallelScheme.PARTITION` are pipelined during training
+
+If it is `True`, each worker waits only for the one whose documents it samples next instead of all workers at every round,
+and merges its own vocabulary block as soon as it finishes, while the others are still sampling.
+The result is the same as with `False`(default), but less time is spent waiting for the slowest worker.
+It has no effect on the models derived from `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+학습 시 `tomotopy.ParallelScheme.PARTITION`의 각 단계를 파이프라인으로 처리할지 여부를 얻거나 설정합니다.
+
+`True`인 경우 각 작업자는 매 단계마다 모든 작업자를 기다리지 않고 다음에 샘플링할 문헌을 맡았던 작업자만 기다리며,
+자신의 어휘 블록을 마치는 즉시 다른 작업자가 샘플링하는 동안 이를 병합합니다.
+결과는 `False`(기본값)일 때와 같지만 가장 느린 작업자를 기다리는 시간이 줄어듭니다.
+`tomotopy.LDAModel`에서 파생된 모델에는 영향을 주지 않습니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_partition_rebalance_interval__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the interval of iterations at which the vocabulary blocks of `tomotopy.ParallelScheme.PARTITION` are rebalanced by their measured costs
+
+The vocabulary is first cut into blocks of similar numbers of tokens, but the cost of a token also depends on the sparsity of its topics
+and on the model, so some workers keep finishing late at every round. With a non-zero interval, the time spent on each block is measured
+and the blocks are cut again so that each takes a similar time, whenever the slowest one takes 10% more than the average.
+Since the blocks follow the measured times, the results are not reproducible across runs. It is ignored with `tomotopy.LDAModel.reproducible`.
+If it is 0(default), the blocks are cut only once.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.PARTITION`의 어휘 블록을 측정된 비용에 따라 다시 나누는 반복 간격을 얻거나 설정합니다.
+
+어휘는 처음에 토큰 수가 비슷한 블록들로 나뉘지만, 토큰의 비용은 그 주제들의 희소성과 모델에 따라서도 달라지므로 일부 작업자가 매 단계마다 늦게 끝나게 됩니다.
+0이 아닌 간격을 설정하면 각 블록에 걸린 시간을 측정하여, 가장 느린 블록이 평균보다 10% 이상 오래 걸릴 때마다 각 블록이 비슷한 시간이 걸리도록 다시 나눕니다.
+블록이 측정된 시간을 따르므로 결과는 실행마다 재현되지 않습니다. `tomotopy.LDAModel.reproducible`이 설정된 경우에는 무시됩니다.
+0(기본값)인 경우 블록을 한 번만 나눕니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_freeze_interval__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the interval of full sweeps when stable tokens are resampled less often during training
+
+If it is a positive integer, the model counts how many times in a row each token and each document kept their topics.
+A token kept for `s` samplings is resampled only with probability `2 ** -min(s // 4, 2)`,
+and a document whose tokens all kept their topics for `s` samplings is visited only once every `2 ** min(s // 4, 2)` iterations,
+except that every `freeze_interval`-th iteration samples all tokens.
+Late iterations get several times faster, at the cost of no longer being an exact Gibbs sweep between full sweeps.
+If it is 0(default), all tokens are sampled at every iteration.
+The counters are not saved, and it has no effect on inference or on the models derived from `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+학습 시 안정된 토큰을 덜 자주 샘플링할 때 전체 샘플링을 수행할 간격을 얻거나 설정합니다.
+
+양의 정수인 경우 모델은 각 토큰과 각 문헌이 몇 번 연속으로 주제를 유지했는지 셉니다.
+`s`번의 샘플링 동안 주제를 유지한 토큰은 `2 ** -min(s // 4, 2)`의 확률로만 다시 샘플링되며,
+모든 토큰이 `s`번의 샘플링 동안 주제를 유지한 문헌은 `2 ** min(s // 4, 2)`번의 반복마다 한 번씩만 방문됩니다.
+단, 매 `freeze_interval`번째 반복에서는 모든 토큰을 샘플링합니다.
+후반 반복이 몇 배 빨라지지만, 전체 샘플링 사이의 반복은 더 이상 정확한 깁스 샘플링이 아닙니다.
+0(기본값)인 경우 매 반복마다 모든 토큰을 샘플링합니다.
+이 횟수들은 저장되지 않으며, 추론이나 `tomotopy.LDAModel`에서 파생된 모델에는 영향을 주지 않습니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_collapse_duplicates__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether the documents with exactly the same words are collapsed when the model is prepared
+
+If it is `True`, the first training collapses the documents whose words are the same in the same order, like templated or boilerplate texts,
+into the first of them, which is sampled once for all of them and counts for each of them in the topic-word distributions.
+So each iteration samples the collapsed duplicates only once. The duplicates always have the same topics as their representative,
+so `LDAModel.docs`, the document-topic distributions and saved models still contain every document.
+It should be set before the first call of `LDAModel.train`. It is not saved,
+and it has no effect on the models derived from `tomotopy.LDAModel` or on models with `out_of_core_dir`. Default is `False`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+모델 준비 시 단어가 완전히 같은 문헌들을 하나로 합칠지를 얻거나 설정합니다.
+
+`True`인 경우 첫 학습 시 템플릿이나 상용구 문서처럼 같은 단어들이 같은 순서로 등장하는 문헌들을 그 중 첫 번째 문헌으로 합칩니다.
+이 대표 문헌은 나머지 모두를 대신해 한 번만 샘플링되며, 주제-단어 분포에는 각각의 문헌으로서 집계됩니다.
+따라서 매 반복에서 합쳐진 중복 문헌들은 한 번만 샘플링됩니다. 중복 문헌들은 항상 대표 문헌과 같은 주제를 가지므로
+`LDAModel.docs`, 문헌-주제 분포 및 저장된 모델에는 여전히 모든 문헌이 포함됩니다.
+첫 `LDAModel.train` 호출 전에 설정해야 합니다. 이 값은 저장되지 않으며,
+`tomotopy.LDAModel`에서 파생된 모델이나 `out_of_core_dir`을 사용하는 모델에는 영향을 주지 않습니다. 기본값은 `False`입니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_auto_memory_limit__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the memory limit in bytes of `tomotopy.ParallelScheme.AUTO`
+
+The candidates whose `tomotopy.LDAModel.estimate_train_memory` exceeds it are not tried.
+If all of them exceed it, the one needing the least memory is chosen. Its default value is 0, which means no limit.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.AUTO`의 메모리 한도를 바이트 단위로 얻거나 설정합니다.
+
+`tomotopy.LDAModel.estimate_train_memory`가 이를 넘는 후보는 시도하지 않습니다.
+모든 후보가 한도를 넘으면 메모리가 가장 적게 드는 후보를 고릅니다. 기본값은 0이며, 한도가 없음을 뜻합니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_numa_aware__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether the workers of `tomotopy.LDAModel.train` are bound to NUMA nodes
+
+If it is `True`, each worker is bound to a cpu which the process is allowed to run on. Workers are spread over the NUMA nodes in proportion to their cpus, with consecutive workers on the same node, and each allocates its own copy of the model state on its node.
+With `tomotopy.ParallelScheme.PARTITION`, the topic counts of the vocabularies assigned to each worker are also moved to the worker's node.
+This reduces the traffic between sockets on multi-socket machines. Binding workers is supported only on Linux, and if it fails, the workers are left unbound. Its default value is `False`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.train`의 작업자들을 NUMA 노드에 고정할지 여부를 얻거나 설정합니다.
+
+`True`인 경우 각 작업자는 프로세스가 실행될 수 있는 CPU에 고정됩니다. 작업자들은 각 NUMA 노드의 CPU 수에 비례하여 나뉘며 연속된 작업자는 같은 노드에 놓이고, 모델 상태의 복사본을 자신의 노드에 할당합니다.
+`tomotopy.ParallelScheme.PARTITION`에서는 각 작업자가 맡은 어휘들의 주제별 개수도 작업자의 노드로 옮겨집니다.
+여러 소켓을 가진 장비에서 소켓 간의 통신량을 줄여줍니다. 작업자 고정은 Linux에서만 지원되며, 실패할 경우 작업자들은 고정되지 않습니다. 기본값은 `False`입니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_tracing__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether `tomotopy.LDAModel.train` records a trace of its execution, which is saved by `tomotopy.LDAModel.save_trace`
+
+The trace has the spans of the phases of every iteration on the calling thread, like `sampling`, `merging` and `optimizing`,
+and a span for every task and chunk run by each worker, named after the phase it belongs to, with the time it waited to be started.
+It shows which worker ran which part of the work and where the workers wait for a serial phase or for a slow chunk.
+Each span takes tens of bytes until the next training, and its default value is `False`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.train`이 실행 과정의 트레이스를 기록할지 여부를 얻거나 설정합니다. 기록된 트레이스는 `tomotopy.LDAModel.save_trace`로 저장할 수 있습니다.
+
+트레이스는 호출한 스레드에서 매 반복마다 수행된 `sampling`, `merging`, `optimizing` 등 각 단계의 구간과,
+각 작업자가 수행한 모든 작업 및 청크의 구간을 가지며, 작업과 청크는 속한 단계의 이름과 시작되기까지 기다린 시간을 가집니다.
+어느 작업자가 어느 부분을 수행했는지, 작업자들이 직렬 단계나 느린 청크를 어디에서 기다리는지를 보여줍니다.
+구간마다 다음 학습까지 수십 바이트를 차지하며, 기본값은 `False`입니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_dense_vocab_size__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the number of the most frequent vocabularies whose topic counts are stored in a dense matrix
+
+If it is 0(default), the counts of all vocabularies are stored densely, which needs `k * len(used_vocabs)` numbers for the model and for each worker of `tomotopy.ParallelScheme.COPY_MERGE`.
+Otherwise, only the non-zero counts of the other, rarer, vocabularies are stored, which saves a lot of memory for a large vocabulary.
+It can be changed at any time except during training, and saved models are always written with the dense layout.
+Currently it is supported only by `tomotopy.LDAModel` without word priors set by `tomotopy.LDAModel.set_word_prior`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+주제별 개수를 밀집 행렬에 저장할, 가장 빈도가 높은 어휘의 개수를 얻거나 설정합니다.
+
+0(기본값)인 경우 모든 어휘의 개수를 밀집 행렬에 저장하며, 모델과 `tomotopy.ParallelScheme.COPY_MERGE`의 각 작업자마다 `k * len(used_vocabs)`개의 수가 필요합니다.
+그렇지 않은 경우 나머지 희귀한 어휘들은 0이 아닌 개수만 저장하므로, 어휘 집합이 큰 경우 메모리를 크게 절약할 수 있습니다.
+학습 중이 아니라면 언제든지 바꿀 수 있으며, 저장된 모델은 항상 밀집 형태로 기록됩니다.
+현재 `tomotopy.LDAModel.set_word_prior`로 단어 사전 분포를 설정하지 않은 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_compact__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+whether the model was created with `compact=True` (read-only))"",
+    u8R""(.. versionadded:: 0.12.3
+
+모델이 `compact=True`로 생성되었는지 여부 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(LDA_out_of_core_dir__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the directory where the documents of the model are kept in temporary files during training
+
+If it is set, the words, topics and weights of the documents and their topic counts are moved into files in the directory at the start of the training,
+and the files are mapped into memory. Documents are sampled in the order they are stored and the next ones are read ahead,
+so the OS keeps in memory only the parts being sampled, along with the topic-word counts.
+This allows training on corpora whose documents don't fit in memory at once. The files are removed when the model is deleted.
+If it is `None`(default), all documents are kept in memory. Setting it on a trained model moves the documents immediately.
+Currently it is supported only by `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+학습 중에 모델의 문헌들을 임시 파일로 보관할 디렉토리를 얻거나 설정합니다.
+
+설정된 경우 학습이 시작될 때 문헌들의 단어, 주제, 가중치와 문헌별 주제 개수가 이 디렉토리의 파일로 옮겨지며, 파일은 메모리에 매핑됩니다.
+문헌들은 저장된 순서대로 샘플링되고 다음 문헌들을 미리 읽어두므로, 운영체제는 주제-단어 개수와 함께 샘플링 중인 부분만 메모리에 유지합니다.
+따라서 문헌 전체가 한 번에 메모리에 들어가지 않는 말뭉치로도 학습할 수 있습니다. 파일은 모델이 삭제될 때 제거됩니다.
+`None`(기본값)인 경우 모든 문헌을 메모리에 유지합니다. 학습된 모델에 설정하면 문헌들을 즉시 옮깁니다.
+현재 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_new_doc_sweeps__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the number of sweeps over only the documents added after training, before all documents are trained together
+
+Documents added by `tomotopy.LDAModel.add_doc` to a trained model are prepared at the next call of `tomotopy.LDAModel.train`
+without preparing the others again. Their new words are added to the vocabularies if they pass `min_cf` and `min_df`,
+while the words removed before stay removed. Then only the new documents are sampled this many times,
+so that their topics settle against the learned topics first. The default value is 0.
+Currently it is supported only by `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+학습 이후에 추가된 문헌들만을 샘플링하는 횟수를 얻거나 설정합니다. 이 샘플링은 전체 문헌을 함께 학습하기 전에 수행됩니다.
+
+학습된 모델에 `tomotopy.LDAModel.add_doc`로 추가된 문헌들은 다음 `tomotopy.LDAModel.train` 호출 시 나머지 문헌을 다시 준비하지 않고 준비됩니다.
+새 단어들은 `min_cf`와 `min_df`를 통과하면 어휘 목록에 추가되며, 이전에 제외된 단어들은 계속 제외됩니다.
+그 뒤 새 문헌들만을 이 횟수만큼 샘플링하여, 학습된 주제에 맞춰 새 문헌의 주제가 먼저 자리잡도록 합니다. 기본값은 0입니다.
+현재 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_ll_sample_docs__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the number of documents sampled to estimate `tomotopy.LDAModel.ll_per_word` and `tomotopy.LDAModel.perplexity`
+
+If it is positive and less than the number of documents, the log-likelihood of the documents is estimated
+from this many documents sampled at random, while that of the topic-word distributions is computed exactly.
+The same documents are sampled at every evaluation, so the estimates are comparable across iterations.
+The default value is 0, which evaluates all documents.
+The evaluation runs in parallel on the workers of the last `tomotopy.LDAModel.train` regardless of this value.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.ll_per_word`와 `tomotopy.LDAModel.perplexity`를 추정하기 위해 표본으로 뽑는 문헌의 개수를 얻거나 설정합니다.
+
+양수이면서 문헌 개수보다 작은 경우, 문헌들의 로그 가능도는 무작위로 뽑은 이 개수의 문헌들로부터 추정되며
+주제-단어 분포의 로그 가능도는 정확하게 계산됩니다. 매 평가마다 같은 문헌들을 뽑으므로 반복 간에 추정치를 비교할 수 있습니다.
+기본값은 0이며, 이 경우 모든 문헌을 평가합니다.
+이 값과 무관하게 평가는 마지막 `tomotopy.LDAModel.train`의 작업자들을 사용하여 병렬로 수행됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_incremental_ll__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether `tomotopy.LDAModel.ll_per_word` is updated incrementally
+
+If it is `True`, the model keeps the counts and the sums of log-gamma terms of the last evaluation,
+and the next evaluation recomputes only the terms whose counts have changed since then.
+The result equals that of the full evaluation up to numerical error, so it is cheap enough to monitor the convergence at every iteration,
+at the cost of keeping a copy of the topic counts of all documents and of the topic-word counts.
+It takes precedence over `tomotopy.LDAModel.ll_sample_docs`. The default value is `False`.
+Currently it is supported only by `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.ll_per_word`를 점진적으로 갱신할지 여부를 얻거나 설정합니다.
+
+`True`인 경우 모델은 마지막 평가 때의 빈도와 로그 감마 항들의 합을 유지하며, 다음 평가에서는 그 이후 빈도가 바뀐 항들만을 다시 계산합니다.
+결과는 수치 오차를 제외하면 전체 평가와 같으므로 매 반복마다 수렴 여부를 확인할 만큼 비용이 적습니다.
+대신 모든 문헌의 주제 빈도와 주제-단어 빈도의 사본을 유지합니다.
+`tomotopy.LDAModel.ll_sample_docs`보다 우선합니다. 기본값은 `False`입니다.
+현재 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_frozen_inference__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether `tomotopy.LDAModel.infer` treats the topic-word distributions of the model as fixed
+
+If it is `True`, the topics of the inferred documents are sampled from the normalized topic-word distributions,
+which are computed once after each training and cached, instead of the topic-word counts updated by the inferred documents themselves.
+It makes repeated inference on a model which is not trained any more cheaper, and the result differs only slightly
+as long as the inferred documents are small compared to the training corpus.
+It is ignored if word priors are set by `tomotopy.LDAModel.set_word_prior`. The default value is `False`.
+Currently it is supported only by `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.infer`가 모델의 토픽-단어 분포를 고정된 것으로 다룰지 여부를 얻거나 설정합니다.
+
+`True`인 경우 추론되는 문헌들의 토픽은 그 문헌들에 의해 갱신되는 토픽-단어 빈도 대신,
+학습 후 한 번 계산되어 캐시되는 정규화된 토픽-단어 분포로부터 샘플링됩니다.
+더 이상 학습하지 않는 모델에 대해 반복적으로 추론하는 비용을 줄여주며, 추론하는 문헌들이 학습 말뭉치에 비해 작다면 결과의 차이는 미미합니다.
+`tomotopy.LDAModel.set_word_prior`로 단어 사전 분포가 설정된 경우에는 무시됩니다. 기본값은 `False`입니다.
+현재 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_fold_in_em__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether `tomotopy.LDAModel.infer` folds documents in by EM instead of Gibbs sampling
+
+If it is `True`, the topic-word distributions of the model are fixed as with `tomotopy.LDAModel.frozen_inference`,
+and the topic distribution of each document is estimated by EM over its unique words.
+Each document stops as soon as the mean change of its topic distribution gets smaller than `tolerance` of `infer`
+(0.001 if it is not positive), so most documents take far fewer than `iter` iterations.
+The topic of each word is then drawn from its final responsibility, and the returned log-likelihood of each document is
+the log probability of its words given its topic distribution and the topic-word distributions.
+It takes precedence over `tomotopy.LDAModel.frozen_inference`, and is ignored if word priors are set by `tomotopy.LDAModel.set_word_prior`.
+The default value is `False`. Currently it is supported only by `tomotopy.LDAModel`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.LDAModel.infer`가 깁스 샘플링 대신 EM으로 문헌들을 추론할지 여부를 얻거나 설정합니다.
+
+`True`인 경우 `tomotopy.LDAModel.frozen_inference`처럼 모델의 토픽-단어 분포는 고정되며,
+각 문헌의 토픽 분포는 그 문헌의 고유 단어들에 대한 EM으로 추정됩니다.
+각 문헌은 토픽 분포의 평균 변화량이 `infer`의 `tolerance`(양수가 아닐 경우 0.001)보다 작아지는 즉시 멈추므로
+대부분의 문헌은 `iter`보다 훨씬 적은 반복만을 수행합니다.
+이후 각 단어의 토픽은 최종 책임도로부터 뽑히며, 반환되는 각 문헌의 로그가능도는 토픽 분포와 토픽-단어 분포가 주어졌을 때 단어들의 로그 확률입니다.
+`tomotopy.LDAModel.frozen_inference`보다 우선하며, `tomotopy.LDAModel.set_word_prior`로 단어 사전 분포가 설정된 경우에는 무시됩니다.
+기본값은 `False`입니다. 현재 `tomotopy.LDAModel`에서만 지원됩니다.)"");
+
+DOC_VARIABLE_EN_KO(LDA_topic_word_counts__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+a read-only `numpy.ndarray` view of the topic-word counts of the model (read-only)
+
+It shares the memory of the model instead of copying it, so it reflects the counts as the model is trained further.
+Its dtype is int32 if `tw` is `tomotopy.TermWeight.ONE` and float32 otherwise, and it is in Fortran order.
+Its shape is (`k`, `len(vocabs)`) for `tomotopy.LDAModel`, but derived models may have more rows for their additional topics.
+It is not available for `tomotopy.HPAModel` or when `tomotopy.LDAModel.dense_vocab_size` keeps some vocabularies out of the dense storage.
+While any view exists, preparing newly added documents in `tomotopy.LDAModel.train` and changing `tomotopy.LDAModel.dense_vocab_size` raise `BufferError`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+모델의 토픽-단어 빈도에 대한 읽기 전용 `numpy.ndarray` 뷰 (읽기전용)
+
+모델의 메모리를 복사하지 않고 공유하므로 모델을 추가로 학습하면 그 빈도가 반영됩니다.
+dtype은 `tw`가 `tomotopy.TermWeight.ONE`일 때 int32, 그 외에는 float32이며 Fortran 순서입니다.
+`tomotopy.LDAModel`에서 모양은 (`k`, `len(vocabs)`)이지만, 파생 모델은 추가적인 토픽들을 위해 더 많은 행을 가질 수 있습니다.
+`tomotopy.HPAModel`이거나 `tomotopy.LDAModel.dense_vocab_size`로 인해 일부 어휘가 밀집 저장소 밖에 있는 경우에는 사용할 수 없습니다.
+뷰가 존재하는 동안 `tomotopy.LDAModel.train`에서 새로 추가된 문헌을 준비하거나 `tomotopy.LDAModel.dense_vocab_size`를 변경하면 `BufferError`가 발생합니다.)"");
+
 DOC_VARIABLE_EN_KO(LDA_removed_top_words__doc__,
     u8R""(a `list` of `str` which is a word removed from the model if you set `rm_top` greater than 0 at initializing the model (read-only))"",
     u8R""(모델 생성시 `rm_top` 파라미터를 1 이상으로 설정한 경우, 빈도수가 높아서 모델에서 제외된 단어의 목록을 보여줍니다. (읽기전용))"");
@@ -1382,7 +2773,7 @@ normalize : bool
 
 
 DOC_SIGNATURE_EN_KO(GDMR_tdf_linspace__doc__,
-    "tdf_linspace(self, numeric_metadata_start, numeric_metadata_stop, num, metadata='', multi_metadata=[], endpoint=True, normalize=True)",
+    "tdf_linspace(self, numeric_metadata_start, numeric_metadata_stop, num, metadata='', multi_metadata=[], endpoint=True, normalize=True, workers=0)",
     u8R""(Calculate a topic distribution for given `metadata` value. It returns a list with length `k`.
 
 .. versionchanged:: 0.11.0
@@ -1391,6 +2782,10 @@ DOC_SIGNATURE_EN_KO(GDMR_tdf_linspace__doc__,
 
     A new argument `multi_metadata` for multiple values of metadata was added.
 
+.. versionchanged:: 0.12.3
+
+    A new argument `workers` was added. The samples are evaluated in blocks by vectorized kernels.
+
 Parameters
 ----------
 numeric_metadata_start : Iterable[float]
@@ -1407,6 +2802,8 @@ endpoint : bool
     If True, `metadata_stop` is the last sample. Otherwise, it is not included. Default is True.
 normalize : bool
     If true, the method returns probabilities for each topic in range [0, 1]. Otherwise, it returns raw values in logit.
+workers : int
+    an integer indicating the number of workers to evaluate the samples. If `workers` is 0, the number of cores in the system will be used.
 
 Returns
 -------
@@ -1421,6 +2818,10 @@ u8R""(주어진 `metadata`에 대해 토픽 분포를 계산하여, `k` 길이
 
     여러 개의 메타데이터를 입력하는데 쓰이는 `multi_metadata`가 추가되었습니다.
 
+.. versionchanged:: 0.12.3
+
+    새 인자 `workers`가 추가되었습니다. 샘플들은 벡터화된 커널로 블록 단위로 계산됩니다.
+
 Parameters
 ----------
 numeric_metadata_start : Iterable[float]
@@ -1437,6 +2838,8 @@ endpoint : bool
     참인 경우 `metadata_stop`이 마지막 샘플이 됩니다. 거짓인 경우 끝값이 샘플에 포함되지 않습니다. 기본값은 참입니다.
 normalize : bool
     참인 경우, 각 값이 [0, 1] 범위에 있는 확률 분포를 반환합니다. 거짓인 경우 logit값을 그대로 반환합니다.
+workers : int
+    샘플을 계산하는 데에 사용할 작업자 수. 0으로 설정할 경우 시스템 내의 가용한 모든 코어가 사용됩니다.
 )"");
 
 
@@ -1577,9 +2980,13 @@ topic_id : int
 )"");
 
 DOC_SIGNATURE_EN_KO(HDP_convert_to_lda__doc__,
-    "convert_to_lda(self, topic_threshold=0.0)",
+    "convert_to_lda(self, topic_threshold=0.0, move_docs=False)",
     u8R""(.. versionadded:: 0.8.0
 
+.. versionchanged:: 0.12.3
+
+    A new argument `move_docs` was added. The documents of a trained model are converted in place and in parallel, without reinitializing them.
+
 Convert the current HDP model to equivalent LDA model and return `(new_lda_model, new_topic_id)`.
 Topics with proportion less than `topic_threshold` are removed in `new_lda_model`.
 
@@ -1591,9 +2998,17 @@ Parameters
 topic_threshold : float
     Topics with proportion less than this value is removed in new LDA model.
     The default value is 0, and it means no topic except not alive is removed.
+move_docs : bool
+    If true, the documents are moved into `new_lda_model` instead of being copied, which saves time and memory for large corpora.
+    The current model is left empty, so any use of it after the conversion raises `RuntimeError`.
+    It cannot be set while `infer` or `save` is running on the current model or views of the arrays of its documents exist.
 )"",
 u8R""(.. versionadded:: 0.8.0
 
+.. versionchanged:: 0.12.3
+
+    새 인자 `move_docs`가 추가되었습니다. 학습된 모델의 문헌들은 다시 초기화되지 않고 병렬로 그 자리에서 변환됩니다.
+
 현재의 HDP 모델을 동등한 LDA모델로 변환하고, `(new_lda_mode, new_topic_id)`를 반환합니다.
 이 때 `topic_threshold`보다 작은 비율의 토픽은 `new_lda_model`에서 제거됩니다.
 
@@ -1605,6 +3020,10 @@ Parameters
 topic_threshold : float
     이 값보다 작은 비율의 토픽은 새 LDA 모델에서 제거됩니다.
     기본값은 0이며, 이 경우 유효하지 않는 토픽을 제외한 모든 토픽이 LDA 모델에 포함됩니다.
+move_docs : bool
+    참일 경우 문헌들을 복사하지 않고 `new_lda_model`로 옮깁니다. 큰 말뭉치에서 시간과 메모리를 절약할 수 있습니다.
+    현재 모델은 비게 되므로, 변환 후에 현재 모델을 사용하면 `RuntimeError`가 발생합니다.
+    현재 모델에서 `infer`나 `save`가 실행 중이거나 문헌들의 배열에 대한 뷰가 남아 있는 동안에는 참으로 설정할 수 없습니다.
 )"");
 
 DOC_VARIABLE_EN_KO(HDP_gamma__doc__,
@@ -2709,6 +4128,37 @@ doc : tomotopy.Document
     응답 변수를 추정하려하는 문헌의 인스턴스 혹은 인스턴스들의 list
 )"");
 
+DOC_SIGNATURE_EN_KO(SLDA_estimate_batch__doc__,
+    "estimate_batch(self, doc, workers=0)",
+    u8R""(.. versionadded:: 0.12.3
+
+Return the estimated response variables of many documents at once as a `numpy.ndarray` of shape (`len(doc)`, `f`).
+The topic proportions of the documents are computed in parallel and all the variables are evaluated with one matrix product per worker,
+which is much faster than calling `tomotopy.SLDAModel.estimate` for each document.
+As with `estimate`, unseen documents should be inferred by `tomotopy.LDAModel.infer` first.
+
+Parameters
+----------
+doc : Union[Iterable[tomotopy.Document], tomotopy.utils.Corpus]
+    a list of documents of this model, or a corpus returned by `tomotopy.LDAModel.infer` of this model
+workers : int
+    the number of workers. If `workers` is 0, the number of cores in the system will be used.
+)"",
+u8R""(.. versionadded:: 0.12.3
+
+많은 문헌의 추정된 응답 변수를 한 번에 (`len(doc)`, `f`) 모양의 `numpy.ndarray`로 반환합니다.
+문헌들의 토픽 비율을 병렬로 계산하고 모든 변수를 작업자마다 한 번의 행렬곱으로 계산하므로,
+각 문헌마다 `tomotopy.SLDAModel.estimate`를 호출하는 것보다 훨씬 빠릅니다.
+`estimate`와 마찬가지로 새로운 문헌은 먼저 `tomotopy.LDAModel.infer`로 추론해야 합니다.
+
+Parameters
+----------
+doc : Union[Iterable[tomotopy.Document], tomotopy.utils.Corpus]
+    이 모델의 문헌들의 list, 혹은 이 모델의 `tomotopy.LDAModel.infer`가 반환한 corpus
+workers : int
+    사용할 스레드의 개수. 0으로 설정할 경우 시스템 내의 가용한 모든 코어가 사용됩니다.
+)"");
+
 DOC_VARIABLE_EN_KO(SLDA_f__doc__,
     u8R""(the number of response variables (read-only))"",
     u8R""(응답 변수의 개수 (읽기전용))"");
@@ -3042,6 +4492,11 @@ transform : Callable[dict, dict]
     .. versionadded:: 0.6.0
 
     a callable object to manipulate arbitrary keyword arguments for a specific topic model
+
+.. versionchanged:: 0.12.3
+
+    Once at least half of the blocks of topics are dead during training, the live topics are moved together,
+    so the topic ids may change between calls of `tomotopy.HLDAModel.train`. `tomotopy.HLDAModel.k` shrinks accordingly.
 )"",
 u8R""(이 타입은 Hierarchical LDA 토픽 모델의 구현체를 제공합니다. 주요 알고리즘은 다음 논문에 기초하고 있습니다:
 
@@ -3085,6 +4540,11 @@ transform : Callable[dict, dict]
     .. versionadded:: 0.6.0
 
     특정한 토픽 모델에 맞춰 임의 키워드 인자를 조작하기 위한 호출가능한 객체
+
+.. versionchanged:: 0.12.3
+
+    학습 중 토픽 블록의 절반 이상이 죽으면 살아있는 토픽들을 한데 모으므로,
+    `tomotopy.HLDAModel.train` 호출 사이에 토픽 번호가 바뀔 수 있습니다. `tomotopy.HLDAModel.k`도 그만큼 줄어듭니다.
 )"");
 
 DOC_SIGNATURE_EN_KO(HLDA_is_live_topic__doc__,
@@ -3184,6 +4644,41 @@ DOC_VARIABLE_EN_KO(HLDA_depth__doc__,
     u8R""(the number of depth (read-only))"",
     u8R""(현재 모델의 총 깊이 (읽기전용))"");
 
+DOC_VARIABLE_EN_KO(HLDA_path_batch__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the number of documents per worker whose paths are sampled at once
+
+If it is 0(default), the paths of documents are sampled one by one at each iteration.
+Otherwise, the workers of `tomotopy.HLDAModel.train` sample the paths of `path_batch * workers` documents concurrently
+against the same snapshot of the tree, and new topics are made for them after all of them are sampled.
+A larger value scales better with the number of workers, but the documents of a batch don't see the paths chosen by each other.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+한 번에 경로를 샘플링할 작업자당 문헌의 개수를 얻거나 설정합니다.
+
+0(기본값)인 경우 매 반복마다 문헌들의 경로를 하나씩 샘플링합니다.
+그렇지 않은 경우 `tomotopy.HLDAModel.train`의 작업자들은 `path_batch * workers`개의 문헌의 경로를 동일한 트리 스냅샷을 바탕으로 동시에 샘플링하며,
+새로운 토픽은 이들을 모두 샘플링한 뒤에 만들어집니다.
+값이 클수록 작업자 수에 따라 더 잘 확장되지만, 한 묶음 안의 문헌들은 서로가 선택한 경로를 보지 못합니다.)"");
+
+DOC_VARIABLE_EN_KO(HLDA_path_prune_threshold__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the log-likelihood margin used for pruning the path search
+
+If it is 0(default), the likelihoods of all the paths of the tree are calculated for each document.
+Otherwise, subtrees whose probability of being reached is lower than the likelihood of the current path of the document by more than this margin
+are skipped while training, because no path through them can be more likely than that.
+The probability mass dropped by a subtree is at most `exp(-path_prune_threshold)` times that of the current path, so a value around 20 is usually safe.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+경로 탐색의 가지치기에 사용할 로그 가능도 여유폭을 얻거나 설정합니다.
+
+0(기본값)인 경우 각 문헌마다 트리의 모든 경로에 대한 가능도를 계산합니다.
+그렇지 않은 경우 학습 중에 도달할 확률이 문헌의 현재 경로의 가능도보다 이 값 이상 낮은 하위 트리는 건너뜁니다. 그 하위 트리를 지나는 어떤 경로도 현재 경로보다 가능도가 높을 수 없기 때문입니다.
+하위 트리 하나가 누락시키는 확률 질량은 현재 경로의 `exp(-path_prune_threshold)`배 이하이므로, 보통 20 정도의 값이면 안전합니다.)"");
+
 /*
     class DT
 */
@@ -3442,6 +4937,24 @@ DOC_VARIABLE_EN_KO(DT_num_docs_by_timepoint__doc__,
     u8R""(the number of documents in the model by timepoint (read-only))"",
     u8R""(각 시점별 모델 내 문헌 개수 (읽기전용))"");
 
+DOC_VARIABLE_EN_KO(DT_time_partition__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set whether `tomotopy.ParallelScheme.PARTITION` partitions the timepoints instead of the vocabulary
+
+If it is `True`, each worker owns whole timepoints, balanced by their numbers of words, and samples their documents
+directly on the model's counts, since documents of different timepoints never share counts.
+No worker copies any part of the topic-word counts, and nothing is merged after sampling.
+It works best when there are many more timepoints than workers. The default value is `False`.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+`tomotopy.ParallelScheme.PARTITION`이 어휘 대신 시점을 분할할지 여부를 얻거나 설정합니다.
+
+`True`인 경우 각 작업자는 단어 수에 따라 균형을 맞춘 시점들을 통째로 맡아, 그 문헌들을 모델의 카운트 위에서 바로 샘플링합니다.
+서로 다른 시점의 문헌들은 카운트를 공유하지 않기 때문입니다.
+작업자들은 토픽-단어 카운트를 전혀 복사하지 않으며, 샘플링 후 병합도 하지 않습니다.
+시점의 개수가 작업자 수보다 훨씬 많을 때 가장 효과적입니다. 기본값은 `False`입니다.)"");
+
 DOC_VARIABLE_EN_KO(DT_alpha__doc__,
     u8R""(per-document topic distribution in the shape `[num_timepoints, k]` (read-only)
 
@@ -3545,3 +5058,724 @@ DOC_VARIABLE_EN_KO(PT_p__doc__,
 u8R""(가상 문헌의 개수 (읽기전용)
 
 .. versionadded:: 0.11.0)"");
+
+DOC_VARIABLE_EN_KO(PT_pseudo_doc_mh_steps__doc__,
+    u8R""(.. versionadded:: 0.12.3
+
+get or set the number of Metropolis-Hastings steps used for reassigning the pseudo document of each document while training
+
+If it is 0(default), the likelihoods of all the pseudo documents are calculated for each document.
+Otherwise, each step proposes the pseudo document of a randomly chosen document (or a random pseudo document, in proportion to `lambda`),
+so the cost per document no longer grows with `p`. A few steps are usually enough when `p` is large.)"",
+    u8R""(.. versionadded:: 0.12.3
+
+학습 중 각 문헌의 가상 문헌을 다시 할당할 때 사용할 메트로폴리스-헤이스팅스 단계의 횟수를 얻거나 설정합니다.
+
+0(기본값)인 경우 각 문헌마다 모든 가상 문헌에 대한 가능도를 계산합니다.
+그렇지 않은 경우 각 단계는 임의로 고른 문헌의 가상 문헌(혹은 `lambda`에 비례하여 임의의 가상 문헌)을 제안하므로, 문헌당 비용이 `p`에 따라 증가하지 않습니다. `p`가 큰 경우 보통 몇 단계로 충분합니다.)"");
+
+DOC_SIGNATURE_EN_KO(InferenceModel___init____doc__,
+    "InferenceModel()",
+    u8R""(.. versionadded:: 0.12.3
+
+This type provides a read-only model which can only infer topic distributions of unseen documents.
+An instance of this type can be acquired from `tomotopy.InferenceModel.load` with a file written by `tomotopy.LDAModel.export_inference`.
+It holds neither documents nor counts, so it needs much less memory than the original model.)"",
+u8R""(.. versionadded:: 0.12.3
+
+이 타입은 새로운 문헌의 토픽 분포를 추론하는 것만 가능한 읽기 전용 모델을 제공합니다.
+이 타입의 인스턴스는 `tomotopy.LDAModel.export_inference`로 저장한 파일을 `tomotopy.InferenceModel.load`로 읽어 얻을 수 있습니다.
+문헌과 카운트를 가지고 있지 않으므로 원래 모델보다 훨씬 적은 메모리를 필요로 합니다.)"");
+
+DOC_SIGNATURE_EN_KO(InferenceModel_load__doc__,
+    "load(filename)",
+    u8R""(Return the inference model loaded from file `filename`, which is written by `tomotopy.LDAModel.export_inference`.)"",
+    u8R""(`tomotopy.LDAModel.export_inference`로 저장된 `filename` 경로의 파일로부터 추론 모델을 읽어들여 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(InferenceModel_infer__doc__,
+    "infer(self, doc, iter=100, workers=0, seed=None)",
+    u8R""(Return the inferred topic distribution and the log-likelihood of `doc`.
+
+Parameters
+----------
+doc : Union[Iterable[str], Iterable[Iterable[str]]]
+    a document given as a list of words, or a list of such documents.
+    Words not in the vocabulary are ignored.
+iter : int
+    the number of iterations of Gibbs sampling
+workers : int
+    the number of worker threads. If 0, it uses as many threads as the number of cores.
+seed : int
+    the random seed. Document `i` is sampled with `seed + i`, so the result does not depend on `workers`.
+
+Returns
+-------
+If `doc` is a single document, a tuple of the topic distribution in `numpy.ndarray` and the log-likelihood in `float`.
+If `doc` is a list of documents, a tuple of a list of topic distributions and a list of log-likelihoods.)"",
+u8R""(`doc`의 추론된 토픽 분포와 로그 가능도를 반환합니다.
+
+Parameters
+----------
+doc : Union[Iterable[str], Iterable[Iterable[str]]]
+    단어의 리스트로 주어지는 문헌 하나, 혹은 그러한 문헌들의 리스트.
+    어휘 사전에 없는 단어는 무시됩니다.
+iter : int
+    깁스 샘플링의 반복 횟수
+workers : int
+    사용할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.
+seed : int
+    난수의 시드값. `i`번째 문헌은 `seed + i`로 샘플링되므로 결과는 `workers`에 따라 달라지지 않습니다.
+
+Returns
+-------
+`doc`이 문헌 하나일 경우, `numpy.ndarray`인 토픽 분포와 `float`인 로그 가능도의 튜플을 반환합니다.
+`doc`이 문헌들의 리스트일 경우, 토픽 분포들의 리스트와 로그 가능도들의 리스트의 튜플을 반환합니다.)"");
+
+DOC_VARIABLE_EN_KO(InferenceModel_k__doc__,
+    u8R""(K, the number of topics (read-only))"",
+    u8R""(토픽의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(InferenceModel_vocabs__doc__,
+    u8R""(a list of words in the vocabulary of the model (read-only))"",
+    u8R""(모델의 어휘 사전에 포함된 단어들의 리스트 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(InferenceModel_dtype__doc__,
+    u8R""(the storage type of the topic-word distribution, one of `'float32'`, `'float16'` and `'uint16'` (read-only))"",
+    u8R""(토픽-단어 분포가 저장된 형식으로 `'float32'`, `'float16'`, `'uint16'` 중 하나 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(InferenceModel_tw__doc__,
+    u8R""(the term weighting scheme of the model, see `tomotopy.TermWeight` (read-only))"",
+    u8R""(모델의 용어 가중치 기법, `tomotopy.TermWeight` 참조 (읽기전용))"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA___init____doc__,
+    "OnlineLDAModel(k=1, alpha=0.1, eta=0.01, tau0=64., kappa=0.7, total_docs=0, seed=None)",
+    u8R""(.. versionadded:: 0.12.3
+
+This type provides Latent Dirichlet Allocation trained by stochastic variational inference on minibatches of documents.
+Unlike `tomotopy.LDAModel`, it keeps neither documents nor per-token topic assignments, only the variational parameters of the topic-word distributions,
+so it can be updated with a stream of new documents by `tomotopy.OnlineLDAModel.partial_fit` without retraining from scratch.
+The vocabulary grows with the words of new documents.
+
+> * Hoffman, M., Bach, F. R., & Blei, D. M. (2010). Online learning for latent dirichlet allocation. In Advances in neural information processing systems (pp. 856-864).
+
+Parameters
+----------
+k : int
+    the number of topics between 1 ~ 32767
+alpha : float
+    the symmetric Dirichlet prior of the topic distribution of each document
+eta : float
+    the symmetric Dirichlet prior of the word distribution of each topic
+tau0 : float
+    a non-negative value which slows down the learning rate of early updates
+kappa : float
+    the rate at which the learning rate `(tau0 + num_updates + 1) ** -kappa` decays, in (0.5, 1]
+total_docs : int
+    the number of documents in the whole stream. If 0, the number of documents seen so far is used.
+seed : int
+    the random seed for the initial topic-word parameters)"",
+u8R""(.. versionadded:: 0.12.3
+
+이 타입은 문헌의 미니배치에 대한 확률적 변분 추론으로 학습하는 Latent Dirichlet Allocation을 제공합니다.
+`tomotopy.LDAModel`과 달리 문헌이나 토큰별 주제 할당을 가지지 않고 토픽-단어 분포의 변분 매개변수만 가지므로,
+처음부터 다시 학습하지 않고 `tomotopy.OnlineLDAModel.partial_fit`으로 새 문헌의 흐름을 반영하여 갱신할 수 있습니다.
+어휘 사전은 새 문헌의 단어들로 늘어납니다.
+
+> * Hoffman, M., Bach, F. R., & Blei, D. M. (2010). Online learning for latent dirichlet allocation. In Advances in neural information processing systems (pp. 856-864).
+
+Parameters
+----------
+k : int
+    토픽의 개수, 1 ~ 32767 사이의 정수
+alpha : float
+    문헌별 토픽 분포의 대칭 디리클레 사전 분포
+eta : float
+    토픽별 단어 분포의 대칭 디리클레 사전 분포
+tau0 : float
+    초기 갱신의 학습률을 늦추는 0 이상의 값
+kappa : float
+    학습률 `(tau0 + num_updates + 1) ** -kappa`가 감소하는 정도, (0.5, 1] 범위의 값
+total_docs : int
+    전체 흐름에 포함된 문헌의 개수. 0일 경우 지금까지 본 문헌의 개수를 사용합니다.
+seed : int
+    토픽-단어 매개변수의 초기값에 사용할 난수의 시드값)"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA_from_model__doc__,
+    "from_model(model, tau0=64., kappa=0.7, total_docs=0, seed=None)",
+    u8R""(Return a new online model warm-started from a trained `tomotopy.LDAModel` `model`.
+It takes the topic-word counts, the priors and the used vocabularies of `model`, and its number of documents as `num_docs`.
+The other parameters are the same as those of `tomotopy.OnlineLDAModel`.)"",
+    u8R""(학습된 `tomotopy.LDAModel`인 `model`에서 시작하는 새 온라인 모델을 반환합니다.
+`model`의 토픽-단어 개수, 사전 분포, 사용된 어휘들을 가져오며, 문헌 개수를 `num_docs`로 가져옵니다.
+나머지 인자는 `tomotopy.OnlineLDAModel`의 것과 같습니다.)"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA_load__doc__,
+    "load(filename)",
+    u8R""(Return the online model loaded from file `filename`, which is written by `tomotopy.OnlineLDAModel.save`.)"",
+    u8R""(`tomotopy.OnlineLDAModel.save`로 저장된 `filename` 경로의 파일로부터 온라인 모델을 읽어들여 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA_save__doc__,
+    "save(self, filename)",
+    u8R""(Save the model into file `filename`.)"",
+    u8R""(모델을 `filename` 경로의 파일에 저장합니다.)"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA_partial_fit__doc__,
+    "partial_fit(self, docs, iter=50, workers=0)",
+    u8R""(Update the model with a minibatch of documents by one step of stochastic variational inference, and return the lower bound of the log-likelihood per word of `docs` estimated before the update.
+Documents are not kept after the update.
+
+Parameters
+----------
+docs : Iterable[Iterable[str]]
+    a list of documents, each of which is given as a list of words
+iter : int
+    the maximum number of iterations of the variational update of each document
+workers : int
+    the number of worker threads. If 0, it uses as many threads as the number of cores.)"",
+    u8R""(문헌의 미니배치로 확률적 변분 추론을 한 단계 수행하여 모델을 갱신하고, 갱신 전에 추정한 `docs`의 단어당 로그 가능도의 하한을 반환합니다.
+문헌들은 갱신 후에 보관되지 않습니다.
+
+Parameters
+----------
+docs : Iterable[Iterable[str]]
+    단어의 리스트로 주어지는 문헌들의 리스트
+iter : int
+    각 문헌의 변분 갱신의 최대 반복 횟수
+workers : int
+    사용할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.)"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA_infer__doc__,
+    "infer(self, doc, iter=50, workers=0)",
+    u8R""(Return the inferred topic distribution and the log-likelihood of `doc`.
+
+Parameters
+----------
+doc : Union[Iterable[str], Iterable[Iterable[str]]]
+    a document given as a list of words, or a list of such documents.
+    Words not in the vocabulary are ignored.
+iter : int
+    the maximum number of iterations of the variational update of each document
+workers : int
+    the number of worker threads. If 0, it uses as many threads as the number of cores.
+
+Returns
+-------
+If `doc` is a single document, a tuple of the topic distribution in `numpy.ndarray` and the log-likelihood in `float`.
+If `doc` is a list of documents, a tuple of a list of topic distributions and a list of log-likelihoods.)"",
+u8R""(`doc`의 추론된 토픽 분포와 로그 가능도를 반환합니다.
+
+Parameters
+----------
+doc : Union[Iterable[str], Iterable[Iterable[str]]]
+    단어의 리스트로 주어지는 문헌 하나, 혹은 그러한 문헌들의 리스트.
+    어휘 사전에 없는 단어는 무시됩니다.
+iter : int
+    각 문헌의 변분 갱신의 최대 반복 횟수
+workers : int
+    사용할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.
+
+Returns
+-------
+`doc`이 문헌 하나일 경우, `numpy.ndarray`인 토픽 분포와 `float`인 로그 가능도의 튜플을 반환합니다.
+`doc`이 문헌들의 리스트일 경우, 토픽 분포들의 리스트와 로그 가능도들의 리스트의 튜플을 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA_get_topic_words__doc__,
+    "get_topic_words(self, topic_id, top_n=10)",
+    u8R""(Return the `top_n` words and their probabilities in the topic `topic_id`, in the type of `list` of (`str`, `float`).)"",
+    u8R""(토픽 `topic_id`에 속하는 상위 단어 `top_n`개와 각각의 확률을 (`str`, `float`)의 `list`로 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(OnlineLDA_get_topic_word_dist__doc__,
+    "get_topic_word_dist(self, topic_id)",
+    u8R""(Return the word distribution of the topic `topic_id` over all vocabularies in `tomotopy.OnlineLDAModel.vocabs`.)"",
+    u8R""(`tomotopy.OnlineLDAModel.vocabs`의 모든 어휘에 대한 토픽 `topic_id`의 단어 분포를 반환합니다.)"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_k__doc__,
+    u8R""(K, the number of topics (read-only))"",
+    u8R""(토픽의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_alpha__doc__,
+    u8R""(the Dirichlet prior of the topic distribution of each document (read-only))"",
+    u8R""(문헌별 토픽 분포의 디리클레 사전 분포 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_eta__doc__,
+    u8R""(the Dirichlet prior of the word distribution of each topic (read-only))"",
+    u8R""(토픽별 단어 분포의 디리클레 사전 분포 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_tau0__doc__,
+    u8R""(the delay of the decay of the learning rate (read-only))"",
+    u8R""(학습률 감소의 지연값 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_kappa__doc__,
+    u8R""(the rate of the decay of the learning rate (read-only))"",
+    u8R""(학습률의 감소율 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_total_docs__doc__,
+    u8R""(get or set the number of documents in the whole stream, which scales the statistics of each minibatch. If 0, `num_docs` is used.)"",
+    u8R""(각 미니배치의 통계량의 배율을 정하는 전체 흐름의 문헌 개수를 얻거나 설정합니다. 0일 경우 `num_docs`를 사용합니다.)"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_num_docs__doc__,
+    u8R""(the number of documents the model has seen (read-only))"",
+    u8R""(모델이 지금까지 본 문헌의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_num_updates__doc__,
+    u8R""(the number of updates by `tomotopy.OnlineLDAModel.partial_fit` (read-only))"",
+    u8R""(`tomotopy.OnlineLDAModel.partial_fit`으로 갱신한 횟수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(OnlineLDA_vocabs__doc__,
+    u8R""(a list of words in the vocabulary of the model (read-only))"",
+    u8R""(모델의 어휘 사전에 포함된 단어들의 리스트 (읽기전용))"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA___init____doc__,
+    "CVB0LDAModel(k=1, alpha=0.1, eta=0.01, top_k=8, seed=None)",
+    u8R""(.. versionadded:: 0.12.3
+
+This type provides Latent Dirichlet Allocation trained by the zero-order collapsed variational Bayes (CVB0).
+Instead of sampling a topic of each token like `tomotopy.LDAModel`, it updates the topic distribution of each token with the expected counts of the others,
+so it usually converges in far fewer iterations.
+Only the `top_k` largest probabilities of the distribution of each token are kept, which takes `6 * top_k` bytes per token instead of `4 * k`.
+Documents are split into as many ranges as the worker threads, and the topic-word counts updated by each worker are merged after each iteration.
+
+> * Asuncion, A., Welling, M., Smyth, P., & Teh, Y. W. (2009). On smoothing and inference for topic models. In Proceedings of the twenty-fifth conference on uncertainty in artificial intelligence (pp. 27-34).
+
+Parameters
+----------
+k : int
+    the number of topics between 1 ~ 32767
+alpha : float
+    the symmetric Dirichlet prior of the topic distribution of each document
+eta : float
+    the symmetric Dirichlet prior of the word distribution of each topic
+top_k : int
+    the number of topics kept in the distribution of each token. If 0 or not less than `k`, all topics are kept.
+seed : int
+    the random seed for the initial topics of tokens)"",
+u8R""(.. versionadded:: 0.12.3
+
+이 타입은 0차 붕괴 변분 베이즈(CVB0)로 학습하는 Latent Dirichlet Allocation을 제공합니다.
+`tomotopy.LDAModel`처럼 각 토큰의 주제를 샘플링하는 대신 다른 토큰들의 기대 개수로 각 토큰의 주제 분포를 갱신하므로,
+보통 훨씬 적은 반복 횟수로 수렴합니다.
+각 토큰의 분포에서 가장 큰 확률 `top_k`개만을 보관하므로 토큰당 `4 * k` 바이트 대신 `6 * top_k` 바이트를 사용합니다.
+문헌들은 작업 스레드의 개수만큼의 구간으로 나뉘며, 각 스레드가 갱신한 토픽-단어 개수는 매 반복 후에 병합됩니다.
+
+> * Asuncion, A., Welling, M., Smyth, P., & Teh, Y. W. (2009). On smoothing and inference for topic models. In Proceedings of the twenty-fifth conference on uncertainty in artificial intelligence (pp. 27-34).
+
+Parameters
+----------
+k : int
+    토픽의 개수, 1 ~ 32767 사이의 정수
+alpha : float
+    문헌별 토픽 분포의 대칭 디리클레 사전 분포
+eta : float
+    토픽별 단어 분포의 대칭 디리클레 사전 분포
+top_k : int
+    각 토큰의 분포에 보관할 토픽의 개수. 0이거나 `k` 이상일 경우 모든 토픽을 보관합니다.
+seed : int
+    토큰의 초기 토픽에 사용할 난수의 시드값)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_load__doc__,
+    "load(filename)",
+    u8R""(Return the model loaded from file `filename`, which is written by `tomotopy.CVB0LDAModel.save`.)"",
+    u8R""(`tomotopy.CVB0LDAModel.save`로 저장된 `filename` 경로의 파일로부터 모델을 읽어들여 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_save__doc__,
+    "save(self, filename)",
+    u8R""(Save the model, including its documents and the distributions of their tokens, into file `filename`.)"",
+    u8R""(문헌들과 그 토큰들의 분포를 포함하여 모델을 `filename` 경로의 파일에 저장합니다.)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_add_doc__doc__,
+    "add_doc(self, words)",
+    u8R""(Add a new document given as a list of words into the model and return an index of the added document.
+Documents can be added after training as well, and the next `tomotopy.CVB0LDAModel.train` starts from the current state with them.)"",
+    u8R""(단어의 리스트로 주어지는 새 문헌을 모델에 추가하고 추가된 문헌의 인덱스 번호를 반환합니다.
+학습 후에도 문헌을 추가할 수 있으며, 다음 `tomotopy.CVB0LDAModel.train`은 추가된 문헌들과 함께 현재 상태에서 이어서 학습합니다.)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_train__doc__,
+    "train(self, iter=10, workers=0)",
+    u8R""(Train the model by `iter` iterations over all documents.
+The result depends only on `seed` and `workers`, not on the scheduling of the threads.
+
+Parameters
+----------
+iter : int
+    the number of iterations
+workers : int
+    the number of worker threads. If 0, it uses as many threads as the number of cores.)"",
+    u8R""(모든 문헌에 대해 `iter`번 반복하여 모델을 학습합니다.
+결과는 스레드의 실행 순서와 상관없이 `seed`와 `workers`에 의해서만 결정됩니다.
+
+Parameters
+----------
+iter : int
+    반복 횟수
+workers : int
+    사용할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_infer__doc__,
+    "infer(self, doc, iter=50, workers=0)",
+    u8R""(Return the inferred topic distribution and the log-likelihood of `doc` with the topic-word distributions fixed.
+
+Parameters
+----------
+doc : Union[Iterable[str], Iterable[Iterable[str]]]
+    a document given as a list of words, or a list of such documents.
+    Words not used in training are ignored.
+iter : int
+    the maximum number of iterations of the update of each document
+workers : int
+    the number of worker threads. If 0, it uses as many threads as the number of cores.
+
+Returns
+-------
+If `doc` is a single document, a tuple of the topic distribution in `numpy.ndarray` and the log-likelihood in `float`.
+If `doc` is a list of documents, a tuple of a list of topic distributions and a list of log-likelihoods.)"",
+u8R""(토픽-단어 분포를 고정한 채로 `doc`의 추론된 토픽 분포와 로그 가능도를 반환합니다.
+
+Parameters
+----------
+doc : Union[Iterable[str], Iterable[Iterable[str]]]
+    단어의 리스트로 주어지는 문헌 하나, 혹은 그러한 문헌들의 리스트.
+    학습에 사용되지 않은 단어는 무시됩니다.
+iter : int
+    각 문헌의 갱신의 최대 반복 횟수
+workers : int
+    사용할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.
+
+Returns
+-------
+`doc`이 문헌 하나일 경우, `numpy.ndarray`인 토픽 분포와 `float`인 로그 가능도의 튜플을 반환합니다.
+`doc`이 문헌들의 리스트일 경우, 토픽 분포들의 리스트와 로그 가능도들의 리스트의 튜플을 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_get_topic_words__doc__,
+    "get_topic_words(self, topic_id, top_n=10)",
+    u8R""(Return the `top_n` words and their probabilities in the topic `topic_id`, in the type of `list` of (`str`, `float`).)"",
+    u8R""(토픽 `topic_id`에 속하는 상위 단어 `top_n`개와 각각의 확률을 (`str`, `float`)의 `list`로 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_get_topic_word_dist__doc__,
+    "get_topic_word_dist(self, topic_id)",
+    u8R""(Return the word distribution of the topic `topic_id` over all vocabularies in `tomotopy.CVB0LDAModel.vocabs`.)"",
+    u8R""(`tomotopy.CVB0LDAModel.vocabs`의 모든 어휘에 대한 토픽 `topic_id`의 단어 분포를 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(CVB0LDA_get_doc_topic_dist__doc__,
+    "get_doc_topic_dist(self, doc_id)",
+    u8R""(Return the topic distribution of the document `doc_id` in the model.)"",
+    u8R""(모델에 포함된 문헌 `doc_id`의 토픽 분포를 반환합니다.)"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_k__doc__,
+    u8R""(K, the number of topics (read-only))"",
+    u8R""(토픽의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_alpha__doc__,
+    u8R""(the Dirichlet prior of the topic distribution of each document (read-only))"",
+    u8R""(문헌별 토픽 분포의 디리클레 사전 분포 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_eta__doc__,
+    u8R""(the Dirichlet prior of the word distribution of each topic (read-only))"",
+    u8R""(토픽별 단어 분포의 디리클레 사전 분포 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_top_k__doc__,
+    u8R""(the number of topics kept in the distribution of each token, 0 for all topics (read-only))"",
+    u8R""(각 토큰의 분포에 보관하는 토픽의 개수, 0일 경우 모든 토픽 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_num_docs__doc__,
+    u8R""(the number of documents in the model (read-only))"",
+    u8R""(모델에 포함된 문헌의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_num_words__doc__,
+    u8R""(the number of tokens of all documents in the model (read-only))"",
+    u8R""(모델에 포함된 모든 문헌의 토큰 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_global_step__doc__,
+    u8R""(the total number of iterations of training (read-only))"",
+    u8R""(학습의 총 반복 횟수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_ll_per_word__doc__,
+    u8R""(the log-likelihood per word of the trained documents, computed from their expected counts (read-only))"",
+    u8R""(학습된 문헌들의 기대 개수로 계산한 단어당 로그 가능도 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(CVB0LDA_vocabs__doc__,
+    u8R""(a list of words in the vocabulary of the model (read-only))"",
+    u8R""(모델의 어휘 사전에 포함된 단어들의 리스트 (읽기전용))"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA___init____doc__,
+    "MultiChainLDAModel(k=1, chains_per_k=1, alpha=0.1, eta=0.01, seed=None)",
+    u8R""(.. versionadded:: 0.12.3
+
+This type trains several chains of Latent Dirichlet Allocation by collapsed Gibbs sampling over one shared store of documents.
+Each chain keeps only its topic assignments and counts, so a model selection over several values of `k` and seeds
+holds a single copy of the corpus instead of one per `tomotopy.LDAModel`.
+All chains are sampled by one pool of threads, and the log-likelihood per word of each chain is recorded after each iteration,
+so the convergence of the chains with the same `k` can be checked by `tomotopy.MultiChainLDAModel.rhat`.
+
+Parameters
+----------
+k : Union[int, Iterable[int]]
+    the number of topics between 1 ~ 32767, or a list of them
+chains_per_k : int
+    the number of chains with different seeds for each value of `k`.
+    The chains are ordered by `k` first, so the chain `i * chains_per_k + j` is the `j`-th chain of the `i`-th value of `k`.
+alpha : float
+    the symmetric Dirichlet prior of the topic distribution of each document
+eta : float
+    the symmetric Dirichlet prior of the word distribution of each topic
+seed : int
+    the random seed of the first chain. The chain `i` uses `seed + i`.)"",
+u8R""(.. versionadded:: 0.12.3
+
+이 타입은 하나의 공유된 문헌 저장소 위에서 붕괴된 깁스 샘플링으로 여러 개의 Latent Dirichlet Allocation 체인을 학습합니다.
+각 체인은 자신의 토픽 할당과 개수만을 보관하므로, 여러 `k` 값과 시드에 대한 모형 선택에서
+`tomotopy.LDAModel`마다 말뭉치를 복사하는 대신 말뭉치를 한 벌만 유지합니다.
+모든 체인은 하나의 스레드 풀로 샘플링되며 각 체인의 단어당 로그 가능도가 매 반복 후에 기록되므로,
+같은 `k`를 가진 체인들의 수렴 여부를 `tomotopy.MultiChainLDAModel.rhat`으로 확인할 수 있습니다.
+
+Parameters
+----------
+k : Union[int, Iterable[int]]
+    토픽의 개수, 1 ~ 32767 사이의 정수 혹은 그러한 정수들의 리스트
+chains_per_k : int
+    `k`의 각 값마다 서로 다른 시드로 학습할 체인의 개수.
+    체인들은 `k`에 따라 먼저 정렬되므로, `i * chains_per_k + j`번 체인은 `i`번째 `k` 값의 `j`번째 체인입니다.
+alpha : float
+    문헌별 토픽 분포의 대칭 디리클레 사전 분포
+eta : float
+    토픽별 단어 분포의 대칭 디리클레 사전 분포
+seed : int
+    첫번째 체인의 난수 시드값. `i`번 체인은 `seed + i`를 사용합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_load__doc__,
+    "load(filename)",
+    u8R""(Return the model loaded from file `filename`, which is written by `tomotopy.MultiChainLDAModel.save`.)"",
+    u8R""(`tomotopy.MultiChainLDAModel.save`로 저장된 `filename` 경로의 파일로부터 모델을 읽어들여 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_save__doc__,
+    "save(self, filename)",
+    u8R""(Save the model, including its documents and the topic assignments of all chains, into file `filename`.)"",
+    u8R""(문헌들과 모든 체인의 토픽 할당을 포함하여 모델을 `filename` 경로의 파일에 저장합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_add_doc__doc__,
+    "add_doc(self, words)",
+    u8R""(Add a new document given as a list of words into the store shared by all chains and return an index of the added document.
+Documents can be added after training as well, and the next `tomotopy.MultiChainLDAModel.train` starts from the current state with them.)"",
+    u8R""(단어의 리스트로 주어지는 새 문헌을 모든 체인이 공유하는 저장소에 추가하고 추가된 문헌의 인덱스 번호를 반환합니다.
+학습 후에도 문헌을 추가할 수 있으며, 다음 `tomotopy.MultiChainLDAModel.train`은 추가된 문헌들과 함께 현재 상태에서 이어서 학습합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_train__doc__,
+    "train(self, iter=10, workers=0)",
+    u8R""(Train all chains by `iter` iterations over all documents.
+The chains are sampled concurrently, and when `workers` is larger than the number of chains,
+the documents of each chain are split into ranges whose topic-word counts are merged after each iteration.
+The result depends only on `seed` and `workers`, not on the scheduling of the threads.
+
+Parameters
+----------
+iter : int
+    the number of iterations
+workers : int
+    the number of worker threads shared by all chains. If 0, it uses as many threads as the number of cores.)"",
+    u8R""(모든 체인을 모든 문헌에 대해 `iter`번 반복하여 학습합니다.
+체인들은 동시에 샘플링되며, `workers`가 체인의 개수보다 클 경우
+각 체인의 문헌들을 여러 구간으로 나누어 샘플링하고 그 토픽-단어 개수를 매 반복 후에 병합합니다.
+결과는 스레드의 실행 순서와 상관없이 `seed`와 `workers`에 의해서만 결정됩니다.
+
+Parameters
+----------
+iter : int
+    반복 횟수
+workers : int
+    모든 체인이 공유할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_rhat__doc__,
+    "rhat(self, chains, window=0)",
+    u8R""(Return the potential scale reduction factor (R-hat) of Gelman and Rubin over the log-likelihoods per word of `chains`.
+Values close to 1 mean that the chains have mixed, and values above about 1.1 mean that they need more iterations.
+
+Parameters
+----------
+chains : Iterable[int]
+    the indices of at least two chains with the same `k`
+window : int
+    the number of the last iterations used. If 0, the last half of the iterations is used.)"",
+    u8R""(`chains`의 단어당 로그 가능도에 대한 Gelman과 Rubin의 잠재적 척도 축소 인자(R-hat)를 반환합니다.
+1에 가까울수록 체인들이 잘 섞였음을, 약 1.1보다 클 경우 더 많은 반복이 필요함을 뜻합니다.
+
+Parameters
+----------
+chains : Iterable[int]
+    같은 `k`를 가진 둘 이상의 체인들의 번호
+window : int
+    사용할 마지막 반복의 횟수. 0일 경우 반복들의 뒤쪽 절반을 사용합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_get_ll_history__doc__,
+    "get_ll_history(self, chain_id)",
+    u8R""(Return the log-likelihoods per word of the chain `chain_id` recorded after each iteration, in the type of `list` of `float`.)"",
+    u8R""(매 반복 후에 기록된 `chain_id`번 체인의 단어당 로그 가능도들을 `float`의 `list`로 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_get_topic_words__doc__,
+    "get_topic_words(self, chain_id, topic_id, top_n=10)",
+    u8R""(Return the `top_n` words and their probabilities in the topic `topic_id` of the chain `chain_id`, in the type of `list` of (`str`, `float`).)"",
+    u8R""(`chain_id`번 체인의 토픽 `topic_id`에 속하는 상위 단어 `top_n`개와 각각의 확률을 (`str`, `float`)의 `list`로 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_get_topic_word_dist__doc__,
+    "get_topic_word_dist(self, chain_id, topic_id)",
+    u8R""(Return the word distribution of the topic `topic_id` of the chain `chain_id` over all vocabularies in `tomotopy.MultiChainLDAModel.vocabs`.)"",
+    u8R""(`tomotopy.MultiChainLDAModel.vocabs`의 모든 어휘에 대한 `chain_id`번 체인의 토픽 `topic_id`의 단어 분포를 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(MultiChainLDA_get_doc_topic_dist__doc__,
+    "get_doc_topic_dist(self, chain_id, doc_id)",
+    u8R""(Return the topic distribution of the document `doc_id` in the chain `chain_id`.)"",
+    u8R""(`chain_id`번 체인에서 문헌 `doc_id`의 토픽 분포를 반환합니다.)"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_num_chains__doc__,
+    u8R""(the number of chains (read-only))"",
+    u8R""(체인의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_k__doc__,
+    u8R""(a list of the number of topics of each chain (read-only))"",
+    u8R""(각 체인의 토픽 개수의 리스트 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_seeds__doc__,
+    u8R""(a list of the random seed of each chain (read-only))"",
+    u8R""(각 체인의 난수 시드값의 리스트 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_alpha__doc__,
+    u8R""(the symmetric Dirichlet prior of the topic distribution of each document (read-only))"",
+    u8R""(문헌별 토픽 분포의 대칭 디리클레 사전 분포 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_eta__doc__,
+    u8R""(the symmetric Dirichlet prior of the word distribution of each topic (read-only))"",
+    u8R""(토픽별 단어 분포의 대칭 디리클레 사전 분포 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_num_docs__doc__,
+    u8R""(the number of documents in the model (read-only))"",
+    u8R""(모델에 포함된 문헌의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_num_words__doc__,
+    u8R""(the number of tokens of all documents in the model (read-only))"",
+    u8R""(모델에 포함된 모든 문헌의 토큰 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_global_step__doc__,
+    u8R""(the total number of iterations of training (read-only))"",
+    u8R""(학습의 총 반복 횟수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_ll_per_word__doc__,
+    u8R""(a list of the log-likelihood per word of each chain after the last iteration (read-only))"",
+    u8R""(마지막 반복 후 각 체인의 단어당 로그 가능도의 리스트 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(MultiChainLDA_vocabs__doc__,
+    u8R""(a list of words in the vocabulary of the model (read-only))"",
+    u8R""(모델의 어휘 사전에 포함된 단어들의 리스트 (읽기전용))"");
+
+DOC_SIGNATURE_EN_KO(DocIndex___init____doc__,
+    "DocIndex(source, metric=DocMetric.HELLINGER, n_lists=0, train_iter=10, workers=0, seed=None)",
+    u8R""(.. versionadded:: 0.12.3
+
+This type provides an approximate nearest neighbour index over the topic distributions of documents, to find similar documents.
+Each distribution is stored as a unit vector in float16, which takes `2 * k` bytes per document,
+and the vectors are grouped into `n_lists` inverted lists by their nearest centroids found by k-means.
+A search scans only the lists whose centroids are the nearest to the query.
+Both building the index and searching it run in parallel.
+
+Parameters
+----------
+source : Union[tomotopy.LDAModel, Iterable[Iterable[float]]]
+    a trained topic model whose documents are indexed with their topic distributions,
+    or a list of topic distributions such as the results of `tomotopy.LDAModel.infer`.
+    The index of each document in the search results is its index in `source`.
+metric : Union[int, tomotopy.DocMetric]
+    the distance between topic distributions
+n_lists : int
+    the number of inverted lists. If 0, the square root of the number of documents is used.
+train_iter : int
+    the number of iterations of k-means
+workers : int
+    the number of worker threads. If 0, it uses as many threads as the number of cores.
+seed : int
+    the random seed for the initial centroids)"",
+u8R""(.. versionadded:: 0.12.3
+
+이 타입은 유사한 문헌을 찾기 위한, 문헌의 토픽 분포에 대한 근사 최근접 이웃 색인을 제공합니다.
+각 분포는 float16의 단위 벡터로 저장되어 문헌당 `2 * k` 바이트를 사용하며,
+벡터들은 k-평균으로 찾은 가장 가까운 중심에 따라 `n_lists`개의 역 목록으로 묶입니다.
+검색은 질의와 가장 가까운 중심을 가진 목록들만을 탐색합니다.
+색인의 구축과 검색은 모두 병렬로 수행됩니다.
+
+Parameters
+----------
+source : Union[tomotopy.LDAModel, Iterable[Iterable[float]]]
+    문헌들을 그 토픽 분포로 색인할 학습된 토픽 모델,
+    혹은 `tomotopy.LDAModel.infer`의 결과와 같은 토픽 분포들의 리스트.
+    검색 결과에서 각 문헌의 번호는 `source`에서의 번호입니다.
+metric : Union[int, tomotopy.DocMetric]
+    토픽 분포 간의 거리
+n_lists : int
+    역 목록의 개수. 0일 경우 문헌 개수의 제곱근을 사용합니다.
+train_iter : int
+    k-평균의 반복 횟수
+workers : int
+    사용할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.
+seed : int
+    초기 중심에 사용할 난수의 시드값)"");
+
+DOC_SIGNATURE_EN_KO(DocIndex_load__doc__,
+    "load(filename)",
+    u8R""(Return the index loaded from file `filename`, which is written by `tomotopy.DocIndex.save`.)"",
+    u8R""(`tomotopy.DocIndex.save`로 저장된 `filename` 경로의 파일로부터 색인을 읽어들여 반환합니다.)"");
+
+DOC_SIGNATURE_EN_KO(DocIndex_save__doc__,
+    "save(self, filename)",
+    u8R""(Save the index into file `filename`. It can be saved next to the file of the model it was built from.)"",
+    u8R""(색인을 `filename` 경로의 파일에 저장합니다. 색인을 구축한 모델의 파일 옆에 함께 저장할 수 있습니다.)"");
+
+DOC_SIGNATURE_EN_KO(DocIndex_search__doc__,
+    "search(self, query, top_n=10, n_probe=8, workers=0)",
+    u8R""(Return the `top_n` nearest documents of `query` and their distances.
+
+Parameters
+----------
+query : Union[Iterable[float], Iterable[Iterable[float]]]
+    a topic distribution, or a list of them
+top_n : int
+    the number of documents returned for each query
+n_probe : int
+    the number of lists scanned for each query. A larger value finds the exact neighbours more often but takes longer.
+workers : int
+    the number of worker threads. If 0, it uses as many threads as the number of cores.
+
+Returns
+-------
+A tuple of the indices of documents in `numpy.ndarray` of int64 and their distances in `numpy.ndarray` of float32,
+both of which are sorted by distance and have the shape `(top_n,)` for a single query or `(len(query), top_n)` for a list of queries.
+If fewer than `top_n` documents are found, the remaining indices are -1 and their distances are infinity.)"",
+    u8R""(`query`에 가장 가까운 문헌 `top_n`개와 그 거리를 반환합니다.
+
+Parameters
+----------
+query : Union[Iterable[float], Iterable[Iterable[float]]]
+    토픽 분포 하나 혹은 그러한 분포들의 리스트
+top_n : int
+    각 질의마다 반환할 문헌의 개수
+n_probe : int
+    각 질의마다 탐색할 목록의 개수. 클수록 정확한 이웃을 더 자주 찾지만 더 오래 걸립니다.
+workers : int
+    사용할 스레드의 개수. 0일 경우 코어 개수만큼의 스레드를 사용합니다.
+
+Returns
+-------
+int64의 `numpy.ndarray`인 문헌의 번호들과 float32의 `numpy.ndarray`인 그 거리들의 튜플을 반환합니다.
+둘 다 거리순으로 정렬되어 있으며, 질의 하나일 경우 `(top_n,)`, 질의들의 리스트일 경우 `(len(query), top_n)`의 모양을 가집니다.
+찾은 문헌이 `top_n`개보다 적을 경우 나머지 번호는 -1, 거리는 무한대입니다.)"");
+
+DOC_VARIABLE_EN_KO(DocIndex_metric__doc__,
+    u8R""(the distance between topic distributions, one of `tomotopy.DocMetric` (read-only))"",
+    u8R""(토픽 분포 간의 거리, `tomotopy.DocMetric` 중 하나 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(DocIndex_k__doc__,
+    u8R""(the number of topics of the indexed distributions (read-only))"",
+    u8R""(색인된 분포의 토픽 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(DocIndex_num_docs__doc__,
+    u8R""(the number of indexed documents (read-only))"",
+    u8R""(색인된 문헌의 개수 (읽기전용))"");
+
+DOC_VARIABLE_EN_KO(DocIndex_n_lists__doc__,
+    u8R""(the number of inverted lists (read-only))"",
+    u8R""(역 목록의 개수 (읽기전용))"");
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include "../Utils/Utils.hpp"
+#include "../Utils/ThreadPool.hpp"
+#include "../Utils/HugePages.hpp"
+#include "../Utils/serializer.hpp"
+
+/*
+Model families except LDA can be built as separate extension modules, called engines,
+which hold the instantiations of their models and are imported when a model of the family is created first.
+So `import tomotopy` doesn't pay for loading the code of the families never used.
+
+An engine named `<main module>_<family>` exports `EngineLink` in a capsule `_link` named `tomotopy.engine`.
+The main module gets `I<Family>Model::create` of the engine from it,
+and hands over the state shared by the whole process to the engine by `adopt` before calling it.
+*/
+struct EngineShared
+{
+	tomoto::PoolManager* pools;
+	tomoto::HugePages::State* hugePages;
+	tomoto::serializer::StreamFlagIndices streamFlags;
+};
+
+struct EngineLink
+{
+	// engines built from another version of the source are refused
+	static constexpr uint32_t currentVersion = 1;
+
+	uint32_t version;
+	void* create;
+	void(*adopt)(const EngineShared&);
+};
+
+static constexpr const char* engineCapsuleName = "tomotopy.engine";
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "module.h"
+#include "../TopicModel/InferenceModel.h"
+
+struct InferenceModelObject
+{
+	PyObject_HEAD;
+	union { tomoto::InferenceModel model; };
+	static PyObject* repr(InferenceModelObject* self);
+	static void dealloc(InferenceModelObject* self);
+
+	static PyObject* load(PyObject*, PyObject* args, PyObject* kwargs);
+	static PyObject* infer(InferenceModelObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getK(InferenceModelObject* self, void* closure);
+	static PyObject* getVocabs(InferenceModelObject* self, void* closure);
+	static PyObject* getDType(InferenceModelObject* self, void* closure);
+	static PyObject* getTermWeight(InferenceModelObject* self, void* closure);
+};
+
+extern PyTypeObject InferenceModel_type;
+
+void addInferenceTypes(PyObject* gModule);
@@ -130,6 +130,30 @@ k : int
 top_n : int
     토픽 레이블의 개수)"");
 
+DOC_SIGNATURE_EN_KO(Labeler_get_all_topic_labels__doc__,
+	"get_all_topic_labels(self, top_n=10)",
+	u8R""(.. versionadded:: 0.12.3
+
+Return the top-n label candidates for every topic at once.
+The i-th element of the returned list is equal to `get_topic_labels(i, top_n)`,
+but the labels of all topics are selected in parallel and reused by later calls.
+
+Parameters
+----------
+top_n : int
+    the number of labels for each topic
+)"",
+	u8R""(.. versionadded:: 0.12.3
+
+모든 토픽의 레이블 후보 상위 n개를 한 번에 반환합니다.
+반환되는 리스트의 i번째 원소는 `get_topic_labels(i, top_n)`과 같지만,
+모든 토픽의 레이블이 병렬로 선택되며 이후의 호출에서 재사용됩니다.
+
+Parameters
+----------
+top_n : int
+    각 토픽별 레이블의 개수)"");
+
 DOC_SIGNATURE_EN_KO(FoRelevance___init____doc__,
 	"FoRelevance(topic_model, cands, min_df=5, smoothing=0.01, mu=0.25, window_size=-1, workers=0)",
 	u8R""(.. versionadded:: 0.6.0
@@ -15,11 +15,12 @@
 
 #include "../TopicModel/TopicModel.hpp"
 #include "../Utils/serializer.hpp"
+#include "../Utils/Compression.hpp"
 #include "docs.h"
 
-void char2Byte(const std::string& str, std::vector<uint32_t>& startPos, std::vector<uint16_t>& length);
+void char2Byte(const std::string& str, tomoto::tvector<uint32_t>& startPos, tomoto::tvector<uint16_t>& length);
 
-void char2Byte(const char* begin, const char* end, std::vector<uint32_t> & startPos, std::vector<uint16_t> & length);
+void char2Byte(const char* begin, const char* end, tomoto::tvector<uint32_t> & startPos, tomoto::tvector<uint16_t> & length);
 
 #define DEFINE_GETTER_PROTOTYPE(PREFIX, GETTER)\
 PyObject* PREFIX##_##GETTER(TopicModelObject *self, void *closure);
@@ -29,7 +30,7 @@ PyObject* PREFIX##_##GETTER(TopicModelObject *self, void *closure)\
 {\
 	try\
 	{\
-		if (!self->inst) throw runtime_error{ "inst is null" };\
+		checkInst(self);\
 		auto* inst = static_cast<BASE*>(self->inst);\
 		return py::buildPyValue(inst->GETTER());\
 	}\
@@ -52,7 +53,7 @@ int PREFIX##_##SETTER(TopicModelObject* self, PyObject* val, void* closure)\
 {\
 	try\
 	{\
-		if (!self->inst) throw runtime_error{ "inst is null" };\
+		checkInst(self);\
 		auto* inst = static_cast<BASE*>(self->inst);\
 		auto value = PyFloat_AsDouble(val);\
 		if (value == -1 && PyErr_Occurred()) throw bad_exception{};\
@@ -76,7 +77,7 @@ int PREFIX##_##SETTER(TopicModelObject* self, PyObject* val, void* closure)\
 {\
 	try\
 	{\
-		if (!self->inst) throw runtime_error{ "inst is null" };\
+		checkInst(self);\
 		auto* inst = static_cast<BASE*>(self->inst);\
 		auto v = PyLong_AsLong(val);\
 		if (v == -1 && PyErr_Occurred()) throw bad_exception{};\
@@ -96,25 +97,53 @@ int PREFIX##_##SETTER(TopicModelObject* self, PyObject* val, void* closure)\
 }
 
 
+// decompresses the model in `str` with all cores if it was saved with `compress=True`, otherwise returns an empty vector
+inline std::vector<char> unpackModel(std::istream& str)
+{
+	if (!tomoto::serializer::isCompressed(str)) return {};
+	py::GILReleaser nogil;
+	return tomoto::serializer::decompress(str, 0);
+}
+
 #define DEFINE_LOADER(PREFIX, TYPE) \
 PyObject* PREFIX##_load(PyObject*, PyObject* args, PyObject *kwargs)\
 {\
 	const char* filename;\
-	static const char* kwlist[] = { "filename", nullptr };\
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;\
+	size_t useMMap = 0;\
+	static const char* kwlist[] = { "filename", "mmap", nullptr };\
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|p", (char**)kwlist, &filename, &useMMap)) return nullptr;\
 	try\
 	{\
-		ifstream str{ filename, ios_base::binary };\
-		if (!str) throw ios_base::failure{ std::string("cannot open file '") + filename + std::string("'") };\
+		ifstream str;\
+		std::shared_ptr<tomoto::MMap> mapped;\
+		std::vector<char> unpacked;\
+		if (useMMap)\
+		{\
+			mapped = std::make_shared<tomoto::MMap>(filename);\
+			/* compressed arrays cannot be used in place, so they are decompressed into memory */\
+			tomoto::serializer::imstream mstr{ mapped->get(), (std::ptrdiff_t)mapped->size() };\
+			unpacked = unpackModel(mstr);\
+			if (!unpacked.empty()) mapped.reset();\
+		}\
+		else\
+		{\
+			str.open(filename, ios_base::binary);\
+			if (!str) throw ios_base::failure{ std::string("cannot open file '") + filename + std::string("'") };\
+			unpacked = unpackModel(str);\
+		}\
+		tomoto::serializer::imstream ustr{ unpacked.data(), (std::ptrdiff_t)unpacked.size() };\
+		std::istream& in = unpacked.empty() ? (std::istream&)str : ustr;\
 		for (size_t i = 0; i < (size_t)tomoto::TermWeight::size; ++i)\
 		{\
-			str.seekg(0);\
+			if (!mapped) in.seekg(0);\
 			py::UniqueObj args{ Py_BuildValue("(n)", i) };\
 			auto* p = PyObject_CallObject((PyObject*)&TYPE, args);\
+			if (!p) throw bad_exception{};\
 			try\
 			{\
 				vector<uint8_t> extra_data;\
-				((TopicModelObject*)p)->inst->loadModel(str, &extra_data);\
+				if (mapped) ((TopicModelObject*)p)->inst->loadModel(mapped, &extra_data);\
+				else ((TopicModelObject*)p)->inst->loadModel(in, &extra_data);\
 				if (!extra_data.empty())\
 				{\
 					py::UniqueObj pickle{ PyImport_ImportModule("pickle") };\
@@ -160,15 +189,19 @@ PyObject* PREFIX##_loads(PyObject*, PyObject* args, PyObject *kwargs)\
 	try\
 	{\
 		tomoto::serializer::imstream str{ (const char*)data.buf, data.len };\
+		std::vector<char> unpacked = unpackModel(str);\
+		tomoto::serializer::imstream ustr{ unpacked.data(), (std::ptrdiff_t)unpacked.size() };\
+		std::istream& in = unpacked.empty() ? (std::istream&)str : ustr;\
 		for (size_t i = 0; i < (size_t)tomoto::TermWeight::size; ++i)\
 		{\
-			str.seekg(0);\
+			in.seekg(0);\
 			py::UniqueObj args{ Py_BuildValue("(n)", i) };\
 			auto* p = PyObject_CallObject((PyObject*)&TYPE, args);\
+			if (!p) throw bad_exception{};\
 			try\
 			{\
 				vector<uint8_t> extra_data;\
-				((TopicModelObject*)p)->inst->loadModel(str, &extra_data);\
+				((TopicModelObject*)p)->inst->loadModel(in, &extra_data);\
 				if (!extra_data.empty())\
 				{\
 					py::UniqueObj pickle{ PyImport_ImportModule("pickle") };\
@@ -335,9 +368,64 @@ struct TopicModelObject
 	size_t minWordCnt, minWordDf;
 	size_t removeTopWord;
 	PyObject* initParams;
+	size_t numCountViews; // the number of live views of `topic_word_counts`
+	size_t numDocViews; // the number of live views of the arrays of the model's documents
+	size_t numInferring; // the number of `infer` calls running on the model without the GIL
+	unsigned long busyThread; // the id of the Python thread running `train` or another call modifying the model without the GIL, 0 if none
+	bool consumed; // whether the documents were moved out by `HDPModel.convert_to_lda(move_docs=True)`, which leaves the model unusable
 	static void dealloc(TopicModelObject* self);
 };
 
+/*
+`train` and the other calls modifying the model release the GIL, so any call on the model from another Python thread would race with them.
+The callbacks of `train` run on its own thread while the sampling is paused, so they may still read the model.
+*/
+inline void checkInst(TopicModelObject* self)
+{
+	if (!self->inst) throw py::RuntimeError{ "inst is null" };
+	if (self->consumed) throw py::RuntimeError{ "cannot use the model whose documents were moved by `convert_to_lda(move_docs=True)`" };
+	if (self->busyThread && self->busyThread != PyThread_get_thread_ident())
+	{
+		throw py::RuntimeError{ "cannot use the model while `train` is running on another thread" };
+	}
+}
+
+/*
+`infer` only reads the model, so any number of threads may run it at the same time without the GIL,
+but the model must not be modified meanwhile, nor while `train` is running even on the same thread by its callbacks.
+*/
+inline void checkNotInferring(TopicModelObject* self, const char* action)
+{
+	if (self->numInferring) throw py::RuntimeError{ std::string{ "cannot " } + action + " while `infer` or `save` is running on other threads" };
+	if (self->busyThread) throw py::RuntimeError{ std::string{ "cannot " } + action + " while `train` is running" };
+}
+
+// marks `tm` busy. It should be created before releasing the GIL and destroyed after acquiring it again.
+class BusyScope
+{
+	TopicModelObject* tm;
+public:
+	BusyScope(TopicModelObject* _tm) : tm{ _tm }
+	{
+		tm->busyThread = PyThread_get_thread_ident();
+	}
+
+	~BusyScope()
+	{
+		tm->busyThread = 0;
+	}
+};
+
+struct InferenceSessionObject
+{
+	PyObject_HEAD;
+	TopicModelObject* tm;
+	tomoto::IInferenceSession* inst;
+	static void dealloc(InferenceSessionObject* self);
+};
+
+extern PyTypeObject InferenceSession_type;
+
 DEFINE_GETTER_PROTOTYPE(LDA, getK);
 DEFINE_GETTER_PROTOTYPE(LDA, getAlpha);
 DEFINE_GETTER_PROTOTYPE(LDA, getEta);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "module.h"
+#include "../TopicModel/MultiChainLDA.h"
+
+struct MultiChainLDAObject
+{
+	PyObject_HEAD;
+	union { tomoto::MultiChainLDA model; };
+	static int init(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* repr(MultiChainLDAObject* self);
+	static void dealloc(MultiChainLDAObject* self);
+
+	static PyObject* load(PyObject*, PyObject* args, PyObject* kwargs);
+	static PyObject* save(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* addDoc(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* train(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* rhat(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getLLHistory(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getTopicWords(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getTopicWordDist(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getDocTopicDist(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getNumChains(MultiChainLDAObject* self, void* closure);
+	static PyObject* getKs(MultiChainLDAObject* self, void* closure);
+	static PyObject* getSeeds(MultiChainLDAObject* self, void* closure);
+	static PyObject* getAlpha(MultiChainLDAObject* self, void* closure);
+	static PyObject* getEta(MultiChainLDAObject* self, void* closure);
+	static PyObject* getNumDocs(MultiChainLDAObject* self, void* closure);
+	static PyObject* getNumWords(MultiChainLDAObject* self, void* closure);
+	static PyObject* getGlobalStep(MultiChainLDAObject* self, void* closure);
+	static PyObject* getLLPerWord(MultiChainLDAObject* self, void* closure);
+	static PyObject* getVocabs(MultiChainLDAObject* self, void* closure);
+};
+
+extern PyTypeObject MultiChainLDA_type;
+
+void addMultiChainTypes(PyObject* gModule);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "module.h"
+#include "../TopicModel/OnlineLDA.h"
+
+struct OnlineLDAObject
+{
+	PyObject_HEAD;
+	union { tomoto::OnlineLDA model; };
+	static int init(OnlineLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* repr(OnlineLDAObject* self);
+	static void dealloc(OnlineLDAObject* self);
+
+	static PyObject* fromModel(PyObject*, PyObject* args, PyObject* kwargs);
+	static PyObject* load(PyObject*, PyObject* args, PyObject* kwargs);
+	static PyObject* save(OnlineLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* partialFit(OnlineLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* infer(OnlineLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getTopicWords(OnlineLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getTopicWordDist(OnlineLDAObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* getK(OnlineLDAObject* self, void* closure);
+	static PyObject* getAlpha(OnlineLDAObject* self, void* closure);
+	static PyObject* getEta(OnlineLDAObject* self, void* closure);
+	static PyObject* getTau0(OnlineLDAObject* self, void* closure);
+	static PyObject* getKappa(OnlineLDAObject* self, void* closure);
+	static PyObject* getTotalDocs(OnlineLDAObject* self, void* closure);
+	static int setTotalDocs(OnlineLDAObject* self, PyObject* val, void* closure);
+	static PyObject* getNumDocs(OnlineLDAObject* self, void* closure);
+	static PyObject* getNumUpdates(OnlineLDAObject* self, void* closure);
+	static PyObject* getVocabs(OnlineLDAObject* self, void* closure);
+};
+
+extern PyTypeObject OnlineLDA_type;
+
+void addOnlineTypes(PyObject* gModule);
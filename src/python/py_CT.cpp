@@ -46,7 +46,7 @@ static PyObject* CT_getCorrelations(TopicModelObject* self, PyObject* args, PyOb
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", (char**)kwlist, &argTopicId)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ICTModel*>(self->inst);
 
 		if (!argTopicId || argTopicId == Py_None)
@@ -76,7 +76,7 @@ PyObject* CT_getPriorCov(TopicModelObject *self, void *closure)
 {
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ICTModel*>(self->inst);
 		py::UniqueObj obj{ py::buildPyValue(inst->getPriorCov()) };
 		PyArray_Dims dims;
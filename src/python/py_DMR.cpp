@@ -56,7 +56,7 @@ static PyObject* DMR_addDoc(TopicModelObject* self, PyObject* args, PyObject *kw
 		&argWords, &metadata, &multiMetadata)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		if (self->isPrepared) throw py::RuntimeError{ "cannot add_doc() after train()" };
 		auto* inst = static_cast<tomoto::IDMRModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
@@ -91,7 +91,7 @@ static DocumentObject* DMR_makeDoc(TopicModelObject* self, PyObject* args, PyObj
 		&argWords, &metadata, &multiMetadata)) return nullptr;
 	return py::handleExc([&]() -> DocumentObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDMRModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
 		{
@@ -129,7 +129,7 @@ static PyObject* DMR_getTopicPrior(TopicModelObject* self, PyObject* args, PyObj
 		&metadata, &multiMetadata, &raw)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDMRModel*>(self->inst);
 		if (multiMetadata && PyUnicode_Check(multiMetadata))
 		{
@@ -152,7 +152,7 @@ static VocabObject* DMR_getMetadataDict(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* ret = (VocabObject*)PyObject_CallObject((PyObject*)&UtilsVocab_type, nullptr);
 		ret->dep = (PyObject*)self;
 		Py_INCREF(ret->dep);
@@ -166,7 +166,7 @@ static VocabObject* DMR_getMultiMetadataDict(TopicModelObject* self, void* closu
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* ret = (VocabObject*)PyObject_CallObject((PyObject*)&UtilsVocab_type, nullptr);
 		ret->dep = (PyObject*)self;
 		Py_INCREF(ret->dep);
@@ -180,7 +180,7 @@ static PyObject* DMR_getLambda(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDMRModel*>(self->inst);
 		npy_intp shapes[2] = { (npy_intp)inst->getK(), (npy_intp)(inst->getF() * inst->getMdVecSize()) };
 		PyObject* ret = PyArray_EMPTY(2, shapes, NPY_FLOAT, 0);
@@ -197,7 +197,7 @@ static PyObject* DMR_getLambdaV2(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDMRModel*>(self->inst);
 		npy_intp shapes[3] = { (npy_intp)inst->getK(), (npy_intp)inst->getF(), (npy_intp)inst->getMdVecSize() };
 		PyObject* ret = PyArray_EMPTY(3, shapes, NPY_FLOAT, 0);
@@ -214,7 +214,7 @@ static PyObject* DMR_getAlpha(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDMRModel*>(self->inst);
 		npy_intp shapes[2] = { (npy_intp)inst->getK(), (npy_intp)inst->getF() };
 		PyObject* ret = PyArray_EMPTY(2, shapes, NPY_FLOAT, 0);
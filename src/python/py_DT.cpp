@@ -51,7 +51,7 @@ static PyObject* DT_addDoc(TopicModelObject* self, PyObject* args, PyObject *kwa
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", (char**)kwlist, &argWords, &timepoint)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		if (self->isPrepared) throw py::RuntimeError{ "cannot add_doc() after train()" };
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
@@ -73,7 +73,7 @@ static DocumentObject* DT_makeDoc(TopicModelObject* self, PyObject* args, PyObje
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", (char**)kwlist, &argWords, &timepoint)) return nullptr;
 	return py::handleExc([&]() -> DocumentObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
 		{
@@ -97,7 +97,7 @@ static PyObject* DT_getAlpha(TopicModelObject* self, PyObject* args, PyObject *k
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &timepoint)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 
 		if (timepoint >= inst->getT()) throw py::ValueError{ "`timepoint` must < `DTModel.num_timepoints`" };
@@ -118,7 +118,7 @@ static PyObject* DT_getPhi(TopicModelObject* self, PyObject* args, PyObject *kwa
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn", (char**)kwlist, &timepoint, &topicId)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 
 		return py::buildPyValue(inst->getPhi(topicId, timepoint));
@@ -132,7 +132,7 @@ static PyObject* DT_getTopicWords(TopicModelObject* self, PyObject* args, PyObje
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn|n", (char**)kwlist, &topicId, &timepoint, &topN)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < k" };
 		if (timepoint >= inst->getT()) throw py::ValueError{ "must topic_id < t" };
@@ -148,7 +148,7 @@ static PyObject* DT_getTopicWordDist(TopicModelObject* self, PyObject* args, PyO
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn|p", (char**)kwlist, &topicId, &timepoint, &normalize)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < k" };
 		if (timepoint >= inst->getT()) throw py::ValueError{ "must topic_id < t" };
@@ -161,7 +161,7 @@ static PyObject* DT_getCountByTopics(TopicModelObject* self)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 
 		auto l = inst->getCountByTopic();
@@ -201,12 +201,26 @@ DEFINE_GETTER(tomoto::IDTModel, DT, getNumDocsByT);
 DEFINE_SETTER_CHECKED_FLOAT(tomoto::IDTModel, DT, setShapeA, value > 0);
 DEFINE_SETTER_CHECKED_FLOAT(tomoto::IDTModel, DT, setShapeB, value >= 0);
 DEFINE_SETTER_CHECKED_FLOAT(tomoto::IDTModel, DT, setShapeC, 0.5 < value && value <= 1);
+DEFINE_GETTER(tomoto::IDTModel, DT, getTimePartition);
+
+static int DT_setTimePartition(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setTimePartition(!!v);
+		return 0;
+	});
+}
 
 static PyObject* DT_alpha(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDTModel*>(self->inst);
 		npy_intp shapes[2] = { (npy_intp)inst->getT(), (npy_intp)inst->getK() };
 		PyObject* ret = PyArray_EMPTY(2, shapes, NPY_FLOAT, 0);
@@ -229,6 +243,7 @@ static PyGetSetDef DT_getseters[] = {
 	{ (char*)"eta", nullptr, nullptr, DT_eta__doc__, nullptr },
 	{ (char*)"num_timepoints", (getter)DT_getT, nullptr, DT_num_timepoints__doc__, nullptr },
 	{ (char*)"num_docs_by_timepoint", (getter)DT_getNumDocsByT, nullptr, DT_num_docs_by_timepoint__doc__, nullptr },
+	{ (char*)"time_partition", (getter)DT_getTimePartition, (setter)DT_setTimePartition, DT_time_partition__doc__, nullptr },
 	{ nullptr },
 };
 
@@ -86,7 +86,7 @@ static PyObject* GDMR_addDoc(TopicModelObject* self, PyObject* args, PyObject *k
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Oz", (char**)kwlist, &argWords, &argNumMetadata, &metadata)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		if (self->isPrepared) throw py::RuntimeError{ "cannot add_doc() after train()" };
 		auto* inst = static_cast<tomoto::IGDMRModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
@@ -119,7 +119,7 @@ static DocumentObject* GDMR_makeDoc(TopicModelObject* self, PyObject* args, PyOb
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Oz", (char**)kwlist, &argWords, &argNumMetadata, &metadata)) return nullptr;
 	return py::handleExc([&]() -> DocumentObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IDMRModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
 		{
@@ -157,7 +157,7 @@ static PyObject* GDMR_tdf(TopicModelObject* self, PyObject* args, PyObject *kwar
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|zOp", (char**)kwlist, &argNumMetadata, &metadata, &multiMetadata, &normalize)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IGDMRModel*>(self->inst);
 
 		auto v = py::toCpp<vector<tomoto::Float>>(argNumMetadata, "`numeric_metadata` must be an iterable of float.");
@@ -179,13 +179,13 @@ static PyObject* GDMR_tdfLinspace(TopicModelObject* self, PyObject* args, PyObje
 	PyObject *argMetadataStart = nullptr, *argMetadataStop = nullptr, *argNum = nullptr;
 	PyObject* multiMetadata = nullptr;
 	const char* metadata = "";
-	size_t endpoint = 1, normalize = 1;
-	static const char* kwlist[] = { "numeric_metadata_start", "numeric_metadata_stop", "num", "metadata", "multi_metadata", "endpoint", "normalize", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|zOpp", (char**)kwlist, 
-		&argMetadataStart, &argMetadataStop, &argNum, &metadata, &multiMetadata, &endpoint, &normalize)) return nullptr;
+	size_t endpoint = 1, normalize = 1, workers = 0;
+	static const char* kwlist[] = { "numeric_metadata_start", "numeric_metadata_stop", "num", "metadata", "multi_metadata", "endpoint", "normalize", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|zOppn", (char**)kwlist, 
+		&argMetadataStart, &argMetadataStop, &argNum, &metadata, &multiMetadata, &endpoint, &normalize, &workers)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IGDMRModel*>(self->inst);
 		auto start = py::toCpp<vector<tomoto::Float>>(argMetadataStart, "`metadata_start` must be an iterable of float.");
 		if (start.size() != inst->getFs().size()) throw py::ValueError{ "`len(metadata_start)` must be equal to `len(degree).`" };
@@ -226,7 +226,7 @@ static PyObject* GDMR_tdfLinspace(TopicModelObject* self, PyObject* args, PyObje
 
 		try
 		{
-			py::UniqueObj obj{ py::buildPyValue(inst->getTDFBatch(mds.data(), metadata, {}, num.size(), tot, !!normalize)) };
+			py::UniqueObj obj{ py::buildPyValue(inst->getTDFBatch(mds.data(), metadata, {}, num.size(), tot, !!normalize, workers)) };
 			PyArray_Dims dims;
 			num.emplace_back(inst->getK());
 			dims.ptr = num.data();
@@ -244,7 +244,7 @@ static PyObject* GDMR_getMetadataRange(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IGDMRModel*>(self->inst);
 		vector<float> vMin, vMax;
 		inst->getMdRange(vMin, vMax);
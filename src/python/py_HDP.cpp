@@ -40,7 +40,7 @@ static PyObject* HDP_isLiveTopic(TopicModelObject* self, PyObject* args, PyObjec
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &topicId)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IHDPModel*>(self->inst);
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < K" };
 
@@ -51,14 +51,22 @@ static PyObject* HDP_isLiveTopic(TopicModelObject* self, PyObject* args, PyObjec
 static PyObject* HDP_convertToLDA(TopicModelObject* self, PyObject* args, PyObject *kwargs)
 {
 	float topicThreshold = 0;
-	static const char* kwlist[] = { "topic_threshold", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|f", (char**)kwlist, &topicThreshold)) return nullptr;
+	size_t moveDocs = 0;
+	static const char* kwlist[] = { "topic_threshold", "move_docs", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|fp", (char**)kwlist, &topicThreshold, &moveDocs)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto inst = static_cast<tomoto::IHDPModel*>(self->inst);
+		if (moveDocs)
+		{
+			checkNotInferring(self, "move the documents");
+			if (self->numDocViews) throw py::BufferError{ "cannot move the documents while views of them exist" };
+		}
 		std::vector<tomoto::Tid> newK;
-		auto lda = inst->convertToLDA(topicThreshold, newK);
+		auto lda = inst->convertToLDA(topicThreshold, newK, !!moveDocs);
+		// the documents left in this model are empty, so it can't be used any more
+		if (moveDocs) self->consumed = true;
 		py::UniqueObj r{ PyObject_CallObject((PyObject*)&LDA_type, nullptr) };
 		auto ret = (TopicModelObject*)r.get();
 		delete ret->inst;
@@ -83,6 +91,19 @@ PyObject* Document_HDP_Z(DocumentObject* self, void* closure)
 	});
 }
 
+bool Document_HDP_fillZ(const tomoto::DocumentBase* doc, int16_t* out)
+{
+	return docVisit<tomoto::DocumentHDP>(doc, [&](auto* doc)
+	{
+		fillReorder(doc->Zs, doc->wOrder, out, [doc](tomoto::Tid x) -> int16_t
+		{
+			if (x == tomoto::non_topic_id) return -1;
+			return doc->numTopicByTable[x].topic;
+		});
+		return true;
+	});
+}
+
 
 DEFINE_GETTER(tomoto::IHDPModel, HDP, getAlpha);
 DEFINE_GETTER(tomoto::IHDPModel, HDP, getGamma);
@@ -46,7 +46,7 @@ static PyObject* HLDA_##NAME(TopicModelObject* self, PyObject* args, PyObject *k
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &topicId)) return nullptr;\
 	return py::handleExc([&]()\
 	{\
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };\
+		checkInst(self);\
 		auto* inst = static_cast<tomoto::IHLDAModel*>(self->inst);\
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < K" };\
 		if (!self->isPrepared) throw py::RuntimeError{ "train() should be called first" };\
@@ -67,12 +67,25 @@ PyObject* Document_HLDA_Z(DocumentObject* self, void* closure)
 	});
 }
 
+bool Document_HLDA_fillZ(const tomoto::DocumentBase* doc, int16_t* out)
+{
+	return docVisit<tomoto::DocumentHLDA>(doc, [&](auto* doc)
+	{
+		fillReorder(doc->Zs, doc->wOrder, out, [doc](tomoto::Tid x) -> int16_t
+		{
+			if (x == tomoto::non_topic_id) return -1;
+			return doc->path[x];
+		});
+		return true;
+	});
+}
+
 
 PyObject* HLDA_getAlpha(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IHLDAModel*>(self->inst);
 		vector<float> ret;
 		for (size_t i = 0; i < inst->getLevelDepth(); ++i)
@@ -87,6 +100,13 @@ PyObject* HLDA_getAlpha(TopicModelObject* self, void* closure)
 DEFINE_GETTER(tomoto::IHLDAModel, HLDA, getGamma);
 DEFINE_GETTER(tomoto::IHLDAModel, HLDA, getLevelDepth);
 DEFINE_GETTER(tomoto::IHLDAModel, HLDA, getLiveK);
+DEFINE_GETTER(tomoto::IHLDAModel, HLDA, getPathBatch);
+
+DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::IHLDAModel, HLDA, setPathBatch);
+
+DEFINE_GETTER(tomoto::IHLDAModel, HLDA, getPathPruneThreshold);
+
+DEFINE_SETTER_CHECKED_FLOAT(tomoto::IHLDAModel, HLDA, setPathPruneThreshold, value >= 0);
 
 DEFINE_LOADER(HLDA, HLDA_type);
 
@@ -114,6 +134,8 @@ static PyGetSetDef HLDA_getseters[] = {
 	{ (char*)"gamma", (getter)HLDA_getGamma, nullptr, HLDA_gamma__doc__, nullptr },
 	{ (char*)"live_k", (getter)HLDA_getLiveK, nullptr, HLDA_live_k__doc__, nullptr },
 	{ (char*)"depth", (getter)HLDA_getLevelDepth, nullptr, HLDA_depth__doc__, nullptr },
+	{ (char*)"path_batch", (getter)HLDA_getPathBatch, (setter)HLDA_setPathBatch, HLDA_path_batch__doc__, nullptr },
+	{ (char*)"path_prune_threshold", (getter)HLDA_getPathPruneThreshold, (setter)HLDA_setPathPruneThreshold, HLDA_path_prune_threshold__doc__, nullptr },
 	{ nullptr },
 };
 
@@ -49,7 +49,7 @@ static PyObject* HPA_getTopicWords(TopicModelObject* self, PyObject* args, PyObj
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", (char**)kwlist, &topicId, &topN)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IHPAModel*>(self->inst);
 		if (topicId > inst->getK() + inst->getK2()) throw py::ValueError{ "must topic_id < 1 + K1 + K2" };
 
@@ -64,7 +64,7 @@ static PyObject* HPA_getTopicWordDist(TopicModelObject* self, PyObject* args, Py
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|p", (char**)kwlist, &topicId, &normalize)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IHPAModel*>(self->inst);
 		if (topicId > inst->getK() + inst->getK2()) throw py::ValueError{ "must topic_id < 1 + K1 + K2" };
 		
@@ -80,7 +80,7 @@ static PyObject* HPA_getAlpha(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IHPAModel*>(self->inst);
 		npy_intp shapes[1] = { (npy_intp)inst->getK() + 1 };
 		PyObject* ret = PyArray_EMPTY(1, shapes, NPY_FLOAT, 0);
@@ -96,7 +96,7 @@ static PyObject* HPA_getSubalpha(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IHPAModel*>(self->inst);
 		npy_intp shapes[2] = { (npy_intp)inst->getK(), (npy_intp)inst->getK2() + 1 };
 		PyObject* ret = PyArray_EMPTY(2, shapes, NPY_FLOAT, 0);
@@ -1,4 +1,6 @@
+#include <cstdio>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <sstream>
 
@@ -12,23 +14,30 @@ using namespace std;
 static int LDA_init(TopicModelObject *self, PyObject *args, PyObject *kwargs)
 {
 	size_t tw = 0, minCnt = 0, minDf = 0, rmTop = 0;
+	int compact = 0;
 	tomoto::LDAArgs margs;
 	PyObject* objCorpus = nullptr, *objTransform = nullptr;
 	PyObject* objAlpha = nullptr;
 	static const char* kwlist[] = { "tw", "min_cf", "min_df", "rm_top", "k", "alpha", "eta", "seed",
-		"corpus", "transform", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nnnnnOfnOO", (char**)kwlist, 
-		&tw, &minCnt, &minDf, &rmTop, &margs.k, &objAlpha, &margs.eta, &margs.seed, &objCorpus, &objTransform)) return -1;
+		"corpus", "transform", "compact", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nnnnnOfnOOp", (char**)kwlist, 
+		&tw, &minCnt, &minDf, &rmTop, &margs.k, &objAlpha, &margs.eta, &margs.seed, &objCorpus, &objTransform, &compact)) return -1;
 	return py::handleExc([&]()
 	{
 		if (objAlpha) margs.alpha = broadcastObj<tomoto::Float>(objAlpha, margs.k,
 			[=]() { return "`alpha` must be an instance of `float` or `List[float]` with length `k` (given " + py::repr(objAlpha) + ")"; }
 		);
+		margs.compact = !!compact;
 
 		tomoto::ITopicModel* inst = tomoto::ILDAModel::create((tomoto::TermWeight)tw, margs);
 		if (!inst) throw py::ValueError{ "unknown tw value" };
 		self->inst = inst;
 		self->isPrepared = false;
+		self->numCountViews = 0;
+		self->numDocViews = 0;
+		self->numInferring = 0;
+		self->busyThread = 0;
+		self->consumed = false;
 		self->minWordCnt = minCnt;
 		self->minWordDf = minDf;
 		self->removeTopWord = rmTop;
@@ -36,6 +45,7 @@ static int LDA_init(TopicModelObject *self, PyObject *args, PyObject *kwargs)
 			tw, minCnt, minDf, rmTop, margs.k, margs.alpha, margs.eta, margs.seed
 		);
 		py::setPyDictItem(self->initParams, "version", getVersion());
+		py::setPyDictItem(self->initParams, "compact", margs.compact);
 
 		insertCorpus(self, objCorpus, objTransform);
 		return 0;
@@ -49,9 +59,10 @@ static PyObject* LDA_addDoc(TopicModelObject* self, PyObject* args, PyObject *kw
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &argWords)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
-		if (self->isPrepared) throw py::RuntimeError{ "cannot add_doc() after train()" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		checkNotInferring(self, "add documents");
+		if (self->isPrepared && !inst->canAppendDocs()) throw py::RuntimeError{ "cannot add_doc() after train()" };
 		if (PyUnicode_Check(argWords))
 		{
 			if (PyErr_WarnEx(PyExc_RuntimeWarning, "`words` should be an iterable of str.", 1)) return nullptr;
@@ -69,8 +80,9 @@ static PyObject* LDA_addCorpus(TopicModelObject* self, PyObject* args, PyObject*
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", (char**)kwlist, &corpus, &transform)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
-		if (self->isPrepared) throw py::RuntimeError{ "cannot add_corpus() after train()" };
+		checkInst(self);
+		checkNotInferring(self, "add documents");
+		if (self->isPrepared && !static_cast<tomoto::ILDAModel*>(self->inst)->canAppendDocs()) throw py::RuntimeError{ "cannot add_corpus() after train()" };
 		if (!PyObject_TypeCheck(corpus, &UtilsCorpus_type)) throw py::ValueError{ "`corpus` must be an instance of `tomotopy.utils.Corpus`" };
 		py::UniqueObj _corpusRet{ PyObject_CallFunctionObjArgs((PyObject*)&UtilsCorpus_type, (PyObject*)self, nullptr) };
 		CorpusObject* corpusRet = (CorpusObject*)_corpusRet.get();
@@ -83,6 +95,60 @@ static PyObject* LDA_addCorpus(TopicModelObject* self, PyObject* args, PyObject*
 	});
 }
 
+static PyObject* LDA_addTokenArrays(TopicModelObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* vocabs, * tokenIds, * offsets, * uids = nullptr;
+	size_t workers = 0;
+	static const char* kwlist[] = { "vocabs", "token_ids", "offsets", "uids", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|On", (char**)kwlist,
+		&vocabs, &tokenIds, &offsets, &uids, &workers)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		checkNotInferring(self, "add documents");
+		if (self->isPrepared && !inst->canAppendDocs()) throw py::RuntimeError{ "cannot add_token_arrays() after train()" };
+		if (((TopicModelTypeObject*)self->ob_base.ob_type)->miscConverter)
+			throw py::ValueError{ "`add_token_arrays()` is not supported for models requiring extra arguments per document. Use `add_doc()` instead." };
+		TokenArrays arrays{ vocabs, tokenIds, offsets, uids };
+
+		// only the used words enter the vocabulary of the model, in the order of their first occurrences like `add_doc`
+		vector<string> usedWords;
+		usedWords.reserve(arrays.usedVocabs.size());
+		for (auto v : arrays.usedVocabs) usedWords.emplace_back(arrays.vocabs[v]);
+		inst->updateVocab(usedWords);
+		vector<tomoto::Vid> remap(arrays.vocabs.size(), tomoto::non_vocab_id);
+		for (auto v : arrays.usedVocabs) remap[v] = inst->getVocabDict().toWid(arrays.vocabs[v]);
+
+		// batch.offsets are relative to batch.words, so they start from the first offset
+		vector<size_t> relOffsets(arrays.offsets.size());
+		for (size_t i = 0; i < relOffsets.size(); ++i) relOffsets[i] = arrays.offsets[i] - arrays.offsets[0];
+
+		tomoto::DocBatch batch;
+		// -1 in token_ids is reinterpreted as `non_vocab_id` and dropped
+		batch.words = (const tomoto::Vid*)arrays.tokens + arrays.offsets[0];
+		batch.offsets = relOffsets.data();
+		batch.size = arrays.size();
+		batch.vocabRemap = remap.data();
+		if (!arrays.uids.empty())
+		{
+			batch.fillKernel = [&](size_t i, tomoto::RawDocKernel& doc, const vector<uint32_t>&)
+			{
+				doc.docUid = tomoto::SharedString{ arrays.uids[i] };
+			};
+		}
+
+		vector<size_t> ids;
+		{
+			BusyScope busy{ self };
+			py::GILReleaser nogil;
+			ids = inst->addDocs(batch, workers);
+		}
+		vector<int64_t> ret{ ids.begin(), ids.end() };
+		return py::buildPyValue(ret);
+	});
+}
+
 static DocumentObject* LDA_makeDoc(TopicModelObject* self, PyObject* args, PyObject *kwargs)
 {
 	PyObject *argWords = nullptr;
@@ -90,7 +156,7 @@ static DocumentObject* LDA_makeDoc(TopicModelObject* self, PyObject* args, PyObj
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &argWords)) return nullptr;
 	return py::handleExc([&]() -> DocumentObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
 		{
@@ -114,7 +180,7 @@ PyObject* LDA_setWordPrior(TopicModelObject* self, PyObject* args, PyObject *kwa
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "sO", (char**)kwlist, &word, &prior)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		if (self->isPrepared) throw py::RuntimeError{ "cannot set_word_prior() after train()" };
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 		inst->setWordPrior(word, py::toCpp<vector<tomoto::Float>>(prior, "`prior` must be a list of floats with len = k"));
@@ -123,6 +189,79 @@ PyObject* LDA_setWordPrior(TopicModelObject* self, PyObject* args, PyObject *kwa
 	});
 }
 
+static PyObject* LDA_setWarmStart(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	PyObject* model;
+	static const char* kwlist[] = { "model", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &model)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		if (self->isPrepared) throw py::RuntimeError{ "cannot set_warm_start() after train()" };
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		if (model == Py_None)
+		{
+			inst->setWarmStart(nullptr);
+			Py_INCREF(Py_None);
+			return Py_None;
+		}
+		if (!PyObject_TypeCheck(model, &LDA_type)) throw py::ValueError{ "`model` must be an instance of `tomotopy.LDAModel` or its subclasses" };
+		auto* source = (TopicModelObject*)model;
+		if (!source->inst) throw py::RuntimeError{ "inst of `model` is null" };
+		if (!source->isPrepared) throw py::ValueError{ "`model` should be trained first" };
+		try
+		{
+			inst->setWarmStart(static_cast<tomoto::ILDAModel*>(source->inst));
+		}
+		catch (const tomoto::exc::InvalidArgument& e)
+		{
+			throw py::ValueError{ e.what() };
+		}
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+static PyObject* LDA_setDistributedSync(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	PyObject *vocabs, *exchange;
+	float threshold = 0;
+	static const char* kwlist[] = { "vocabs", "exchange", "threshold", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|f", (char**)kwlist, &vocabs, &exchange, &threshold)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		if (exchange == Py_None)
+		{
+			inst->setDistributedSync({}, {}, 0);
+			Py_INCREF(Py_None);
+			return Py_None;
+		}
+		if (!PyCallable_Check(exchange)) throw py::ValueError{ "`exchange` must be callable" };
+		auto words = py::toCpp<vector<string>>(vocabs, "`vocabs` must be an iterable of str");
+
+		// it is called by `train` without the GIL
+		py::SharedObj fn{ exchange };
+		Py_INCREF(exchange);
+		inst->setDistributedSync(words, [fn](tomoto::TopicWordDelta&& delta)
+		{
+			py::GILAcquirer gil;
+			py::UniqueObj vids{ py::buildPyValue(delta.vids) }, tids{ py::buildPyValue(delta.tids) }, counts{ py::buildPyValue(delta.counts) };
+			py::UniqueObj ret{ PyObject_CallFunctionObjArgs(fn.get(), vids.get(), tids.get(), counts.get(), nullptr) };
+			if (!ret) throw py::ExcPropagation{};
+			if (!PyTuple_Check(ret.get()) || PyTuple_Size(ret.get()) != 3) throw py::ValueError{ "`exchange` must return a tuple of (vids, tids, counts)" };
+			tomoto::TopicWordDelta all;
+			all.vids = py::toCpp<vector<uint32_t>>(PyTuple_GET_ITEM(ret.get(), 0), "`vids` must be an iterable of int");
+			all.tids = py::toCpp<vector<tomoto::Tid>>(PyTuple_GET_ITEM(ret.get(), 1), "`tids` must be an iterable of int");
+			all.counts = py::toCpp<vector<float>>(PyTuple_GET_ITEM(ret.get(), 2), "`counts` must be an iterable of float");
+			return all;
+		}, threshold);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
 PyObject* LDA_getWordPrior(TopicModelObject* self, PyObject* args, PyObject *kwargs)
 {
 	const char* word;
@@ -130,27 +269,206 @@ PyObject* LDA_getWordPrior(TopicModelObject* self, PyObject* args, PyObject *kwa
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &word)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 		return py::buildPyValue(inst->getWordPrior(word));
 	});
 }
 
+/*
+writes the checkpoints of `train` into `path` on a background thread while sampling continues.
+Only the snapshot is taken on the training thread. It is compressed into a temporary file which replaces `path` at the end,
+so a crash during writing leaves the previous checkpoint intact.
+With `maxDeltas`, up to `maxDeltas` delta checkpoints follow each full one, appended to `path + ".delta"` as separately compressed records.
+A record cut by a crash is ignored by `restore_checkpoint` with the records after it.
+*/
+class CheckpointWriter
+{
+	std::string path;
+	size_t maxDeltas;
+	tomoto::CheckpointBase base;
+	std::future<void> pending;
+	std::exception_ptr error;
+
+	static void compressInto(std::ostream& str, const std::string& data, const std::string& path)
+	{
+		tomoto::serializer::ozstream ostr{ str };
+		ostr.write(data.data(), data.size());
+		ostr.close();
+		if (!ostr || !str.flush()) throw py::OSError{ "writing the checkpoint '" + path + "' is failed" };
+	}
+
+	static void writeFile(const std::string& path, const std::string& data)
+	{
+		const std::string tmpPath = path + ".tmp";
+		{
+			ofstream str{ tmpPath, ios_base::binary };
+			if (!str) throw py::OSError{ "cannot open file '" + tmpPath + "'" };
+			compressInto(str, data, tmpPath);
+		}
+		if (std::rename(tmpPath.c_str(), path.c_str()))
+		{
+			// `rename` doesn't replace an existing file on some platforms
+			std::remove(path.c_str());
+			if (std::rename(tmpPath.c_str(), path.c_str())) throw py::OSError{ "cannot rename '" + tmpPath + "' to '" + path + "'" };
+		}
+		// the deltas of the previous checkpoint. If it is left by a crash, it is ignored since its records are chained to the previous one
+		std::remove((path + ".delta").c_str());
+	}
+
+	static void appendFile(const std::string& path, const std::string& data)
+	{
+		ofstream str{ path, ios_base::binary | ios_base::app };
+		if (!str) throw py::OSError{ "cannot open file '" + path + "'" };
+		compressInto(str, data, path);
+	}
+
+public:
+	CheckpointWriter(std::string _path, size_t _maxDeltas = 0) : path{ std::move(_path) }, maxDeltas{ _maxDeltas }
+	{
+	}
+
+	~CheckpointWriter()
+	{
+		wait();
+	}
+
+	// returns false if this or the previous checkpoint has failed, whose error is raised by `rethrow`
+	bool write(const tomoto::ILDAModel& inst)
+	{
+		wait();
+		if (error) return false;
+		try
+		{
+			ostringstream snapshot;
+			if (base.id && base.numDeltas < maxDeltas && inst.writeCheckpointDelta(snapshot, base))
+			{
+				pending = std::async(std::launch::async, appendFile, path + ".delta", snapshot.str());
+				return true;
+			}
+			snapshot.str({});
+			inst.writeCheckpoint(snapshot, maxDeltas ? &base : nullptr);
+			pending = std::async(std::launch::async, writeFile, path, snapshot.str());
+		}
+		catch (...)
+		{
+			error = std::current_exception();
+			return false;
+		}
+		return true;
+	}
+
+	void wait()
+	{
+		if (!pending.valid()) return;
+		try
+		{
+			pending.get();
+		}
+		catch (...)
+		{
+			if (!error) error = std::current_exception();
+		}
+	}
+
+	void rethrow()
+	{
+		if (error) std::rethrow_exception(error);
+	}
+};
+
 static PyObject* LDA_train(TopicModelObject* self, PyObject* args, PyObject *kwargs)
 {
-	size_t iteration = 10, workers = 0, ps = 0, fixed = 0;
-	static const char* kwlist[] = { "iter", "workers", "parallel", "freeze_topics", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nnnp", (char**)kwlist, &iteration, &workers, &ps, &fixed)) return nullptr;
+	size_t iteration = 10, workers = 0, ps = 0, fixed = 0, callbackInterval = 1, checkpointInterval = 10, checkpointDeltas = 0;
+	PyObject* callback = nullptr;
+	const char* checkpoint = nullptr;
+	static const char* kwlist[] = { "iter", "workers", "parallel", "freeze_topics", "callback", "callback_interval",
+		"checkpoint", "checkpoint_interval", "checkpoint_deltas", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nnnpOnznn", (char**)kwlist, &iteration, &workers, &ps, &fixed, &callback, &callbackInterval,
+		&checkpoint, &checkpointInterval, &checkpointDeltas)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
+		if (callback == Py_None) callback = nullptr;
+		if (callback && !PyCallable_Check(callback)) throw py::ValueError{ "`callback` must be callable" };
+		if (!callbackInterval) throw py::ValueError{ "`callback_interval` must be positive" };
+		if (checkpoint && !checkpointInterval) throw py::ValueError{ "`checkpoint_interval` must be positive" };
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
-		if (!self->isPrepared)
+
+		checkNotInferring(self, "train the model");
+		if (self->isPrepared && inst->getNumNewDocs() && (self->numCountViews || self->numDocViews))
+		{
+			throw py::BufferError{ "cannot prepare new documents while views of `topic_word_counts` or of documents exist" };
+		}
+		if (inst->isSharingArrays() && (self->numCountViews || self->numDocViews))
+		{
+			throw py::BufferError{ "cannot train a model sharing its counts with its copies while views of `topic_word_counts` or of documents exist" };
+		}
+
+		bool callbackFailed = false;
+		CheckpointWriter checkpointWriter{ checkpoint ? checkpoint : "", checkpointDeltas };
+		tomoto::TrainingCallback cb;
+		if (callback || checkpoint) cb = [&](const tomoto::TrainingProgress& p)
+		{
+			const bool last = p.iteration == p.totalIteration;
+			if (checkpoint && (p.iteration % checkpointInterval == 0 || last))
+			{
+				if (!checkpointWriter.write(*inst)) return false;
+			}
+			if (!callback || !(p.iteration % callbackInterval == 0 || last)) return true;
+
+			const double llPerWord = p.getLLPerWord();
+			py::GILAcquirer gil;
+			static const char* keys[] = { "iteration", "global_step", "ll_per_word", "elapsed", "tokens_per_sec" };
+			py::UniqueObj progress{ py::buildPyDict(keys, p.iteration, p.globalStep, llPerWord, p.elapsed, p.tokensPerSec) };
+			py::UniqueObj ret{ PyObject_CallFunctionObjArgs(callback, progress.get(), nullptr) };
+			if (!ret)
+			{
+				callbackFailed = true;
+				return false;
+			}
+			return ret.get() != Py_False;
+		};
+		// both are called by the one callback of `train`, so it is called at every common divisor of their intervals
+		size_t interval = callback ? callbackInterval : checkpointInterval;
+		if (callback && checkpoint)
+		{
+			for (size_t r = checkpointInterval; r; )
+			{
+				const size_t t = interval % r;
+				interval = r;
+				r = t;
+			}
+		}
+
+		// `isPrepared` is written only with the GIL, even if `train` fails after preparing the model
+		bool prepared = false;
+		try
+		{
+			BusyScope busy{ self };
+			py::GILReleaser nogil;
+			if (!self->isPrepared)
+			{
+				inst->setPrepareWorkers(workers);
+				inst->prepare(true, self->minWordCnt, self->minWordDf, self->removeTopWord);
+				prepared = true;
+			}
+			else if (inst->getNumNewDocs())
+			{
+				inst->setPrepareWorkers(workers);
+				inst->prepareNewDocs();
+			}
+			inst->train(iteration, workers, (tomoto::ParallelScheme)ps, !!fixed, cb, interval);
+			checkpointWriter.wait();
+		}
+		catch (...)
 		{
-			inst->prepare(true, self->minWordCnt, self->minWordDf, self->removeTopWord);
-			self->isPrepared = true;
+			if (prepared) self->isPrepared = true;
+			throw;
 		}
-		inst->train(iteration, workers, (tomoto::ParallelScheme)ps, !!fixed);
+		if (prepared) self->isPrepared = true;
+		if (callbackFailed) throw py::ExcPropagation{};
+		checkpointWriter.rethrow();
 		Py_INCREF(Py_None);
 		return Py_None;
 	});
@@ -163,7 +481,7 @@ PyObject* LDA_getTopicWords(TopicModelObject* self, PyObject* args, PyObject *kw
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", (char**)kwlist, &topicId, &topN)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < K" };
 		
@@ -178,7 +496,7 @@ static PyObject* LDA_getTopicWordDist(TopicModelObject* self, PyObject* args, Py
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|p", (char**)kwlist, &topicId, &normalize)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < K" };
 
@@ -186,126 +504,704 @@ static PyObject* LDA_getTopicWordDist(TopicModelObject* self, PyObject* args, Py
 	});
 }
 
+// `fillFn` is called without GIL with an allocator of a 2D float32 array
+template<typename _FillFn>
+static PyObject* buildDistMatrix(_FillFn&& fillFn)
+{
+	py::UniqueObj ret;
+	tomoto::MatrixAllocator alloc = [&](size_t rows, size_t cols)
+	{
+		py::GILAcquirer gil;
+		npy_intp shapes[2] = { (npy_intp)rows, (npy_intp)cols };
+		ret = py::UniqueObj{ PyArray_EMPTY(2, shapes, NPY_FLOAT, 0) };
+		if (!ret) throw py::ExcPropagation{};
+		return (float*)PyArray_DATA((PyArrayObject*)ret.get());
+	};
+	{
+		py::GILReleaser nogil;
+		fillFn(alloc);
+	}
+	return ret.release();
+}
+
+static PyObject* LDA_getTopicWordDists(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	size_t normalize = 1, workers = 0;
+	static const char* kwlist[] = { "normalize", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|pn", (char**)kwlist, &normalize, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		if (!self->isPrepared) throw py::RuntimeError{ "train() should be called first" };
+		return buildDistMatrix([&](const tomoto::MatrixAllocator& alloc)
+		{
+			self->inst->getWidsByTopics(alloc, !!normalize, workers);
+		});
+	});
+}
+
+static PyObject* LDA_getDocTopicDists(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	size_t normalize = 1, workers = 0;
+	static const char* kwlist[] = { "normalize", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|pn", (char**)kwlist, &normalize, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		if (!self->isPrepared) throw py::RuntimeError{ "train() should be called first" };
+		return buildDistMatrix([&](const tomoto::MatrixAllocator& alloc)
+		{
+			self->inst->getTopicsByDocs(alloc, !!normalize, workers);
+		});
+	});
+}
+
+static PyObject* LDA_getAllTopicWords(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	size_t topN = 10, workers = 0, returnWords = 0;
+	static const char* kwlist[] = { "top_n", "workers", "return_words", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nnp", (char**)kwlist, &topN, &workers, &returnWords)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		checkInst(self);
+		if (!self->isPrepared) throw py::RuntimeError{ "train() should be called first" };
+		std::vector<tomoto::Vid> vids;
+		std::vector<tomoto::Float> weights;
+		size_t n;
+		{
+			py::GILReleaser nogil;
+			n = self->inst->getWidsByTopicsSorted(topN, workers, vids, weights);
+		}
+		const size_t k = n ? vids.size() / n : 0;
+		npy_intp shapes[2] = { (npy_intp)k, (npy_intp)n };
+		py::UniqueObj weightArr{ PyArray_EMPTY(2, shapes, NPY_FLOAT, 0) };
+		memcpy(PyArray_DATA((PyArrayObject*)weightArr.get()), weights.data(), sizeof(float) * weights.size());
+		if (returnWords)
+		{
+			auto& dict = self->inst->getVocabDict();
+			std::vector<std::vector<std::string>> words(k);
+			for (size_t i = 0; i < k; ++i)
+			{
+				for (size_t j = 0; j < n; ++j) words[i].emplace_back(dict.toWord(vids[i * n + j]));
+			}
+			return py::buildPyTuple(words, std::move(weightArr));
+		}
+		py::UniqueObj vidArr{ PyArray_EMPTY(2, shapes, NPY_UINT32, 0) };
+		memcpy(PyArray_DATA((PyArrayObject*)vidArr.get()), vids.data(), sizeof(tomoto::Vid) * vids.size());
+		return py::buildPyTuple(std::move(vidArr), std::move(weightArr));
+	});
+}
+
+static void releaseCountView(PyObject* capsule)
+{
+	auto* tm = (TopicModelObject*)PyCapsule_GetPointer(capsule, "tomotopy.topic_word_counts");
+	tm->numCountViews--;
+	Py_DECREF(tm);
+}
+
+static PyObject* LDA_getTopicWordCounts(TopicModelObject* self, void* closure)
+{
+	return py::handleExc([&]() -> PyObject*
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		size_t rows, cols;
+		const void* data = self->isPrepared ? inst->getTopicWordCounts(rows, cols) : nullptr;
+		if (!data)
+		{
+			if (!self->isPrepared) throw py::RuntimeError{ "train() should be called first" };
+			throw py::RuntimeError{ "`topic_word_counts` is not available for this model or when `dense_vocab_size` limits the dense storage" };
+		}
+
+		npy_intp shapes[2] = { (npy_intp)rows, (npy_intp)cols };
+		const int type = inst->getTermWeight() == tomoto::TermWeight::one ? NPY_INT32 : NPY_FLOAT;
+		py::UniqueObj ret{ PyArray_New(&PyArray_Type, 2, shapes, type, nullptr, (void*)data, 0, NPY_ARRAY_F_CONTIGUOUS, nullptr) };
+		if (!ret) throw py::ExcPropagation{};
+		PyArray_CLEARFLAGS((PyArrayObject*)ret.get(), NPY_ARRAY_WRITEABLE);
+		// the capsule keeps the model alive while the view exists
+		PyObject* base = PyCapsule_New(self, "tomotopy.topic_word_counts", releaseCountView);
+		if (!base) throw py::ExcPropagation{};
+		Py_INCREF(self);
+		self->numCountViews++;
+		if (PyArray_SetBaseObject((PyArrayObject*)ret.get(), base) < 0) throw py::ExcPropagation{};
+		return ret.release();
+	});
+}
+
+// counts the running `infer` and `save` calls of `tm`. It should be created before releasing the GIL and destroyed after acquiring it again.
+class InferringScope
+{
+	TopicModelObject* tm;
+public:
+	InferringScope(TopicModelObject* _tm) : tm{ _tm }
+	{
+		tm->numInferring++;
+	}
+
+	~InferringScope()
+	{
+		tm->numInferring--;
+	}
+};
+
+// `inferFn` is called without GIL
+template<typename _InferFn>
+static PyObject* inferDocs(TopicModelObject* self, PyObject* argDoc, PyObject* argTransform, bool together, _InferFn&& inferFn)
+{
+	py::UniqueObj iter;
+	if (PyObject_TypeCheck(argDoc, &UtilsCorpus_type))
+	{
+		CorpusObject* cps = makeCorpus(self, argDoc, argTransform);
+		std::vector<tomoto::DocumentBase*> docs;
+		for (auto& d : cps->docsMade) docs.emplace_back(d.get());
+		std::vector<double> ll;
+		{
+			InferringScope inferring{ self };
+			py::GILReleaser nogil;
+			ll = inferFn(docs);
+		}
+		return py::buildPyTuple(py::UniqueObj{ (PyObject*)cps }, ll);
+	}
+	else if (PyObject_TypeCheck(argDoc, &UtilsDocument_type))
+	{
+		auto* doc = (DocumentObject*)argDoc;
+		if (doc->corpus->tm != self) throw py::ValueError{ "`doc` was from another model, not fit to this model" };
+		if (doc->owner)
+		{
+			std::vector<tomoto::DocumentBase*> docs;
+			docs.emplace_back((tomoto::DocumentBase*)doc->getBoundDoc());
+			float ll;
+			{
+				InferringScope inferring{ self };
+				py::GILReleaser nogil;
+				ll = inferFn(docs)[0];
+			}
+			doc->initialized = true;
+			return Py_BuildValue("(Nf)", py::buildPyValue(self->inst->getTopicsByDoc(doc->getBoundDoc())), ll);
+		}
+		else
+		{
+			return Py_BuildValue("(Ns)", py::buildPyValue(self->inst->getTopicsByDoc(doc->getBoundDoc())), nullptr);
+		}
+	}
+	else if ((iter = py::UniqueObj{ PyObject_GetIter(argDoc) }) != nullptr)
+	{
+		std::vector<tomoto::DocumentBase*> docs;
+		std::vector<DocumentObject*> docObjs;
+		py::UniqueObj item;
+		while ((item = py::UniqueObj{ PyIter_Next(iter) }))
+		{
+			if (!PyObject_TypeCheck(item, &UtilsDocument_type)) throw py::ValueError{ "`doc` must be tomotopy.Document type or list of tomotopy.Document" };
+			auto* doc = (DocumentObject*)item.get();
+			if (doc->corpus->tm != self) throw py::ValueError{ "`doc` was from another model, not fit to this model" };
+			docs.emplace_back((tomoto::DocumentBase*)doc->doc);
+			docObjs.emplace_back(doc);
+		}
+		if (PyErr_Occurred()) throw py::ExcPropagation{};
+		std::vector<double> ll;
+		{
+			InferringScope inferring{ self };
+			py::GILReleaser nogil;
+			ll = inferFn(docs);
+		}
+		
+		for (auto doc : docObjs) doc->initialized = true;
+
+		PyObject* ret = PyList_New(docs.size());
+		size_t i = 0;
+		for (auto d : docs)
+		{
+			PyList_SetItem(ret, i++, py::buildPyValue(self->inst->getTopicsByDoc(d)));
+		}
+		if (together)
+		{
+			return Py_BuildValue("(Nf)", ret, ll[0]);
+		}
+		else
+		{
+			return Py_BuildValue("(NN)", ret, py::buildPyValue(ll));
+		}
+	}
+	else
+	{
+		throw py::ValueError{ "`doc` must be tomotopy.Document type or list of tomotopy.Document" };
+	}
+}
+
+/*
+appends the numbers of iterations done for the documents to `result` of `inferDocs` when inference has a deadline.
+It is an int for a single document or documents inferred together, and a list otherwise.
+*/
+static PyObject* appendIterations(PyObject* result, PyObject* argDoc, bool together, const tomoto::InferenceDeadline& deadline, const vector<uint32_t>& iterations)
+{
+	py::UniqueObj ret{ result };
+	if (!ret || (deadline.seconds <= 0 && deadline.secondsPerDoc <= 0)) return ret.release();
+	py::UniqueObj iters;
+	if (iterations.empty())
+	{
+		Py_INCREF(Py_None);
+		iters = py::UniqueObj{ Py_None };
+	}
+	else if (together || PyObject_TypeCheck(argDoc, &UtilsDocument_type)) iters = py::UniqueObj{ py::buildPyValue(iterations[0]) };
+	else iters = py::UniqueObj{ py::buildPyValue(iterations) };
+	return Py_BuildValue("(OON)", PyTuple_GET_ITEM(ret.get(), 0), PyTuple_GET_ITEM(ret.get(), 1), iters.release());
+}
+
 PyObject* LDA_infer(TopicModelObject* self, PyObject* args, PyObject *kwargs)
 {
 	PyObject *argDoc, *argTransform = nullptr;
 	size_t iteration = 100, workers = 0, together = 0, ps = 0;
 	float tolerance = -1;
-	static const char* kwlist[] = { "doc", "iter", "tolerance", "workers", "parallel", "together", "transform", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nfnnpO", (char**)kwlist, &argDoc, &iteration, &tolerance, &workers, &ps, &together, &argTransform)) return nullptr;
+	tomoto::InferenceDeadline deadline;
+	static const char* kwlist[] = { "doc", "iter", "tolerance", "workers", "parallel", "together", "transform", "timeout", "doc_timeout", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nfnnpOdd", (char**)kwlist, &argDoc, &iteration, &tolerance, &workers, &ps, &together, &argTransform,
+		&deadline.seconds, &deadline.secondsPerDoc)) return nullptr;
 	DEBUG_LOG("infer " << self->ob_base.ob_type << ", " << self->ob_base.ob_refcnt);
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
+		if (!self->isPrepared) throw py::RuntimeError{ "cannot infer with untrained model" };
+		vector<uint32_t> iterations;
+		return appendIterations(inferDocs(self, argDoc, argTransform, !!together, [&](const std::vector<tomoto::DocumentBase*>& docs)
+		{
+			return self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together, deadline, &iterations);
+		}), argDoc, !!together, deadline, iterations);
+	});
+}
+
+/*
+makes the documents [first, last) of `corpus` for the model, like `makeCorpus` but without the raw texts, which inference doesn't need.
+`vocabMap` maps the vocabularies of `corpus` to those of the model.
+Documents without any word known to the model are made as nullptr, so that they keep their positions.
+*/
+static void makeDocBatch(TopicModelObject* self, CorpusObject* corpus, const vector<tomoto::Vid>& vocabMap,
+	size_t first, size_t last, PyObject* transform, vector<unique_ptr<tomoto::DocumentBase>>& docs)
+{
+	auto miscConverter = ((TopicModelTypeObject*)self->ob_base.ob_type)->miscConverter;
+	docs.clear();
+	for (size_t i = first; i < last; ++i)
+	{
+		auto& rdoc = corpus->docs[i];
+		tomoto::RawDoc doc;
+		doc.weight = rdoc.weight;
+		doc.docUid = rdoc.docUid;
+		for (auto w : rdoc.words)
+		{
+			if (w == tomoto::non_vocab_id || vocabMap[w] == tomoto::non_vocab_id) continue;
+			doc.words.emplace_back(vocabMap[w]);
+		}
+		if (doc.words.empty())
+		{
+			docs.emplace_back();
+			continue;
+		}
+		if (miscConverter) doc.misc = miscConverter(self, transformMisc(rdoc.misc, transform));
+		docs.emplace_back(self->inst->makeDoc(doc));
+	}
+}
+
+static PyObject* LDA_inferMatrix(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	PyObject *argDoc, *argTransform = nullptr;
+	size_t iteration = 100, workers = 0, ps = 0, batchSize = 4096;
+	float tolerance = -1;
+	static const char* kwlist[] = { "doc", "iter", "tolerance", "workers", "parallel", "batch_size", "transform", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nfnnnO", (char**)kwlist, &argDoc, &iteration, &tolerance, &workers, &ps, &batchSize, &argTransform)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
 		if (!self->isPrepared) throw py::RuntimeError{ "cannot infer with untrained model" };
-		py::UniqueObj iter;
+		if (!PyObject_TypeCheck(argDoc, &UtilsCorpus_type)) throw py::ValueError{ "`doc` must be an instance of `tomotopy.utils.Corpus`" };
+		auto* corpus = (CorpusObject*)argDoc;
+		if (!corpus->isIndependent()) throw py::ValueError{ "`doc` must be a corpus not bound to a topic model" };
+		if (!batchSize) throw py::ValueError{ "`batch_size` must be positive" };
+		auto* inst = self->inst;
+
+		const auto& dict = corpus->getVocabDict();
+		vector<tomoto::Vid> vocabMap(dict.size());
+		for (size_t v = 0; v < dict.size(); ++v) vocabMap[v] = dict.mapToNewDict(v, inst->getVocabDict());
+
+		const size_t numDocs = corpus->docs.size(), K = inst->getK();
+		npy_intp shapes[2] = { (npy_intp)numDocs, (npy_intp)K };
+		py::UniqueObj theta{ PyArray_EMPTY(2, shapes, NPY_FLOAT, 0) }, ll{ PyArray_EMPTY(1, shapes, NPY_DOUBLE, 0) };
+		if (!theta || !ll) throw py::ExcPropagation{};
+		auto* thetaData = (float*)PyArray_DATA((PyArrayObject*)theta.get());
+		auto* llData = (double*)PyArray_DATA((PyArrayObject*)ll.get());
+
+		// only a batch of documents exists at a time, and the results are written into the arrays directly
+		vector<unique_ptr<tomoto::DocumentBase>> batch;
+		vector<tomoto::DocumentBase*> docs;
+		for (size_t first = 0; first < numDocs; first += batchSize)
+		{
+			const size_t last = std::min(first + batchSize, numDocs);
+			makeDocBatch(self, corpus, vocabMap, first, last, argTransform, batch);
+			docs.clear();
+			for (auto& d : batch) if (d) docs.emplace_back(d.get());
+
+			InferringScope inferring{ self };
+			py::GILReleaser nogil;
+			auto batchLL = docs.empty() ? vector<double>{} : inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, false);
+			for (size_t i = first, j = 0; i < last; ++i)
+			{
+				auto row = thetaData + i * K;
+				auto& d = batch[i - first];
+				if (!d)
+				{
+					std::fill(row, row + K, std::numeric_limits<float>::quiet_NaN());
+					llData[i] = 0;
+					continue;
+				}
+				auto dist = inst->getTopicsByDoc(d.get());
+				std::copy(dist.begin(), dist.end(), row);
+				llData[i] = batchLL[j++];
+			}
+		}
+		return py::buildPyTuple(std::move(theta), std::move(ll));
+	});
+}
+
+static PyObject* LDA_estimateHeldOutLL(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	PyObject *argDoc, *argSeed = nullptr, *argTransform = nullptr;
+	size_t method = 0, particles = 10, workers = 0;
+	static const char* kwlist[] = { "doc", "method", "particles", "workers", "seed", "transform", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nnnOO", (char**)kwlist, &argDoc, &method, &particles, &workers, &argSeed, &argTransform)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		checkInst(self);
+		if (!self->isPrepared) throw py::RuntimeError{ "cannot estimate with untrained model" };
+		if (method >= (size_t)tomoto::HeldOutEstimator::size) throw py::ValueError{ "`method` must be one of `tomotopy.HeldOutEstimator`." };
+		size_t seed = std::random_device{}();
+		if (argSeed && argSeed != Py_None) seed = py::toCpp<size_t>(argSeed, "`seed` must be an integer.");
+
+		std::vector<tomoto::DocumentBase*> docs;
+		py::UniqueObj corpus, iter;
+		bool single = false;
 		if (PyObject_TypeCheck(argDoc, &UtilsCorpus_type))
 		{
-			CorpusObject* cps = makeCorpus(self, argDoc, argTransform);
-			std::vector<tomoto::DocumentBase*> docs;
-			for (auto& d : cps->docsMade) docs.emplace_back(d.get());
-			auto ll = self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together);
-			return py::buildPyTuple(py::UniqueObj{ (PyObject*)cps }, ll);
+			corpus = py::UniqueObj{ (PyObject*)makeCorpus(self, argDoc, argTransform) };
+			for (auto& d : ((CorpusObject*)corpus.get())->docsMade) docs.emplace_back(d.get());
 		}
 		else if (PyObject_TypeCheck(argDoc, &UtilsDocument_type))
 		{
 			auto* doc = (DocumentObject*)argDoc;
 			if (doc->corpus->tm != self) throw py::ValueError{ "`doc` was from another model, not fit to this model" };
-			if (doc->owner)
-			{
-				std::vector<tomoto::DocumentBase*> docs;
-				docs.emplace_back((tomoto::DocumentBase*)doc->getBoundDoc());
-				float ll = self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together)[0];
-				doc->initialized = true;
-				return Py_BuildValue("(Nf)", py::buildPyValue(self->inst->getTopicsByDoc(doc->getBoundDoc())), ll);
-			}
-			else
-			{
-				return Py_BuildValue("(Ns)", py::buildPyValue(self->inst->getTopicsByDoc(doc->getBoundDoc())), nullptr);
-			}
+			docs.emplace_back((tomoto::DocumentBase*)doc->getBoundDoc());
+			single = true;
 		}
 		else if ((iter = py::UniqueObj{ PyObject_GetIter(argDoc) }) != nullptr)
 		{
-			std::vector<tomoto::DocumentBase*> docs;
-			std::vector<DocumentObject*> docObjs;
 			py::UniqueObj item;
 			while ((item = py::UniqueObj{ PyIter_Next(iter) }))
 			{
 				if (!PyObject_TypeCheck(item, &UtilsDocument_type)) throw py::ValueError{ "`doc` must be tomotopy.Document type or list of tomotopy.Document" };
 				auto* doc = (DocumentObject*)item.get();
 				if (doc->corpus->tm != self) throw py::ValueError{ "`doc` was from another model, not fit to this model" };
-				docs.emplace_back((tomoto::DocumentBase*)doc->doc);
-				docObjs.emplace_back(doc);
+				docs.emplace_back((tomoto::DocumentBase*)doc->getBoundDoc());
 			}
 			if (PyErr_Occurred()) throw py::ExcPropagation{};
-			auto ll = self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together);
-			
-			for (auto doc : docObjs) doc->initialized = true;
-
-			PyObject* ret = PyList_New(docs.size());
-			size_t i = 0;
-			for (auto d : docs)
-			{
-				PyList_SetItem(ret, i++, py::buildPyValue(self->inst->getTopicsByDoc(d)));
-			}
-			if (together)
-			{
-				return Py_BuildValue("(Nf)", ret, ll[0]);
-			}
-			else
-			{
-				return Py_BuildValue("(NN)", ret, py::buildPyValue(ll));
-			}
 		}
 		else
 		{
 			throw py::ValueError{ "`doc` must be tomotopy.Document type or list of tomotopy.Document" };
 		}
+
+		std::vector<double> ll;
+		{
+			InferringScope inferring{ self };
+			py::GILReleaser nogil;
+			ll = self->inst->estimateHeldOutLL(docs, (tomoto::HeldOutEstimator)method, particles, workers, seed);
+		}
+		if (single) return py::buildPyValue(ll[0]);
+		return py::buildPyValue(ll);
 	});
 }
 
+static PyObject* LDA_makeInferenceSession(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	size_t workers = 0, ps = 0;
+	static const char* kwlist[] = { "workers", "parallel", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", (char**)kwlist, &workers, &ps)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		if (!self->isPrepared) throw py::RuntimeError{ "cannot infer with untrained model" };
+		py::UniqueObj ret{ PyObject_CallObject((PyObject*)&InferenceSession_type, nullptr) };
+		if (!ret) throw py::ExcPropagation{};
+		auto* sess = (InferenceSessionObject*)ret.get();
+		sess->inst = self->inst->makeInferenceSession(workers, (tomoto::ParallelScheme)ps).release();
+		sess->tm = self;
+		Py_INCREF(self);
+		return ret.release();
+	});
+}
+
+void InferenceSessionObject::dealloc(InferenceSessionObject* self)
+{
+	delete self->inst;
+	Py_XDECREF(self->tm);
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* InferenceSession_infer(InferenceSessionObject* self, PyObject* args, PyObject *kwargs)
+{
+	PyObject *argDoc, *argTransform = nullptr;
+	size_t iteration = 100, together = 0;
+	float tolerance = -1;
+	tomoto::InferenceDeadline deadline;
+	static const char* kwlist[] = { "doc", "iter", "tolerance", "together", "transform", "timeout", "doc_timeout", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nfpOdd", (char**)kwlist, &argDoc, &iteration, &tolerance, &together, &argTransform,
+		&deadline.seconds, &deadline.secondsPerDoc)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (!self->inst || !self->tm) throw py::RuntimeError{ "inst is null" };
+		checkInst(self->tm);
+		vector<uint32_t> iterations;
+		return appendIterations(inferDocs(self->tm, argDoc, argTransform, !!together, [&](const std::vector<tomoto::DocumentBase*>& docs)
+		{
+			return self->inst->infer(docs, iteration, tolerance, !!together, deadline, &iterations);
+		}), argDoc, !!together, deadline, iterations);
+	});
+}
+
+static PyObject* InferenceSession_getWorkers(InferenceSessionObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		return py::buildPyValue(self->inst->getNumWorkers());
+	});
+}
+
+static PyObject* InferenceSession_getParallel(InferenceSessionObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		return py::buildPyValue((size_t)self->inst->getParallelScheme());
+	});
+}
+
+static PyObject* InferenceSession_getModel(InferenceSessionObject* self, void* closure)
+{
+	return py::buildPyValue((PyObject*)self->tm);
+}
+
+static PyMethodDef InferenceSession_methods[] =
+{
+	{ "infer", (PyCFunction)InferenceSession_infer, METH_VARARGS | METH_KEYWORDS, InferenceSession_infer__doc__ },
+	{ nullptr }
+};
+
+static PyGetSetDef InferenceSession_getseters[] = {
+	{ (char*)"workers", (getter)InferenceSession_getWorkers, nullptr, InferenceSession_workers__doc__, nullptr },
+	{ (char*)"parallel", (getter)InferenceSession_getParallel, nullptr, InferenceSession_parallel__doc__, nullptr },
+	{ (char*)"model", (getter)InferenceSession_getModel, nullptr, InferenceSession_model__doc__, nullptr },
+	{ nullptr },
+};
+
+PyTypeObject InferenceSession_type = {
+	PyVarObject_HEAD_INIT(nullptr, 0)
+	"tomotopy.InferenceSession",             /* tp_name */
+	sizeof(InferenceSessionObject), /* tp_basicsize */
+	0,                         /* tp_itemsize */
+	(destructor)InferenceSessionObject::dealloc, /* tp_dealloc */
+	0,                         /* tp_print */
+	0,                         /* tp_getattr */
+	0,                         /* tp_setattr */
+	0,                         /* tp_reserved */
+	0,                         /* tp_repr */
+	0,                         /* tp_as_number */
+	0,                         /* tp_as_sequence */
+	0,                         /* tp_as_mapping */
+	0,                         /* tp_hash  */
+	0,                         /* tp_call */
+	0,                         /* tp_str */
+	0,                         /* tp_getattro */
+	0,                         /* tp_setattro */
+	0,                         /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,        /* tp_flags */
+	InferenceSession___init____doc__,           /* tp_doc */
+	0,                         /* tp_traverse */
+	0,                         /* tp_clear */
+	0,                         /* tp_richcompare */
+	0,                         /* tp_weaklistoffset */
+	0,                         /* tp_iter */
+	0,                         /* tp_iternext */
+	InferenceSession_methods,  /* tp_methods */
+	0,                         /* tp_members */
+	InferenceSession_getseters, /* tp_getset */
+	0,                         /* tp_base */
+	0,                         /* tp_dict */
+	0,                         /* tp_descr_get */
+	0,                         /* tp_descr_set */
+	0,                         /* tp_dictoffset */
+	0,                         /* tp_init */
+	PyType_GenericAlloc,
+	PyType_GenericNew,
+};
+
+// writes the model into `str` in the compressed container using `workers` threads if `compress` is set
+static void saveModel(tomoto::ITopicModel* inst, std::ostream& str, bool full, const vector<uint8_t>* extraData, bool compress, size_t workers)
+{
+	if (!compress)
+	{
+		inst->saveModel(str, full, extraData);
+		return;
+	}
+	tomoto::serializer::ozstream ostr{ str, workers };
+	inst->saveModel(ostr, full, extraData);
+	if (!ostr) throw std::ios_base::failure{ "writing the compressed model is failed" };
+	ostr.close();
+}
+
 static PyObject* LDA_save(TopicModelObject* self, PyObject* args, PyObject *kwargs)
 {
 	const char* filename;
-	size_t full = 1;
-	static const char* kwlist[] = { "filename", "full", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|p", (char**)kwlist, &filename, &full)) return nullptr;
+	size_t full = 1, aligned = 0, compress = 0, workers = 0;
+	static const char* kwlist[] = { "filename", "full", "aligned", "compress", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|pppn", (char**)kwlist, &filename, &full, &aligned, &compress, &workers)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
+		if (aligned && compress) throw py::ValueError{ "`aligned` cannot be used with `compress`, since compressed arrays cannot be used in place" };
 		ofstream str{ filename, ios_base::binary };
 		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		if (aligned) tomoto::serializer::setAlignedSections(str);
 
 		vector<uint8_t> extra_data;
 		{
-			py::UniqueObj pickle{ PyImport_ImportModule("pickle") };
-			PyObject* pickle_dict{ PyModule_GetDict(pickle) };
-			py::UniqueObj args{ Py_BuildValue("(O)", self->initParams) };
-			py::UniqueObj pickled_bytes{ PyObject_CallObject(
-				PyDict_GetItemString(pickle_dict, "dumps"),
-				args
-			) };
-			char* buf;
-			ssize_t bufsize;
-			PyBytes_AsStringAndSize(pickled_bytes, &buf, &bufsize);
-			extra_data.resize(bufsize);
-			memcpy(extra_data.data(), buf, bufsize);
+			py::UniqueObj pickle{ PyImport_ImportModule("pickle") };
+			PyObject* pickle_dict{ PyModule_GetDict(pickle) };
+			py::UniqueObj args{ Py_BuildValue("(O)", self->initParams) };
+			py::UniqueObj pickled_bytes{ PyObject_CallObject(
+				PyDict_GetItemString(pickle_dict, "dumps"),
+				args
+			) };
+			char* buf;
+			ssize_t bufsize;
+			PyBytes_AsStringAndSize(pickled_bytes, &buf, &bufsize);
+			extra_data.resize(bufsize);
+			memcpy(extra_data.data(), buf, bufsize);
+		}
+
+		{
+			InferringScope saving{ self };
+			py::GILReleaser nogil;
+			saveModel(self->inst, str, !!full, &extra_data, !!compress, workers);
+		}
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+static PyObject* LDA_exportInference(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	const char* filename;
+	const char* dtype = "float32";
+	static const char* kwlist[] = { "filename", "dtype", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|s", (char**)kwlist, &filename, &dtype)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		tomoto::InferenceDType dt;
+		if (!strcmp(dtype, "float32")) dt = tomoto::InferenceDType::float32;
+		else if (!strcmp(dtype, "float16")) dt = tomoto::InferenceDType::float16;
+		else if (!strcmp(dtype, "uint16")) dt = tomoto::InferenceDType::uint16;
+		else throw py::ValueError{ std::string("`dtype` must be one of 'float32', 'float16' or 'uint16', but given '") + dtype + std::string("'") };
+
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		ofstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		inst->exportInferenceModel(str, dt);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+static PyObject* LDA_restoreCheckpoint(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	const char* filename;
+	size_t workers = 0;
+	static const char* kwlist[] = { "filename", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|n", (char**)kwlist, &filename, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		checkNotInferring(self, "restore a checkpoint");
+		if ((self->numCountViews || self->numDocViews) && (inst->isSharingArrays() || inst->getNumNewDocs()))
+		{
+			throw py::BufferError{ "cannot restore a checkpoint while views of `topic_word_counts` or of documents exist" };
+		}
+
+		ifstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		size_t numReplayed = 0;
+		bool prepared = false;
+		try
+		{
+			auto unpacked = unpackModel(str);
+			tomoto::serializer::imstream ustr{ unpacked.data(), (std::ptrdiff_t)unpacked.size() };
+			std::istream& in = unpacked.empty() ? (std::istream&)str : ustr;
+
+			BusyScope busy{ self };
+			py::GILReleaser nogil;
+			std::vector<std::vector<char>> deltas;
+			ifstream dstr{ std::string{ filename } + ".delta", ios_base::binary };
+			while (dstr && tomoto::serializer::isCompressed(dstr))
+			{
+				try
+				{
+					deltas.emplace_back(tomoto::serializer::decompress(dstr));
+				}
+				catch (const ios_base::failure&)
+				{
+					// the record being appended when the training stopped
+					break;
+				}
+			}
+
+			inst->setPrepareWorkers(workers);
+			if (!self->isPrepared)
+			{
+				inst->prepare(true, self->minWordCnt, self->minWordDf, self->removeTopWord);
+				prepared = true;
+			}
+			else if (inst->getNumNewDocs())
+			{
+				inst->prepareNewDocs();
+			}
+			numReplayed = inst->restoreCheckpoint(in, deltas);
+		}
+		catch (const tomoto::exc::InvalidArgument& e)
+		{
+			if (prepared) self->isPrepared = true;
+			throw py::ValueError{ e.what() };
 		}
-
-		self->inst->saveModel(str, !!full, &extra_data);
-		Py_INCREF(Py_None);
-		return Py_None;
+		catch (const ios_base::failure& e)
+		{
+			if (prepared) self->isPrepared = true;
+			throw py::OSError{ std::string("'") + filename + "' is not a valid checkpoint: " + e.what() };
+		}
+		catch (...)
+		{
+			if (prepared) self->isPrepared = true;
+			throw;
+		}
+		if (prepared) self->isPrepared = true;
+		return py::buildPyValue(numReplayed);
 	});
 }
 
 static PyObject* LDA_saves(TopicModelObject* self, PyObject* args, PyObject* kwargs)
 {
-	size_t full = 1;
-	static const char* kwlist[] = { "full", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|p", (char**)kwlist, &full)) return nullptr;
+	size_t full = 1, compress = 0, workers = 0;
+	static const char* kwlist[] = { "full", "compress", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ppn", (char**)kwlist, &full, &compress, &workers)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		ostringstream str;
 
 		vector<uint8_t> extra_data;
@@ -324,7 +1220,11 @@ static PyObject* LDA_saves(TopicModelObject* self, PyObject* args, PyObject* kwa
 			memcpy(extra_data.data(), buf, bufsize);
 		}
 
-		self->inst->saveModel(str, !!full, &extra_data);
+		{
+			InferringScope saving{ self };
+			py::GILReleaser nogil;
+			saveModel(self->inst, str, !!full, &extra_data, !!compress, workers);
+		}
 		return PyBytes_FromStringAndSize(str.str().data(), str.str().size());
 	});
 }
@@ -336,7 +1236,7 @@ static PyObject* LDA_update_vocab(TopicModelObject* self, PyObject* args, PyObje
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &objWords)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		self->inst->updateVocab(py::toCpp<vector<string>>(objWords, "`words` must be an iterable of str"));
 		Py_INCREF(Py_None);
 		return Py_None;
@@ -346,7 +1246,7 @@ static CorpusObject* LDA_getDocs(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		py::UniqueObj args{ py::buildPyTuple((PyObject*)self) };
 		auto ret = (CorpusObject*)PyObject_CallObject((PyObject*)&UtilsCorpus_type, args);
 		return ret;
@@ -357,7 +1257,7 @@ static VocabObject* LDA_getVocabs(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* ret = (VocabObject*)PyObject_CallObject((PyObject*)&UtilsVocab_type, nullptr);
 		ret->dep = (PyObject*)self;
 		Py_INCREF(ret->dep);
@@ -371,7 +1271,7 @@ static VocabObject* LDA_getUsedVocabs(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* ret = (VocabObject*)PyObject_CallObject((PyObject*)&UtilsVocab_type, nullptr);
 		ret->dep = (PyObject*)self;
 		Py_INCREF(ret->dep);
@@ -385,7 +1285,7 @@ static PyObject* LDA_getUsedVocabCf(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		return py::buildPyValue(self->inst->getVocabCf().begin(), self->inst->getVocabCf().begin() + self->inst->getV());
 	});
 }
@@ -394,7 +1294,7 @@ static PyObject* LDA_getUsedVocabWeightedCf(TopicModelObject* self, void* closur
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		return py::buildPyValue(self->inst->getVocabWeightedCf());
 	});
 }
@@ -403,27 +1303,155 @@ static PyObject* LDA_getUsedVocabDf(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		return py::buildPyValue(self->inst->getVocabDf().begin(), self->inst->getVocabDf().begin() + self->inst->getV());
 	});
 }
 
+static PyObject* LDA_getTrainStats(TopicModelObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto& stats = self->inst->getTrainingStats();
+		py::UniqueObj tuning{ PyList_New(0) };
+		for (auto& t : stats.tuning)
+		{
+			static const char* trialKeys[] = { "scheme", "workers", "sec_per_iter", "memory" };
+			py::UniqueObj trial{ py::buildPyDict(trialKeys, (size_t)t.scheme, t.workers, t.secPerIter, t.memory) };
+			PyList_Append(tuning, trial);
+		}
+		static const char* keys[] = { "iterations", "elapsed", "sampling", "merging", "global_sampling", "global_level", "distributing", "optimizing",
+			"tokens", "tokens_per_sec", "merge_bytes", "worker_busy", "worker_idle", "scheme", "workers", "tuning" };
+		return py::buildPyDict(keys, stats.iterations, stats.elapsed, stats.sampling, stats.merging, stats.globalSampling, stats.globalLevel, 
+			stats.distributing, stats.optimizing, stats.tokens, stats.getTokensPerSec(), stats.mergeBytes, stats.workerBusy, stats.workerIdle,
+			(size_t)stats.scheme, stats.workers, std::move(tuning));
+	});
+}
+
+static PyObject* LDA_saveTrace(TopicModelObject* self, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		ostringstream json;
+		try
+		{
+			self->inst->writeTrace(json);
+		}
+		catch (const tomoto::exc::InvalidArgument& e)
+		{
+			throw py::RuntimeError{ e.what() };
+		}
+		ofstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		const auto data = json.str();
+		if (!str.write(data.data(), data.size())) throw py::OSError{ std::string("writing '") + filename + "' is failed" };
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+static PyObject* LDA_getMemoryUsage(TopicModelObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		py::UniqueObj ret{ PyDict_New() };
+		for (auto& p : self->inst->getMemoryUsage())
+		{
+			py::UniqueObj v{ py::buildPyValue(p.second) };
+			PyDict_SetItemString(ret, p.first.c_str(), v);
+		}
+		return ret.release();
+	});
+}
+
+static PyObject* LDA_estimateTrainMemory(TopicModelObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t workers = 0, ps = 0;
+	static const char* kwlist[] = { "workers", "parallel", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", (char**)kwlist, &workers, &ps)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		checkNotInferring(self, "prepare the model");
+		uint64_t ret;
+		bool prepared = false;
+		try
+		{
+			BusyScope busy{ self };
+			py::GILReleaser nogil;
+			// the states are allocated by `prepare`, which `train` would call first
+			if (!self->isPrepared)
+			{
+				inst->setPrepareWorkers(workers);
+				inst->prepare(true, self->minWordCnt, self->minWordDf, self->removeTopWord);
+				prepared = true;
+			}
+			ret = inst->estimateTrainingMemory(workers, (tomoto::ParallelScheme)ps);
+		}
+		catch (...)
+		{
+			if (prepared) self->isPrepared = true;
+			throw;
+		}
+		if (prepared) self->isPrepared = true;
+		return py::buildPyValue(ret);
+	});
+}
+
 static PyObject* LDA_getCountByTopics(TopicModelObject* self)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 
 		return py::buildPyValue(inst->getCountByTopic());
 	});
 }
 
+static PyObject* LDA_exportAssignments(TopicModelObject* self)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = self->inst;
+		const size_t numDocs = inst->getNumDocs();
+		npy_intp numOffsets = numDocs + 1;
+		py::UniqueObj offsets{ PyArray_EMPTY(1, &numOffsets, NPY_INT64, 0) };
+		auto* off = (int64_t*)PyArray_DATA((PyArrayObject*)offsets.get());
+		off[0] = 0;
+		for (size_t i = 0; i < numDocs; ++i) off[i + 1] = off[i] + inst->getDoc(i)->words.size();
+
+		npy_intp numWords = off[numDocs];
+		py::UniqueObj wordIds{ PyArray_EMPTY(1, &numWords, NPY_UINT32, 0) };
+		py::UniqueObj topicIds{ PyArray_EMPTY(1, &numWords, NPY_INT16, 0) };
+		auto* words = (uint32_t*)PyArray_DATA((PyArrayObject*)wordIds.get());
+		auto* topics = (int16_t*)PyArray_DATA((PyArrayObject*)topicIds.get());
+		{
+			py::GILReleaser nogil;
+			for (size_t i = 0; i < numDocs; ++i)
+			{
+				auto* doc = inst->getDoc(i);
+				fillReorder(doc->words, doc->wOrder, words + off[i], [](tomoto::Vid v) { return v; });
+				if (!Document_fillZ(doc, topics + off[i])) std::fill(topics + off[i], topics + off[i + 1], -1);
+			}
+		}
+		return py::buildPyTuple(std::move(offsets), std::move(wordIds), std::move(topicIds));
+	});
+}
+
 PyObject* LDA_getAlpha(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 		vector<float> ret;
 		for (size_t i = 0; i < inst->getK(); ++i)
@@ -438,7 +1466,7 @@ static PyObject* LDA_getRemovedTopWords(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
 
 		vector<string> ret;
@@ -463,7 +1491,7 @@ static PyObject* LDA_summary(TopicModelObject* self, PyObject* args, PyObject* k
 		&argInitialHP, &argParams, &argTopicWordTopN, &argFile, &argFlush)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 
 		py::UniqueObj mod{ PyImport_ImportModule("tomotopy._summary") };
 		if (!mod) throw py::ExcPropagation{};
@@ -484,7 +1512,9 @@ static PyObject* LDA_copy(TopicModelObject* self)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
+		// `copy` of plain LDA converts the model to share its arrays, which `infer` or `save` on other threads may be reading
+		checkNotInferring(self, "copy the model");
 
 		py::UniqueObj type{ PyObject_Type((PyObject*)self) };
 		py::UniqueObj ret{ PyObject_CallFunctionObjArgs(type, nullptr) };
@@ -515,8 +1545,304 @@ DEFINE_GETTER(tomoto::ILDAModel, LDA, getOptimInterval);
 DEFINE_GETTER(tomoto::ILDAModel, LDA, getBurnInIteration);
 DEFINE_GETTER(tomoto::ILDAModel, LDA, getGlobalStep);
 
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getSamplingMethod);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getDynamicBalancing);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getDocOrder);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getNumaAware);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getTracing);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getAsyncStaleness);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getAsyncRecountInterval);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getPartitionRebalanceInterval);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getHierarchicalGroups);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getPipelinedPartition);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getFreezeInterval);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getCollapseDuplicates);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getDenseVocabSize);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getCompact);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getNewDocSweeps);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getLLSampleDocs);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getIncrementalLL);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getOptimEta);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getReproducible);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getFrozenInference);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getFoldInEM);
+DEFINE_GETTER(tomoto::ILDAModel, LDA, getAutoMemoryLimit);
+
+static PyObject* LDA_getOutOfCoreDir(TopicModelObject* self, void* closure)
+{
+	return py::handleExc([&]() -> PyObject*
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto dir = inst->getOutOfCoreDir();
+		if (dir.empty())
+		{
+			Py_INCREF(Py_None);
+			return Py_None;
+		}
+		return py::buildPyValue(dir);
+	});
+}
+
 DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::ILDAModel, LDA, setOptimInterval);
 DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::ILDAModel, LDA, setBurnInIteration);
+DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::ILDAModel, LDA, setAsyncRecountInterval);
+DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::ILDAModel, LDA, setPartitionRebalanceInterval);
+DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::ILDAModel, LDA, setHierarchicalGroups);
+DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::ILDAModel, LDA, setFreezeInterval);
+
+static int LDA_setSamplingMethod(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyLong_AsLong(val);
+		if (v == -1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		if (v < 0 || v >= (long)tomoto::SamplingMethod::size) throw py::ValueError{ "`sampling_method` must be one of `tomotopy.SamplingMethod`" };
+		checkNotInferring(self, "change `sampling_method`");
+		inst->setSamplingMethod((tomoto::SamplingMethod)v);
+		return 0;
+	});
+}
+
+static int LDA_setDenseVocabSize(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyLong_AsLong(val);
+		if (v == -1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		if (v < 0) throw py::ValueError{ "`dense_vocab_size` must be a non-negative integer" };
+		if (self->numCountViews) throw py::BufferError{ "cannot change `dense_vocab_size` while views of `topic_word_counts` exist" };
+		checkNotInferring(self, "change `dense_vocab_size`");
+		inst->setDenseVocabSize((size_t)v);
+		return 0;
+	});
+}
+
+static int LDA_setNewDocSweeps(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyLong_AsLong(val);
+		if (v == -1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		if (v < 0) throw py::ValueError{ "`new_doc_sweeps` must be a non-negative integer" };
+		inst->setNewDocSweeps((size_t)v);
+		return 0;
+	});
+}
+
+static int LDA_setLLSampleDocs(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyLong_AsLong(val);
+		if (v == -1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		if (v < 0) throw py::ValueError{ "`ll_sample_docs` must be a non-negative integer" };
+		inst->setLLSampleDocs((size_t)v);
+		return 0;
+	});
+}
+
+static int LDA_setFrozenInference(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		checkNotInferring(self, "change `frozen_inference`");
+		inst->setFrozenInference(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setFoldInEM(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		checkNotInferring(self, "change `fold_in_em`");
+		inst->setFoldInEM(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setIncrementalLL(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setIncrementalLL(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setOptimEta(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setOptimEta(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setReproducible(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setReproducible(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setCollapseDuplicates(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setCollapseDuplicates(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setDynamicBalancing(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setDynamicBalancing(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setPipelinedPartition(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setPipelinedPartition(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setAsyncStaleness(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyLong_AsLong(val);
+		if (v == -1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		if (v <= 0) throw py::ValueError{ "`async_staleness` must be a positive integer" };
+		inst->setAsyncStaleness((size_t)v);
+		return 0;
+	});
+}
+
+static int LDA_setAutoMemoryLimit(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyLong_AsUnsignedLongLong(val);
+		if (v == (unsigned long long)-1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		inst->setAutoMemoryLimit((uint64_t)v);
+		return 0;
+	});
+}
+
+static int LDA_setNumaAware(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setNumaAware(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setTracing(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyObject_IsTrue(val);
+		if (v == -1) throw py::ExcPropagation{};
+		inst->setTracing(!!v);
+		return 0;
+	});
+}
+
+static int LDA_setDocOrder(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		auto v = PyLong_AsLong(val);
+		if (v == -1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		if (v < 0 || v >= (long)tomoto::DocOrder::size) throw py::ValueError{ "`doc_order` must be one of `tomotopy.DocOrder`" };
+		inst->setDocOrder((tomoto::DocOrder)v);
+		return 0;
+	});
+}
+
+static int LDA_setOutOfCoreDir(TopicModelObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ILDAModel*>(self->inst);
+		if (val == Py_None)
+		{
+			inst->setOutOfCoreDir({});
+			return 0;
+		}
+		py::UniqueObj path{ PyOS_FSPath(val) };
+		if (!path) throw py::ExcPropagation{};
+		if (!PyUnicode_Check(path.get())) throw py::ValueError{ "`out_of_core_dir` must be `str`, `os.PathLike` or `None`" };
+		std::string dir = PyUnicode_AsUTF8(path.get());
+		if (dir.empty()) throw py::ValueError{ "`out_of_core_dir` must not be empty" };
+		inst->setOutOfCoreDir(dir);
+		return 0;
+	});
+}
 
 DEFINE_LOADER(LDA, LDA_type);
 
@@ -639,6 +1965,15 @@ PyObject* Document_LDA_Z(DocumentObject* self, void* closure)
 	});
 }
 
+bool Document_LDA_fillZ(const tomoto::DocumentBase* doc, int16_t* out)
+{
+	return docVisit<tomoto::DocumentLDA>(doc, [&](auto* doc)
+	{
+		fillReorder(doc->Zs, doc->wOrder, out, [](tomoto::Tid x) -> int16_t { return x; });
+		return true;
+	});
+}
+
 PyObject* Document_getCountVector(DocumentObject* self)
 {
 	return py::handleExc([&]()
@@ -665,16 +2000,30 @@ static PyMethodDef LDA_methods[] =
 {
 	{ "add_doc", (PyCFunction)LDA_addDoc, METH_VARARGS | METH_KEYWORDS, LDA_add_doc__doc__ },
 	{ "add_corpus", (PyCFunction)LDA_addCorpus, METH_VARARGS | METH_KEYWORDS, LDA_add_corpus__doc__ },
+	{ "add_token_arrays", (PyCFunction)LDA_addTokenArrays, METH_VARARGS | METH_KEYWORDS, LDA_add_token_arrays__doc__ },
 	{ "make_doc", (PyCFunction)LDA_makeDoc, METH_VARARGS | METH_KEYWORDS, LDA_make_doc__doc__},
 	{ "set_word_prior", (PyCFunction)LDA_setWordPrior, METH_VARARGS | METH_KEYWORDS, LDA_set_word_prior__doc__},
 	{ "get_word_prior", (PyCFunction)LDA_getWordPrior, METH_VARARGS | METH_KEYWORDS, LDA_get_word_prior__doc__},
+	{ "set_warm_start", (PyCFunction)LDA_setWarmStart, METH_VARARGS | METH_KEYWORDS, LDA_set_warm_start__doc__},
+	{ "set_distributed_sync", (PyCFunction)LDA_setDistributedSync, METH_VARARGS | METH_KEYWORDS, LDA_set_distributed_sync__doc__},
 	{ "train", (PyCFunction)LDA_train, METH_VARARGS | METH_KEYWORDS, LDA_train__doc__},
+	{ "estimate_train_memory", (PyCFunction)LDA_estimateTrainMemory, METH_VARARGS | METH_KEYWORDS, LDA_estimate_train_memory__doc__},
 	{ "get_count_by_topics", (PyCFunction)LDA_getCountByTopics, METH_NOARGS, LDA_get_count_by_topics__doc__},
+	{ "export_assignments", (PyCFunction)LDA_exportAssignments, METH_NOARGS, LDA_export_assignments__doc__},
 	{ "get_topic_words", (PyCFunction)LDA_getTopicWords, METH_VARARGS | METH_KEYWORDS, LDA_get_topic_words__doc__},
 	{ "get_topic_word_dist", (PyCFunction)LDA_getTopicWordDist, METH_VARARGS | METH_KEYWORDS, LDA_get_topic_word_dist__doc__ },
+	{ "get_topic_word_dists", (PyCFunction)LDA_getTopicWordDists, METH_VARARGS | METH_KEYWORDS, LDA_get_topic_word_dists__doc__ },
+	{ "get_doc_topic_dists", (PyCFunction)LDA_getDocTopicDists, METH_VARARGS | METH_KEYWORDS, LDA_get_doc_topic_dists__doc__ },
+	{ "get_all_topic_words", (PyCFunction)LDA_getAllTopicWords, METH_VARARGS | METH_KEYWORDS, LDA_get_all_topic_words__doc__ },
 	{ "infer", (PyCFunction)LDA_infer, METH_VARARGS | METH_KEYWORDS, LDA_infer__doc__ },
+	{ "infer_matrix", (PyCFunction)LDA_inferMatrix, METH_VARARGS | METH_KEYWORDS, LDA_infer_matrix__doc__ },
+	{ "estimate_held_out_ll", (PyCFunction)LDA_estimateHeldOutLL, METH_VARARGS | METH_KEYWORDS, LDA_estimate_held_out_ll__doc__ },
+	{ "make_inference_session", (PyCFunction)LDA_makeInferenceSession, METH_VARARGS | METH_KEYWORDS, LDA_make_inference_session__doc__ },
 	{ "save", (PyCFunction)LDA_save, METH_VARARGS | METH_KEYWORDS, LDA_save__doc__},
 	{ "saves", (PyCFunction)LDA_saves, METH_VARARGS | METH_KEYWORDS, LDA_saves__doc__},
+	{ "export_inference", (PyCFunction)LDA_exportInference, METH_VARARGS | METH_KEYWORDS, LDA_export_inference__doc__},
+	{ "restore_checkpoint", (PyCFunction)LDA_restoreCheckpoint, METH_VARARGS | METH_KEYWORDS, LDA_restore_checkpoint__doc__},
+	{ "save_trace", (PyCFunction)LDA_saveTrace, METH_VARARGS | METH_KEYWORDS, LDA_save_trace__doc__},
 	{ "load", (PyCFunction)LDA_load, METH_STATIC | METH_VARARGS | METH_KEYWORDS, LDA_load__doc__},
 	{ "loads", (PyCFunction)LDA_loads, METH_STATIC | METH_VARARGS | METH_KEYWORDS, LDA_loads__doc__},
 	{ "copy", (PyCFunction)LDA_copy, METH_NOARGS, LDA_copy__doc__},
@@ -696,7 +2045,31 @@ static PyGetSetDef LDA_getseters[] = {
 	{ (char*)"vocab_freq", (getter)LDA_getVocabCf, nullptr, LDA_vocab_freq__doc__, nullptr },
 	{ (char*)"num_words", (getter)LDA_getN, nullptr, LDA_num_words__doc__, nullptr },
 	{ (char*)"optim_interval", (getter)LDA_getOptimInterval, (setter)LDA_setOptimInterval, LDA_optim_interval__doc__, nullptr },
+	{ (char*)"optim_eta", (getter)LDA_getOptimEta, (setter)LDA_setOptimEta, LDA_optim_eta__doc__, nullptr },
+	{ (char*)"reproducible", (getter)LDA_getReproducible, (setter)LDA_setReproducible, LDA_reproducible__doc__, nullptr },
 	{ (char*)"burn_in", (getter)LDA_getBurnInIteration, (setter)LDA_setBurnInIteration, LDA_burn_in__doc__, nullptr },
+	{ (char*)"sampling_method", (getter)LDA_getSamplingMethod, (setter)LDA_setSamplingMethod, LDA_sampling_method__doc__, nullptr },
+	{ (char*)"dynamic_balancing", (getter)LDA_getDynamicBalancing, (setter)LDA_setDynamicBalancing, LDA_dynamic_balancing__doc__, nullptr },
+	{ (char*)"doc_order", (getter)LDA_getDocOrder, (setter)LDA_setDocOrder, LDA_doc_order__doc__, nullptr },
+	{ (char*)"numa_aware", (getter)LDA_getNumaAware, (setter)LDA_setNumaAware, LDA_numa_aware__doc__, nullptr },
+	{ (char*)"tracing", (getter)LDA_getTracing, (setter)LDA_setTracing, LDA_tracing__doc__, nullptr },
+	{ (char*)"auto_memory_limit", (getter)LDA_getAutoMemoryLimit, (setter)LDA_setAutoMemoryLimit, LDA_auto_memory_limit__doc__, nullptr },
+	{ (char*)"async_staleness", (getter)LDA_getAsyncStaleness, (setter)LDA_setAsyncStaleness, LDA_async_staleness__doc__, nullptr },
+	{ (char*)"async_recount_interval", (getter)LDA_getAsyncRecountInterval, (setter)LDA_setAsyncRecountInterval, LDA_async_recount_interval__doc__, nullptr },
+	{ (char*)"hierarchical_groups", (getter)LDA_getHierarchicalGroups, (setter)LDA_setHierarchicalGroups, LDA_hierarchical_groups__doc__, nullptr },
+	{ (char*)"pipelined_partition", (getter)LDA_getPipelinedPartition, (setter)LDA_setPipelinedPartition, LDA_pipelined_partition__doc__, nullptr },
+	{ (char*)"partition_rebalance_interval", (getter)LDA_getPartitionRebalanceInterval, (setter)LDA_setPartitionRebalanceInterval, LDA_partition_rebalance_interval__doc__, nullptr },
+	{ (char*)"freeze_interval", (getter)LDA_getFreezeInterval, (setter)LDA_setFreezeInterval, LDA_freeze_interval__doc__, nullptr },
+	{ (char*)"collapse_duplicates", (getter)LDA_getCollapseDuplicates, (setter)LDA_setCollapseDuplicates, LDA_collapse_duplicates__doc__, nullptr },
+	{ (char*)"dense_vocab_size", (getter)LDA_getDenseVocabSize, (setter)LDA_setDenseVocabSize, LDA_dense_vocab_size__doc__, nullptr },
+	{ (char*)"compact", (getter)LDA_getCompact, nullptr, LDA_compact__doc__, nullptr },
+	{ (char*)"out_of_core_dir", (getter)LDA_getOutOfCoreDir, (setter)LDA_setOutOfCoreDir, LDA_out_of_core_dir__doc__, nullptr },
+	{ (char*)"new_doc_sweeps", (getter)LDA_getNewDocSweeps, (setter)LDA_setNewDocSweeps, LDA_new_doc_sweeps__doc__, nullptr },
+	{ (char*)"ll_sample_docs", (getter)LDA_getLLSampleDocs, (setter)LDA_setLLSampleDocs, LDA_ll_sample_docs__doc__, nullptr },
+	{ (char*)"incremental_ll", (getter)LDA_getIncrementalLL, (setter)LDA_setIncrementalLL, LDA_incremental_ll__doc__, nullptr },
+	{ (char*)"frozen_inference", (getter)LDA_getFrozenInference, (setter)LDA_setFrozenInference, LDA_frozen_inference__doc__, nullptr },
+	{ (char*)"fold_in_em", (getter)LDA_getFoldInEM, (setter)LDA_setFoldInEM, LDA_fold_in_em__doc__, nullptr },
+	{ (char*)"topic_word_counts", (getter)LDA_getTopicWordCounts, nullptr, LDA_topic_word_counts__doc__, nullptr },
 	{ (char*)"removed_top_words", (getter)LDA_getRemovedTopWords, nullptr, LDA_removed_top_words__doc__, nullptr },
 	{ (char*)"used_vocabs", (getter)LDA_getUsedVocabs, nullptr, LDA_used_vocabs__doc__, nullptr },
 	{ (char*)"used_vocab_freq", (getter)LDA_getUsedVocabCf, nullptr, LDA_used_vocab_freq__doc__, nullptr },
@@ -704,6 +2077,8 @@ static PyGetSetDef LDA_getseters[] = {
 	{ (char*)"vocab_df", (getter)LDA_getVocabDf, nullptr, LDA_vocab_df__doc__, nullptr },
 	{ (char*)"used_vocab_df", (getter)LDA_getUsedVocabDf, nullptr, LDA_used_vocab_df__doc__, nullptr },
 	{ (char*)"global_step", (getter)LDA_getGlobalStep, nullptr, LDA_global_step__doc__, nullptr },
+	{ (char*)"train_stats", (getter)LDA_getTrainStats, nullptr, LDA_train_stats__doc__, nullptr },
+	{ (char*)"memory_usage", (getter)LDA_getMemoryUsage, nullptr, LDA_memory_usage__doc__, nullptr },
 	{ (char*)"_init_params", (getter)LDA_getInitParams, nullptr, "", nullptr },
 	{ nullptr },
 };
@@ -50,7 +50,7 @@ static PyObject* PA_getSubTopicDist(TopicModelObject* self, PyObject* args, PyOb
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|p", (char**)kwlist, &topicId, &normalize)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IPAModel*>(self->inst);
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < k1" };
 
@@ -65,7 +65,7 @@ static PyObject* PA_getSubTopics(TopicModelObject* self, PyObject* args, PyObjec
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", (char**)kwlist, &topicId, &topN)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IPAModel*>(self->inst);
 		if (topicId >= inst->getK()) throw py::ValueError{ "must topic_id < k1" };
 
@@ -80,7 +80,7 @@ static PyObject* PA_getTopicWords(TopicModelObject* self, PyObject* args, PyObje
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", (char**)kwlist, &topicId, &topN)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IPAModel*>(self->inst);
 		if (topicId >= inst->getK2()) throw py::ValueError{ "must topic_id < k2" };
 
@@ -95,7 +95,7 @@ static PyObject* PA_getTopicWordDist(TopicModelObject* self, PyObject* args, PyO
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|p", (char**)kwlist, &topicId, &normalize)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IPAModel*>(self->inst);
 		if (topicId >= inst->getK2()) throw py::ValueError{ "must topic_id < k2" };
 
@@ -144,7 +144,7 @@ static PyObject* PA_infer(TopicModelObject* self, PyObject* args, PyObject *kwar
 	DEBUG_LOG("infer " << self->ob_base.ob_type << ", " << self->ob_base.ob_refcnt);
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		if (!self->isPrepared) throw py::RuntimeError{ "cannot infer with untrained model" };
 		auto inst = static_cast<tomoto::IPAModel*>(self->inst);
 		py::UniqueObj iter;
@@ -153,7 +153,11 @@ static PyObject* PA_infer(TopicModelObject* self, PyObject* args, PyObject *kwar
 			CorpusObject* cps = makeCorpus(self, argDoc, argTransform);
 			std::vector<tomoto::DocumentBase*> docs;
 			for (auto& d : cps->docsMade) docs.emplace_back(d.get());
-			auto ll = self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together);
+			std::vector<double> ll;
+			{
+				py::GILReleaser nogil;
+				ll = self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together);
+			}
 			return py::buildPyTuple(py::UniqueObj{ (PyObject*)cps }, ll);
 		}
 		else if (PyObject_TypeCheck(argDoc, &UtilsDocument_type))
@@ -164,7 +168,11 @@ static PyObject* PA_infer(TopicModelObject* self, PyObject* args, PyObject *kwar
 			{
 				std::vector<tomoto::DocumentBase*> docs;
 				docs.emplace_back((tomoto::DocumentBase*)doc->doc);
-				double ll = self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together)[0];
+				double ll;
+				{
+					py::GILReleaser nogil;
+					ll = self->inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together)[0];
+				}
 				doc->initialized = true;
 				return Py_BuildValue("((NN)f)", py::buildPyValue(inst->getTopicsByDoc(doc->getBoundDoc())),
 					py::buildPyValue(inst->getSubTopicsByDoc(doc->getBoundDoc())), ll);
@@ -190,7 +198,11 @@ static PyObject* PA_infer(TopicModelObject* self, PyObject* args, PyObject *kwar
 			}
 			if (PyErr_Occurred()) throw py::ExcPropagation{};
 			if (!self->isPrepared) throw py::RuntimeError{ "cannot infer with untrained model" };
-			auto ll = inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together);
+			std::vector<double> ll;
+			{
+				py::GILReleaser nogil;
+				ll = inst->infer(docs, iteration, tolerance, workers, (tomoto::ParallelScheme)ps, !!together);
+			}
 
 			for (auto doc : docObjs) doc->initialized = true;
 
@@ -223,7 +235,7 @@ static PyObject* PA_getCountBySuperTopic(TopicModelObject* self)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IPAModel*>(self->inst);
 
 		return py::buildPyValue(inst->getCountBySuperTopic());
@@ -251,7 +263,7 @@ static PyObject* PA_getSubalpha(TopicModelObject* self, void* closure)
 {
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::IPAModel*>(self->inst);
 		npy_intp shapes[2] = { (npy_intp)inst->getK(), (npy_intp)inst->getK2() };
 		PyObject* ret = PyArray_EMPTY(2, shapes, NPY_FLOAT, 0);
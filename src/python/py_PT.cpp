@@ -42,6 +42,8 @@ static int PT_init(TopicModelObject *self, PyObject *args, PyObject *kwargs)
 }
 
 DEFINE_GETTER(tomoto::IPTModel, PT, getP);
+DEFINE_GETTER(tomoto::IPTModel, PT, getPseudoDocMHSteps);
+DEFINE_SETTER_NON_NEGATIVE_INT(tomoto::IPTModel, PT, setPseudoDocMHSteps);
 
 DEFINE_LOADER(PT, PT_type);
 
@@ -55,6 +57,7 @@ static PyMethodDef PT_methods[] =
 
 static PyGetSetDef PT_getseters[] = {
 	{ (char*)"p", (getter)PT_getP, nullptr, PT_p__doc__, nullptr },
+	{ (char*)"pseudo_doc_mh_steps", (getter)PT_getPseudoDocMHSteps, (setter)PT_setPseudoDocMHSteps, PT_pseudo_doc_mh_steps__doc__, nullptr },
 	{ nullptr },
 };
 
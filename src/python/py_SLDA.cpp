@@ -112,7 +112,7 @@ static PyObject* SLDA_addDoc(TopicModelObject* self, PyObject* args, PyObject *k
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", (char**)kwlist, &argWords, &argY)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		if (self->isPrepared) throw py::RuntimeError{ "cannot add_doc() after train()" };
 		auto* inst = static_cast<tomoto::ISLDAModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
@@ -137,7 +137,7 @@ static DocumentObject* SLDA_makeDoc(TopicModelObject* self, PyObject* args, PyOb
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", (char**)kwlist, &argWords, &argY)) return nullptr;
 	return py::handleExc([&]() -> DocumentObject*
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ISLDAModel*>(self->inst);
 		if (PyUnicode_Check(argWords))
 		{
@@ -165,7 +165,7 @@ static PyObject* SLDA_getRegressionCoef(TopicModelObject* self, PyObject* args,
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", (char**)kwlist, &argVarId)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ISLDAModel*>(self->inst);
 		if (!argVarId || argVarId == Py_None)
 		{
@@ -192,7 +192,7 @@ static PyObject* SLDA_getTypeOfVar(TopicModelObject* self, PyObject* args, PyObj
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &varId)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ISLDAModel*>(self->inst);
 		if (varId >= inst->getF()) throw py::ValueError{ "`var_id` must be < `f`" };
 		return py::buildPyValue(std::string{ "l\0b" + (size_t)inst->getTypeOfVar(varId) * 2 });
@@ -206,7 +206,7 @@ static PyObject* SLDA_estimateVars(TopicModelObject* self, PyObject* args, PyObj
 	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &argDoc)) return nullptr;
 	return py::handleExc([&]()
 	{
-		if (!self->inst) throw py::RuntimeError{ "inst is null" };
+		checkInst(self);
 		auto* inst = static_cast<tomoto::ISLDAModel*>(self->inst);
 		try
 		{
@@ -239,6 +239,54 @@ static PyObject* SLDA_estimateVars(TopicModelObject* self, PyObject* args, PyObj
 	});
 }
 
+static PyObject* SLDA_estimateBatch(TopicModelObject* self, PyObject* args, PyObject *kwargs)
+{
+	PyObject* argDoc;
+	size_t workers = 0;
+	static const char* kwlist[] = { "doc", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", (char**)kwlist, &argDoc, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		checkInst(self);
+		auto* inst = static_cast<tomoto::ISLDAModel*>(self->inst);
+		std::vector<const tomoto::DocumentBase*> docs;
+		if (PyObject_TypeCheck(argDoc, &UtilsCorpus_type))
+		{
+			auto* cps = (CorpusObject*)argDoc;
+			if (!cps->made || cps->tm != self) throw py::ValueError{ "`doc` must be a corpus returned by `infer` of this model" };
+			for (auto& d : cps->docsMade) docs.emplace_back(d.get());
+		}
+		else
+		{
+			py::UniqueObj iter{ PyObject_GetIter(argDoc) };
+			if (!iter) throw py::ValueError{ "`doc` must be an iterable of tomotopy.Document or tomotopy.utils.Corpus" };
+			py::UniqueObj nextDoc;
+			while ((nextDoc = py::UniqueObj{ PyIter_Next(iter) }))
+			{
+				if (!PyObject_TypeCheck(nextDoc, &UtilsDocument_type)) throw py::ValueError{ "`doc` must be an iterable of tomotopy.Document or tomotopy.utils.Corpus" };
+				auto* doc = (DocumentObject*)nextDoc.get();
+				if (doc->corpus->tm != self) throw py::ValueError{ "`doc` was from another model, not fit to this model" };
+				docs.emplace_back(doc->getBoundDoc());
+			}
+			if (PyErr_Occurred()) throw py::ExcPropagation{};
+		}
+
+		py::UniqueObj ret;
+		tomoto::MatrixAllocator alloc = [&](size_t rows, size_t cols)
+		{
+			py::GILAcquirer gil;
+			npy_intp shapes[2] = { (npy_intp)rows, (npy_intp)cols };
+			ret = py::UniqueObj{ PyArray_EMPTY(2, shapes, NPY_FLOAT, 0) };
+			if (!ret) throw py::ExcPropagation{};
+			return (float*)PyArray_DATA((PyArrayObject*)ret.get());
+		};
+		{
+			py::GILReleaser nogil;
+			inst->estimateVarsByDocs(docs, alloc, workers);
+		}
+		return ret.release();
+	});
+}
 
 DEFINE_GETTER(tomoto::ISLDAModel, SLDA, getF);
 
@@ -256,6 +304,7 @@ static PyMethodDef SLDA_methods[] =
 	{ "get_regression_coef", (PyCFunction)SLDA_getRegressionCoef, METH_VARARGS | METH_KEYWORDS, SLDA_get_regression_coef__doc__},
 	{ "get_var_type", (PyCFunction)SLDA_getTypeOfVar, METH_VARARGS | METH_KEYWORDS, SLDA_get_var_type__doc__},
 	{ "estimate", (PyCFunction)SLDA_estimateVars, METH_VARARGS | METH_KEYWORDS, SLDA_estimate__doc__},
+	{ "estimate_batch", (PyCFunction)SLDA_estimateBatch, METH_VARARGS | METH_KEYWORDS, SLDA_estimate_batch__doc__},
 	{ nullptr }
 };
 
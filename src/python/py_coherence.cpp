@@ -9,50 +9,103 @@ int CoherenceObject::init(CoherenceObject* self, PyObject* args, PyObject* kwarg
 	new (&self->model) tomoto::coherence::CoherenceModel;
 	new (&self->cm) tomoto::coherence::AnyConfirmMeasurer;
 
-	CorpusObject* corpus;
+	PyObject* corpusObj;
 	PyObject* targets = nullptr;
+	PyObject* index = nullptr;
 	size_t windowSize = 0;
 	double eps = 1e-12;
 	double gamma = 1;
+	size_t numWorkers = 1;
+	size_t topN = 10;
 	ProbEstimation pe = ProbEstimation::none;
 	Segmentation seg = Segmentation::none;
 	ConfirmMeasure cm = ConfirmMeasure::none;
 	IndirectMeasure im = IndirectMeasure::none;
-	static const char* kwlist[] = { "corpus", "pe", "seg", "cm", "im", "window_size", "eps", "gamma", "targets", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|iiiinddO", (char**)kwlist,
-		&corpus, &pe, &seg, &cm, &im, &windowSize, &eps, &gamma, &targets)) return -1;
+	static const char* kwlist[] = { "corpus", "pe", "seg", "cm", "im", "window_size", "eps", "gamma", "targets", "workers", "index", "top_n", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|iiiinddOnOn", (char**)kwlist,
+		&corpusObj, &pe, &seg, &cm, &im, &windowSize, &eps, &gamma, &targets, &numWorkers, &index, &topN)) return -1;
 	return py::handleExc([&]()
 	{
-		if (!PyObject_TypeCheck(corpus, &UtilsCorpus_type))
+		// documents of a topic model are counted straight from the model, and `corpus` is only its view used to look up words
+		const tomoto::ITopicModel* tm = nullptr;
+		py::UniqueObj corpusHolder;
+		if (PyObject_TypeCheck(corpusObj, &LDA_type))
 		{
-			throw py::ValueError{ "`corpus` must be an instance of `tomotopy.utils.Corpus`." };
+			tm = ((TopicModelObject*)corpusObj)->inst;
+			if (!tm) throw py::RuntimeError{ "inst is null" };
+			corpusHolder = py::UniqueObj{ PyObject_CallObject((PyObject*)&UtilsCorpus_type, py::UniqueObj{ py::buildPyTuple(corpusObj) }) };
+			if (!corpusHolder) throw py::ExcPropagation{};
 		}
-		self->model.~CoherenceModel();
-		new (&self->model) tomoto::coherence::CoherenceModel{ pe, windowSize };
+		else if (PyObject_TypeCheck(corpusObj, &UtilsCorpus_type))
+		{
+			Py_INCREF(corpusObj);
+			corpusHolder = py::UniqueObj{ corpusObj };
+		}
+		else
+		{
+			throw py::ValueError{ "`corpus` must be an instance of `tomotopy.utils.Corpus` or `tomotopy.LDAModel`." };
+		}
+		auto* corpus = (CorpusObject*)corpusHolder.get();
+		if (index == Py_None) index = nullptr;
+		if (index && !PyObject_TypeCheck(index, &CoherenceIndex_type))
+		{
+			throw py::ValueError{ "`index` must be an instance of `tomotopy.coherence.CoherenceIndex`." };
+		}
+		auto* indexObj = (CoherenceIndexObject*)index;
+		if (indexObj && indexObj->inst.getIndex().numDocs() != CorpusObject::len(corpus))
+		{
+			throw py::ValueError{ "`index` was not built from `corpus`." };
+		}
+		// postings are only needed for probabilities of word sets, which only a direct measure on `one_set` asks for
+		const bool keepPostings = seg == Segmentation::one_set && im == IndirectMeasure::none;
 
-		self->corpus = corpus;
-		Py_INCREF(corpus);
+		if (!numWorkers) numWorkers = thread::hardware_concurrency();
+		self->corpus = (CorpusObject*)corpusHolder.release();
 
 		vector<tomoto::Vid> targetIds;
-		py::foreach<string>(targets, [&](const string& w)
+		if (tm && (!targets || targets == Py_None))
 		{
-			auto wid = corpus->getVocabDict().toWid(w);
-			if (wid != tomoto::non_vocab_id) targetIds.emplace_back(wid);
-		}, "`targets` must be an iterable of `str`.");
-
-		self->model.insertTargets(targetIds.begin(), targetIds.end());
+			py::GILReleaser nogil;
+			targetIds = tomoto::coherence::CoherenceModel::getTopicTargets(*tm, topN, numWorkers);
+		}
+		else
+		{
+			py::foreach<string>(targets, [&](const string& w)
+			{
+				auto wid = corpus->getVocabDict().toWid(w);
+				if (wid != tomoto::non_vocab_id) targetIds.emplace_back(wid);
+			}, "`targets` must be an iterable of `str`.");
+		}
 
-		for (size_t i = 0; i < CorpusObject::len(corpus); ++i)
+		self->model.~CoherenceModel();
+		if (indexObj)
 		{
-			auto* doc = corpus->getDoc(i);
-			self->model.insertDoc(
-				wordBegin(doc, corpus->isIndependent()),
-				wordEnd(doc, corpus->isIndependent())
-			);
+			new (&self->model) tomoto::coherence::CoherenceModel{ pe,
+				indexObj->inst.getEstimator(pe, windowSize, keepPostings, targetIds.begin(), targetIds.end())
+			};
+		}
+		else
+		{
+			new (&self->model) tomoto::coherence::CoherenceModel{ pe, windowSize, keepPostings };
+			py::GILReleaser nogil;
+			self->model.insertTargets(targetIds.begin(), targetIds.end());
+
+			if (tm) self->model.insertDocs(*tm, numWorkers);
+			else self->model.insertDocs(CorpusObject::len(corpus), [&](size_t i)
+			{
+				auto* doc = corpus->getDoc(i);
+				return make_pair(
+					wordBegin(doc, corpus->isIndependent()),
+					wordEnd(doc, corpus->isIndependent())
+				);
+			}, numWorkers);
 		}
 
 		self->seg = seg;
-		self->cm = tomoto::coherence::AnyConfirmMeasurer::getInstance(cm, im, targetIds.begin(), targetIds.end(), eps, gamma);
+		self->numWorkers = numWorkers;
+		py::GILReleaser nogil;
+		self->cm = tomoto::coherence::AnyConfirmMeasurer::getInstance(cm, im, targetIds.begin(), targetIds.end(), eps, gamma,
+			self->model.getEstimator(), numWorkers);
 		return 0;
 	});
 }
@@ -86,27 +139,48 @@ PyObject* CoherenceObject::getScore(CoherenceObject* self, PyObject* args, PyObj
 			if (wid != tomoto::non_vocab_id) wordIds.emplace_back(wid);
 		}, "`words` must be an iterable of `str`.");
 
-		switch (self->seg)
-		{
-		case Segmentation::one_one:
-			return py::buildPyValue(self->model.template getScore<Segmentation::one_one>(self->cm, wordIds.begin(), wordIds.end()));
-		case Segmentation::one_pre:
-			return py::buildPyValue(self->model.template getScore<Segmentation::one_pre>(self->cm, wordIds.begin(), wordIds.end()));
-		case Segmentation::one_suc:
-			return py::buildPyValue(self->model.template getScore<Segmentation::one_suc>(self->cm, wordIds.begin(), wordIds.end()));
-		case Segmentation::one_all:
-			return py::buildPyValue(self->model.template getScore<Segmentation::one_all>(self->cm, wordIds.begin(), wordIds.end()));
-		case Segmentation::one_set:
-			return py::buildPyValue(self->model.template getScore<Segmentation::one_set>(self->cm, wordIds.begin(), wordIds.end()));
-		default:
-			throw py::ValueError{ "invalid Segmentation `seg`" };
+		double score;
+		{
+			py::GILReleaser nogil;
+			score = self->cm.getScore(self->model.getEstimator(), self->seg, wordIds);
+		}
+		return py::buildPyValue(score);
+	});
+}
+
+PyObject* CoherenceObject::getScores(CoherenceObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* wordsList;
+	static const char* kwlist[] = { "words_list", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist,
+		&wordsList)) return nullptr;
+
+	return py::handleExc([&]()
+	{
+		vector<vector<tomoto::Vid>> wordIds;
+		py::foreach<PyObject*>(wordsList, [&](PyObject* words)
+		{
+			wordIds.emplace_back();
+			py::foreach<string>(words, [&](const string& w)
+			{
+				auto wid = self->corpus->getVocabDict().toWid(w);
+				if (wid != tomoto::non_vocab_id) wordIds.back().emplace_back(wid);
+			}, "`words_list` must be an iterable of iterables of `str`.");
+		}, "`words_list` must be an iterable of iterables of `str`.");
+
+		vector<double> scores;
+		{
+			py::GILReleaser nogil;
+			scores = self->model.getScores(self->cm, self->seg, wordIds, self->numWorkers);
 		}
+		return py::buildPyValue(scores);
 	});
 }
 
 static PyMethodDef Coherence_methods[] =
 {
 	{ "get_score", (PyCFunction)CoherenceObject::getScore, METH_VARARGS | METH_KEYWORDS, "" },
+	{ "_get_scores", (PyCFunction)CoherenceObject::getScores, METH_VARARGS | METH_KEYWORDS, "" },
 	{ nullptr }
 };
 
@@ -157,10 +231,145 @@ PyTypeObject Coherence_type = {
 	PyType_GenericNew,
 };
 
+CoherenceIndexObject* CoherenceIndexObject::_new(PyTypeObject* subtype, PyObject* args, PyObject* kwargs)
+{
+	CoherenceIndexObject* obj = (CoherenceIndexObject*)subtype->tp_alloc(subtype, 0);
+	new (&obj->inst) tomoto::coherence::IndexedEstimators;
+	return obj;
+}
+
+int CoherenceIndexObject::init(CoherenceIndexObject* self, PyObject* args, PyObject* kwargs)
+{
+	CorpusObject* corpus = nullptr;
+	static const char* kwlist[] = { "corpus", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", (char**)kwlist, &corpus)) return -1;
+	return py::handleExc([&]()
+	{
+		// `corpus` may be omitted when the index is restored by `__setstate__`
+		if (!corpus) return 0;
+		if (!PyObject_TypeCheck(corpus, &UtilsCorpus_type))
+		{
+			throw py::ValueError{ "`corpus` must be an instance of `tomotopy.utils.Corpus`." };
+		}
+
+		py::GILReleaser nogil;
+		self->inst.build(CorpusObject::len(corpus), [&](size_t i)
+		{
+			auto* doc = corpus->getDoc(i);
+			return make_pair(
+				wordBegin(doc, corpus->isIndependent()),
+				wordEnd(doc, corpus->isIndependent())
+			);
+		});
+		return 0;
+	});
+}
+
+void CoherenceIndexObject::dealloc(CoherenceIndexObject* self)
+{
+	self->inst.~IndexedEstimators();
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyObject* CoherenceIndexObject::getstate(CoherenceIndexObject* self, PyObject*)
+{
+	return py::handleExc([&]()
+	{
+		ostringstream str;
+		self->inst.serializerWrite(str);
+		return PyBytes_FromStringAndSize(str.str().data(), str.str().size());
+	});
+}
+
+PyObject* CoherenceIndexObject::setstate(CoherenceIndexObject* self, PyObject* args)
+{
+	Py_buffer data;
+	if (!PyArg_ParseTuple(args, "y*", &data)) return nullptr;
+	return py::handleExc([&]()
+	{
+		tomoto::serializer::imstream str{ (char*)data.buf, data.len };
+		try
+		{
+			self->inst.serializerRead(str);
+		}
+		catch (...)
+		{
+			PyBuffer_Release(&data);
+			throw;
+		}
+		PyBuffer_Release(&data);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* CoherenceIndexObject::getNumDocs(CoherenceIndexObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		return py::buildPyValue(self->inst.getIndex().numDocs());
+	});
+}
+
+static PyMethodDef CoherenceIndex_methods[] =
+{
+	{ "__getstate__", (PyCFunction)CoherenceIndexObject::getstate, METH_NOARGS, "" },
+	{ "__setstate__", (PyCFunction)CoherenceIndexObject::setstate, METH_VARARGS, "" },
+	{ nullptr }
+};
+
+static PyGetSetDef CoherenceIndex_getseters[] = {
+	{ (char*)"num_docs", (getter)CoherenceIndexObject::getNumDocs, nullptr, "", nullptr },
+	{ nullptr }
+};
+
+PyTypeObject CoherenceIndex_type = {
+	PyVarObject_HEAD_INIT(nullptr, 0)
+	"tomotopy._CoherenceIndex",             /* tp_name */
+	sizeof(CoherenceIndexObject), /* tp_basicsize */
+	0,                         /* tp_itemsize */
+	(destructor)CoherenceIndexObject::dealloc, /* tp_dealloc */
+	0,                         /* tp_print */
+	0,                         /* tp_getattr */
+	0,                         /* tp_setattr */
+	0,                         /* tp_reserved */
+	0,                         /* tp_repr */
+	0,                         /* tp_as_number */
+	0,       /* tp_as_sequence */
+	0,                         /* tp_as_mapping */
+	0,                         /* tp_hash  */
+	0,                         /* tp_call */
+	0,                         /* tp_str */
+	0,
+	0,                         /* tp_setattro */
+	0,                         /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,   /* tp_flags */
+	"",           /* tp_doc */
+	0,                         /* tp_traverse */
+	0,                         /* tp_clear */
+	0,                         /* tp_richcompare */
+	0,                         /* tp_weaklistoffset */
+	0,              /* tp_iter */
+	0,                         /* tp_iternext */
+	CoherenceIndex_methods,             /* tp_methods */
+	0,						 /* tp_members */
+	CoherenceIndex_getseters,                         /* tp_getset */
+	0,                         /* tp_base */
+	0,                         /* tp_dict */
+	0,                         /* tp_descr_get */
+	0,                         /* tp_descr_set */
+	0,                         /* tp_dictoffset */
+	(initproc)CoherenceIndexObject::init,      /* tp_init */
+	PyType_GenericAlloc,
+	(newfunc)CoherenceIndexObject::_new,
+};
 
 void addCoherenceTypes(PyObject* gModule)
 {
 	if (PyType_Ready(&Coherence_type) < 0) throw runtime_error{ "Coherence_type is not ready." };
 	Py_INCREF(&Coherence_type);
 	PyModule_AddObject(gModule, "_Coherence", (PyObject*)&Coherence_type);
+	if (PyType_Ready(&CoherenceIndex_type) < 0) throw runtime_error{ "CoherenceIndex_type is not ready." };
+	Py_INCREF(&CoherenceIndex_type);
+	PyModule_AddObject(gModule, "_CoherenceIndex", (PyObject*)&CoherenceIndex_type);
 }
@@ -0,0 +1,333 @@
+#include <random>
+#include "module.h"
+#include "cvb0.h"
+
+using namespace std;
+
+int CVB0LDAObject::init(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	tomoto::CVB0LDAArgs margs;
+	PyObject* argSeed = nullptr;
+	static const char* kwlist[] = { "k", "alpha", "eta", "top_k", "seed", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nffnO", (char**)kwlist,
+		&margs.k, &margs.alpha, &margs.eta, &margs.topK, &argSeed)) return -1;
+	return py::handleExc([&]()
+	{
+		if (argSeed && argSeed != Py_None) margs.seed = py::toCpp<size_t>(argSeed, "`seed` must be an integer.");
+		self->model = tomoto::CVB0LDA{ margs };
+		return 0;
+	});
+}
+
+PyObject* CVB0LDAObject::repr(CVB0LDAObject* self)
+{
+	return py::buildPyValue(tomoto::text::format("<tomotopy.CVB0LDAModel k=%zd, top_k=%zd, num_docs=%zd, global_step=%zd>",
+		self->model.getK(), self->model.getTopK(), self->model.getNumDocs(), (size_t)self->model.getGlobalStep()));
+}
+
+void CVB0LDAObject::dealloc(CVB0LDAObject* self)
+{
+	self->model.~CVB0LDA();
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyObject* CVB0LDAObject::load(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ifstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		py::UniqueObj obj{ PyObject_CallObject((PyObject*)&CVB0LDA_type, nullptr) };
+		if (!obj) throw py::ExcPropagation{};
+		auto* self = (CVB0LDAObject*)obj.get();
+		try
+		{
+			self->model.read(str);
+		}
+		catch (const tomoto::serializer::UnfitException&)
+		{
+			throw py::ValueError{ std::string("'") + filename + std::string("' is not a CVB0 LDA model file") };
+		}
+		catch (const ios_base::failure& e)
+		{
+			throw py::OSError{ e.what() };
+		}
+		return obj.release();
+	});
+}
+
+PyObject* CVB0LDAObject::save(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ofstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		self->model.write(str);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* CVB0LDAObject::addDoc(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argWords;
+	static const char* kwlist[] = { "words", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &argWords)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (PyUnicode_Check(argWords)) throw py::ValueError{ "`words` must be an iterable of `str`." };
+		auto words = py::toCpp<vector<string>>(argWords, "`words` must be an iterable of `str`.");
+		return py::buildPyValue(self->model.addDoc(self->model.toWids(words, true)));
+	});
+}
+
+PyObject* CVB0LDAObject::train(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t iteration = 10, workers = 0;
+	static const char* kwlist[] = { "iter", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", (char**)kwlist, &iteration, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		{
+			py::GILReleaser nogil;
+			self->model.train(iteration, workers);
+		}
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* CVB0LDAObject::infer(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argDoc;
+	size_t iteration = 50, workers = 0;
+	static const char* kwlist[] = { "doc", "iter", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nn", (char**)kwlist,
+		&argDoc, &iteration, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		// `doc` is either a list of words or an iterable of lists of words
+		vector<vector<tomoto::Vid>> docs;
+		bool single = false;
+		py::UniqueObj iter{ PyObject_GetIter(argDoc) }, item;
+		if (!iter) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+		vector<string> words;
+		while ((item = py::UniqueObj{ PyIter_Next(iter) }))
+		{
+			if (PyUnicode_Check(item.get()))
+			{
+				if (!docs.empty()) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+				single = true;
+				words.emplace_back(py::toCpp<string>(item));
+			}
+			else
+			{
+				if (single) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+				docs.emplace_back(self->model.toWids(py::toCpp<vector<string>>(item, "`doc` must be an iterable of `str` or an iterable of iterables of `str`."), false));
+			}
+		}
+		if (PyErr_Occurred()) throw py::ExcPropagation{};
+		if (single) docs.emplace_back(self->model.toWids(words, false));
+
+		vector<vector<tomoto::Float>> dists;
+		vector<double> ll;
+		{
+			py::GILReleaser nogil;
+			dists = self->model.infer(docs, iteration, workers, &ll);
+		}
+
+		if (single) return py::buildPyTuple(dists[0], ll[0]);
+		py::UniqueObj ret{ PyList_New(dists.size()) };
+		for (size_t i = 0; i < dists.size(); ++i)
+		{
+			PyList_SET_ITEM(ret.get(), i, py::buildPyValue(dists[i]));
+		}
+		return py::buildPyTuple(ret.get(), ll);
+	});
+}
+
+PyObject* CVB0LDAObject::getTopicWords(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t topicId, topN = 10;
+	static const char* kwlist[] = { "topic_id", "top_n", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", (char**)kwlist, &topicId, &topN)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (topicId >= self->model.getK()) throw py::ValueError{ "must topic_id < K" };
+		auto dist = self->model.getTopicWordDist(topicId);
+		vector<size_t> order(dist.size());
+		iota(order.begin(), order.end(), 0);
+		topN = min(topN, order.size());
+		partial_sort(order.begin(), order.begin() + topN, order.end(), [&](size_t a, size_t b) { return dist[a] > dist[b]; });
+		vector<pair<string, tomoto::Float>> ret;
+		for (size_t i = 0; i < topN; ++i) ret.emplace_back(self->model.getVocabDict().toWord(order[i]), dist[order[i]]);
+		return py::buildPyValue(ret);
+	});
+}
+
+PyObject* CVB0LDAObject::getTopicWordDist(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t topicId;
+	static const char* kwlist[] = { "topic_id", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &topicId)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (topicId >= self->model.getK()) throw py::ValueError{ "must topic_id < K" };
+		return py::buildPyValue(self->model.getTopicWordDist(topicId));
+	});
+}
+
+PyObject* CVB0LDAObject::getDocTopicDist(CVB0LDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t docId;
+	static const char* kwlist[] = { "doc_id", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &docId)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (docId >= self->model.getNumDocs()) throw py::ValueError{ "must doc_id < num_docs" };
+		return py::buildPyValue(self->model.getDocTopicDist(docId));
+	});
+}
+
+PyObject* CVB0LDAObject::getK(CVB0LDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getK());
+}
+
+PyObject* CVB0LDAObject::getAlpha(CVB0LDAObject* self, void* closure)
+{
+	vector<tomoto::Float> ret(self->model.getK());
+	for (size_t k = 0; k < ret.size(); ++k) ret[k] = self->model.getAlpha(k);
+	return py::buildPyValue(ret);
+}
+
+PyObject* CVB0LDAObject::getEta(CVB0LDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getEta());
+}
+
+PyObject* CVB0LDAObject::getTopK(CVB0LDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getTopK());
+}
+
+PyObject* CVB0LDAObject::getNumDocs(CVB0LDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getNumDocs());
+}
+
+PyObject* CVB0LDAObject::getNumWords(CVB0LDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getN());
+}
+
+PyObject* CVB0LDAObject::getGlobalStep(CVB0LDAObject* self, void* closure)
+{
+	return py::buildPyValue((size_t)self->model.getGlobalStep());
+}
+
+PyObject* CVB0LDAObject::getLLPerWord(CVB0LDAObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		return py::buildPyValue(self->model.getLLPerWord(0));
+	});
+}
+
+PyObject* CVB0LDAObject::getVocabs(CVB0LDAObject* self, void* closure)
+{
+	auto& dict = self->model.getVocabDict();
+	py::UniqueObj ret{ PyList_New(self->model.getV()) };
+	for (size_t i = 0; i < self->model.getV(); ++i)
+	{
+		PyList_SET_ITEM(ret.get(), i, py::buildPyValue(dict.toWord(i)));
+	}
+	return ret.release();
+}
+
+static PyMethodDef CVB0LDA_methods[] =
+{
+	{ "load", (PyCFunction)CVB0LDAObject::load, METH_STATIC | METH_VARARGS | METH_KEYWORDS, CVB0LDA_load__doc__ },
+	{ "save", (PyCFunction)CVB0LDAObject::save, METH_VARARGS | METH_KEYWORDS, CVB0LDA_save__doc__ },
+	{ "add_doc", (PyCFunction)CVB0LDAObject::addDoc, METH_VARARGS | METH_KEYWORDS, CVB0LDA_add_doc__doc__ },
+	{ "train", (PyCFunction)CVB0LDAObject::train, METH_VARARGS | METH_KEYWORDS, CVB0LDA_train__doc__ },
+	{ "infer", (PyCFunction)CVB0LDAObject::infer, METH_VARARGS | METH_KEYWORDS, CVB0LDA_infer__doc__ },
+	{ "get_topic_words", (PyCFunction)CVB0LDAObject::getTopicWords, METH_VARARGS | METH_KEYWORDS, CVB0LDA_get_topic_words__doc__ },
+	{ "get_topic_word_dist", (PyCFunction)CVB0LDAObject::getTopicWordDist, METH_VARARGS | METH_KEYWORDS, CVB0LDA_get_topic_word_dist__doc__ },
+	{ "get_doc_topic_dist", (PyCFunction)CVB0LDAObject::getDocTopicDist, METH_VARARGS | METH_KEYWORDS, CVB0LDA_get_doc_topic_dist__doc__ },
+	{ nullptr }
+};
+
+static PyGetSetDef CVB0LDA_getseters[] = {
+	{ (char*)"k", (getter)CVB0LDAObject::getK, nullptr, CVB0LDA_k__doc__, nullptr },
+	{ (char*)"alpha", (getter)CVB0LDAObject::getAlpha, nullptr, CVB0LDA_alpha__doc__, nullptr },
+	{ (char*)"eta", (getter)CVB0LDAObject::getEta, nullptr, CVB0LDA_eta__doc__, nullptr },
+	{ (char*)"top_k", (getter)CVB0LDAObject::getTopK, nullptr, CVB0LDA_top_k__doc__, nullptr },
+	{ (char*)"num_docs", (getter)CVB0LDAObject::getNumDocs, nullptr, CVB0LDA_num_docs__doc__, nullptr },
+	{ (char*)"num_words", (getter)CVB0LDAObject::getNumWords, nullptr, CVB0LDA_num_words__doc__, nullptr },
+	{ (char*)"global_step", (getter)CVB0LDAObject::getGlobalStep, nullptr, CVB0LDA_global_step__doc__, nullptr },
+	{ (char*)"ll_per_word", (getter)CVB0LDAObject::getLLPerWord, nullptr, CVB0LDA_ll_per_word__doc__, nullptr },
+	{ (char*)"vocabs", (getter)CVB0LDAObject::getVocabs, nullptr, CVB0LDA_vocabs__doc__, nullptr },
+	{ nullptr }
+};
+
+static PyObject* CVB0LDA_new(PyTypeObject* type, PyObject*, PyObject*)
+{
+	auto* self = (CVB0LDAObject*)type->tp_alloc(type, 0);
+	if (self) new (&self->model) tomoto::CVB0LDA;
+	return (PyObject*)self;
+}
+
+PyTypeObject CVB0LDA_type = {
+	PyVarObject_HEAD_INIT(nullptr, 0)
+	"tomotopy.CVB0LDAModel",             /* tp_name */
+	sizeof(CVB0LDAObject), /* tp_basicsize */
+	0,                         /* tp_itemsize */
+	(destructor)CVB0LDAObject::dealloc, /* tp_dealloc */
+	0,                         /* tp_print */
+	0,                         /* tp_getattr */
+	0,                         /* tp_setattr */
+	0,                         /* tp_reserved */
+	(reprfunc)CVB0LDAObject::repr,                         /* tp_repr */
+	0,                         /* tp_as_number */
+	0,       /* tp_as_sequence */
+	0,                         /* tp_as_mapping */
+	0,                         /* tp_hash  */
+	0,                         /* tp_call */
+	0,                         /* tp_str */
+	0,
+	0,                         /* tp_setattro */
+	0,                         /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,   /* tp_flags */
+	CVB0LDA___init____doc__,           /* tp_doc */
+	0,                         /* tp_traverse */
+	0,                         /* tp_clear */
+	0,                         /* tp_richcompare */
+	0,                         /* tp_weaklistoffset */
+	0,              /* tp_iter */
+	0,                         /* tp_iternext */
+	CVB0LDA_methods,             /* tp_methods */
+	0,						 /* tp_members */
+	CVB0LDA_getseters,                         /* tp_getset */
+	0,                         /* tp_base */
+	0,                         /* tp_dict */
+	0,                         /* tp_descr_get */
+	0,                         /* tp_descr_set */
+	0,                         /* tp_dictoffset */
+	(initproc)CVB0LDAObject::init,      /* tp_init */
+	PyType_GenericAlloc,
+	CVB0LDA_new,
+};
+
+void addCVB0Types(PyObject* gModule)
+{
+	if (PyType_Ready(&CVB0LDA_type) < 0) throw runtime_error{ "CVB0LDA_type is not ready." };
+	Py_INCREF(&CVB0LDA_type);
+	PyModule_AddObject(gModule, "CVB0LDAModel", (PyObject*)&CVB0LDA_type);
+}
@@ -0,0 +1,264 @@
+#include <random>
+#include "module.h"
+#include "docindex.h"
+
+using namespace std;
+
+namespace
+{
+	// reads a topic distribution or an iterable of them from `obj` into `out`, and returns whether it is a single one
+	bool readDists(PyObject* obj, size_t k, vector<tomoto::Float>& out, const char* failMsg)
+	{
+		py::UniqueObj iter{ PyObject_GetIter(obj) }, item;
+		if (!iter) throw py::ValueError{ failMsg };
+		bool single = false, first = true;
+		while ((item = py::UniqueObj{ PyIter_Next(iter) }))
+		{
+			if (first) single = !!PyNumber_Check(item.get());
+			first = false;
+			if (single)
+			{
+				out.emplace_back(py::toCpp<tomoto::Float>(item, failMsg));
+				continue;
+			}
+			auto dist = py::toCpp<vector<tomoto::Float>>(item, failMsg);
+			if (dist.size() != k) throw py::ValueError{ "all topic distributions must have the same length as `k` of the index." };
+			out.insert(out.end(), dist.begin(), dist.end());
+		}
+		if (PyErr_Occurred()) throw py::ExcPropagation{};
+		if (single && out.size() != k) throw py::ValueError{ "all topic distributions must have the same length as `k` of the index." };
+		return single;
+	}
+}
+
+int DocIndexObject::init(DocIndexObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argSource, *argSeed = nullptr;
+	tomoto::DocIndexArgs margs;
+	size_t metric = (size_t)margs.metric, workers = 0;
+	static const char* kwlist[] = { "source", "metric", "n_lists", "train_iter", "workers", "seed", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nnnnO", (char**)kwlist,
+		&argSource, &metric, &margs.numLists, &margs.trainIter, &workers, &argSeed)) return -1;
+	return py::handleExc([&]()
+	{
+		if (metric >= (size_t)tomoto::DocMetric::size) throw py::ValueError{ "`metric` must be one of `tomotopy.DocMetric`." };
+		margs.metric = (tomoto::DocMetric)metric;
+		if (argSeed && argSeed != Py_None) margs.seed = py::toCpp<size_t>(argSeed, "`seed` must be an integer.");
+
+		// the distributions of the documents of a topic model are read straight from the model
+		if (PyObject_TypeCheck(argSource, &LDA_type))
+		{
+			auto* tm = ((TopicModelObject*)argSource)->inst;
+			if (!tm) throw py::RuntimeError{ "inst is null" };
+			if (!((TopicModelObject*)argSource)->isPrepared) throw py::RuntimeError{ "train() should be called first" };
+			if (!tm->getNumDocs()) throw py::ValueError{ "`source` has no documents." };
+			const size_t k = tm->getK();
+			py::GILReleaser nogil;
+			self->index = tomoto::DocIndex{ tm->getNumDocs(), k, [&](size_t i, tomoto::Float* out)
+			{
+				auto dist = tm->getTopicsByDoc(tm->getDoc(i), true);
+				copy(dist.begin(), dist.end(), out);
+			}, margs, workers };
+			return 0;
+		}
+
+		const char* failMsg = "`source` must be an instance of `tomotopy.LDAModel` or an iterable of topic distributions.";
+		py::UniqueObj iter{ PyObject_GetIter(argSource) }, item;
+		if (!iter) throw py::ValueError{ failMsg };
+		vector<tomoto::Float> dists;
+		size_t k = 0, n = 0;
+		while ((item = py::UniqueObj{ PyIter_Next(iter) }))
+		{
+			auto dist = py::toCpp<vector<tomoto::Float>>(item, failMsg);
+			if (!n) k = dist.size();
+			if (!k || dist.size() != k) throw py::ValueError{ "all topic distributions of `source` must have the same non-zero length." };
+			dists.insert(dists.end(), dist.begin(), dist.end());
+			++n;
+		}
+		if (PyErr_Occurred()) throw py::ExcPropagation{};
+		if (!n) throw py::ValueError{ "`source` has no documents." };
+		py::GILReleaser nogil;
+		self->index = tomoto::DocIndex{ n, k, [&](size_t i, tomoto::Float* out)
+		{
+			copy(&dists[i * k], &dists[i * k] + k, out);
+		}, margs, workers };
+		return 0;
+	});
+}
+
+PyObject* DocIndexObject::repr(DocIndexObject* self)
+{
+	return py::buildPyValue(tomoto::text::format("<tomotopy.DocIndex metric=%zd, k=%zd, num_docs=%zd, n_lists=%zd>",
+		(size_t)self->index.getMetric(), self->index.getK(), self->index.getNumDocs(), self->index.getNumLists()));
+}
+
+void DocIndexObject::dealloc(DocIndexObject* self)
+{
+	self->index.~DocIndex();
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyObject* DocIndexObject::load(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ifstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		// `source` is required by `__init__`, so the object is only allocated here
+		py::UniqueObj obj{ DocIndex_type.tp_new(&DocIndex_type, nullptr, nullptr) };
+		if (!obj) throw py::ExcPropagation{};
+		auto* self = (DocIndexObject*)obj.get();
+		try
+		{
+			self->index.read(str);
+		}
+		catch (const tomoto::serializer::UnfitException&)
+		{
+			throw py::ValueError{ std::string("'") + filename + std::string("' is not a document index file") };
+		}
+		catch (const ios_base::failure& e)
+		{
+			throw py::OSError{ e.what() };
+		}
+		return obj.release();
+	});
+}
+
+PyObject* DocIndexObject::save(DocIndexObject* self, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ofstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		self->index.write(str);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* DocIndexObject::search(DocIndexObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argQuery;
+	size_t topN = 10, numProbes = 8, workers = 0;
+	static const char* kwlist[] = { "query", "top_n", "n_probe", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nnn", (char**)kwlist, &argQuery, &topN, &numProbes, &workers)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		const size_t k = self->index.getK();
+		if (!k) throw py::RuntimeError{ "the index is empty" };
+		vector<tomoto::Float> queries;
+		const bool single = readDists(argQuery, k, queries, "`query` must be a topic distribution or an iterable of topic distributions.");
+		const size_t numQueries = queries.size() / k;
+
+		vector<int64_t> ids;
+		vector<tomoto::Float> dists;
+		{
+			py::GILReleaser nogil;
+			self->index.search(queries.data(), numQueries, topN, numProbes, workers, ids, dists);
+		}
+
+		npy_intp shapes[2] = { (npy_intp)numQueries, (npy_intp)topN };
+		py::UniqueObj retIds{ single ? PyArray_EMPTY(1, shapes + 1, NPY_INT64, 0) : PyArray_EMPTY(2, shapes, NPY_INT64, 0) };
+		py::UniqueObj retDists{ single ? PyArray_EMPTY(1, shapes + 1, NPY_FLOAT, 0) : PyArray_EMPTY(2, shapes, NPY_FLOAT, 0) };
+		memcpy(PyArray_DATA((PyArrayObject*)retIds.get()), ids.data(), sizeof(int64_t) * ids.size());
+		memcpy(PyArray_DATA((PyArrayObject*)retDists.get()), dists.data(), sizeof(float) * dists.size());
+		return py::buildPyTuple(retIds.get(), retDists.get());
+	});
+}
+
+PyObject* DocIndexObject::getMetric(DocIndexObject* self, void* closure)
+{
+	return py::buildPyValue((size_t)self->index.getMetric());
+}
+
+PyObject* DocIndexObject::getK(DocIndexObject* self, void* closure)
+{
+	return py::buildPyValue(self->index.getK());
+}
+
+PyObject* DocIndexObject::getNumDocs(DocIndexObject* self, void* closure)
+{
+	return py::buildPyValue(self->index.getNumDocs());
+}
+
+PyObject* DocIndexObject::getNumLists(DocIndexObject* self, void* closure)
+{
+	return py::buildPyValue(self->index.getNumLists());
+}
+
+static PyMethodDef DocIndex_methods[] =
+{
+	{ "load", (PyCFunction)DocIndexObject::load, METH_STATIC | METH_VARARGS | METH_KEYWORDS, DocIndex_load__doc__ },
+	{ "save", (PyCFunction)DocIndexObject::save, METH_VARARGS | METH_KEYWORDS, DocIndex_save__doc__ },
+	{ "search", (PyCFunction)DocIndexObject::search, METH_VARARGS | METH_KEYWORDS, DocIndex_search__doc__ },
+	{ nullptr }
+};
+
+static PyGetSetDef DocIndex_getseters[] = {
+	{ (char*)"metric", (getter)DocIndexObject::getMetric, nullptr, DocIndex_metric__doc__, nullptr },
+	{ (char*)"k", (getter)DocIndexObject::getK, nullptr, DocIndex_k__doc__, nullptr },
+	{ (char*)"num_docs", (getter)DocIndexObject::getNumDocs, nullptr, DocIndex_num_docs__doc__, nullptr },
+	{ (char*)"n_lists", (getter)DocIndexObject::getNumLists, nullptr, DocIndex_n_lists__doc__, nullptr },
+	{ nullptr }
+};
+
+static PyObject* DocIndex_new(PyTypeObject* type, PyObject*, PyObject*)
+{
+	auto* self = (DocIndexObject*)type->tp_alloc(type, 0);
+	if (self) new (&self->index) tomoto::DocIndex;
+	return (PyObject*)self;
+}
+
+PyTypeObject DocIndex_type = {
+	PyVarObject_HEAD_INIT(nullptr, 0)
+	"tomotopy.DocIndex",             /* tp_name */
+	sizeof(DocIndexObject), /* tp_basicsize */
+	0,                         /* tp_itemsize */
+	(destructor)DocIndexObject::dealloc, /* tp_dealloc */
+	0,                         /* tp_print */
+	0,                         /* tp_getattr */
+	0,                         /* tp_setattr */
+	0,                         /* tp_reserved */
+	(reprfunc)DocIndexObject::repr,                         /* tp_repr */
+	0,                         /* tp_as_number */
+	0,       /* tp_as_sequence */
+	0,                         /* tp_as_mapping */
+	0,                         /* tp_hash  */
+	0,                         /* tp_call */
+	0,                         /* tp_str */
+	0,
+	0,                         /* tp_setattro */
+	0,                         /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,   /* tp_flags */
+	DocIndex___init____doc__,           /* tp_doc */
+	0,                         /* tp_traverse */
+	0,                         /* tp_clear */
+	0,                         /* tp_richcompare */
+	0,                         /* tp_weaklistoffset */
+	0,              /* tp_iter */
+	0,                         /* tp_iternext */
+	DocIndex_methods,             /* tp_methods */
+	0,						 /* tp_members */
+	DocIndex_getseters,                         /* tp_getset */
+	0,                         /* tp_base */
+	0,                         /* tp_dict */
+	0,                         /* tp_descr_get */
+	0,                         /* tp_descr_set */
+	0,                         /* tp_dictoffset */
+	(initproc)DocIndexObject::init,      /* tp_init */
+	PyType_GenericAlloc,
+	DocIndex_new,
+};
+
+void addDocIndexTypes(PyObject* gModule)
+{
+	if (PyType_Ready(&DocIndex_type) < 0) throw runtime_error{ "DocIndex_type is not ready." };
+	Py_INCREF(&DocIndex_type);
+	PyModule_AddObject(gModule, "DocIndex", (PyObject*)&DocIndex_type);
+}
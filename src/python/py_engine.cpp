@@ -0,0 +1,60 @@
+#ifdef _DEBUG
+#undef _DEBUG
+#include <Python.h>
+#define _DEBUG
+#else
+#include <Python.h>
+#endif
+
+#include "engine.h"
+#include "../TopicModel/GDMR.h"
+#include "../TopicModel/HDP.h"
+#include "../TopicModel/MGLDA.h"
+#include "../TopicModel/HPA.h"
+#include "../TopicModel/CT.h"
+#include "../TopicModel/SLDA.h"
+#include "../TopicModel/HLDA.h"
+#include "../TopicModel/PLDA.h"
+#include "../TopicModel/DT.h"
+#include "../TopicModel/PT.h"
+
+/*
+The entry of an engine, see `engine.h`.
+It is built with `src/TopicModel/<Family>Model.cpp`, and `TOMOTOPY_ENGINE` is defined as the interface of the family, like `IDMRModel`.
+*/
+
+#ifndef TOMOTOPY_ENGINE
+#error "TOMOTOPY_ENGINE should be defined as the interface of the model family."
+#endif
+
+static void adopt(const EngineShared& shared)
+{
+	tomoto::PoolManager::share(*shared.pools);
+	tomoto::HugePages::share(*shared.hugePages);
+	tomoto::serializer::streamFlagIndices() = shared.streamFlags;
+}
+
+PyMODINIT_FUNC MODULE_NAME()
+{
+	static PyModuleDef mod =
+	{
+		PyModuleDef_HEAD_INIT,
+		"tomotopy_engine",
+		"Engine of a model family of tomotopy",
+		-1,
+		nullptr,
+	};
+
+	static EngineLink link{ EngineLink::currentVersion, (void*)&tomoto::TOMOTOPY_ENGINE::create, adopt };
+
+	PyObject* module = PyModule_Create(&mod);
+	if (!module) return nullptr;
+	PyObject* capsule = PyCapsule_New(&link, engineCapsuleName, nullptr);
+	if (!capsule || PyModule_AddObject(module, "_link", capsule) < 0)
+	{
+		Py_XDECREF(capsule);
+		Py_DECREF(module);
+		return nullptr;
+	}
+	return module;
+}
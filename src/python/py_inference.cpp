@@ -0,0 +1,195 @@
+#include <random>
+#include "module.h"
+#include "inference.h"
+
+using namespace std;
+
+static const char* dtypeNames[] = { "float32", "float16", "uint16" };
+
+PyObject* InferenceModelObject::repr(InferenceModelObject* self)
+{
+	return py::buildPyValue(tomoto::text::format("<tomotopy.InferenceModel k=%zd, v=%zd, dtype=%s>",
+		self->model.getK(), self->model.getV(), dtypeNames[(size_t)self->model.getDType()]));
+}
+
+void InferenceModelObject::dealloc(InferenceModelObject* self)
+{
+	self->model.~InferenceModel();
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyObject* InferenceModelObject::load(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ifstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		py::UniqueObj obj{ PyObject_CallObject((PyObject*)&InferenceModel_type, nullptr) };
+		if (!obj) throw py::ExcPropagation{};
+		auto* self = (InferenceModelObject*)obj.get();
+		try
+		{
+			self->model.read(str);
+		}
+		catch (const tomoto::serializer::UnfitException&)
+		{
+			throw py::ValueError{ std::string("'") + filename + std::string("' is not an inference model file") };
+		}
+		catch (const ios_base::failure& e)
+		{
+			throw py::OSError{ e.what() };
+		}
+		return obj.release();
+	});
+}
+
+PyObject* InferenceModelObject::infer(InferenceModelObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argDoc;
+	size_t iteration = 100, workers = 0, seed = random_device{}();
+	PyObject* argSeed = nullptr;
+	static const char* kwlist[] = { "doc", "iter", "workers", "seed", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nnO", (char**)kwlist,
+		&argDoc, &iteration, &workers, &argSeed)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (argSeed && argSeed != Py_None) seed = py::toCpp<size_t>(argSeed, "`seed` must be an integer.");
+
+		// `doc` is either a list of words or an iterable of lists of words
+		vector<vector<tomoto::Vid>> docs;
+		bool single = false;
+		py::UniqueObj iter{ PyObject_GetIter(argDoc) }, item;
+		if (!iter) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+		vector<string> words;
+		while ((item = py::UniqueObj{ PyIter_Next(iter) }))
+		{
+			if (PyUnicode_Check(item.get()))
+			{
+				if (!docs.empty()) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+				single = true;
+				words.emplace_back(py::toCpp<string>(item));
+			}
+			else
+			{
+				if (single) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+				docs.emplace_back(self->model.toWids(py::toCpp<vector<string>>(item, "`doc` must be an iterable of `str` or an iterable of iterables of `str`.")));
+			}
+		}
+		if (PyErr_Occurred()) throw py::ExcPropagation{};
+		if (single) docs.emplace_back(self->model.toWids(words));
+
+		vector<vector<tomoto::Float>> dists;
+		vector<double> ll;
+		{
+			py::GILReleaser nogil;
+			dists = self->model.infer(docs, iteration, workers, seed, &ll);
+		}
+
+		if (single) return py::buildPyTuple(dists[0], ll[0]);
+		py::UniqueObj ret{ PyList_New(dists.size()) };
+		for (size_t i = 0; i < dists.size(); ++i)
+		{
+			PyList_SET_ITEM(ret.get(), i, py::buildPyValue(dists[i]));
+		}
+		return py::buildPyTuple(ret.get(), ll);
+	});
+}
+
+PyObject* InferenceModelObject::getK(InferenceModelObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getK());
+}
+
+PyObject* InferenceModelObject::getVocabs(InferenceModelObject* self, void* closure)
+{
+	auto& dict = self->model.getVocabDict();
+	py::UniqueObj ret{ PyList_New(self->model.getV()) };
+	for (size_t i = 0; i < self->model.getV(); ++i)
+	{
+		PyList_SET_ITEM(ret.get(), i, py::buildPyValue(dict.toWord(i)));
+	}
+	return ret.release();
+}
+
+PyObject* InferenceModelObject::getDType(InferenceModelObject* self, void* closure)
+{
+	return py::buildPyValue(string{ dtypeNames[(size_t)self->model.getDType()] });
+}
+
+PyObject* InferenceModelObject::getTermWeight(InferenceModelObject* self, void* closure)
+{
+	return py::buildPyValue((size_t)self->model.getTermWeight());
+}
+
+static PyMethodDef InferenceModel_methods[] =
+{
+	{ "load", (PyCFunction)InferenceModelObject::load, METH_STATIC | METH_VARARGS | METH_KEYWORDS, InferenceModel_load__doc__ },
+	{ "infer", (PyCFunction)InferenceModelObject::infer, METH_VARARGS | METH_KEYWORDS, InferenceModel_infer__doc__ },
+	{ nullptr }
+};
+
+static PyGetSetDef InferenceModel_getseters[] = {
+	{ (char*)"k", (getter)InferenceModelObject::getK, nullptr, InferenceModel_k__doc__, nullptr },
+	{ (char*)"vocabs", (getter)InferenceModelObject::getVocabs, nullptr, InferenceModel_vocabs__doc__, nullptr },
+	{ (char*)"dtype", (getter)InferenceModelObject::getDType, nullptr, InferenceModel_dtype__doc__, nullptr },
+	{ (char*)"tw", (getter)InferenceModelObject::getTermWeight, nullptr, InferenceModel_tw__doc__, nullptr },
+	{ nullptr }
+};
+
+static PyObject* InferenceModel_new(PyTypeObject* type, PyObject*, PyObject*)
+{
+	auto* self = (InferenceModelObject*)type->tp_alloc(type, 0);
+	if (self) new (&self->model) tomoto::InferenceModel;
+	return (PyObject*)self;
+}
+
+PyTypeObject InferenceModel_type = {
+	PyVarObject_HEAD_INIT(nullptr, 0)
+	"tomotopy.InferenceModel",             /* tp_name */
+	sizeof(InferenceModelObject), /* tp_basicsize */
+	0,                         /* tp_itemsize */
+	(destructor)InferenceModelObject::dealloc, /* tp_dealloc */
+	0,                         /* tp_print */
+	0,                         /* tp_getattr */
+	0,                         /* tp_setattr */
+	0,                         /* tp_reserved */
+	(reprfunc)InferenceModelObject::repr,                         /* tp_repr */
+	0,                         /* tp_as_number */
+	0,       /* tp_as_sequence */
+	0,                         /* tp_as_mapping */
+	0,                         /* tp_hash  */
+	0,                         /* tp_call */
+	0,                         /* tp_str */
+	0,
+	0,                         /* tp_setattro */
+	0,                         /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,   /* tp_flags */
+	InferenceModel___init____doc__,           /* tp_doc */
+	0,                         /* tp_traverse */
+	0,                         /* tp_clear */
+	0,                         /* tp_richcompare */
+	0,                         /* tp_weaklistoffset */
+	0,              /* tp_iter */
+	0,                         /* tp_iternext */
+	InferenceModel_methods,             /* tp_methods */
+	0,						 /* tp_members */
+	InferenceModel_getseters,                         /* tp_getset */
+	0,                         /* tp_base */
+	0,                         /* tp_dict */
+	0,                         /* tp_descr_get */
+	0,                         /* tp_descr_set */
+	0,                         /* tp_dictoffset */
+	0,      /* tp_init */
+	PyType_GenericAlloc,
+	InferenceModel_new,
+};
+
+void addInferenceTypes(PyObject* gModule)
+{
+	if (PyType_Ready(&InferenceModel_type) < 0) throw runtime_error{ "InferenceModel_type is not ready." };
+	Py_INCREF(&InferenceModel_type);
+	PyModule_AddObject(gModule, "InferenceModel", (PyObject*)&InferenceModel_type);
+}
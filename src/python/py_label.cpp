@@ -165,7 +165,11 @@ struct ExtractorObject
 		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &tm)) return nullptr;
 		return py::handleExc([&]()
 		{
-			auto cands = self->inst->extract(tm->inst);
+			std::vector<tomoto::label::Candidate> cands;
+			{
+				py::GILReleaser nogil;
+				cands = self->inst->extract(tm->inst);
+			}
 			PyObject* ret = PyList_New(0);
 			for (auto& c : cands)
 			{
@@ -209,6 +213,22 @@ struct LabelerObject
 		});
 	}
 
+	static PyObject* getAllTopicLabels(LabelerObject* self, PyObject* args, PyObject *kwargs)
+	{
+		size_t topN = 10;
+		static const char* kwlist[] = { "top_n", nullptr };
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", (char**)kwlist, &topN)) return nullptr;
+		return py::handleExc([&]()
+		{
+			std::vector<std::vector<std::pair<std::string, float>>> labels;
+			{
+				py::GILReleaser nogil;
+				labels = self->inst->getAllLabels(self->tm->inst->getK(), topN);
+			}
+			return py::buildPyValue(labels);
+		});
+	}
+
 	static void dealloc(LabelerObject* self)
 	{
 		delete self->inst;
@@ -219,6 +239,7 @@ struct LabelerObject
 static PyMethodDef Labeler_methods[] =
 {
 	{ "get_topic_labels", (PyCFunction)LabelerObject::getTopicLabels, METH_VARARGS | METH_KEYWORDS, Labeler_get_topic_labels__doc__ },
+	{ "get_all_topic_labels", (PyCFunction)LabelerObject::getAllTopicLabels, METH_VARARGS | METH_KEYWORDS, Labeler_get_all_topic_labels__doc__ },
 	{ nullptr }
 };
 
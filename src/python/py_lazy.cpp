@@ -0,0 +1,75 @@
+#ifdef TOMOTOPY_SPLIT_ENGINES
+
+#include "module.h"
+#include "engine.h"
+#include "../TopicModel/GDMR.h"
+#include "../TopicModel/HDP.h"
+#include "../TopicModel/MGLDA.h"
+#include "../TopicModel/HPA.h"
+#include "../TopicModel/CT.h"
+#include "../TopicModel/SLDA.h"
+#include "../TopicModel/HLDA.h"
+#include "../TopicModel/PLDA.h"
+#include "../TopicModel/DT.h"
+#include "../TopicModel/PT.h"
+
+/*
+`I<Family>Model::create` of the main module when the model families are built as engines, see `engine.h`.
+Each of them imports its engine at the first call and forwards the calls to the `create` of the engine.
+They are called only with the GIL held, by the constructors and the loaders of the models.
+*/
+
+using namespace std;
+
+#define TMT_STRINGIFY_(x) #x
+#define TMT_STRINGIFY(x) TMT_STRINGIFY_(x)
+
+namespace
+{
+	template<typename _Fn>
+	_Fn loadEngine(const char* family)
+	{
+		// MODULE_NAME is `PyInit_` followed by the name of this module
+		static const string prefix = string{ TMT_STRINGIFY(MODULE_NAME) }.substr(7) + "_";
+		py::UniqueObj mod{ PyImport_ImportModule((prefix + family).c_str()) };
+		if (!mod) throw py::ExcPropagation{};
+		py::UniqueObj capsule{ PyObject_GetAttrString(mod, "_link") };
+		if (!capsule) throw py::ExcPropagation{};
+		auto* link = (const EngineLink*)PyCapsule_GetPointer(capsule, engineCapsuleName);
+		if (!link) throw py::ExcPropagation{};
+		if (link->version != EngineLink::currentVersion)
+		{
+			throw py::RuntimeError{ "the module `" + prefix + family + "` was built from another version of tomotopy. Please reinstall tomotopy." };
+		}
+		link->adopt(EngineShared{ &tomoto::PoolManager::getInstance(), &tomoto::HugePages::getState(), tomoto::serializer::streamFlagIndices() });
+		return (_Fn)link->create;
+	}
+}
+
+#define DEFINE_ENGINE_CREATE(CLASS, ARGS, FAMILY) \
+tomoto::I##CLASS##Model* tomoto::I##CLASS##Model::create(TermWeight _weight, const ARGS& args, bool scalarRng)\
+{\
+	static auto fn = loadEngine<decltype(&I##CLASS##Model::create)>(FAMILY);\
+	return fn(_weight, args, scalarRng);\
+}
+
+DEFINE_ENGINE_CREATE(DMR, DMRArgs, "dmr");
+DEFINE_ENGINE_CREATE(GDMR, GDMRArgs, "gdmr");
+DEFINE_ENGINE_CREATE(HDP, HDPArgs, "hdp");
+DEFINE_ENGINE_CREATE(MGLDA, MGLDAArgs, "mglda");
+DEFINE_ENGINE_CREATE(PA, PAArgs, "pa");
+DEFINE_ENGINE_CREATE(CT, CTArgs, "ct");
+DEFINE_ENGINE_CREATE(SLDA, SLDAArgs, "slda");
+DEFINE_ENGINE_CREATE(HLDA, HLDAArgs, "hlda");
+DEFINE_ENGINE_CREATE(LLDA, LDAArgs, "llda");
+DEFINE_ENGINE_CREATE(PLDA, PLDAArgs, "plda");
+DEFINE_ENGINE_CREATE(DT, DTArgs, "dt");
+DEFINE_ENGINE_CREATE(PT, PTArgs, "pt");
+
+tomoto::IHPAModel* tomoto::IHPAModel::create(TermWeight _weight, bool _exclusive, const HPAArgs& args, bool scalarRng)
+{
+	static auto fn = loadEngine<decltype(&IHPAModel::create)>("hpa");
+	return fn(_weight, _exclusive, args, scalarRng);
+}
+
+#endif
@@ -3,12 +3,17 @@
 #include "label.h"
 #include "utils.h"
 #include "coherence.h"
+#include "inference.h"
+#include "online.h"
+#include "cvb0.h"
+#include "multichain.h"
+#include "docindex.h"
 
 using namespace std;
 
 PyObject* gModule;
 
-void char2Byte(const char* strBegin, const char* strEnd, vector<uint32_t>& startPos, vector<uint16_t>& length)
+void char2Byte(const char* strBegin, const char* strEnd, tomoto::tvector<uint32_t>& startPos, tomoto::tvector<uint16_t>& length)
 {
 	if (strBegin == strEnd) return;
 	vector<size_t> charPos;
@@ -45,12 +50,12 @@ void char2Byte(const char* strBegin, const char* strEnd, vector<uint32_t>& start
 	}
 }
 
-void char2Byte(const string& str, vector<uint32_t>& startPos, vector<uint16_t>& length)
+void char2Byte(const string& str, tomoto::tvector<uint32_t>& startPos, tomoto::tvector<uint16_t>& length)
 {
 	return char2Byte(&str[0], &str[0] + str.size(), startPos, length);
 }
 
-void char2Byte(const tomoto::SharedString& str, vector<uint32_t>& startPos, vector<uint16_t>& length)
+void char2Byte(const tomoto::SharedString& str, tomoto::tvector<uint32_t>& startPos, tomoto::tvector<uint16_t>& length)
 {
 	return char2Byte(str.begin(), str.end(), startPos, length);
 }
@@ -66,6 +71,130 @@ void TopicModelObject::dealloc(TopicModelObject* self)
 	Py_TYPE(self)->tp_free((PyObject*)self);
 }
 
+static PyObject* loadInfo(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]()
+	{
+		ifstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		tomoto::ModelInfo info;
+		try
+		{
+			std::vector<char> unpacked = unpackModel(str);
+			tomoto::serializer::imstream ustr{ unpacked.data(), (std::ptrdiff_t)unpacked.size() };
+			std::istream& in = unpacked.empty() ? (std::istream&)str : ustr;
+			py::GILReleaser nogil;
+			in.seekg(0);
+			info = tomoto::readModelInfo(in);
+		}
+		catch (const ios_base::failure& e)
+		{
+			throw py::OSError{ std::string("'") + filename + std::string("' is not valid model file: ") + e.what() };
+		}
+
+		std::vector<std::string> vocabs;
+		for (size_t v = 0; v < info.realV && v < info.dict.size(); ++v) vocabs.emplace_back(info.dict.toWord(v));
+		py::UniqueObj initParams;
+		if (!info.extra.empty())
+		{
+			py::UniqueObj pickle{ PyImport_ImportModule("pickle") };
+			PyObject* pickle_dict{ PyModule_GetDict(pickle) };
+			py::UniqueObj bytes{ PyBytes_FromStringAndSize((const char*)info.extra.data(), info.extra.size()) };
+			py::UniqueObj args{ Py_BuildValue("(O)", bytes.get()) };
+			initParams = py::UniqueObj{ PyObject_CallObject(PyDict_GetItemString(pickle_dict, "loads"), args) };
+			if (!initParams) throw py::ExcPropagation{};
+		}
+		else
+		{
+			Py_INCREF(Py_None);
+			initParams = py::UniqueObj{ Py_None };
+		}
+
+		static const char* keys[] = { "model_key", "tw", "k", "alpha", "eta", "global_step", "vocabs", "init_params" };
+		const size_t tw = info.twid == "idf" ? (size_t)tomoto::TermWeight::idf : info.twid == "pmi" ? (size_t)tomoto::TermWeight::pmi : (size_t)tomoto::TermWeight::one;
+		py::UniqueObj ret{ py::buildPyDict(keys, info.tmid, tw, info.k, info.alpha, info.eta, info.globalStep, vocabs, std::move(initParams)) };
+		if (info.hasToc)
+		{
+			py::setPyDictItem(ret, "num_docs", info.toc.numDocs);
+			py::setPyDictItem(ret, "num_words", info.toc.numWords);
+		}
+		else
+		{
+			PyDict_SetItemString(ret, "num_docs", Py_None);
+			PyDict_SetItemString(ret, "num_words", Py_None);
+		}
+		return ret.release();
+	});
+}
+
+static PyObject* setMaxWorkers(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	Py_ssize_t n;
+	static const char* kwlist[] = { "n", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &n)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (n < 0) throw py::ValueError{ "`n` must be a non-negative integer." };
+		tomoto::PoolManager::getInstance().setMaxWorkers(n);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+static PyObject* getMaxWorkers(PyObject*)
+{
+	return py::handleExc([&]()
+	{
+		return py::buildPyValue(tomoto::PoolManager::getInstance().getMaxWorkers());
+	});
+}
+
+static PyObject* setAllocPolicy(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	const char* policy;
+	Py_ssize_t minSize = 1 << 24;
+	static const char* kwlist[] = { "policy", "min_size", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|n", (char**)kwlist, &policy, &minSize)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		if (minSize <= 0) throw py::ValueError{ "`min_size` must be a positive integer." };
+		if (policy == string{ "default" }) tomoto::HugePages::setMinBytes(0);
+		else if (policy == string{ "huge_pages" })
+		{
+			if (!tomoto::HugePages::isSupported())
+			{
+				if (PyErr_WarnEx(PyExc_RuntimeWarning, "huge pages are not supported on this platform, so `policy` stays 'default'.", 1)) return nullptr;
+			}
+			else tomoto::HugePages::setMinBytes(minSize);
+		}
+		else throw py::ValueError{ "`policy` must be one of 'default' and 'huge_pages', but given " + py::repr(PyTuple_GET_ITEM(args, 0)) };
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+static PyObject* getAllocPolicy(PyObject*)
+{
+	return py::handleExc([&]()
+	{
+		const size_t minBytes = tomoto::HugePages::getMinBytes();
+		return py::buildPyTuple(string{ minBytes ? "huge_pages" : "default" }, minBytes);
+	});
+}
+
+static PyMethodDef moduleMethods[] =
+{
+	{ "load_info", (PyCFunction)loadInfo, METH_VARARGS | METH_KEYWORDS, load_info__doc__ },
+	{ "set_max_workers", (PyCFunction)setMaxWorkers, METH_VARARGS | METH_KEYWORDS, set_max_workers__doc__ },
+	{ "get_max_workers", (PyCFunction)getMaxWorkers, METH_NOARGS, get_max_workers__doc__ },
+	{ "set_alloc_policy", (PyCFunction)setAllocPolicy, METH_VARARGS | METH_KEYWORDS, set_alloc_policy__doc__ },
+	{ "get_alloc_policy", (PyCFunction)getAllocPolicy, METH_NOARGS, get_alloc_policy__doc__ },
+	{ nullptr },
+};
+
 PyMODINIT_FUNC MODULE_NAME()
 {
 	import_array();
@@ -76,7 +205,7 @@ PyMODINIT_FUNC MODULE_NAME()
 		"tomotopy",
 		"Tomoto Module for Python",
 		-1,
-		nullptr,
+		moduleMethods,
 	};
 
 	gModule = PyModule_Create(&mod);
@@ -86,6 +215,10 @@ PyMODINIT_FUNC MODULE_NAME()
 	Py_INCREF(&LDA_type);
 	PyModule_AddObject(gModule, "LDAModel", (PyObject*)&LDA_type);
 
+	if (PyType_Ready(&InferenceSession_type) < 0) return nullptr;
+	Py_INCREF(&InferenceSession_type);
+	PyModule_AddObject(gModule, "InferenceSession", (PyObject*)&InferenceSession_type);
+
 #ifdef TM_DMR
 	if (PyType_Ready(&DMR_type) < 0) return nullptr;
 	Py_INCREF(&DMR_type);
@@ -152,18 +285,27 @@ PyMODINIT_FUNC MODULE_NAME()
 	PyModule_AddObject(gModule, "PTModel", (PyObject*)&PT_type);
 #endif
 
-#ifdef __AVX2__
+#ifdef __AVX512F__
+	PyModule_AddStringConstant(gModule, "isa", "avx512");
+#elif defined(__AVX2__)
 	PyModule_AddStringConstant(gModule, "isa", "avx2");
 #elif defined(__AVX__)
 	PyModule_AddStringConstant(gModule, "isa", "avx");
 #elif defined(__SSE2__) || defined(__x86_64__) || defined(_WIN64)
 	PyModule_AddStringConstant(gModule, "isa", "sse2");
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	PyModule_AddStringConstant(gModule, "isa", "neon");
 #else
 	PyModule_AddStringConstant(gModule, "isa", "none");
 #endif
 	addLabelTypes(gModule);
 	addUtilsTypes(gModule);
 	addCoherenceTypes(gModule);
+	addInferenceTypes(gModule);
+	addOnlineTypes(gModule);
+	addCVB0Types(gModule);
+	addMultiChainTypes(gModule);
+	addDocIndexTypes(gModule);
 
 	return gModule;
 }
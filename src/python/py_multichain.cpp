@@ -0,0 +1,340 @@
+#include <random>
+#include "module.h"
+#include "multichain.h"
+
+using namespace std;
+
+int MultiChainLDAObject::init(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	tomoto::MultiChainLDAArgs margs;
+	PyObject* argK = nullptr, *argSeed = nullptr;
+	static const char* kwlist[] = { "k", "chains_per_k", "alpha", "eta", "seed", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|OnffO", (char**)kwlist,
+		&argK, &margs.chainsPerK, &margs.alpha, &margs.eta, &argSeed)) return -1;
+	return py::handleExc([&]()
+	{
+		if (argK && PyLong_Check(argK)) margs.ks = { py::toCpp<size_t>(argK) };
+		else if (argK) margs.ks = py::toCpp<vector<size_t>>(argK, "`k` must be an integer or an iterable of integers.");
+		if (argSeed && argSeed != Py_None) margs.seed = py::toCpp<size_t>(argSeed, "`seed` must be an integer.");
+		try
+		{
+			self->model = tomoto::MultiChainLDA{ margs };
+		}
+		catch (const tomoto::exc::InvalidArgument& e)
+		{
+			throw py::ValueError{ e.what() };
+		}
+		return 0;
+	});
+}
+
+PyObject* MultiChainLDAObject::repr(MultiChainLDAObject* self)
+{
+	return py::buildPyValue(tomoto::text::format("<tomotopy.MultiChainLDAModel num_chains=%zd, num_docs=%zd, global_step=%zd>",
+		self->model.getNumChains(), self->model.getNumDocs(), (size_t)self->model.getGlobalStep()));
+}
+
+void MultiChainLDAObject::dealloc(MultiChainLDAObject* self)
+{
+	self->model.~MultiChainLDA();
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyObject* MultiChainLDAObject::load(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ifstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		py::UniqueObj obj{ PyObject_CallObject((PyObject*)&MultiChainLDA_type, nullptr) };
+		if (!obj) throw py::ExcPropagation{};
+		auto* self = (MultiChainLDAObject*)obj.get();
+		try
+		{
+			self->model.read(str);
+		}
+		catch (const tomoto::serializer::UnfitException&)
+		{
+			throw py::ValueError{ std::string("'") + filename + std::string("' is not a multi-chain LDA model file") };
+		}
+		catch (const ios_base::failure& e)
+		{
+			throw py::OSError{ e.what() };
+		}
+		return obj.release();
+	});
+}
+
+PyObject* MultiChainLDAObject::save(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ofstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		self->model.write(str);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* MultiChainLDAObject::addDoc(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argWords;
+	static const char* kwlist[] = { "words", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", (char**)kwlist, &argWords)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (PyUnicode_Check(argWords)) throw py::ValueError{ "`words` must be an iterable of `str`." };
+		auto words = py::toCpp<vector<string>>(argWords, "`words` must be an iterable of `str`.");
+		return py::buildPyValue(self->model.addDoc(self->model.toWids(words, true)));
+	});
+}
+
+PyObject* MultiChainLDAObject::train(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t iteration = 10, workers = 0;
+	static const char* kwlist[] = { "iter", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nn", (char**)kwlist, &iteration, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		{
+			py::GILReleaser nogil;
+			self->model.train(iteration, workers);
+		}
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* MultiChainLDAObject::rhat(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argChains;
+	size_t window = 0;
+	static const char* kwlist[] = { "chains", "window", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n", (char**)kwlist, &argChains, &window)) return nullptr;
+	return py::handleExc([&]()
+	{
+		auto chains = py::toCpp<vector<size_t>>(argChains, "`chains` must be an iterable of int.");
+		try
+		{
+			return py::buildPyValue(self->model.getRhat(chains, window));
+		}
+		catch (const tomoto::exc::InvalidArgument& e)
+		{
+			throw py::ValueError{ e.what() };
+		}
+	});
+}
+
+PyObject* MultiChainLDAObject::getLLHistory(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t chainId;
+	static const char* kwlist[] = { "chain_id", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &chainId)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (chainId >= self->model.getNumChains()) throw py::ValueError{ "must chain_id < num_chains" };
+		return py::buildPyValue(self->model.getLLHistory(chainId));
+	});
+}
+
+PyObject* MultiChainLDAObject::getTopicWords(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t chainId, topicId, topN = 10;
+	static const char* kwlist[] = { "chain_id", "topic_id", "top_n", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn|n", (char**)kwlist, &chainId, &topicId, &topN)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (chainId >= self->model.getNumChains()) throw py::ValueError{ "must chain_id < num_chains" };
+		if (topicId >= self->model.getK(chainId)) throw py::ValueError{ "must topic_id < k[chain_id]" };
+		auto dist = self->model.getTopicWordDist(chainId, topicId);
+		vector<size_t> order(dist.size());
+		iota(order.begin(), order.end(), 0);
+		topN = min(topN, order.size());
+		partial_sort(order.begin(), order.begin() + topN, order.end(), [&](size_t a, size_t b) { return dist[a] > dist[b]; });
+		vector<pair<string, tomoto::Float>> ret;
+		for (size_t i = 0; i < topN; ++i) ret.emplace_back(self->model.getVocabDict().toWord(order[i]), dist[order[i]]);
+		return py::buildPyValue(ret);
+	});
+}
+
+PyObject* MultiChainLDAObject::getTopicWordDist(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t chainId, topicId;
+	static const char* kwlist[] = { "chain_id", "topic_id", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn", (char**)kwlist, &chainId, &topicId)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (chainId >= self->model.getNumChains()) throw py::ValueError{ "must chain_id < num_chains" };
+		if (topicId >= self->model.getK(chainId)) throw py::ValueError{ "must topic_id < k[chain_id]" };
+		return py::buildPyValue(self->model.getTopicWordDist(chainId, topicId));
+	});
+}
+
+PyObject* MultiChainLDAObject::getDocTopicDist(MultiChainLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t chainId, docId;
+	static const char* kwlist[] = { "chain_id", "doc_id", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "nn", (char**)kwlist, &chainId, &docId)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (chainId >= self->model.getNumChains()) throw py::ValueError{ "must chain_id < num_chains" };
+		if (docId >= self->model.getNumDocs()) throw py::ValueError{ "must doc_id < num_docs" };
+		return py::buildPyValue(self->model.getDocTopicDist(chainId, docId));
+	});
+}
+
+PyObject* MultiChainLDAObject::getNumChains(MultiChainLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getNumChains());
+}
+
+PyObject* MultiChainLDAObject::getKs(MultiChainLDAObject* self, void* closure)
+{
+	vector<size_t> ret(self->model.getNumChains());
+	for (size_t i = 0; i < ret.size(); ++i) ret[i] = self->model.getK(i);
+	return py::buildPyValue(ret);
+}
+
+PyObject* MultiChainLDAObject::getSeeds(MultiChainLDAObject* self, void* closure)
+{
+	vector<size_t> ret(self->model.getNumChains());
+	for (size_t i = 0; i < ret.size(); ++i) ret[i] = self->model.getSeed(i);
+	return py::buildPyValue(ret);
+}
+
+PyObject* MultiChainLDAObject::getAlpha(MultiChainLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getAlpha());
+}
+
+PyObject* MultiChainLDAObject::getEta(MultiChainLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getEta());
+}
+
+PyObject* MultiChainLDAObject::getNumDocs(MultiChainLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getNumDocs());
+}
+
+PyObject* MultiChainLDAObject::getNumWords(MultiChainLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getN());
+}
+
+PyObject* MultiChainLDAObject::getGlobalStep(MultiChainLDAObject* self, void* closure)
+{
+	return py::buildPyValue((size_t)self->model.getGlobalStep());
+}
+
+PyObject* MultiChainLDAObject::getLLPerWord(MultiChainLDAObject* self, void* closure)
+{
+	vector<double> ret(self->model.getNumChains());
+	for (size_t i = 0; i < ret.size(); ++i)
+	{
+		auto& h = self->model.getLLHistory(i);
+		ret[i] = h.empty() ? 0 : h.back();
+	}
+	return py::buildPyValue(ret);
+}
+
+PyObject* MultiChainLDAObject::getVocabs(MultiChainLDAObject* self, void* closure)
+{
+	auto& dict = self->model.getVocabDict();
+	py::UniqueObj ret{ PyList_New(self->model.getV()) };
+	for (size_t i = 0; i < self->model.getV(); ++i)
+	{
+		PyList_SET_ITEM(ret.get(), i, py::buildPyValue(dict.toWord(i)));
+	}
+	return ret.release();
+}
+
+static PyMethodDef MultiChainLDA_methods[] =
+{
+	{ "load", (PyCFunction)MultiChainLDAObject::load, METH_STATIC | METH_VARARGS | METH_KEYWORDS, MultiChainLDA_load__doc__ },
+	{ "save", (PyCFunction)MultiChainLDAObject::save, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_save__doc__ },
+	{ "add_doc", (PyCFunction)MultiChainLDAObject::addDoc, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_add_doc__doc__ },
+	{ "train", (PyCFunction)MultiChainLDAObject::train, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_train__doc__ },
+	{ "rhat", (PyCFunction)MultiChainLDAObject::rhat, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_rhat__doc__ },
+	{ "get_ll_history", (PyCFunction)MultiChainLDAObject::getLLHistory, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_get_ll_history__doc__ },
+	{ "get_topic_words", (PyCFunction)MultiChainLDAObject::getTopicWords, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_get_topic_words__doc__ },
+	{ "get_topic_word_dist", (PyCFunction)MultiChainLDAObject::getTopicWordDist, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_get_topic_word_dist__doc__ },
+	{ "get_doc_topic_dist", (PyCFunction)MultiChainLDAObject::getDocTopicDist, METH_VARARGS | METH_KEYWORDS, MultiChainLDA_get_doc_topic_dist__doc__ },
+	{ nullptr }
+};
+
+static PyGetSetDef MultiChainLDA_getseters[] = {
+	{ (char*)"num_chains", (getter)MultiChainLDAObject::getNumChains, nullptr, MultiChainLDA_num_chains__doc__, nullptr },
+	{ (char*)"k", (getter)MultiChainLDAObject::getKs, nullptr, MultiChainLDA_k__doc__, nullptr },
+	{ (char*)"seeds", (getter)MultiChainLDAObject::getSeeds, nullptr, MultiChainLDA_seeds__doc__, nullptr },
+	{ (char*)"alpha", (getter)MultiChainLDAObject::getAlpha, nullptr, MultiChainLDA_alpha__doc__, nullptr },
+	{ (char*)"eta", (getter)MultiChainLDAObject::getEta, nullptr, MultiChainLDA_eta__doc__, nullptr },
+	{ (char*)"num_docs", (getter)MultiChainLDAObject::getNumDocs, nullptr, MultiChainLDA_num_docs__doc__, nullptr },
+	{ (char*)"num_words", (getter)MultiChainLDAObject::getNumWords, nullptr, MultiChainLDA_num_words__doc__, nullptr },
+	{ (char*)"global_step", (getter)MultiChainLDAObject::getGlobalStep, nullptr, MultiChainLDA_global_step__doc__, nullptr },
+	{ (char*)"ll_per_word", (getter)MultiChainLDAObject::getLLPerWord, nullptr, MultiChainLDA_ll_per_word__doc__, nullptr },
+	{ (char*)"vocabs", (getter)MultiChainLDAObject::getVocabs, nullptr, MultiChainLDA_vocabs__doc__, nullptr },
+	{ nullptr }
+};
+
+static PyObject* MultiChainLDA_new(PyTypeObject* type, PyObject*, PyObject*)
+{
+	auto* self = (MultiChainLDAObject*)type->tp_alloc(type, 0);
+	if (self) new (&self->model) tomoto::MultiChainLDA;
+	return (PyObject*)self;
+}
+
+PyTypeObject MultiChainLDA_type = {
+	PyVarObject_HEAD_INIT(nullptr, 0)
+	"tomotopy.MultiChainLDAModel",             /* tp_name */
+	sizeof(MultiChainLDAObject), /* tp_basicsize */
+	0,                         /* tp_itemsize */
+	(destructor)MultiChainLDAObject::dealloc, /* tp_dealloc */
+	0,                         /* tp_print */
+	0,                         /* tp_getattr */
+	0,                         /* tp_setattr */
+	0,                         /* tp_reserved */
+	(reprfunc)MultiChainLDAObject::repr,                         /* tp_repr */
+	0,                         /* tp_as_number */
+	0,       /* tp_as_sequence */
+	0,                         /* tp_as_mapping */
+	0,                         /* tp_hash  */
+	0,                         /* tp_call */
+	0,                         /* tp_str */
+	0,
+	0,                         /* tp_setattro */
+	0,                         /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,   /* tp_flags */
+	MultiChainLDA___init____doc__,           /* tp_doc */
+	0,                         /* tp_traverse */
+	0,                         /* tp_clear */
+	0,                         /* tp_richcompare */
+	0,                         /* tp_weaklistoffset */
+	0,              /* tp_iter */
+	0,                         /* tp_iternext */
+	MultiChainLDA_methods,             /* tp_methods */
+	0,						 /* tp_members */
+	MultiChainLDA_getseters,                         /* tp_getset */
+	0,                         /* tp_base */
+	0,                         /* tp_dict */
+	0,                         /* tp_descr_get */
+	0,                         /* tp_descr_set */
+	0,                         /* tp_dictoffset */
+	(initproc)MultiChainLDAObject::init,      /* tp_init */
+	PyType_GenericAlloc,
+	MultiChainLDA_new,
+};
+
+void addMultiChainTypes(PyObject* gModule)
+{
+	if (PyType_Ready(&MultiChainLDA_type) < 0) throw runtime_error{ "MultiChainLDA_type is not ready." };
+	Py_INCREF(&MultiChainLDA_type);
+	PyModule_AddObject(gModule, "MultiChainLDAModel", (PyObject*)&MultiChainLDA_type);
+}
@@ -0,0 +1,357 @@
+#include <random>
+#include "module.h"
+#include "online.h"
+
+using namespace std;
+
+int OnlineLDAObject::init(OnlineLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	tomoto::OnlineLDAArgs margs;
+	PyObject* argSeed = nullptr;
+	unsigned long long totalDocs = 0;
+	static const char* kwlist[] = { "k", "alpha", "eta", "tau0", "kappa", "total_docs", "seed", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nffffKO", (char**)kwlist,
+		&margs.k, &margs.alpha, &margs.eta, &margs.tau0, &margs.kappa, &totalDocs, &argSeed)) return -1;
+	return py::handleExc([&]()
+	{
+		if (argSeed && argSeed != Py_None) margs.seed = py::toCpp<size_t>(argSeed, "`seed` must be an integer.");
+		margs.totalDocs = totalDocs;
+		self->model = tomoto::OnlineLDA{ margs };
+		return 0;
+	});
+}
+
+PyObject* OnlineLDAObject::repr(OnlineLDAObject* self)
+{
+	return py::buildPyValue(tomoto::text::format("<tomotopy.OnlineLDAModel k=%zd, v=%zd, num_updates=%zd>",
+		self->model.getK(), self->model.getV(), (size_t)self->model.getNumUpdates()));
+}
+
+void OnlineLDAObject::dealloc(OnlineLDAObject* self)
+{
+	self->model.~OnlineLDA();
+	Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+PyObject* OnlineLDAObject::fromModel(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argModel;
+	tomoto::OnlineLDAArgs margs;
+	PyObject* argSeed = nullptr;
+	unsigned long long totalDocs = 0;
+	static const char* kwlist[] = { "model", "tau0", "kappa", "total_docs", "seed", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ffKO", (char**)kwlist,
+		&argModel, &margs.tau0, &margs.kappa, &totalDocs, &argSeed)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		if (!PyObject_TypeCheck(argModel, &LDA_type)) throw py::ValueError{ "`model` must be an instance of `tomotopy.LDAModel`." };
+		auto* mdl = (TopicModelObject*)argModel;
+		if (!mdl->inst) throw py::RuntimeError{ "inst is null" };
+		if (!mdl->isPrepared) throw py::ValueError{ "`model` must be trained before." };
+		if (argSeed && argSeed != Py_None) margs.seed = py::toCpp<size_t>(argSeed, "`seed` must be an integer.");
+		margs.totalDocs = totalDocs;
+
+		py::UniqueObj obj{ PyObject_CallObject((PyObject*)&OnlineLDA_type, nullptr) };
+		if (!obj) throw py::ExcPropagation{};
+		auto* self = (OnlineLDAObject*)obj.get();
+		self->model = tomoto::OnlineLDA{ margs };
+		self->model.warmStart(*static_cast<tomoto::ILDAModel*>(mdl->inst));
+		return obj.release();
+	});
+}
+
+PyObject* OnlineLDAObject::load(PyObject*, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ifstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		py::UniqueObj obj{ PyObject_CallObject((PyObject*)&OnlineLDA_type, nullptr) };
+		if (!obj) throw py::ExcPropagation{};
+		auto* self = (OnlineLDAObject*)obj.get();
+		try
+		{
+			self->model.read(str);
+		}
+		catch (const tomoto::serializer::UnfitException&)
+		{
+			throw py::ValueError{ std::string("'") + filename + std::string("' is not an online LDA model file") };
+		}
+		catch (const ios_base::failure& e)
+		{
+			throw py::OSError{ e.what() };
+		}
+		return obj.release();
+	});
+}
+
+PyObject* OnlineLDAObject::save(OnlineLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]() -> PyObject*
+	{
+		ofstream str{ filename, ios_base::binary };
+		if (!str) throw py::OSError{ std::string("cannot open file '") + filename + std::string("'") };
+		self->model.write(str);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* OnlineLDAObject::partialFit(OnlineLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argDocs;
+	size_t iteration = 50, workers = 0;
+	static const char* kwlist[] = { "docs", "iter", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nn", (char**)kwlist,
+		&argDocs, &iteration, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		vector<vector<tomoto::Vid>> docs;
+		py::UniqueObj iter{ PyObject_GetIter(argDocs) }, item;
+		if (!iter) throw py::ValueError{ "`docs` must be an iterable of iterables of `str`." };
+		while ((item = py::UniqueObj{ PyIter_Next(iter) }))
+		{
+			if (PyUnicode_Check(item.get())) throw py::ValueError{ "`docs` must be an iterable of iterables of `str`." };
+			docs.emplace_back(self->model.toWids(py::toCpp<vector<string>>(item, "`docs` must be an iterable of iterables of `str`."), true));
+		}
+		if (PyErr_Occurred()) throw py::ExcPropagation{};
+
+		double ll;
+		{
+			py::GILReleaser nogil;
+			ll = self->model.partialFit(docs, iteration, workers);
+		}
+		return py::buildPyValue(ll);
+	});
+}
+
+PyObject* OnlineLDAObject::infer(OnlineLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* argDoc;
+	size_t iteration = 50, workers = 0;
+	static const char* kwlist[] = { "doc", "iter", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|nn", (char**)kwlist,
+		&argDoc, &iteration, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		// `doc` is either a list of words or an iterable of lists of words
+		vector<vector<tomoto::Vid>> docs;
+		bool single = false;
+		py::UniqueObj iter{ PyObject_GetIter(argDoc) }, item;
+		if (!iter) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+		vector<string> words;
+		while ((item = py::UniqueObj{ PyIter_Next(iter) }))
+		{
+			if (PyUnicode_Check(item.get()))
+			{
+				if (!docs.empty()) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+				single = true;
+				words.emplace_back(py::toCpp<string>(item));
+			}
+			else
+			{
+				if (single) throw py::ValueError{ "`doc` must be an iterable of `str` or an iterable of iterables of `str`." };
+				docs.emplace_back(self->model.toWids(py::toCpp<vector<string>>(item, "`doc` must be an iterable of `str` or an iterable of iterables of `str`."), false));
+			}
+		}
+		if (PyErr_Occurred()) throw py::ExcPropagation{};
+		if (single) docs.emplace_back(self->model.toWids(words, false));
+
+		vector<vector<tomoto::Float>> dists;
+		vector<double> ll;
+		{
+			py::GILReleaser nogil;
+			dists = self->model.infer(docs, iteration, workers, &ll);
+		}
+
+		if (single) return py::buildPyTuple(dists[0], ll[0]);
+		py::UniqueObj ret{ PyList_New(dists.size()) };
+		for (size_t i = 0; i < dists.size(); ++i)
+		{
+			PyList_SET_ITEM(ret.get(), i, py::buildPyValue(dists[i]));
+		}
+		return py::buildPyTuple(ret.get(), ll);
+	});
+}
+
+PyObject* OnlineLDAObject::getTopicWords(OnlineLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t topicId, topN = 10;
+	static const char* kwlist[] = { "topic_id", "top_n", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n|n", (char**)kwlist, &topicId, &topN)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (topicId >= self->model.getK()) throw py::ValueError{ "must topic_id < K" };
+		auto dist = self->model.getTopicWordDist(topicId);
+		vector<size_t> order(dist.size());
+		iota(order.begin(), order.end(), 0);
+		topN = min(topN, order.size());
+		partial_sort(order.begin(), order.begin() + topN, order.end(), [&](size_t a, size_t b) { return dist[a] > dist[b]; });
+		vector<pair<string, tomoto::Float>> ret;
+		for (size_t i = 0; i < topN; ++i) ret.emplace_back(self->model.getVocabDict().toWord(order[i]), dist[order[i]]);
+		return py::buildPyValue(ret);
+	});
+}
+
+PyObject* OnlineLDAObject::getTopicWordDist(OnlineLDAObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t topicId;
+	static const char* kwlist[] = { "topic_id", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "n", (char**)kwlist, &topicId)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (topicId >= self->model.getK()) throw py::ValueError{ "must topic_id < K" };
+		return py::buildPyValue(self->model.getTopicWordDist(topicId));
+	});
+}
+
+PyObject* OnlineLDAObject::getK(OnlineLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getK());
+}
+
+PyObject* OnlineLDAObject::getAlpha(OnlineLDAObject* self, void* closure)
+{
+	vector<tomoto::Float> ret(self->model.getK());
+	for (size_t k = 0; k < ret.size(); ++k) ret[k] = self->model.getAlpha(k);
+	return py::buildPyValue(ret);
+}
+
+PyObject* OnlineLDAObject::getEta(OnlineLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getEta());
+}
+
+PyObject* OnlineLDAObject::getTau0(OnlineLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getTau0());
+}
+
+PyObject* OnlineLDAObject::getKappa(OnlineLDAObject* self, void* closure)
+{
+	return py::buildPyValue(self->model.getKappa());
+}
+
+PyObject* OnlineLDAObject::getTotalDocs(OnlineLDAObject* self, void* closure)
+{
+	return py::buildPyValue((size_t)self->model.getTotalDocs());
+}
+
+int OnlineLDAObject::setTotalDocs(OnlineLDAObject* self, PyObject* val, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		auto v = PyLong_AsLongLong(val);
+		if (v == -1 && PyErr_Occurred()) throw py::ExcPropagation{};
+		if (v < 0) throw py::ValueError{ "`total_docs` must be a non-negative integer" };
+		self->model.setTotalDocs((uint64_t)v);
+		return 0;
+	});
+}
+
+PyObject* OnlineLDAObject::getNumDocs(OnlineLDAObject* self, void* closure)
+{
+	return py::buildPyValue((size_t)self->model.getNumDocs());
+}
+
+PyObject* OnlineLDAObject::getNumUpdates(OnlineLDAObject* self, void* closure)
+{
+	return py::buildPyValue((size_t)self->model.getNumUpdates());
+}
+
+PyObject* OnlineLDAObject::getVocabs(OnlineLDAObject* self, void* closure)
+{
+	auto& dict = self->model.getVocabDict();
+	py::UniqueObj ret{ PyList_New(self->model.getV()) };
+	for (size_t i = 0; i < self->model.getV(); ++i)
+	{
+		PyList_SET_ITEM(ret.get(), i, py::buildPyValue(dict.toWord(i)));
+	}
+	return ret.release();
+}
+
+static PyMethodDef OnlineLDA_methods[] =
+{
+	{ "from_model", (PyCFunction)OnlineLDAObject::fromModel, METH_STATIC | METH_VARARGS | METH_KEYWORDS, OnlineLDA_from_model__doc__ },
+	{ "load", (PyCFunction)OnlineLDAObject::load, METH_STATIC | METH_VARARGS | METH_KEYWORDS, OnlineLDA_load__doc__ },
+	{ "save", (PyCFunction)OnlineLDAObject::save, METH_VARARGS | METH_KEYWORDS, OnlineLDA_save__doc__ },
+	{ "partial_fit", (PyCFunction)OnlineLDAObject::partialFit, METH_VARARGS | METH_KEYWORDS, OnlineLDA_partial_fit__doc__ },
+	{ "infer", (PyCFunction)OnlineLDAObject::infer, METH_VARARGS | METH_KEYWORDS, OnlineLDA_infer__doc__ },
+	{ "get_topic_words", (PyCFunction)OnlineLDAObject::getTopicWords, METH_VARARGS | METH_KEYWORDS, OnlineLDA_get_topic_words__doc__ },
+	{ "get_topic_word_dist", (PyCFunction)OnlineLDAObject::getTopicWordDist, METH_VARARGS | METH_KEYWORDS, OnlineLDA_get_topic_word_dist__doc__ },
+	{ nullptr }
+};
+
+static PyGetSetDef OnlineLDA_getseters[] = {
+	{ (char*)"k", (getter)OnlineLDAObject::getK, nullptr, OnlineLDA_k__doc__, nullptr },
+	{ (char*)"alpha", (getter)OnlineLDAObject::getAlpha, nullptr, OnlineLDA_alpha__doc__, nullptr },
+	{ (char*)"eta", (getter)OnlineLDAObject::getEta, nullptr, OnlineLDA_eta__doc__, nullptr },
+	{ (char*)"tau0", (getter)OnlineLDAObject::getTau0, nullptr, OnlineLDA_tau0__doc__, nullptr },
+	{ (char*)"kappa", (getter)OnlineLDAObject::getKappa, nullptr, OnlineLDA_kappa__doc__, nullptr },
+	{ (char*)"total_docs", (getter)OnlineLDAObject::getTotalDocs, (setter)OnlineLDAObject::setTotalDocs, OnlineLDA_total_docs__doc__, nullptr },
+	{ (char*)"num_docs", (getter)OnlineLDAObject::getNumDocs, nullptr, OnlineLDA_num_docs__doc__, nullptr },
+	{ (char*)"num_updates", (getter)OnlineLDAObject::getNumUpdates, nullptr, OnlineLDA_num_updates__doc__, nullptr },
+	{ (char*)"vocabs", (getter)OnlineLDAObject::getVocabs, nullptr, OnlineLDA_vocabs__doc__, nullptr },
+	{ nullptr }
+};
+
+static PyObject* OnlineLDA_new(PyTypeObject* type, PyObject*, PyObject*)
+{
+	auto* self = (OnlineLDAObject*)type->tp_alloc(type, 0);
+	if (self) new (&self->model) tomoto::OnlineLDA;
+	return (PyObject*)self;
+}
+
+PyTypeObject OnlineLDA_type = {
+	PyVarObject_HEAD_INIT(nullptr, 0)
+	"tomotopy.OnlineLDAModel",             /* tp_name */
+	sizeof(OnlineLDAObject), /* tp_basicsize */
+	0,                         /* tp_itemsize */
+	(destructor)OnlineLDAObject::dealloc, /* tp_dealloc */
+	0,                         /* tp_print */
+	0,                         /* tp_getattr */
+	0,                         /* tp_setattr */
+	0,                         /* tp_reserved */
+	(reprfunc)OnlineLDAObject::repr,                         /* tp_repr */
+	0,                         /* tp_as_number */
+	0,       /* tp_as_sequence */
+	0,                         /* tp_as_mapping */
+	0,                         /* tp_hash  */
+	0,                         /* tp_call */
+	0,                         /* tp_str */
+	0,
+	0,                         /* tp_setattro */
+	0,                         /* tp_as_buffer */
+	Py_TPFLAGS_DEFAULT,   /* tp_flags */
+	OnlineLDA___init____doc__,           /* tp_doc */
+	0,                         /* tp_traverse */
+	0,                         /* tp_clear */
+	0,                         /* tp_richcompare */
+	0,                         /* tp_weaklistoffset */
+	0,              /* tp_iter */
+	0,                         /* tp_iternext */
+	OnlineLDA_methods,             /* tp_methods */
+	0,						 /* tp_members */
+	OnlineLDA_getseters,                         /* tp_getset */
+	0,                         /* tp_base */
+	0,                         /* tp_dict */
+	0,                         /* tp_descr_get */
+	0,                         /* tp_descr_set */
+	0,                         /* tp_dictoffset */
+	(initproc)OnlineLDAObject::init,      /* tp_init */
+	PyType_GenericAlloc,
+	OnlineLDA_new,
+};
+
+void addOnlineTypes(PyObject* gModule)
+{
+	if (PyType_Ready(&OnlineLDA_type) < 0) throw runtime_error{ "OnlineLDA_type is not ready." };
+	Py_INCREF(&OnlineLDA_type);
+	PyModule_AddObject(gModule, "OnlineLDAModel", (PyObject*)&OnlineLDA_type);
+}
@@ -15,7 +15,13 @@
 
 using namespace std;
 
-#if defined(_WIN32) || defined(_WIN64)
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define TOMOTOPY_X86
+#endif
+
+#if !defined(TOMOTOPY_X86)
+
+#elif defined(_WIN32) || defined(_WIN64)
 #include <Windows.h>
 #include <immintrin.h>
 
@@ -41,8 +47,8 @@ void cpuid(int info[4], int InfoType) {
 
 PyMODINIT_FUNC PyInit__tomotopy()
 {
-	bool sse2 = false, avx = false, avx2 = false;
-	bool env_sse2 = false, env_avx = false, env_avx2 = false;
+	bool sse2 = false, avx = false, avx2 = false, avx512 = false;
+	bool env_sse2 = false, env_avx = false, env_avx2 = false, env_avx512 = false;
 
 	string isaEnv;
 	const char* p = getenv("TOMOTOPY_ISA");
@@ -54,20 +60,23 @@ PyMODINIT_FUNC PyInit__tomotopy()
 
 	while (getline(iss, item, ','))
 	{
-		if (item == "avx2") env_avx2 = true;
+		if (item == "avx512") env_avx512 = true;
+		else if (item == "avx2") env_avx2 = true;
 		else if (item == "avx") env_avx = true;
 		else if (item == "sse2") env_sse2 = true;
 		else if (item == "none");
 		else fprintf(stderr, "Unknown ISA option '%s' ignored.\n", item.c_str());
 	}
 
-	if (!env_sse2 && !env_avx && !env_avx2)
+	if (!env_sse2 && !env_avx && !env_avx2 && !env_avx512)
 	{
 		env_sse2 = true;
 		env_avx = true;
 		env_avx2 = true;
+		env_avx512 = true;
 	}
 	
+#ifdef TOMOTOPY_X86
 	int info[4];
 	cpuid(info, 0);
 	int nIds = info[0];
@@ -75,22 +84,36 @@ PyMODINIT_FUNC PyInit__tomotopy()
 	cpuid(info, 0x80000000);
 	unsigned nExIds = info[0];
 
+	unsigned long long xcrFeatureMask = 0;
     if (nIds >= 1) {
         cpuid(info, 1);
         sse2 = (info[3] & ((int)1 << 26)) != 0;
 		if ((info[2] & (1 << 27)) && ((info[2] & ((int)1 << 28)) != 0))
 		{
-			unsigned long long xcrFeatureMask = _xgetbv(0);
+			xcrFeatureMask = _xgetbv(0);
 			avx = (xcrFeatureMask & 0x6) == 0x6;
 		}
     }
     if (nIds >= 7) {
         cpuid(info, 7);
         avx2 = (info[1] & ((int)1 << 5)) != 0;
+		// AVX512 F, DQ, BW and VL with the opmask and zmm states enabled by OS
+		const int avx512Bits = ((int)1 << 16) | ((int)1 << 17) | ((int)1 << 30) | ((int)1 << 31);
+		avx512 = avx && (info[1] & avx512Bits) == avx512Bits && (xcrFeatureMask & 0xE6) == 0xE6;
     }
+#endif
 
 	PyObject* module = nullptr;
 	vector<string> triedModules;
+	if (!module && avx512 && env_avx512)
+	{
+		module = PyImport_ImportModule("_tomotopy_avx512");
+		if (!module)
+		{
+			PyErr_Clear();
+			triedModules.emplace_back("avx512");
+		}
+	}
 	if (!module && avx2 && env_avx2)
 	{
 		module = PyImport_ImportModule("_tomotopy_avx2");
@@ -4,6 +4,7 @@
 #include "label.h"
 #include "../Labeling/Phraser.hpp"
 #include "../Labeling/FoRelevance.h"
+#include "../TopicModel/BatchUtils.hpp"
 
 using namespace std;
 
@@ -242,6 +243,9 @@ CorpusObject* CorpusObject::_new(PyTypeObject* subtype, PyObject* args, PyObject
 	new (&obj->docs) vector<tomoto::RawDoc>;
 	new (&obj->invmap) unordered_map<string, size_t>;
 	obj->made = false;
+	obj->sketch = nullptr;
+	obj->prefilterCf = 0;
+	obj->counting = false;
 	return obj;
 }
 
@@ -275,6 +279,8 @@ void CorpusObject::dealloc(CorpusObject* self)
 	else if (self->made) self->docsMade.~vector();
 	else self->docIdcs.~vector();
 	self->invmap.~unordered_map();
+	delete self->sketch;
+	self->sketch = nullptr;
 	Py_XDECREF(self->depObj);
 	self->depObj = nullptr;
 }
@@ -325,8 +331,16 @@ PyObject* CorpusObject::setstate(CorpusObject* self, PyObject* args)
 			tomoto::RawDoc doc;
 			doc.words = py::toCpp<vector<tomoto::Vid>>(words, "");
 			if (raw) doc.rawStr = tomoto::SharedString{ PyUnicode_AsUTF8(raw) };
-			if (pos) doc.origWordPos = py::toCpp<vector<uint32_t>>(pos, "");
-			if (len) doc.origWordLen = py::toCpp<vector<uint16_t>>(len, "");
+			if (pos)
+			{
+				auto v = py::toCpp<vector<uint32_t>>(pos, "");
+				doc.origWordPos.assign(v.data(), v.data() + v.size());
+			}
+			if (len)
+			{
+				auto v = py::toCpp<vector<uint16_t>>(len, "");
+				doc.origWordLen.assign(v.data(), v.data() + v.size());
+			}
 
 			PyObject* key, * value;
 			Py_ssize_t p = 0;
@@ -347,6 +361,250 @@ PyObject* CorpusObject::setstate(CorpusObject* self, PyObject* args)
 	});
 }
 
+namespace
+{
+	/*
+	The binary corpus format stores each field of all documents as one column, 
+	so that saving and loading it copies contiguous blocks instead of building Python objects per document.
+	Variable-length columns are preceded by `numDocs + 1` offsets.
+	*/
+	constexpr uint32_t corpusFormatVersion = 1;
+
+	template<typename _Ty>
+	void writeRaw(std::ostream& ostr, const _Ty* data, size_t n)
+	{
+		if (n && !ostr.write((const char*)data, sizeof(_Ty) * n))
+			throw std::ios_base::failure{ "writing the corpus is failed" };
+	}
+
+	template<typename _SizeFn>
+	void writeOffsets(std::ostream& ostr, size_t n, _SizeFn&& sizeFn)
+	{
+		vector<uint64_t> ptr(n + 1);
+		for (size_t i = 0; i < n; ++i) ptr[i + 1] = ptr[i] + sizeFn(i);
+		writeRaw(ostr, ptr.data(), ptr.size());
+	}
+
+	class ColumnReader
+	{
+		const char* cur;
+		const char* end;
+
+		void need(size_t bytes) const
+		{
+			if ((size_t)(end - cur) < bytes) throw std::ios_base::failure{ "the corpus file is truncated" };
+		}
+
+	public:
+		ColumnReader(const char* _begin, const char* _end) : cur{ _begin }, end{ _end }
+		{
+		}
+
+		template<typename _Ty>
+		_Ty read()
+		{
+			_Ty v;
+			need(sizeof(_Ty));
+			std::memcpy(&v, cur, sizeof(_Ty));
+			cur += sizeof(_Ty);
+			return v;
+		}
+
+		template<typename _Ty>
+		vector<_Ty> readVector(size_t n)
+		{
+			vector<_Ty> v(n);
+			need(sizeof(_Ty) * n);
+			if (n) std::memcpy(v.data(), cur, sizeof(_Ty) * n);
+			cur += sizeof(_Ty) * n;
+			return v;
+		}
+
+		// returns the beginning of `n` elements of `_Ty`, which may be unaligned
+		template<typename _Ty>
+		const char* skip(size_t n)
+		{
+			need(sizeof(_Ty) * n);
+			const char* ret = cur;
+			cur += sizeof(_Ty) * n;
+			return ret;
+		}
+	};
+
+	template<typename _Cont>
+	void copyRange(_Cont& dest, const char* col, uint64_t b, uint64_t e)
+	{
+		using _Ty = typename _Cont::value_type;
+		dest.resize(e - b);
+		if (e > b) std::memcpy(dest.data(), col + sizeof(_Ty) * b, sizeof(_Ty) * (e - b));
+	}
+}
+
+PyObject* CorpusObject::save(CorpusObject* self, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (!self->isIndependent())
+			throw py::RuntimeError{ "Cannot save the corpus bound to a topic model. Try to use a topic model's `save` method." };
+
+		// misc values are arbitrary Python objects, so they are pickled together only if there is any
+		py::UniqueObj miscBytes;
+		if (std::any_of(self->docs.begin(), self->docs.end(), [](const tomoto::RawDoc& d) { return !d.misc.empty(); }))
+		{
+			py::UniqueObj miscs{ PyList_New(self->docs.size()) };
+			for (size_t i = 0; i < self->docs.size(); ++i)
+			{
+				PyObject* dict = PyDict_New();
+				for (auto& p : self->docs[i].misc)
+				{
+					PyObject* o = (PyObject*)p.second.template get<std::shared_ptr<void>>().get();
+					PyDict_SetItemString(dict, p.first.c_str(), o);
+				}
+				PyList_SET_ITEM(miscs.get(), i, dict);
+			}
+			py::UniqueObj pickle{ PyImport_ImportModule("pickle") };
+			if (!pickle) throw py::ExcPropagation{};
+			miscBytes = py::UniqueObj{ PyObject_CallMethod(pickle, "dumps", "(O)", miscs.get()) };
+			if (!miscBytes) throw py::ExcPropagation{};
+		}
+
+		for (auto& d : self->docs)
+		{
+			if (d.origWordLen.size() != d.origWordPos.size()) throw py::RuntimeError{ "the positions and the lengths of words are mismatched." };
+		}
+
+		ofstream ostr{ filename, ios_base::binary };
+		if (!ostr) throw ios_base::failure{ std::string("cannot open file '") + filename + std::string("'") };
+
+		auto& docs = self->docs;
+		const auto& dict = *self->vocab->vocabs;
+		const size_t numDocs = docs.size();
+		tomoto::serializer::writeMany(ostr, tomoto::serializer::to_key("TCOR"), corpusFormatVersion, (uint64_t)dict.size());
+		writeOffsets(ostr, dict.size(), [&](size_t i) { return dict.toWord(i).size(); });
+		for (size_t i = 0; i < dict.size(); ++i) writeRaw(ostr, dict.toWord(i).data(), dict.toWord(i).size());
+
+		tomoto::serializer::writeToStream<uint64_t>(ostr, numDocs);
+		writeOffsets(ostr, numDocs, [&](size_t i) { return docs[i].words.size(); });
+		for (auto& d : docs) writeRaw(ostr, d.words.data(), d.words.size());
+		for (auto& d : docs) writeRaw(ostr, &d.weight, 1);
+		writeOffsets(ostr, numDocs, [&](size_t i) { return docs[i].docUid.size(); });
+		for (auto& d : docs) writeRaw(ostr, d.docUid.data(), d.docUid.size());
+		writeOffsets(ostr, numDocs, [&](size_t i) { return docs[i].rawStr.size(); });
+		for (auto& d : docs) writeRaw(ostr, d.rawStr.data(), d.rawStr.size());
+		writeOffsets(ostr, numDocs, [&](size_t i) { return docs[i].origWordPos.size(); });
+		for (auto& d : docs) writeRaw(ostr, d.origWordPos.data(), d.origWordPos.size());
+		for (auto& d : docs) writeRaw(ostr, d.origWordLen.data(), d.origWordLen.size());
+
+		char* miscData = nullptr;
+		Py_ssize_t miscSize = 0;
+		if (miscBytes && PyBytes_AsStringAndSize(miscBytes, &miscData, &miscSize)) throw py::ExcPropagation{};
+		tomoto::serializer::writeToStream<uint64_t>(ostr, (uint64_t)miscSize);
+		writeRaw(ostr, miscData, miscSize);
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+PyObject* CorpusObject::load(CorpusObject* self, PyObject* args, PyObject* kwargs)
+{
+	const char* filename;
+	static const char* kwlist[] = { "filename", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", (char**)kwlist, &filename)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (!self->isIndependent())
+			throw py::RuntimeError{ "Cannot modify the corpus bound to a topic model." };
+		if (!self->docs.empty()) throw py::RuntimeError{ "`_load` requires an empty corpus." };
+
+		tomoto::MMap mapped{ filename };
+		ColumnReader reader{ mapped.get(), mapped.get() + mapped.size() };
+		auto magic = reader.read<std::array<char, 4>>();
+		if (magic != tomoto::serializer::to_key("TCOR").m) throw py::ValueError{ std::string("'") + filename + "' is not a corpus file." };
+		auto version = reader.read<uint32_t>();
+		if (version > corpusFormatVersion) throw py::ValueError{ "unsupported corpus format version " + std::to_string(version) };
+
+		auto* dict = new tomoto::Dictionary;
+		if (!self->vocab->dep && self->vocab->vocabs) delete self->vocab->vocabs;
+		self->vocab->vocabs = dict;
+		self->vocab->dep = nullptr;
+		self->vocab->size = -1;
+		const size_t numVocabs = reader.read<uint64_t>();
+		auto vocabPtr = reader.readVector<uint64_t>(numVocabs + 1);
+		const char* vocabStr = reader.skip<char>(vocabPtr.back());
+		dict->reserve(numVocabs);
+		for (size_t i = 0; i < numVocabs; ++i)
+		{
+			dict->add(string{ vocabStr + vocabPtr[i], vocabStr + vocabPtr[i + 1] });
+		}
+
+		const size_t numDocs = reader.read<uint64_t>();
+		auto wordPtr = reader.readVector<uint64_t>(numDocs + 1);
+		const char* words = reader.skip<tomoto::Vid>(wordPtr.back());
+		auto weights = reader.readVector<tomoto::Float>(numDocs);
+		auto uidPtr = reader.readVector<uint64_t>(numDocs + 1);
+		const char* uids = reader.skip<char>(uidPtr.back());
+		auto rawPtr = reader.readVector<uint64_t>(numDocs + 1);
+		const char* raws = reader.skip<char>(rawPtr.back());
+		auto posPtr = reader.readVector<uint64_t>(numDocs + 1);
+		const char* poses = reader.skip<uint32_t>(posPtr.back());
+		const char* lens = reader.skip<uint16_t>(posPtr.back());
+		const size_t miscSize = reader.read<uint64_t>();
+		const char* miscData = reader.skip<char>(miscSize);
+
+		py::UniqueObj miscs;
+		if (miscSize)
+		{
+			py::UniqueObj pickle{ PyImport_ImportModule("pickle") };
+			if (!pickle) throw py::ExcPropagation{};
+			py::UniqueObj bytes{ PyBytes_FromStringAndSize(miscData, miscSize) };
+			miscs = py::UniqueObj{ PyObject_CallMethod(pickle, "loads", "(O)", bytes.get()) };
+			if (!miscs) throw py::ExcPropagation{};
+			if (!PyList_Check(miscs.get()) || PyList_GET_SIZE(miscs.get()) != (Py_ssize_t)numDocs)
+				throw py::ValueError{ "the corpus file has broken user data." };
+		}
+
+		self->docs.reserve(numDocs);
+		for (size_t i = 0; i < numDocs; ++i)
+		{
+			tomoto::RawDoc doc;
+			copyRange(doc.words, words, wordPtr[i], wordPtr[i + 1]);
+			for (auto w : doc.words)
+			{
+				if (w >= numVocabs && w != tomoto::non_vocab_id) throw py::ValueError{ "the corpus file has an out-of-vocabulary word id." };
+			}
+			doc.weight = weights[i];
+			if (uidPtr[i + 1] > uidPtr[i])
+			{
+				doc.docUid = tomoto::SharedString{ uids + uidPtr[i], uids + uidPtr[i + 1] };
+				self->invmap.emplace((string)doc.docUid, i);
+			}
+			if (rawPtr[i + 1] > rawPtr[i]) doc.rawStr = tomoto::SharedString{ raws + rawPtr[i], raws + rawPtr[i + 1] };
+			copyRange(doc.origWordPos, poses, posPtr[i], posPtr[i + 1]);
+			copyRange(doc.origWordLen, lens, posPtr[i], posPtr[i + 1]);
+
+			PyObject* misc = miscs ? PyList_GET_ITEM(miscs.get(), i) : nullptr;
+			PyObject* key, * value;
+			Py_ssize_t p = 0;
+			while (misc && PyDict_Check(misc) && PyDict_Next(misc, &p, &key, &value))
+			{
+				const char* utf8 = PyUnicode_AsUTF8(key);
+				if (!utf8) throw py::ExcPropagation{};
+				Py_INCREF(value);
+				doc.misc[utf8] = std::shared_ptr<void>{ value, [](void* p)
+				{
+					Py_XDECREF(p);
+				} };
+			}
+			self->docs.emplace_back(move(doc));
+		}
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
 PyObject* CorpusObject::addDoc(CorpusObject* self, PyObject* args, PyObject* kwargs)
 {
 	return py::handleExc([&]()
@@ -382,7 +640,7 @@ PyObject* CorpusObject::addDoc(CorpusObject* self, PyObject* args, PyObject* kwa
 			{
 				if (PyUnicode_Check(t))
 				{
-					doc.words.emplace_back(self->vocab->vocabs->add(PyUnicode_AsUTF8(t)));
+					doc.words.emplace_back(self->addWord(PyUnicode_AsUTF8(t)));
 				}
 				else if (PyTuple_Size(t) == 3)
 				{
@@ -393,7 +651,7 @@ PyObject* CorpusObject::addDoc(CorpusObject* self, PyObject* args, PyObject* kwa
 
 					py::UniqueObj stopRet{ PyObject_CallObject(stopwords, py::UniqueObj{ py::buildPyTuple(word) }) };
 					if (!stopRet) throw py::ExcPropagation{};
-					doc.words.emplace_back(PyObject_IsTrue(stopRet) ? -1 : self->vocab->vocabs->add(PyUnicode_AsUTF8(word)));
+					doc.words.emplace_back(PyObject_IsTrue(stopRet) ? -1 : self->addWord(PyUnicode_AsUTF8(word)));
 					doc.origWordPos.emplace_back(PyLong_AsLong(pos));
 					doc.origWordLen.emplace_back(PyLong_AsLong(len));
 				}
@@ -412,38 +670,364 @@ PyObject* CorpusObject::addDoc(CorpusObject* self, PyObject* args, PyObject* kwa
 			{
 				py::UniqueObj stopRet{ PyObject_CallObject(stopwords, py::UniqueObj{ py::buildPyTuple(w) }) };
 				if (!stopRet) throw py::ExcPropagation{};
-				doc.words.emplace_back(PyObject_IsTrue(stopRet) ? -1 : self->vocab->vocabs->add(w));
+				doc.words.emplace_back(PyObject_IsTrue(stopRet) ? -1 : self->addWord(w));
 			}, "");
 		}
-		PyObject* key, * value;
-		Py_ssize_t p = 0;
-		while (PyDict_Next(kwargs, &p, &key, &value))
+		if (self->counting) return py::buildPyValue(-1);
+		self->appendDoc(move(doc), kwargs);
+		return py::buildPyValue(self->docs.size() - 1);
+	});
+}
+
+tomoto::Vid CorpusObject::addWord(const string& word, size_t cnt)
+{
+	if (sketch)
+	{
+		if (counting)
+		{
+			sketch->add(word, cnt);
+			return tomoto::non_vocab_id;
+		}
+		const auto v = vocab->vocabs->toWid(word);
+		if (v != tomoto::non_vocab_id) return v;
+		if (sketch->estimate(word) < prefilterCf) return tomoto::non_vocab_id;
+	}
+	return vocab->vocabs->add(word);
+}
+
+PyObject* CorpusObject::setPrefilter(CorpusObject* self, PyObject* args, PyObject* kwargs)
+{
+	size_t minCf = 0, width = 1 << 20, depth = 4;
+	int counting = 0;
+	static const char* kwlist[] = { "min_cf", "counting", "width", "depth", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "np|nn", (char**)kwlist,
+		&minCf, &counting, &width, &depth)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (!self->isIndependent())
+			throw py::RuntimeError{ "Cannot modify the corpus bound to a topic model." };
+		if (!minCf)
+		{
+			// the sketch is needed only while ingesting, so it is freed at the end
+			delete self->sketch;
+			self->sketch = nullptr;
+		}
+		else if (!self->sketch) self->sketch = new tomoto::CountMinSketch{ width, depth };
+		self->prefilterCf = minCf;
+		self->counting = self->sketch && counting;
+		Py_INCREF(Py_None);
+		return Py_None;
+	});
+}
+
+void CorpusObject::appendDoc(tomoto::RawDoc&& doc, PyObject* kwargs)
+{
+	PyObject* key, * value;
+	Py_ssize_t p = 0;
+	while (kwargs && PyDict_Next(kwargs, &p, &key, &value))
+	{
+		const char* utf8 = PyUnicode_AsUTF8(key);
+		if (utf8 == string{ "uid" })
+		{
+			if (value == Py_None) continue;
+			const char* uid = PyUnicode_AsUTF8(value);
+			if (!uid) throw py::ValueError{ "`uid` must be str type." };
+			string suid = uid;
+			if (suid.empty()) throw py::ValueError{ "wrong `uid` value : empty str not allowed" };
+			if (invmap.find(suid) != invmap.end())
+			{
+				throw py::ValueError{ "there is a document with uid = " + py::repr(value) + " already." };
+			}
+			invmap.emplace(suid, docs.size());
+			doc.docUid = tomoto::SharedString{ uid };
+			continue;
+		}
+
+		Py_INCREF(value);
+		doc.misc[utf8] = std::shared_ptr<void>{ value, [](void* p)
+		{
+			Py_XDECREF(p);
+		} };
+	}
+	docs.emplace_back(move(doc));
+}
+
+PyObject* CorpusObject::addRawDocs(CorpusObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* raws, * kwargsList, * stemmer = nullptr;
+	int lowercase = 1;
+	size_t workers = 0;
+	static const char* kwlist[] = { "raws", "kwargs_list", "lowercase", "stemmer", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|pOn", (char**)kwlist,
+		&raws, &kwargsList, &lowercase, &stemmer, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (!self->isIndependent())
+			throw py::RuntimeError{ "Cannot modify the corpus bound to a topic model." };
+		if (stemmer == Py_None) stemmer = nullptr;
+
+		vector<string> rawStrs;
+		vector<PyObject*> docKwargs;
+		py::foreach<string>(raws, [&](const string& raw)
+		{
+			rawStrs.emplace_back(raw);
+		}, "`raws` must be an iterable of `str`.");
+		py::foreach<PyObject*>(kwargsList, [&](PyObject* d)
+		{
+			docKwargs.emplace_back(d);
+		}, "`kwargs_list` must be an iterable of `dict`.");
+		if (rawStrs.size() != docKwargs.size()) throw py::ValueError{ "`raws` and `kwargs_list` must have the same length." };
+
+		// each worker tokenizes a contiguous range of documents into ids of its own local vocabulary
+		struct LocalVocab
+		{
+			unordered_map<string, uint32_t> ids;
+			vector<string> words;
+			vector<pair<size_t, size_t>> firstAt; // (document, token) where each word occurs first
+			vector<size_t> cnts;
+		};
+		const size_t numDocs = rawStrs.size();
+		if (!workers) workers = thread::hardware_concurrency();
+		workers = max(min(workers, numDocs / 64), (size_t)1);
+		vector<LocalVocab> locals(workers);
+		vector<tomoto::RawDoc> docs(numDocs);
 		{
-			const char* utf8 = PyUnicode_AsUTF8(key);
-			if (utf8 == string{ "uid" })
+			py::GILReleaser nogil;
+			auto tokenizeRange = [&](size_t w)
+			{
+				auto& lv = locals[w];
+				for (size_t i = numDocs * w / workers; i < numDocs * (w + 1) / workers; ++i)
+				{
+					auto& doc = docs[i];
+					tomoto::text::tokenizeSimple(rawStrs[i], !!lowercase, [&](const string& token, uint32_t pos, uint32_t len)
+					{
+						auto it = lv.ids.find(token);
+						if (it == lv.ids.end())
+						{
+							it = lv.ids.emplace(token, (uint32_t)lv.words.size()).first;
+							lv.words.emplace_back(token);
+							lv.firstAt.emplace_back(i, doc.words.size());
+							lv.cnts.emplace_back(0);
+						}
+						++lv.cnts[it->second];
+						doc.words.emplace_back(it->second);
+						doc.origWordPos.emplace_back(pos);
+						doc.origWordLen.emplace_back((uint16_t)len);
+					});
+				}
+			};
+
+			if (workers > 1)
 			{
-				if (value == Py_None) continue;
-				const char* uid = PyUnicode_AsUTF8(value);
-				if (!uid) throw py::ValueError{ "`uid` must be str type." };
-				string suid = uid;
-				if (suid.empty()) throw py::ValueError{ "wrong `uid` value : empty str not allowed" };
-				if (self->invmap.find(suid) != self->invmap.end())
+				auto pool = tomoto::PoolManager::getInstance().borrow(workers);
+				vector<future<void>> futures;
+				for (size_t w = 0; w < workers; ++w)
 				{
-					throw py::ValueError{ "there is a document with uid = " + py::repr(value) + " already." };
+					futures.emplace_back(pool->enqueue([&](size_t, size_t w) { tokenizeRange(w); }, w));
 				}
-				self->invmap.emplace(suid, self->docs.size());
-				doc.docUid = tomoto::SharedString{ uid };
+				for (auto& f : futures) f.get();
+			}
+			else
+			{
+				tokenizeRange(0);
+			}
+		}
+
+		// local words are resolved in the order of their first occurrences, so the shared vocabulary gets the same ids as adding documents one by one.
+		// Python is called only once for each distinct token, for lowercasing non-ASCII letters, stemming and filtering stopwords.
+		vector<tuple<size_t, size_t, size_t, uint32_t>> order;
+		for (size_t w = 0; w < workers; ++w)
+		{
+			for (uint32_t j = 0; j < locals[w].words.size(); ++j)
+			{
+				order.emplace_back(locals[w].firstAt[j].first, locals[w].firstAt[j].second, w, j);
+			}
+		}
+		sort(order.begin(), order.end());
+
+		// when counting, each distinct token is counted at once with its occurrences in all workers
+		unordered_map<string, size_t> totalCnts;
+		if (self->counting)
+		{
+			for (auto& lv : locals)
+			{
+				for (size_t j = 0; j < lv.words.size(); ++j) totalCnts[lv.words[j]] += lv.cnts[j];
+			}
+		}
+
+		py::UniqueObj stopwords{ PyObject_GetAttrString((PyObject*)self, "_stopwords") };
+		if (!stopwords) throw py::ExcPropagation{};
+		vector<vector<tomoto::Vid>> toGlobal(workers);
+		for (size_t w = 0; w < workers; ++w) toGlobal[w].resize(locals[w].words.size());
+		unordered_map<string, tomoto::Vid> resolved;
+		for (auto& e : order)
+		{
+			const size_t w = get<2>(e);
+			const uint32_t j = get<3>(e);
+			const string& token = locals[w].words[j];
+			auto it = resolved.find(token);
+			if (it != resolved.end())
+			{
+				toGlobal[w][j] = it->second;
 				continue;
 			}
 
-			Py_INCREF(value);
-			doc.misc[utf8] = std::shared_ptr<void>{ value, [](void* p)
+			py::UniqueObj word{ PyUnicode_FromStringAndSize(token.data(), token.size()) };
+			if (lowercase && any_of(token.begin(), token.end(), [](char c) { return (uint8_t)c >= 0x80; }))
 			{
-				Py_XDECREF(p);
-			} };
+				word = py::UniqueObj{ PyObject_CallMethod(word, "lower", nullptr) };
+				if (!word) throw py::ExcPropagation{};
+			}
+			if (stemmer)
+			{
+				word = py::UniqueObj{ PyObject_CallFunctionObjArgs(stemmer, word.get(), nullptr) };
+				if (!word) throw py::ExcPropagation{};
+				if (!PyUnicode_Check(word)) throw py::ValueError{ "`stemmer` must return a `str`." };
+			}
+			py::UniqueObj stopRet{ PyObject_CallFunctionObjArgs(stopwords, word.get(), nullptr) };
+			if (!stopRet) throw py::ExcPropagation{};
+			const tomoto::Vid v = PyObject_IsTrue(stopRet) ? tomoto::non_vocab_id : self->addWord(PyUnicode_AsUTF8(word), self->counting ? totalCnts[token] : 1);
+			resolved.emplace(token, v);
+			toGlobal[w][j] = v;
 		}
-		self->docs.emplace_back(move(doc));
-		return py::buildPyValue(self->docs.size() - 1);
+		if (self->counting) return py::buildPyValue((size_t)0);
+
+		size_t added = 0;
+		for (size_t w = 0; w < workers; ++w)
+		{
+			for (size_t i = numDocs * w / workers; i < numDocs * (w + 1) / workers; ++i)
+			{
+				// empty documents are skipped like `add_doc`
+				if (rawStrs[i].empty()) continue;
+				auto& doc = docs[i];
+				for (auto& v : doc.words) v = toGlobal[w][v];
+				doc.rawStr = tomoto::SharedString{ rawStrs[i] };
+				self->appendDoc(move(doc), docKwargs[i]);
+				++added;
+			}
+		}
+		return py::buildPyValue(added);
+	});
+}
+
+TokenArrays::TokenArrays(PyObject* _vocabs, PyObject* tokenIds, PyObject* _offsets, PyObject* _uids)
+{
+	py::foreach<string>(_vocabs, [&](const string& w)
+	{
+		vocabs.emplace_back(w);
+	}, "`vocabs` must be an iterable of `str`.");
+	tokenObj = py::UniqueObj{ PyArray_FROMANY(tokenIds, NPY_INT32, 1, 1, NPY_ARRAY_IN_ARRAY) };
+	if (!tokenObj) throw py::ExcPropagation{};
+	offsetObj = py::UniqueObj{ PyArray_FROMANY(_offsets, NPY_INT64, 1, 1, NPY_ARRAY_IN_ARRAY) };
+	if (!offsetObj) throw py::ExcPropagation{};
+	tokens = (const int32_t*)PyArray_DATA((PyArrayObject*)tokenObj.get());
+	const size_t numTokens = PyArray_SIZE((PyArrayObject*)tokenObj.get());
+	const auto* off = (const int64_t*)PyArray_DATA((PyArrayObject*)offsetObj.get());
+	const size_t numOffsets = PyArray_SIZE((PyArrayObject*)offsetObj.get());
+	if (!numOffsets) throw py::ValueError{ "`offsets` must have `len(docs) + 1` elements." };
+	if (off[0] < 0) throw py::ValueError{ "`offsets` must not be negative." };
+	offsets.assign(off, off + numOffsets);
+	for (size_t i = 1; i < numOffsets; ++i)
+	{
+		if (off[i] < off[i - 1]) throw py::ValueError{ "`offsets` must be non-decreasing." };
+	}
+	if (offsets.back() > numTokens) throw py::ValueError{ "`offsets` exceeds the length of `token_ids`." };
+
+	if (_uids && _uids != Py_None)
+	{
+		py::foreach<string>(_uids, [&](const string& uid)
+		{
+			uids.emplace_back(uid);
+		}, "`uids` must be an iterable of `str`.");
+		if (uids.size() != size()) throw py::ValueError{ "`uids` must have the same length as the number of documents." };
+	}
+
+	const int64_t V = vocabs.size();
+	int64_t invalid = 0;
+	{
+		py::GILReleaser nogil;
+		vector<char> seen(V);
+		for (size_t i = offsets.front(); i < offsets.back(); ++i)
+		{
+			const int32_t t = tokens[i];
+			if (t == -1) continue;
+			if (t < -1 || t >= V)
+			{
+				invalid = (int64_t)i + 1;
+				break;
+			}
+			if (seen[t]) continue;
+			seen[t] = 1;
+			usedVocabs.emplace_back(t);
+		}
+	}
+	if (invalid) throw py::ValueError{ "`token_ids[" + to_string(invalid - 1) + "]` = " + to_string(tokens[invalid - 1]) + " is out of `vocabs`." };
+}
+
+PyObject* CorpusObject::addTokenArrays(CorpusObject* self, PyObject* args, PyObject* kwargs)
+{
+	PyObject* vocabs, * tokenIds, * offsets, * uids = nullptr;
+	size_t workers = 0;
+	static const char* kwlist[] = { "vocabs", "token_ids", "offsets", "uids", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|On", (char**)kwlist,
+		&vocabs, &tokenIds, &offsets, &uids, &workers)) return nullptr;
+	return py::handleExc([&]()
+	{
+		if (!self->isIndependent())
+			throw py::RuntimeError{ "Cannot modify the corpus bound to a topic model." };
+		TokenArrays arrays{ vocabs, tokenIds, offsets, uids };
+		const size_t numDocs = arrays.size();
+
+		// Python is called only once for each used vocabulary, for filtering stopwords
+		py::UniqueObj stopwords{ PyObject_GetAttrString((PyObject*)self, "_stopwords") };
+		if (!stopwords) throw py::ExcPropagation{};
+		vector<tomoto::Vid> remap(arrays.vocabs.size(), tomoto::non_vocab_id);
+		for (auto v : arrays.usedVocabs)
+		{
+			py::UniqueObj word{ PyUnicode_FromStringAndSize(arrays.vocabs[v].data(), arrays.vocabs[v].size()) };
+			if (!word) throw py::ExcPropagation{};
+			py::UniqueObj stopRet{ PyObject_CallFunctionObjArgs(stopwords, word.get(), nullptr) };
+			if (!stopRet) throw py::ExcPropagation{};
+			if (!PyObject_IsTrue(stopRet)) remap[v] = self->vocab->vocabs->add(arrays.vocabs[v]);
+		}
+
+		unordered_set<string> batchUids;
+		for (auto& uid : arrays.uids)
+		{
+			if (uid.empty()) throw py::ValueError{ "wrong `uid` value : empty str not allowed" };
+			if (self->invmap.count(uid) || !batchUids.emplace(uid).second) throw py::ValueError{ "there is a document with uid = '" + uid + "' already." };
+		}
+
+		vector<tomoto::RawDoc> docs(numDocs);
+		{
+			py::GILReleaser nogil;
+			tomoto::detail::forEachRange(numDocs, workers, [&](size_t, size_t b, size_t e)
+			{
+				for (size_t i = b; i < e; ++i)
+				{
+					auto& doc = docs[i];
+					doc.words.resize(arrays.offsets[i + 1] - arrays.offsets[i]);
+					for (size_t j = 0; j < doc.words.size(); ++j)
+					{
+						const int32_t t = arrays.tokens[arrays.offsets[i] + j];
+						doc.words[j] = t < 0 ? tomoto::non_vocab_id : remap[t];
+					}
+					if (!arrays.uids.empty()) doc.docUid = tomoto::SharedString{ arrays.uids[i] };
+				}
+			});
+		}
+
+		size_t added = 0;
+		self->docs.reserve(self->docs.size() + numDocs);
+		for (auto& doc : docs)
+		{
+			// empty documents are skipped like `add_doc`
+			if (doc.words.empty()) continue;
+			if (!doc.docUid.empty()) self->invmap.emplace(string{ doc.docUid }, self->docs.size());
+			self->docs.emplace_back(move(doc));
+			++added;
+		}
+		return py::buildPyValue(added);
 	});
 }
 
@@ -459,34 +1043,28 @@ PyObject* CorpusObject::extractNgrams(CorpusObject* self, PyObject* args, PyObje
 	{
 		if (!self->isIndependent())
 			throw py::RuntimeError{ "Cannot modify the corpus bound to a topic model." };
-		size_t vSize = self->vocab->vocabs->size();
-		vector<size_t> cf(vSize),
-			df(vSize),
-			odf(vSize);
-		for (auto& d : self->docs)
+		vector<tomoto::label::Candidate> cands;
 		{
-			for (auto w : d.words)
+			py::GILReleaser nogil;
+			if (!workers) workers = thread::hardware_concurrency();
+			tomoto::PoolManager::Lease pool;
+			if (workers > 1) pool = tomoto::PoolManager::getInstance().borrow(workers);
+
+			size_t vSize = self->vocab->vocabs->size();
+			vector<size_t> cf(vSize), df(vSize);
+			auto tx = [](const tomoto::RawDoc& raw)
 			{
-				if (w == tomoto::non_vocab_id) continue;
-				odf[w] = 1;
-				cf[w]++;
-			}
-
-			for (size_t i = 0; i < df.size(); ++i) df[i] += odf[i];
-			fill(odf.begin(), odf.end(), 0);
+				return RawDocWrapper{ raw };
+			};
+			auto docBegin = tomoto::makeTransformIter(self->docs.begin(), tx);
+			auto docEnd = tomoto::makeTransformIter(self->docs.end(), tx);
+			tomoto::phraser::countUnigrams(cf, df, docBegin, docEnd, pool.get());
+			cands = tomoto::phraser::extractPMINgrams(docBegin, docEnd,
+				cf, df,
+				minCf, minDf, 2, maxLen, maxCand, minScore, normalized, pool.get()
+			);
 		}
 
-		auto tx = [](const tomoto::RawDoc& raw)
-		{
-			return RawDocWrapper{ raw };
-		};
-		auto docBegin = tomoto::makeTransformIter(self->docs.begin(), tx);
-		auto docEnd = tomoto::makeTransformIter(self->docs.end(), tx);
-		auto cands = tomoto::phraser::extractPMINgrams(docBegin, docEnd,
-			cf, df,
-			minCf, minDf, 2, maxLen, maxCand, minScore, normalized
-		);
-
 		PyObject* ret = PyList_New(0);
 		for (auto& c : cands)
 		{
@@ -500,15 +1078,14 @@ PyObject* CorpusObject::extractNgrams(CorpusObject* self, PyObject* args, PyObje
 	});
 }
 
-// TODO: It loses some ngram patterns. Fix me!
 PyObject* CorpusObject::concatNgrams(CorpusObject* self, PyObject* args, PyObject* kwargs)
 {
 	PyObject* cands;
 	const char* delimiter = "_";
-	float minScore = -INFINITY;
-	static const char* kwlist[] = { "cands", "delimiter", nullptr };
-	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s", (char**)kwlist,
-		&cands, &delimiter)) return nullptr;
+	size_t workers = 1;
+	static const char* kwlist[] = { "cands", "delimiter", "workers", nullptr };
+	if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sn", (char**)kwlist,
+		&cands, &delimiter, &workers)) return nullptr;
 	return py::handleExc([&]() -> PyObject*
 	{
 		if (!self->isIndependent())
@@ -580,38 +1157,16 @@ PyObject* CorpusObject::concatNgrams(CorpusObject* self, PyObject* args, PyObjec
 			});
 		}
 		root.fillFail();
+		const tomoto::FrozenTrie<tomoto::Vid, size_t> trie{ root };
+		candTrie = {};
 
-		size_t totUpdated = 0;
-		for (auto& doc : self->docs)
+		size_t totUpdated;
 		{
-			auto* node = &root;
-			for (size_t i = 0; i < doc.words.size(); ++i)
-			{
-				auto* nnode = node->getNext(doc.words[i]);
-				while (!nnode)
-				{
-					node = node->getFail();
-					if (node) nnode = node->getNext(doc.words[i]);
-					else break;
-				}
-				
-				if (nnode)
-				{
-					node = nnode;
-					if (nnode->val && nnode->val != (size_t)-1)
-					{
-						size_t found = nnode->val - 1;
-						doc.words[i] = pcandVids[found];
-						size_t len = pcands[found].w.size();
-						if(len > 1) doc.words.erase(doc.words.begin() + i - len + 1, doc.words.begin() + i);
-						totUpdated++;
-					}
-				}
-				else
-				{
-					node = &root;
-				}
-			}
+			py::GILReleaser nogil;
+			if (!workers) workers = thread::hardware_concurrency();
+			tomoto::PoolManager::Lease pool;
+			if (workers > 1) pool = tomoto::PoolManager::getInstance().borrow(workers);
+			totUpdated = tomoto::phraser::concatNgrams(self->docs.begin(), self->docs.end(), trie, pcandVids, pool.get());
 		}
 		return py::buildPyValue(totUpdated);
 	});
@@ -797,6 +1352,11 @@ static PyMethodDef UtilsCorpus_methods[] =
 	{ "__getstate__", (PyCFunction)CorpusObject::getstate, METH_NOARGS, "" },
 	{ "__setstate__", (PyCFunction)CorpusObject::setstate, METH_VARARGS, "" },
 	{ "add_doc", (PyCFunction)CorpusObject::addDoc, METH_VARARGS | METH_KEYWORDS, "" },
+	{ "_add_raw_docs", (PyCFunction)CorpusObject::addRawDocs, METH_VARARGS | METH_KEYWORDS, "" },
+	{ "_add_token_arrays", (PyCFunction)CorpusObject::addTokenArrays, METH_VARARGS | METH_KEYWORDS, "" },
+	{ "_set_prefilter", (PyCFunction)CorpusObject::setPrefilter, METH_VARARGS | METH_KEYWORDS, "" },
+	{ "_save", (PyCFunction)CorpusObject::save, METH_VARARGS | METH_KEYWORDS, "" },
+	{ "_load", (PyCFunction)CorpusObject::load, METH_VARARGS | METH_KEYWORDS, "" },
 	{ "extract_ngrams", (PyCFunction)CorpusObject::extractNgrams, METH_VARARGS | METH_KEYWORDS, "" },
 	{ "concat_ngrams", (PyCFunction)CorpusObject::concatNgrams, METH_VARARGS | METH_KEYWORDS, "" },
 	{ nullptr }
@@ -1051,6 +1611,80 @@ PyObject* DocumentObject::getUid(DocumentObject* self, void* closure)
 	});
 }
 
+static void releaseDocView(PyObject* capsule)
+{
+	auto* self = (DocumentObject*)PyCapsule_GetPointer(capsule, "tomotopy.document_view");
+	self->corpus->tm->numDocViews--;
+	Py_DECREF(self);
+}
+
+/*
+builds a read-only array viewing `size` elements at `data`, which belong to the document of `self`.
+The view keeps the document (and so its model) alive, and the model refuses to move the arrays of its documents while views of them exist.
+Documents made by `make_doc` or for `infer` aren't viewed since `infer` reallocates their arrays.
+*/
+template<typename _Ty>
+static PyObject* buildDocView(DocumentObject* self, const _Ty* data, size_t size)
+{
+	npy_intp shapes[1] = { (npy_intp)size };
+	constexpr int type = py::detail::NpyType<_Ty>::type;
+	if (!size) return PyArray_EMPTY(1, shapes, type, 0);
+	py::UniqueObj ret{ PyArray_New(&PyArray_Type, 1, shapes, type, nullptr, (void*)data, 0, NPY_ARRAY_C_CONTIGUOUS, nullptr) };
+	if (!ret) throw py::ExcPropagation{};
+	PyArray_CLEARFLAGS((PyArrayObject*)ret.get(), NPY_ARRAY_WRITEABLE);
+	PyObject* base = PyCapsule_New(self, "tomotopy.document_view", releaseDocView);
+	if (!base) throw py::ExcPropagation{};
+	Py_INCREF(self);
+	self->corpus->tm->numDocViews++;
+	if (PyArray_SetBaseObject((PyArrayObject*)ret.get(), base) < 0) throw py::ExcPropagation{};
+	return ret.release();
+}
+
+static void checkViewable(DocumentObject* self, const char* name)
+{
+	if (self->corpus->isIndependent()) throw py::AttributeError{ std::string{ "doc has no `" } + name + "` field!" };
+	if (!self->doc) throw py::RuntimeError{ "doc is null!" };
+	if (self->owner || self->corpus->made) throw py::RuntimeError{ std::string{ "`" } + name + "` is only available for the documents of the model" };
+	// the arrays of the documents are packed when the model is prepared for the first time
+	if (!self->corpus->tm->isPrepared) throw py::RuntimeError{ "train() should be called first" };
+}
+
+PyObject* DocumentObject::getWordsView(DocumentObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkViewable(self, "words_view");
+		auto& words = self->getBoundDoc()->words;
+		return buildDocView(self, words.data(), words.size());
+	});
+}
+
+PyObject* DocumentObject::getTopicsView(DocumentObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkViewable(self, "topics_view");
+		if (auto* ret = docVisit<tomoto::DocumentLDA>(self->getBoundDoc(), [&](auto* doc)
+		{
+			return buildDocView(self, doc->Zs.data(), doc->Zs.size());
+		})) return ret;
+		throw py::AttributeError{ "doc has no `topics_view` field!" };
+	});
+}
+
+PyObject* DocumentObject::getCountByTopicsView(DocumentObject* self, void* closure)
+{
+	return py::handleExc([&]()
+	{
+		checkViewable(self, "count_by_topics_view");
+		if (auto* ret = docVisit<tomoto::DocumentLDA>(self->getBoundDoc(), [&](auto* doc)
+		{
+			return buildDocView(self, doc->numByTopic.data(), doc->numByTopic.size());
+		})) return ret;
+		throw py::AttributeError{ "doc has no `count_by_topics_view` field!" };
+	});
+}
+
 PyObject* DocumentObject::getattro(DocumentObject* self, PyObject* attr)
 {
 	return py::handleExc([&]()
@@ -1168,6 +1802,17 @@ static PyObject* Document_Z(DocumentObject* self, void* closure)
 	});
 }
 
+bool Document_fillZ(const tomoto::DocumentBase* doc, int16_t* out)
+{
+#ifdef TM_HLDA
+	if (Document_HLDA_fillZ(doc, out)) return true;
+#endif
+#ifdef TM_HDP
+	if (Document_HDP_fillZ(doc, out)) return true;
+#endif
+	return Document_LDA_fillZ(doc, out);
+}
+
 static PyObject* Document_metadata(DocumentObject* self, void* closure)
 {
 	return py::handleExc([&]()
@@ -1219,6 +1864,9 @@ static PyGetSetDef UtilsDocument_getseters[] = {
 	{ (char*)"uid", (getter)DocumentObject::getUid, nullptr, Document_uid__doc__, nullptr },
 	{ (char*)"raw", (getter)DocumentObject::getRaw, nullptr, Document_raw__doc__, nullptr },
 	{ (char*)"span", (getter)DocumentObject::getSpan, nullptr, Document_span__doc__, nullptr },
+	{ (char*)"words_view", (getter)DocumentObject::getWordsView, nullptr, Document_words_view__doc__, nullptr },
+	{ (char*)"topics_view", (getter)DocumentObject::getTopicsView, nullptr, Document_topics_view__doc__, nullptr },
+	{ (char*)"count_by_topics_view", (getter)DocumentObject::getCountByTopicsView, nullptr, Document_count_by_topics_view__doc__, nullptr },
 #ifdef TM_DMR
 	{ (char*)"metadata", (getter)Document_metadata, nullptr, Document_metadata__doc__, nullptr },
 	{ (char*)"multi_metadata", (getter)Document_DMR_multiMetadata, nullptr, Document_multi_metadata__doc__, nullptr },
@@ -1678,7 +2326,68 @@ vector<size_t> insertCorpus(TopicModelObject* self, PyObject* _corpus, PyObject*
 	if (!PyObject_TypeCheck(_corpus, &UtilsCorpus_type)) throw py::ValueError{ "`corpus` must be an instance of `tomotopy.utils.Corpus`" };
 	auto corpus = (CorpusObject*)_corpus;
 	bool insert_into_empty = self->inst->updateVocab(corpus->getVocabDict().getRaw());
-	if (corpus->isIndependent())
+	auto miscConverter = ((TopicModelTypeObject*)self->ob_base.ob_type)->miscConverter;
+	if (corpus->isIndependent() && !miscConverter)
+	{
+		// documents need no misc data, so they are built in parallel from one flat buffer of word ids
+		vector<tomoto::Vid> words;
+		vector<size_t> offsets{ 0 };
+		offsets.reserve(corpus->docs.size() + 1);
+		for (auto& rdoc : corpus->docs) offsets.emplace_back(offsets.back() + rdoc.words.size());
+		words.resize(offsets.back());
+		for (size_t i = 0; i < corpus->docs.size(); ++i)
+		{
+			std::copy(corpus->docs[i].words.begin(), corpus->docs[i].words.end(), words.begin() + offsets[i]);
+		}
+
+		vector<tomoto::Vid> remap;
+		if (!insert_into_empty)
+		{
+			remap.resize(corpus->getVocabDict().size());
+			for (size_t v = 0; v < remap.size(); ++v)
+			{
+				remap[v] = corpus->getVocabDict().mapToNewDict(v, self->inst->getVocabDict());
+			}
+		}
+
+		tomoto::DocBatch batch;
+		batch.words = words.data();
+		batch.offsets = offsets.data();
+		batch.size = corpus->docs.size();
+		batch.vocabRemap = insert_into_empty ? nullptr : remap.data();
+		batch.fillKernel = [&](size_t i, tomoto::RawDocKernel& doc, const vector<uint32_t>& kept)
+		{
+			auto& rdoc = corpus->docs[i];
+			doc.weight = rdoc.weight;
+			doc.docUid = rdoc.docUid;
+			doc.rawStr = rdoc.rawStr;
+			if (doc.rawStr.empty() || kept.empty()) return;
+			doc.origWordPos.reserve(kept.size());
+			doc.origWordLen.reserve(kept.size());
+			for (auto j : kept)
+			{
+				doc.origWordPos.emplace_back(rdoc.origWordPos[j]);
+				doc.origWordLen.emplace_back(rdoc.origWordLen[j]);
+			}
+			char2Byte(doc.rawStr, doc.origWordPos, doc.origWordLen);
+		};
+
+		vector<size_t> ids;
+		{
+			py::GILReleaser nogil;
+			ids = self->inst->addDocs(batch, 0);
+		}
+		for (auto id : ids)
+		{
+			if (id == (size_t)-1)
+			{
+				fprintf(stderr, "Adding empty document was ignored.\n");
+				continue;
+			}
+			ret.emplace_back(id);
+		}
+	}
+	else if (corpus->isIndependent())
 	{
 		for (auto& rdoc : corpus->docs)
 		{
@@ -1708,7 +2417,6 @@ vector<size_t> insertCorpus(TopicModelObject* self, PyObject* _corpus, PyObject*
 			}
 
 			if (!doc.rawStr.empty()) char2Byte(doc.rawStr, doc.origWordPos, doc.origWordLen);
-			auto miscConverter = ((TopicModelTypeObject*)self->ob_base.ob_type)->miscConverter;
 			if (!miscConverter) doc.misc.clear();
 			else doc.misc = miscConverter(self, transformMisc(rdoc.misc, transform));
 			ret.emplace_back(self->inst->addDoc(doc));
@@ -1745,7 +2453,6 @@ vector<size_t> insertCorpus(TopicModelObject* self, PyObject* _corpus, PyObject*
 			}
 
 			if (!doc.rawStr.empty()) char2Byte(doc.rawStr, doc.origWordPos, doc.origWordLen);
-			auto miscConverter = ((TopicModelTypeObject*)self->ob_base.ob_type)->miscConverter;
 			if (!miscConverter) doc.misc.clear();
 			
 			else doc.misc = miscConverter(self, transformMisc(rdoc.makeMisc(corpus->tm->inst), transform));
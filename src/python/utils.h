@@ -2,6 +2,7 @@
 
 #include "../TopicModel/LDA.h"
 #include "../Utils/Dictionary.h"
+#include "../Utils/CountMinSketch.hpp"
 #include "module.h"
 #include "../Labeling/Phraser.hpp"
 
@@ -57,6 +58,10 @@ struct CorpusObject
 		TopicModelObject* tm;
 	};
 	bool made;
+	// while `counting`, words are only counted into `sketch`. After that, only the words whose estimated counts reach `prefilterCf` enter the vocabulary.
+	tomoto::CountMinSketch* sketch;
+	size_t prefilterCf;
+	bool counting;
 
 	inline bool isIndependent() const
 	{
@@ -76,7 +81,12 @@ struct CorpusObject
 	static void dealloc(CorpusObject* self);
 	static PyObject* getstate(CorpusObject* self, PyObject*);
 	static PyObject* setstate(CorpusObject* self, PyObject* args);
+	static PyObject* save(CorpusObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* load(CorpusObject* self, PyObject* args, PyObject* kwargs);
 	static PyObject* addDoc(CorpusObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* addRawDocs(CorpusObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* addTokenArrays(CorpusObject* self, PyObject* args, PyObject* kwargs);
+	static PyObject* setPrefilter(CorpusObject* self, PyObject* args, PyObject* kwargs);
 	static PyObject* extractNgrams(CorpusObject* self, PyObject* args, PyObject* kwargs);
 	static PyObject* concatNgrams(CorpusObject* self, PyObject* args, PyObject* kwargs);
 	static Py_ssize_t len(CorpusObject* self);
@@ -85,6 +95,12 @@ struct CorpusObject
 	static PyObject* iter(CorpusObject* self);
 
 	const tomoto::Dictionary& getVocabDict() const;
+
+	// appends `doc` with its uid and misc data given by `kwargs`
+	void appendDoc(tomoto::RawDoc&& doc, PyObject* kwargs);
+
+	// returns the id of `word` occurring `cnt` times, or `non_vocab_id` if it is counted only or filtered out by `sketch`
+	tomoto::Vid addWord(const std::string& word, size_t cnt = 1);
 };
 
 struct CorpusIterObject
@@ -174,6 +190,9 @@ struct DocumentObject
 	static PyObject* getSpan(DocumentObject* self, void* closure);
 	static PyObject* getWeight(DocumentObject* self, void* closure);
 	static PyObject* getUid(DocumentObject* self, void* closure);
+	static PyObject* getWordsView(DocumentObject* self, void* closure);
+	static PyObject* getTopicsView(DocumentObject* self, void* closure);
+	static PyObject* getCountByTopicsView(DocumentObject* self, void* closure);
 
 	static PyObject* getattro(DocumentObject* self, PyObject* attr);
 };
@@ -199,11 +218,30 @@ struct PhraserObject
 
 void addUtilsTypes(PyObject* gModule);
 
+/*
+documents given as a vocabulary and CSR arrays of token ids, for `add_token_arrays`.
+The arrays can be any objects convertible into NumPy arrays (e.g. Arrow arrays), which are used without copying if they are already int32 and int64.
+*/
+struct TokenArrays
+{
+	std::vector<std::string> vocabs;
+	py::UniqueObj tokenObj, offsetObj;
+	const int32_t* tokens = nullptr; // token ids into `vocabs`, -1 for a dropped token
+	std::vector<size_t> offsets; // tokens of the i-th document are in [offsets[i], offsets[i + 1])
+	std::vector<std::string> uids; // empty if not given
+	std::vector<uint32_t> usedVocabs; // the ids of `vocabs` used by the tokens, in the order of their first occurrences
+
+	// it validates the arguments and raises `ValueError` for wrong ones.
+	TokenArrays(PyObject* vocabs, PyObject* tokenIds, PyObject* offsets, PyObject* uids);
+
+	size_t size() const { return offsets.size() - 1; }
+};
+
 template<
 	template<tomoto::TermWeight tw> class DocTy, 
 	typename Fn
 >
-PyObject* docVisit(tomoto::DocumentBase* doc, Fn&& visitor)
+auto docVisit(tomoto::DocumentBase* doc, Fn&& visitor) -> decltype(visitor((DocTy<tomoto::TermWeight::one>*)nullptr))
 {
 	if (auto* d = dynamic_cast<DocTy<tomoto::TermWeight::one>*>(doc))
 	{
@@ -220,14 +258,14 @@ PyObject* docVisit(tomoto::DocumentBase* doc, Fn&& visitor)
 		return visitor(d);
 	}
 
-	return nullptr;
+	return {};
 }
 
 template<
 	template<tomoto::TermWeight tw> class DocTy,
 	typename Fn
 >
-PyObject* docVisit(const tomoto::DocumentBase* doc, Fn&& visitor)
+auto docVisit(const tomoto::DocumentBase* doc, Fn&& visitor) -> decltype(visitor((const DocTy<tomoto::TermWeight::one>*)nullptr))
 {
 	if (auto* d = dynamic_cast<const DocTy<tomoto::TermWeight::one>*>(doc))
 	{
@@ -244,7 +282,7 @@ PyObject* docVisit(const tomoto::DocumentBase* doc, Fn&& visitor)
 		return visitor(d);
 	}
 
-	return nullptr;
+	return {};
 }
 
 #define DEFINE_DOCUMENT_GETTER_PROTOTYPE(NAME) \
@@ -307,6 +345,12 @@ namespace py
 		}
 		return ret;
 	}
+
+	template<typename _Ty>
+	PyObject* buildPyValue(const tomoto::tvector<_Ty>& v, force_list_t)
+	{
+		return buildPyValue(v);
+	}
 }
 
 PyObject* Document_LDA_Z(DocumentObject* self, void* closure);
@@ -315,6 +359,15 @@ PyObject* Document_HDP_Z(DocumentObject* self, void* closure);
 
 PyObject* Document_HLDA_Z(DocumentObject* self, void* closure);
 
+// write the topics of `doc` in the order of its words into `out`, the same as `Document.topics`. They return false if `doc` isn't of their type.
+bool Document_LDA_fillZ(const tomoto::DocumentBase* doc, int16_t* out);
+
+bool Document_HDP_fillZ(const tomoto::DocumentBase* doc, int16_t* out);
+
+bool Document_HLDA_fillZ(const tomoto::DocumentBase* doc, int16_t* out);
+
+bool Document_fillZ(const tomoto::DocumentBase* doc, int16_t* out);
+
 PyObject* Document_DMR_metadata(DocumentObject* self, void* closure);
 PyObject* Document_DMR_multiMetadata(DocumentObject* self, void* closure);
 
@@ -364,6 +417,19 @@ PyObject* buildPyValueReorder(const _Target& target, const _Order& order)
 	}
 }
 
+template<typename _Target, typename _Order, typename _Out, typename _Tx>
+void fillReorder(const _Target& target, const _Order& order, _Out* out, _Tx&& transformer)
+{
+	if (order.empty())
+	{
+		for (auto& t : target) *out++ = transformer(t);
+	}
+	else
+	{
+		for (auto idx : order) *out++ = transformer(target[idx]);
+	}
+}
+
 template<typename _Target, typename _Order, typename _Tx>
 PyObject* buildPyValueReorder(const _Target& target, const _Order& order, _Tx&& transformer)
 {
@@ -383,3 +449,4 @@ PyObject* buildPyValueReorder(const _Target& target, const _Order& order, _Tx&&
 
 std::vector<size_t> insertCorpus(TopicModelObject* self, PyObject* corpus, PyObject* transform);
 CorpusObject* makeCorpus(TopicModelObject* self, PyObject* _corpus, PyObject* transform);
+tomoto::RawDoc::MiscType transformMisc(const tomoto::RawDoc::MiscType& misc, PyObject* transform);
@@ -11,7 +11,7 @@ model_cases = [
     (tp.PLDAModel, curpath + '/sample_with_md.txt', 1, lambda x:x, {'latent_topics':2, 'topics_per_label':2}, None),
     (tp.HLDAModel, curpath + '/sample.txt', 0, None, {'depth':3}, None),
     (tp.CTModel, curpath + '/sample.txt', 0, None, {'k':10}, None),
-    (tp.HDPModel, curpath + '/sample.txt', 0, None, {'initial_k':10}, [tp.ParallelScheme.COPY_MERGE]),
+    (tp.HDPModel, curpath + '/sample.txt', 0, None, {'initial_k':10}, [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]),
     (tp.MGLDAModel, curpath + '/sample.txt', 0, None, {'k_g':5, 'k_l':5}, None),
     (tp.PAModel, curpath + '/sample.txt', 0, None, {'k1':5, 'k2':10}, [tp.ParallelScheme.COPY_MERGE]),
     (tp.HPAModel, curpath + '/sample.txt', 0, None, {'k1':5, 'k2':10}, [tp.ParallelScheme.COPY_MERGE]),
@@ -39,7 +39,7 @@ model_raw_cases = [
     (tp.LDAModel, curpath + '/sample_raw.txt', 0, None, {'k':10}, None),
     (tp.HLDAModel, curpath + '/sample_raw.txt', 0, None, {'depth':3}, None),
     (tp.CTModel, curpath + '/sample_raw.txt', 0, None, {'k':10}, None),
-    (tp.HDPModel, curpath + '/sample_raw.txt', 0, None, {'initial_k':10}, [tp.ParallelScheme.COPY_MERGE]),
+    (tp.HDPModel, curpath + '/sample_raw.txt', 0, None, {'initial_k':10}, [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]),
     (tp.MGLDAModel, curpath + '/sample_raw.txt', 0, None, {'k_g':5, 'k_l':5}, None),
     (tp.PAModel, curpath + '/sample_raw.txt', 0, None, {'k1':5, 'k2':10}, [tp.ParallelScheme.COPY_MERGE]),
     (tp.HPAModel, curpath + '/sample_raw.txt', 0, None, {'k1':5, 'k2':10}, [tp.ParallelScheme.COPY_MERGE]),
@@ -53,7 +53,7 @@ model_corpus_cases = [
     (tp.PLDAModel, curpath + '/sample_with_md.txt', 1, lambda x:{'labels':x}, {'latent_topics':2, 'topics_per_label':2}, None),
     (tp.HLDAModel, curpath + '/sample.txt', 0, None, {'depth':3}, None),
     (tp.CTModel, curpath + '/sample.txt', 0, None, {'k':10}, None),
-    (tp.HDPModel, curpath + '/sample.txt', 0, None, {'initial_k':10}, [tp.ParallelScheme.COPY_MERGE]),
+    (tp.HDPModel, curpath + '/sample.txt', 0, None, {'initial_k':10}, [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]),
     (tp.MGLDAModel, curpath + '/sample.txt', 0, None, {'k_g':5, 'k_l':5}, None),
     (tp.PAModel, curpath + '/sample.txt', 0, None, {'k1':5, 'k2':10}, [tp.ParallelScheme.COPY_MERGE]),
     (tp.HPAModel, curpath + '/sample.txt', 0, None, {'k1':5, 'k2':10}, [tp.ParallelScheme.COPY_MERGE]),
@@ -155,6 +155,10 @@ def save_and_load(cls, inputFile, mdFields, f, kargs, ps):
     mdl = cls.loads(bytearr)
     mdl.train(20, parallel=ps)
 
+    mdl.save('test.model.{}.aligned.bin'.format(cls.__name__), aligned=True)
+    mdl = cls.load('test.model.{}.aligned.bin'.format(cls.__name__), mmap=True)
+    mdl.train(20, parallel=ps)
+
 def copy_train(cls, inputFile, mdFields, f, kargs, ps):
     print('Test copy & train')
     tw = 0
@@ -395,6 +399,13 @@ def test_estimate_SLDA_PARTITION(cls=tp.SLDAModel, inputFile=curpath + '/sample_
     mdl.infer(unseen_docs, parallel=ps)
     mdl.estimate(unseen_docs)
 
+    # the batched estimates are the same as those of each document
+    import numpy as np
+    batch = mdl.estimate_batch(unseen_docs, workers=2)
+    assert batch.shape == (len(unseen_docs), mdl.f)
+    assert np.allclose(batch, np.array(mdl.estimate(unseen_docs)), atol=1e-5)
+    assert np.allclose(mdl.estimate_batch(mdl.docs, workers=4), np.array(mdl.estimate(mdl.docs)), atol=1e-5)
+
 def test_auto_labeling():
     from nltk.stem.porter import PorterStemmer
     from nltk.corpus import stopwords
@@ -425,6 +436,10 @@ def test_auto_labeling():
     cands = extractor.extract(mdl)
 
     labeler = tp.label.FoRelevance(mdl, cands, min_df=3, smoothing=1e-2, mu=0.25, workers=1)
+    all_labels = labeler.get_all_topic_labels(top_n=5)
+    assert len(all_labels) == mdl.k
+    for k in range(mdl.k):
+        assert all_labels[k] == labeler.get_topic_labels(k, top_n=5)
     for k in range(mdl.k):
         print("== Topic #{} ==".format(k))
         print("Labels:", ', '.join(label for label, score in labeler.get_topic_labels(k, top_n=5)))
@@ -511,6 +526,1454 @@ def test_hdp_to_lda():
         for word, prob in lda.get_topic_words(k):
             print('\t', word, prob, sep='\t')
 
+def test_hdp_partition():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.HDPModel(tw=tw, min_df=5, rm_top=5, initial_k=5, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        for _ in range(10):
+            mdl.train(10, workers=4, parallel=tp.ParallelScheme.PARTITION)
+            assert np.isfinite(mdl.ll_per_word)
+            assert (np.array(mdl.get_count_by_topics()) >= 0).all()
+            assert all(mdl.is_live_topic(t) for doc in mdl.docs[::20] for t in set(doc.topics) if t >= 0)
+
+def test_hdp_to_lda_move():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.HDPModel(tw=tw, min_df=5, rm_top=5, initial_k=5, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(200)
+        copied, mapping = mdl.convert_to_lda(topic_threshold=1e-2)
+        source = mdl.copy()
+        moved, mapping2 = source.convert_to_lda(topic_threshold=1e-2, move_docs=True)
+        assert list(mapping) == list(mapping2)
+        for use in (lambda: source.train(1), lambda: source.docs, lambda: source.k):
+            try:
+                use()
+            except RuntimeError:
+                pass
+            else:
+                raise AssertionError("the model whose documents were moved should raise")
+        for i in range(0, len(mdl.docs), 50):
+            hdp_topics = [mapping[t] if t >= 0 else -1 for t in mdl.docs[i].topics]
+            assert list(copied.docs[i].topics) == list(moved.docs[i].topics)
+            assert all(a == b for a, b in zip(hdp_topics, copied.docs[i].topics) if a >= 0)
+        assert sum(copied.get_count_by_topics()) == sum(moved.get_count_by_topics())
+        copied.train(10)
+        moved.train(10)
+
+def test_sparse_sampling():
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        for ps in (tp.ParallelScheme.NONE, tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION):
+            mdl = tp.LDAModel(tw=tw, k=40, min_df=2, rm_top=2)
+            mdl.sampling_method = tp.SamplingMethod.SPARSE
+            for n, line in enumerate(open(curpath + '/sample.txt', encoding='utf-8')):
+                ch = line.strip().split()
+                mdl.add_doc(ch)
+            mdl.train(200, workers=2, parallel=ps)
+            print('Sparse sampling with {} {}\tLog-likelihood: {}'.format(tw.name, ps.name, mdl.ll_per_word))
+            mdl.infer(mdl.make_doc(ch))
+
+    mdl = tp.DMRModel(k=10)
+    try:
+        mdl.sampling_method = tp.SamplingMethod.SPARSE
+    except Exception:
+        pass
+    else:
+        raise AssertionError("DMRModel doesn't support SamplingMethod.SPARSE")
+
+def test_mh_sampling():
+    cases = [
+        (tp.LDAModel, curpath + '/sample.txt', 0, None, {'k':40}),
+        (tp.LLDAModel, curpath + '/sample_with_md.txt', 1, lambda x:x, {'k':5}),
+        (tp.PLDAModel, curpath + '/sample_with_md.txt', 1, lambda x:x, {'latent_topics':2, 'topics_per_label':2}),
+        (tp.DMRModel, curpath + '/sample_with_md.txt', 1, lambda x:'_'.join(x), {'k':10}),
+    ]
+    for cls, inputFile, mdFields, f, kargs in cases:
+        for ps in (tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION):
+            mdl = cls(tw=tp.TermWeight.IDF, min_df=2, rm_top=2, **kargs)
+            mdl.sampling_method = tp.SamplingMethod.MH
+            for n, line in enumerate(open(inputFile, encoding='utf-8')):
+                ch = line.strip().split()
+                if len(ch) < mdFields + 1: continue
+                if mdFields: mdl.add_doc(ch[mdFields:], f(ch[:mdFields]))
+                else: mdl.add_doc(ch)
+            mdl.train(200, workers=2, parallel=ps)
+            print('MH sampling with {} {}\tLog-likelihood: {}'.format(cls.__name__, ps.name, mdl.ll_per_word))
+            if mdFields: mdl.infer(mdl.make_doc(ch[mdFields:], f(ch[:mdFields])))
+            else: mdl.infer(mdl.make_doc(ch))
+
+    mdl = tp.GDMRModel(k=10, degrees=[3])
+    try:
+        mdl.sampling_method = tp.SamplingMethod.MH
+    except Exception:
+        pass
+    else:
+        raise AssertionError("GDMRModel doesn't support SamplingMethod.MH")
+
+def test_train_callback():
+    mdl = tp.LDAModel(k=10, min_df=2, rm_top=2)
+    for n, line in enumerate(open(curpath + '/sample.txt', encoding='utf-8')):
+        ch = line.strip().split()
+        mdl.add_doc(ch)
+
+    history = []
+    def callback(progress):
+        history.append(progress)
+        return progress['iteration'] < 50
+    mdl.train(100, callback=callback, callback_interval=10)
+    assert [p['iteration'] for p in history] == [10, 20, 30, 40, 50]
+    assert mdl.global_step == 50
+
+    handle = tp.TrainingHandle(mdl, 100000, callback=lambda p: print(p['global_step'], p['ll_per_word']), callback_interval=100)
+    handle.cancel()
+    assert handle.wait(60)
+    assert mdl.global_step < 100050
+
+    def failing_callback(progress):
+        raise ValueError()
+    try:
+        mdl.train(10, callback=failing_callback)
+    except ValueError:
+        pass
+    else:
+        raise AssertionError("the exception from callback should be propagated")
+
+    import threading
+    started, resume = threading.Event(), threading.Event()
+    def blocking_callback(progress):
+        started.set()
+        resume.wait(60)
+        # reading in the callback is allowed, but modifying is not
+        assert mdl.k == 10
+        try:
+            mdl.add_doc(['new', 'doc'])
+        except RuntimeError:
+            pass
+        else:
+            raise AssertionError("add_doc() during train() should raise")
+    handle = tp.TrainingHandle(mdl, 10, callback=blocking_callback, callback_interval=5)
+    assert started.wait(60)
+    try:
+        mdl.k
+    except RuntimeError:
+        pass
+    else:
+        raise AssertionError("the model shouldn't be accessed from another thread during train()")
+    resume.set()
+    assert handle.wait(60)
+    assert mdl.k == 10
+
+def test_export_inference():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF, tp.TermWeight.PMI):
+        mdl = tp.LDAModel(tw=tw, k=10, min_df=2, rm_top=2, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(200)
+        for dtype in ('float32', 'float16', 'uint16'):
+            mdl.export_inference('test.inference.bin', dtype=dtype)
+            im = tp.InferenceModel.load('test.inference.bin')
+            assert im.k == mdl.k and im.dtype == dtype and im.tw == tw
+            assert im.vocabs == list(mdl.used_vocabs)
+            dist, ll = im.infer(docs[0], seed=1)
+            assert dist.shape == (mdl.k,) and abs(dist.sum() - 1) < 1e-4
+            dists, lls = im.infer(docs[:5], workers=2, seed=1)
+            assert len(dists) == 5 and np.allclose(dists[0], dist) and lls[0] == ll
+
+    try:
+        tp.HDPModel(min_df=2).export_inference('test.inference.bin')
+    except Exception:
+        pass
+    else:
+        raise AssertionError("only LDAModel supports export_inference")
+
+def test_inference_session():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10, min_df=2, rm_top=2)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(100)
+    session = mdl.make_inference_session(workers=2)
+    assert session.workers == 2 and session.model is mdl
+    for i in range(0, len(docs), 4):
+        batch = [mdl.make_doc(ch) for ch in docs[i:i + 4]]
+        dists, lls = session.infer(batch, iter=20)
+        assert len(dists) == len(batch) and len(lls) == len(batch)
+    dist, ll = session.infer(mdl.make_doc(docs[0]), together=True)
+    assert len(dist) == mdl.k
+    del mdl
+    session.infer(session.model.make_doc(docs[0]))
+
+def test_online_lda():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.OnlineLDAModel(k=10, total_docs=len(docs), seed=42)
+    for i in range(0, len(docs), 64):
+        ll = mdl.partial_fit(docs[i:i + 64], workers=2)
+        assert np.isfinite(ll)
+    assert mdl.num_docs == len(docs) and mdl.num_updates == (len(docs) + 63) // 64
+    assert len(mdl.get_topic_words(0, top_n=5)) == 5
+    assert abs(mdl.get_topic_word_dist(0).sum() - 1) < 1e-3
+    dist, ll = mdl.infer(docs[0])
+    assert dist.shape == (mdl.k,) and abs(dist.sum() - 1) < 1e-4
+    dists, lls = mdl.infer(docs[:5], workers=2)
+    assert np.allclose(dists[0], dist)
+
+    # the first update takes the whole step without overshooting even if tau0 is 0
+    zero = tp.OnlineLDAModel(k=10, tau0=0, seed=42)
+    for i in range(0, 256, 64):
+        assert np.isfinite(zero.partial_fit(docs[i:i + 64]))
+    for k in range(zero.k):
+        dist = zero.get_topic_word_dist(k)
+        assert np.isfinite(dist).all() and (dist >= 0).all()
+
+    mdl.save('test.online.bin')
+    loaded = tp.OnlineLDAModel.load('test.online.bin')
+    assert loaded.vocabs == mdl.vocabs and loaded.num_updates == mdl.num_updates
+    assert np.allclose(loaded.get_topic_word_dist(3), mdl.get_topic_word_dist(3))
+
+    # warm start from a model trained by Gibbs sampling
+    lda = tp.LDAModel(k=10, min_df=2, rm_top=2, seed=42)
+    for ch in docs[:len(docs) // 2]: lda.add_doc(ch)
+    lda.train(100)
+    mdl = tp.OnlineLDAModel.from_model(lda)
+    assert mdl.k == lda.k and mdl.vocabs == list(lda.used_vocabs) and mdl.num_docs == len(lda.docs)
+    mdl.partial_fit(docs[len(docs) // 2:], workers=2)
+
+def test_freeze_interval():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for ps in [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]:
+        mdl = tp.LDAModel(k=10, min_df=2, rm_top=2, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(100, workers=2, parallel=ps)
+        mdl.freeze_interval = 5
+        assert mdl.freeze_interval == 5
+        mdl.train(50, workers=2, parallel=ps)
+        ll = mdl.ll_per_word
+        assert ll < 0
+        mdl.freeze_interval = 0
+        mdl.train(5, workers=2, parallel=ps)
+        mdl.infer(mdl.docs[0])
+
+def test_cvb0_lda():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for top_k in [0, 4]:
+        mdl = tp.CVB0LDAModel(k=10, top_k=top_k, seed=42)
+        for ch in docs[:len(docs) // 2]: mdl.add_doc(ch)
+        mdl.train(1, workers=2)
+        ll = mdl.ll_per_word
+        mdl.train(20, workers=2)
+        assert mdl.global_step == 21 and mdl.ll_per_word > ll
+        assert abs(mdl.get_topic_word_dist(0).sum() - 1) < 1e-3
+        assert abs(mdl.get_doc_topic_dist(0).sum() - 1) < 1e-3
+
+        # documents added later join the next training
+        for ch in docs[len(docs) // 2:]: mdl.add_doc(ch)
+        mdl.train(5, workers=2)
+        assert mdl.num_docs == len(docs)
+        dist, ll = mdl.infer(docs[0])
+        assert dist.shape == (mdl.k,) and abs(dist.sum() - 1) < 1e-4
+        dists, lls = mdl.infer(docs[:5], workers=2)
+        assert np.allclose(dists[0], dist)
+
+        mdl.save('test.cvb0.bin')
+        loaded = tp.CVB0LDAModel.load('test.cvb0.bin')
+        assert loaded.vocabs == mdl.vocabs and loaded.top_k == top_k and loaded.num_words == mdl.num_words
+        assert abs(loaded.ll_per_word - mdl.ll_per_word) < 1e-5
+        assert np.allclose(loaded.get_topic_word_dist(3), mdl.get_topic_word_dist(3))
+
+def test_multi_chain_lda():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.MultiChainLDAModel(k=[5, 10], chains_per_k=2, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(40, workers=2)
+    assert mdl.num_chains == 4 and mdl.k == [5, 5, 10, 10] and mdl.global_step == 40
+    for c in range(mdl.num_chains):
+        history = mdl.get_ll_history(c)
+        assert len(history) == 40 and history[-1] > history[0]
+        assert abs(mdl.get_topic_word_dist(c, 0).sum() - 1) < 1e-3
+        assert abs(mdl.get_doc_topic_dist(c, 0).sum() - 1) < 1e-3
+    assert mdl.rhat([0, 1]) >= 0 and mdl.rhat([2, 3], window=10) >= 0
+    try:
+        mdl.rhat([1, 2])
+        raise AssertionError("chains with different k must be rejected")
+    except ValueError:
+        pass
+
+    # more workers than chains split the documents of each chain
+    mdl.train(5, workers=8)
+    mdl.save('test.multichain.bin')
+    loaded = tp.MultiChainLDAModel.load('test.multichain.bin')
+    assert loaded.vocabs == mdl.vocabs and loaded.k == mdl.k and loaded.num_words == mdl.num_words
+    assert loaded.ll_per_word == mdl.ll_per_word
+    assert np.allclose(loaded.get_topic_word_dist(3, 2), mdl.get_topic_word_dist(3, 2))
+
+def test_doc_index():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(100, workers=1)
+    thetas = mdl.get_doc_topic_dists()
+    for metric in tp.DocMetric:
+        index = tp.DocIndex(mdl, metric=metric, workers=2, seed=42)
+        assert index.num_docs == len(mdl.docs) and index.k == mdl.k and index.metric == metric
+
+        # scanning all lists finds the exact neighbours, which include the document itself
+        ids, dists = index.search(thetas[:20], top_n=5, n_probe=index.n_lists, workers=2)
+        assert ids.shape == (20, 5) and all(i in ids[i] for i in range(20))
+        assert (np.diff(dists, axis=1) >= 0).all()
+        one_ids, one_dists = index.search(thetas[3], top_n=5, n_probe=index.n_lists)
+        assert (one_ids == ids[3]).all()
+
+        same = tp.DocIndex(thetas, metric=metric, workers=1, seed=42)
+        assert (same.search(thetas[:20], top_n=5, n_probe=same.n_lists)[0] == ids).all()
+
+        index.save('test.docindex.bin')
+        loaded = tp.DocIndex.load('test.docindex.bin')
+        assert loaded.n_lists == index.n_lists and (loaded.search(thetas[:20], top_n=5)[0] == index.search(thetas[:20], top_n=5)[0]).all()
+
+def test_held_out_ll():
+    import math
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs[:-20]: mdl.add_doc(ch)
+    mdl.train(100, workers=1)
+    held_out = [mdl.make_doc(ch) for ch in docs[-20:]]
+    for method in tp.HeldOutEstimator:
+        lls = mdl.estimate_held_out_ll(held_out, method=method, particles=5, workers=1, seed=42)
+        assert len(lls) == len(held_out) and all(math.isfinite(ll) for ll in lls)
+        # the result doesn't depend on the number of workers
+        assert mdl.estimate_held_out_ll(held_out, method=method, particles=5, workers=4, seed=42) == lls
+        assert mdl.estimate_held_out_ll(held_out[0], method=method, particles=5, seed=42) == lls[0]
+
+def test_dense_vocab_size():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for ps in [tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION]:
+        mdl = tp.LDAModel(k=10, min_df=2, rm_top=2)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.dense_vocab_size = 100
+        mdl.train(100, workers=2, parallel=ps)
+        ll = mdl.ll_per_word
+        # changing the layout keeps the counts
+        mdl.dense_vocab_size = 0
+        assert abs(mdl.ll_per_word - ll) < 1e-5
+        mdl.dense_vocab_size = 50
+        mdl.train(10, workers=2, parallel=ps)
+        mdl.infer(mdl.make_doc(docs[0]))
+        mdl.save('test.lda.bin')
+        mdl = tp.LDAModel.load('test.lda.bin')
+        assert mdl.dense_vocab_size == 0
+        mdl.infer(mdl.make_doc(docs[0]))
+
+def test_compact():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.IDF, tp.TermWeight.PMI):
+        for sm in (tp.SamplingMethod.DENSE, tp.SamplingMethod.SPARSE):
+            mdl = tp.LDAModel(tw=tw, k=10, min_df=2, rm_top=2, compact=True)
+            assert mdl.compact
+            mdl.sampling_method = sm
+            for ch in docs: mdl.add_doc(ch)
+            mdl.train(100, workers=2)
+            ll = mdl.ll_per_word
+            mdl.save('test.lda.bin')
+            mdl = tp.LDAModel.load('test.lda.bin')
+            assert mdl.compact and abs(mdl.ll_per_word - ll) < 1e-5
+            mdl.train(10, workers=2)
+            mdl.infer(mdl.make_doc(docs[0]))
+
+    # the weights computed from the frequencies are the same as the stored ones
+    lls = []
+    for compact in (False, True):
+        mdl = tp.LDAModel(tw=tp.TermWeight.PMI, k=10, min_df=2, rm_top=2, seed=42, compact=compact)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(20, workers=1)
+        lls.append(mdl.ll_per_word)
+    assert abs(lls[0] - lls[1]) < 1e-4
+
+def test_doc_order():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for order in (tp.DocOrder.VOCAB_BLOCK, tp.DocOrder.LENGTH, tp.DocOrder.WORD_MAJOR):
+        mdl = tp.LDAModel(k=10, min_df=2, rm_top=2)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.doc_order = order
+        assert mdl.doc_order == order
+        mdl.train(100, workers=2, parallel=tp.ParallelScheme.PARTITION)
+        assert len(mdl.docs) == len(docs)
+        mdl.doc_order = tp.DocOrder.SHUFFLED
+        mdl.train(10, workers=2, parallel=tp.ParallelScheme.PARTITION)
+
+def test_word_major_order():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.LDAModel(tw=tw, k=10, min_df=2, rm_top=2)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.doc_order = tp.DocOrder.WORD_MAJOR
+        mdl.train(0)
+        ll = mdl.ll_per_word
+        for workers in (1, 2, 3):
+            mdl.train(20, workers=workers, parallel=tp.ParallelScheme.PARTITION)
+        assert mdl.ll_per_word > ll
+        if tw == tp.TermWeight.ONE:
+            assert sum(mdl.get_count_by_topics()) == mdl.num_words
+
+def test_numa_aware():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for ps in (tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION):
+        mdl = tp.LDAModel(k=10, min_df=2, rm_top=2, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.numa_aware = True
+        assert mdl.numa_aware
+        mdl.train(50, workers=2, parallel=ps)
+        ll = mdl.ll_per_word
+        mdl.numa_aware = False
+        assert abs(mdl.ll_per_word - ll) < 1e-5
+        mdl.train(10, workers=2, parallel=ps)
+
+def test_out_of_core():
+    import tempfile
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    with tempfile.TemporaryDirectory() as tmpdir:
+        for ps in (tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION):
+            mdl = tp.LDAModel(tw=tp.TermWeight.IDF, k=10, min_df=2, rm_top=2, seed=42)
+            for ch in docs: mdl.add_doc(ch)
+            mdl.out_of_core_dir = tmpdir
+            assert mdl.out_of_core_dir == tmpdir
+            mdl.train(50, workers=2, parallel=ps)
+            ll = mdl.ll_per_word
+            copied = mdl.copy()
+            assert abs(copied.ll_per_word - ll) < 1e-5
+            # moving the documents into memory keeps the state
+            mdl.out_of_core_dir = None
+            assert abs(mdl.ll_per_word - ll) < 1e-5
+            mdl.train(10, workers=2, parallel=ps)
+            copied.train(10, workers=2, parallel=ps)
+            copied.infer(copied.make_doc(docs[0]))
+            del copied
+        mdl = tp.PTModel(k=10, p=100)
+        try:
+            mdl.out_of_core_dir = tmpdir
+            assert False
+        except RuntimeError:
+            pass
+
+def test_add_doc_after_train():
+    import tempfile
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    half = len(docs) // 2
+    with tempfile.TemporaryDirectory() as tmpdir:
+        for tw, ooc in ((tp.TermWeight.ONE, False), (tp.TermWeight.IDF, False), (tp.TermWeight.PMI, True)):
+            mdl = tp.LDAModel(tw=tw, k=10, min_df=2, rm_top=2, seed=42)
+            for ch in docs[:half]: mdl.add_doc(ch)
+            if ooc: mdl.out_of_core_dir = tmpdir
+            mdl.train(20, workers=2)
+            num_vocabs = len(mdl.used_vocabs)
+            mdl.new_doc_sweeps = 5
+            for ch in docs[half:]: mdl.add_doc(ch)
+            mdl.train(20, workers=2)
+            assert len(mdl.docs) == len(docs)
+            assert len(mdl.used_vocabs) >= num_vocabs
+            assert len(mdl.docs[-1].get_topic_dist()) == 10
+            copied = mdl.copy()
+            assert abs(copied.ll_per_word - mdl.ll_per_word) < 1e-5
+            mdl.save('test.lda.bin')
+            mdl = tp.LDAModel.load('test.lda.bin')
+            assert abs(copied.ll_per_word - mdl.ll_per_word) < 1e-5
+    mdl = tp.PTModel(k=10, p=100)
+    for ch in docs[:half]: mdl.add_doc(ch)
+    mdl.train(5)
+    try:
+        mdl.add_doc(docs[-1])
+        assert False
+    except RuntimeError:
+        pass
+
+def test_distributed_sync():
+    import threading
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    vocabs = sorted(set(w for d in docs for w in d))
+    barrier = threading.Barrier(2)
+    sent = [None, None]
+    def make_exchange(node):
+        def exchange(vids, tids, counts):
+            sent[node] = (vids, tids, counts)
+            barrier.wait()
+            ret = tuple(np.concatenate([s[i] for s in sent]) for i in range(3))
+            barrier.wait()
+            return ret
+        return exchange
+
+    mdls = []
+    for node, ps in enumerate((tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION)):
+        mdl = tp.LDAModel(k=10, seed=42)
+        mdl.set_distributed_sync(vocabs, make_exchange(node))
+        for ch in docs[node::2]: mdl.add_doc(ch)
+        mdls.append((mdl, ps))
+    threads = [threading.Thread(target=mdl.train, args=(20,), kwargs=dict(workers=2, parallel=ps)) for mdl, ps in mdls]
+    for t in threads: t.start()
+    for t in threads: t.join()
+    # all nodes agree on the topic-word distributions
+    dists = []
+    for mdl, _ in mdls:
+        order = np.argsort(mdl.used_vocabs)
+        dists.append(np.array([mdl.get_topic_word_dist(k)[order] for k in range(mdl.k)]))
+    assert np.allclose(dists[0], dists[1])
+    mdl = tp.PTModel(k=10, p=100)
+    try:
+        mdl.set_distributed_sync(vocabs, make_exchange(0))
+        assert False
+    except RuntimeError:
+        pass
+
+def test_ll_sample_docs():
+    mdl = tp.LDAModel(k=10, seed=42)
+    for line in open(curpath + '/sample.txt', encoding='utf-8'):
+        mdl.add_doc(line.strip().split())
+    mdl.train(50, workers=2)
+    full = mdl.ll_per_word
+    # the evaluation in parallel gives the same value as a copy without workers
+    assert abs(mdl.copy().ll_per_word - full) < 1e-6
+    mdl.ll_sample_docs = len(mdl.docs) // 4
+    est = mdl.ll_per_word
+    assert est == mdl.ll_per_word
+    assert abs(est - full) < abs(full) * 0.2
+    mdl.ll_sample_docs = 0
+    assert mdl.ll_per_word == full
+
+def test_incremental_ll():
+    mdl = tp.LDAModel(k=10, seed=42)
+    for line in open(curpath + '/sample.txt', encoding='utf-8'):
+        mdl.add_doc(line.strip().split())
+    mdl.incremental_ll = True
+    for _ in range(5):
+        mdl.train(10, workers=1)
+        full = mdl.copy()
+        full.incremental_ll = False
+        assert abs(mdl.ll_per_word - full.ll_per_word) < abs(full.ll_per_word) * 1e-5
+    try:
+        tp.PTModel(k=10, p=100).incremental_ll = True
+        assert False
+    except RuntimeError:
+        pass
+
+def test_word_prior_and_optim_eta():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.LDAModel(tw=tw, k=10, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        words = list(dict.fromkeys(w for ch in docs for w in ch))[:5]
+        for i, w in enumerate(words):
+            mdl.set_word_prior(w, [1.0 if k == i else 0.001 for k in range(10)])
+        mdl.optim_eta = True
+        mdl.train(50, workers=2)
+        assert mdl.eta != 0.01
+        # the words without their own priors share the optimized eta
+        used = list(mdl.used_vocabs)
+        assert mdl.get_word_prior(words[0])[0] == 1.0
+        assert abs(mdl.get_word_prior(used[-1])[0] - mdl.eta) < 1e-6
+        w = used.index(words[0])
+        assert mdl.get_topic_word_dist(0)[w] > mdl.get_topic_word_dist(1)[w]
+
+        full = mdl.copy()
+        full.incremental_ll = True
+        assert abs(mdl.ll_per_word - full.ll_per_word) < abs(full.ll_per_word) * 1e-5
+        loaded = tp.LDAModel.loads(mdl.saves())
+        assert abs(mdl.ll_per_word - loaded.ll_per_word) < abs(mdl.ll_per_word) * 1e-5
+
+    try:
+        tp.PTModel(k=10, p=100).optim_eta = True
+        assert False
+    except RuntimeError:
+        pass
+
+def test_reproducible():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    results = []
+    for workers, parallel, sampling in ((1, tp.ParallelScheme.NONE, tp.SamplingMethod.DENSE), 
+        (2, tp.ParallelScheme.COPY_MERGE, tp.SamplingMethod.DENSE), (4, tp.ParallelScheme.PARTITION, tp.SamplingMethod.DENSE),
+        (1, tp.ParallelScheme.DEFAULT, tp.SamplingMethod.MH), (3, tp.ParallelScheme.DEFAULT, tp.SamplingMethod.MH)):
+        mdl = tp.LDAModel(k=10, seed=42)
+        mdl.sampling_method = sampling
+        for ch in docs: mdl.add_doc(ch)
+        mdl.reproducible = True
+        mdl.train(50, workers=workers, parallel=parallel)
+        results.append((sampling, [list(mdl.get_topic_word_dist(k)) for k in range(mdl.k)], mdl.ll_per_word))
+    for (s1, d1, l1), (s2, d2, l2) in zip(results, results[1:]):
+        if s1 != s2: continue
+        assert d1 == d2
+        assert l1 == l2
+
+    try:
+        tp.DMRModel(k=10).reproducible = True
+        assert False
+    except RuntimeError:
+        pass
+
+def test_train_stats():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(20, workers=2, parallel=tp.ParallelScheme.COPY_MERGE)
+    stats = mdl.train_stats
+    assert stats['iterations'] == 20
+    assert stats['tokens'] == mdl.num_words * 20
+    assert stats['sampling'] > 0 and stats['merge_bytes'] > 0
+    phases = sum(stats[k] for k in ('sampling', 'merging', 'global_sampling', 'global_level', 'distributing', 'optimizing'))
+    assert phases <= stats['elapsed'] * 1.01
+    assert len(stats['worker_busy']) == 2 and len(stats['worker_idle']) == 2
+    mdl.train(5, workers=1)
+    assert mdl.train_stats['iterations'] == 5
+
+def test_trace():
+    import json
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.tracing = True
+    assert mdl.tracing
+    for ps in (tp.ParallelScheme.COPY_MERGE, tp.ParallelScheme.PARTITION):
+        mdl.train(5, workers=2, parallel=ps)
+        mdl.save_trace('test.trace.json')
+        events = json.load(open('test.trace.json'))['traceEvents']
+        phases = [e for e in events if e.get('cat') == 'phase' and e['name'] == 'sampling']
+        assert len(phases) == 5 and all(e['tid'] == 0 for e in phases)
+        work = [e for e in events if e.get('cat') in ('task', 'chunk')]
+        assert {e['tid'] for e in work} <= {1, 2} and work
+        assert all(e['args']['wait_us'] >= 0 for e in work)
+
+    mdl.tracing = False
+    mdl.train(1, workers=2)
+    try:
+        mdl.save_trace('test.trace.json')
+        raise AssertionError("an untraced training should raise RuntimeError")
+    except RuntimeError:
+        pass
+
+def test_memory_usage():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10)
+    for ch in docs: mdl.add_doc(ch)
+    single = mdl.estimate_train_memory(workers=1)
+    multi = mdl.estimate_train_memory(workers=4, parallel=tp.ParallelScheme.COPY_MERGE)
+    usage = mdl.memory_usage
+    assert usage['globalState'] > 0 and usage['docs.words'] > 0 and usage['dictionary'] > 0
+    assert single == sum(usage.values())
+    assert multi > single + usage['globalState']
+    mdl.train(10, workers=2, parallel=tp.ParallelScheme.COPY_MERGE)
+    usage = mdl.memory_usage
+    assert usage['localData[0]'] > 0 and 'localData[2]' not in usage
+
+    mdl = tp.HLDAModel(depth=3)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(5, workers=1)
+    assert mdl.memory_usage['nodeTrees'] > 0
+
+def test_auto_scheme():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(20, workers=4, parallel=tp.ParallelScheme.AUTO)
+    stats = mdl.train_stats
+    assert stats['iterations'] == 20 and mdl.global_step == 20
+    tried = [t for t in stats['tuning'] if t['sec_per_iter'] >= 0]
+    assert tried
+    best = min(tried, key=lambda t: t['sec_per_iter'])
+    assert stats['scheme'] == best['scheme']
+    mdl.train(5, workers=4, parallel=tp.ParallelScheme.AUTO)
+    assert mdl.train_stats['tuning'] == [] and mdl.train_stats['scheme'] == best['scheme']
+
+    mdl = tp.LDAModel(k=10)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.auto_memory_limit = 1
+    mdl.train(10, workers=4, parallel=tp.ParallelScheme.AUTO)
+    assert all(t['sec_per_iter'] == -1 for t in mdl.train_stats['tuning'])
+    assert mdl.train_stats['iterations'] == 10
+
+def test_bulk_dists():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for cls, kargs in [(tp.LDAModel, {'k': 10}), (tp.PAModel, {'k1': 5, 'k2': 10}), (tp.MGLDAModel, {'k_g': 5, 'k_l': 5})]:
+        for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+            mdl = cls(tw=tw, seed=42, **kargs)
+            for ch in docs: mdl.add_doc(ch)
+            mdl.train(20, workers=1)
+            phi = mdl.get_topic_word_dists(workers=2)
+            assert phi.dtype == np.float32 and phi.shape[1] == len(mdl.used_vocabs)
+            for k in range(phi.shape[0]):
+                assert np.allclose(phi[k], mdl.get_topic_word_dist(k))
+            theta = mdl.get_doc_topic_dists(normalize=False, workers=2)
+            assert theta.shape[0] == len(mdl.docs)
+            for i in range(0, len(mdl.docs), 50):
+                assert np.allclose(theta[i], mdl.docs[i].get_topic_dist(normalize=False))
+
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(20, workers=1)
+    counts = mdl.topic_word_counts
+    assert counts.dtype == np.int32 and counts.shape == (10, len(mdl.used_vocabs))
+    assert not counts.flags.writeable
+    assert (counts.sum(axis=1) == mdl.get_count_by_topics()).all()
+    mdl.train(10, workers=1)
+    assert (counts.sum(axis=1) == mdl.get_count_by_topics()).all()
+    mdl.add_doc(docs[0])
+    try:
+        mdl.train(1, workers=1)
+        assert False
+    except BufferError:
+        pass
+    del counts
+    mdl.train(1, workers=1)
+
+def test_document_views():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for cls, kargs in [(tp.LDAModel, {'k': 10}), (tp.HDPModel, {'initial_k': 5})]:
+        mdl = cls(seed=42, rm_top=2, **kargs)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(20, workers=1)
+        offsets, word_ids, topic_ids = mdl.export_assignments()
+        assert offsets.dtype == np.int64 and word_ids.dtype == np.uint32 and topic_ids.dtype == np.int16
+        assert len(offsets) == len(mdl.docs) + 1 and offsets[-1] == len(word_ids) == len(topic_ids)
+        for i in range(0, len(mdl.docs), 37):
+            doc = mdl.docs[i]
+            b, e = offsets[i], offsets[i + 1]
+            assert list(word_ids[b:e]) == list(doc.words)
+            assert list(topic_ids[b:e]) == list(doc.topics)
+            words, topics = doc.words_view, doc.topics_view
+            assert not words.flags.writeable and not topics.flags.writeable
+            assert sorted(words) == sorted(doc.words) and len(topics) == len(words)
+
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    try:
+        mdl.docs[0].words_view
+        assert False
+    except RuntimeError:
+        pass
+    mdl.train(20, workers=1)
+    doc = mdl.docs[0]
+    topics, counts = doc.topics_view, doc.count_by_topics_view
+    assert sorted(topics) == sorted(doc.topics)
+    assert list(counts) == list(np.bincount(topics, minlength=10))
+    mdl.train(10, workers=1)
+    # the views follow the states of the model
+    assert list(counts) == list(np.bincount(topics, minlength=10))
+    try:
+        mdl.make_doc(docs[0]).words_view
+        assert False
+    except RuntimeError:
+        pass
+    mdl.add_doc(docs[0])
+    try:
+        mdl.train(1, workers=1)
+        assert False
+    except BufferError:
+        pass
+    del doc, topics, counts
+    mdl.train(1, workers=1)
+
+def test_all_topic_words():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for cls, kargs in [(tp.LDAModel, {'k': 10}), (tp.PAModel, {'k1': 5, 'k2': 10}), (tp.MGLDAModel, {'k_g': 5, 'k_l': 5})]:
+        mdl = cls(seed=42, **kargs)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(20, workers=1)
+        vids, weights = mdl.get_all_topic_words(top_n=7, workers=2)
+        words, weights2 = mdl.get_all_topic_words(top_n=7, return_words=True)
+        assert vids.shape == weights.shape and vids.shape[1] == 7
+        assert (weights == weights2).all()
+        for k in range(vids.shape[0]):
+            expected = mdl.get_topic_words(k, top_n=7)
+            assert [mdl.vocabs[v] for v in vids[k]] == [w for w, _ in expected] == words[k]
+            assert all(abs(a - b) < 1e-6 for a, (_, b) in zip(weights[k], expected))
+    vids, _ = mdl.get_all_topic_words(top_n=len(mdl.used_vocabs) + 10)
+    assert vids.shape[1] == len(mdl.used_vocabs)
+
+def test_frozen_inference():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(100, workers=1)
+    unseen = [mdl.make_doc(ch) for ch in docs[:50]]
+    dists, _ = mdl.infer(unseen, workers=1)
+    mdl.frozen_inference = True
+    unseen = [mdl.make_doc(ch) for ch in docs[:50]]
+    frozen, ll = mdl.infer(unseen, workers=2)
+    assert len(frozen) == len(ll) == 50
+    for f in frozen:
+        assert abs(sum(f) - 1) < 1e-4
+    # the dominant topics mostly agree with those inferred by the collapsed sampler
+    agree = sum(max(range(10), key=d.__getitem__) == max(range(10), key=f.__getitem__) for d, f in zip(dists, frozen))
+    assert agree >= 35
+    mdl.train(10, workers=1)
+    mdl.infer(mdl.make_doc(docs[0]))
+    try:
+        tp.PTModel(k=10, p=100).frozen_inference = True
+        assert False
+    except RuntimeError:
+        pass
+
+def test_fold_in_em():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(100, workers=1)
+    dists, _ = mdl.infer([mdl.make_doc(ch) for ch in docs[:50]], workers=1)
+    mdl.fold_in_em = True
+    unseen = [mdl.make_doc(ch) for ch in docs[:50]]
+    folded, ll = mdl.infer(unseen, tolerance=1e-4, workers=2)
+    assert len(folded) == len(ll) == 50
+    assert all(l <= 0 for l in ll)
+    agree = sum(max(range(10), key=d.__getitem__) == max(range(10), key=f.__getitem__) for d, f in zip(dists, folded))
+    assert agree >= 35
+    _, ll_sum = mdl.infer([mdl.make_doc(ch) for ch in docs[:50]], tolerance=1e-4, together=True)
+    assert abs(ll_sum - sum(ll)) < 1e-3 * abs(ll_sum)
+    try:
+        tp.PTModel(k=10, p=100).fold_in_em = True
+        assert False
+    except RuntimeError:
+        pass
+
+def test_concurrent_infer():
+    import threading
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(50, workers=1)
+    mdl.save('test.lda.bin')
+    for frozen in (False, True):
+        # a loaded model builds its caches at the first inference, which many threads race to here
+        mdl = tp.LDAModel.load('test.lda.bin')
+        mdl.frozen_inference = frozen
+        results = [None] * 8
+        def run(i):
+            results[i] = [mdl.infer([mdl.make_doc(ch) for ch in docs[:30]], workers=2)[0] for _ in range(3)]
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(len(results))]
+        for t in threads: t.start()
+        for t in threads: t.join()
+        expected, _ = mdl.infer([mdl.make_doc(ch) for ch in docs[:30]], workers=1)
+        for r in results:
+            for dists in r:
+                for a, b in zip(dists, expected):
+                    assert all(abs(x - y) < 1e-5 for x, y in zip(a, b))
+
+def test_copy_on_write():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.LDAModel(tw=tw, k=10, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(50, workers=1)
+        ll = mdl.ll_per_word
+        dists = [mdl.get_topic_word_dist(k) for k in range(mdl.k)]
+        copies = [mdl.copy() for _ in range(3)]
+        for c in copies: assert abs(c.ll_per_word - ll) < 1e-5
+        # each copy gets its own arrays at its first training, leaving the others intact
+        for i, c in enumerate(copies):
+            c.train(10 * (i + 1), workers=1)
+        assert abs(mdl.ll_per_word - ll) < 1e-5
+        for k in range(mdl.k):
+            assert all(abs(x - y) < 1e-6 for x, y in zip(mdl.get_topic_word_dist(k), dists[k]))
+        mdl.train(10, workers=1)
+        copies[0].add_doc(docs[0])
+        copies[0].train(10, workers=1)
+
+def test_compressed_save():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for cls in (tp.LDAModel, tp.PAModel):
+        mdl = cls(k=10, seed=42) if cls is tp.LDAModel else cls(k1=5, k2=10, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.train(50, workers=1)
+        mdl.save('test.model.bin')
+        mdl.save('test.model.z.bin', compress=True, workers=2)
+        assert os.path.getsize('test.model.z.bin') < os.path.getsize('test.model.bin')
+        for loaded in (cls.load('test.model.z.bin'), cls.load('test.model.z.bin', mmap=True), cls.loads(mdl.saves(compress=True))):
+            assert abs(loaded.ll_per_word - mdl.ll_per_word) < 1e-5
+            assert loaded.saves() == mdl.saves()
+            loaded.train(10, workers=1)
+
+    try:
+        mdl.save('test.model.z.bin', aligned=True, compress=True)
+        raise AssertionError("`aligned` with `compress` should raise ValueError")
+    except ValueError:
+        pass
+
+    # the snapshot is saved while the model keeps training
+    mdl = tp.LDAModel(k=10, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(50, workers=1)
+    expected = mdl.saves()
+    handle = tp.SaveHandle(mdl, 'test.model.z.bin')
+    mdl.train(50, workers=1)
+    handle.wait()
+    assert handle.done()
+    assert tp.LDAModel.load('test.model.z.bin').saves() == expected
+
+    # the snapshot would share the arrays which the training keeps modifying
+    def callback(progress):
+        try:
+            tp.SaveHandle(mdl, 'test.model.z.bin')
+        except RuntimeError:
+            return True
+        raise AssertionError("SaveHandle during train() should raise")
+    mdl.train(5, workers=1, callback=callback)
+
+def test_load_info():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(tw=tp.TermWeight.IDF, k=12, alpha=0.2, eta=0.05, min_df=2, rm_top=2)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(20, workers=1)
+    for full, compress in ((True, False), (True, True), (False, False)):
+        mdl.save('test.model.bin', full=full, compress=compress)
+        info = tp.load_info('test.model.bin')
+        assert info['model_key'] == 'LDA' and info['tw'] == tp.TermWeight.IDF
+        assert info['k'] == 12 and abs(info['alpha'] - 0.2) < 1e-6 and abs(info['eta'] - 0.05) < 1e-6
+        assert info['global_step'] == mdl.global_step
+        assert info['vocabs'] == list(mdl.used_vocabs)
+        assert info['init_params']['k'] == 12
+        assert info['num_docs'] == (len(mdl.docs) if full else 0)
+        assert info['num_words'] == (mdl.num_words if full else 0)
+        assert tp.LDAModel.load('test.model.bin').k == 12
+
+    mdl = tp.PAModel(k1=5, k2=10)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(5, workers=1)
+    mdl.save('test.model.bin')
+    info = tp.load_info('test.model.bin')
+    assert info['k'] == 5 and info['num_docs'] == len(mdl.docs)
+
+def test_max_workers():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=10, min_df=2, rm_top=2, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.train(20, workers=1)
+    default = tp.get_max_workers()
+    assert default >= 1
+    try:
+        unseen = [mdl.make_doc(ch) for ch in docs[:50]]
+        expected = mdl.infer(unseen, workers=1)[1]
+        tp.set_max_workers(2)
+        assert tp.get_max_workers() == 2
+        # calls asking for more workers than the cap still finish, and the pooled workers give the same results
+        for _ in range(3):
+            unseen = [mdl.make_doc(ch) for ch in docs[:50]]
+            topic_dist, ll = mdl.infer(unseen, workers=8, parallel=tp.ParallelScheme.COPY_MERGE)
+            assert len(topic_dist) == 50
+        unseen = [mdl.make_doc(ch) for ch in docs[:50]]
+        assert mdl.infer(unseen, workers=1)[1] == expected
+        try:
+            tp.set_max_workers(-1)
+            raise AssertionError('ValueError is expected')
+        except ValueError:
+            pass
+    finally:
+        tp.set_max_workers(0)
+    assert tp.get_max_workers() == default
+
+def test_alloc_policy():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    def train():
+        mdl = tp.LDAModel(k=20, seed=42)
+        for words in docs: mdl.add_doc(words)
+        mdl.train(20, workers=2, parallel=tp.ParallelScheme.COPY_MERGE)
+        return [mdl.get_topic_word_dist(k).tolist() for k in range(mdl.k)]
+    assert tp.get_alloc_policy()[0] == 'default'
+    expected = train()
+    try:
+        tp.set_alloc_policy('huge_pages', min_size=4096)
+        assert tp.get_alloc_policy() == ('huge_pages', 4096)
+        # the policy changes only where matrices live, not the result
+        assert train() == expected
+    finally:
+        tp.set_alloc_policy('default')
+    try:
+        tp.set_alloc_policy('unknown')
+        raise AssertionError('ValueError expected')
+    except ValueError:
+        pass
+
+def test_lazy_engines():
+    import subprocess, sys
+    code = '''
+import sys, tomotopy as tp
+loaded = lambda: {k for k in sys.modules if k.startswith('_tomotopy_')}
+tp.LDAModel(k=2)
+before = loaded()
+mdl = tp.DMRModel(k=2)
+mdl.add_doc(['a', 'b', 'c'], metadata='m')
+mdl.train(5, workers=2)
+print(sorted(before), sorted(loaded() - before))
+'''
+    out = subprocess.run([sys.executable, '-c', code], check=True, capture_output=True, text=True).stdout
+    before, added = eval(out)
+    # the engine of DMR is imported when DMRModel is created first, unless everything is built into one module
+    assert not any(k.endswith('_dmr') for k in before)
+    assert all(k.endswith('_dmr') for k in added) and len(added) <= 1
+
+def test_run_sampling():
+    import math
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')][:100]
+    # repeated words form runs long enough for the run-aware sampler when there are many topics
+    for k in (20, 300):
+        mdl = tp.LDAModel(k=k, seed=42)
+        for words in docs: mdl.add_doc(words[:10] * 20)
+        mdl.train(20, workers=1)
+        assert math.isfinite(mdl.ll_per_word)
+        assert sum(mdl.get_count_by_topics()) == sum(len(doc.words) for doc in mdl.docs)
+        for doc in mdl.docs:
+            assert all(0 <= z < k for z in doc.topics)
+
+def test_collapse_duplicates():
+    import math
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')][:50]
+    mdl = tp.LDAModel(k=10, seed=42)
+    mdl.collapse_duplicates = True
+    assert mdl.collapse_duplicates
+    # every document is repeated three times
+    for words in docs * 3: mdl.add_doc(words)
+    mdl.train(20, workers=1)
+    assert math.isfinite(mdl.ll_per_word)
+    # the duplicates still count in the topic-word distributions
+    assert sum(mdl.get_count_by_topics()) == sum(len(doc.words) for doc in mdl.docs)
+    n = len(mdl.docs) // 3
+    for i in range(n):
+        for j in (i + n, i + 2 * n):
+            if not len(mdl.docs[i].words): continue
+            assert list(mdl.docs[j].topics) == list(mdl.docs[i].topics)
+            assert list(mdl.docs[j].get_topic_dist()) == list(mdl.docs[i].get_topic_dist())
+
+    mdl.save('test.model.bin')
+    loaded = tp.LDAModel.load('test.model.bin')
+    assert len(loaded.docs) == len(mdl.docs)
+    assert list(loaded.get_count_by_topics()) == list(mdl.get_count_by_topics())
+
+def test_warm_start():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    prev = tp.LDAModel(k=10, seed=42)
+    for words in docs[:400]: prev.add_doc(words)
+    prev.train(200, workers=1)
+
+    def retrain(warm):
+        mdl = tp.LDAModel(k=10, seed=7)
+        for words in docs[100:500]: mdl.add_doc(words)
+        if warm: mdl.set_warm_start(prev)
+        mdl.train(5, workers=1)
+        return mdl
+
+    # the warm-started model starts near the converged state of `prev`
+    assert retrain(True).ll_per_word > retrain(False).ll_per_word
+
+    try:
+        tp.LDAModel(k=5).set_warm_start(prev)
+        raise AssertionError("a model with another number of topics should be refused")
+    except ValueError:
+        pass
+
+def test_infer_matrix():
+    import numpy as np
+    corpus = tp.utils.Corpus()
+    for line in open(curpath + '/sample.txt', encoding='utf-8'): corpus.add_doc(line.strip().split())
+    mdl = tp.LDAModel(k=10, seed=42, corpus=corpus[:300])
+    mdl.train(50, workers=1)
+
+    unseen = corpus[300:400]
+    # a document of words the model doesn't know keeps its row
+    unseen.add_doc(['unknown_word_of_the_model'])
+    theta, ll = mdl.infer_matrix(unseen, batch_size=16, workers=1)
+    assert theta.shape == (len(unseen), mdl.k) and theta.dtype == np.float32
+    assert ll.shape == (len(unseen),)
+    assert np.allclose(theta[:-1].sum(axis=1), 1, atol=1e-4)
+    assert np.isnan(theta[-1]).all() and ll[-1] == 0
+    assert np.isfinite(ll[:-1]).all()
+
+    # the topics agree with `infer` on most documents
+    result, _ = mdl.infer(corpus[300:400], workers=1)
+    expected = np.array([doc.get_topic_dist() for doc in result])
+    assert (theta[:-1].argmax(axis=1) == expected.argmax(axis=1)).mean() > 0.5
+
+def test_infer_deadline():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.LDAModel(k=20, seed=42)
+    for words in docs[:300]: mdl.add_doc(words)
+    mdl.train(20, workers=1)
+    unseen = [mdl.make_doc(words) for words in docs[300:400]]
+
+    # without a deadline, the result keeps its form
+    result, ll = mdl.infer(unseen, iter=50, workers=1)
+    assert len(result) == len(unseen)
+
+    # a deadline already passed leaves every document at its initial topics
+    result, ll, iters = mdl.infer(unseen, iter=10000, workers=1, timeout=1e-9)
+    assert len(result) == len(unseen) and iters == [0] * len(unseen)
+
+    result, ll, iters = mdl.infer(unseen, iter=10 ** 6, workers=2, doc_timeout=0.002)
+    assert all(0 < i < 10 ** 6 for i in iters)
+    assert all(abs(sum(r) - 1) < 1e-4 for r in result)
+
+    result, ll, iters = mdl.infer(unseen, iter=30, workers=1, timeout=60, together=True)
+    assert iters == 30
+
+    sess = mdl.make_inference_session(workers=1)
+    dist, ll, iters = sess.infer(mdl.make_doc(docs[400]), iter=10 ** 6, doc_timeout=0.001)
+    assert 0 < iters < 10 ** 6
+
+def test_raw_text_columns():
+    lines = [line.strip() for line in open(curpath + '/sample_raw.txt', encoding='utf-8')][:200]
+    corpus = tp.utils.Corpus(tokenizer=tp.utils.SimpleTokenizer(), stopwords=lambda x: len(x) <= 2)
+    for i, line in enumerate(lines):
+        corpus.add_doc(raw=line, uid='doc{:05}'.format(i))
+    mdl = tp.LDAModel(k=5, corpus=corpus)
+    # documents without raw texts are mixed with those having them
+    mdl.add_doc(['no', 'raw', 'text'])
+    mdl.train(10, workers=1)
+    expected = [(doc.raw, doc.span, doc.uid) for doc in mdl.docs]
+    assert expected[0][0] == lines[0] and expected[0][1]
+
+    for compress in (False, True):
+        mdl.save('test.model.bin', compress=compress)
+        loaded = tp.LDAModel.load('test.model.bin')
+        assert [(doc.raw, doc.span, doc.uid) for doc in loaded.docs] == expected
+        # the loaded documents share the columns, and training or copying the model keeps them
+        loaded.train(5, workers=1)
+        assert [(doc.raw, doc.span, doc.uid) for doc in loaded.copy().docs] == expected
+
+def test_token_arrays():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')][:300]
+    vocabs = sorted(set(w for doc in docs for w in doc))
+    vid = {w:i for i, w in enumerate(vocabs)}
+    token_ids = np.array([vid[w] for doc in docs for w in doc], dtype=np.int32)
+    offsets = np.cumsum([0] + [len(doc) for doc in docs], dtype=np.int64)
+    uids = ['doc{}'.format(i) for i in range(len(docs))]
+
+    expected = tp.LDAModel(k=5)
+    for doc in docs:
+        expected.add_doc(doc)
+    mdl = tp.LDAModel(k=5)
+    ids = mdl.add_token_arrays(vocabs, token_ids, offsets, uids=uids, workers=4)
+    assert list(ids) == list(range(len(docs)))
+    assert list(mdl.vocabs) == list(expected.vocabs)
+    assert list(mdl.vocab_freq) == list(expected.vocab_freq)
+    assert [list(d) for d in mdl.docs] == [list(d) for d in expected.docs]
+    assert mdl.docs[7].uid == 'doc7'
+    mdl.train(10, workers=1)
+
+    # any object with the buffer protocol is accepted, and the stopwords of corpus are applied once per word
+    stop = set(vocabs[:50])
+    corpus = tp.utils.Corpus(stopwords=lambda x: x in stop)
+    assert corpus.add_token_arrays(vocabs, memoryview(token_ids), offsets.tolist(), workers=2) == len(docs)
+    ref = tp.utils.Corpus(stopwords=lambda x: x in stop)
+    for doc in docs:
+        ref.add_doc(doc)
+    assert [list(d) for d in corpus] == [list(d) for d in ref]
+
+    for bad in ([0, 3, 2], [0, len(token_ids) + 1], []):
+        try:
+            mdl.add_token_arrays(vocabs, token_ids, np.array(bad, dtype=np.int64))
+            raise AssertionError('ValueError expected')
+        except ValueError:
+            pass
+    try:
+        tp.LDAModel().add_token_arrays(vocabs[:10], token_ids, offsets)
+        raise AssertionError('ValueError expected')
+    except ValueError:
+        pass
+
+def test_process_min_cf():
+    from collections import Counter
+    lines = [line.strip() for line in open(curpath + '/sample_raw.txt', encoding='utf-8')][:500]
+    for tokenizer in (tp.utils.SimpleTokenizer(), lambda raw, user_data=None: raw.lower().split()):
+        full = tp.utils.Corpus(tokenizer=tokenizer)
+        full.process(lines)
+        cf = Counter(w for doc in full for w in doc)
+        pruned = tp.utils.Corpus(tokenizer=tokenizer)
+        assert pruned.process(lines, workers=2, min_cf=5) == len(lines)
+        # words occurring less than 5 times are dropped from their documents like stopwords
+        assert [[w if cf[w] >= 5 else None for w in doc] for doc in full] == [list(doc) for doc in pruned]
+        assert any(w is None for doc in pruned for w in doc)
+    try:
+        tp.utils.Corpus(tokenizer=tp.utils.SimpleTokenizer()).process(iter(lines), min_cf=5)
+        raise AssertionError('ValueError expected')
+    except ValueError:
+        pass
+
+def test_checkpoint():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    def build(k=10):
+        mdl = tp.LDAModel(k=k, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        return mdl
+
+    mdl = build()
+    mdl.optim_interval = 5
+    iterations = []
+    mdl.train(22, workers=1, callback=lambda p: iterations.append(p['iteration']), callback_interval=4,
+        checkpoint='test.ckpt', checkpoint_interval=10)
+    # the callback keeps its own interval while checkpoints are written between them
+    assert iterations == [4, 8, 12, 16, 20, 22]
+    assert not os.path.exists('test.ckpt.tmp')
+
+    restored = build()
+    restored.restore_checkpoint('test.ckpt')
+    assert restored.global_step == mdl.global_step
+    assert abs(restored.ll_per_word - mdl.ll_per_word) < 1e-5
+    assert np.allclose(restored.alpha, mdl.alpha)
+    for k in range(mdl.k):
+        assert restored.get_count_by_topics()[k] == mdl.get_count_by_topics()[k]
+        assert np.allclose(restored.get_topic_word_dist(k), mdl.get_topic_word_dist(k))
+    restored.train(10, workers=1)
+
+    other_docs = tp.LDAModel(k=10, seed=42)
+    for ch in docs[:-1]: other_docs.add_doc(ch)
+    for other in (build(k=5), other_docs):
+        try:
+            other.restore_checkpoint('test.ckpt')
+            raise AssertionError("a checkpoint of other topics or documents should raise ValueError")
+        except ValueError:
+            pass
+
+def test_checkpoint_deltas():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    def build():
+        # small priors make the topics of most words settle, as late in the training of a large model
+        mdl = tp.LDAModel(k=10, alpha=0.01, eta=0.001, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        return mdl
+
+    mdl = build()
+    mdl.train(200, workers=1)
+    mdl.train(3, workers=1, checkpoint='test_delta.ckpt', checkpoint_interval=1, checkpoint_deltas=4)
+    # a full checkpoint at the first iteration followed by two deltas
+    assert os.path.getsize('test_delta.ckpt.delta') < os.path.getsize('test_delta.ckpt')
+
+    restored = build()
+    assert restored.restore_checkpoint('test_delta.ckpt', workers=2) == 2
+    assert restored.global_step == mdl.global_step
+    assert abs(restored.ll_per_word - mdl.ll_per_word) < 1e-5
+    for d1, d2 in zip(restored.docs, mdl.docs):
+        assert list(d1.topics) == list(d2.topics)
+
+    # a delta cut by a crash is ignored
+    with open('test_delta.ckpt.delta', 'rb+') as f:
+        f.truncate(os.path.getsize('test_delta.ckpt.delta') - 3)
+    restored = build()
+    assert restored.restore_checkpoint('test_delta.ckpt') == 1
+
+    # a new full checkpoint removes the deltas of the previous one
+    mdl.train(1, workers=1, checkpoint='test_delta.ckpt', checkpoint_deltas=4)
+    assert not os.path.exists('test_delta.ckpt.delta')
+    assert build().restore_checkpoint('test_delta.ckpt') == 0
+
+def test_async():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.LDAModel(tw=tw, k=10, min_df=2, rm_top=2)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.async_staleness = 4
+        mdl.async_recount_interval = 5
+        mdl.train(100, workers=4, parallel=tp.ParallelScheme.ASYNC)
+        ll = mdl.ll_per_word
+        mdl.save('test.lda.bin')
+        mdl = tp.LDAModel.load('test.lda.bin')
+        assert abs(mdl.ll_per_word - ll) < 1e-5
+        mdl.infer(mdl.make_doc(docs[0]), parallel=tp.ParallelScheme.ASYNC)
+
+    mdl = tp.DMRModel(k=10)
+    for ch in docs: mdl.add_doc(ch)
+    try:
+        mdl.train(10, workers=2, parallel=tp.ParallelScheme.ASYNC)
+    except RuntimeError:
+        pass
+    else:
+        raise AssertionError("DMRModel doesn't support ParallelScheme.ASYNC")
+
+def test_hierarchical_scheme():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.LDAModel(tw=tw, k=10, min_df=2, rm_top=2)
+        for ch in docs: mdl.add_doc(ch)
+        for groups in (0, 2, 3):
+            mdl.hierarchical_groups = groups
+            assert mdl.hierarchical_groups == groups
+            mdl.train(20, workers=4, parallel=tp.ParallelScheme.HIERARCHICAL)
+            assert mdl.train_stats['scheme'] == tp.ParallelScheme.HIERARCHICAL
+            assert (mdl.get_count_by_topics() >= 0).all()
+        ll = mdl.ll_per_word
+        mdl.save('test.lda.bin')
+        mdl = tp.LDAModel.load('test.lda.bin')
+        assert abs(mdl.ll_per_word - ll) < 1e-5
+        mdl.infer(mdl.make_doc(docs[0]), parallel=tp.ParallelScheme.HIERARCHICAL)
+
+    mdl = tp.DMRModel(k=10)
+    for ch in docs: mdl.add_doc(ch)
+    try:
+        mdl.train(10, workers=2, parallel=tp.ParallelScheme.HIERARCHICAL)
+    except:
+        pass
+    else:
+        raise AssertionError("DMRModel doesn't support ParallelScheme.HIERARCHICAL")
+
+def test_llda_many_labels():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for cls, kargs in ((tp.LLDAModel, {'k':1}), (tp.PLDAModel, {'topics_per_label':2})):
+        mdl = cls(min_df=2, rm_top=2, **kargs)
+        labels_of = {}
+        for i, ch in enumerate(docs):
+            labels = ['label{}'.format(i % 50), 'label{}'.format((i * 7 + 3) % 50)]
+            idx = mdl.add_doc(ch, labels=labels)
+            if idx is not None: labels_of[idx] = labels
+        mdl.train(20, workers=2)
+        per_label = mdl.topics_per_label if cls is tp.PLDAModel else 1
+        for idx, labels in labels_of.items():
+            allowed = set(i * per_label + j for i, l in enumerate(mdl.topic_label_dict) if l in labels for j in range(per_label))
+            assert set(int(t) for t in mdl.docs[idx].topics if 0 <= t < mdl.k).issubset(allowed)
+
+def test_pipelined_partition():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        lls = []
+        for pipelined in (False, True):
+            mdl = tp.LDAModel(tw=tw, k=10, min_df=2, rm_top=2, seed=42)
+            for ch in docs: mdl.add_doc(ch)
+            mdl.pipelined_partition = pipelined
+            assert mdl.pipelined_partition == pipelined
+            mdl.train(50, workers=4, parallel=tp.ParallelScheme.PARTITION)
+            lls.append(mdl.ll_per_word)
+        assert abs(lls[0] - lls[1]) < 1e-6
+
+def test_partition_rebalance():
+    import math
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    for cls in (tp.LDAModel, tp.PAModel):
+        mdl = cls(k=10, min_df=2, rm_top=2, seed=42) if cls is tp.LDAModel else cls(k1=5, k2=10, min_df=2, rm_top=2, seed=42)
+        for ch in docs: mdl.add_doc(ch)
+        mdl.partition_rebalance_interval = 2
+        assert mdl.partition_rebalance_interval == 2
+        mdl.train(30, workers=4, parallel=tp.ParallelScheme.PARTITION)
+        # the counts stay consistent with the topics of the words after the blocks move
+        assert math.isfinite(mdl.ll_per_word)
+        assert sum(mdl.get_count_by_topics()) == mdl.num_words
+
+def test_gdmr_tdf_linspace():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.GDMRModel(k=5, degrees=[3, 2], min_df=2, rm_top=2, seed=42)
+    for i, ch in enumerate(docs):
+        mdl.add_doc(ch, numeric_metadata=[(i % 17) / 16, (i % 5) / 4])
+    mdl.train(20, workers=1)
+    for normalize in (True, False):
+        grid = mdl.tdf_linspace([0, 0], [1, 1], [33, 9], normalize=normalize, workers=4)
+        serial = mdl.tdf_linspace([0, 0], [1, 1], [33, 9], normalize=normalize, workers=1)
+        assert abs(grid - serial).max() < 1e-5
+        for x, y in ((0, 0), (7, 3), (32, 8)):
+            ref = mdl.tdf([x / 32, y / 8], normalize=normalize)
+            assert abs(grid[x, y] - ref).max() < 1e-4
+
+def test_dmr_unknown_md_infer():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.DMRModel(k=10, min_df=2, rm_top=2, seed=42)
+    for i, ch in enumerate(docs):
+        mdl.add_doc(ch, metadata='md{}'.format(i % 3), multi_metadata=['a'] if i % 2 else ['b'])
+    mdl.train(50, workers=1)
+    # ['a', 'b'] never occurs in training, so the inferred documents share one unknown group
+    for _ in range(2):
+        unseen = [mdl.make_doc(ch, metadata='md0', multi_metadata=['a', 'b']) for ch in docs[:200]]
+        mdl.infer(unseen, workers=4)
+        for doc in unseen:
+            assert abs(sum(doc.get_topic_dist()) - 1) < 1e-4
+        mdl.train(10, workers=1)
+
+def test_dmr_warm_optimization():
+    import numpy as np
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.DMRModel(k=10, min_df=2, rm_top=2, seed=42)
+    for i, ch in enumerate(docs):
+        mdl.add_doc(ch, metadata='md{}'.format(i % 3))
+    mdl.optim_interval = 1
+    mdl.burn_in = 0
+    mdl.train(30, workers=2)
+    # later optimizations refine lambda from where it is, so it stays put once the topics settle
+    before = np.array(mdl.lambdas)
+    assert np.isfinite(before).all()
+    mdl.train(1, workers=2)
+    after = np.array(mdl.lambdas)
+    assert np.isfinite(after).all()
+    assert np.abs(after - before).max() < np.abs(before).max()
+
+def test_dt_time_partition():
+    for tw in (tp.TermWeight.ONE, tp.TermWeight.IDF):
+        mdl = tp.DTModel(tw=tw, k=10, t=13, min_df=2, rm_top=2, seed=42)
+        for line in open(curpath + '/sample_tp.txt', encoding='utf-8'):
+            ch = line.strip().split()
+            if len(ch) < 2: continue
+            mdl.add_doc(ch[1:], timepoint=int(ch[0]))
+        assert not mdl.time_partition
+        mdl.time_partition = True
+        assert mdl.time_partition
+        mdl.train(50, workers=4, parallel=tp.ParallelScheme.PARTITION)
+        assert mdl.train_stats['scheme'] == tp.ParallelScheme.PARTITION
+        if tw == tp.TermWeight.ONE: assert sum(mdl.get_count_by_topics().flatten()) == mdl.num_words
+        assert mdl.ll_per_word == mdl.ll_per_word
+        mdl.time_partition = False
+        mdl.train(10, workers=4, parallel=tp.ParallelScheme.PARTITION)
+
+def test_hlda_path_batch():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.HLDAModel(depth=3, min_df=2, rm_top=2)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.path_batch = 8
+    assert mdl.path_batch == 8
+    mdl.train(50, workers=4)
+    assert mdl.live_k > 1
+    mdl.infer(mdl.make_doc(docs[0]))
+
+def test_hlda_path_prune():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.HLDAModel(depth=4, min_df=2, rm_top=2)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.path_prune_threshold = 20
+    assert mdl.path_prune_threshold == 20
+    mdl.train(50, workers=1)
+    assert mdl.live_k > 1
+    mdl.path_batch = 8
+    mdl.train(20, workers=4)
+
+def test_hlda_compaction():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    # a large gamma keeps making and killing paths, which leaves many dead blocks to be compacted
+    mdl = tp.HLDAModel(depth=3, gamma=5, min_df=2, rm_top=2, seed=42)
+    for ch in docs: mdl.add_doc(ch)
+    for _ in range(10):
+        mdl.train(20, workers=2)
+        # the pathes of the documents still follow the live topics after their ids have moved
+        nonempty = [doc for doc in mdl.docs if len(doc)]
+        for doc in nonempty:
+            path = list(doc.path)
+            assert all(mdl.is_live_topic(t) for t in path)
+            assert all(mdl.parent_topic(path[l + 1]) == path[l] for l in range(len(path) - 1))
+        assert sum(mdl.num_docs_of_topic(t) for t in range(mdl.k) if mdl.is_live_topic(t) and mdl.level(t) == 2) == len(nonempty)
+        assert sum(mdl.get_count_by_topics()) == mdl.num_words
+
+def test_pt_pseudo_doc_mh():
+    docs = [line.strip().split() for line in open(curpath + '/sample.txt', encoding='utf-8')]
+    mdl = tp.PTModel(k=10, p=100)
+    for ch in docs: mdl.add_doc(ch)
+    mdl.pseudo_doc_mh_steps = 4
+    assert mdl.pseudo_doc_mh_steps == 4
+    mdl.train(50, workers=1)
+    mdl.train(50, workers=4)
+    assert len(set(doc.pseudo_doc_id for doc in mdl.docs)) > 1
+
+    # the other documents have only the words removed by `min_cf`
+    mdl = tp.PTModel(k=2, p=4, min_cf=2)
+    mdl.add_doc(['a', 'b', 'a', 'b'])
+    for w in 'cdef': mdl.add_doc([w])
+    mdl.pseudo_doc_mh_steps = 4
+    mdl.train(10, workers=1)
+
 def test_coherence():
     mdl = tp.LDAModel(tw=tp.TermWeight.ONE, k=20, min_df=5, rm_top=5)
     for n, line in enumerate(open(curpath + '/sample.txt', encoding='utf-8')):
@@ -522,15 +1985,115 @@ def test_coherence():
         coherence = tp.coherence.Coherence(corpus=mdl, coherence=coh)
         print(coherence.get_score())
 
+def test_coherence_workers():
+    mdl = tp.LDAModel(tw=tp.TermWeight.ONE, k=20, min_df=5, rm_top=5)
+    for n, line in enumerate(open(curpath + '/sample.txt', encoding='utf-8')):
+        ch = line.strip().split()
+        mdl.add_doc(ch)
+    mdl.train(200)
+
+    for coh in ('u_mass', 'c_uci', 'c_npmi', 'c_v'):
+        single = tp.coherence.Coherence(corpus=mdl, coherence=coh, workers=1)
+        multi = tp.coherence.Coherence(corpus=mdl, coherence=coh, workers=4)
+        for k in range(mdl.k):
+            assert abs(single.get_score(topic_id=k) - multi.get_score(topic_id=k)) < 1e-5
+
+def test_coherence_index():
+    mdl = tp.LDAModel(tw=tp.TermWeight.ONE, k=20, min_df=5, rm_top=5)
+    for n, line in enumerate(open(curpath + '/sample.txt', encoding='utf-8')):
+        ch = line.strip().split()
+        mdl.add_doc(ch)
+    mdl.train(200)
+
+    index = tp.coherence.CoherenceIndex(mdl)
+    index.save('test.cidx')
+    index = tp.coherence.CoherenceIndex.load('test.cidx')
+    for top_n in (5, 10):
+        for coh in ('u_mass', 'c_uci', 'c_npmi', 'c_v'):
+            scanned = tp.coherence.Coherence(corpus=mdl, coherence=coh, top_n=top_n)
+            indexed = tp.coherence.Coherence(corpus=mdl, coherence=coh, top_n=top_n, index=index)
+            for k in range(mdl.k):
+                assert abs(scanned.get_score(topic_id=k) - indexed.get_score(topic_id=k)) < 1e-5
+
+def test_coherence_all_topics():
+    mdl = tp.LDAModel(tw=tp.TermWeight.ONE, k=20, min_df=5, rm_top=5)
+    for n, line in enumerate(open(curpath + '/sample.txt', encoding='utf-8')):
+        ch = line.strip().split()
+        mdl.add_doc(ch)
+    mdl.train(200)
+
+    for coh in ('u_mass', 'c_uci', 'c_npmi', 'c_v'):
+        coherence = tp.coherence.Coherence(corpus=mdl, coherence=coh, workers=4)
+        scores = [coherence.get_score(topic_id=k) for k in range(mdl.k)]
+        assert abs(coherence.get_score() - sum(scores) / len(scores)) < 1e-4
+        # words out of the targets have their context vectors computed on demand
+        words = [w for w, _ in mdl.get_topic_words(0, top_n=5)] + [w for w, _ in mdl.get_topic_words(1, top_n=5)]
+        targeted = tp.coherence.Coherence(corpus=mdl, coherence=coh, targets=words)
+        assert abs(coherence.get_score(words=words) - targeted.get_score(words=words)) < 1e-4
+
+def test_coherence_from_model():
+    mdl = tp.LDAModel(tw=tp.TermWeight.ONE, k=20, min_df=5, rm_top=5)
+    for n, line in enumerate(open(curpath + '/sample.txt', encoding='utf-8')):
+        ch = line.strip().split()
+        mdl.add_doc(ch)
+    mdl.train(200)
+
+    targets = [w for k in range(mdl.k) for w, _ in mdl.get_topic_words(k, top_n=10)]
+    for coh in ('u_mass', 'c_uci', 'c_npmi', 'c_v'):
+        native = tp.coherence.Coherence(corpus=mdl, coherence=coh, top_n=10, workers=4)
+        scanned = tp.coherence.Coherence(corpus=mdl.docs, coherence=coh, targets=targets)
+        for k in range(mdl.k):
+            words = [w for w, _ in mdl.get_topic_words(k, top_n=10)]
+            assert abs(native.get_score(topic_id=k) - scanned.get_score(words=words)) < 1e-5
+
+def test_corpus_process_native():
+    from nltk.stem.porter import PorterStemmer
+    stemmer = PorterStemmer()
+    stopwords = lambda x: len(x) <= 2
+    lines = list(open(curpath + '/sample_raw.txt', encoding='utf-8'))
+    tokenizer = tp.utils.SimpleTokenizer(stemmer=stemmer.stem)
+    native = tp.utils.Corpus(tokenizer=tokenizer, stopwords=stopwords)
+    native.process(lines, workers=4)
+    # a wrapper makes the corpus call the tokenizer through Python for each document
+    python = tp.utils.Corpus(tokenizer=lambda raw, user_data: tokenizer(raw, user_data), stopwords=stopwords)
+    python.process(lines)
+
+    assert len(native) == len(python)
+    for a, b in zip(native, python):
+        assert list(a) == list(b)
+        assert list(a.words) == list(b.words)
+        assert a.span == b.span
+
+def test_concat_ngrams():
+    docs = [['new', 'york', 'city', 'is', 'big'], ['i', 'love', 'new', 'york', 'city'], ['new', 'york', 'is', 'not', 'york']] * 10
+    corpora = []
+    for workers in (1, 4):
+        corpus = tp.utils.Corpus()
+        for words in docs:
+            corpus.add_doc(words=words)
+        cands = corpus.extract_ngrams(min_cf=5, min_df=3)
+        assert corpus.concat_ngrams(cands, workers=workers) > 0
+        corpora.append([list(corpus[i]) for i in range(len(corpus))])
+    assert corpora[0] == corpora[1]
+    for words, orig in zip(corpora[0], docs):
+        assert len(words) < len(orig)
+        assert ' '.join(words).replace('_', ' ') == ' '.join(orig)
+
 def test_corpus_save_load():
     corpus = tp.utils.Corpus()
     # data_feeder yields a tuple of (raw string, user data) or a str (raw string)
     for i, line in enumerate(open('test/sample_raw.txt', encoding='utf-8')):
         corpus.add_doc(words=line.split(), uid='doc{:05}'.format(i))
     
+    corpus.add_doc(words=['metadata', 'test'], uid='meta', metadata='a')
     corpus.save('test.cps')
 
-    corpus = tp.utils.Corpus.load('test.cps')
+    loaded = tp.utils.Corpus.load('test.cps')
+    assert len(loaded) == len(corpus)
+    for a, b in zip(corpus, loaded):
+        assert list(a.words) == list(b.words)
+        assert a.uid == b.uid
+    assert loaded['meta'].metadata == 'a'
 
 for model_case in model_cases:
     pss = model_case[5]
@@ -63,10 +63,246 @@ class ParallelScheme(IntEnum):
     > * Yan, F., Xu, N., & Qi, Y. (2009). Parallel inference for latent dirichlet allocation on graphics processing units. In Advances in neural information processing systems (pp. 2134-2142).
     """
 
+    ASYNC = 4
+    """
+    .. versionadded:: 0.12.3
+
+    All workers sample against the shared topic-word counts, which are updated by atomic operations, without merging them at every iteration.
+    Each worker keeps its own topic totals and syncs them every `tomotopy.LDAModel.async_staleness` documents.
+    This has advantages when you have a large number of workers. Currently it is supported only by `tomotopy.LDAModel` with `tomotopy.SamplingMethod.DENSE`,
+    and inference runs as COPY_MERGE.
+    
+    > * Newman, D., Asuncion, A., Smyth, P., & Welling, M. (2009). Distributed algorithms for topic models. Journal of Machine Learning Research, 10(Aug), 1801-1828.
+    """
+
+    AUTO = 5
+    """
+    .. versionadded:: 0.12.3
+
+    Train a few iterations with each scheme the model provides, using all the workers and half of them, and go on with the fastest one.
+    These iterations are part of the training. The decision is reported by `tomotopy.LDAModel.train_stats` 
+    and reused by later calls with the same number of workers until documents are added.
+    The candidates which would exceed `tomotopy.LDAModel.auto_memory_limit` are skipped. Inference runs as DEFAULT.
+    """
+
+    HIERARCHICAL = 6
+    """
+    .. versionadded:: 0.12.3
+
+    Split the workers into `tomotopy.LDAModel.hierarchical_groups` groups, each of which keeps one copy of the topic-word counts.
+    The copies are merged as COPY_MERGE does, and the workers inside a group sample as PARTITION does on the copy of their group.
+    So it uses less memory than COPY_MERGE and cuts the vocabulary into larger blocks than PARTITION,
+    which has advantages when you have a very large number of workers. Currently it is supported only by `tomotopy.LDAModel`,
+    and inference runs as COPY_MERGE.
+    """
+
+class SamplingMethod(IntEnum):
+    """
+    .. versionadded:: 0.12.3
+
+    This enumeration is for the sampling method of Gibbs sampling. 
+    The basic one is DENSE. Not all models supports all options. 
+    """
+
+    DENSE = 0
+    """ Calculate the likelihoods of all topics for each word (default)"""
+
+    SPARSE = 1
+    """
+    Split the likelihood into smoothing, document-topic and topic-word buckets and evaluate only non-zero terms of them.
+    The cost of sampling a word is proportional to the number of topics occurring in its document or assigned to it, rather than the number of all topics.
+    This has advantages when you have a large number of topics.
+    
+    > * Yao, L., Mimno, D., & McCallum, A. (2009, June). Efficient methods for topic model inference on streaming document collections. In Proceedings of the 15th ACM SIGKDD international conference on Knowledge discovery and data mining (pp. 937-946).
+    """
+
+    MH = 2
+    """
+    Propose new topics alternately from the word proposal and the document proposal, and accept them by Metropolis-Hastings test.
+    The word proposal is built once per iteration into alias tables, so the cost of sampling a word is constant regardless of the number of topics.
+    This has advantages when you have a very large number of topics, but it needs more iterations to converge than DENSE.
+    
+    > * Yuan, J., Gao, F., Ho, Q., Dai, W., Wei, J., Zheng, X., ... & Ma, W. Y. (2015, May). Lightlda: Big topic models on modest computer clusters. In Proceedings of the 24th International Conference on World Wide Web (pp. 1351-1361).
+    """
+
+class DocOrder(IntEnum):
+    """
+    .. versionadded:: 0.12.3
+
+    This enumeration is for the order in which documents are visited by `tomotopy.ParallelScheme.PARTITION`.
+    It only changes the order of sampling, not the order of `tomotopy.LDAModel.docs`.
+    """
+
+    SHUFFLED = 0
+    """ Visit documents in a random order (default)"""
+
+    VOCAB_BLOCK = 1
+    """
+    Group documents by the block of vocabularies holding most of their words, and visit longer ones first in each group.
+    A block is sized so that its topic counts fit in the L2 cache.
+    """
+
+    LENGTH = 2
+    """ Visit longer documents first"""
+
+    WORD_MAJOR = 3
+    """
+    Visit tokens word by word instead of document by document, so that all occurrences of a vocabulary are sampled in turn
+    while its topic counts stay in the CPU cache. It helps most with large vocabularies.
+    It also applies to the single-threaded training, but only `tomotopy.LDAModel` with `tomotopy.SamplingMethod.DENSE` supports it.
+    The other models and samplers visit documents in a random order.
+    """
+
+class DocMetric(IntEnum):
+    """
+    .. versionadded:: 0.12.3
+
+    This enumeration is for the distance between topic distributions of documents used by `tomotopy.DocIndex`.
+    """
+
+    HELLINGER = 0
+    """ The Hellinger distance (default)"""
+
+    JS = 1
+    """ The Jensen-Shannon divergence in nats. The lists to scan are chosen by the Hellinger distance."""
+
+    COSINE = 2
+    """ One minus the cosine similarity"""
+
+class HeldOutEstimator(IntEnum):
+    """
+    .. versionadded:: 0.12.3
+
+    This enumeration is for the estimator of the held-out log-likelihood used by `tomotopy.LDAModel.estimate_held_out_ll`.
+    """
+
+    LEFT_TO_RIGHT = 0
+    """ The left-to-right particle estimator of Wallach et al. (2009) (default). It is the most accurate, but its cost is quadratic in the length of a document."""
+
+    IMPORTANCE_SAMPLING = 1
+    """ Importance sampling whose proposal draws the topic of each word independently from the prior and the topic-word distribution"""
+
+    HARMONIC_MEAN = 2
+    """ The harmonic mean of the likelihoods of the samples of Gibbs sampling. It is cheap, but known to overestimate the likelihood."""
+
+class TrainingHandle:
+    """
+    .. versionadded:: 0.12.3
+
+    `TrainingHandle` runs `tomotopy.LDAModel.train` of the given model in a background thread.
+    Since the training releases the GIL, other Python threads keep running during the training.
+    The model must not be accessed until the training is done, except inside `callback`;
+    other threads get `RuntimeError` when they try.
+
+    Parameters
+    ----------
+    model : tomotopy.LDAModel
+        the model to be trained
+    iter, workers, parallel, freeze_topics, callback, callback_interval, checkpoint, checkpoint_interval, checkpoint_deltas
+        the same as the parameters of `tomotopy.LDAModel.train`
+    """
+
+    def __init__(self, model, iter=10, workers=0, parallel=0, freeze_topics=False, callback=None, callback_interval=1,
+                 checkpoint=None, checkpoint_interval=10, checkpoint_deltas=0):
+        import threading
+        self._model = model
+        self._cancelled = threading.Event()
+        self._progress = None
+        self._exception = None
+
+        def _callback(progress):
+            self._progress = progress
+            if self._cancelled.is_set(): return False
+            if callback is not None: return callback(progress)
+
+        def _run():
+            try:
+                model.train(iter, workers, parallel, freeze_topics, callback=_callback, callback_interval=callback_interval,
+                            checkpoint=checkpoint, checkpoint_interval=checkpoint_interval, checkpoint_deltas=checkpoint_deltas)
+            except BaseException as e:
+                self._exception = e
+
+        self._thread = threading.Thread(target=_run, daemon=True)
+        self._thread.start()
+
+    def cancel(self):
+        """Request the training to stop. It stops at the next callback point, that is, within `callback_interval` iterations."""
+        self._cancelled.set()
+
+    def done(self):
+        """Return `True` if the training is finished or cancelled."""
+        return not self._thread.is_alive()
+
+    def wait(self, timeout=None):
+        """Wait until the training is done for at most `timeout` seconds, and return `tomotopy.TrainingHandle.done`.
+If the training raised an exception, it is re-raised here."""
+        self._thread.join(timeout)
+        if self._exception is not None:
+            e, self._exception = self._exception, None
+            raise e
+        return self.done()
+
+    @property
+    def progress(self):
+        """the dict passed to the last callback, or `None` if no iteration has been reported yet (read-only)"""
+        return self._progress
+
+    @property
+    def model(self):
+        """the model being trained (read-only)"""
+        return self._model
+
+class SaveHandle:
+    """
+    .. versionadded:: 0.12.3
+
+    `SaveHandle` saves a snapshot of the given model into a file in a background thread, so that the model can be trained again right away.
+    The snapshot is taken by `tomotopy.LDAModel.copy` when the handle is created.
+    For `tomotopy.LDAModel` itself, the snapshot shares the documents and the counts with the model,
+    so it takes memory only for the arrays which the model modifies before the saving is done.
+
+    Parameters
+    ----------
+    model : tomotopy.LDAModel
+        the model to be saved
+    filename, full, compress, workers
+        the same as the parameters of `tomotopy.LDAModel.save`
+    """
+
+    def __init__(self, model, filename, full=True, compress=True, workers=0):
+        import threading
+        self._snapshot = model.copy()
+        self._exception = None
+
+        def _run():
+            try:
+                self._snapshot.save(filename, full=full, compress=compress, workers=workers)
+            except BaseException as e:
+                self._exception = e
+            finally:
+                # releases the arrays shared with the model
+                self._snapshot = None
+
+        self._thread = threading.Thread(target=_run, daemon=True)
+        self._thread.start()
+
+    def done(self):
+        """Return `True` if the saving is finished."""
+        return not self._thread.is_alive()
+
+    def wait(self, timeout=None):
+        """Wait until the saving is done for at most `timeout` seconds, and return `tomotopy.SaveHandle.done`.
+If the saving raised an exception, it is re-raised here."""
+        self._thread.join(timeout)
+        if self._exception is not None:
+            e, self._exception = self._exception, None
+            raise e
+        return self.done()
+
 isa = ''
 """
 Indicate which SIMD instruction set is used for acceleration.
-It can be one of `'avx2'`, `'avx'`, `'sse2'` and `'none'`.
+It can be one of `'avx512'`, `'avx2'`, `'avx'`, `'sse2'`, `'neon'` and `'none'`.
 """
 
 from _tomotopy import *
@@ -84,7 +320,7 @@ if os.environ.get('TOMOTOPY_LANG') == 'kr':
 """
     __pdoc__ = {}
     __pdoc__['isa'] = """현재 로드된 모듈이 어떤 SIMD 명령어 세트를 사용하는지 표시합니다. 
-이 값은 `'avx2'`, `'avx'`, `'sse2'`, `'none'` 중 하나입니다."""
+이 값은 `'avx512'`, `'avx2'`, `'avx'`, `'sse2'`, `'neon'`, `'none'` 중 하나입니다."""
     __pdoc__['TermWeight'] = """용어 가중치 기법을 선택하는 데에 사용되는 열거형입니다. 여기에 제시된 용어 가중치 기법들은 다음 논문을 바탕으로 하였습니다:
     
 > * Wilson, A. T., & Chew, P. A. (2010, June). Term weighting schemes for latent dirichlet allocation. In human language technologies: The 2010 annual conference of the North American Chapter of the Association for Computational Linguistics (pp. 465-473). Association for Computational Linguistics.
@@ -112,4 +348,103 @@ PCGS에서 제안된 분할 샘플링 알고리즘을 사용합니다. 작업자
     
 > * Yan, F., Xu, N., & Qi, Y. (2009). Parallel inference for latent dirichlet allocation on graphics processing units. In Advances in neural information processing systems (pp. 2134-2142).
 """
+    __pdoc__['ParallelScheme.ASYNC'] = """
+.. versionadded:: 0.12.3
+
+모든 작업자가 원자적 연산으로 갱신되는 공유 토픽-단어 개수를 바탕으로 샘플링하며, 매 반복마다 이를 병합하지 않습니다.
+각 작업자는 자신의 주제별 합계를 가지며 `tomotopy.LDAModel.async_staleness`개의 문헌마다 이를 동기화합니다.
+작업자 수가 많을 때 유리합니다. 현재 `tomotopy.SamplingMethod.DENSE`를 사용하는 `tomotopy.LDAModel`에서만 지원되며, 추론은 COPY_MERGE로 수행됩니다.
+    
+> * Newman, D., Asuncion, A., Smyth, P., & Welling, M. (2009). Distributed algorithms for topic models. Journal of Machine Learning Research, 10(Aug), 1801-1828.
+"""
+    __pdoc__['ParallelScheme.AUTO'] = """
+.. versionadded:: 0.12.3
+
+모델이 지원하는 각 기법을 전체 작업자와 그 절반으로 몇 번씩 반복 학습해보고, 가장 빠른 것으로 학습을 이어갑니다.
+이 반복들도 학습의 일부입니다. 결정은 `tomotopy.LDAModel.train_stats`로 알 수 있으며,
+문헌이 추가되기 전까지 같은 작업자 수의 이후 호출에서 재사용됩니다.
+`tomotopy.LDAModel.auto_memory_limit`를 넘을 후보는 건너뜁니다. 추론은 DEFAULT로 수행됩니다.
+"""
+    __pdoc__['ParallelScheme.HIERARCHICAL'] = """
+.. versionadded:: 0.12.3
+
+작업자들을 `tomotopy.LDAModel.hierarchical_groups`개의 그룹으로 나누고, 각 그룹이 토픽-단어 개수의 사본을 하나씩 가집니다.
+사본들은 COPY_MERGE처럼 병합되며, 그룹 내의 작업자들은 자기 그룹의 사본 위에서 PARTITION처럼 샘플링합니다.
+따라서 COPY_MERGE보다 메모리를 적게 사용하고 PARTITION보다 어휘 집합을 큰 블록으로 나누므로,
+작업자 수가 매우 많을 때 유리합니다. 현재 `tomotopy.LDAModel`에서만 지원되며, 추론은 COPY_MERGE로 수행됩니다.
+"""
+    __pdoc__['SamplingMethod'] = """깁스 샘플링에 사용할 샘플링 기법을 선택하는 데에 사용되는 열거형입니다. 기본값은 DENSE이며, 모든 모델이 아래의 기법을 전부 지원하지는 않습니다."""
+    __pdoc__['SamplingMethod.DENSE'] = """각 단어마다 모든 토픽의 우도를 계산합니다. (기본값)"""
+    __pdoc__['SamplingMethod.SPARSE'] = """
+우도를 평활화, 문헌-토픽, 토픽-단어 버킷으로 분리하고 0이 아닌 항만 계산합니다.
+단어 하나를 샘플링하는 비용이 전체 토픽 개수가 아니라 해당 문헌이나 단어에 등장하는 토픽 개수에 비례합니다.
+토픽 개수가 많을 때 유리합니다.
+    
+> * Yao, L., Mimno, D., & McCallum, A. (2009, June). Efficient methods for topic model inference on streaming document collections. In Proceedings of the 15th ACM SIGKDD international conference on Knowledge discovery and data mining (pp. 937-946).
+"""
+    __pdoc__['SamplingMethod.MH'] = """
+단어 제안 분포와 문헌 제안 분포에서 번갈아가며 새 토픽을 제안하고, 메트로폴리스-헤이스팅스 검정으로 이를 채택합니다.
+단어 제안 분포는 매 반복마다 별칭 테이블로 생성되므로, 단어 하나를 샘플링하는 비용이 토픽 개수와 관계없이 일정합니다.
+토픽 개수가 매우 많을 때 유리하지만, DENSE보다 수렴에 더 많은 반복이 필요합니다.
+    
+> * Yuan, J., Gao, F., Ho, Q., Dai, W., Wei, J., Zheng, X., ... & Ma, W. Y. (2015, May). Lightlda: Big topic models on modest computer clusters. In Proceedings of the 24th International Conference on World Wide Web (pp. 1351-1361).
+"""
+    __pdoc__['DocOrder'] = """`tomotopy.ParallelScheme.PARTITION`에서 문헌을 방문하는 순서를 선택하는 데에 사용되는 열거형입니다. 샘플링 순서만 바꾸며 `tomotopy.LDAModel.docs`의 순서는 바꾸지 않습니다."""
+    __pdoc__['DocOrder.SHUFFLED'] = """문헌을 무작위 순서로 방문합니다. (기본값)"""
+    __pdoc__['DocOrder.VOCAB_BLOCK'] = """
+문헌을 단어가 가장 많이 속하는 어휘 블록별로 묶고, 각 묶음 안에서는 긴 문헌부터 방문합니다.
+블록의 크기는 그 주제별 개수가 L2 캐시에 들어가도록 정해집니다.
+"""
+    __pdoc__['DocOrder.LENGTH'] = """긴 문헌부터 방문합니다."""
+    __pdoc__['DocOrder.WORD_MAJOR'] = """
+문헌 단위 대신 단어 단위로 토큰을 방문하여, 한 어휘의 모든 출현을 연달아 샘플링하는 동안 그 주제별 개수가 CPU 캐시에 머무르게 합니다.
+어휘의 크기가 클 때 가장 유리합니다.
+단일 스레드 학습에도 적용되지만, `tomotopy.SamplingMethod.DENSE`를 사용하는 `tomotopy.LDAModel`만 이를 지원합니다.
+다른 모형과 샘플링 방법은 문헌을 무작위 순서로 방문합니다.
+"""
+    __pdoc__['DocMetric'] = """`tomotopy.DocIndex`가 사용하는 문헌의 토픽 분포 간 거리를 선택하는 데에 사용되는 열거형입니다."""
+    __pdoc__['DocMetric.HELLINGER'] = """헬링거 거리 (기본값)"""
+    __pdoc__['DocMetric.JS'] = """nat 단위의 젠슨-섀넌 발산. 탐색할 목록은 헬링거 거리로 고릅니다."""
+    __pdoc__['DocMetric.COSINE'] = """1에서 코사인 유사도를 뺀 값"""
+    __pdoc__['HeldOutEstimator'] = """`tomotopy.LDAModel.estimate_held_out_ll`이 사용하는 held-out 로그 가능도의 추정 방법을 선택하는 데에 사용되는 열거형입니다."""
+    __pdoc__['HeldOutEstimator.LEFT_TO_RIGHT'] = """Wallach 외(2009)의 left-to-right 입자 추정법 (기본값). 가장 정확하지만 비용이 문헌 길이의 제곱에 비례합니다."""
+    __pdoc__['HeldOutEstimator.IMPORTANCE_SAMPLING'] = """각 단어의 주제를 사전 분포와 주제-단어 분포로부터 독립적으로 뽑는 제안 분포를 쓰는 중요도 샘플링"""
+    __pdoc__['HeldOutEstimator.HARMONIC_MEAN'] = """깁스 샘플링 표본들의 가능도의 조화 평균. 빠르지만 가능도를 과대추정하는 것으로 알려져 있습니다."""
+    __pdoc__['TrainingHandle'] = """
+.. versionadded:: 0.12.3
+
+`TrainingHandle`은 주어진 모델의 `tomotopy.LDAModel.train`을 백그라운드 스레드에서 실행합니다.
+학습 중에는 GIL이 해제되므로 다른 Python 스레드가 계속 실행될 수 있습니다.
+학습이 끝나기 전까지는 `callback` 내부를 제외하고 모델에 접근해서는 안 됩니다.
+
+Parameters
+----------
+model : tomotopy.LDAModel
+    학습할 모델
+iter, workers, parallel, freeze_topics, callback, callback_interval, checkpoint, checkpoint_interval, checkpoint_deltas
+    `tomotopy.LDAModel.train`의 파라미터와 동일
+"""
+    __pdoc__['TrainingHandle.cancel'] = """학습 중단을 요청합니다. 학습은 다음 콜백 시점, 즉 `callback_interval` 회 반복 이내에 중단됩니다."""
+    __pdoc__['TrainingHandle.done'] = """학습이 끝났거나 중단되었으면 `True`를 반환합니다."""
+    __pdoc__['TrainingHandle.wait'] = """최대 `timeout`초 동안 학습이 끝나기를 기다린 뒤 `tomotopy.TrainingHandle.done`을 반환합니다.
+학습 중 예외가 발생했다면 여기에서 다시 발생시킵니다."""
+    __pdoc__['TrainingHandle.progress'] = """마지막 콜백에 전달된 dict, 아직 보고된 반복이 없으면 `None` (읽기전용)"""
+    __pdoc__['TrainingHandle.model'] = """학습 중인 모델 (읽기전용)"""
+    __pdoc__['SaveHandle'] = """
+.. versionadded:: 0.12.3
+
+`SaveHandle`은 주어진 모델의 스냅샷을 백그라운드 스레드에서 파일로 저장하여, 모델을 곧바로 다시 학습할 수 있게 합니다.
+스냅샷은 핸들이 생성될 때 `tomotopy.LDAModel.copy`로 만들어집니다.
+`tomotopy.LDAModel`의 경우 스냅샷은 문헌들과 개수들을 모델과 공유하므로, 저장이 끝나기 전에 모델이 변경하는 배열들만큼의 메모리만 추가로 사용합니다.
+
+Parameters
+----------
+model : tomotopy.LDAModel
+    저장할 모델
+filename, full, compress, workers
+    `tomotopy.LDAModel.save`의 파라미터와 동일
+"""
+    __pdoc__['SaveHandle.done'] = """저장이 끝났으면 `True`를 반환합니다."""
+    __pdoc__['SaveHandle.wait'] = """최대 `timeout`초 동안 저장이 끝나기를 기다린 뒤 `tomotopy.SaveHandle.done`을 반환합니다.
+저장 중 예외가 발생했다면 여기에서 다시 발생시킵니다."""
 del IntEnum, os
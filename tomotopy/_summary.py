@@ -236,25 +236,32 @@ def params_info_CTModel(mdl, file):
     print('| eta (Dirichlet prior on the per-topic word distribution)\n'
         '|  {:.5}'.format(mdl.eta), file=file)
 
+def _all_topic_words(mdl, top_n):
+    words, _ = mdl.get_all_topic_words(top_n=top_n, return_words=True)
+    return [' '.join(w) for w in words]
+
 def topics_info_LDAModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_topics()
     for k in range(mdl.k):
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('| #{} ({}) : {}'.format(k, topic_cnt[k], words), file=file)
 
 def topics_info_HDPModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_topics()
     for k in range(mdl.k):
         if not mdl.is_live_topic(k): continue
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('| #{} ({}) : {}'.format(k, topic_cnt[k], words), file=file)
 
 def topics_info_HLDAModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     import numpy as np
     topic_cnt = mdl.get_count_by_topics()
 
     def print_hierarchical(k=0, level=0):
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('| {}#{} ({}, {}) : {}'.format('  ' * level, k, topic_cnt[k], mdl.num_docs_of_topic(k), words), file=file)
         for c in np.sort(mdl.children_topics(k)):
             print_hierarchical(c, level + 1)
@@ -262,6 +269,7 @@ def topics_info_HLDAModel(mdl, file, topic_word_top_n):
     print_hierarchical()
 
 def topics_info_PAModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_super_topic()
     print('| Sub-topic distribution of Super-topics', file=file)
     for k in range(mdl.k1):
@@ -270,58 +278,63 @@ def topics_info_PAModel(mdl, file, topic_word_top_n):
     topic_cnt = mdl.get_count_by_topics()
     print('| Word distribution of Sub-topics', file=file)
     for k in range(mdl.k2):
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('|  #{} ({}) : {}'.format(k, topic_cnt[k], words), file=file)
 
 def topics_info_HPAModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_topics()
-    words = ' '.join(w for w, _ in mdl.get_topic_words(0, top_n=topic_word_top_n))
+    words = topic_words[0]
     print('| Top-topic ({}) : {}'.format(topic_cnt[0], words), file=file)
     print('| Super-topics', file=file)
     for k in range(1, 1 + mdl.k1):
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('|  #Super{} ({}) : {}'.format(k - 1, topic_cnt[k], words), file=file)
         words = ' '.join('#{}'.format(w) for w, _ in mdl.get_sub_topics(k - 1, top_n=topic_word_top_n))
         print('|    its sub-topics : {}'.format(words))
     print('| Sub-topics', file=file)
     for k in range(1 + mdl.k1, 1 + mdl.k1 + mdl.k2):
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('|  #{} ({}) : {}'.format(k - 1 - mdl.k1, topic_cnt[k], words), file=file)
 
 def topics_info_LLDAModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_topics()
     for k in range(mdl.k):
         label = ('Label {} (#{})'.format(mdl.topic_label_dict[k], k) 
             if k < len(mdl.topic_label_dict) else '#{}'.format(k))
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('| {} ({}) : {}'.format(label, topic_cnt[k], words), file=file)
 
 def topics_info_PLDAModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_topics()
     for k in range(mdl.k):
         l = k // mdl.topics_per_label
         label = ('Label {}-{} (#{})'.format(mdl.topic_label_dict[l], k % mdl.topics_per_label, k) 
             if l < len(mdl.topic_label_dict) else 'Latent {} (#{})'.format(k - mdl.topics_per_label * len(mdl.topic_label_dict), k))
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('| {} ({}) : {}'.format(label, topic_cnt[k], words), file=file)
 
 def topics_info_MGLDAModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_topics()
     print('| Global Topic', file=file)
     for k in range(mdl.k):
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k, top_n=topic_word_top_n))
+        words = topic_words[k]
         print('|  #{} ({}) : {}'.format(k, topic_cnt[k], words), file=file)
     print('| Local Topic', file=file)
     for k in range(mdl.k_l):
-        words = ' '.join(w for w, _ in mdl.get_topic_words(k + mdl.k, top_n=topic_word_top_n))
+        words = topic_words[k + mdl.k]
         print('|  #{} ({}) : {}'.format(k, topic_cnt[k + mdl.k], words), file=file)
 
 def topics_info_DTModel(mdl, file, topic_word_top_n):
+    topic_words = _all_topic_words(mdl, topic_word_top_n)
     topic_cnt = mdl.get_count_by_topics()
     for k in range(mdl.k):
         print('| #{} ({})'.format(k, topic_cnt[:, k].sum()), file=file)
         for t in range(mdl.num_timepoints):
-            words = ' '.join(w for w, _ in mdl.get_topic_words(k, t, top_n=topic_word_top_n))
+            words = topic_words[k + mdl.k * t]
             print('|  t={} ({}) : {}'.format(t, topic_cnt[t, k], words), file=file)
 
 def summary(mdl, initial_hp=True, params=True, topic_word_top_n=5, file=None, flush=False):
@@ -9,7 +9,7 @@ This module provides the way to calculate topic coherence introduced the followi
 
 '''
 
-from _tomotopy import _Coherence
+from _tomotopy import _Coherence, _CoherenceIndex
 
 from enum import IntEnum
 
@@ -66,7 +66,7 @@ class Coherence(_Coherence):
         'c_npmi':(ProbEstimation.SLIDING_WINDOWS, 10, Segmentation.ONE_ONE, ConfirmMeasure.NPMI, IndirectMeasure.NONE)
     }
 
-    def __init__(self, corpus, coherence='u_mass', window_size=0, targets=None, top_n=10, eps=1e-12, gamma=1.0):
+    def __init__(self, corpus, coherence='u_mass', window_size=0, targets=None, top_n=10, eps=1e-12, gamma=1.0, workers=1, index=None):
         '''Initialize an instance to calculate coherence for given corpus
 
 Parameters
@@ -75,6 +75,11 @@ corpus : Union[tomotopy.utils.Corpus, tomotopy.LDAModel]
     A reference corpus to be used for estimating probability. 
     Supports not only an instance of `tomotopy.utils.Corpus`, but also any topic model instances including `tomotopy.LDAModel` and its descendants.
     If `corpus` is an instance of `tomotpy.utils.Corpus`, `targets` must be given too.
+
+    .. versionchanged:: 0.12.3
+
+        If `corpus` is a topic model, its documents are counted directly from the model in parallel,
+        and the target words are taken from all of its topics without iterating them in Python.
 coherence : Union[str, Tuple[int, int, int], Tuple[int, int, int, int]]
     A coherence metric to be used. The metric can be a combination of (`tomotopy.coherence.ProbEstimation`, `tomotopy.coherence.Segmentation`, `tomotopy.coherence.ConfirmMeasure`)
     or a combination of (`tomotopy.coherence.ProbEstimation`, `tomotopy.coherence.Segmentation`, `tomotopy.coherence.ConfirmMeasure`, `tomotopy.coherence.IndirectMeasure`).
@@ -98,15 +103,24 @@ eps : float
     An epsilon value to prevent division by zero
 gamma : float
     A gamma value for indirect confirm measures
+workers : int
+    .. versionadded:: 0.12.3
+
+    The number of threads used to count `corpus`. If 0, all cores are used.
+    Each thread counts its own part of documents and then the partial counts are merged.
+    The threads are also used to compute the context vectors of all target words at once for indirect confirm measures,
+    and to score all topics when `get_score` is called without `words` and `topic_id`.
+index : tomotopy.coherence.CoherenceIndex
+    .. versionadded:: 0.12.3
+
+    An index built from `corpus`. If given, probabilities are estimated from the index instead of scanning `corpus`,
+    and only the occurrences of target words which were not requested before are scanned.
+    `workers` is not used for counting in this case.
         '''
         import tomotopy as tp
-        import itertools
         self._top_n = top_n
         if isinstance(corpus, tp.LDAModel):
             self._topic_model = corpus
-            if targets is None:
-                targets = itertools.chain(*((w for w, _ in corpus.get_topic_words(k, top_n=top_n)) for k in range(corpus.k)))
-            corpus = corpus.docs
         else:
             self._topic_model = None
         
@@ -127,9 +141,9 @@ gamma : float
             if type(cm) is str: cm = ConfirmMeasure[cm]
             if type(im) is str: im = IndirectMeasure[im]
         
-        if not targets: raise ValueError("`targets` must be given as a non-empty iterable of str.")
+        if self._topic_model is None and not targets: raise ValueError("`targets` must be given as a non-empty iterable of str.")
 
-        super().__init__(corpus, pe=pe, seg=seg, cm=cm, im=im, window_size=window_size or w, targets=targets, eps=eps, gamma=gamma)
+        super().__init__(corpus, pe=pe, seg=seg, cm=cm, im=im, window_size=window_size or w, targets=targets, eps=eps, gamma=gamma, workers=workers, index=index, top_n=top_n)
     
     def get_score(self, words=None, topic_id=None):
         '''Calculate the coherence score for given `words` or `topic_id`
@@ -148,15 +162,63 @@ topic_id : int
         if words is None and self._topic_model is None:
             raise ValueError("`words` must be provided if `Coherence` is not bound to an instance of topic model.")
         if words is None and topic_id is None:
-            c = []
-            for k in range(self._topic_model.k):
-                c.append(super().get_score((w for w, _ in self._topic_model.get_topic_words(k, top_n=self._top_n))))
+            c = super()._get_scores([
+                [w for w, _ in self._topic_model.get_topic_words(k, top_n=self._top_n)] for k in range(self._topic_model.k)
+            ])
             return sum(c) / len(c)
         
         if words is None:
             words = (w for w, _ in self._topic_model.get_topic_words(topic_id, top_n=self._top_n))
         return super().get_score(words)
 
+class CoherenceIndex(_CoherenceIndex):
+    '''.. versionadded:: 0.12.3
+
+`CoherenceIndex` class keeps the positions of all words of a reference corpus,
+together with the probability estimators filled from it.
+Passing it to `tomotopy.coherence.Coherence` as `index` avoids scanning the whole corpus again:
+estimators are shared between `Coherence` instances and only grow with the target words not requested before.
+This is useful when the coherence of many models is calculated against the same corpus, e.g. at every checkpoint of training.
+    '''
+
+    def __init__(self, corpus):
+        '''Build an index of `corpus`
+
+Parameters
+----------
+corpus : Union[tomotopy.utils.Corpus, tomotopy.LDAModel]
+    A reference corpus. The same corpus should be given to `tomotopy.coherence.Coherence` together with this index.
+        '''
+        import tomotopy as tp
+        if isinstance(corpus, tp.LDAModel):
+            corpus = corpus.docs
+        super().__init__(corpus)
+
+    def save(self, filename:str):
+        '''Save the index into the file `filename`. Estimators filled from the index are not saved.
+
+Parameters
+----------
+filename : str
+    a path for the file where the instance is saved
+        '''
+        import pickle
+        with open(filename, 'wb') as f:
+            pickle.dump(self, f)
+
+    @staticmethod
+    def load(filename:str):
+        '''Load and return an index from the file `filename`
+
+Parameters
+----------
+filename : str
+    a path for the file to be loaded
+        '''
+        import pickle
+        with open(filename, 'rb') as f:
+            return pickle.load(f)
+
 import os
 if os.environ.get('TOMOTOPY_LANG') == 'kr':
     __doc__ = """..versionadded:: 0.10.0
@@ -191,6 +253,11 @@ corpus : Union[tomotopy.utils.Corpus, tomotopy.LDAModel]
     단어 분포 확률을 추정하기 위한 레퍼런스 코퍼스.
     `tomotopy.utils.Corpus` 타입뿐만 아니라 `tomotopy.LDAModel`를 비롯한 다양한 토픽 모델링 타입의 인스턴스까지 지원합니다.
     만약 `corpus`가 `tomotpy.utils.Corpus`의 인스턴스라면 `targets`이 반드시 주어져야 합니다.
+
+    .. versionchanged:: 0.12.3
+
+        `corpus`가 토픽 모델인 경우, 모델의 문헌을 직접 병렬로 집계하며
+        목표 단어도 Python에서 반복하지 않고 모델의 모든 토픽에서 가져옵니다.
 coherence : Union[str, Tuple[int, int, int], Tuple[int, int, int, int]]
     coherence를 계산하는 데 사용될 척도. 척도는 (`tomotopy.coherence.ProbEstimation`, `tomotopy.coherence.Segmentation`, `tomotopy.coherence.ConfirmMeasure`)의 조합이거나
     (`tomotopy.coherence.ProbEstimation`, `tomotopy.coherence.Segmentation`, `tomotopy.coherence.ConfirmMeasure`, `tomotopy.coherence.IndirectMeasure`)의 조합이어야 합니다.
@@ -214,6 +281,18 @@ eps : float
     계산 과정에서 0으로 나누는 것을 방지하기 위한 epsilon 값
 gamma : float
     indirect confirm measure 계산에 사용되는 gamma 값
+workers : int
+    .. versionadded:: 0.12.3
+
+    `corpus`를 집계하는 데 사용할 스레드의 개수. 0일 경우 모든 코어를 사용합니다.
+    각 스레드가 문헌의 일부를 따로 집계한 뒤 그 결과를 합칩니다.
+    이 스레드들은 indirect confirm measure를 위해 모든 목표 단어의 문맥 벡터를 한 번에 계산하는 데에도,
+    `words`와 `topic_id` 없이 `get_score`를 호출할 때 모든 토픽의 점수를 계산하는 데에도 사용됩니다.
+index : tomotopy.coherence.CoherenceIndex
+    .. versionadded:: 0.12.3
+
+    `corpus`로부터 생성된 인덱스. 주어질 경우 `corpus`를 다시 훑는 대신 인덱스로부터 확률을 추정하며,
+    이전에 요청된 적 없는 목표 단어의 출현 위치만 새로 살펴봅니다. 이 경우 `workers`는 집계에 사용되지 않습니다.
 '''
     __pdoc__['Coherence.get_score'] = '''주어진 `words` 또는 `topic_id`를 이용해 coherence를 계산합니다.
 
@@ -227,5 +306,19 @@ topic_id : int
     단어가 추출될 토픽의 id.
     이 파라미터는 오직 `tomotopy.coherence.Coherence`가 `tomotopy.LDAModel`나 기타 토픽 모델의 인스턴스로 `corpus`를 받아 초기화된 경우에만 사용 가능합니다.
     생략시 모든 토픽의 coherence 점수를 평균낸 값이 반환됩니다.
+'''
+    __pdoc__['CoherenceIndex'] = '''.. versionadded:: 0.12.3
+
+`CoherenceIndex` 클래스는 레퍼런스 코퍼스의 모든 단어의 위치와 이로부터 계산된 확률 추정기들을 보관합니다.
+`tomotopy.coherence.Coherence`에 `index`로 넘겨주면 전체 코퍼스를 다시 훑지 않아도 됩니다.
+확률 추정기는 여러 `Coherence` 인스턴스 사이에서 공유되며, 이전에 요청된 적 없는 목표 단어에 대해서만 확장됩니다.
+학습의 매 체크포인트마다 같은 코퍼스로 coherence를 계산하는 경우에 유용합니다.
+'''
+    __pdoc__['CoherenceIndex.__init__'] = '''`corpus`의 인덱스를 생성합니다.
+
+Parameters
+----------
+corpus : Union[tomotopy.utils.Corpus, tomotopy.LDAModel]
+    레퍼런스 코퍼스. `tomotopy.coherence.Coherence`에도 이 인덱스와 함께 같은 코퍼스가 주어져야 합니다.
 '''
 del os
\ No newline at end of file